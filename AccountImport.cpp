@@ -0,0 +1,437 @@
+/**
+ * @file AccountImport.cpp
+ * @brief Implements bulk account registration with hash-set de-duplication and an all-or-nothing append.
+ */
+
+#include "AccountImport.h"
+#include "ErrorHandling.h"
+#include "FileLock.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <system_error>
+
+namespace {
+
+const std::size_t kScanBlock = 1 << 22;     // Bytes read per block while scanning the CSV.
+
+/**
+ * @brief A run of code points that fold by the same offset: first, first + stride, ..., last.
+ */
+struct FoldRange {
+    std::uint32_t first;    /**< First code point of the run. */
+    std::uint32_t last;     /**< Last code point of the run. */
+    std::int32_t delta;     /**< Offset to the folded code point. */
+    std::uint32_t stride;   /**< 1 for a block, 2 for alternating upper/lower pairs. */
+};
+
+// Unicode 14 simple case folding (CaseFolding.txt, statuses C and S), the mapping QChar::toCaseFolded()
+// and Qt::CaseInsensitive use, sorted by first code point.
+const FoldRange kFoldRanges[] = {
+    {0x0041, 0x005A, 32, 1}, {0x00B5, 0x00B5, 775, 1}, {0x00C0, 0x00D6, 32, 1}, {0x00D8, 0x00DE, 32, 1},
+    {0x0100, 0x012E, 1, 2}, {0x0132, 0x0136, 1, 2}, {0x0139, 0x0147, 1, 2}, {0x014A, 0x0176, 1, 2},
+    {0x0178, 0x0178, -121, 1}, {0x0179, 0x017D, 1, 2}, {0x017F, 0x017F, -268, 1}, {0x0181, 0x0181, 210, 1},
+    {0x0182, 0x0184, 1, 2}, {0x0186, 0x0186, 206, 1}, {0x0187, 0x0187, 1, 1}, {0x0189, 0x018A, 205, 1},
+    {0x018B, 0x018B, 1, 1}, {0x018E, 0x018E, 79, 1}, {0x018F, 0x018F, 202, 1}, {0x0190, 0x0190, 203, 1},
+    {0x0191, 0x0191, 1, 1}, {0x0193, 0x0193, 205, 1}, {0x0194, 0x0194, 207, 1}, {0x0196, 0x0196, 211, 1},
+    {0x0197, 0x0197, 209, 1}, {0x0198, 0x0198, 1, 1}, {0x019C, 0x019C, 211, 1}, {0x019D, 0x019D, 213, 1},
+    {0x019F, 0x019F, 214, 1}, {0x01A0, 0x01A4, 1, 2}, {0x01A6, 0x01A6, 218, 1}, {0x01A7, 0x01A7, 1, 1},
+    {0x01A9, 0x01A9, 218, 1}, {0x01AC, 0x01AC, 1, 1}, {0x01AE, 0x01AE, 218, 1}, {0x01AF, 0x01AF, 1, 1},
+    {0x01B1, 0x01B2, 217, 1}, {0x01B3, 0x01B5, 1, 2}, {0x01B7, 0x01B7, 219, 1}, {0x01B8, 0x01B8, 1, 1},
+    {0x01BC, 0x01BC, 1, 1}, {0x01C4, 0x01C4, 2, 1}, {0x01C5, 0x01C5, 1, 1}, {0x01C7, 0x01C7, 2, 1},
+    {0x01C8, 0x01C8, 1, 1}, {0x01CA, 0x01CA, 2, 1}, {0x01CB, 0x01DB, 1, 2}, {0x01DE, 0x01EE, 1, 2},
+    {0x01F1, 0x01F1, 2, 1}, {0x01F2, 0x01F4, 1, 2}, {0x01F6, 0x01F6, -97, 1}, {0x01F7, 0x01F7, -56, 1},
+    {0x01F8, 0x021E, 1, 2}, {0x0220, 0x0220, -130, 1}, {0x0222, 0x0232, 1, 2}, {0x023A, 0x023A, 10795, 1},
+    {0x023B, 0x023B, 1, 1}, {0x023D, 0x023D, -163, 1}, {0x023E, 0x023E, 10792, 1}, {0x0241, 0x0241, 1, 1},
+    {0x0243, 0x0243, -195, 1}, {0x0244, 0x0244, 69, 1}, {0x0245, 0x0245, 71, 1}, {0x0246, 0x024E, 1, 2},
+    {0x0345, 0x0345, 116, 1}, {0x0370, 0x0372, 1, 2}, {0x0376, 0x0376, 1, 1}, {0x037F, 0x037F, 116, 1},
+    {0x0386, 0x0386, 38, 1}, {0x0388, 0x038A, 37, 1}, {0x038C, 0x038C, 64, 1}, {0x038E, 0x038F, 63, 1},
+    {0x0391, 0x03A1, 32, 1}, {0x03A3, 0x03AB, 32, 1}, {0x03C2, 0x03C2, 1, 1}, {0x03CF, 0x03CF, 8, 1},
+    {0x03D0, 0x03D0, -30, 1}, {0x03D1, 0x03D1, -25, 1}, {0x03D5, 0x03D5, -15, 1}, {0x03D6, 0x03D6, -22, 1},
+    {0x03D8, 0x03EE, 1, 2}, {0x03F0, 0x03F0, -54, 1}, {0x03F1, 0x03F1, -48, 1}, {0x03F4, 0x03F4, -60, 1},
+    {0x03F5, 0x03F5, -64, 1}, {0x03F7, 0x03F7, 1, 1}, {0x03F9, 0x03F9, -7, 1}, {0x03FA, 0x03FA, 1, 1},
+    {0x03FD, 0x03FF, -130, 1}, {0x0400, 0x040F, 80, 1}, {0x0410, 0x042F, 32, 1}, {0x0460, 0x0480, 1, 2},
+    {0x048A, 0x04BE, 1, 2}, {0x04C0, 0x04C0, 15, 1}, {0x04C1, 0x04CD, 1, 2}, {0x04D0, 0x052E, 1, 2},
+    {0x0531, 0x0556, 48, 1}, {0x10A0, 0x10C5, 7264, 1}, {0x10C7, 0x10C7, 7264, 1}, {0x10CD, 0x10CD, 7264, 1},
+    {0x13F8, 0x13FD, -8, 1}, {0x1C80, 0x1C80, -6222, 1}, {0x1C81, 0x1C81, -6221, 1}, {0x1C82, 0x1C82, -6212, 1},
+    {0x1C83, 0x1C84, -6210, 1}, {0x1C85, 0x1C85, -6211, 1}, {0x1C86, 0x1C86, -6204, 1}, {0x1C87, 0x1C87, -6180, 1},
+    {0x1C88, 0x1C88, 35267, 1}, {0x1C90, 0x1CBA, -3008, 1}, {0x1CBD, 0x1CBF, -3008, 1}, {0x1E00, 0x1E94, 1, 2},
+    {0x1E9B, 0x1E9B, -58, 1}, {0x1E9E, 0x1E9E, -7615, 1}, {0x1EA0, 0x1EFE, 1, 2}, {0x1F08, 0x1F0F, -8, 1},
+    {0x1F18, 0x1F1D, -8, 1}, {0x1F28, 0x1F2F, -8, 1}, {0x1F38, 0x1F3F, -8, 1}, {0x1F48, 0x1F4D, -8, 1},
+    {0x1F59, 0x1F5F, -8, 2}, {0x1F68, 0x1F6F, -8, 1}, {0x1F88, 0x1F8F, -8, 1}, {0x1F98, 0x1F9F, -8, 1},
+    {0x1FA8, 0x1FAF, -8, 1}, {0x1FB8, 0x1FB9, -8, 1}, {0x1FBA, 0x1FBB, -74, 1}, {0x1FBC, 0x1FBC, -9, 1},
+    {0x1FBE, 0x1FBE, -7173, 1}, {0x1FC8, 0x1FCB, -86, 1}, {0x1FCC, 0x1FCC, -9, 1}, {0x1FD8, 0x1FD9, -8, 1},
+    {0x1FDA, 0x1FDB, -100, 1}, {0x1FE8, 0x1FE9, -8, 1}, {0x1FEA, 0x1FEB, -112, 1}, {0x1FEC, 0x1FEC, -7, 1},
+    {0x1FF8, 0x1FF9, -128, 1}, {0x1FFA, 0x1FFB, -126, 1}, {0x1FFC, 0x1FFC, -9, 1}, {0x2126, 0x2126, -7517, 1},
+    {0x212A, 0x212A, -8383, 1}, {0x212B, 0x212B, -8262, 1}, {0x2132, 0x2132, 28, 1}, {0x2160, 0x216F, 16, 1},
+    {0x2183, 0x2183, 1, 1}, {0x24B6, 0x24CF, 26, 1}, {0x2C00, 0x2C2F, 48, 1}, {0x2C60, 0x2C60, 1, 1},
+    {0x2C62, 0x2C62, -10743, 1}, {0x2C63, 0x2C63, -3814, 1}, {0x2C64, 0x2C64, -10727, 1}, {0x2C67, 0x2C6B, 1, 2},
+    {0x2C6D, 0x2C6D, -10780, 1}, {0x2C6E, 0x2C6E, -10749, 1}, {0x2C6F, 0x2C6F, -10783, 1},
+    {0x2C70, 0x2C70, -10782, 1}, {0x2C72, 0x2C72, 1, 1}, {0x2C75, 0x2C75, 1, 1}, {0x2C7E, 0x2C7F, -10815, 1},
+    {0x2C80, 0x2CE2, 1, 2}, {0x2CEB, 0x2CED, 1, 2}, {0x2CF2, 0x2CF2, 1, 1}, {0xA640, 0xA66C, 1, 2},
+    {0xA680, 0xA69A, 1, 2}, {0xA722, 0xA72E, 1, 2}, {0xA732, 0xA76E, 1, 2}, {0xA779, 0xA77B, 1, 2},
+    {0xA77D, 0xA77D, -35332, 1}, {0xA77E, 0xA786, 1, 2}, {0xA78B, 0xA78B, 1, 1}, {0xA78D, 0xA78D, -42280, 1},
+    {0xA790, 0xA792, 1, 2}, {0xA796, 0xA7A8, 1, 2}, {0xA7AA, 0xA7AA, -42308, 1}, {0xA7AB, 0xA7AB, -42319, 1},
+    {0xA7AC, 0xA7AC, -42315, 1}, {0xA7AD, 0xA7AD, -42305, 1}, {0xA7AE, 0xA7AE, -42308, 1},
+    {0xA7B0, 0xA7B0, -42258, 1}, {0xA7B1, 0xA7B1, -42282, 1}, {0xA7B2, 0xA7B2, -42261, 1}, {0xA7B3, 0xA7B3, 928, 1},
+    {0xA7B4, 0xA7C2, 1, 2}, {0xA7C4, 0xA7C4, -48, 1}, {0xA7C5, 0xA7C5, -42307, 1}, {0xA7C6, 0xA7C6, -35384, 1},
+    {0xA7C7, 0xA7C9, 1, 2}, {0xA7D0, 0xA7D0, 1, 1}, {0xA7D6, 0xA7D8, 1, 2}, {0xA7F5, 0xA7F5, 1, 1},
+    {0xAB70, 0xABBF, -38864, 1}, {0xFF21, 0xFF3A, 32, 1}, {0x10400, 0x10427, 40, 1}, {0x104B0, 0x104D3, 40, 1},
+    {0x10570, 0x1057A, 39, 1}, {0x1057C, 0x1058A, 39, 1}, {0x1058C, 0x10592, 39, 1}, {0x10594, 0x10595, 39, 1},
+    {0x10C80, 0x10CB2, 64, 1}, {0x118A0, 0x118BF, 32, 1}, {0x16E40, 0x16E5F, 32, 1}, {0x1E900, 0x1E921, 34, 1},
+};
+
+/**
+ * @brief Folds one code point.
+ * @param cp Code point.
+ * @return std::uint32_t The folded code point (cp itself if it has no folding).
+ */
+std::uint32_t foldCodePoint(std::uint32_t cp) {
+    const FoldRange *end = kFoldRanges + sizeof(kFoldRanges) / sizeof(kFoldRanges[0]);
+    const FoldRange *range =
+        std::upper_bound(kFoldRanges, end, cp, [](std::uint32_t value, const FoldRange &r) { return value < r.first; });
+    if (range == kFoldRanges) return cp;
+    --range;
+    if (cp > range->last || (cp - range->first) % range->stride != 0) return cp;
+    return static_cast<std::uint32_t>(static_cast<std::int32_t>(cp) + range->delta);
+}
+
+/**
+ * @brief Appends a code point as UTF-8.
+ * @param out Output.
+ * @param cp Code point.
+ */
+void appendUtf8(std::string &out, std::uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+/**
+ * @brief Decodes the UTF-8 sequence starting at an index.
+ * @param text Text.
+ * @param at Index of the lead byte; advanced past the sequence.
+ * @param[out] cp The code point.
+ * @return bool False if the bytes are not a well-formed sequence; at is then left unchanged.
+ */
+bool decodeUtf8(const std::string &text, std::size_t &at, std::uint32_t &cp) {
+    unsigned char lead = static_cast<unsigned char>(text[at]);
+    std::size_t length = lead >= 0xF0 && lead <= 0xF4 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC2 && lead < 0xE0 ? 2 : 0;
+    if (length == 0 || lead >= 0xF5 || text.size() - at < length) return false;
+    cp = lead & (0x7F >> length);
+    for (std::size_t k = 1; k < length; ++k) {
+        unsigned char byte = static_cast<unsigned char>(text[at + k]);
+        if ((byte & 0xC0) != 0x80) return false;
+        cp = cp << 6 | (byte & 0x3F);
+    }
+    static const std::uint32_t smallest[] = {0, 0, 0x80, 0x800, 0x10000};
+    if (cp < smallest[length] || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000)) return false;
+    at += length;
+    return true;
+}
+
+/**
+ * @brief Trims spaces, tabs and carriage returns from both ends of a range.
+ * @param text Text.
+ * @param begin Index of the first character.
+ * @param end One past the last character.
+ * @return std::string The trimmed substring.
+ */
+std::string trimmed(const std::string &text, std::size_t begin, std::size_t end) {
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t' || text[begin] == '\r')) ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r')) --end;
+    return text.substr(begin, end - begin);
+}
+
+/**
+ * @brief Checks whether a field contains a control character, which would break the CSV's lines.
+ * @param field Field text.
+ * @return bool True if it contains a byte below 0x20 or DEL.
+ */
+bool hasControlCharacter(const std::string &field) {
+    for (char c : field)
+        if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) return true;
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an importer for a registration CSV.
+ * @param csvFile Path of the CSV shared by registration and reading rows.
+ */
+AccountImport::AccountImport(const std::string &csvFile) : csvPath(csvFile) {}
+
+/**
+ * @brief Checks a password against the registration rules.
+ *
+ * Mirrors the "^(?=.*[A-Za-z])(?=.*\d).{5,}$" check of SurveyScreen::saveUserData. QRegularExpression
+ * matches in UTF mode, where '.' consumes a whole code point (a surrogate pair in UTF-16), so the length is
+ * counted in code points: UTF-8 lead bytes, not bytes and not UTF-16 units.
+ *
+ * @param password Trimmed password.
+ * @return bool True if it has at least 5 characters, a letter and a digit.
+ */
+bool AccountImport::isValidPassword(const std::string &password) {
+    std::size_t characters = 0;
+    bool letter = false;
+    bool digit = false;
+    for (char c : password) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if ((byte & 0xC0) != 0x80) ++characters;
+        letter = letter || (byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z');
+        digit = digit || (byte >= '0' && byte <= '9');
+        if (c == '\n') return false;
+    }
+    return characters >= 5 && letter && digit;
+}
+
+/**
+ * @brief Gets the key usernames are compared by.
+ *
+ * ASCII, by far the common case, is folded in place; anything else is decoded and mapped through the
+ * simple case folding table. Bytes that are not well-formed UTF-8 are kept as they are.
+ *
+ * @param username Username in UTF-8.
+ * @return std::string The username with Unicode simple case folding applied.
+ */
+std::string AccountImport::foldCase(const std::string &username) {
+    std::string key;
+    key.reserve(username.size());
+    std::size_t at = 0;
+    while (at < username.size()) {
+        char c = username[at];
+        if (static_cast<unsigned char>(c) < 0x80) {
+            key += c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+            ++at;
+            continue;
+        }
+        std::uint32_t cp;
+        if (decodeUtf8(username, at, cp)) {
+            appendUtf8(key, foldCodePoint(cp));
+        } else {
+            key += c;
+            ++at;
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief Parses a "username,password" CSV.
+ * @param path CSV path.
+ * @param[out] accounts Parsed accounts.
+ * @return bool False if the file could not be read.
+ */
+bool AccountImport::parseAccounts(const std::string &path, std::vector<AccountRecord> &accounts) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        ErrorHandling::logErrorMessage("Failed to open account list " + path);
+        return false;
+    }
+    std::string text(static_cast<std::size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    in.read(&text[0], static_cast<std::streamsize>(text.size()));
+    if (!in) {
+        ErrorHandling::logErrorMessage("Failed to read account list " + path);
+        return false;
+    }
+
+    accounts.reserve(accounts.size() + text.size() / 24);
+    std::size_t lineStart = 0;
+    bool first = true;
+    while (lineStart < text.size()) {
+        std::size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = text.size();
+        std::size_t comma = text.find(',', lineStart);
+        bool blank = trimmed(text, lineStart, lineEnd).empty();
+        if (!blank) {
+            AccountRecord record;
+            if (comma < lineEnd && text.find(',', comma + 1) >= lineEnd) {
+                record.username = trimmed(text, lineStart, comma);
+                record.password = trimmed(text, comma + 1, lineEnd);
+            } else {
+                // Kept so the import reports the line instead of silently dropping it.
+                record.username = trimmed(text, lineStart, lineEnd);
+            }
+            bool header = first && foldCase(record.username) == "username" && foldCase(record.password) == "password";
+            if (!header) accounts.push_back(std::move(record));
+            first = false;
+        }
+        lineStart = lineEnd + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Scans the CSV for usernames already taken.
+ * @return bool False if the file exists but could not be read.
+ */
+bool AccountImport::loadExisting() {
+    taken.clear();
+    loaded = true;
+    std::error_code ec;
+    if (!std::filesystem::exists(csvPath, ec)) return true;
+    std::ifstream in(csvPath, std::ios::binary);
+    if (!in.is_open()) {
+        ErrorHandling::logErrorMessage("Failed to open " + csvPath + " for reading usernames");
+        return false;
+    }
+
+    // Reading rows of one user are usually contiguous, so a name equal to the previous row's is not re-hashed.
+    std::string block(kScanBlock, '\0');
+    std::string carry;
+    std::string previous;
+    bool header = true;
+    auto takeLine = [&](const std::string &text, std::size_t begin, std::size_t end) {
+        if (header) {
+            header = false;
+            return;
+        }
+        std::size_t comma = text.find(',', begin);
+        std::string name = trimmed(text, begin, comma < end ? comma : end);
+        if (name.empty() || name == previous) return;
+        taken.insert(foldCase(name));
+        previous.swap(name);
+    };
+    while (in) {
+        in.read(&block[0], static_cast<std::streamsize>(block.size()));
+        std::size_t got = static_cast<std::size_t>(in.gcount());
+        if (got == 0) break;
+        std::size_t lineStart = 0;
+        for (std::size_t newline; (newline = block.find('\n', lineStart)) < got; lineStart = newline + 1) {
+            if (!carry.empty()) {
+                carry.append(block, lineStart, newline - lineStart);
+                takeLine(carry, 0, carry.size());
+                carry.clear();
+            } else {
+                takeLine(block, lineStart, newline);
+            }
+        }
+        carry.append(block, lineStart, got - lineStart);
+    }
+    if (!carry.empty()) takeLine(carry, 0, carry.size());
+    if (in.bad()) {
+        ErrorHandling::logErrorMessage("Failed to read " + csvPath);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks whether a username is taken.
+ * @param username Username.
+ * @return bool True if it is in the CSV or was imported by this object.
+ */
+bool AccountImport::contains(const std::string &username) const {
+    return taken.count(foldCase(username)) != 0;
+}
+
+/**
+ * @brief Registers a batch of accounts.
+ * @param accounts Accounts to register.
+ * @param dryRun Validate and de-duplicate only, without writing.
+ * @return AccountImportReport What was imported and what was rejected.
+ */
+AccountImportReport AccountImport::import(const std::vector<AccountRecord> &accounts, bool dryRun) {
+    AccountImportReport report;
+    if (!loaded && !loadExisting()) {
+        report.written = false;
+        return report;
+    }
+
+    // The CSV is shared with ReadingStore; measuring, appending and any rollback happen under its lock.
+    std::unique_ptr<FileLock> csvLock;
+    if (!dryRun) csvLock.reset(new FileLock(csvPath + ".lock"));
+    std::error_code ec;
+    std::uintmax_t previousSize = std::filesystem::exists(csvPath, ec) ? std::filesystem::file_size(csvPath, ec) : 0;
+    if (ec) previousSize = 0;
+    std::string buffer;
+    buffer.reserve(accounts.size() * 32 + 32);
+    if (previousSize == 0) {
+        buffer += "Username,Password\n";
+    } else {
+        // A last row without a newline would otherwise absorb the first imported account.
+        std::ifstream tail(csvPath, std::ios::binary);
+        char last = '\n';
+        if (tail.seekg(static_cast<std::streamoff>(previousSize) - 1) && tail.get(last) && last != '\n') buffer += '\n';
+    }
+
+    taken.reserve(taken.size() + accounts.size());
+    std::vector<std::string> added;
+    added.reserve(accounts.size());
+    for (std::size_t i = 0; i < accounts.size(); ++i) {
+        const std::string username = trimmed(accounts[i].username, 0, accounts[i].username.size());
+        const std::string password = trimmed(accounts[i].password, 0, accounts[i].password.size());
+        const char *reason = nullptr;
+        if (username.find(',') != std::string::npos || password.find(',') != std::string::npos)
+            reason = "Fields may not contain commas";
+        else if (hasControlCharacter(username) || hasControlCharacter(password))
+            reason = "Fields may not contain tabs, line breaks or other control characters";
+        else if (username.empty() || password.empty()) reason = "Both fields must be filled";
+        else if (!isValidPassword(password))
+            reason = "Password must be at least 5 characters long and contain at least one letter and one number";
+        if (!reason) {
+            std::string key = foldCase(username);
+            if (taken.insert(key).second) added.push_back(std::move(key));
+            else reason = "Username already exists";
+        }
+        if (reason) {
+            AccountRejection rejection;
+            rejection.index = i;
+            rejection.username = accounts[i].username;
+            rejection.reason = reason;
+            report.rejected.push_back(std::move(rejection));
+            continue;
+        }
+        buffer += username;
+        buffer += ',';
+        buffer += password;
+        buffer += '\n';
+        ++report.imported;
+    }
+
+    auto forgetAdded = [&]() {
+        for (const std::string &key : added) taken.erase(key);
+    };
+    if (dryRun) {
+        forgetAdded();
+        return report;
+    }
+    if (report.imported == 0) return report;
+
+    bool ok = false;
+    {
+        std::ofstream out(csvPath, std::ios::binary | std::ios::app);
+        if (out.is_open()) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            out.close();
+            ok = static_cast<bool>(out);
+        }
+    }
+    if (!ok) {
+        ErrorHandling::logErrorMessage("Failed to append accounts to " + csvPath);
+        // Whatever part of the batch reached the file is cut off again.
+        if (csvLock->isLocked() && std::filesystem::exists(csvPath, ec) &&
+            std::filesystem::file_size(csvPath, ec) > previousSize)
+            std::filesystem::resize_file(csvPath, previousSize, ec);
+        forgetAdded();
+        report.imported = 0;
+        report.written = false;
+    }
+    return report;
+}
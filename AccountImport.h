@@ -0,0 +1,119 @@
+#ifndef ACCOUNTIMPORT_H
+#define ACCOUNTIMPORT_H
+
+/**
+ * @file AccountImport.h
+ * @brief Declaration of bulk account registration into userdata.csv.
+ *
+ * SurveyScreen registers one account at a time and rescans userdata.csv for each. This header declares an
+ * importer that scans the file once, checks a whole batch against a hash set of the names already taken,
+ * and appends every accepted account in a single write.
+ */
+
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief One account to register.
+ */
+struct AccountRecord {
+    std::string username;   /**< Username (surrounding whitespace is trimmed). */
+    std::string password;   /**< Password (surrounding whitespace is trimmed). */
+};
+
+/**
+ * @brief An account that was not registered, and why.
+ */
+struct AccountRejection {
+    std::size_t index = 0;  /**< Position in the imported batch. */
+    std::string username;   /**< Username as given. */
+    std::string reason;     /**< Human-readable reason. */
+};
+
+/**
+ * @brief Outcome of one import.
+ */
+struct AccountImportReport {
+    std::size_t imported = 0;                   /**< Accounts appended. */
+    std::vector<AccountRejection> rejected;     /**< Accounts skipped, in batch order. */
+    bool written = true;                        /**< False if the append failed (nothing was imported). */
+};
+
+/**
+ * @class AccountImport
+ * @brief Validates, de-duplicates and appends registration rows in bulk.
+ *
+ * Passwords follow SurveyScreen's rules: at least 5 characters with at least one ASCII letter and one
+ * digit. A username is taken if it matches, ignoring case as Qt::CaseInsensitive does (Unicode simple case
+ * folding), the first field of any row of the CSV after the header (as in SurveyScreen::saveUserData) or an
+ * earlier account of the same batch. Fields may not contain commas or control characters, since either would
+ * corrupt the CSV.
+ *
+ * The accepted rows are appended with one write. If that write fails the file is truncated back to its
+ * previous length, so an import lands either completely or not at all. Both happen under the FileLock that
+ * ReadingStore takes on the same CSV, so the truncation never removes rows another process appended.
+ */
+class AccountImport {
+public:
+    /**
+     * @brief Constructs an importer for a registration CSV.
+     * @param csvFile Path of the CSV shared by registration and reading rows.
+     */
+    explicit AccountImport(const std::string &csvFile = "userdata.csv");
+
+    /**
+     * @brief Checks a password against the registration rules.
+     * @param password Trimmed password.
+     * @return bool True if it has at least 5 characters, a letter and a digit.
+     */
+    static bool isValidPassword(const std::string &password);
+
+    /**
+     * @brief Gets the key usernames are compared by.
+     * @param username Username.
+     * @return std::string The username with Unicode simple case folding applied, as QString::toCaseFolded().
+     */
+    static std::string foldCase(const std::string &username);
+
+    /**
+     * @brief Parses a "username,password" CSV, skipping a "Username,Password" header and blank lines.
+     * @param path CSV path.
+     * @param[out] accounts Parsed accounts; lines without exactly one comma are kept with an empty password so
+     *             import() reports them.
+     * @return bool False if the file could not be read.
+     */
+    static bool parseAccounts(const std::string &path, std::vector<AccountRecord> &accounts);
+
+    /**
+     * @brief Scans the CSV for usernames already taken (done by import() if not called first).
+     * @return bool False if the file exists but could not be read.
+     */
+    bool loadExisting();
+
+    /**
+     * @brief Checks whether a username is taken.
+     * @param username Username.
+     * @return bool True if it is in the CSV or was imported by this object.
+     */
+    bool contains(const std::string &username) const;
+
+    /** @return std::size_t Number of distinct usernames known to be taken. */
+    std::size_t takenCount() const { return taken.size(); }
+
+    /**
+     * @brief Registers a batch of accounts.
+     * @param accounts Accounts to register.
+     * @param dryRun Validate and de-duplicate only, without writing.
+     * @return AccountImportReport What was imported and what was rejected.
+     */
+    AccountImportReport import(const std::vector<AccountRecord> &accounts, bool dryRun = false);
+
+private:
+    std::string csvPath;                        /**< Path of the registration CSV. */
+    std::unordered_set<std::string> taken;      /**< Folded usernames already registered. */
+    bool loaded = false;                        /**< True once the CSV has been scanned. */
+};
+
+#endif // ACCOUNTIMPORT_H
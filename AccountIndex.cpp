@@ -0,0 +1,119 @@
+/**
+ * @file AccountIndex.cpp
+ * @brief Implements the sorted username index and its prefix lookups.
+ */
+
+#include "AccountIndex.h"
+#include "AccountImport.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+
+namespace {
+
+/**
+ * @brief Trims spaces, tabs and carriage returns from both ends of a range.
+ * @param text Text.
+ * @param begin Index of the first character.
+ * @param end One past the last character.
+ * @return std::string The trimmed substring.
+ */
+std::string trimmed(const std::string &text, std::size_t begin, std::size_t end) {
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t' || text[begin] == '\r')) ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r')) --end;
+    return text.substr(begin, end - begin);
+}
+
+} // namespace
+
+/**
+ * @brief Replaces the index contents.
+ * @param accounts Usernames in any order.
+ */
+void AccountIndex::build(std::vector<std::string> accounts) {
+    std::vector<std::string> folded(accounts.size());
+    for (std::size_t i = 0; i < accounts.size(); ++i) folded[i] = AccountImport::foldCase(accounts[i]);
+    std::vector<std::size_t> order(accounts.size());
+    std::iota(order.begin(), order.end(), 0);
+    // Stable, so the first spelling of a name wins when several differ only in case.
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return folded[a] < folded[b]; });
+    keys.clear();
+    names.clear();
+    keys.reserve(order.size());
+    names.reserve(order.size());
+    for (std::size_t i : order) {
+        if (folded[i].empty() || (!keys.empty() && keys.back() == folded[i])) continue;
+        keys.push_back(std::move(folded[i]));
+        names.push_back(std::move(accounts[i]));
+    }
+}
+
+/**
+ * @brief Indexes the registration rows of userdata.csv.
+ * @param csvPath Path of the CSV shared by registration and reading rows.
+ * @return bool False if the file could not be opened.
+ */
+bool AccountIndex::loadRegistered(const std::string &csvPath) {
+    std::ifstream in(csvPath, std::ios::binary);
+    if (!in.is_open()) {
+        ErrorHandling::logErrorMessage("Failed to open " + csvPath + " for loading user names");
+        return false;
+    }
+    std::vector<std::string> accounts;
+    std::string line;
+    bool header = true;
+    while (std::getline(in, line)) {
+        std::size_t comma = line.find(',');
+        if (header) {
+            header = trimmed(line, 0, line.size()).empty();
+            continue;
+        }
+        // Registration rows have exactly two columns; reading rows have three or four.
+        if (comma == std::string::npos || line.find(',', comma + 1) != std::string::npos) continue;
+        accounts.push_back(trimmed(line, 0, comma));
+    }
+    build(std::move(accounts));
+    return true;
+}
+
+/**
+ * @brief Finds the usernames that start with a prefix, ignoring ASCII case.
+ * @param prefix Typed text.
+ * @return std::pair<std::size_t, std::size_t> Half-open range of positions.
+ */
+std::pair<std::size_t, std::size_t> AccountIndex::prefixRange(const std::string &prefix) const {
+    const std::string key = AccountImport::foldCase(prefix);
+    auto first = std::lower_bound(keys.begin(), keys.end(), key);
+    // Everything from first on that starts with key; comparing only the first key.size() characters.
+    auto last = std::upper_bound(first, keys.end(), key, [](const std::string &value, const std::string &element) {
+        return value.compare(0, value.size(), element, 0, value.size()) < 0;
+    });
+    return std::make_pair(static_cast<std::size_t>(first - keys.begin()),
+                          static_cast<std::size_t>(last - keys.begin()));
+}
+
+/**
+ * @brief Gets the first matches for a prefix in sorted order.
+ * @param prefix Typed text.
+ * @param count Maximum number of matches.
+ * @return std::vector<std::string> Matching usernames.
+ */
+std::vector<std::string> AccountIndex::topMatches(const std::string &prefix, std::size_t count) const {
+    std::pair<std::size_t, std::size_t> range = prefixRange(prefix);
+    std::size_t last = std::min(range.second, range.first + count);
+    return std::vector<std::string>(names.begin() + static_cast<std::ptrdiff_t>(range.first),
+                                    names.begin() + static_cast<std::ptrdiff_t>(last));
+}
+
+/**
+ * @brief Finds a username, ignoring ASCII case.
+ * @param username Username.
+ * @return long long Position, or -1 if it is not registered.
+ */
+long long AccountIndex::find(const std::string &username) const {
+    const std::string key = AccountImport::foldCase(username);
+    auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    return it != keys.end() && *it == key ? static_cast<long long>(it - keys.begin()) : -1;
+}
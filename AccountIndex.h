@@ -0,0 +1,77 @@
+#ifndef ACCOUNTINDEX_H
+#define ACCOUNTINDEX_H
+
+/**
+ * @file AccountIndex.h
+ * @brief Declaration of the sorted username index behind the type-ahead account pickers.
+ *
+ * This header declares a case-insensitively sorted array of registered usernames. Every name that starts
+ * with a typed prefix sits in one contiguous range of the array, so the matches for a keystroke are found
+ * with two binary searches and read out in order without copying.
+ */
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class AccountIndex
+ * @brief Usernames sorted by their ASCII-case-folded form, with prefix range lookups.
+ *
+ * Names that differ only in case are kept once (the first one seen), matching the case-insensitive
+ * uniqueness SurveyScreen and AccountImport enforce when registering.
+ */
+class AccountIndex {
+public:
+    /**
+     * @brief Replaces the index contents.
+     * @param accounts Usernames in any order; duplicates are dropped.
+     */
+    void build(std::vector<std::string> accounts);
+
+    /**
+     * @brief Indexes the registration rows (exactly two columns) of userdata.csv, skipping its header line.
+     * @param csvPath Path of the CSV shared by registration and reading rows.
+     * @return bool False if the file could not be opened.
+     */
+    bool loadRegistered(const std::string &csvPath);
+
+    /** @return std::size_t Number of usernames. */
+    std::size_t size() const { return names.size(); }
+
+    /**
+     * @brief Gets a username by its position in sorted order.
+     * @param i Position (below size()).
+     * @return const std::string& Username as registered.
+     */
+    const std::string &name(std::size_t i) const { return names[i]; }
+
+    /**
+     * @brief Finds the usernames that start with a prefix, ignoring ASCII case.
+     * @param prefix Typed text (an empty prefix matches everything).
+     * @return std::pair<std::size_t, std::size_t> Half-open range of positions, in sorted order.
+     */
+    std::pair<std::size_t, std::size_t> prefixRange(const std::string &prefix) const;
+
+    /**
+     * @brief Gets the first matches for a prefix in sorted order, so an exact match comes first.
+     * @param prefix Typed text.
+     * @param count Maximum number of matches.
+     * @return std::vector<std::string> Matching usernames.
+     */
+    std::vector<std::string> topMatches(const std::string &prefix, std::size_t count) const;
+
+    /**
+     * @brief Finds a username, ignoring ASCII case.
+     * @param username Username.
+     * @return long long Position, or -1 if it is not registered.
+     */
+    long long find(const std::string &username) const;
+
+private:
+    std::vector<std::string> keys;      /**< Case-folded usernames, sorted. */
+    std::vector<std::string> names;     /**< Usernames as registered, parallel to keys. */
+};
+
+#endif // ACCOUNTINDEX_H
@@ -0,0 +1,238 @@
+/**
+ * @file AnomalyDetector.cpp
+ * @brief Implements the EWMA, CUSUM and per-patient streaming detectors.
+ *
+ * The detectors replace "average over the entire history" checks: a bad hour shows up in the EWMA level and
+ * the CUSUM within a handful of samples instead of being diluted by months of normal data.
+ */
+
+#include "AnomalyDetector.h"
+#include <cmath>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+
+/**
+ * @brief Constructs a new EwmaChart object.
+ * @param smoothing Weight of the newest sample (lambda).
+ * @param limitWidth Control limit width L in standard deviations.
+ */
+EwmaChart::EwmaChart(double smoothing, double limitWidth)
+    : lambda(smoothing), width(limitWidth), level(0.0), started(false) {}
+
+/**
+ * @brief Adds a sample and tests it against the baseline.
+ *
+ * Uses the asymptotic control limits, which the chart reaches after a few samples.
+ *
+ * @param x New sample.
+ * @param mean Baseline mean.
+ * @param sigma Baseline standard deviation.
+ * @return int +1 above the upper limit, -1 below the lower limit, 0 in control.
+ */
+int EwmaChart::update(double x, double mean, double sigma) {
+    if (!started) {
+        level = x;
+        started = true;
+    } else {
+        level = lambda * x + (1.0 - lambda) * level;
+    }
+    double limit = width * sigma * std::sqrt(lambda / (2.0 - lambda));
+    if (level > mean + limit) return 1;
+    if (level < mean - limit) return -1;
+    return 0;
+}
+
+/**
+ * @brief Constructs a new Cusum object.
+ * @param k Reference value in standard deviations.
+ * @param h Decision interval in standard deviations.
+ */
+Cusum::Cusum(double k, double h) : slack(k), threshold(h), high(0.0), low(0.0) {}
+
+/**
+ * @brief Adds a standardised sample.
+ * @param z Sample expressed as (x - mean) / sigma.
+ * @return int +1 while an upward shift is signalled, -1 while a downward one is, 0 otherwise.
+ */
+int Cusum::update(double z) {
+    high = std::fmin(std::fmax(0.0, high + z - slack), 2.0 * threshold);
+    low = std::fmin(std::fmax(0.0, low - z - slack), 2.0 * threshold);
+    if (high > threshold) return 1;
+    if (low > threshold) return -1;
+    return 0;
+}
+
+/**
+ * @brief Constructs a new PatientDetector with an empty baseline.
+ */
+PatientDetector::PatientDetector()
+    : ewma(0.1, 3.5), cusum(0.5, 8.0), samples(0), baselineMean(0.0), baselineVar(0.0),
+      welfordM2(0.0), alarmState(0), alarmSamples(0), lastSeverity(0.0) {}
+
+/**
+ * @brief Gets the baseline standard deviation.
+ * @return double Standard deviation, floored at kMinSigma.
+ */
+double PatientDetector::getBaselineSigma() const {
+    return std::fmax(std::sqrt(baselineVar), kMinSigma);
+}
+
+/**
+ * @brief Feeds one heart-rate sample.
+ *
+ * During warm-up only the baseline and the EWMA level are updated. Afterwards the sample is tested by
+ * both charts; an event is emitted when the patient enters an alarm (or the alarm changes direction), not
+ * on every out-of-control sample. The alarm clears once the EWMA is back inside its limits and the CUSUM
+ * has decayed below its decision interval, or after kRelearnSamples samples, when the shifted level becomes
+ * the baseline.
+ *
+ * @param timestamp Sample time (seconds since epoch).
+ * @param bpm Heart rate in beats per minute.
+ * @param[out] event Filled in when the sample triggers a change event.
+ * @return bool True if a change event was emitted.
+ */
+bool PatientDetector::update(long long timestamp, double bpm, ChangeEvent &event) {
+    ++samples;
+    if (samples <= kWarmupSamples) {
+        double delta = bpm - baselineMean;
+        baselineMean += delta / samples;
+        welfordM2 += delta * (bpm - baselineMean);
+        baselineVar = samples > 1 ? welfordM2 / (samples - 1) : 0.0;
+        ewma.update(bpm, baselineMean, getBaselineSigma());
+        return false;
+    }
+
+    double sigma = getBaselineSigma();
+    double z = (bpm - baselineMean) / sigma;
+    int ewmaSignal = ewma.update(bpm, baselineMean, sigma);
+    int cusumSignal = cusum.update(z);
+
+    bool emitted = false;
+    int signal = cusumSignal != 0 ? cusumSignal : ewmaSignal;
+    if (signal != 0 && signal != alarmState) {
+        event.kind = cusumSignal > 0 ? ChangeEvent::CusumUp
+                   : cusumSignal < 0 ? ChangeEvent::CusumDown
+                   : ewmaSignal > 0 ? ChangeEvent::EwmaHigh : ChangeEvent::EwmaLow;
+        event.timestamp = timestamp;
+        event.value = bpm;
+        event.baseline = baselineMean;
+        event.severity = std::fmax(std::fabs(z), std::fabs(ewma.getLevel() - baselineMean) / sigma);
+        lastSeverity = event.severity;
+        alarmState = signal;
+        alarmSamples = 0;
+        emitted = true;
+    } else if (ewmaSignal == 0 && cusumSignal == 0 && alarmState != 0) {
+        alarmState = 0;
+    }
+
+    // The capped CUSUM stays above h for as long as the shift lasts, so a lasting shift is relearned.
+    if (alarmState != 0 && ++alarmSamples >= kRelearnSamples) {
+        baselineMean = ewma.getLevel();
+        cusum.reset();
+        alarmState = 0;
+        alarmSamples = 0;
+    }
+
+    if (alarmState == 0) {
+        double delta = bpm - baselineMean;
+        baselineMean += kBaselineRate * delta;
+        baselineVar = (1.0 - kBaselineRate) * (baselineVar + kBaselineRate * delta * delta);
+    }
+    return emitted;
+}
+
+/**
+ * @brief Classifies risk from the recent level rather than the lifetime average.
+ * @return std::string "Low", "Moderate", "High", or "Unknown".
+ */
+std::string PatientDetector::classifyRisk() const {
+    if (samples == 0) return "Unknown";
+    double recent = ewma.getLevel();
+    int tier = recent < 80.0 ? 0 : (recent < 100.0 ? 1 : 2);
+    if (alarmState > 0 && tier < 2) ++tier;
+    static const char *names[] = { "Low", "Moderate", "High" };
+    return names[tier];
+}
+
+/**
+ * @brief Writes the detector state as one line.
+ * @param out Output stream.
+ */
+void PatientDetector::write(std::ostream &out) const {
+    std::streamsize precision = out.precision(17);
+    out << "detector," << samples << "," << baselineMean << "," << baselineVar << "," << welfordM2 << ","
+        << alarmState << "," << alarmSamples << "," << lastSeverity << "," << (ewma.hasLevel() ? 1 : 0) << ","
+        << ewma.getLevel() << "," << cusum.getHigh() << "," << cusum.getLow() << "\n";
+    out.precision(precision);
+}
+
+/**
+ * @brief Reads state written by write().
+ * @param in Input stream positioned at the "detector" line.
+ * @return bool False if the line is malformed.
+ */
+bool PatientDetector::read(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 9, "detector,") != 0) return false;
+    double values[11];
+    const char *p = line.c_str() + 9;
+    char *end = nullptr;
+    for (int i = 0; i < 11; ++i) {
+        values[i] = std::strtod(p, &end);
+        if (end == p || *end != (i < 10 ? ',' : '\0')) return false;
+        p = end + 1;
+    }
+    samples = static_cast<long long>(values[0]);
+    baselineMean = values[1];
+    baselineVar = values[2];
+    welfordM2 = values[3];
+    alarmState = static_cast<int>(values[4]);
+    alarmSamples = static_cast<long long>(values[5]);
+    lastSeverity = values[6];
+    ewma.restore(values[8], values[7] != 0.0);
+    cusum.restore(values[9], values[10]);
+    return true;
+}
+
+/**
+ * @brief Feeds one sample for a user, creating the user's detector on first use.
+ * @param user Username.
+ * @param timestamp Sample time (seconds since epoch).
+ * @param bpm Heart rate in beats per minute.
+ * @param[out] events Receives any change event produced by this sample.
+ * @return bool True if an event was appended.
+ */
+bool AnomalyMonitor::update(const std::string &user, long long timestamp, double bpm, std::vector<ChangeEvent> &events) {
+    ChangeEvent event;
+    if (patients[user].update(timestamp, bpm, event)) {
+        events.push_back(event);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Looks up the detector for a user.
+ * @param user Username.
+ * @return const PatientDetector* The detector, or nullptr if unknown.
+ */
+const PatientDetector* AnomalyMonitor::find(const std::string &user) const {
+    auto it = patients.find(user);
+    return it == patients.end() ? nullptr : &it->second;
+}
+
+/**
+ * @brief Gets a short human-readable description of an event.
+ * @param event The change event.
+ * @return std::string Description of the direction and test.
+ */
+std::string describeChangeEvent(const ChangeEvent &event) {
+    switch (event.kind) {
+    case ChangeEvent::CusumUp:   return "Upward shift (CUSUM)";
+    case ChangeEvent::CusumDown: return "Downward shift (CUSUM)";
+    case ChangeEvent::EwmaHigh:  return "Elevated level (EWMA)";
+    case ChangeEvent::EwmaLow:   return "Depressed level (EWMA)";
+    }
+    return "Change";
+}
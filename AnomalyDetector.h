@@ -0,0 +1,257 @@
+#ifndef ANOMALYDETECTOR_H
+#define ANOMALYDETECTOR_H
+
+/**
+ * @file AnomalyDetector.h
+ * @brief Declaration of the streaming heart-rate anomaly detectors.
+ *
+ * This header declares an EWMA control chart, a two-sided CUSUM, a per-patient detector that combines both
+ * against a baseline learned online, and a monitor that runs one detector per user. Every update is O(1),
+ * so a single core can follow thousands of patients.
+ */
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A change reported by a detector.
+ */
+struct ChangeEvent {
+    /**
+     * @brief Which test raised the event.
+     */
+    enum Kind {
+        EwmaHigh,   /**< Smoothed level crossed the upper control limit. */
+        EwmaLow,    /**< Smoothed level crossed the lower control limit. */
+        CusumUp,    /**< Cumulative sum detected an upward shift. */
+        CusumDown   /**< Cumulative sum detected a downward shift. */
+    };
+
+    Kind kind = EwmaHigh;       /**< Test that fired. */
+    long long timestamp = 0;    /**< Timestamp of the sample that triggered the event. */
+    double value = 0.0;         /**< The triggering sample. */
+    double baseline = 0.0;      /**< Baseline mean at the time of the event. */
+    double severity = 0.0;      /**< Size of the excursion in baseline standard deviations. */
+
+    /** @return bool True for upward (faster heart rate) events. */
+    bool isUpward() const { return kind == EwmaHigh || kind == CusumUp; }
+};
+
+/**
+ * @class EwmaChart
+ * @brief Exponentially weighted moving average control chart.
+ *
+ * z_t = lambda * x_t + (1 - lambda) * z_{t-1}, signalling when z leaves mu +/- L * sigma * sqrt(lambda / (2 - lambda)).
+ */
+class EwmaChart {
+private:
+    double lambda;      /**< Smoothing weight of the newest sample. */
+    double width;       /**< Control limit width L in standard deviations. */
+    double level;       /**< Current smoothed value z. */
+    bool started;       /**< False until the first sample seeds the level. */
+
+public:
+    /**
+     * @brief Constructs a new EwmaChart object.
+     * @param smoothing Weight of the newest sample (lambda), typically 0.05 - 0.3.
+     * @param limitWidth Control limit width L in standard deviations.
+     */
+    explicit EwmaChart(double smoothing = 0.2, double limitWidth = 3.0);
+
+    /**
+     * @brief Adds a sample and tests it against the baseline.
+     * @param x New sample.
+     * @param mean Baseline mean.
+     * @param sigma Baseline standard deviation (must be positive).
+     * @return int +1 above the upper limit, -1 below the lower limit, 0 in control.
+     */
+    int update(double x, double mean, double sigma);
+
+    /** @return double The smoothed level z. */
+    double getLevel() const { return level; }
+
+    /** @return bool True once a sample has been seen. */
+    bool hasLevel() const { return started; }
+
+    /**
+     * @brief Restores a saved level.
+     * @param savedLevel Smoothed value z.
+     * @param savedStarted Whether a sample had been seen.
+     */
+    void restore(double savedLevel, bool savedStarted) { level = savedLevel; started = savedStarted; }
+};
+
+/**
+ * @class Cusum
+ * @brief Two-sided tabular CUSUM on standardised samples.
+ *
+ * S+ = max(0, S+ + z - k) and S- = max(0, S- - z - k), signalling when either exceeds h. A side keeps
+ * signalling until its sum decays back to h, so a sustained shift is one continuous signal rather than a
+ * series of alarms and clears. The sums are capped at 2h so that the signal ends within about h / k
+ * in-control samples after the shift does.
+ */
+class Cusum {
+private:
+    double slack;       /**< Reference value k in standard deviations. */
+    double threshold;   /**< Decision interval h in standard deviations. */
+    double high;        /**< Upper cumulative sum S+. */
+    double low;         /**< Lower cumulative sum S-. */
+
+public:
+    /**
+     * @brief Constructs a new Cusum object.
+     * @param k Reference value (half the shift to detect, in standard deviations).
+     * @param h Decision interval in standard deviations.
+     */
+    explicit Cusum(double k = 0.5, double h = 5.0);
+
+    /**
+     * @brief Adds a standardised sample.
+     * @param z Sample expressed as (x - mean) / sigma.
+     * @return int +1 while an upward shift is signalled, -1 while a downward one is, 0 otherwise.
+     */
+    int update(double z);
+
+    /** @return double Current upper cumulative sum. */
+    double getHigh() const { return high; }
+
+    /** @return double Current lower cumulative sum. */
+    double getLow() const { return low; }
+
+    /**
+     * @brief Clears both cumulative sums.
+     */
+    void reset() { high = 0.0; low = 0.0; }
+
+    /**
+     * @brief Restores saved sums.
+     * @param savedHigh Upper cumulative sum.
+     * @param savedLow Lower cumulative sum.
+     */
+    void restore(double savedHigh, double savedLow) { high = savedHigh; low = savedLow; }
+};
+
+/**
+ * @class PatientDetector
+ * @brief EWMA and CUSUM detectors against one patient's own learned baseline.
+ *
+ * The first samples establish the baseline mean and variance (Welford). Afterwards the baseline keeps
+ * adapting through a slow exponential update, which is paused while an alarm is active so that the shift
+ * under investigation is not absorbed into "normal". An alarm that lasts kRelearnSamples samples is taken
+ * as the patient's new normal: the baseline moves to the smoothed level and the CUSUM restarts, so a lasting
+ * change is reported once and then clears instead of raising the risk tier forever.
+ */
+class PatientDetector {
+private:
+    EwmaChart ewma;           /**< Fast control chart on the raw samples. */
+    Cusum cusum;              /**< Two-sided CUSUM on standardised samples. */
+    long long samples;        /**< Samples seen so far. */
+    double baselineMean;      /**< Learned baseline mean. */
+    double baselineVar;       /**< Learned baseline variance. */
+    double welfordM2;         /**< Welford sum of squares during warm-up. */
+    int alarmState;           /**< +1 / -1 while an upward / downward alarm is active, else 0. */
+    long long alarmSamples;   /**< Samples since the active alarm was raised. */
+    double lastSeverity;      /**< Severity of the most recent event. */
+
+public:
+    static const int kWarmupSamples = 30;      /**< Samples used to seed the baseline. */
+    static constexpr double kBaselineRate = 0.01; /**< Weight of a new sample in the adaptive baseline. */
+    static constexpr double kMinSigma = 1.0;   /**< Floor on the baseline standard deviation in BPM. */
+    static const int kRelearnSamples = 240;    /**< Samples an alarm lasts before its level is relearned. */
+
+    PatientDetector();
+
+    /**
+     * @brief Feeds one heart-rate sample.
+     * @param timestamp Sample time (seconds since epoch).
+     * @param bpm Heart rate in beats per minute.
+     * @param[out] event Filled in when the sample triggers a change event.
+     * @return bool True if a change event was emitted.
+     */
+    bool update(long long timestamp, double bpm, ChangeEvent &event);
+
+    /** @return bool True once the warm-up period is over. */
+    bool isWarmedUp() const { return samples >= kWarmupSamples; }
+
+    /** @return long long Number of samples seen. */
+    long long getSampleCount() const { return samples; }
+
+    /** @return double Learned baseline mean. */
+    double getBaselineMean() const { return baselineMean; }
+
+    /** @return double Learned baseline standard deviation (never below kMinSigma). */
+    double getBaselineSigma() const;
+
+    /** @return double Recent (EWMA-smoothed) heart rate. */
+    double getRecentLevel() const { return ewma.getLevel(); }
+
+    /** @return int +1 / -1 while an upward / downward alarm is active, else 0. */
+    int getAlarmState() const { return alarmState; }
+
+    /** @return double Severity of the last event in baseline standard deviations (0 if none). */
+    double getLastSeverity() const { return lastSeverity; }
+
+    /**
+     * @brief Classifies risk from the recent level rather than the lifetime average.
+     *
+     * The smoothed level is compared against the 80 / 100 BPM thresholds used elsewhere in the app, and an
+     * active upward alarm raises the tier by one step.
+     *
+     * @return std::string "Low", "Moderate", "High", or "Unknown" before any samples arrive.
+     */
+    std::string classifyRisk() const;
+
+    /**
+     * @brief Writes the detector state as one "detector,..." line.
+     * @param out Output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads state written by write().
+     * @param in Input stream positioned at the "detector" line.
+     * @return bool False if the line is malformed (the detector is left untouched).
+     */
+    bool read(std::istream &in);
+};
+
+/**
+ * @class AnomalyMonitor
+ * @brief Runs one PatientDetector per user.
+ */
+class AnomalyMonitor {
+private:
+    std::unordered_map<std::string, PatientDetector> patients; /**< Detector state keyed by username. */
+
+public:
+    /**
+     * @brief Feeds one sample for a user.
+     * @param user Username.
+     * @param timestamp Sample time (seconds since epoch).
+     * @param bpm Heart rate in beats per minute.
+     * @param[out] events Receives any change event produced by this sample.
+     * @return bool True if an event was appended.
+     */
+    bool update(const std::string &user, long long timestamp, double bpm, std::vector<ChangeEvent> &events);
+
+    /**
+     * @brief Looks up the detector for a user.
+     * @param user Username.
+     * @return const PatientDetector* The detector, or nullptr if the user has no samples yet.
+     */
+    const PatientDetector* find(const std::string &user) const;
+
+    /** @return std::size_t Number of monitored users. */
+    std::size_t size() const { return patients.size(); }
+};
+
+/**
+ * @brief Gets a short human-readable description of an event.
+ * @param event The change event.
+ * @return std::string For example "Upward shift (CUSUM)".
+ */
+std::string describeChangeEvent(const ChangeEvent &event);
+
+#endif // ANOMALYDETECTOR_H
@@ -0,0 +1,215 @@
+/**
+ * @file BpmHistogram.cpp
+ * @brief Implements fixed-bin heart-rate histograms and their day-aligned tier.
+ */
+
+#include "BpmHistogram.h"
+#include "HeartRateRollup.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/**
+ * @brief Adds one reading.
+ * @param bpm Heart rate in beats per minute.
+ */
+void BpmHistogram::add(double bpm) {
+    long rounded = std::lround(std::min(std::max(bpm, 0.0), static_cast<double>(kBins - 1)));
+    ++bins[rounded];
+    ++total;
+}
+
+/**
+ * @brief Adds another histogram's counts to this one.
+ * @param other Histogram to merge.
+ */
+void BpmHistogram::merge(const BpmHistogram &other) {
+    for (int b = 0; b < kBins; ++b) bins[b] += other.bins[b];
+    total += other.total;
+}
+
+/**
+ * @brief Counts readings in a BPM range.
+ * @param low Inclusive lower BPM.
+ * @param high Exclusive upper BPM.
+ * @return long long Readings with low <= BPM < high.
+ */
+long long BpmHistogram::countBetween(int low, int high) const {
+    long long sum = 0;
+    for (int b = std::max(low, 0); b < std::min(high, kBins); ++b) sum += bins[b];
+    return sum;
+}
+
+/**
+ * @brief Splits the readings into training zones.
+ * @param maxHeartRate Maximum heart rate the zone boundaries are relative to.
+ * @return HeartRateZones Fraction of readings per zone.
+ */
+HeartRateZones BpmHistogram::zones(double maxHeartRate) const {
+    HeartRateZones result;
+    if (total == 0) return result;
+    int fatBurnStart = static_cast<int>(std::ceil(0.5 * maxHeartRate));
+    int cardioStart = static_cast<int>(std::ceil(0.7 * maxHeartRate));
+    result.resting = static_cast<double>(countBetween(0, fatBurnStart)) / total;
+    result.fatBurn = static_cast<double>(countBetween(fatBurnStart, cardioStart)) / total;
+    result.cardio = static_cast<double>(countBetween(cardioStart, kBins)) / total;
+    return result;
+}
+
+/**
+ * @brief Writes the non-empty bins as "bin:count" fields, each preceded by a comma.
+ * @param out Output stream.
+ */
+void BpmHistogram::write(std::ostream &out) const {
+    for (int b = 0; b < kBins; ++b)
+        if (bins[b] != 0) out << "," << b << ":" << bins[b];
+}
+
+/**
+ * @brief Parses fields produced by write().
+ * @param text Text starting at the first comma (may be empty).
+ * @return bool False if the text is malformed.
+ */
+bool BpmHistogram::parse(const char *text) {
+    *this = BpmHistogram();
+    while (*text == ',') {
+        char *end = nullptr;
+        long b = std::strtol(text + 1, &end, 10);
+        if (*end != ':' || b < 0 || b >= kBins) return false;
+        unsigned long long count = std::strtoull(end + 1, &end, 10);
+        bins[b] = static_cast<std::uint32_t>(count);
+        total += static_cast<long long>(count);
+        text = end;
+    }
+    return *text == '\0' || *text == '\r';
+}
+
+/**
+ * @brief Adds one reading.
+ * @param timestamp Seconds since epoch.
+ * @param bpm Heart rate in beats per minute.
+ */
+void DailyHistograms::addReading(long long timestamp, double bpm) {
+    long long start = HeartRateRollup::bucketStart(timestamp, HeartRateRollup::Day);
+    if (dayHistograms.empty() || dayHistograms.back().start < start) {
+        dayHistograms.emplace_back();
+        dayHistograms.back().start = start;
+    }
+    auto it = dayHistograms.end() - 1;
+    if (it->start != start) {
+        it = std::lower_bound(dayHistograms.begin(), dayHistograms.end(), start,
+                              [](const Day &day, long long s) { return day.start < s; });
+        if (it->start != start) {
+            it = dayHistograms.insert(it, Day());
+            it->start = start;
+        }
+    }
+    it->histogram.add(bpm);
+    lifetime.add(bpm);
+}
+
+/**
+ * @brief Merges the days that overlap a time range.
+ * @param from Inclusive range start (seconds since epoch).
+ * @param to Exclusive range end (seconds since epoch).
+ * @return BpmHistogram Combined histogram.
+ */
+BpmHistogram DailyHistograms::range(long long from, long long to) const {
+    auto it = std::lower_bound(dayHistograms.begin(), dayHistograms.end(), from - 86400 + 1,
+                               [](const Day &day, long long s) { return day.start < s; });
+    BpmHistogram merged;
+    for (; it != dayHistograms.end() && it->start < to; ++it) merged.merge(it->histogram);
+    return merged;
+}
+
+/**
+ * @brief Removes all days.
+ */
+void DailyHistograms::clear() {
+    dayHistograms.clear();
+    lifetime = BpmHistogram();
+}
+
+/**
+ * @brief Writes a "histograms" section: a count line and one "start,bin:count,..." line per day.
+ * @param out Output stream.
+ */
+void DailyHistograms::write(std::ostream &out) const {
+    out << "histograms," << dayHistograms.size() << "\n";
+    for (const Day &day : dayHistograms) {
+        out << day.start;
+        day.histogram.write(out);
+        out << "\n";
+    }
+}
+
+/**
+ * @brief Reads a section previously produced by write().
+ * @param in Input stream positioned at the "histograms" line.
+ * @return bool False if the section is missing or malformed.
+ */
+bool DailyHistograms::read(std::istream &in) {
+    clear();
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 11, "histograms,") != 0) return false;
+    long long dayCount = std::strtoll(line.c_str() + 11, nullptr, 10);
+    if (dayCount < 0) return false;
+    dayHistograms.resize(static_cast<std::size_t>(dayCount));
+    for (Day &day : dayHistograms) {
+        if (!std::getline(in, line)) return false;
+        char *end = nullptr;
+        day.start = std::strtoll(line.c_str(), &end, 10);
+        if (end == line.c_str() || !day.histogram.parse(end)) return false;
+        lifetime.merge(day.histogram);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a "histograms,<count>,<from>" line and the days starting at or after from.
+ * @param out Output stream.
+ * @param since Earliest timestamp added since the last write.
+ */
+void DailyHistograms::writeChanges(std::ostream &out, long long since) const {
+    long long from = HeartRateRollup::bucketStart(since, HeartRateRollup::Day);
+    auto first = std::lower_bound(dayHistograms.begin(), dayHistograms.end(), from,
+                                  [](const Day &day, long long s) { return day.start < s; });
+    out << "histograms," << (dayHistograms.end() - first) << "," << from << "\n";
+    for (auto it = first; it != dayHistograms.end(); ++it) {
+        out << it->start;
+        it->histogram.write(out);
+        out << "\n";
+    }
+}
+
+/**
+ * @brief Applies days previously produced by writeChanges().
+ *
+ * The lifetime total is merged again from every day, since the replaced days cannot be subtracted out.
+ *
+ * @param in Input stream positioned at the "histograms" line.
+ * @return bool False if the section is malformed.
+ */
+bool DailyHistograms::readChanges(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 11, "histograms,") != 0) return false;
+    char *end = nullptr;
+    long long dayCount = std::strtoll(line.c_str() + 11, &end, 10);
+    if (dayCount < 0 || *end != ',') return false;
+    long long from = std::strtoll(end + 1, nullptr, 10);
+
+    dayHistograms.erase(std::lower_bound(dayHistograms.begin(), dayHistograms.end(), from,
+                                         [](const Day &day, long long s) { return day.start < s; }),
+                        dayHistograms.end());
+    for (long long i = 0; i < dayCount; ++i) {
+        Day day;
+        if (!std::getline(in, line)) return false;
+        day.start = std::strtoll(line.c_str(), &end, 10);
+        if (end == line.c_str() || !day.histogram.parse(end) || day.start < from) return false;
+        if (!dayHistograms.empty() && day.start <= dayHistograms.back().start) return false;
+        dayHistograms.push_back(day);
+    }
+    lifetime = BpmHistogram();
+    for (const Day &day : dayHistograms) lifetime.merge(day.histogram);
+    return true;
+}
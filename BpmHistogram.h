@@ -0,0 +1,172 @@
+#ifndef BPMHISTOGRAM_H
+#define BPMHISTOGRAM_H
+
+/**
+ * @file BpmHistogram.h
+ * @brief Declaration of fixed-bin heart-rate histograms and their day-aligned tier.
+ *
+ * This header declares a 1-BPM histogram that is updated in constant time per reading and merged by adding
+ * bins, and a series of such histograms aligned to the day tier of HeartRateRollup. Any day-aligned range of
+ * a user's history, including all of it, is summarized by merging day histograms instead of rescanning
+ * readings.
+ */
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Share of readings in each heart-rate training zone.
+ */
+struct HeartRateZones {
+    double resting = 0.0;   /**< Below 50% of the maximum heart rate. */
+    double fatBurn = 0.0;   /**< 50% to 70% of the maximum heart rate. */
+    double cardio = 0.0;    /**< 70% of the maximum heart rate and above. */
+};
+
+/**
+ * @class BpmHistogram
+ * @brief Reading counts in 1-BPM bins from 0 to kBins - 1.
+ *
+ * Readings are rounded to the nearest BPM; values outside the range land in the first or last bin.
+ */
+class BpmHistogram {
+public:
+    static const int kBins = 256;   /**< Number of 1-BPM bins. */
+
+    /**
+     * @brief Adds one reading.
+     * @param bpm Heart rate in beats per minute.
+     */
+    void add(double bpm);
+
+    /**
+     * @brief Adds another histogram's counts to this one.
+     * @param other Histogram to merge.
+     */
+    void merge(const BpmHistogram &other);
+
+    /**
+     * @brief Gets the count of one bin.
+     * @param bin BPM value (0 to kBins - 1).
+     * @return long long Readings rounded to that BPM.
+     */
+    long long bin(int bin) const { return bins[bin]; }
+
+    /** @return long long Total number of readings. */
+    long long count() const { return total; }
+
+    /** @return bool True if no readings were added. */
+    bool empty() const { return total == 0; }
+
+    /**
+     * @brief Counts readings in a BPM range.
+     * @param low Inclusive lower BPM.
+     * @param high Exclusive upper BPM.
+     * @return long long Readings with low <= BPM < high.
+     */
+    long long countBetween(int low, int high) const;
+
+    /**
+     * @brief Splits the readings into training zones.
+     * @param maxHeartRate Maximum heart rate the zone boundaries are relative to.
+     * @return HeartRateZones Fraction of readings per zone (all zero if empty).
+     */
+    HeartRateZones zones(double maxHeartRate) const;
+
+    /**
+     * @brief Writes the non-empty bins as "bin:count" fields, each preceded by a comma.
+     * @param out Output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Parses fields produced by write().
+     * @param text Text starting at the first comma (may be empty).
+     * @return bool False if the text is malformed.
+     */
+    bool parse(const char *text);
+
+private:
+    std::uint32_t bins[kBins] = {}; /**< Readings per BPM. */
+    long long total = 0;            /**< Sum of all bins. */
+};
+
+/**
+ * @class DailyHistograms
+ * @brief One BpmHistogram per day, aligned to HeartRateRollup's day tier, plus a running lifetime total.
+ *
+ * Readings normally arrive in time order and go into the newest day in O(1); an out-of-order reading finds
+ * its day with a binary search.
+ */
+class DailyHistograms {
+public:
+    /**
+     * @brief One day's histogram.
+     */
+    struct Day {
+        long long start = 0;        /**< Day start (seconds since epoch, UTC). */
+        BpmHistogram histogram;     /**< Readings of that day. */
+    };
+
+    /**
+     * @brief Adds one reading.
+     * @param timestamp Seconds since epoch.
+     * @param bpm Heart rate in beats per minute.
+     */
+    void addReading(long long timestamp, double bpm);
+
+    /** @return const BpmHistogram& Every reading added. */
+    const BpmHistogram& total() const { return lifetime; }
+
+    /**
+     * @brief Merges the days that overlap a time range.
+     * @param from Inclusive range start (seconds since epoch).
+     * @param to Exclusive range end (seconds since epoch).
+     * @return BpmHistogram Combined histogram.
+     */
+    BpmHistogram range(long long from, long long to) const;
+
+    /** @return const std::vector<Day>& Non-empty days sorted by start. */
+    const std::vector<Day>& days() const { return dayHistograms; }
+
+    /**
+     * @brief Removes all days.
+     */
+    void clear();
+
+    /**
+     * @brief Writes a "histograms" section.
+     * @param out Output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads a section previously produced by write().
+     * @param in Input stream positioned at the "histograms" line.
+     * @return bool False if the section is missing or malformed.
+     */
+    bool read(std::istream &in);
+
+    /**
+     * @brief Writes only the days that readings at or after a given time can have touched.
+     * @param out Output stream.
+     * @param since Earliest timestamp added since the last write.
+     */
+    void writeChanges(std::ostream &out, long long since) const;
+
+    /**
+     * @brief Applies days previously produced by writeChanges(), replacing the ones they cover.
+     * @param in Input stream positioned at the "histograms" line.
+     * @return bool False if the section is malformed (the days are then in an unspecified state).
+     */
+    bool readChanges(std::istream &in);
+
+private:
+    std::vector<Day> dayHistograms; /**< Histograms per day. */
+    BpmHistogram lifetime;          /**< Merge of every day. */
+};
+
+#endif // BPMHISTOGRAM_H
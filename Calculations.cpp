@@ -13,87 +13,98 @@
  #include <iostream>
  #include "RandomNumberGenerator.h"
  #include "FamilyHealth.h"
+ #include "RiskModel.h"
  
  /**
-  * @brief Assesses heart health based on family health parameters and simulates sensor readings.
+  * @brief Gets the ranges simulated sensor readings are drawn from for a risk tier.
   *
-  * This function calculates a risk score based on various factors extracted from the 
-  * FamilyHealth object. It evaluates the age group, gender, sleep hours, exercise frequency,
-  * family disease history, diet type, and smoking status. The risk score is then used to 
-  * simulate sensor readings for heart rate, systolic blood pressure, diastolic blood pressure,
-  * cholesterol, and ECG using randomly generated values.
+  * @param tier 0 = Low, 1 = Moderate, 2 = High (out-of-range values are clamped).
   *
-  * The thresholds for risk score are used as follows:
-  * - Low risk: risk score < 10
-  * - Moderate risk: risk score >= 10 and < 18
-  * - High risk: risk score >= 18
+  * @return The tier's ranges.
+  */
+ const SimulatedVitalRanges& simulatedVitalRanges(int tier)
+ {
+     static const SimulatedVitalRanges ranges[3] = {
+         // Low risk
+         { { 60, 80 }, { 110, 120 }, { 70, 80 }, { 150, 200 }, { 0.05, 0.15 } },
+         // Moderate risk
+         { { 80, 95 }, { 120, 135 }, { 80, 90 }, { 200, 240 }, { 0.02, 0.18 } },
+         // High risk
+         { { 95, 120 }, { 135, 160 }, { 90, 110 }, { 240, 300 }, { -0.1, 0.3 } }
+     };
+     return ranges[tier < 0 ? 0 : (tier > 2 ? 2 : tier)];
+ }
+ 
+ /**
+  * @brief Computes the additive point score from raw survey answers.
   *
-  * @param[in] family A reference to a FamilyHealth object containing health-related information.
-  * @param[out] heartRate A reference to a double where the simulated heart rate will be stored.
-  * @param[out] sysBP A reference to a double where the simulated systolic blood pressure will be stored.
-  * @param[out] diasBP A reference to a double where the simulated diastolic blood pressure will be stored.
-  * @param[out] cholesterol A reference to a double where the simulated cholesterol level will be stored.
-  * @param[out] ecg A reference to a double where the simulated ECG reading will be stored.
+  * Each answer contributes points: age group, gender (by age), sleep hours, exercise frequency, each
+  * family disease, diet type and smoking status. See computeRiskScore(const FamilyHealth&) for the tiers.
   *
-  * @return A string describing the assessed risk level for heart disease.
+  * @param ageGroup Age group (1-6).
+  * @param male Gender assigned at birth (true: male).
+  * @param sleepHours Sleep selection (1-5).
+  * @param exerciseFrequency Exercise selection (1-4).
+  * @param familyHistory Bit i set if FamilyHealth disease i runs in the family.
+  * @param dietType Diet selection (1-6).
+  * @param smoker Smoking status.
   *
-  * @note The simulation ranges vary depending on the computed risk score.
+  * @return The risk score.
   */
- std::string assessHeartHealth(const FamilyHealth& family, double& heartRate,
-     double& sysBP, double& diasBP,
-     double& cholesterol, double& ecg)
+ int computeRiskScore(int ageGroup, bool male, int sleepHours, int exerciseFrequency,
+     unsigned familyHistory, int dietType, bool smoker)
  {
      int riskScore = 0;
      
      // 1) Age-based
-     if (family.getAgeGroup() == 1 || family.getAgeGroup() == 2)
+     if (ageGroup == 1 || ageGroup == 2)
          riskScore += 1;
-     else if (family.getAgeGroup() == 3 || family.getAgeGroup() == 4)
+     else if (ageGroup == 3 || ageGroup == 4)
          riskScore += 2;
      else
          riskScore += 3;
      
      // 2) Gender-based: interpret 'false' as Female and 'true' as Male.
-     if (!family.getGender())  // false => Female
+     if (!male)  // false => Female
      {
-         if (family.getAgeGroup() <= 3)
+         if (ageGroup <= 3)
              riskScore += 1;
          else
              riskScore += 3;
      }
      else // Male
      {
-         if (family.getAgeGroup() <= 3)
+         if (ageGroup <= 3)
              riskScore += 2;
          else
              riskScore += 3;
      }
      
      // 3) Sleep Hours: e.g. 1 => <4 hrs => +3, 2 => 4-5 hrs => +2, 3 => 6-7 hrs => +1, 4 => 7-8 hrs => +1, 5 => >8 hrs => +3
-     if (family.getSleepHours() == 1 || family.getSleepHours() == 5)
+     if (sleepHours == 1 || sleepHours == 5)
          riskScore += 3;
-     else if (family.getSleepHours() == 2)
+     else if (sleepHours == 2)
          riskScore += 2;
      else
          riskScore += 1;
      
      // 4) Exercise Frequency: e.g. 1 => never => +3, 2 => 1-2/wk => +2, else => +1
-     if (family.getExerciseFrequency() == 1)
+     if (exerciseFrequency == 1)
          riskScore += 3;
-     else if (family.getExerciseFrequency() == 2)
+     else if (exerciseFrequency == 2)
          riskScore += 2;
      else
          riskScore += 1;
      
      // 5) Family disease(s): If the user has multiple diseases, each adds to the score.
-     if (family.hasFamilyDisease(0)) riskScore += 2; // Heart disease
-     if (family.hasFamilyDisease(1)) riskScore += 1; // Diabetes
-     if (family.hasFamilyDisease(2)) riskScore += 2; // High cholesterol
-     if (family.hasFamilyDisease(3)) riskScore += 2; // High blood pressure
+     if (familyHistory & 1u) riskScore += 2; // Heart disease
+     if (familyHistory & 2u) riskScore += 1; // Diabetes
+     if (familyHistory & 4u) riskScore += 2; // High cholesterol
+     if (familyHistory & 8u) riskScore += 2; // High blood pressure
      
      // 6) Diet type:
      // 1 = High Protein, 2 = Low Carb, 3 = Vegetarian, 4 = Western, 5 = Vegan, 6 = Balanced
-     int dt = family.getDietType();
+     int dt = dietType;
      if (dt == 4) // Western
          riskScore += 3;
      else if (dt == 1 || dt == 2 || dt == 3 || dt == 6)
@@ -102,42 +113,99 @@
          riskScore += 2;
      
      // 7) Smoking
-     if (family.getIsSmoker())
+     if (smoker)
          riskScore += 3;
      else
          riskScore += 1;
      
+     return riskScore;
+ }
+ 
+ /**
+  * @brief Computes the additive point score for a FamilyHealth object.
+  *
+  * Tiers: Low below 10, Moderate from 10 to 17, High from 18.
+  *
+  * @param[in] family A reference to a FamilyHealth object containing health-related information.
+  *
+  * @return The risk score.
+  */
+ int computeRiskScore(const FamilyHealth& family)
+ {
+     unsigned history = 0;
+     for (int i = 0; i < 4; ++i)
+         if (family.hasFamilyDisease(i)) history |= 1u << i;
+     return computeRiskScore(family.getAgeGroup(), family.getGender(), family.getSleepHours(),
+                             family.getExerciseFrequency(), history, family.getDietType(), family.getIsSmoker());
+ }
+ 
+ /**
+  * @brief Maps a point score to its risk tier.
+  *
+  * @param score Point score.
+  *
+  * @return 0 (Low), 1 (Moderate) or 2 (High).
+  */
+ int riskTierOf(int score)
+ {
+     return score >= 18 ? 2 : (score >= 10 ? 1 : 0);
+ }
+ 
+ /**
+  * @brief Assesses heart health based on family health parameters and simulates sensor readings.
+  *
+  * This function calculates a risk score based on various factors extracted from the 
+  * FamilyHealth object. It evaluates the age group, gender, sleep hours, exercise frequency,
+  * family disease history, diet type, and smoking status. The risk score is then used to 
+  * simulate sensor readings for heart rate, systolic blood pressure, diastolic blood pressure,
+  * cholesterol, and ECG using randomly generated values.
+  *
+  * The thresholds for risk score are used as follows:
+  * - Low risk: risk score < 10
+  * - Moderate risk: risk score >= 10 and < 18
+  * - High risk: risk score >= 18
+  *
+  * @param[in] family A reference to a FamilyHealth object containing health-related information.
+  * @param[out] heartRate A reference to a double where the simulated heart rate will be stored.
+  * @param[out] sysBP A reference to a double where the simulated systolic blood pressure will be stored.
+  * @param[out] diasBP A reference to a double where the simulated diastolic blood pressure will be stored.
+  * @param[out] cholesterol A reference to a double where the simulated cholesterol level will be stored.
+  * @param[out] ecg A reference to a double where the simulated ECG reading will be stored.
+  * @param[in] model Optional trained logistic model; when given, its probability and cut-offs decide the tier
+  *                  instead of the point thresholds.
+  *
+  * @return A string describing the assessed risk level for heart disease.
+  *
+  * @note The simulation ranges vary depending on the computed risk score.
+  */
+ std::string assessHeartHealth(const FamilyHealth& family, double& heartRate,
+     double& sysBP, double& diasBP,
+     double& cholesterol, double& ecg,
+     const LogisticRiskModel* model)
+ {
+     int riskScore = computeRiskScore(family);
+     
      // Print riskScore for debugging
      std::cout << "Risk Score: " << riskScore << std::endl;
      
-     // Simulate sensor readings based on risk score
-     if (riskScore < 10) {
-         // Low risk
-         heartRate   = RandomNumberGenerator(60,  80).generate();
-         sysBP       = RandomNumberGenerator(110, 120).generate();
-         diasBP      = RandomNumberGenerator(70, 80).generate();
-         cholesterol = RandomNumberGenerator(150, 200).generate();
-         ecg         = RandomNumberGenerator(0.05, 0.15).generate();
-     } else if (riskScore < 18) {
-         // Moderate risk
-         heartRate   = RandomNumberGenerator(80, 95).generate();
-         sysBP       = RandomNumberGenerator(120, 135).generate();
-         diasBP      = RandomNumberGenerator(80, 90).generate();
-         cholesterol = RandomNumberGenerator(200, 240).generate();
-         ecg         = RandomNumberGenerator(0.02, 0.18).generate();
-     } else {
-         // High risk
-         heartRate   = RandomNumberGenerator(95, 120).generate();
-         sysBP       = RandomNumberGenerator(135, 160).generate();
-         diasBP      = RandomNumberGenerator(90, 110).generate();
-         cholesterol = RandomNumberGenerator(240, 300).generate();
-         ecg         = RandomNumberGenerator(-0.1, 0.3).generate();
+     // 0 = Low, 1 = Moderate, 2 = High; the point system is the baseline unless a trained model is given.
+     int tier = riskTierOf(riskScore);
+     if (model) {
+         tier = model->tierOf(model->probability(family));
      }
      
+     // Simulate sensor readings based on risk tier
+     const SimulatedVitalRanges& ranges = simulatedVitalRanges(tier);
+     heartRate   = RandomNumberGenerator(ranges.heartRate[0], ranges.heartRate[1]).generate();
+     sysBP       = RandomNumberGenerator(ranges.sysBP[0], ranges.sysBP[1]).generate();
+     diasBP      = RandomNumberGenerator(ranges.diasBP[0], ranges.diasBP[1]).generate();
+     cholesterol = RandomNumberGenerator(ranges.cholesterol[0], ranges.cholesterol[1]).generate();
+     ecg         = RandomNumberGenerator(ranges.ecg[0], ranges.ecg[1]).generate();
+     
      // Final risk assessment
-     if (riskScore >= 18) 
+     if (tier == 2) 
          return "High risk of heart disease.";
-     else if (riskScore >= 10)
+     else if (tier == 1)
          return "Moderate risk of heart disease.";
      else
          return "Low risk of heart disease. You are healthy!";
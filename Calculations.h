@@ -15,6 +15,62 @@
 #include "FamilyHealth.h"
 #include <string>
 
+class LogisticRiskModel;
+
+/**
+ * @brief Ranges (minimum, maximum) the simulated sensor readings are drawn from for one risk tier.
+ */
+struct SimulatedVitalRanges {
+    double heartRate[2];    /**< Heart rate (BPM). */
+    double sysBP[2];        /**< Systolic blood pressure (mmHg). */
+    double diasBP[2];       /**< Diastolic blood pressure (mmHg). */
+    double cholesterol[2];  /**< Cholesterol (mg/dL). */
+    double ecg[2];          /**< ECG reading. */
+};
+
+/**
+ * @brief Gets the ranges simulated sensor readings are drawn from for a risk tier.
+ *
+ * @param tier 0 = Low, 1 = Moderate, 2 = High (out-of-range values are clamped).
+ *
+ * @return The tier's ranges.
+ */
+const SimulatedVitalRanges& simulatedVitalRanges(int tier);
+
+/**
+ * @brief Computes the additive point score from raw survey answers.
+ *
+ * @param ageGroup Age group (1-6).
+ * @param male Gender assigned at birth (true: male).
+ * @param sleepHours Sleep selection (1-5).
+ * @param exerciseFrequency Exercise selection (1-4).
+ * @param familyHistory Bit i set if FamilyHealth disease i runs in the family.
+ * @param dietType Diet selection (1-6).
+ * @param smoker Smoking status.
+ *
+ * @return The risk score (Low below 10, Moderate below 18, otherwise High).
+ */
+int computeRiskScore(int ageGroup, bool male, int sleepHours, int exerciseFrequency,
+                     unsigned familyHistory, int dietType, bool smoker);
+
+/**
+ * @brief Computes the additive point score for a FamilyHealth object.
+ *
+ * @param[in] family A reference to a FamilyHealth object containing the user's health data.
+ *
+ * @return The risk score (Low below 10, Moderate below 18, otherwise High).
+ */
+int computeRiskScore(const FamilyHealth& family);
+
+/**
+ * @brief Maps a point score to its risk tier.
+ *
+ * @param score Point score from computeRiskScore().
+ *
+ * @return 0 (Low) below 10, 1 (Moderate) below 18, otherwise 2 (High).
+ */
+int riskTierOf(int score);
+
 /**
  * @brief Assesses heart health and simulates sensor readings.
  *
@@ -34,12 +90,15 @@
  * @param[out] diasBP A reference to a double where the simulated diastolic blood pressure will be stored.
  * @param[out] cholesterol A reference to a double where the simulated cholesterol level will be stored.
  * @param[out] ecg A reference to a double where the simulated ECG reading will be stored.
+ * @param[in] model Optional trained logistic model (see RiskModel.h). When given, its probability and cut-offs
+ *                  choose the tier; otherwise the point system above is used as the baseline.
  *
  * @return A string message representing the assessed risk of heart disease.
  *
  * @note The simulated sensor readings are based on predefined ranges corresponding to low, moderate,
  * and high risk scores.
  */
-std::string assessHeartHealth(const FamilyHealth& family, double& heartRate, double& sysBP, double& diasBP, double& cholesterol, double& ecg);
+std::string assessHeartHealth(const FamilyHealth& family, double& heartRate, double& sysBP, double& diasBP, double& cholesterol, double& ecg,
+                              const LogisticRiskModel* model = nullptr);
 
 #endif // CALCULATIONS_H
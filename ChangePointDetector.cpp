@@ -0,0 +1,239 @@
+/**
+ * @file ChangePointDetector.cpp
+ * @brief Implements PELT segmentation and coarse-to-fine refinement over the rollup tiers.
+ *
+ * PELT (Killick et al., 2012) finds the exact penalised least-squares segmentation while discarding split
+ * candidates that can never become optimal again, which keeps it close to linear on data with real changes.
+ */
+
+#include "ChangePointDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double kMinSigma = 1.0;   // BPM; differences smaller than this are not clinically meaningful
+
+/**
+ * @brief Reading count and BPM sum of a run of buckets.
+ */
+struct Aggregate {
+    long long count = 0;
+    double sum = 0.0;
+
+    void add(const RollupBucket &b) { count += b.count; sum += b.sum; }
+    void add(const Aggregate &a) { count += a.count; sum += a.sum; }
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+    double score() const { return count > 0 ? sum * sum / count : 0.0; }
+};
+
+/**
+ * @brief Estimates the noise level of a sequence from the median absolute first difference.
+ *
+ * Differencing removes the level shifts themselves, and the median ignores the few differences that span a
+ * change, so sigma is not inflated by the changes we are trying to find.
+ *
+ * @param values Observations.
+ * @return double Robust standard deviation estimate.
+ */
+double robustSigma(const std::vector<double> &values) {
+    if (values.size() < 2) return kMinSigma;
+    std::vector<double> diffs(values.size() - 1);
+    for (std::size_t i = 1; i < values.size(); ++i) diffs[i - 1] = std::fabs(values[i] - values[i - 1]);
+    std::nth_element(diffs.begin(), diffs.begin() + diffs.size() / 2, diffs.end());
+    double mad = diffs[diffs.size() / 2];
+    // MAD / 0.6745 estimates the sd of the differences, which is sqrt(2) times the sd of the values.
+    return std::fmax(mad / (0.6745 * std::sqrt(2.0)), kMinSigma);
+}
+
+/**
+ * @brief Finds the buckets of a tier whose start lies in [from, to).
+ * @param buckets Tier buckets sorted by start.
+ * @param from Inclusive start.
+ * @param to Exclusive end.
+ * @param[out] first Index of the first bucket in range.
+ * @return std::size_t Number of buckets in range.
+ */
+std::size_t bucketRange(const std::vector<RollupBucket> &buckets, long long from, long long to, std::size_t &first) {
+    auto cmp = [](const RollupBucket &b, long long s) { return b.start < s; };
+    auto lo = std::lower_bound(buckets.begin(), buckets.end(), from, cmp);
+    auto hi = std::lower_bound(lo, buckets.end(), to, cmp);
+    first = static_cast<std::size_t>(lo - buckets.begin());
+    return static_cast<std::size_t>(hi - lo);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a new ChangePointDetector object.
+ * @param penaltyScale Multiplier on the default penalty.
+ * @param minSegmentBuckets Minimum segment length in coarse buckets.
+ */
+ChangePointDetector::ChangePointDetector(double penaltyScale, int minSegmentBuckets)
+    : penaltyScale(penaltyScale), minSegment(std::max(1, minSegmentBuckets)) {}
+
+/**
+ * @brief Runs PELT over a sequence of means.
+ *
+ * F(t) = min over s of F(s) + C(s, t) + penalty, where C is the within-segment sum of squared deviations
+ * computed in O(1) from prefix sums. After F(t) is known, any s with F(s) + C(s, t) > F(t) is pruned.
+ *
+ * @param means Observations.
+ * @param penalty Cost added per segment.
+ * @return std::vector<int> Indices where new segments start (excluding 0), ascending.
+ */
+std::vector<int> ChangePointDetector::pelt(const std::vector<double> &means, double penalty) const {
+    const int n = static_cast<int>(means.size());
+    std::vector<int> changes;
+    if (n < 2 * minSegment) return changes;
+
+    std::vector<double> s1(n + 1, 0.0), s2(n + 1, 0.0);
+    for (int i = 0; i < n; ++i) {
+        s1[i + 1] = s1[i] + means[i];
+        s2[i + 1] = s2[i] + means[i] * means[i];
+    }
+    auto cost = [&](int s, int t) {
+        double sum = s1[t] - s1[s];
+        return (s2[t] - s2[s]) - sum * sum / (t - s);
+    };
+
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> best(n + 1, inf);
+    std::vector<int> previous(n + 1, 0);
+    best[0] = -penalty;
+
+    std::vector<int> candidates;
+    std::vector<int> kept;
+    for (int t = minSegment; t <= n; ++t) {
+        // s becomes admissible once it can close a minimum-length segment ending at t.
+        int admissible = t - minSegment;
+        if (admissible == 0 || admissible >= minSegment) candidates.push_back(admissible);
+
+        double bestCost = inf;
+        int bestStart = 0;
+        for (int s : candidates) {
+            double c = best[s] + cost(s, t) + penalty;
+            if (c < bestCost) {
+                bestCost = c;
+                bestStart = s;
+            }
+        }
+        best[t] = bestCost;
+        previous[t] = bestStart;
+
+        kept.clear();
+        for (int s : candidates) {
+            if (best[s] + cost(s, t) <= bestCost) kept.push_back(s);
+        }
+        candidates.swap(kept);
+    }
+
+    for (int t = previous[n]; t > 0; t = previous[t]) changes.push_back(t);
+    std::reverse(changes.begin(), changes.end());
+    return changes;
+}
+
+/**
+ * @brief Detects level shifts, choosing the coarse tier automatically.
+ * @param rollup The user's rollup tiers.
+ * @return std::vector<ChangePoint> Change points in time order.
+ */
+std::vector<ChangePoint> ChangePointDetector::detect(const HeartRateRollup &rollup) const {
+    for (int t = HeartRateRollup::kTierCount - 1; t >= 0; --t) {
+        HeartRateRollup::Tier tier = static_cast<HeartRateRollup::Tier>(t);
+        if (rollup.buckets(tier).size() >= static_cast<std::size_t>(2 * minSegment))
+            return detect(rollup, tier, HeartRateRollup::Minute);
+    }
+    return std::vector<ChangePoint>();
+}
+
+/**
+ * @brief Detects level shifts on a given coarse tier and refines them down to a finer tier.
+ *
+ * Refinement keeps the rest of both coarse segments fixed and moves the boundary within the two coarse
+ * buckets on either side of it, choosing the fine split that minimises the reading-weighted squared error
+ * (equivalently, maximises S_L^2 / N_L + S_R^2 / N_R). The chosen fine bucket and its left neighbour then
+ * form the search window at the next finer tier.
+ *
+ * @param rollup The user's rollup tiers.
+ * @param coarse Tier that PELT runs on.
+ * @param fine Finest tier used for refinement.
+ * @return std::vector<ChangePoint> Change points in time order.
+ */
+std::vector<ChangePoint> ChangePointDetector::detect(const HeartRateRollup &rollup,
+                                                     HeartRateRollup::Tier coarse,
+                                                     HeartRateRollup::Tier fine) const {
+    std::vector<ChangePoint> points;
+    const std::vector<RollupBucket> &buckets = rollup.buckets(coarse);
+    if (fine > coarse) fine = coarse;
+
+    std::vector<double> means(buckets.size());
+    for (std::size_t i = 0; i < buckets.size(); ++i) means[i] = buckets[i].mean();
+
+    double sigma = robustSigma(means);
+    double penalty = penaltyScale * 2.0 * sigma * sigma * std::log(std::max<std::size_t>(means.size(), 2));
+    std::vector<int> changes = pelt(means, penalty);
+    if (changes.empty()) return points;
+
+    std::vector<int> bounds;
+    bounds.push_back(0);
+    bounds.insert(bounds.end(), changes.begin(), changes.end());
+    bounds.push_back(static_cast<int>(buckets.size()));
+
+    for (std::size_t c = 1; c + 1 < bounds.size(); ++c) {
+        int segStart = bounds[c - 1];
+        int j = bounds[c];
+        int segEnd = bounds[c + 1];
+
+        Aggregate before, after, outerLeft, outerRight;
+        for (int i = segStart; i < j; ++i) before.add(buckets[i]);
+        for (int i = j; i < segEnd; ++i) after.add(buckets[i]);
+        for (int i = segStart; i < j - 1; ++i) outerLeft.add(buckets[i]);
+        for (int i = j + 1; i < segEnd; ++i) outerRight.add(buckets[i]);
+
+        long long boundary = buckets[j].start;
+        long long windowFrom = buckets[j - 1].start;
+        long long windowTo = buckets[j].start + HeartRateRollup::tierSeconds(coarse);
+
+        for (int t = coarse - 1; t >= fine; --t) {
+            HeartRateRollup::Tier tier = static_cast<HeartRateRollup::Tier>(t);
+            const std::vector<RollupBucket> &finer = rollup.buckets(tier);
+            std::size_t first = 0;
+            std::size_t m = bucketRange(finer, windowFrom, windowTo, first);
+            if (m < 2) break;
+
+            Aggregate window;
+            for (std::size_t i = 0; i < m; ++i) window.add(finer[first + i]);
+
+            // Scan split positions k = 1..m-1: left gets finer[first, first + k).
+            Aggregate left = outerLeft;
+            std::size_t bestSplit = 1;
+            double bestScore = -1.0;
+            for (std::size_t k = 1; k < m; ++k) {
+                left.add(finer[first + k - 1]);
+                Aggregate right = outerRight;
+                right.count += (outerLeft.count + window.count) - left.count;
+                right.sum += (outerLeft.sum + window.sum) - left.sum;
+                double score = left.score() + right.score();
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestSplit = k;
+                }
+            }
+
+            for (std::size_t i = 0; i + 1 < bestSplit; ++i) outerLeft.add(finer[first + i]);
+            for (std::size_t i = bestSplit + 1; i < m; ++i) outerRight.add(finer[first + i]);
+            boundary = finer[first + bestSplit].start;
+            windowFrom = finer[first + bestSplit - 1].start;
+            windowTo = boundary + HeartRateRollup::tierSeconds(tier);
+        }
+
+        ChangePoint point;
+        point.timestamp = boundary;
+        point.meanBefore = before.mean();
+        point.meanAfter = after.mean();
+        points.push_back(point);
+    }
+    return points;
+}
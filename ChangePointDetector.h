@@ -0,0 +1,83 @@
+#ifndef CHANGEPOINTDETECTOR_H
+#define CHANGEPOINTDETECTOR_H
+
+/**
+ * @file ChangePointDetector.h
+ * @brief Declaration of the offline (retrospective) heart-rate change-point detector.
+ *
+ * This header declares a detector that answers "when did this patient's heart rate level shift?" over
+ * months of history. It segments the coarse rollup tier with PELT and then refines each boundary through the
+ * finer tiers, touching fine buckets only next to candidate change points.
+ */
+
+#include "HeartRateRollup.h"
+#include <vector>
+
+/**
+ * @brief A detected shift in mean heart rate.
+ */
+struct ChangePoint {
+    long long timestamp = 0;    /**< Start of the first fine bucket after the shift (seconds since epoch). */
+    double meanBefore = 0.0;    /**< Mean BPM of the segment before the shift. */
+    double meanAfter = 0.0;     /**< Mean BPM of the segment after the shift. */
+
+    /** @return double Size of the shift in BPM (positive when the rate went up). */
+    double shift() const { return meanAfter - meanBefore; }
+};
+
+/**
+ * @class ChangePointDetector
+ * @brief PELT segmentation of rollup bucket means with coarse-to-fine refinement.
+ *
+ * Each coarse bucket mean is one observation. The noise level is estimated robustly from the median absolute
+ * first difference, and the per-change penalty is penaltyScale * 2 * sigma^2 * ln(n). A boundary between
+ * coarse buckets j-1 and j is then moved to the finer tier by searching only the fine buckets inside those two
+ * coarse buckets, and so on down to the finest requested tier. A year of minute data (about 525,000 buckets)
+ * therefore costs a PELT pass over 365 day means plus a few hundred fine buckets per change point.
+ */
+class ChangePointDetector {
+private:
+    double penaltyScale;        /**< Multiplier on the BIC-style penalty; larger values report fewer changes. */
+    int minSegment;             /**< Minimum segment length in coarse buckets. */
+
+    /**
+     * @brief Runs PELT over a sequence of means.
+     * @param means Observations.
+     * @param penalty Cost added per segment.
+     * @return std::vector<int> Indices where new segments start (excluding 0), ascending.
+     */
+    std::vector<int> pelt(const std::vector<double> &means, double penalty) const;
+
+public:
+    /**
+     * @brief Constructs a new ChangePointDetector object.
+     * @param penaltyScale Multiplier on the default penalty (1.0 is BIC-like).
+     * @param minSegmentBuckets Minimum segment length in coarse buckets.
+     */
+    explicit ChangePointDetector(double penaltyScale = 1.0, int minSegmentBuckets = 3);
+
+    /**
+     * @brief Detects level shifts, choosing the coarse tier automatically.
+     *
+     * Uses the coarsest tier that still has enough buckets to hold two minimum-length segments, so months of
+     * history are segmented by day and a short history by hour or minute. Change points older than the
+     * minute tier's retention are refined to the hour only.
+     *
+     * @param rollup The user's rollup tiers.
+     * @return std::vector<ChangePoint> Change points in time order.
+     */
+    std::vector<ChangePoint> detect(const HeartRateRollup &rollup) const;
+
+    /**
+     * @brief Detects level shifts on a given coarse tier and refines them down to a finer tier.
+     * @param rollup The user's rollup tiers.
+     * @param coarse Tier that PELT runs on.
+     * @param fine Finest tier used for refinement (must not be coarser than coarse).
+     * @return std::vector<ChangePoint> Change points in time order.
+     */
+    std::vector<ChangePoint> detect(const HeartRateRollup &rollup,
+                                    HeartRateRollup::Tier coarse,
+                                    HeartRateRollup::Tier fine) const;
+};
+
+#endif // CHANGEPOINTDETECTOR_H
@@ -0,0 +1,73 @@
+/**
+ * @file EcgBeatDetector.cpp
+ * @brief Implements the EcgBeatDetector class for windowed heart rate from a raw ECG stream.
+ */
+
+#include "EcgBeatDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+const std::int64_t EcgBeatDetector::kRefractoryUs;
+const int EcgBeatDetector::kMinSlope;
+
+/**
+ * @brief Constructs a detector.
+ * @param windowSeconds Length of the window each heart rate covers.
+ */
+EcgBeatDetector::EcgBeatDetector(double windowSeconds)
+    : windowUs(static_cast<std::int64_t>(windowSeconds * 1e6)) {
+    if (windowUs < 2 * kRefractoryUs) windowUs = 2 * kRefractoryUs;
+}
+
+/**
+ * @brief Feeds consecutive samples, closing a window whenever its length has been covered.
+ * @param samples The samples.
+ * @param count Number of samples.
+ * @param interval Microseconds between samples.
+ * @return int Windows completed by this call.
+ */
+int EcgBeatDetector::add(const std::int16_t *samples, std::size_t count, std::uint32_t interval) {
+    if (interval == 0) return 0;
+    const double decay = std::pow(0.5, interval / 2e6);
+    int completed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        int slope = std::abs(samples[i] - previous);
+        previous = samples[i];
+        clock += interval;
+        sinceBeat += interval;
+        if (!primed) {
+            primed = true;
+            continue;
+        }
+        level = std::max(level * decay, static_cast<double>(slope));
+        if (slope >= kMinSlope && slope > 0.5 * level && sinceBeat >= kRefractoryUs) {
+            if (firstBeat < 0) firstBeat = clock;
+            lastBeat = clock;
+            ++beats;
+            sinceBeat = 0;
+        }
+        if (clock >= windowUs) {
+            double bpm = beats >= 2 ? 60e6 * (beats - 1) / (lastBeat - firstBeat) : 0.0;
+            lastBpm = bpm >= 20.0 && bpm <= 240.0 ? bpm : 0.0;
+            clock = 0;
+            firstBeat = lastBeat = -1;
+            beats = 0;
+            ++completed;
+        }
+    }
+    return completed;
+}
+
+/**
+ * @brief Forgets the signal seen so far.
+ */
+void EcgBeatDetector::reset() {
+    clock = sinceBeat = 0;
+    firstBeat = lastBeat = -1;
+    beats = 0;
+    level = 0.0;
+    previous = 0;
+    primed = false;
+    lastBpm = 0.0;
+}
@@ -0,0 +1,71 @@
+#ifndef ECGBEATDETECTOR_H
+#define ECGBEATDETECTOR_H
+
+/**
+ * @file EcgBeatDetector.h
+ * @brief Declaration of the EcgBeatDetector class.
+ *
+ * This header declares a streaming R-peak detector that turns a raw ECG sample stream, as carried by
+ * SampleBus, into one heart rate per fixed-length window, so high-rate device streams can be stored as
+ * ordinary readings.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class EcgBeatDetector
+ * @brief Counts R peaks in a 16-bit ECG stream and reports the mean heart rate of each window.
+ *
+ * The QRS complex is the steepest part of the ECG, so a beat is taken where the absolute slope between
+ * consecutive samples exceeds half of a peak level that decays by half every two seconds. A refractory
+ * period of 250 ms (240 BPM) keeps one complex from counting twice. The rate of a window is measured from
+ * the spacing of its first and last beats, so a window needs at least two beats to report one.
+ *
+ * Work is O(1) per sample and the state is a handful of numbers, so one detector per stream is cheap.
+ */
+class EcgBeatDetector {
+public:
+    /**
+     * @brief Constructs a detector.
+     * @param windowSeconds Length of the window each heart rate covers.
+     */
+    explicit EcgBeatDetector(double windowSeconds = 60.0);
+
+    /**
+     * @brief Feeds consecutive samples.
+     * @param samples The samples.
+     * @param count Number of samples.
+     * @param interval Microseconds between samples.
+     * @return int Windows completed by this call; the last one's rate is available via windowBpm().
+     */
+    int add(const std::int16_t *samples, std::size_t count, std::uint32_t interval);
+
+    /**
+     * @brief Gets the heart rate of the last completed window.
+     * @return double Beats per minute, or 0 if the window had fewer than two beats or an implausible rate.
+     */
+    double windowBpm() const { return lastBpm; }
+
+    /**
+     * @brief Forgets the signal seen so far, e.g. after samples were lost.
+     */
+    void reset();
+
+private:
+    static const std::int64_t kRefractoryUs = 250000;   /**< Shortest beat-to-beat interval. */
+    static const int kMinSlope = 8;                     /**< Slope below which no beat is taken (ADC units). */
+
+    std::int64_t windowUs;          /**< Window length in microseconds. */
+    std::int64_t clock = 0;         /**< Microseconds into the current window. */
+    std::int64_t sinceBeat = 0;     /**< Microseconds since the last beat. */
+    std::int64_t firstBeat = -1;    /**< Window time of its first beat (-1: none yet). */
+    std::int64_t lastBeat = -1;     /**< Window time of its last beat. */
+    int beats = 0;                  /**< Beats in the current window. */
+    double level = 0.0;             /**< Decaying peak of the absolute slope. */
+    int previous = 0;               /**< Last sample seen. */
+    bool primed = false;            /**< A previous sample exists. */
+    double lastBpm = 0.0;           /**< Rate of the last completed window. */
+};
+
+#endif // ECGBEATDETECTOR_H
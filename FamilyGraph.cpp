@@ -0,0 +1,488 @@
+/**
+ * @file FamilyGraph.cpp
+ * @brief Implements the CSR pedigree graph and its batched and incremental inherited-risk propagation.
+ */
+
+#include "FamilyGraph.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const float kRelatedness[FamilyGraph::kMaxDegree + 1] = {1.0f, 0.5f, 0.25f, 0.125f};
+
+/**
+ * @brief Gets the reverse of a relation.
+ * @param relation What B is to A.
+ * @return FamilyGraph::Relation What A is to B.
+ */
+FamilyGraph::Relation inverse(FamilyGraph::Relation relation) {
+    switch (relation) {
+    case FamilyGraph::Parent: return FamilyGraph::Child;
+    case FamilyGraph::Child: return FamilyGraph::Parent;
+    default: return FamilyGraph::Sibling;
+    }
+}
+
+/**
+ * @brief Splits a CSV line into trimmed fields.
+ * @param line The line.
+ * @return std::vector<std::string> Fields.
+ */
+std::vector<std::string> splitFields(const std::string &line) {
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        std::size_t first = field.find_first_not_of(" \t\r");
+        std::size_t last = field.find_last_not_of(" \t\r");
+        fields.push_back(first == std::string::npos ? std::string() : field.substr(first, last - first + 1));
+    }
+    return fields;
+}
+
+} // namespace
+
+/**
+ * @brief Adds an account, or finds it if it already exists.
+ * @param user Username.
+ * @return std::uint32_t Account id.
+ */
+std::uint32_t FamilyGraph::addAccount(const std::string &user) {
+    auto it = ids.find(user);
+    if (it != ids.end()) return it->second;
+    std::uint32_t id = static_cast<std::uint32_t>(names.size());
+    ids.emplace(user, id);
+    names.push_back(user);
+    conditions.push_back(0);
+    risks.emplace_back();
+    return id;
+}
+
+/**
+ * @brief Looks up an account.
+ * @param user Username.
+ * @return long long Account id, or -1.
+ */
+long long FamilyGraph::find(const std::string &user) const {
+    auto it = ids.find(user);
+    return it == ids.end() ? -1 : static_cast<long long>(it->second);
+}
+
+/**
+ * @brief Calls a function for every current neighbour of a node: live CSR edges, then the overlay.
+ * @param node Account id.
+ * @param visit Called with each Edge.
+ */
+template <typename Visit>
+void FamilyGraph::forEachNeighbour(std::uint32_t node, Visit visit) const {
+    if (node + 1 < offsets.size()) {
+        for (std::uint32_t e = offsets[node]; e < offsets[node + 1]; ++e)
+            if (!removed[e]) visit(edges[e]);
+    }
+    if (!added.empty()) {
+        auto it = added.find(node);
+        if (it != added.end())
+            for (const Edge &edge : it->second) visit(edge);
+    }
+}
+
+/**
+ * @brief Finds the edge between two nodes.
+ * @param from Source id.
+ * @param to Target id.
+ * @return bool True if linked.
+ */
+bool FamilyGraph::linked(std::uint32_t from, std::uint32_t to) const {
+    bool found = false;
+    forEachNeighbour(from, [&](const Edge &edge) { found = found || edge.target == to; });
+    return found;
+}
+
+/**
+ * @brief Links two accounts, adding them if needed.
+ * @param user Username.
+ * @param relative The relative's username.
+ * @param relation What the relative is to the user.
+ * @return bool False if they are the same account or already linked.
+ */
+bool FamilyGraph::link(const std::string &user, const std::string &relative, Relation relation) {
+    std::uint32_t a = addAccount(user);
+    std::uint32_t b = addAccount(relative);
+    if (a == b || linked(a, b)) return false;
+    Edge forward;
+    forward.target = b;
+    forward.relation = relation;
+    Edge backward;
+    backward.target = a;
+    backward.relation = inverse(relation);
+    added[a].push_back(forward);
+    added[b].push_back(backward);
+    pendingEdits += 2;
+    ++links;
+    // Everyone within range of either end after the link is exactly who gains a relative.
+    rescore(neighbourhood({a, b}));
+    if (pendingEdits > edges.size() / 8 + 64) compact();
+    return true;
+}
+
+/**
+ * @brief Removes the link between two accounts.
+ * @param user Username.
+ * @param relative The relative's username.
+ * @return bool False if they were not linked.
+ */
+bool FamilyGraph::unlink(const std::string &user, const std::string &relative) {
+    long long a = find(user);
+    long long b = find(relative);
+    if (a < 0 || b < 0 || !linked(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b))) return false;
+    // Collected before the edge goes, since afterwards part of the family may be out of reach.
+    std::vector<std::uint32_t> affected = computed ? neighbourhood({static_cast<std::uint32_t>(a),
+                                                                    static_cast<std::uint32_t>(b)})
+                                                   : std::vector<std::uint32_t>();
+    auto drop = [this](std::uint32_t from, std::uint32_t to) {
+        if (from + 1 < offsets.size()) {
+            for (std::uint32_t e = offsets[from]; e < offsets[from + 1]; ++e) {
+                if (!removed[e] && edges[e].target == to) {
+                    removed[e] = 1;
+                    ++pendingEdits;
+                    return;
+                }
+            }
+        }
+        std::vector<Edge> &list = added[from];
+        list.erase(std::remove_if(list.begin(), list.end(), [to](const Edge &edge) { return edge.target == to; }),
+                   list.end());
+        if (list.empty()) added.erase(from);
+    };
+    drop(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b));
+    drop(static_cast<std::uint32_t>(b), static_cast<std::uint32_t>(a));
+    --links;
+    rescore(affected);
+    if (pendingEdits > edges.size() / 8 + 64) compact();
+    return true;
+}
+
+/**
+ * @brief Records the conditions an account holder has been diagnosed with.
+ * @param user Username (added if needed).
+ * @param mask Bit i set for FamilyHealth disease i.
+ */
+void FamilyGraph::setConditions(const std::string &user, std::uint8_t mask) {
+    std::uint32_t id = addAccount(user);
+    if (conditions[id] == mask) return;
+    conditions[id] = mask;
+    rescore(neighbourhood({id}));
+}
+
+/**
+ * @brief Folds pending edits into the CSR arrays.
+ */
+void FamilyGraph::compact() {
+    const std::size_t count = names.size();
+    std::vector<std::uint32_t> newOffsets(count + 1, 0);
+    for (std::uint32_t node = 0; node < count; ++node) {
+        std::uint32_t degree = 0;
+        forEachNeighbour(node, [&](const Edge &) { ++degree; });
+        newOffsets[node + 1] = newOffsets[node] + degree;
+    }
+    std::vector<Edge> newEdges(newOffsets[count]);
+    for (std::uint32_t node = 0; node < count; ++node) {
+        std::uint32_t next = newOffsets[node];
+        forEachNeighbour(node, [&](const Edge &edge) { newEdges[next++] = edge; });
+        std::sort(newEdges.begin() + newOffsets[node], newEdges.begin() + next,
+                  [](const Edge &x, const Edge &y) { return x.target < y.target; });
+    }
+    offsets.swap(newOffsets);
+    edges.swap(newEdges);
+    removed.assign(edges.size(), 0);
+    added.clear();
+    pendingEdits = 0;
+}
+
+/**
+ * @brief Collects the accounts within kMaxDegree links of some seeds, seeds included.
+ * @param seeds Account ids.
+ * @return std::vector<std::uint32_t> Ids.
+ */
+std::vector<std::uint32_t> FamilyGraph::neighbourhood(const std::vector<std::uint32_t> &seeds) const {
+    // Families are small, so a sorted list of visited ids beats a per-account scratch array here.
+    std::vector<std::uint32_t> visited(seeds);
+    std::sort(visited.begin(), visited.end());
+    visited.erase(std::unique(visited.begin(), visited.end()), visited.end());
+    std::vector<std::uint32_t> frontier(visited);
+    for (int depth = 0; depth < kMaxDegree && !frontier.empty(); ++depth) {
+        std::vector<std::uint32_t> next;
+        for (std::uint32_t node : frontier) {
+            forEachNeighbour(node, [&](const Edge &edge) {
+                if (!std::binary_search(visited.begin(), visited.end(), edge.target)) next.push_back(edge.target);
+            });
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        std::vector<std::uint32_t> merged;
+        merged.reserve(visited.size() + next.size());
+        std::merge(visited.begin(), visited.end(), next.begin(), next.end(), std::back_inserter(merged));
+        visited.swap(merged);
+        frontier.swap(next);
+    }
+    return visited;
+}
+
+/**
+ * @brief Walks an account's blood relatives breadth-first, closest first, up to kMaxDegree links away.
+ *
+ * A blood line climbs parent links, turns at most once (a sibling link, or the first child link), and then
+ * only descends child links. Each account is searched in both phases, climbing and descending, so depth
+ * holds two entries per account: one that arrives climbing may still reach cousins, one that arrives
+ * descending may not. Spouses and in-laws sit on paths that descend and then climb, which are never taken.
+ *
+ * @param node Account id.
+ * @param depth Scratch array, two entries per account, all -1 on entry and on exit.
+ * @param queue Scratch queue of account id * 2 + phase.
+ * @param visit Called once per relative with its id and link distance.
+ */
+template <typename Visit>
+void FamilyGraph::forEachBloodRelative(std::uint32_t node, std::vector<std::int8_t> &depth,
+                                       std::vector<std::uint32_t> &queue, Visit visit) const {
+    const std::uint32_t climbing = 0, descending = 1;
+    queue.clear();
+    queue.push_back(node * 2 + climbing);
+    depth[node * 2 + climbing] = 0;
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        std::uint32_t state = queue[head];
+        std::uint32_t current = state / 2;
+        int d = depth[state];
+        if (d == kMaxDegree) continue;
+        forEachNeighbour(current, [&](const Edge &edge) {
+            std::uint32_t phase;
+            if (edge.relation == Parent && state % 2 == climbing) phase = climbing;
+            else if (edge.relation == Child || (edge.relation == Sibling && state % 2 == climbing)) phase = descending;
+            else return;
+            std::uint32_t next = edge.target * 2 + phase;
+            if (depth[next] >= 0) return;
+            // First reached in either phase: this is the relative's shortest blood line.
+            if (depth[edge.target * 2] < 0 && depth[edge.target * 2 + 1] < 0)
+                visit(edge.target, d + 1);
+            depth[next] = static_cast<std::int8_t>(d + 1);
+            queue.push_back(next);
+        });
+    }
+    for (std::uint32_t visited : queue) depth[visited] = -1;
+}
+
+/**
+ * @brief Scores one account from its blood relatives within kMaxDegree links.
+ * @param node Account id.
+ * @param depth Scratch array, two entries per account, all -1 on entry and on exit.
+ * @param queue Scratch queue.
+ * @return InheritedRisk The account's risk.
+ */
+FamilyGraph::InheritedRisk FamilyGraph::score(std::uint32_t node, std::vector<std::int8_t> &depth,
+                                              std::vector<std::uint32_t> &queue) const {
+    InheritedRisk risk;
+    forEachBloodRelative(node, depth, queue, [&](std::uint32_t relative, int d) {
+        ++risk.relatives;
+        std::uint8_t mask = conditions[relative];
+        for (int i = 0; i < kDiseaseCount; ++i)
+            if (mask & (1u << i)) risk.disease[i] += kRelatedness[d];
+    });
+    return risk;
+}
+
+/**
+ * @brief Rescores some accounts after an edit (no-op before computeAll()).
+ * @param nodes Account ids.
+ */
+void FamilyGraph::rescore(const std::vector<std::uint32_t> &nodes) {
+    if (!computed || nodes.empty()) return;
+    // score() leaves the scratch all -1, so only accounts added since the last edit need initialising.
+    depthScratch.resize(names.size() * 2, -1);
+    for (std::uint32_t node : nodes) risks[node] = score(node, depthScratch, queueScratch);
+}
+
+/**
+ * @brief Scores every account, one family per work item.
+ * @param threads Worker threads (0: one per core).
+ */
+void FamilyGraph::computeAll(unsigned threads) {
+    compact();
+    const std::uint32_t count = static_cast<std::uint32_t>(names.size());
+    risks.assign(count, InheritedRisk());
+    computed = true;
+
+    // Families are the connected components, laid out one after another in memberStart/members.
+    std::vector<std::uint32_t> members;
+    std::vector<std::uint32_t> memberStart;
+    std::vector<std::uint8_t> seen(count, 0);
+    members.reserve(count);
+    for (std::uint32_t root = 0; root < count; ++root) {
+        if (seen[root]) continue;
+        memberStart.push_back(static_cast<std::uint32_t>(members.size()));
+        seen[root] = 1;
+        members.push_back(root);
+        for (std::size_t head = memberStart.back(); head < members.size(); ++head) {
+            std::uint32_t node = members[head];
+            for (std::uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                std::uint32_t target = edges[e].target;
+                if (!seen[target]) {
+                    seen[target] = 1;
+                    members.push_back(target);
+                }
+            }
+        }
+    }
+    memberStart.push_back(static_cast<std::uint32_t>(members.size()));
+    families = memberStart.size() - 1;
+    if (families == 0) return;
+
+    unsigned threadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, families));
+    // Families are claimed in chunks so single-account families do not contend on the counter.
+    const std::size_t chunk = std::max<std::size_t>(1, families / (threadCount * 64));
+    std::atomic<std::size_t> nextFamily(0);
+    auto worker = [&]() {
+        std::vector<std::int8_t> depth(count * 2, -1);
+        std::vector<std::uint32_t> queue;
+        for (std::size_t first = nextFamily.fetch_add(chunk); first < families; first = nextFamily.fetch_add(chunk)) {
+            std::size_t last = std::min(families, first + chunk);
+            for (std::uint32_t m = memberStart[first]; m < memberStart[last]; ++m) {
+                std::uint32_t node = members[m];
+                // Nobody to inherit from: leave the zeroed entry.
+                if (offsets[node] == offsets[node + 1]) continue;
+                risks[node] = score(node, depth, queue);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threadCount; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread &thread : pool) thread.join();
+}
+
+/**
+ * @brief Gets an account's inherited risk.
+ * @param user Username.
+ * @return InheritedRisk Risk, or all zeros for an unknown account.
+ */
+FamilyGraph::InheritedRisk FamilyGraph::riskOf(const std::string &user) const {
+    long long id = find(user);
+    return id < 0 ? InheritedRisk() : risks[static_cast<std::size_t>(id)];
+}
+
+/**
+ * @brief Turns an account's inherited risk into FamilyHealth-style family-history bits.
+ * @param user Username.
+ * @param threshold Evidence needed per condition.
+ * @return unsigned Bit i set if condition i reaches the threshold.
+ */
+unsigned FamilyGraph::familyHistoryBits(const std::string &user, double threshold) const {
+    InheritedRisk risk = riskOf(user);
+    unsigned bits = 0;
+    for (int i = 0; i < kDiseaseCount; ++i)
+        if (risk.disease[i] >= threshold) bits |= 1u << i;
+    return bits;
+}
+
+/**
+ * @brief Lists an account's relatives with their relatedness.
+ * @param user Username.
+ * @return std::vector<std::pair<std::string, double>> Blood relatives within kMaxDegree links, closest first.
+ */
+std::vector<std::pair<std::string, double>> FamilyGraph::relativesOf(const std::string &user) const {
+    std::vector<std::pair<std::string, double>> result;
+    long long id = find(user);
+    if (id < 0) return result;
+    std::vector<std::int8_t> depth(names.size() * 2, -1);
+    std::vector<std::uint32_t> queue;
+    forEachBloodRelative(static_cast<std::uint32_t>(id), depth, queue, [&](std::uint32_t relative, int d) {
+        result.emplace_back(names[relative], kRelatedness[d]);
+    });
+    return result;
+}
+
+/**
+ * @brief Parses a relation name.
+ * @param text "parent", "child" or "sibling".
+ * @param[out] relation The relation.
+ * @return bool False if the name is unknown.
+ */
+bool FamilyGraph::parseRelation(const std::string &text, Relation &relation) {
+    if (text == "parent") relation = Parent;
+    else if (text == "child") relation = Child;
+    else if (text == "sibling") relation = Sibling;
+    else return false;
+    return true;
+}
+
+/**
+ * @brief Loads links from a "user,relative,relation" CSV and compacts once at the end.
+ * @param path CSV path.
+ * @return bool False if the file could not be opened.
+ */
+bool FamilyGraph::loadLinks(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        ErrorHandling::logErrorMessage("Failed to open family links " + path);
+        return false;
+    }
+    // Scoring is deferred to the next computeAll() rather than done link by link.
+    bool wasComputed = computed;
+    computed = false;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#' || line == "\r") continue;
+        std::vector<std::string> fields = splitFields(line);
+        Relation relation = Parent;
+        if (fields.size() != 3 || fields[0].empty() || fields[1].empty() || !parseRelation(fields[2], relation)) {
+            ErrorHandling::logErrorMessage("Skipping malformed family link at " + path + ":" +
+                                           std::to_string(lineNumber));
+            continue;
+        }
+        link(fields[0], fields[1], relation);
+    }
+    compact();
+    if (wasComputed) computeAll();
+    return true;
+}
+
+/**
+ * @brief Loads conditions from a "user,bits" CSV.
+ * @param path CSV path.
+ * @return bool False if the file could not be opened.
+ */
+bool FamilyGraph::loadConditions(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        ErrorHandling::logErrorMessage("Failed to open family conditions " + path);
+        return false;
+    }
+    bool wasComputed = computed;
+    computed = false;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#' || line == "\r") continue;
+        std::vector<std::string> fields = splitFields(line);
+        char *end = nullptr;
+        unsigned long mask = fields.size() == 2 ? std::strtoul(fields[1].c_str(), &end, 10) : 0;
+        if (fields.size() != 2 || fields[0].empty() || fields[1].empty() || *end != '\0' ||
+            mask >= (1u << kDiseaseCount)) {
+            ErrorHandling::logErrorMessage("Skipping malformed family conditions at " + path + ":" +
+                                           std::to_string(lineNumber));
+            continue;
+        }
+        setConditions(fields[0], static_cast<std::uint8_t>(mask));
+    }
+    if (wasComputed) computeAll();
+    return true;
+}
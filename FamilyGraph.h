@@ -0,0 +1,246 @@
+#ifndef FAMILYGRAPH_H
+#define FAMILYGRAPH_H
+
+/**
+ * @file FamilyGraph.h
+ * @brief Declaration of the linked-family pedigree graph and its inherited-risk propagation.
+ *
+ * FamilyHealth records family history as four self-reported booleans. This header declares a graph that
+ * links HeartPi accounts belonging to blood relatives, so a user's family history can also be derived from
+ * the conditions their relatives have recorded, weighted by how closely related they are.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class FamilyGraph
+ * @brief First-degree family links in compressed sparse row (CSR) form, with relatedness-weighted risk.
+ *
+ * Each account is a node; parent, child and sibling links are edges stored in both directions. Only blood
+ * lines count: parent links up, at most one turn (a sibling link or a child link), then child links down.
+ * A co-parent reached through a shared child, or that co-parent's own family, is never a relative. A blood
+ * relative d links away contributes 0.5^d of each condition they have (0.5 for parents, children and
+ * siblings, 0.25 for grandparents, aunts and uncles, 0.125 for cousins), up to kMaxDegree links. Weights
+ * follow link distance, so a parent shared by siblings should be linked to each of them.
+ *
+ * The adjacency is a CSR array plus a small overlay of edits made since the last compaction: added edges per
+ * node and a tombstone per removed CSR edge. compact() folds the overlay back into the arrays, and does so
+ * automatically once the overlay grows past an eighth of the edge count.
+ *
+ * computeAll() splits the accounts into families (connected components) and scores whole families on
+ * worker threads. After that, each edit rescores only the accounts within kMaxDegree links of the accounts
+ * it touched.
+ */
+class FamilyGraph {
+public:
+    static const int kDiseaseCount = 4; /**< Conditions, in FamilyHealth's family-history order. */
+    static const int kMaxDegree = 3;    /**< Relatives further than this many links away are ignored. */
+
+    /**
+     * @brief What the relative is to the account a link starts from.
+     */
+    enum Relation : std::uint8_t {
+        Parent = 0,
+        Child,
+        Sibling
+    };
+
+    /**
+     * @brief Relatedness-weighted evidence per condition.
+     */
+    struct InheritedRisk {
+        float disease[kDiseaseCount] = {};  /**< Sum of relatedness over relatives with each condition. */
+        std::uint32_t relatives = 0;        /**< Linked relatives within kMaxDegree links. */
+    };
+
+    /**
+     * @brief Adds an account, or finds it if it already exists.
+     * @param user Username.
+     * @return std::uint32_t Account id.
+     */
+    std::uint32_t addAccount(const std::string &user);
+
+    /**
+     * @brief Looks up an account.
+     * @param user Username.
+     * @return long long Account id, or -1.
+     */
+    long long find(const std::string &user) const;
+
+    /**
+     * @brief Links two accounts, adding them if needed.
+     * @param user Username.
+     * @param relative The relative's username.
+     * @param relation What the relative is to the user.
+     * @return bool False if they are the same account or already linked.
+     */
+    bool link(const std::string &user, const std::string &relative, Relation relation);
+
+    /**
+     * @brief Removes the link between two accounts.
+     * @param user Username.
+     * @param relative The relative's username.
+     * @return bool False if they were not linked.
+     */
+    bool unlink(const std::string &user, const std::string &relative);
+
+    /**
+     * @brief Records the conditions an account holder has been diagnosed with.
+     * @param user Username (added if needed).
+     * @param mask Bit i set for FamilyHealth disease i.
+     */
+    void setConditions(const std::string &user, std::uint8_t mask);
+
+    /**
+     * @brief Scores every account, one family per work item.
+     * @param threads Worker threads (0: one per core).
+     */
+    void computeAll(unsigned threads = 0);
+
+    /**
+     * @brief Gets an account's inherited risk (all zeros before computeAll()).
+     * @param user Username.
+     * @return InheritedRisk Risk, or all zeros for an unknown account.
+     */
+    InheritedRisk riskOf(const std::string &user) const;
+
+    /**
+     * @brief Turns an account's inherited risk into FamilyHealth-style family-history bits.
+     * @param user Username.
+     * @param threshold Evidence needed per condition (0.5: one first-degree relative or two second-degree).
+     * @return unsigned Bit i set if condition i reaches the threshold.
+     */
+    unsigned familyHistoryBits(const std::string &user, double threshold = 0.5) const;
+
+    /**
+     * @brief Lists an account's relatives with their relatedness.
+     * @param user Username.
+     * @return std::vector<std::pair<std::string, double>> Blood relatives within kMaxDegree links, closest
+     *         first.
+     */
+    std::vector<std::pair<std::string, double>> relativesOf(const std::string &user) const;
+
+    /**
+     * @brief Folds pending edits into the CSR arrays.
+     */
+    void compact();
+
+    /** @return std::size_t Number of accounts. */
+    std::size_t accountCount() const { return names.size(); }
+
+    /**
+     * @brief Gets an account's username.
+     * @param id Account id (below accountCount()).
+     * @return const std::string& Username.
+     */
+    const std::string &accountName(std::uint32_t id) const { return names[id]; }
+
+    /** @return std::size_t Number of links. */
+    std::size_t linkCount() const { return links; }
+
+    /** @return std::size_t Number of families found by the last computeAll(). */
+    std::size_t familyCount() const { return families; }
+
+    /**
+     * @brief Parses a relation name.
+     * @param text "parent", "child" or "sibling".
+     * @param[out] relation The relation.
+     * @return bool False if the name is unknown.
+     */
+    static bool parseRelation(const std::string &text, Relation &relation);
+
+    /**
+     * @brief Loads links from a "user,relative,relation" CSV and compacts once at the end.
+     * @param path CSV path.
+     * @return bool False if the file could not be opened.
+     */
+    bool loadLinks(const std::string &path);
+
+    /**
+     * @brief Loads conditions from a "user,bits" CSV (bits as a decimal mask).
+     * @param path CSV path.
+     * @return bool False if the file could not be opened.
+     */
+    bool loadConditions(const std::string &path);
+
+private:
+    /**
+     * @brief One directed half of a link.
+     */
+    struct Edge {
+        std::uint32_t target = 0;           /**< Relative's account id. */
+        Relation relation = Parent;         /**< What the relative is to the source account. */
+    };
+
+    std::vector<std::string> names;                         /**< Username per id. */
+    std::unordered_map<std::string, std::uint32_t> ids;     /**< Id per username. */
+    std::vector<std::uint8_t> conditions;                   /**< Own conditions per id. */
+    std::vector<InheritedRisk> risks;                       /**< Computed risk per id. */
+    std::vector<std::uint32_t> offsets;                     /**< CSR row offsets (compacted nodes + 1). */
+    std::vector<Edge> edges;                                /**< CSR edges, sorted by target per node. */
+    std::vector<std::uint8_t> removed;                      /**< Tombstone per CSR edge. */
+    std::unordered_map<std::uint32_t, std::vector<Edge>> added; /**< Edges added since the last compaction. */
+    std::size_t pendingEdits = 0;                           /**< Overlay size (added plus removed edges). */
+    std::size_t links = 0;                                  /**< Current number of links. */
+    std::size_t families = 0;                               /**< Components found by computeAll(). */
+    bool computed = false;                                  /**< True once computeAll() has run. */
+    std::vector<std::int8_t> depthScratch;                  /**< score() scratch (2 per id) for rescore(). */
+    std::vector<std::uint32_t> queueScratch;                /**< score() queue reused by rescore(). */
+
+    /**
+     * @brief Calls a function for every current neighbour of a node.
+     * @param node Account id.
+     * @param visit Called with each Edge.
+     */
+    template <typename Visit>
+    void forEachNeighbour(std::uint32_t node, Visit visit) const;
+
+    /**
+     * @brief Finds the edge between two nodes.
+     * @param from Source id.
+     * @param to Target id.
+     * @return bool True if linked.
+     */
+    bool linked(std::uint32_t from, std::uint32_t to) const;
+
+    /**
+     * @brief Collects the accounts within kMaxDegree links of some seeds, seeds included.
+     * @param seeds Account ids.
+     * @return std::vector<std::uint32_t> Ids.
+     */
+    std::vector<std::uint32_t> neighbourhood(const std::vector<std::uint32_t> &seeds) const;
+
+    /**
+     * @brief Walks an account's blood relatives breadth-first, closest first, up to kMaxDegree links away.
+     * @param node Account id.
+     * @param depth Scratch array, two entries per account, all -1 on entry and on exit.
+     * @param queue Scratch queue.
+     * @param visit Called once per relative with its id and link distance.
+     */
+    template <typename Visit>
+    void forEachBloodRelative(std::uint32_t node, std::vector<std::int8_t> &depth,
+                              std::vector<std::uint32_t> &queue, Visit visit) const;
+
+    /**
+     * @brief Scores one account from its blood relatives within kMaxDegree links.
+     * @param node Account id.
+     * @param depth Scratch array, two entries per account, all -1 on entry and on exit.
+     * @param queue Scratch queue.
+     * @return InheritedRisk The account's risk.
+     */
+    InheritedRisk score(std::uint32_t node, std::vector<std::int8_t> &depth,
+                        std::vector<std::uint32_t> &queue) const;
+
+    /**
+     * @brief Rescores some accounts after an edit (no-op before computeAll()).
+     * @param nodes Account ids.
+     */
+    void rescore(const std::vector<std::uint32_t> &nodes);
+};
+
+#endif // FAMILYGRAPH_H
@@ -0,0 +1,38 @@
+/**
+ * @file FileLock.cpp
+ * @brief Implements the flock()-based FileLock.
+ */
+
+#include "FileLock.h"
+#include "ErrorHandling.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+/**
+ * @brief Opens the lock file and waits for the lock.
+ *
+ * A failure is logged and the caller carries on without the lock; callers that would be unsafe without it
+ * check isLocked().
+ *
+ * @param path Path of the lock file.
+ */
+FileLock::FileLock(const std::string &path)
+    : fd(::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)), locked(false) {
+    int result = -1;
+    if (fd >= 0) {
+        do {
+            result = ::flock(fd, LOCK_EX);
+        } while (result != 0 && errno == EINTR);
+    }
+    locked = result == 0;
+    if (!locked) ErrorHandling::logErrorMessage("Failed to lock " + path + "; updating without the lock");
+}
+
+/**
+ * @brief Releases the lock by closing the lock file.
+ */
+FileLock::~FileLock() {
+    if (fd >= 0) ::close(fd);
+}
@@ -0,0 +1,46 @@
+#ifndef FILELOCK_H
+#define FILELOCK_H
+
+/**
+ * @file FileLock.h
+ * @brief Declaration of an exclusive advisory lock shared by the processes that write the same file.
+ *
+ * The GUI, ingestd and the account importer all append to userdata.csv, and an append that fails is cut back
+ * to the length the file had before it. Both steps happen under this lock, so a rollback can never cut off
+ * rows that another process appended in between.
+ */
+
+#include <string>
+
+/**
+ * @class FileLock
+ * @brief Holds an exclusive flock() on a lock file for as long as it lives.
+ *
+ * The lock file only names the lock and stays empty, so the file it guards can still be replaced by rename.
+ * By convention the lock for "name" is "name.lock".
+ */
+class FileLock {
+public:
+    /**
+     * @brief Opens (creating if needed) the lock file and waits for the lock.
+     * @param path Path of the lock file.
+     */
+    explicit FileLock(const std::string &path);
+
+    /**
+     * @brief Releases the lock.
+     */
+    ~FileLock();
+
+    FileLock(const FileLock &) = delete;
+    FileLock &operator=(const FileLock &) = delete;
+
+    /** @return bool True if the lock is held; false if it could not be taken (the failure has been logged). */
+    bool isLocked() const { return locked; }
+
+private:
+    int fd;         /**< Descriptor of the lock file, or -1. */
+    bool locked;    /**< True once flock() succeeded. */
+};
+
+#endif // FILELOCK_H
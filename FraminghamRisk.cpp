@@ -0,0 +1,356 @@
+/**
+ * @file FraminghamRisk.cpp
+ * @brief Implements the vectorized Framingham kernel, its double-precision reference and RiskPopulation.
+ *
+ * The kernel is written once against a small set of vector operations defined for SSE2, AArch64 NEON and a
+ * one-lane scalar fallback. log(x) splits x into m·2^e with m in [sqrt(1/2), sqrt(2)) and evaluates
+ * ln m = 2 atanh((m-1)/(m+1)) with four odd terms (|f| <= 0.172, truncation below 3e-8). exp(x) reduces to
+ * 2^n·e^r with |r| <= ln(2)/2 and a degree-6 Taylor polynomial (truncation below 1.2e-7 relative); ln 2 is
+ * split into high and low parts in both so the reduction adds no error of its own.
+ */
+
+#include "FraminghamRisk.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRAMINGHAM_SSE
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define FRAMINGHAM_NEON
+#endif
+
+namespace {
+
+// Framingham general CVD (2008) coefficients: women, then men.
+const float kAge[2]        = { 2.32888f, 3.06117f };
+const float kTotalChol[2]  = { 1.20904f, 1.12370f };
+const float kHdl[2]        = { -0.70833f, -0.93263f };
+const float kSbpUntreated[2] = { 2.76157f, 1.93303f };
+const float kSbpTreated[2] = { 2.82263f, 1.99881f };
+const float kSmoker[2]     = { 0.52873f, 0.65451f };
+const float kDiabetes[2]   = { 0.69154f, 0.57367f };
+const float kMeanSum[2]    = { 26.1931f, 23.9802f };
+const double kBaselineSurvival[2] = { 0.95012, 0.88936 };
+const float kLnBaselineSurvival[2] = { static_cast<float>(std::log(kBaselineSurvival[0])),
+                                       static_cast<float>(std::log(kBaselineSurvival[1])) };
+
+const float kLn2Hi = 0.693359375f;
+const float kLn2Lo = -2.12194440e-4f;
+
+#if defined(FRAMINGHAM_SSE)
+
+const std::size_t kLanes = 4;
+typedef __m128 Vec;
+
+inline Vec vset(float x) { return _mm_set1_ps(x); }
+inline Vec vload(const float *p) { return _mm_loadu_ps(p); }
+inline void vstore(float *p, Vec v) { _mm_storeu_ps(p, v); }
+inline Vec vadd(Vec a, Vec b) { return _mm_add_ps(a, b); }
+inline Vec vsub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+inline Vec vmul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+inline Vec vdiv(Vec a, Vec b) { return _mm_div_ps(a, b); }
+inline Vec vmin(Vec a, Vec b) { return _mm_min_ps(a, b); }
+inline Vec vmax(Vec a, Vec b) { return _mm_max_ps(a, b); }
+
+/** Splits positive x into a mantissa in [sqrt(1/2), sqrt(2)) and its exponent (as float). */
+inline Vec vsplit(Vec x, Vec &exponent) {
+    __m128i bits = _mm_castps_si128(x);
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+    Vec m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+                                          _mm_set1_epi32(0x3F800000)));
+    Vec big = _mm_cmpgt_ps(m, vset(1.41421356f));
+    m = _mm_or_ps(_mm_and_ps(big, vmul(m, vset(0.5f))), _mm_andnot_ps(big, m));
+    e = _mm_sub_epi32(e, _mm_castps_si128(big));  // big lanes are all ones (-1)
+    exponent = _mm_cvtepi32_ps(e);
+    return m;
+}
+
+/** Rounds to the nearest integer and returns it with 2^n. */
+inline Vec vround(Vec x, Vec &pow2) {
+    __m128i n = _mm_cvtps_epi32(x);
+    pow2 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+    return _mm_cvtepi32_ps(n);
+}
+
+#elif defined(FRAMINGHAM_NEON)
+
+const std::size_t kLanes = 4;
+typedef float32x4_t Vec;
+
+inline Vec vset(float x) { return vdupq_n_f32(x); }
+inline Vec vload(const float *p) { return vld1q_f32(p); }
+inline void vstore(float *p, Vec v) { vst1q_f32(p, v); }
+inline Vec vadd(Vec a, Vec b) { return vaddq_f32(a, b); }
+inline Vec vsub(Vec a, Vec b) { return vsubq_f32(a, b); }
+inline Vec vmul(Vec a, Vec b) { return vmulq_f32(a, b); }
+inline Vec vdiv(Vec a, Vec b) { return vdivq_f32(a, b); }
+inline Vec vmin(Vec a, Vec b) { return vminq_f32(a, b); }
+inline Vec vmax(Vec a, Vec b) { return vmaxq_f32(a, b); }
+
+inline Vec vsplit(Vec x, Vec &exponent) {
+    int32x4_t bits = vreinterpretq_s32_f32(x);
+    int32x4_t e = vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127));
+    Vec m = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007FFFFF)), vdupq_n_s32(0x3F800000)));
+    uint32x4_t big = vcgtq_f32(m, vset(1.41421356f));
+    m = vbslq_f32(big, vmul(m, vset(0.5f)), m);
+    e = vsubq_s32(e, vreinterpretq_s32_u32(big));
+    exponent = vcvtq_f32_s32(e);
+    return m;
+}
+
+inline Vec vround(Vec x, Vec &pow2) {
+    int32x4_t n = vcvtnq_s32_f32(x);
+    pow2 = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n, vdupq_n_s32(127)), 23));
+    return vcvtq_f32_s32(n);
+}
+
+#else
+
+const std::size_t kLanes = 1;
+typedef float Vec;
+
+inline Vec vset(float x) { return x; }
+inline Vec vload(const float *p) { return *p; }
+inline void vstore(float *p, Vec v) { *p = v; }
+inline Vec vadd(Vec a, Vec b) { return a + b; }
+inline Vec vsub(Vec a, Vec b) { return a - b; }
+inline Vec vmul(Vec a, Vec b) { return a * b; }
+inline Vec vdiv(Vec a, Vec b) { return a / b; }
+inline Vec vmin(Vec a, Vec b) { return a < b ? a : b; }
+inline Vec vmax(Vec a, Vec b) { return a > b ? a : b; }
+
+inline Vec vsplit(Vec x, Vec &exponent) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int e = static_cast<int>(bits >> 23) - 127;
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    if (m > 1.41421356f) {
+        m *= 0.5f;
+        ++e;
+    }
+    exponent = static_cast<float>(e);
+    return m;
+}
+
+inline Vec vround(Vec x, Vec &pow2) {
+    int n = static_cast<int>(std::lrint(x));
+    std::uint32_t bits = static_cast<std::uint32_t>(n + 127) << 23;
+    std::memcpy(&pow2, &bits, sizeof(pow2));
+    return static_cast<float>(n);
+}
+
+#endif
+
+/** Natural log of positive normal x (absolute error below 1e-7 for the kernel's inputs). */
+inline Vec vlog(Vec x) {
+    Vec e;
+    Vec m = vsplit(x, e);
+    Vec f = vdiv(vsub(m, vset(1.0f)), vadd(m, vset(1.0f)));
+    Vec f2 = vmul(f, f);
+    Vec p = vadd(vset(2.0f / 5.0f), vmul(f2, vset(2.0f / 7.0f)));
+    p = vadd(vset(2.0f / 3.0f), vmul(f2, p));
+    p = vadd(vset(2.0f), vmul(f2, p));
+    p = vmul(f, p);
+    return vadd(vadd(p, vmul(e, vset(kLn2Lo))), vmul(e, vset(kLn2Hi)));
+}
+
+/** e^x for x in [-87, 88] (relative error below 2e-7). */
+inline Vec vexp(Vec x) {
+    x = vmax(vmin(x, vset(88.0f)), vset(-87.0f));
+    Vec pow2;
+    Vec n = vround(vmul(x, vset(1.44269504f)), pow2);
+    Vec r = vsub(vsub(x, vmul(n, vset(kLn2Hi))), vmul(n, vset(kLn2Lo)));
+    Vec p = vadd(vset(1.0f / 120.0f), vmul(r, vset(1.0f / 720.0f)));
+    p = vadd(vset(1.0f / 24.0f), vmul(r, p));
+    p = vadd(vset(1.0f / 6.0f), vmul(r, p));
+    p = vadd(vset(0.5f), vmul(r, p));
+    p = vadd(vset(1.0f), vmul(r, p));
+    p = vadd(vset(1.0f), vmul(r, p));
+    return vmul(p, pow2);
+}
+
+/** Blends a women's and men's coefficient by the 0/1 male column. */
+inline Vec bySex(const float (&coefficient)[2], Vec male) {
+    return vadd(vset(coefficient[0]), vmul(male, vset(coefficient[1] - coefficient[0])));
+}
+
+/** Scores kLanes people starting at the given column pointers. */
+inline void scoreLanes(const float *age, const float *tc, const float *hdl, const float *sbp, const float *male,
+                       const float *smoker, const float *diabetic, const float *treated, float *out) {
+    Vec m = vload(male);
+    Vec t = vload(treated);
+    Vec sbpCoefficient = vadd(bySex(kSbpUntreated, m),
+                              vmul(t, vsub(bySex(kSbpTreated, m), bySex(kSbpUntreated, m))));
+    Vec clampedAge = vmax(vmin(vload(age), vset(74.0f)), vset(30.0f));
+
+    Vec sum = vmul(bySex(kAge, m), vlog(clampedAge));
+    sum = vadd(sum, vmul(bySex(kTotalChol, m), vlog(vload(tc))));
+    sum = vadd(sum, vmul(bySex(kHdl, m), vlog(vload(hdl))));
+    sum = vadd(sum, vmul(sbpCoefficient, vlog(vload(sbp))));
+    sum = vadd(sum, vmul(bySex(kSmoker, m), vload(smoker)));
+    sum = vadd(sum, vmul(bySex(kDiabetes, m), vload(diabetic)));
+    sum = vsub(sum, bySex(kMeanSum, m));
+
+    // 1 - S0^exp(sum) = 1 - exp(exp(sum) ln S0)
+    Vec survival = vexp(vmul(vexp(sum), bySex(kLnBaselineSurvival, m)));
+    vstore(out, vsub(vset(1.0f), survival));
+}
+
+} // namespace
+
+/**
+ * @brief Resizes every column.
+ * @param count Number of people.
+ */
+void FraminghamInputs::resize(std::size_t count) {
+    age.resize(count, 50.0f);
+    totalCholesterol.resize(count, 200.0f);
+    hdl.resize(count, static_cast<float>(FraminghamRisk::kDefaultHdl));
+    systolicBP.resize(count, 120.0f);
+    male.resize(count, 0.0f);
+    smoker.resize(count, 0.0f);
+    diabetic.resize(count, 0.0f);
+    treatedBP.resize(count, 0.0f);
+}
+
+/**
+ * @brief Sets one person's inputs.
+ * @param index Person index.
+ * @param ageYears Age.
+ * @param cholesterol Total cholesterol.
+ * @param hdlCholesterol HDL.
+ * @param sbp Systolic BP.
+ * @param isMale Sex.
+ * @param isSmoker Smoker.
+ * @param isDiabetic Diabetes.
+ * @param isTreated Treated BP.
+ */
+void FraminghamInputs::set(std::size_t index, double ageYears, double cholesterol, double hdlCholesterol,
+                           double sbp, bool isMale, bool isSmoker, bool isDiabetic, bool isTreated) {
+    age[index] = static_cast<float>(ageYears);
+    totalCholesterol[index] = static_cast<float>(cholesterol);
+    hdl[index] = static_cast<float>(hdlCholesterol);
+    systolicBP[index] = static_cast<float>(sbp);
+    male[index] = isMale ? 1.0f : 0.0f;
+    smoker[index] = isSmoker ? 1.0f : 0.0f;
+    diabetic[index] = isDiabetic ? 1.0f : 0.0f;
+    treatedBP[index] = isTreated ? 1.0f : 0.0f;
+}
+
+/**
+ * @brief Scores a batch.
+ * @param inputs Inputs.
+ * @param[out] risks Risks.
+ */
+void FraminghamRisk::scoreBatch(const FraminghamInputs &inputs, float *risks) {
+    const std::size_t n = inputs.size();
+    std::size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        scoreLanes(&inputs.age[i], &inputs.totalCholesterol[i], &inputs.hdl[i], &inputs.systolicBP[i],
+                   &inputs.male[i], &inputs.smoker[i], &inputs.diabetic[i], &inputs.treatedBP[i], &risks[i]);
+    }
+    if (i == n) return;
+
+    // The last partial vector runs on padded copies.
+    float column[8][kLanes], out[kLanes];
+    const std::vector<float> *columns[8] = { &inputs.age, &inputs.totalCholesterol, &inputs.hdl, &inputs.systolicBP,
+                                             &inputs.male, &inputs.smoker, &inputs.diabetic, &inputs.treatedBP };
+    const float padding[8] = { 50.0f, 200.0f, 50.0f, 120.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int c = 0; c < 8; ++c)
+        for (std::size_t lane = 0; lane < kLanes; ++lane)
+            column[c][lane] = i + lane < n ? (*columns[c])[i + lane] : padding[c];
+    scoreLanes(column[0], column[1], column[2], column[3], column[4], column[5], column[6], column[7], out);
+    std::copy(out, out + (n - i), risks + i);
+}
+
+/**
+ * @brief Scores one person in double precision.
+ * @param age Age.
+ * @param totalCholesterol Total cholesterol.
+ * @param hdl HDL.
+ * @param systolicBP Systolic BP.
+ * @param male Sex.
+ * @param smoker Smoker.
+ * @param diabetic Diabetes.
+ * @param treatedBP Treated BP.
+ * @return double 10-year risk.
+ */
+double FraminghamRisk::reference(double age, double totalCholesterol, double hdl, double systolicBP, bool male,
+                                 bool smoker, bool diabetic, bool treatedBP) {
+    int s = male ? 1 : 0;
+    age = std::min(std::max(age, 30.0), 74.0);
+    double sum = kAge[s] * std::log(age) + kTotalChol[s] * std::log(totalCholesterol) + kHdl[s] * std::log(hdl) +
+                 (treatedBP ? kSbpTreated[s] : kSbpUntreated[s]) * std::log(systolicBP) +
+                 (smoker ? kSmoker[s] : 0.0) + (diabetic ? kDiabetes[s] : 0.0);
+    return 1.0 - std::pow(kBaselineSurvival[s], std::exp(sum - kMeanSum[s]));
+}
+
+/**
+ * @brief Gets a representative age for a survey age group.
+ * @param ageGroup 1-6.
+ * @return double Age in years.
+ */
+double FraminghamRisk::ageForGroup(int ageGroup) {
+    static const double ages[] = { 21.0, 29.5, 39.5, 49.5, 59.5, 70.0 };
+    return ages[std::min(std::max(ageGroup, 1), 6) - 1];
+}
+
+/**
+ * @brief Adds or replaces a user's inputs from a survey profile.
+ * @param profile Survey profile.
+ * @return bool True if the population changed.
+ */
+bool RiskPopulation::update(const SurveyProfile &profile) {
+    if (profile.user.empty() || profile.systolicBP <= 0 || profile.cholesterol <= 0) return false;
+    auto found = rowOf.find(profile.user);
+    std::size_t row;
+    if (found == rowOf.end()) {
+        row = users.size();
+        users.push_back(profile.user);
+        rowOf.emplace(profile.user, row);
+        inputs.resize(users.size());
+    } else {
+        row = found->second;
+    }
+    inputs.set(row, FraminghamRisk::ageForGroup(profile.ageGroup), profile.cholesterol, FraminghamRisk::kDefaultHdl,
+               profile.systolicBP, profile.male, profile.smoker, false, false);
+    return true;
+}
+
+/**
+ * @brief Rescores every user in one batch pass.
+ */
+void RiskPopulation::rescore() {
+    risks.resize(inputs.size());
+    FraminghamRisk::scoreBatch(inputs, risks.data());
+}
+
+/**
+ * @brief Gets a user's risk from the last rescore().
+ * @param user Username.
+ * @return double Risk, or -1 if unknown.
+ */
+double RiskPopulation::riskOf(const std::string &user) const {
+    auto found = rowOf.find(user);
+    if (found == rowOf.end() || found->second >= risks.size()) return -1.0;
+    return risks[found->second];
+}
+
+/**
+ * @brief Gets the share of users whose risk is below a value.
+ * @param risk Risk.
+ * @return double Percentage.
+ */
+double RiskPopulation::percentBelow(double risk) const {
+    if (risks.empty()) return 0.0;
+    float limit = static_cast<float>(risk);
+    std::size_t below = 0;
+    for (float r : risks) below += r < limit;
+    return 100.0 * static_cast<double>(below) / risks.size();
+}
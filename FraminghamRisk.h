@@ -0,0 +1,155 @@
+#ifndef FRAMINGHAMRISK_H
+#define FRAMINGHAMRISK_H
+
+/**
+ * @file FraminghamRisk.h
+ * @brief Declaration of the Framingham 10-year cardiovascular risk kernel and the RiskPopulation it scores.
+ *
+ * This header declares a batch implementation of the Framingham general cardiovascular risk equation
+ * (D'Agostino et al., Circulation 2008) next to the survey point score. Inputs are held structure-of-arrays
+ * so the kernel evaluates four (SSE2 / AArch64 NEON) people per instruction, with polynomial log and exp
+ * approximations in place of the C library calls.
+ */
+
+#include "SurveyIndex.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Structure-of-arrays inputs for FraminghamRisk::scoreBatch(); every vector has size() entries.
+ *
+ * Flags are stored as 0.0f / 1.0f so the kernel can blend coefficients arithmetically instead of branching.
+ */
+struct FraminghamInputs {
+    std::vector<float> age;                 /**< Age in years (clamped to 30-74, the equation's range). */
+    std::vector<float> totalCholesterol;    /**< Total cholesterol (mg/dL). */
+    std::vector<float> hdl;                 /**< HDL cholesterol (mg/dL). */
+    std::vector<float> systolicBP;          /**< Systolic blood pressure (mmHg). */
+    std::vector<float> male;                /**< 1 for men, 0 for women. */
+    std::vector<float> smoker;              /**< 1 for current smokers. */
+    std::vector<float> diabetic;            /**< 1 for people with diabetes. */
+    std::vector<float> treatedBP;           /**< 1 if the blood pressure is treated. */
+
+    /** @return std::size_t Number of people. */
+    std::size_t size() const { return age.size(); }
+
+    /**
+     * @brief Resizes every column.
+     * @param count Number of people.
+     */
+    void resize(std::size_t count);
+
+    /**
+     * @brief Sets one person's inputs.
+     * @param index Person index.
+     * @param ageYears Age in years.
+     * @param cholesterol Total cholesterol (mg/dL).
+     * @param hdlCholesterol HDL cholesterol (mg/dL).
+     * @param sbp Systolic blood pressure (mmHg).
+     * @param isMale Sex.
+     * @param isSmoker Current smoker.
+     * @param isDiabetic Has diabetes.
+     * @param isTreated Blood pressure is treated.
+     */
+    void set(std::size_t index, double ageYears, double cholesterol, double hdlCholesterol, double sbp,
+             bool isMale, bool isSmoker, bool isDiabetic, bool isTreated);
+};
+
+/**
+ * @class FraminghamRisk
+ * @brief Vectorized Framingham general CVD 10-year risk.
+ *
+ * risk = 1 - S0^exp(sum - mean), where sum = b_age ln(age) + b_tc ln(TC) + b_hdl ln(HDL) + b_sbp ln(SBP)
+ * + b_smoker smoker + b_diabetes diabetes, with sex-specific coefficients and treated/untreated SBP terms.
+ *
+ * Accuracy: the approximate log has an absolute error below 1e-7 and the approximate exp a relative error
+ * below 2e-7 over the kernel's input range, so scoreBatch() stays within kMaxAbsoluteError of the
+ * double-precision reference() for every input in the equation's range.
+ */
+class FraminghamRisk {
+public:
+    static constexpr double kMaxAbsoluteError = 1e-5;  /**< Bound on |scoreBatch() - reference()|. */
+    static constexpr double kDefaultHdl = 50.0;        /**< HDL used when none was measured (mg/dL). */
+
+    /**
+     * @brief Scores a batch.
+     * @param inputs Structure-of-arrays inputs.
+     * @param[out] risks inputs.size() risks in [0, 1].
+     */
+    static void scoreBatch(const FraminghamInputs &inputs, float *risks);
+
+    /**
+     * @brief Scores one person in double precision with the C library log and exp.
+     * @param age Age in years.
+     * @param totalCholesterol Total cholesterol (mg/dL).
+     * @param hdl HDL cholesterol (mg/dL).
+     * @param systolicBP Systolic blood pressure (mmHg).
+     * @param male Sex.
+     * @param smoker Current smoker.
+     * @param diabetic Has diabetes.
+     * @param treatedBP Blood pressure is treated.
+     * @return double 10-year risk in [0, 1].
+     */
+    static double reference(double age, double totalCholesterol, double hdl, double systolicBP, bool male,
+                            bool smoker, bool diabetic, bool treatedBP);
+
+    /**
+     * @brief Gets a representative age for a survey age group.
+     * @param ageGroup 1-6.
+     * @return double Midpoint of the group (70 for 65+).
+     */
+    static double ageForGroup(int ageGroup);
+};
+
+/**
+ * @class RiskPopulation
+ * @brief Latest Framingham inputs and risk per user, rescored in one batch pass.
+ *
+ * Survey profiles supply age group, sex, smoking, systolic BP and total cholesterol. HDL is not measured, so
+ * FraminghamRisk::kDefaultHdl is used; diabetes and blood-pressure treatment are not asked (a family history
+ * of diabetes is not the person's own diagnosis), so both are taken as absent.
+ */
+class RiskPopulation {
+public:
+    /**
+     * @brief Adds or replaces a user's inputs from a survey profile; profiles without vitals are ignored.
+     * @param profile Survey profile with systolic BP and cholesterol.
+     * @return bool True if the population changed.
+     */
+    bool update(const SurveyProfile &profile);
+
+    /**
+     * @brief Rescores every user.
+     */
+    void rescore();
+
+    /**
+     * @brief Gets a user's risk from the last rescore().
+     * @param user Username.
+     * @return double 10-year risk, or -1 if unknown.
+     */
+    double riskOf(const std::string &user) const;
+
+    /**
+     * @brief Gets the share of users whose risk is below a value.
+     * @param risk 10-year risk.
+     * @return double Percentage in [0, 100].
+     */
+    double percentBelow(double risk) const;
+
+    /** @return std::size_t Number of users. */
+    std::size_t size() const { return users.size(); }
+
+    /** @return const std::vector<float>& Risk per user, in insertion order. */
+    const std::vector<float>& getRisks() const { return risks; }
+
+private:
+    std::vector<std::string> users;                         /**< Username per row. */
+    std::unordered_map<std::string, std::size_t> rowOf;     /**< Row per username. */
+    FraminghamInputs inputs;                                /**< Inputs per row. */
+    std::vector<float> risks;                               /**< Risk per row from the last rescore(). */
+};
+
+#endif // FRAMINGHAMRISK_H
@@ -0,0 +1,147 @@
+/**
+ * @file AccountPicker.cpp
+ * @brief Implements the type-ahead account picker and its paged popup model.
+ */
+
+#include "AccountPicker.h"
+#include "../ReadingStore.h"
+#include <algorithm>
+#include <QAbstractItemView>
+#include <QCompleter>
+#include <QFileInfo>
+#include <QListView>
+
+/**
+ * @brief Constructs an empty model.
+ * @param accounts Index to read matches from.
+ * @param parent Parent object.
+ */
+AccountMatchModel::AccountMatchModel(const AccountIndex *accounts, QObject *parent)
+    : QAbstractListModel(parent), accounts(accounts)
+{
+}
+
+/**
+ * @brief Shows the matches for a new prefix.
+ *
+ * Only the range is looked up; rows are handed out page by page through fetchMore().
+ *
+ * @param prefix Typed text.
+ */
+void AccountMatchModel::setPrefix(const QString &prefix)
+{
+    beginResetModel();
+    std::pair<std::size_t, std::size_t> range = accounts->prefixRange(prefix.trimmed().toStdString());
+    first = range.first;
+    last = range.second;
+    loaded = std::min<std::size_t>(last - first, kPageSize);
+    endResetModel();
+}
+
+/**
+ * @brief Gets the number of rows fetched so far.
+ * @param parent Unused (the model is flat).
+ * @return int Row count.
+ */
+int AccountMatchModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(loaded);
+}
+
+/**
+ * @brief Gets a matching username.
+ * @param index Row.
+ * @param role Display or edit role.
+ * @return QVariant The username, or an invalid variant.
+ */
+QVariant AccountMatchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(loaded)) return QVariant();
+    if (role != Qt::DisplayRole && role != Qt::EditRole) return QVariant();
+    return QString::fromStdString(accounts->name(first + static_cast<std::size_t>(index.row())));
+}
+
+/**
+ * @brief Checks whether matches remain beyond the fetched rows.
+ * @param parent Unused (the model is flat).
+ * @return bool True if fetchMore() would add rows.
+ */
+bool AccountMatchModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && first + loaded < last;
+}
+
+/**
+ * @brief Adds the next page of matches.
+ * @param parent Unused (the model is flat).
+ */
+void AccountMatchModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) return;
+    std::size_t count = std::min<std::size_t>(last - first - loaded, kPageSize);
+    if (count == 0) return;
+    beginInsertRows(QModelIndex(), static_cast<int>(loaded), static_cast<int>(loaded + count - 1));
+    loaded += count;
+    endInsertRows();
+}
+
+/**
+ * @brief Constructs an empty picker.
+ *
+ * The completer is attached with setWidget() rather than QLineEdit::setCompleter(), so it never filters the
+ * model itself: the model already holds exactly the matches for the current text.
+ *
+ * @param parent Parent widget.
+ */
+AccountPicker::AccountPicker(QWidget *parent)
+    : QLineEdit(parent), model(new AccountMatchModel(&index, this)), completer(new QCompleter(this))
+{
+    setPlaceholderText("Start typing your username");
+    completer->setModel(model);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(8);
+    completer->setWidget(this);
+    // Every row is one line of text, so the view can skip measuring each row.
+    if (QListView *view = qobject_cast<QListView *>(completer->popup())) view->setUniformItemSizes(true);
+
+    connect(this, &QLineEdit::textEdited, this, &AccountPicker::updateMatches);
+    connect(completer, QOverload<const QString &>::of(&QCompleter::activated), this, &QLineEdit::setText);
+}
+
+/**
+ * @brief Indexes the registered usernames of a CSV file.
+ * @param csvPath Path of the CSV shared by registration and reading rows.
+ * @return bool False if the file could not be opened.
+ */
+bool AccountPicker::loadAccounts(const QString &csvPath)
+{
+    bool ok = index.loadRegistered(csvPath.toStdString());
+    if (ok) ReadingStore::countCsvBytesScanned(static_cast<std::uint64_t>(QFileInfo(csvPath).size()));
+    else index.build({});
+    model->setPrefix(text());
+    return ok;
+}
+
+/**
+ * @brief Gets the chosen account.
+ * @return QString The username as registered, or empty if the text names no account.
+ */
+QString AccountPicker::selectedAccount() const
+{
+    long long position = index.find(text().trimmed().toStdString());
+    return position < 0 ? QString() : QString::fromStdString(index.name(static_cast<std::size_t>(position)));
+}
+
+/**
+ * @brief Refreshes the popup for the current text.
+ * @param text Typed text.
+ */
+void AccountPicker::updateMatches(const QString &text)
+{
+    model->setPrefix(text);
+    if (text.trimmed().isEmpty() || model->matchCount() == 0) {
+        completer->popup()->hide();
+        return;
+    }
+    completer->complete();
+}
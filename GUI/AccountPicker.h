@@ -0,0 +1,102 @@
+#ifndef ACCOUNTPICKER_H
+#define ACCOUNTPICKER_H
+
+/**
+ * @file AccountPicker.h
+ * @brief Declaration of the type-ahead account picker used by the login screens.
+ *
+ * This file declares AccountPicker, a line edit that suggests registered usernames as the user types, and
+ * AccountMatchModel, the popup model behind it. Suggestions come from an AccountIndex, so each keystroke is
+ * a binary search and the popup only ever asks for the rows it is about to show.
+ */
+#include "../AccountIndex.h"
+#include <QAbstractListModel>
+#include <QLineEdit>
+
+class QCompleter;
+
+/**
+ * @class AccountMatchModel
+ * @brief List model exposing the usernames that match a prefix, one page at a time.
+ *
+ * The model holds only the matching range of the index. It reports kPageSize rows at first and grows by
+ * another page whenever the popup scrolls to the end (Qt's canFetchMore/fetchMore protocol), so typing a
+ * single letter over tens of thousands of accounts creates a handful of rows, not one per account.
+ */
+class AccountMatchModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    static const int kPageSize = 50;    /**< Rows added per fetch. */
+
+    /**
+     * @brief Constructs an empty model.
+     * @param accounts Index to read matches from (must outlive the model).
+     * @param parent Parent object.
+     */
+    explicit AccountMatchModel(const AccountIndex *accounts, QObject *parent = nullptr);
+
+    /**
+     * @brief Shows the matches for a new prefix.
+     * @param prefix Typed text.
+     */
+    void setPrefix(const QString &prefix);
+
+    /** @return int Number of matches for the current prefix, fetched or not. */
+    int matchCount() const { return static_cast<int>(last - first); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    const AccountIndex *accounts;   /**< Index the matches come from. */
+    std::size_t first = 0;          /**< First matching position. */
+    std::size_t last = 0;           /**< One past the last matching position. */
+    std::size_t loaded = 0;         /**< Rows reported to views so far. */
+};
+
+/**
+ * @class AccountPicker
+ * @brief Line edit with a lazily filled popup of matching usernames.
+ */
+class AccountPicker : public QLineEdit
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructs an empty picker.
+     * @param parent Parent widget.
+     */
+    explicit AccountPicker(QWidget *parent = nullptr);
+
+    /**
+     * @brief Indexes the registered usernames of a CSV file.
+     * @param csvPath Path of the CSV shared by registration and reading rows.
+     * @return bool False if the file could not be opened (the picker is then empty).
+     */
+    bool loadAccounts(const QString &csvPath = "userdata.csv");
+
+    /** @return int Number of registered usernames. */
+    int accountCount() const { return static_cast<int>(index.size()); }
+
+    /**
+     * @brief Gets the chosen account.
+     * @return QString The username as registered if the text names an account (ignoring case), else empty.
+     */
+    QString selectedAccount() const;
+
+private:
+    AccountIndex index;             /**< Registered usernames. */
+    AccountMatchModel *model;       /**< Popup model over index. */
+    QCompleter *completer;          /**< Popup shown while typing. */
+
+    /**
+     * @brief Refreshes the popup for the current text.
+     * @param text Typed text.
+     */
+    void updateMatches(const QString &text);
+};
+
+#endif // ACCOUNTPICKER_H
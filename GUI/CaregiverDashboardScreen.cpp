@@ -0,0 +1,189 @@
+/**
+ * @file CaregiverDashboardScreen.cpp
+ * @brief Implements the CaregiverDashboardScreen widget listing the users who need attention now.
+ *
+ * Each refresh calls RiskWatchlist::catchUp(), which reads only the bytes appended to userdata.csv and the
+ * survey log since the previous refresh and updates each affected user's rank in O(log N). The call runs on a
+ * QtConcurrent worker that also copies out the top rows, so the GUI thread never touches the shared watchlist
+ * and only redraws the table from that copy.
+ */
+
+#include "CaregiverDashboardScreen.h"
+#include "../MetricsRegistry.h"
+#include "../ReadingStore.h"
+#include "../RiskWatchlist.h"
+#include "../SurveyIndex.h"
+#include "../SurveyStore.h"
+#include <QColor>
+#include <QDateTime>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+#include <QDebug>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief What one catch-up produced, handed from the worker thread to the GUI thread.
+ */
+struct DashboardSnapshot {
+    bool ok = false;                    // The reading CSV could be read
+    bool changed = false;               // Anything new was folded in
+    std::size_t users = 0;              // Users with readings or assessments
+    std::vector<WatchlistEntry> rows;   // Top entries, best first
+};
+
+namespace {
+
+std::mutex watchlistMutex;  // Serialises catch-ups started by different dashboard instances
+const char *kWatchlistStatePath = "watchlist.state";   // Offsets and per-user state of the shared watchlist
+
+} // namespace
+
+/**
+ * @brief Constructs a new CaregiverDashboardScreen object.
+ *
+ * Sets up the title, the table, the status line and the back button, then refreshes every two seconds.
+ *
+ * @param stackedWidgetRef Pointer to the QStackedWidget used for screen navigation.
+ * @param parent Pointer to the parent widget.
+ */
+CaregiverDashboardScreen::CaregiverDashboardScreen(QStackedWidget *stackedWidgetRef, QWidget *parent)
+    : CustomBackgroundWidget(parent), stackedWidget(stackedWidgetRef)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(40, 40, 40, 40);
+    layout->setSpacing(20);
+
+    QLabel *title = new QLabel("Who Needs Attention Now", this);
+    title->setStyleSheet("color: white; font-size: 28px; font-weight: bold; font-family: 'Poppins', sans-serif;");
+    title->setAlignment(Qt::AlignCenter);
+    layout->addWidget(title);
+
+    table = new QTableWidget(0, 5, this);
+    table->setHorizontalHeaderLabels({"User", "Risk", "Alarm", "Recent BPM", "Last Reading"});
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionMode(QAbstractItemView::NoSelection);
+    table->setStyleSheet("background-color: rgba(255, 255, 255, 0.9); color: #333; font-size: 15px; "
+                         "border-radius: 10px;");
+    layout->addWidget(table);
+
+    statusLabel = new QLabel("Loading the watchlist...", this);
+    statusLabel->setStyleSheet("color: white; font-size: 14px;");
+    layout->addWidget(statusLabel);
+
+    QPushButton *backButton = new QPushButton("Back", this);
+    backButton->setFixedSize(300, 60);
+    backButton->setStyleSheet("background-color: white; color: #551900; border: 2px solid #551900; border-radius: 20px; font-size: 16px; font-weight: bold; padding: 8px 16px;");
+    layout->addWidget(backButton, 0, Qt::AlignCenter);
+    connect(backButton, &QPushButton::clicked, this, &CaregiverDashboardScreen::goBack);
+
+    setLayout(layout);
+
+    catchUpWatcher = new QFutureWatcher<DashboardSnapshot>(this);
+    connect(catchUpWatcher, &QFutureWatcher<DashboardSnapshot>::finished, this,
+            &CaregiverDashboardScreen::showSnapshot);
+
+    refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &CaregiverDashboardScreen::refresh);
+    refreshTimer->start(2000);
+    refresh();
+}
+
+/**
+ * @brief Gets the process-wide watchlist, loaded from its saved state on first use.
+ * @return RiskWatchlist& The watchlist (top 10 users).
+ */
+RiskWatchlist& CaregiverDashboardScreen::watchlist()
+{
+    static RiskWatchlist instance = []() {
+        RiskWatchlist saved(10);
+        saved.load(kWatchlistStatePath);
+        return saved;
+    }();
+    return instance;
+}
+
+/**
+ * @brief Starts folding in new readings and surveys on a worker thread.
+ *
+ * A tick that arrives while the previous catch-up is still running is skipped; the next one picks up
+ * whatever was appended meanwhile.
+ */
+void CaregiverDashboardScreen::refresh()
+{
+    static MetricCounter &ticks = MetricsRegistry::global().counter(
+        "heartpi_gui_timer_ticks_total{timer=\"caregiver_dashboard\"}", "GUI timer callbacks run, by timer.");
+    ticks.add();
+    if (catchUpWatcher->isRunning()) return;
+    catchUpWatcher->setFuture(QtConcurrent::run([]() {
+        DashboardSnapshot snapshot;
+        std::lock_guard<std::mutex> lock(watchlistMutex);
+        snapshot.ok = watchlist().catchUp(ReadingStore(), SurveyStore(), snapshot.changed);
+        if (snapshot.ok && snapshot.changed) watchlist().save(kWatchlistStatePath);
+        snapshot.users = watchlist().size();
+        if (snapshot.ok) snapshot.rows = watchlist().top();
+        return snapshot;
+    }));
+}
+
+/**
+ * @brief Redraws the table from the catch-up that just finished.
+ *
+ * The table is only rebuilt when something new was folded in.
+ */
+void CaregiverDashboardScreen::showSnapshot()
+{
+    const DashboardSnapshot snapshot = catchUpWatcher->result();
+    if (!snapshot.ok) {
+        qWarning() << "Caregiver dashboard: failed to read userdata.csv";
+        return;
+    }
+    statusLabel->setText(QString("Monitoring %1 users - updated %2")
+                             .arg(snapshot.users)
+                             .arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    if (!snapshot.changed && table->rowCount() > 0) return;
+
+    const std::vector<WatchlistEntry> &rows = snapshot.rows;
+    table->setRowCount(static_cast<int>(rows.size()));
+    for (int i = 0; i < static_cast<int>(rows.size()); ++i) {
+        const WatchlistEntry &entry = rows[static_cast<std::size_t>(i)];
+        QString alarm = entry.alarmState > 0 ? QString("High (%1 SD)").arg(entry.severity, 0, 'f', 1)
+                      : entry.alarmState < 0 ? QString("Low (%1 SD)").arg(entry.severity, 0, 'f', 1)
+                                             : QString("-");
+        QString lastReading = entry.lastReading > 0
+            ? QDateTime::fromSecsSinceEpoch(entry.lastReading).toString("yyyy-MM-dd hh:mm:ss")
+            : QString("-");
+        table->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(entry.user)));
+        table->setItem(i, 1, new QTableWidgetItem(entry.tier >= 0
+                                                      ? QString::fromStdString(SurveyProfile::tierName(entry.tier))
+                                                      : QString("Not assessed")));
+        table->setItem(i, 2, new QTableWidgetItem(alarm));
+        table->setItem(i, 3, new QTableWidgetItem(entry.lastReading > 0 ? QString::number(entry.recentBpm, 'f', 0)
+                                                                         : QString("-")));
+        table->setItem(i, 4, new QTableWidgetItem(lastReading));
+        if (entry.alarmState != 0 || entry.tier == 2) {
+            for (int column = 0; column < table->columnCount(); ++column)
+                table->item(i, column)->setForeground(QColor("#b00020"));
+        }
+    }
+}
+
+/**
+ * @brief Navigates back to the main menu.
+ */
+void CaregiverDashboardScreen::goBack()
+{
+    refreshTimer->stop();
+    if (stackedWidget) {
+        stackedWidget->setCurrentIndex(0);
+        stackedWidget->removeWidget(this);
+        deleteLater();
+    }
+}
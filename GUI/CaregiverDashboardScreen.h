@@ -0,0 +1,74 @@
+#ifndef CAREGIVERDASHBOARDSCREEN_H
+#define CAREGIVERDASHBOARDSCREEN_H
+
+/**
+ * @file CaregiverDashboardScreen.h
+ * @brief Declaration of the CaregiverDashboardScreen widget.
+ *
+ * This file declares the CaregiverDashboardScreen class, which lists the users who need attention now: the
+ * top entries of the RiskWatchlist, ranked by latest risk tier and the severity of any active heart-rate alarm.
+ * The list refreshes itself while the screen is visible.
+ */
+#include "custombackgroundwidget.h"
+#include <QFutureWatcher>
+#include <QStackedWidget>
+
+class QLabel;
+class QTableWidget;
+class QTimer;
+class RiskWatchlist;
+struct DashboardSnapshot;
+
+/**
+ * @class CaregiverDashboardScreen
+ * @brief A widget showing the top-K users by attention score.
+ *
+ * The watchlist is shared by every dashboard instance and only catches up with the readings and surveys
+ * appended since the previous refresh, so opening the screen again does not re-parse anyone's history. Its
+ * state is saved after every catch-up that folded something in and loaded on first use, so a restarted GUI
+ * resumes from the saved offsets too. The catch-ups run on a worker thread, so a first one that has to read
+ * both logs from the start never blocks the GUI.
+ */
+class CaregiverDashboardScreen : public CustomBackgroundWidget
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructs a new CaregiverDashboardScreen object.
+     *
+     * @param stackedWidgetRef Pointer to the QStackedWidget used for screen navigation.
+     * @param parent Pointer to the parent widget (default is nullptr).
+     */
+    explicit CaregiverDashboardScreen(QStackedWidget *stackedWidgetRef, QWidget *parent = nullptr);
+
+private slots:
+    /**
+     * @brief Starts folding in new readings and surveys on a worker thread, unless a catch-up is running.
+     */
+    void refresh();
+
+    /**
+     * @brief Redraws the table from the catch-up that just finished.
+     */
+    void showSnapshot();
+
+    /**
+     * @brief Navigates back to the main menu.
+     */
+    void goBack();
+
+private:
+    QStackedWidget *stackedWidget;
+    QTableWidget *table;        // One row per watchlist entry
+    QLabel *statusLabel;        // Number of monitored users and last refresh time
+    QTimer *refreshTimer;       // Periodic refresh while the screen is shown
+    QFutureWatcher<DashboardSnapshot> *catchUpWatcher;  // The catch-up running on a worker thread
+
+    /**
+     * @brief Gets the process-wide watchlist. Only catch-up workers use it, one at a time.
+     * @return RiskWatchlist& The watchlist.
+     */
+    static RiskWatchlist& watchlist();
+};
+
+#endif // CAREGIVERDASHBOARDSCREEN_H
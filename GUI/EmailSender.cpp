@@ -12,6 +12,7 @@
  */
 
 #include "EmailSender.h"
+#include "../MetricsRegistry.h"
 #include <QSslSocket>
 #include <QDebug>
 #include <QByteArray>
@@ -24,16 +25,25 @@
  * establishes an SSL connection to Gmail's SMTP server on port 465, and performs the necessary
  * SMTP commands (EHLO, AUTH LOGIN, MAIL FROM, RCPT TO, DATA, QUIT) to send an email.
  *
- * A helper lambda function is used to send each SMTP command and log the corresponding responses.
+ * A helper lambda sends each SMTP command and checks the reply code against the one the step needs
+ * (220 greeting, 250 EHLO, 334 AUTH LOGIN and user name, 235 password, 250 MAIL FROM and RCPT TO, 354 DATA,
+ * 250 after the message). Any other code, or no reply within five seconds, stops the exchange and counts as
+ * a failure, so a rejected login or recipient is no longer reported as sent.
  *
  * @param[in] to The recipient's email address.
  * @param[in] subject The subject of the email.
  * @param[in] body The body content of the email.
- * @return true if the email was sent successfully; false if any step fails.
+ * @return true if the server accepted the message; false if any step fails.
  */
 
 bool EmailSender::sendEmail(const QString &to, const QString &subject, const QString &body)
 {
+    static MetricCounter &sent = MetricsRegistry::global().counter(
+        "heartpi_emails_sent_total", "Emails accepted by the SMTP server.");
+    static MetricCounter &failed = MetricsRegistry::global().counter(
+        "heartpi_emails_failed_total",
+        "Emails that could not be sent (missing credentials, no connection or refused by the server).");
+
     // Read email credentials from environment variables.
     // These were set on my system for security as the repo is public
     // HEARTPI_EMAIL and HEARTPI_APP_PASSWORD
@@ -42,58 +52,83 @@ bool EmailSender::sendEmail(const QString &to, const QString &subject, const QSt
 
     if (senderEmail.isEmpty() || appPassword.isEmpty()) {
         qDebug() << "Missing environment variables for email!";
+        failed.add();
         return false;
     }
 
     QSslSocket socket;
     socket.connectToHostEncrypted("smtp.gmail.com", 465);
-    if (!socket.waitForConnected(5000)) {
+    if (!socket.waitForEncrypted(5000)) {
         qDebug() << "Connection to SMTP server failed!";
+        failed.add();
         return false;
     }
 
-    // Helper lambda: sends a command and reads the response.
-    auto sendCmd = [&](const QString &text) -> QString {
+    // Helper lambda: reads one reply, skipping "250-" continuation lines, and returns its code (-1 if none).
+    auto readReply = [&]() -> int {
+        QByteArray line;
+        do {
+            while (!socket.canReadLine()) {
+                if (!socket.waitForReadyRead(5000)) {
+                    qDebug() << "No response from SMTP server";
+                    return -1;
+                }
+            }
+            line = socket.readLine();
+        } while (line.size() > 3 && line.at(3) == '-');
+        qDebug() << "Response:" << line.trimmed();
+        bool ok = false;
+        int code = line.left(3).toInt(&ok);
+        return ok ? code : -1;
+    };
+
+    // Helper lambda: sends a command and checks that the reply has the expected code.
+    auto sendCmd = [&](const QString &text, int expected, bool secret = false) -> bool {
         socket.write(text.toUtf8() + "\r\n");
         socket.flush();
-        if (!socket.waitForBytesWritten(1000)) {
-            qDebug() << "Failed to write:" << text;
-        }
-        if (!socket.waitForReadyRead(5000)) {
-            qDebug() << "No response for:" << text;
-        }
-        QString response = QString::fromUtf8(socket.readAll());
-        qDebug() << "Sent:" << text;
-        qDebug() << "Response:" << response;
-        return response;
+        qDebug() << "Sent:" << (secret ? QString("<credentials>") : text);
+        int code = readReply();
+        // 251 (recipient not local, will forward) is as good as 250.
+        if (code == expected || (expected == 250 && code == 251)) return true;
+        qDebug() << "SMTP server replied" << code << "where" << expected << "was expected";
+        return false;
     };
 
-    // Begin SMTP communication.
-    sendCmd("EHLO heartpi");
-    sendCmd("AUTH LOGIN");
-
     // Base64 encode credentials.
     QString base64Email    = senderEmail.toUtf8().toBase64();
     QString base64Password = appPassword.toUtf8().toBase64();
 
-    sendCmd(base64Email);
-    sendCmd(base64Password);
-
-    sendCmd("MAIL FROM:<" + senderEmail + ">");
-    sendCmd("RCPT TO:<" + to + ">");
-    sendCmd("DATA");
+    // Lines of the body that start with '.' are doubled so that none of them ends the message early.
+    QString stuffedBody = body;
+    stuffedBody.replace("\n.", "\n..");
+    if (stuffedBody.startsWith('.')) stuffedBody.prepend('.');
 
-    // Construct email message with headers.
+    // Construct email message with headers; sendCmd() adds the CRLF after the final ".".
     QString message = "Subject: " + subject + "\r\n"
                       "To: " + to + "\r\n"
                       "From: " + senderEmail + "\r\n"
                       "MIME-Version: 1.0\r\n"
                       "Content-Type: text/plain; charset=UTF-8\r\n\r\n" +
-                      body + "\r\n.\r\n";
+                      stuffedBody + "\r\n.";
 
-    sendCmd(message);
-    sendCmd("QUIT");
+    // Begin SMTP communication; the first unexpected reply ends it.
+    bool accepted = readReply() == 220 &&
+                    sendCmd("EHLO heartpi", 250) &&
+                    sendCmd("AUTH LOGIN", 334) &&
+                    sendCmd(base64Email, 334, true) &&
+                    sendCmd(base64Password, 235, true) &&
+                    sendCmd("MAIL FROM:<" + senderEmail + ">", 250) &&
+                    sendCmd("RCPT TO:<" + to + ">", 250) &&
+                    sendCmd("DATA", 354) &&
+                    sendCmd(message, 250);
+    // The message is delivered or refused by now, so the reply to QUIT does not matter.
+    sendCmd("QUIT", 221);
 
     socket.disconnectFromHost();
+    if (!accepted) {
+        failed.add();
+        return false;
+    }
+    sent.add();
     return true;
 }
@@ -31,12 +31,13 @@ public:
      *
      * This static function sends an email by establishing an SSL connection to Gmail's SMTP server. It reads the sender's
      * email address and application-specific password from environment variables, authenticates with the server, and sends
-     * an email with the provided recipient, subject, and body. It returns true if the email appears to have been sent successfully.
+     * an email with the provided recipient, subject, and body. Every SMTP reply is checked, so it returns true only once the
+     * server has accepted the message.
      *
      * @param[in] to The recipient's email address.
      * @param[in] subject The subject of the email.
      * @param[in] body The body content of the email.
-     * @return true if the email was sent successfully; false otherwise.
+     * @return true if the server accepted the message; false otherwise.
      */
     static bool sendEmail(const QString &to, const QString &subject, const QString &body);
 };
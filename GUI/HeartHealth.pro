@@ -1,10 +1,12 @@
-QT       += core gui widgets charts multimedia network
+QT       += core gui widgets charts multimedia network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = HeartHealthGUI
 TEMPLATE = app
 
+CONFIG += c++17
+
 SOURCES += main.cpp \
            mainwindow.cpp \
            SurveyScreen.cpp \
@@ -16,9 +18,39 @@ SOURCES += main.cpp \
            TipsForUser.cpp \
            EmailSender.cpp \
            NotifyCaregiverScreen.cpp \
+           CaregiverDashboardScreen.cpp \
+           AccountPicker.cpp \
            ../Calculations.cpp \
            ../FamilyHealth.cpp \
-           ../RandomNumberGenerator.cpp
+           ../RandomNumberGenerator.cpp \
+           ../PpgSimulator.cpp \
+           ../SpO2Processor.cpp \
+           ../SlidingWindowStats.cpp \
+           ../AnomalyDetector.cpp \
+           ../ErrorHandling.cpp \
+           ../FileLock.cpp \
+           ../HeartRateRollup.cpp \
+           ../ReadingStore.cpp \
+           ../ChangePointDetector.cpp \
+           ../HoltWinters.cpp \
+           ../QuantileSketch.cpp \
+           ../PopulationStats.cpp \
+           ../RoaringBitmap.cpp \
+           ../SurveyIndex.cpp \
+           ../SurveyStore.cpp \
+           ../SurveyCube.cpp \
+           ../RiskModel.cpp \
+           ../FraminghamRisk.cpp \
+           ../LifestyleOptimizer.cpp \
+           ../RiskWatchlist.cpp \
+           ../ReadingColumns.cpp \
+           ../WeeklyHeatmap.cpp \
+           ../BpmHistogram.cpp \
+           ../MatrixProfile.cpp \
+           ../AccountImport.cpp \
+           ../AccountIndex.cpp \
+           ../HttpServer.cpp \
+           ../MetricsRegistry.cpp
 
 HEADERS += mainwindow.h \
            custombackgroundwidget.h \
@@ -30,9 +62,39 @@ HEADERS += mainwindow.h \
            TipsForUser.h \
            EmailSender.h \
            NotifyCaregiverScreen.h \
+           CaregiverDashboardScreen.h \
+           AccountPicker.h \
            ../Calculations.h \
            ../FamilyHealth.h \
-           ../RandomNumberGenerator.h
+           ../RandomNumberGenerator.h \
+           ../PpgSimulator.h \
+           ../SpO2Processor.h \
+           ../SlidingWindowStats.h \
+           ../AnomalyDetector.h \
+           ../ErrorHandling.h \
+           ../FileLock.h \
+           ../HeartRateRollup.h \
+           ../ReadingStore.h \
+           ../ChangePointDetector.h \
+           ../HoltWinters.h \
+           ../QuantileSketch.h \
+           ../PopulationStats.h \
+           ../RoaringBitmap.h \
+           ../SurveyIndex.h \
+           ../SurveyStore.h \
+           ../SurveyCube.h \
+           ../RiskModel.h \
+           ../FraminghamRisk.h \
+           ../LifestyleOptimizer.h \
+           ../RiskWatchlist.h \
+           ../ReadingColumns.h \
+           ../WeeklyHeatmap.h \
+           ../BpmHistogram.h \
+           ../MatrixProfile.h \
+           ../AccountImport.h \
+           ../AccountIndex.h \
+           ../HttpServer.h \
+           ../MetricsRegistry.h
 
 # Ensure the images folder is included during deployment
 DISTFILES += images/bg.png images/heartpilogo.png
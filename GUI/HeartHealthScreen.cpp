@@ -14,6 +14,13 @@
 #include "HeartHealthScreen.h"
 #include "../RandomNumberGenerator.h"
 #include "../Calculations.h" // For assessHeartHealth()
+#include "../RiskModel.h"
+#include "../PpgSimulator.h"
+#include "../SpO2Processor.h"
+#include "../ReadingStore.h"
+#include "../SurveyStore.h"
+#include "../FraminghamRisk.h"
+#include "../MetricsRegistry.h"
 #include <QMessageBox>
 #include <QFile>
 #include <QTextStream>
@@ -31,6 +38,7 @@
 #include <QtCharts/QChart>
 #include <QSoundEffect>
 #include <QUrl>
+#include <cmath>
 
 
 /**
@@ -150,16 +158,17 @@ void HeartHealthScreen::setupLiveChart()
     axisX->setLabelsColor(Qt::white);
     axisX->setTitleBrush(QBrush(Qt::white));
 
-    QValueAxis *axisY = new QValueAxis();
-    axisY->setRange(50, 130);
-    axisY->setTitleText("BPM");
-    axisY->setLabelsColor(Qt::white);
-    axisY->setTitleBrush(QBrush(Qt::white));
+    // Starts at the usual resting-to-high band; updateLiveChart() then fits it to the visible window.
+    liveAxisY = new QValueAxis();
+    liveAxisY->setRange(50, 130);
+    liveAxisY->setTitleText("BPM");
+    liveAxisY->setLabelsColor(Qt::white);
+    liveAxisY->setTitleBrush(QBrush(Qt::white));
 
     chart->addAxis(axisX, Qt::AlignBottom);
-    chart->addAxis(axisY, Qt::AlignLeft);
+    chart->addAxis(liveAxisY, Qt::AlignLeft);
     heartRateSeries->attachAxis(axisX);
-    heartRateSeries->attachAxis(axisY);
+    heartRateSeries->attachAxis(liveAxisY);
 
     chart->setTitle("Live Heart Rate Monitor");
     QFont titleFont;
@@ -207,22 +216,44 @@ void HeartHealthScreen::paintEvent(QPaintEvent *event)
  *
  * Computes the heart health assessment using family data and updates UI elements with the simulated sensor readings.
  * Adjusts the background color and starts a beeping timer if the risk is high. Also updates the CSV file with simulated
- * heart rate data.
+ * heart rate data, running each reading's simulated red/IR PPG through the SpO2Processor to store SpO2 alongside BPM.
  *
  * @param familyData The FamilyHealth object containing user data.
  */
 void HeartHealthScreen::displayResults(const FamilyHealth &familyData)
 {
+    // A model trained with tools/riskmodel replaces the point system when HEARTPI_RISK_MODEL names it.
+    const LogisticRiskModel *riskModel = LogisticRiskModel::installed();
+
     double heartRate, sysBP, diasBP, cholesterol, ecg;
     std::string assessment = assessHeartHealth(familyData,
                                                heartRate,
                                                sysBP,
                                                diasBP,
                                                cholesterol,
-                                               ecg);
+                                               ecg,
+                                               riskModel);
 
     resultLabel->setText(QString::fromStdString(assessment));
-    heartRateLabel->setText("Heart Rate: " + QString::number(heartRate, 'f', 1) + " BPM");
+
+    // Simulated saturation drifts lower as the assessed risk goes up.
+    double targetSpO2;
+    if (assessment.find("High risk") != std::string::npos)
+        targetSpO2 = RandomNumberGenerator(91, 95).generate();
+    else if (assessment.find("Moderate risk") != std::string::npos)
+        targetSpO2 = RandomNumberGenerator(94, 97).generate();
+    else
+        targetSpO2 = RandomNumberGenerator(96, 99).generate();
+
+    PpgSimulator previewPpg(100.0, heartRate, targetSpO2);
+    SpO2Processor previewOximeter(previewPpg.getSampleRate(), 400);
+    double previewRed[400], previewIr[400];
+    previewPpg.generate(previewRed, previewIr, 400);
+    previewOximeter.addSamples(previewRed, previewIr, 400);
+    QString heartRateText = "Heart Rate: " + QString::number(heartRate, 'f', 1) + " BPM";
+    if (previewOximeter.latestEstimate().valid)
+        heartRateText += "   SpO2: " + QString::number(previewOximeter.latestEstimate().spo2, 'f', 1) + " %";
+    heartRateLabel->setText(heartRateText);
 
     if (assessment.find("Low risk of heart disease.") != std::string::npos) {
         m_currentRisk = "low";
@@ -252,25 +283,97 @@ void HeartHealthScreen::displayResults(const FamilyHealth &familyData)
     }
 
     if (!user.isEmpty()) {
-        QFile file("userdata.csv");
-        QStringList lines;
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream in(&file);
-            while (!in.atEnd())
-                lines.append(in.readLine());
-            file.close();
+        // Each reading gets one second of simulated red/IR PPG; its SpO2 is stored next to the BPM.
+        PpgSimulator ppg(100.0, heartRate, targetSpO2);
+        SpO2Processor oximeter(ppg.getSampleRate(), 100);
+        double red[100], ir[100];
+        std::vector<HeartRateReading> batch;
+        batch.reserve(20);
+        for (int i = 0; i < 20; i++) {
+            double simulatedHR = RandomNumberGenerator(heartRate - 5, heartRate + 5).generate();
+            ppg.setHeartRate(simulatedHR);
+            ppg.generate(red, ir, 100);
+            oximeter.addSamples(red, ir, 100);
+            const SpO2Estimate &estimate = oximeter.latestEstimate();
+            HeartRateReading reading;
+            reading.user = user.toStdString();
+            reading.timestamp = QDateTime::currentSecsSinceEpoch() + i;
+            reading.bpm = std::round(simulatedHR * 10.0) / 10.0;
+            if (estimate.valid)
+                reading.spo2 = std::round(estimate.spo2 * 10.0) / 10.0;
+            batch.push_back(reading);
+        }
+
+        // This session's vitals go into the population sketches for the user's risk tier and age group.
+        std::string tier = assessment.find("High risk") != std::string::npos ? "High"
+                         : assessment.find("Moderate risk") != std::string::npos ? "Moderate" : "Low";
+        int ageGroup = familyData.getAgeGroup();
+        PopulationStats vitals;
+        for (const HeartRateReading &reading : batch) {
+            vitals.add(PopulationStats::vitalKey("bpm", tier, ageGroup), reading.bpm);
+            if (reading.spo2 >= 0)
+                vitals.add(PopulationStats::vitalKey("spo2", tier, ageGroup), reading.spo2);
+        }
+        vitals.add(PopulationStats::vitalKey("sysbp", tier, ageGroup), sysBP);
+        vitals.add(PopulationStats::vitalKey("diasbp", tier, ageGroup), diasBP);
+        vitals.add(PopulationStats::vitalKey("cholesterol", tier, ageGroup), cholesterol);
+
+        // Appends the rows in one write and folds them into the user's summary and the population sketches.
+        if (!ReadingStore().append(batch, vitals))
+            qWarning() << "Could not append readings to userdata.csv";
+
+        // The answers and resulting tier are logged for cohort queries over the survey index.
+        SurveyProfile profile = SurveyProfile::fromFamilyHealth(familyData, tier, user.toStdString(),
+                                                                QDateTime::currentSecsSinceEpoch());
+        double bpmSum = 0.0, spo2Sum = 0.0;
+        int spo2Count = 0;
+        for (const HeartRateReading &reading : batch) {
+            bpmSum += reading.bpm;
+            if (reading.spo2 >= 0) {
+                spo2Sum += reading.spo2;
+                ++spo2Count;
+            }
         }
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-            QTextStream out(&file);
-            for (const QString &line : lines)
-                out << line << "\n";
-            for (int i = 0; i < 20; i++) {
-                qint64 now = QDateTime::currentSecsSinceEpoch() + i;
-                double simulatedHR = RandomNumberGenerator(heartRate - 5, heartRate + 5).generate();
-                QString newLine = user + "," + QString::number(now) + "," + QString::number(simulatedHR, 'f', 1);
-                out << newLine << "\n";
+        profile.bpm = bpmSum / batch.size();
+        if (spo2Count > 0) profile.spo2 = spo2Sum / spo2Count;
+        profile.systolicBP = sysBP;
+        profile.diastolicBP = diasBP;
+        profile.cholesterol = cholesterol;
+
+        SurveyCube cube;
+        if (!SurveyStore().append({ profile }, &cube)) {
+            qWarning() << "Could not append survey to surveydata.csv";
+        } else {
+            // Compare with everyone who shares the user's age group, gender and smoking status.
+            SurveyCube::Slice peers = SurveyCube::everything();
+            peers[SurveyCube::Age] = profile.ageGroup;
+            peers[SurveyCube::Gender] = profile.male ? 1 : 0;
+            peers[SurveyCube::Smoker] = profile.smoker ? 1 : 0;
+            const SurveyCube::Cell &cohort = cube.query(peers);
+            if (cohort.count() > 1) {
+                resultLabel->setText(resultLabel->text() + "\n" + QString::number(cohort.tierShare(2) * 100.0, 'f', 0) +
+                                     "% of " + QString::number(cohort.count()) +
+                                     " assessments from people like you were High risk (average " +
+                                     QString::number(cohort.mean(SurveyCube::Bpm), 'f', 0) + " BPM).");
             }
-            file.close();
+        }
+
+        // New vitals rescore everyone's Framingham risk in one batch pass over the population.
+        static RiskPopulation population;
+        static bool populationLoaded = false;
+        if (!populationLoaded) {
+            std::vector<SurveyProfile> history;
+            SurveyStore().loadProfiles(history);
+            for (const SurveyProfile &past : history) population.update(past);
+            populationLoaded = true;
+        }
+        population.update(profile);
+        population.rescore();
+        double framingham = population.riskOf(profile.user);
+        if (framingham >= 0) {
+            resultLabel->setText(resultLabel->text() + "\nEstimated 10-year cardiovascular risk (Framingham): " +
+                                 QString::number(framingham * 100.0, 'f', 1) + "%, higher than " +
+                                 QString::number(population.percentBelow(framingham), 'f', 0) + "% of users.");
         }
     }
     loadDataFromCSV("userdata.csv");
@@ -301,6 +404,7 @@ void HeartHealthScreen::reset()
     currentX = 0;
     liveDataIndex = 0;
     liveDataLines.clear();
+    liveStats.clear();
 }
 
 /**
@@ -320,10 +424,14 @@ void HeartHealthScreen::generateHeartRateChart(double /*heartRate*/)
  * @brief Updates the live heart rate chart.
  *
  * Retrieves the next heart rate value from liveDataLines (if available) or generates a random value,
- * then appends the new data point to the chart series. Scrolls the chart if necessary.
+ * then appends the new data point to the chart series. Scrolls the chart if necessary and refits the BPM axis
+ * to the min/max of the visible window using the running liveStats.
  */
 void HeartHealthScreen::updateLiveChart()
 {
+    static MetricCounter &ticks = MetricsRegistry::global().counter(
+        "heartpi_gui_timer_ticks_total{timer=\"live_chart\"}", "GUI timer callbacks run, by timer.");
+    ticks.add();
     double newHeartRate = 70.0;
     if (!liveDataLines.isEmpty() && liveDataIndex < liveDataLines.size()) {
         bool ok = false;
@@ -338,6 +446,15 @@ void HeartHealthScreen::updateLiveChart()
     currentX++;
     if (currentX > 50)
         chart->scroll(chart->plotArea().width() / 50.0, 0);
+
+    // Fit the BPM axis to the visible window and show its mean/spread, in O(1) per tick.
+    liveStats.add(newHeartRate);
+    double low = std::floor((liveStats.min() - 5.0) / 10.0) * 10.0;
+    double high = std::ceil((liveStats.max() + 5.0) / 10.0) * 10.0;
+    if (liveAxisY->min() != low || liveAxisY->max() != high)
+        liveAxisY->setRange(low, high);
+    liveAxisY->setTitleText("BPM (avg " + QString::number(liveStats.mean(), 'f', 1) +
+                            " ± " + QString::number(liveStats.stddev(), 'f', 1) + ")");
 }
 
 /**
@@ -363,13 +480,15 @@ void HeartHealthScreen::loadDataFromCSV(const QString &filename)
         if (line.isEmpty())
             continue;
         QStringList parts = line.split(",");
-        if (parts.size() == 3) {
+        // Reading rows are username,timestamp,BPM with an optional trailing SpO2 column.
+        if (parts.size() == 3 || parts.size() == 4) {
             QString lineUser = parts[0];
             QString hrStr = parts[2];
             if (lineUser == user)
                 liveDataLines.append(hrStr);
         }
     }
+    ReadingStore::countCsvBytesScanned(static_cast<std::uint64_t>(file.pos()));
     file.close();
     liveDataIndex = 0;
 }
@@ -407,6 +526,7 @@ void HeartHealthScreen::showResultsForUser() {
     currentX = 0;
     liveDataIndex = 0;
     liveDataLines.clear();
+    liveStats.clear();
     loadDataFromCSV("userdata.csv");
     update();
 }
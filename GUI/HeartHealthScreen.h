@@ -20,11 +20,13 @@
 #include "custombackgroundwidget.h"
 #include "../FamilyHealth.h"
 #include "../Calculations.h"
+#include "../SlidingWindowStats.h"
 #include <QVBoxLayout>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QPushButton>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
 #include <QStackedWidget>
 #include <QTimer>
 #include <QDateTime>
@@ -169,7 +171,11 @@ private:
     QChartView  *chartView;
     QLineSeries *heartRateSeries;
     QChart      *chart;
+    QValueAxis  *liveAxisY = nullptr;  ///< BPM axis; its range follows the visible window.
     QTimer      *liveTimer;
+
+    /// Statistics over the points currently visible on the live chart (same 50-sample span as the x-axis).
+    SlidingWindowStats liveStats{50};
     
     int currentX = 0;
     int liveDataIndex = 0;
@@ -7,7 +7,8 @@
  * accounts from a CSV file, verifies credentials, fetches heart rate data, computes risk levels, and composes
  * an alert email using the EmailSender module.
  *
- * @note The CSV file "userdata.csv" is used both for registration (2-column rows) and heart rate data (3-column rows).
+ * @note The CSV file "userdata.csv" is used both for registration (2-column rows) and heart rate data (3-column rows,
+ * or 4 columns when an SpO2 reading is stored).
  *
  * @author Ola Waked
  */
@@ -16,16 +17,18 @@
 
 #include "NotifyCaregiverScreen.h"
 #include "EmailSender.h"
+#include "AccountPicker.h"
+#include "../SlidingWindowStats.h"
+#include "../AnomalyDetector.h"
+#include "../ReadingStore.h"
 #include <QStackedWidget>
 #include <QVBoxLayout>
 #include <QLabel>
-#include <QComboBox>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QFile>
 #include <QTextStream>
 #include <QMessageBox>
-#include <QSet>
 #include <QDebug>
 #include <QDateTime>
 
@@ -34,7 +37,7 @@
 /**
  * @brief Constructs a new NotifyCaregiverScreen object.
  *
- * Sets up the UI elements including title label, account drop-down, password and recipient email fields,
+ * Sets up the UI elements including title label, account picker, password and recipient email fields,
  * and the send/back buttons. Connects button clicks to the corresponding slots.
  *
  * @param stackedWidget Pointer to the QStackedWidget used for screen navigation.
@@ -54,11 +57,11 @@ NotifyCaregiverScreen::NotifyCaregiverScreen(QStackedWidget *stackedWidget, QWid
     title->setAlignment(Qt::AlignCenter);
     layout->addWidget(title);
 
-    // Drop-down for username (from registration rows in userdata.csv)
-    accountComboBox = new QComboBox(this);
-    accountComboBox->setFixedSize(400, 40);
-    accountComboBox->setStyleSheet("padding: 8px; font-size: 16px; border-radius: 10px; background-color: white; color: #333;");
-    layout->addWidget(accountComboBox);
+    // Type-ahead username picker (from registration rows in userdata.csv)
+    accountPicker = new AccountPicker(this);
+    accountPicker->setFixedSize(400, 40);
+    accountPicker->setStyleSheet("padding: 8px; font-size: 16px; border-radius: 10px; background-color: white; color: #333;");
+    layout->addWidget(accountPicker);
     loadAccounts();
 
     // Password field
@@ -98,33 +101,15 @@ NotifyCaregiverScreen::NotifyCaregiverScreen(QStackedWidget *stackedWidget, QWid
 /**
  * @brief Loads available user accounts from the CSV file.
  *
- * Opens "userdata.csv", reads registration rows (which have exactly 2 columns: username and password),
- * and populates the account drop-down with unique usernames.
+ * Indexes the registration rows of "userdata.csv" (which have exactly 2 columns: username and password)
+ * so the account picker can suggest unique usernames as the user types.
  */
 void NotifyCaregiverScreen::loadAccounts()
 {
-    accountComboBox->clear();
-    // Open "userdata.csv" to load registration rows (with exactly 2 columns: username,password)
-    QFile file("userdata.csv");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    accountPicker->clear();
+    if (!accountPicker->loadAccounts("userdata.csv")) {
         QMessageBox::warning(this, "File Error", "Failed to open userdata.csv for loading user names.");
-        return;
     }
-    QTextStream in(&file);
-    bool firstLine = true;
-    QSet<QString> accounts;
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty()) continue;
-        if (firstLine) { firstLine = false; continue; }
-        QStringList parts = line.split(",");
-        if (parts.size() == 2) {
-            accounts.insert(parts[0].trimmed());
-        }
-    }
-    file.close();
-    for (const QString &account : accounts)
-        accountComboBox->addItem(account);
 }
 
 /**
@@ -160,6 +145,7 @@ bool NotifyCaregiverScreen::verifyCredentials(const QString &username, const QSt
             }
         }
     }
+    ReadingStore::countCsvBytesScanned(static_cast<std::uint64_t>(file.pos()));
     file.close();
     return valid;
 }
@@ -168,13 +154,14 @@ bool NotifyCaregiverScreen::verifyCredentials(const QString &username, const QSt
  * @brief Attempts to send an alert email to the caregiver.
  *
  * Validates user input, verifies credentials, and then fetches heart rate data from "userdata.csv".
- * Computes average and latest heart rate, determines the risk level, composes the email subject and body,
+ * Computes average and latest heart rate, determines the risk level from streaming EWMA/CUSUM detectors run
+ * against the user's own baseline, composes the email subject and body (including recent change events),
  * and sends the email using the EmailSender class. Displays appropriate messages based on success or failure.
  */
 
 void NotifyCaregiverScreen::attemptSendAlert()
 {
-    QString selectedUser = accountComboBox->currentText();
+    QString selectedUser = accountPicker->selectedAccount();
     QString enteredPassword = passwordField->text().trimmed();
     QString recipientEmail = recipientEmailField->text().trimmed();
 
@@ -189,8 +176,11 @@ void NotifyCaregiverScreen::attemptSendAlert()
     }
 
     // --- Fetch heart rate data from userdata.csv (data rows with 3 columns) ---
-    QVector<double> heartRates;
+    SlidingWindowStats heartRates; // unbounded: running stats over the whole history
+    PatientDetector detector;
+    QVector<ChangeEvent> changeEvents;
     qint64 latestTimestamp = 0;
+    double latestSpO2 = -1;
     QFile file("userdata.csv");
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream in(&file);
@@ -199,33 +189,30 @@ void NotifyCaregiverScreen::attemptSendAlert()
             QString line = in.readLine().trimmed();
             if (firstLine) { firstLine = false; continue; }
             QStringList parts = line.split(",");
-            // Data rows have 3 columns: username, timestamp, BPM
-            if (parts.size() == 3 && parts[0].trimmed().compare(selectedUser, Qt::CaseInsensitive) == 0) {
+            // Data rows have 3 columns: username, timestamp, BPM (plus SpO2 on newer rows)
+            if ((parts.size() == 3 || parts.size() == 4) && parts[0].trimmed().compare(selectedUser, Qt::CaseInsensitive) == 0) {
                 bool ok;
                 double bpm = parts[2].toDouble(&ok);
-                if (ok)
-                    heartRates.append(bpm);
                 latestTimestamp = parts[1].toLongLong();
+                if (ok) {
+                    heartRates.add(bpm);
+                    ChangeEvent event;
+                    if (detector.update(latestTimestamp, bpm, event))
+                        changeEvents.append(event);
+                }
+                latestSpO2 = (parts.size() == 4) ? parts[3].toDouble() : -1;
             }
         }
+        ReadingStore::countCsvBytesScanned(static_cast<std::uint64_t>(file.pos()));
         file.close();
     }
 
     double avg = 0, latest = 0;
     QString risk = "Unknown";
-    if (!heartRates.isEmpty()) {
-        double sum = 0;
-        for (double bpm : heartRates)
-            sum += bpm;
-        avg = sum / heartRates.size();
-        latest = heartRates.last();
-
-        if (avg < 80)
-            risk = "Low";
-        else if (avg < 100)
-            risk = "Moderate";
-        else
-            risk = "High";
+    if (!heartRates.empty()) {
+        avg = heartRates.mean();
+        latest = heartRates.latest();
+        risk = QString::fromStdString(detector.classifyRisk());
     }
 
     // Compose subject and body message.
@@ -238,12 +225,23 @@ void NotifyCaregiverScreen::attemptSendAlert()
     QString body;
     body += "😊 Hi there!\n\n";
     body += selectedUser + " trusted you with their HeartPi data. Here are their recent readings:\n\n";
-    if (!heartRates.isEmpty()) {
+    if (!heartRates.empty()) {
         body += "Average Heart Rate: " + QString::number(avg, 'f', 1) + " BPM\n";
         body += "Latest Heart Rate: " + QString::number(latest, 'f', 1) + " BPM\n";
+        if (latestSpO2 >= 0)
+            body += "Latest SpO2: " + QString::number(latestSpO2, 'f', 1) + " %\n";
         QDateTime dt = QDateTime::fromSecsSinceEpoch(latestTimestamp);
         body += "Last Reading: " + dt.toString("yyyy-MM-dd hh:mm:ss") + "\n";
-        body += "Risk Level: " + risk + "\n\n";
+        body += "Risk Level: " + risk + "\n";
+        // Only the most recent few detector events are worth a caregiver's attention.
+        for (int i = qMax(0, changeEvents.size() - 3); i < changeEvents.size(); ++i) {
+            const ChangeEvent &event = changeEvents[i];
+            body += "Change Detected: " + QString::fromStdString(describeChangeEvent(event)) + " at " +
+                    QDateTime::fromSecsSinceEpoch(event.timestamp).toString("yyyy-MM-dd hh:mm:ss") +
+                    " (" + QString::number(event.value, 'f', 1) + " BPM vs baseline " +
+                    QString::number(event.baseline, 'f', 1) + ")\n";
+        }
+        body += "\n";
     } else {
         body += "No heart rate data available.\n\n";
     }
@@ -15,7 +15,7 @@
 
 #include "custombackgroundwidget.h"
 
-class QComboBox;
+class AccountPicker;
 class QLineEdit;
 class QPushButton;
 class QStackedWidget;
@@ -41,7 +41,7 @@ private slots:
 
 private:
     QStackedWidget *stackedWidget;
-    QComboBox *accountComboBox;      // For selecting the username (registration rows)
+    AccountPicker *accountPicker;     // For selecting the username (registration rows)
     QLineEdit *passwordField;         // For entering the password
     QLineEdit *recipientEmailField;   // For entering the recipient's email address
     QPushButton *sendAlertButton;
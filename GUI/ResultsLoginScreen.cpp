@@ -13,12 +13,12 @@
  */
 
 #include "ResultsLoginScreen.h"
+#include "../ReadingStore.h"
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QFile>
 #include <QTextStream>
 #include <QMessageBox>
-#include <QSet>
 
 /**
  * @brief Constructs a new ResultsLoginScreen object.
@@ -39,7 +39,7 @@ ResultsLoginScreen::ResultsLoginScreen(QStackedWidget *stackedWidgetRef, QWidget
 /**
  * @brief Sets up the user interface for the login screen.
  *
- * Creates and configures UI elements including a title label, account combo box, password field,
+ * Creates and configures UI elements including a title label, account picker, password field,
  * login button, and back button. Also arranges these elements using a QVBoxLayout.
  */
 void ResultsLoginScreen::setupUI()
@@ -53,10 +53,10 @@ void ResultsLoginScreen::setupUI()
     layout->addWidget(title);
     layout->addSpacing(20);
 
-    accountComboBox = new QComboBox(this);
-    accountComboBox->setFixedSize(400, 40);
-    accountComboBox->setStyleSheet("padding: 8px; font-size: 16px; border-radius: 10px; background-color: white; color: #333;");
-    layout->addWidget(accountComboBox);
+    accountPicker = new AccountPicker(this);
+    accountPicker->setFixedSize(400, 40);
+    accountPicker->setStyleSheet("padding: 8px; font-size: 16px; border-radius: 10px; background-color: white; color: #333;");
+    layout->addWidget(accountPicker);
     layout->addSpacing(10);
 
     passwordField = new QLineEdit(this);
@@ -85,39 +85,15 @@ void ResultsLoginScreen::setupUI()
 }
 
 /**
- * @brief Updates the account combo box with usernames from the CSV file.
+ * @brief Updates the account picker with usernames from the CSV file.
  *
- * Opens "userdata.csv" and reads registration rows (those with exactly 2 columns: username and password).
- * The accountComboBox is then populated with the unique usernames found.
+ * Indexes the registration rows of "userdata.csv" (those with exactly 2 columns: username and password).
+ * The picker suggests matching usernames as the user types.
  */
 void ResultsLoginScreen::updateAccounts()
 {
-    accountComboBox->clear();
-    // Open the CSV file and read usernames from rows with two columns (registration data)
-    QFile file("userdata.csv");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-        return;
-    QTextStream in(&file);
-    bool firstLine = true;
-    QSet<QString> accounts;
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty())
-            continue;
-        if (firstLine) {
-            firstLine = false;
-            continue;
-        }
-        QStringList parts = line.split(",");
-        if (parts.size() == 2) { // registration row
-            accounts.insert(parts[0]);
-        }
-    }
-    file.close();
-    // Populate combo box with account names
-    for (const QString &account : accounts) {
-        accountComboBox->addItem(account);
-    }
+    accountPicker->clear();
+    accountPicker->loadAccounts("userdata.csv");
 }
 
 /**
@@ -129,7 +105,7 @@ void ResultsLoginScreen::updateAccounts()
  */
 void ResultsLoginScreen::attemptLogin()
 {
-    QString selectedAccount = accountComboBox->currentText();
+    QString selectedAccount = accountPicker->selectedAccount();
     QString enteredPassword = passwordField->text().trimmed();
     
     // Check that both fields are non-empty.
@@ -137,7 +113,7 @@ void ResultsLoginScreen::attemptLogin()
         QMessageBox::warning(this, "Input Error", "Please select an account and enter the password!");
         // Clear fields on a failed attempt.
         passwordField->clear();
-        accountComboBox->setCurrentIndex(0);
+        accountPicker->clear();
         return;
     }
     
@@ -145,7 +121,7 @@ void ResultsLoginScreen::attemptLogin()
     if (enteredPassword.length() <= 4) {
         QMessageBox::warning(this, "Invalid Password", "Password must be more than 4 characters long!");
         passwordField->clear();
-        accountComboBox->setCurrentIndex(0);
+        accountPicker->clear();
         return;
     }
     
@@ -161,7 +137,7 @@ void ResultsLoginScreen::attemptLogin()
     if (!hasLetter || !hasDigit) {
         QMessageBox::warning(this, "Invalid Password", "Password must contain at least one letter and one number!");
         passwordField->clear();
-        accountComboBox->setCurrentIndex(0);
+        accountPicker->clear();
         return;
     }
     
@@ -170,7 +146,7 @@ void ResultsLoginScreen::attemptLogin()
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QMessageBox::warning(this, "File Error", "Could not open userdata.csv!");
         passwordField->clear();
-        accountComboBox->setCurrentIndex(0);
+        accountPicker->clear();
         return;
     }
     QTextStream in(&file);
@@ -190,6 +166,7 @@ void ResultsLoginScreen::attemptLogin()
             }
         }
     }
+    ReadingStore::countCsvBytesScanned(static_cast<std::uint64_t>(file.pos()));
     file.close();
 
     if (valid) {
@@ -198,9 +175,9 @@ void ResultsLoginScreen::attemptLogin()
         QMessageBox::warning(this, "Login Failed", "Incorrect password for the selected account!");
     }
     
-    // After every attempt, clear the password field and reset the drop-down.
+    // After every attempt, clear the password field and the account picker.
     passwordField->clear();
-    accountComboBox->setCurrentIndex(0);
+    accountPicker->clear();
 }
 
 /**
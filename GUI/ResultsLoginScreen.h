@@ -7,7 +7,7 @@
  * @brief Declaration of the ResultsLoginScreen widget.
  *
  * This file declares the ResultsLoginScreen class, which provides a user interface for logging in to view
- * previous results. The widget includes a combo box for account selection, a password field, and buttons
+ * previous results. The widget includes a type-ahead account picker, a password field, and buttons
  * for login and navigation. Upon successful login, a signal is emitted with the username.
  *
  * @note The class typically reads account information from a CSV file (e.g., "userdata.csv").
@@ -15,7 +15,7 @@
  * @author Ola Waked
  */
 #include "custombackgroundwidget.h"
-#include <QComboBox>
+#include "AccountPicker.h"
 #include <QLineEdit>
 #include <QPushButton>
 #include <QStackedWidget>
@@ -45,7 +45,7 @@ public:
     /**
      * @brief Updates the account list.
      *
-     * Reads available account names from a CSV file and populates the account combo box.
+     * Reads available account names from a CSV file into the account picker.
      */
     void updateAccounts();
 
@@ -75,12 +75,12 @@ private:
     /**
      * @brief Sets up the user interface.
      *
-     * Creates and arranges UI components such as the account combo box, password field, login button, and back button.
+     * Creates and arranges UI components such as the account picker, password field, login button, and back button.
      */
     void setupUI();
 
     QStackedWidget *stackedWidget;
-    QComboBox *accountComboBox;
+    AccountPicker *accountPicker;
     QLineEdit *passwordField;
     QPushButton *loginButton;
     QPushButton *backButton;
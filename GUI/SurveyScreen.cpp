@@ -1,7 +1,9 @@
 #include "Surveyscreen.h"
-#include <QFile>
-#include <QTextStream>
+#include "../AccountImport.h"
+#include "../ReadingStore.h"
+#include <QFileInfo>
 #include <QMessageBox>
+#include <QRegularExpression>
 
 
 /**
@@ -10,7 +12,7 @@
  *
  * This file defines the SurveyScreen class methods which provide an interface for new users to
  * register or log in by entering a username and password. The widget validates the input, checks for
- * existing usernames in a CSV file ("userdata.csv"), and saves new user data. Upon successful
+ * existing usernames in a CSV file ("userdata.csv"), and saves new user data through AccountImport. Upon successful
  * registration, it emits a signal indicating a successful survey login.
  *
  * @note The CSV file stores user registration information, including a header line if the file is new.
@@ -97,49 +99,34 @@ void SurveyScreen::saveUserData()
         return;
     }
 
-    // Password validation
+    // Password validation (AccountImport::isValidPassword applies the same rule to bulk imports)
     QRegularExpression regex("^(?=.*[A-Za-z])(?=.*\\d).{5,}$");
     if (!regex.match(password).hasMatch()) {
         QMessageBox::warning(this, "Password Error", "Password must be at least 5 characters long and contain at least one letter and one number.");
         return;
     }
 
-    QFile file("userdata.csv");
-    bool userAlreadyExists = false;
-
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        bool firstLine = true;
-        while (!in.atEnd()) {
-            QString line = in.readLine();
-            if (firstLine) {
-                firstLine = false;
-                continue;
-            }
-            QStringList parts = line.split(",");
-            if (!parts.isEmpty() && parts[0].compare(username, Qt::CaseInsensitive) == 0) {
-                userAlreadyExists = true;
-                break;
-            }
-        }
-        file.close();
+    AccountImport accounts("userdata.csv");
+    if (!accounts.loadExisting()) {
+        QMessageBox::warning(this, "Error", "Failed to read userdata.csv.");
+        return;
     }
-
-    if (userAlreadyExists) {
+    // The check for taken usernames reads the whole file.
+    ReadingStore::countCsvBytesScanned(static_cast<std::uint64_t>(QFileInfo("userdata.csv").size()));
+    // Compared case-folded, as QString::toCaseFolded() would
+    if (accounts.contains(username.toStdString())) {
         QMessageBox::warning(this, "Registration Error", "Username already exists! Please choose another.");
         return;
     }
 
-    bool fileExists = file.exists();
-    if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-        QTextStream out(&file);
-        if (!fileExists) {
-            out << "Username,Password\n";
-        }
-        out << username << "," << password << "\n";
-        file.close();
-
+    AccountRecord record;
+    record.username = username.toStdString();
+    record.password = password.toStdString();
+    AccountImportReport report = accounts.import({record});
+    if (report.imported == 1) {
         emit surveyLoginSuccessful(username);
+    } else if (!report.rejected.empty()) {
+        QMessageBox::warning(this, "Registration Error", QString::fromStdString(report.rejected.front().reason) + ".");
     } else {
         QMessageBox::warning(this, "Error", "Failed to save data to file.");
     }
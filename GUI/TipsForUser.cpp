@@ -1,4 +1,7 @@
 #include "TipsForUser.h"
+#include "../LifestyleOptimizer.h"
+#include "../RiskModel.h"
+#include "../SurveyStore.h"
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QPushButton>
@@ -32,10 +35,12 @@
  *
  * @param stackedWidgetRef Pointer to the QStackedWidget used for screen navigation.
  * @param riskLevel The risk level (e.g., "High", "Moderate", or other) used to tailor the displayed tips.
+ * @param username The user whose latest survey answers are used for the suggested lifestyle changes.
  * @param prevScreen Pointer to the previous widget screen for navigation.
  * @param parent Pointer to the parent widget (default is nullptr).
  */
-TipsForUser::TipsForUser(QStackedWidget *stackedWidgetRef, const QString &riskLevel, QWidget *prevScreen, QWidget *parent)
+TipsForUser::TipsForUser(QStackedWidget *stackedWidgetRef, const QString &riskLevel, const QString &username,
+                         QWidget *prevScreen, QWidget *parent)
     : QWidget(parent), stackedWidget(stackedWidgetRef), previousScreen(prevScreen)
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -88,6 +93,14 @@ TipsForUser::TipsForUser(QStackedWidget *stackedWidgetRef, const QString &riskLe
         scrollLayout->addWidget(box);
     };
 
+    // PERSONAL CHANGES RANKED BY RISK REDUCTION PER UNIT OF EFFORT
+    const QVector<QPair<QString, QString>> changes = bestChanges(username);
+    if (!changes.isEmpty()) {
+        addCategoryTitle("🎯 Your Best Next Steps");
+        for (const QPair<QString, QString> &change : changes)
+            addTipBox(change.first, change.second);
+    }
+
     // CURATED TIPS BASED ON RISK
     if (riskLevel == "High") {
         addTipBox("High Risk Detected: Please consult your doctor immediately.",
@@ -175,6 +188,43 @@ TipsForUser::TipsForUser(QStackedWidget *stackedWidgetRef, const QString &riskLe
     setLayout(mainLayout);
 }
 
+/**
+ * @brief Finds the lifestyle changes that lower the user's risk most per unit of effort.
+ *
+ * Uses the user's latest survey, which SurveyStore keeps per user, so opening the screen does not parse the
+ * survey log. The scoring table behind LifestyleOptimizer is built once; when the application has a trained
+ * risk model, changes are ranked by its probability.
+ *
+ * @param username User whose latest survey is used.
+ * @return QVector<QPair<QString, QString>> Title and detail of up to three suggestions.
+ */
+QVector<QPair<QString, QString>> TipsForUser::bestChanges(const QString &username)
+{
+    static const LifestyleOptimizer optimizer(LogisticRiskModel::installed());
+    static const char *tierNames[3] = { "Low", "Moderate", "High" };
+
+    QVector<QPair<QString, QString>> changes;
+    if (username.isEmpty()) return changes;
+    SurveyProfile latest;
+    if (!SurveyStore().loadLatest(username.toStdString(), latest)) return changes;
+
+    LifestyleChoice current;
+    current.sleepHours = latest.sleepHours;
+    current.exerciseFrequency = latest.exerciseFrequency;
+    current.dietType = latest.dietType;
+    current.smoker = latest.smoker;
+    for (const LifestyleSuggestion &suggestion : optimizer.suggest(latest, 3)) {
+        QString detail = optimizer.usesModel()
+            ? QString("Estimated risk %1% → %2%")
+                  .arg(suggestion.riskBefore * 100.0, 0, 'f', 1).arg(suggestion.riskAfter * 100.0, 0, 'f', 1)
+            : QString("Risk score %1 → %2").arg(suggestion.riskBefore, 0, 'f', 0).arg(suggestion.scoreAfter);
+        detail += QString(" (%1 risk).").arg(tierNames[suggestion.tierAfter]);
+        changes.append(qMakePair(QString::fromStdString(LifestyleOptimizer::describe(current, suggestion.choice)),
+                                 detail));
+    }
+    return changes;
+}
+
 /**
  * @brief Paints the custom gradient background.
  *
@@ -15,6 +15,8 @@
  */
 #include <QWidget>
 #include <QStackedWidget>
+#include <QPair>
+#include <QVector>
 
 /**
  * @class TipsForUser
@@ -28,11 +30,19 @@
 class TipsForUser : public QWidget {
     Q_OBJECT
 public:
-    // Now accepts a previousScreen pointer.
-    explicit TipsForUser(QStackedWidget *stackedWidgetRef, const QString &riskLevel, QWidget *previousScreen, QWidget *parent = nullptr);
+    // Now accepts a previousScreen pointer and the user whose latest survey drives the suggested changes.
+    explicit TipsForUser(QStackedWidget *stackedWidgetRef, const QString &riskLevel, const QString &username,
+                         QWidget *previousScreen, QWidget *parent = nullptr);
 protected:
     void paintEvent(QPaintEvent *event) override;
 private:
+    /**
+     * @brief Finds the lifestyle changes that lower the user's risk most per unit of effort.
+     * @param username User whose latest survey is used.
+     * @return QVector<QPair<QString, QString>> Title and detail of each suggestion (empty without a survey).
+     */
+    static QVector<QPair<QString, QString>> bestChanges(const QString &username);
+
     QStackedWidget *stackedWidget;
     QWidget *previousScreen; // The screen to return to.
 };
@@ -1,16 +1,26 @@
 #include "WelcomeScreen.h"
 #include "TipsForUser.h"
+#include "../AnomalyDetector.h"
+#include "../ReadingStore.h"
+#include "../ChangePointDetector.h"
+#include "../MatrixProfile.h"
+#include "../SurveyStore.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
-#include <QFile>
-#include <QTextStream>
 #include <QDateTime>
 #include <QFrame>
 #include <QPushButton>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QScatterSeries>
 #include <QtCharts/QValueAxis>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 using namespace QtCharts;
 
 /**
@@ -18,8 +28,18 @@ using namespace QtCharts;
  * @brief Implements the WelcomeScreen widget which displays a personalized welcome message,
  * user heart rate statistics, and a historical chart.
  *
- * The WelcomeScreen class reads the user's heart rate data from a CSV file ("userdata.csv"),
- * calculates statistics such as the average and latest heart rate, and determines the user's risk level.
+ * The WelcomeScreen class takes the user's average and latest heart rate from the user's summary rather than
+ * scanning "userdata.csv", and determines the user's risk level from
+ * the streaming EWMA/CUSUM detector kept in the user's summary, so that a recent bad stretch is not diluted by
+ * older normal readings and opening the screen does not replay the detector over the whole history.
+ * Long-term level shifts found by the offline change-point detector on the user's rollup summary are
+ * listed and marked on the history chart, as are the most unusual half-hour patterns of the last three days
+ * (discords of the matrix profile of the minute tier). A Holt-Winters model kept in the same summary projects the next
+ * 24 hours and flags the current hour when it strays from the projection. Percentile ranks against the
+ * population come from the shared quantile sketches rather than from other users' rows. A 24 x 7 heatmap of
+ * mean BPM by hour of day and day of week is kept per user and drawn as a single scaled image. The BPM
+ * distribution and time in each training zone come from the summary's day histograms, with zone boundaries
+ * set by the 220 - age estimate of maximum heart rate for the age group of the user's latest survey.
  * It also provides navigation buttons, including one to display tailored health tips via the TipsForUser widget.
  *
  * @note This widget is designed to be used within a QStackedWidget for screen navigation.
@@ -27,6 +47,221 @@ using namespace QtCharts;
  * @author Ola Waked
  */
 
+namespace {
+
+// The history chart plots at most this many rollup buckets.
+const std::size_t kMaxChartPoints = 2000;
+
+// Without a survey, zone boundaries assume the 220 - age estimate of maximum heart rate for a 40-year-old.
+const double kDefaultMaxHeartRate = 180.0;
+
+/**
+ * @brief Estimates maximum heart rate as 220 - age, taking the middle of a survey age group.
+ * @param ageGroup Survey age group: 1: 18-24, 2: 25-34, 3: 35-44, 4: 45-54, 5: 55-64, 6: 65+.
+ * @return double Maximum heart rate in BPM.
+ */
+double estimatedMaxHeartRate(int ageGroup)
+{
+    static const double midpoints[] = { 21.0, 29.5, 39.5, 49.5, 59.5, 70.0 };
+    if (ageGroup < 1 || ageGroup > 6) return kDefaultMaxHeartRate;
+    return 220.0 - midpoints[ageGroup - 1];
+}
+
+/**
+ * @brief Spells a whole number as an English ordinal, e.g. 1st, 12th, 22nd.
+ * @param value The number.
+ * @return QString The ordinal.
+ */
+QString ordinal(int value)
+{
+    int lastTwo = value % 100;
+    const char *suffix = "th";
+    if (lastTwo < 11 || lastTwo > 13) {
+        if (value % 10 == 1) suffix = "st";
+        else if (value % 10 == 2) suffix = "nd";
+        else if (value % 10 == 3) suffix = "rd";
+    }
+    return QString::number(value) + suffix;
+}
+
+/**
+ * @brief Draws a BpmHistogram as bars coloured by training zone, with the share of readings per zone.
+ */
+class HistogramView : public QWidget {
+public:
+    /**
+     * @brief Keeps a copy of the histogram to draw.
+     * @param histogram Histogram to show.
+     * @param maxHeartRate The user's estimated maximum heart rate, which sets the zone boundaries.
+     * @param parent Pointer to the parent widget.
+     */
+    HistogramView(const BpmHistogram &histogram, double maxHeartRate, QWidget *parent)
+        : QWidget(parent),
+          histogram(histogram),
+          maxHeartRate(maxHeartRate)
+    {
+        setMinimumHeight(160);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), Qt::black);
+        painter.setPen(Qt::white);
+        QFont font = painter.font();
+        font.setBold(true);
+        painter.setFont(font);
+        if (histogram.empty()) {
+            painter.drawText(rect(), Qt::AlignCenter, "BPM Distribution: no readings yet");
+            return;
+        }
+        HeartRateZones zones = histogram.zones(maxHeartRate);
+        painter.drawText(QRect(0, 0, width(), 24), Qt::AlignCenter,
+                         "BPM Distribution: resting " + QString::number(zones.resting * 100.0, 'f', 0) +
+                         "%, fat burn " + QString::number(zones.fatBurn * 100.0, 'f', 0) + "%, cardio " +
+                         QString::number(zones.cardio * 100.0, 'f', 0) + "%");
+        font.setBold(false);
+        painter.setFont(font);
+
+        int low = 0, high = BpmHistogram::kBins - 1;
+        while (histogram.bin(low) == 0) ++low;
+        while (histogram.bin(high) == 0) --high;
+        long long tallest = 0;
+        for (int bpm = low; bpm <= high; ++bpm) tallest = qMax(tallest, histogram.bin(bpm));
+
+        QRectF bars(10, 28, width() - 20, height() - 50);
+        if (bars.width() <= 0 || bars.height() <= 0) return;
+        double barWidth = bars.width() / (high - low + 1);
+        double fatBurnStart = std::ceil(0.5 * maxHeartRate);
+        double cardioStart = std::ceil(0.7 * maxHeartRate);
+        for (int bpm = low; bpm <= high; ++bpm) {
+            double barHeight = bars.height() * histogram.bin(bpm) / tallest;
+            QColor colour = bpm >= cardioStart ? QColor(230, 60, 60)
+                          : bpm >= fatBurnStart ? QColor(255, 170, 0) : QColor(80, 160, 255);
+            painter.fillRect(QRectF(bars.left() + (bpm - low) * barWidth, bars.bottom() - barHeight,
+                                    qMax(barWidth, 1.0), barHeight), colour);
+        }
+        painter.drawText(QRectF(bars.left(), bars.bottom() + 2, bars.width(), 18), Qt::AlignLeft | Qt::AlignTop,
+                         QString::number(low) + " BPM");
+        painter.drawText(QRectF(bars.left(), bars.bottom() + 2, bars.width(), 18), Qt::AlignRight | Qt::AlignTop,
+                         QString::number(high) + " BPM");
+    }
+
+private:
+    BpmHistogram histogram; /**< Readings to draw. */
+    double maxHeartRate;    /**< Estimated maximum heart rate for the zone boundaries. */
+};
+
+/**
+ * @brief Draws a WeeklyHeatmap as one image with one pixel per cell, scaled to the widget.
+ */
+class HeatmapView : public QWidget {
+public:
+    /**
+     * @brief Builds the cell image and the title from a heatmap.
+     * @param heatmap Heatmap to show.
+     * @param parent Pointer to the parent widget.
+     */
+    HeatmapView(const WeeklyHeatmap &heatmap, QWidget *parent)
+        : QWidget(parent),
+          image(WeeklyHeatmap::kHours, WeeklyHeatmap::kDays, QImage::Format_RGB32)
+    {
+        double low = 1e9, high = -1e9;
+        int hotDay = -1, hotHour = -1;
+        for (int day = 0; day < WeeklyHeatmap::kDays; ++day) {
+            for (int hour = 0; hour < WeeklyHeatmap::kHours; ++hour) {
+                double mean = heatmap.mean(day, hour);
+                if (mean < 0) continue;
+                low = qMin(low, mean);
+                if (mean > high) {
+                    high = mean;
+                    hotDay = day;
+                    hotHour = hour;
+                }
+            }
+        }
+        // Blue for the user's calmest hours through red for their highest, dark grey where there is no data.
+        for (int day = 0; day < WeeklyHeatmap::kDays; ++day) {
+            QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(day));
+            for (int hour = 0; hour < WeeklyHeatmap::kHours; ++hour) {
+                double mean = heatmap.mean(day, hour);
+                if (mean < 0) {
+                    line[hour] = qRgb(40, 40, 40);
+                    continue;
+                }
+                double f = high > low ? (mean - low) / (high - low) : 0.5;
+                line[hour] = QColor::fromHsvF((1.0 - f) * 240.0 / 360.0, 0.85, 0.95).rgb();
+            }
+        }
+        if (hotDay >= 0)
+            title = "Weekly Pattern: " + QString::number(low, 'f', 0) + "-" + QString::number(high, 'f', 0) +
+                    " BPM, highest " + dayNames()[hotDay] + " " +
+                    QString("%1:00").arg(hotHour, 2, 10, QChar('0'));
+        else
+            title = "Weekly Pattern: no hourly data yet";
+        setMinimumHeight(160);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), Qt::black);
+        painter.setPen(Qt::white);
+        QFont font = painter.font();
+        font.setBold(true);
+        painter.setFont(font);
+        painter.drawText(QRect(0, 0, width(), 24), Qt::AlignCenter, title);
+        font.setBold(false);
+        painter.setFont(font);
+
+        QRect cells(40, 28, width() - 50, height() - 50);
+        if (cells.width() <= 0 || cells.height() <= 0) return;
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+        painter.drawImage(cells, image);
+
+        double rowHeight = cells.height() / double(WeeklyHeatmap::kDays);
+        for (int day = 0; day < WeeklyHeatmap::kDays; ++day)
+            painter.drawText(QRectF(0, cells.top() + day * rowHeight, 36, rowHeight),
+                             Qt::AlignRight | Qt::AlignVCenter, dayNames()[day]);
+        double columnWidth = cells.width() / double(WeeklyHeatmap::kHours);
+        for (int hour = 0; hour < WeeklyHeatmap::kHours; hour += 3)
+            painter.drawText(QRectF(cells.left() + hour * columnWidth, cells.bottom() + 2, columnWidth * 3, 18),
+                             Qt::AlignLeft | Qt::AlignTop, QString::number(hour) + "h");
+    }
+
+private:
+    static const QStringList& dayNames()
+    {
+        static const QStringList names = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+        return names;
+    }
+
+    QImage image;   /**< One pixel per cell: rows are days (Monday first), columns are hours. */
+    QString title;  /**< Range and hottest cell. */
+};
+
+} // namespace
+
+/**
+ * @brief Gets a user's cached weekly heatmap, laid out in the current local time zone.
+ *
+ * The heatmap survives across visits to the screen, so each visit only folds in the hours added since the
+ * last one. A change of UTC offset (for example daylight saving) starts a fresh heatmap.
+ *
+ * @param username The user's username.
+ * @return WeeklyHeatmap& The cached heatmap.
+ */
+WeeklyHeatmap& WelcomeScreen::heatmapFor(const QString &username)
+{
+    static QHash<QString, WeeklyHeatmap> cache;
+    long long offset = QDateTime::currentDateTime().offsetFromUtc();
+    auto it = cache.find(username);
+    if (it == cache.end() || it->getUtcOffset() != offset)
+        it = cache.insert(username, WeeklyHeatmap(offset));
+    return *it;
+}
 
  /**
  * @brief Constructs a new WelcomeScreen object.
@@ -62,54 +297,127 @@ WelcomeScreen::WelcomeScreen(QStackedWidget *stackedWidgetRef,
     welcomeLabel->setStyleSheet("color: white; font-size: 28px; font-weight: bold;");
     infoLayout->addWidget(welcomeLabel);
 
-    // Read CSV for stats
-    QVector<double> heartRates;
-    qint64 latestTimestamp = 0;
-    QFile file("userdata.csv");
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        bool firstLine = true;
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (firstLine) { firstLine = false; continue; }
-            QStringList parts = line.split(",");
-            if (parts.size() == 3 && parts[0] == user) {
-                bool ok;
-                double bpm = parts[2].toDouble(&ok);
-                if (ok) heartRates.append(bpm);
-                latestTimestamp = parts[1].toLongLong();
-            }
-        }
-        file.close();
-    }
+    // The latest survey supplies the age group for the BPM zones and the tier for the percentile comparison.
+    SurveyProfile survey;
+    bool surveyed = SurveyStore().loadLatest(user.toStdString(), survey);
+
+    // Retrospective level shifts come from the rollup summary, so months of history cost milliseconds. The
+    // summary also carries the EWMA/CUSUM detector, already fed every reading of this user.
+    std::vector<ChangePoint> changePoints;
+    UserSummary summary;
+    if (ReadingStore().loadSummary(user.toStdString(), summary))
+        changePoints = ChangePointDetector().detect(summary.rollup);
+    // The lifetime figures merge the day tier, so their cost does not grow with the length of the history.
+    RollupBucket lifetime = summary.rollup.summarize(HeartRateRollup::Day, 0, std::numeric_limits<long long>::max());
+    WeeklyHeatmap &heatmap = heatmapFor(user);
+    // A few days of minutes keep the quadratic matrix profile to a few milliseconds.
+    std::vector<ProfileEvent> discords;
+    MatrixProfile profile;
+    long long profileEnd = summary.rollup.getLastTimestamp() + 1;
+    if (profile.computeFromRollup(summary.rollup, profileEnd - 3 * 86400, profileEnd, 30))
+        discords = profile.discords(3);
+    heatmap.update(summary.rollup);
 
     QLabel *riskLabel = new QLabel(this);
     QLabel *averageLabel = new QLabel(this);
     QLabel *latestLabel = new QLabel(this);
+    QLabel *spo2Label = new QLabel(this);
+    QLabel *changeLabel = new QLabel(this);
+    QLabel *shiftLabel = new QLabel(this);
+    QLabel *patternLabel = new QLabel(this);
+    QLabel *forecastLabel = new QLabel(this);
+    QLabel *percentileLabel = new QLabel(this);
     QLabel *timestampLabel = new QLabel(this);
 
     riskLabel->setStyleSheet("color: white; font-size: 20px;");
     averageLabel->setStyleSheet("color: white; font-size: 18px;");
     latestLabel->setStyleSheet("color: white; font-size: 18px;");
+    spo2Label->setStyleSheet("color: white; font-size: 18px;");
+    changeLabel->setStyleSheet("color: white; font-size: 16px;");
+    changeLabel->setWordWrap(true);
+    shiftLabel->setStyleSheet("color: white; font-size: 16px;");
+    shiftLabel->setWordWrap(true);
+    patternLabel->setStyleSheet("color: white; font-size: 16px;");
+    patternLabel->setWordWrap(true);
+    forecastLabel->setStyleSheet("color: white; font-size: 16px;");
+    forecastLabel->setWordWrap(true);
+    percentileLabel->setStyleSheet("color: white; font-size: 16px;");
+    percentileLabel->setWordWrap(true);
     timestampLabel->setStyleSheet("color: white; font-size: 16px; font-style: italic;");
 
-    if (!heartRates.isEmpty()) {
-        double sum = 0;
-        for (double val : heartRates) sum += val;
-        double avg = sum / heartRates.size();
-        double latest = heartRates.last();
+    if (lifetime.count > 0) {
+        double avg = lifetime.mean();
+        double latest = summary.latestBpm;
 
-        QString risk;
-        if (avg < 80) risk = "Low";
-        else if (avg < 100) risk = "Moderate";
-        else risk = "High";
+        // Risk follows the recent EWMA level (plus any active upward alarm), not the lifetime average.
+        QString risk = QString::fromStdString(summary.detector.classifyRisk());
 
         averageLabel->setText("Average Heart Rate: " + QString::number(avg, 'f', 1) + " BPM");
         latestLabel->setText("Latest Heart Rate: " + QString::number(latest, 'f', 1) + " BPM");
         riskLabel->setText("Risk Level: " + risk);
+        if (summary.latestSpO2 >= 0)
+            spo2Label->setText("Latest SpO2: " + QString::number(summary.latestSpO2, 'f', 1) + " %");
+
+        if (summary.changeCount > 0) {
+            const ChangeEvent &last = summary.lastChange;
+            changeLabel->setText("Last Change: " + QString::fromStdString(describeChangeEvent(last)) + " at " +
+                                 QDateTime::fromSecsSinceEpoch(last.timestamp).toString("yyyy-MM-dd hh:mm") +
+                                 " (" + QString::number(summary.changeCount) + " total)");
+        }
+
+        if (!changePoints.empty()) {
+            const ChangePoint &last = changePoints.back();
+            shiftLabel->setText("Level Shifts: " + QString::number(changePoints.size()) + " (latest " +
+                                QString::number(last.shift(), 'f', 1) + " BPM on " +
+                                QDateTime::fromSecsSinceEpoch(last.timestamp).toString("yyyy-MM-dd hh:mm") + ")");
+        }
+
+        if (!discords.empty()) {
+            QDateTime start = QDateTime::fromSecsSinceEpoch(discords.front().timestamp);
+            patternLabel->setText("Unusual Patterns: " + QString::number(discords.size()) +
+                                  " marked in magenta (most unusual from " + start.toString("yyyy-MM-dd hh:mm") + ")");
+        }
 
-        if (latestTimestamp > 0) {
-            QDateTime dt = QDateTime::fromSecsSinceEpoch(latestTimestamp);
+        // Rank against everyone else using only the population sketches.
+        PopulationStats population;
+        ReadingStore().loadPopulation(population);
+        double dayRank = population.percentileRank(PopulationStats::userDayKey(), avg);
+        if (dayRank >= 0) {
+            QString text = "Your average is higher than " + QString::number(dayRank, 'f', 0) +
+                           "% of daily averages";
+            // Readings are filed under the tier of the survey assessment they came with, so the comparison
+            // uses the user's latest assessment rather than the heart-rate level above.
+            if (surveyed) {
+                const std::string tier = SurveyProfile::tierName(survey.tier);
+                // The tier's age-group sketches merge into one distribution for the whole tier.
+                QuantileSketch tierSketch;
+                for (int ageGroup = 1; ageGroup <= 6; ++ageGroup) {
+                    const QuantileSketch *sketch = population.find(PopulationStats::vitalKey("bpm", tier, ageGroup));
+                    if (sketch) tierSketch.merge(*sketch);
+                }
+                if (!tierSketch.empty())
+                    text += "; latest reading is at the " +
+                            ordinal(static_cast<int>(std::lround(tierSketch.percentileRank(latest)))) +
+                            " percentile of " + QString::fromStdString(tier) + " risk readings";
+            }
+            percentileLabel->setText(text + ".");
+        }
+
+        // Compare the hour still filling up with what the model expected for it.
+        const std::vector<RollupBucket> &hours = summary.rollup.buckets(HeartRateRollup::Hour);
+        if (summary.forecaster.isReady() && !hours.empty()) {
+            const RollupBucket &current = hours.back();
+            double expected = summary.forecaster.forecastAt(current.start);
+            bool deviation = summary.forecaster.isDeviation(current.mean(), expected);
+            forecastLabel->setText("This Hour: " + QString::number(current.mean(), 'f', 1) + " BPM (forecast " +
+                                   QString::number(expected, 'f', 1) + " BPM)" +
+                                   (deviation ? " - outside the expected range" : ""));
+            if (deviation)
+                forecastLabel->setStyleSheet("color: #ff6060; font-size: 16px; font-weight: bold;");
+        }
+
+        if (summary.latestTimestamp > 0) {
+            QDateTime dt = QDateTime::fromSecsSinceEpoch(summary.latestTimestamp);
             timestampLabel->setText("Last Reading: " + dt.toString("yyyy-MM-dd hh:mm:ss"));
         }
     } else {
@@ -119,6 +427,12 @@ WelcomeScreen::WelcomeScreen(QStackedWidget *stackedWidgetRef,
     infoLayout->addWidget(riskLabel);
     infoLayout->addWidget(averageLabel);
     infoLayout->addWidget(latestLabel);
+    infoLayout->addWidget(spo2Label);
+    infoLayout->addWidget(changeLabel);
+    infoLayout->addWidget(shiftLabel);
+    infoLayout->addWidget(patternLabel);
+    infoLayout->addWidget(forecastLabel);
+    infoLayout->addWidget(percentileLabel);
     infoLayout->addWidget(timestampLabel);
     infoLayout->addStretch();
 
@@ -130,6 +444,7 @@ WelcomeScreen::WelcomeScreen(QStackedWidget *stackedWidgetRef,
         // Create TipsForUser with the current WelcomeScreen (this) as the previous screen.
         TipsForUser *tipsScreen = new TipsForUser(stackedWidget,
                                                   riskLabel->text().section(':', 1).trimmed(),
+                                                  user,
                                                   this, // previous screen pointer
                                                   stackedWidget); // set parent to stackedWidget
         stackedWidget->addWidget(tipsScreen);
@@ -146,7 +461,26 @@ WelcomeScreen::WelcomeScreen(QStackedWidget *stackedWidgetRef,
     });
     infoLayout->addWidget(backBtn);
 
-    // Create chart from CSV data
+    // The history chart plots bucket means of the finest rollup tier that covers the whole history in at most
+    // kMaxChartPoints buckets, so it costs the same for a week of readings as for years of them. The minute
+    // tier only qualifies while it still reaches back to the first reading.
+    HeartRateRollup::Tier chartTier = HeartRateRollup::Day;
+    const std::vector<RollupBucket> &hourBuckets = summary.rollup.buckets(HeartRateRollup::Hour);
+    if (summary.rollup.buckets(HeartRateRollup::Minute).size() <= kMaxChartPoints &&
+        (hourBuckets.empty() || hourBuckets.front().start >= summary.rollup.minuteHorizon()))
+        chartTier = HeartRateRollup::Minute;
+    else if (hourBuckets.size() <= kMaxChartPoints)
+        chartTier = HeartRateRollup::Hour;
+    const std::vector<RollupBucket> &chartBuckets = summary.rollup.buckets(chartTier);
+    // Tiers are kept in time order however the readings arrived, so a binary search finds a time's bucket.
+    auto chartIndex = [&](long long timestamp) {
+        long long start = HeartRateRollup::bucketStart(timestamp, chartTier);
+        return static_cast<int>(std::lower_bound(chartBuckets.begin(), chartBuckets.end(), start,
+                                                 [](const RollupBucket &bucket, long long time) {
+                                                     return bucket.start < time;
+                                                 }) - chartBuckets.begin());
+    };
+
     QChart *chart = new QChart();
     QLineSeries *series = new QLineSeries();
     chart->addSeries(series);
@@ -155,19 +489,50 @@ WelcomeScreen::WelcomeScreen(QStackedWidget *stackedWidgetRef,
     redPen.setWidth(2);
     series->setPen(redPen);
 
-    for (int i = 0; i < heartRates.size(); ++i) {
-        series->append(i, heartRates[i]);
+    for (int i = 0; i < static_cast<int>(chartBuckets.size()); ++i) {
+        series->append(i, chartBuckets[i].mean());
+    }
+
+    // Mark each level shift at the bucket holding it (or the first one after it).
+    QScatterSeries *shiftMarkers = new QScatterSeries();
+    shiftMarkers->setName("Level shift");
+    shiftMarkers->setMarkerSize(12);
+    shiftMarkers->setColor(Qt::yellow);
+    shiftMarkers->setBorderColor(Qt::yellow);
+    for (const ChangePoint &point : changePoints) {
+        int index = chartIndex(point.timestamp);
+        if (index < static_cast<int>(chartBuckets.size()))
+            shiftMarkers->append(index, chartBuckets[index].mean());
+    }
+    chart->addSeries(shiftMarkers);
+
+    // Mark each discord at the bucket where its window starts.
+    QScatterSeries *discordMarkers = new QScatterSeries();
+    discordMarkers->setName("Unusual pattern");
+    discordMarkers->setMarkerShape(QScatterSeries::MarkerShapeRectangle);
+    discordMarkers->setMarkerSize(12);
+    discordMarkers->setColor(Qt::magenta);
+    discordMarkers->setBorderColor(Qt::magenta);
+    for (const ProfileEvent &discord : discords) {
+        int index = chartIndex(discord.timestamp);
+        if (index < static_cast<int>(chartBuckets.size()))
+            discordMarkers->append(index, chartBuckets[index].mean());
     }
+    chart->addSeries(discordMarkers);
+    chart->legend()->hide();
 
     QValueAxis *axisX = new QValueAxis();
-    // Fix: use int literal 50 so both arguments are int.
-    axisX->setRange(0, qMax(heartRates.size(), 50));
+    axisX->setRange(0, qMax(static_cast<int>(chartBuckets.size()), 50));
     axisX->setTitleText("Time");
     axisX->setLabelsColor(Qt::white);
     axisX->setTitleBrush(QBrush(Qt::white));
 
     QValueAxis *axisY = new QValueAxis();
-    axisY->setRange(50, 130);
+    if (lifetime.count == 0)
+        axisY->setRange(50, 130);
+    else
+        axisY->setRange(std::floor((lifetime.min - 5.0) / 10.0) * 10.0,
+                        std::ceil((lifetime.max + 5.0) / 10.0) * 10.0);
     axisY->setTitleText("BPM");
     axisY->setLabelsColor(Qt::white);
     axisY->setTitleBrush(QBrush(Qt::white));
@@ -176,6 +541,10 @@ WelcomeScreen::WelcomeScreen(QStackedWidget *stackedWidgetRef,
     chart->addAxis(axisY, Qt::AlignLeft);
     series->attachAxis(axisX);
     series->attachAxis(axisY);
+    shiftMarkers->attachAxis(axisX);
+    shiftMarkers->attachAxis(axisY);
+    discordMarkers->attachAxis(axisX);
+    discordMarkers->attachAxis(axisY);
 
     chart->setTitle("Preiviously Generated Heart Rate Monitor Chart");
     QFont titleFont;
@@ -192,7 +561,88 @@ WelcomeScreen::WelcomeScreen(QStackedWidget *stackedWidgetRef,
     chartView->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     chartView->setStyleSheet("background-color: black; border: none;");
 
+    // Projected trend for the 24 hours after the newest hour bucket, with a +/- 2 sigma band.
+    QChart *forecastChart = new QChart();
+    QLineSeries *forecastSeries = new QLineSeries();
+    QLineSeries *upperSeries = new QLineSeries();
+    QLineSeries *lowerSeries = new QLineSeries();
+    QPen forecastPen(QColor(255, 170, 0));
+    forecastPen.setWidth(2);
+    forecastSeries->setPen(forecastPen);
+    QPen bandPen(QColor(255, 170, 0));
+    bandPen.setStyle(Qt::DashLine);
+    upperSeries->setPen(bandPen);
+    lowerSeries->setPen(bandPen);
+
+    double forecastMin = 50, forecastMax = 130;
+    const std::vector<RollupBucket> &hourBuckets = summary.rollup.buckets(HeartRateRollup::Hour);
+    if (summary.forecaster.isReady() && !hourBuckets.empty()) {
+        double band = 2.0 * summary.forecaster.getResidualSigma();
+        forecastMin = 1e9;
+        forecastMax = -1e9;
+        for (int h = 1; h <= 24; ++h) {
+            double value = summary.forecaster.forecastAt(hourBuckets.back().start + h * HoltWinters::kStepSeconds);
+            forecastSeries->append(h, value);
+            upperSeries->append(h, value + band);
+            lowerSeries->append(h, value - band);
+            forecastMin = qMin(forecastMin, value - band);
+            forecastMax = qMax(forecastMax, value + band);
+        }
+        forecastMin = std::floor((forecastMin - 5.0) / 10.0) * 10.0;
+        forecastMax = std::ceil((forecastMax + 5.0) / 10.0) * 10.0;
+        forecastChart->setTitle("Projected Heart Rate (next 24 h)");
+    } else {
+        forecastChart->setTitle("Projected Heart Rate (needs 24 h of history)");
+    }
+    forecastChart->addSeries(forecastSeries);
+    forecastChart->addSeries(upperSeries);
+    forecastChart->addSeries(lowerSeries);
+    forecastChart->legend()->hide();
+
+    QValueAxis *forecastAxisX = new QValueAxis();
+    forecastAxisX->setRange(0, 24);
+    forecastAxisX->setTickCount(7);
+    forecastAxisX->setLabelFormat("%d");
+    forecastAxisX->setTitleText("Hours Ahead");
+    forecastAxisX->setLabelsColor(Qt::white);
+    forecastAxisX->setTitleBrush(QBrush(Qt::white));
+
+    QValueAxis *forecastAxisY = new QValueAxis();
+    forecastAxisY->setRange(forecastMin, forecastMax);
+    forecastAxisY->setTitleText("BPM");
+    forecastAxisY->setLabelsColor(Qt::white);
+    forecastAxisY->setTitleBrush(QBrush(Qt::white));
+
+    forecastChart->addAxis(forecastAxisX, Qt::AlignBottom);
+    forecastChart->addAxis(forecastAxisY, Qt::AlignLeft);
+    for (QLineSeries *s : { forecastSeries, upperSeries, lowerSeries }) {
+        s->attachAxis(forecastAxisX);
+        s->attachAxis(forecastAxisY);
+    }
+    forecastChart->setTitleFont(titleFont);
+    forecastChart->setTitleBrush(QBrush(Qt::white));
+    forecastChart->setBackgroundBrush(QBrush(Qt::black));
+    forecastChart->setPlotAreaBackgroundBrush(QBrush(Qt::black));
+    forecastChart->setPlotAreaBackgroundVisible(true);
+
+    QChartView *forecastView = new QChartView(forecastChart);
+    forecastView->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    forecastView->setStyleSheet("background-color: black; border: none;");
+
+    QVBoxLayout *chartLayout = new QVBoxLayout();
+    chartLayout->setSpacing(20);
+    chartLayout->addWidget(chartView, 2);
+    chartLayout->addWidget(forecastView, 1);
+    QHBoxLayout *patternLayout = new QHBoxLayout();
+    patternLayout->setSpacing(20);
+    patternLayout->addWidget(new HeatmapView(heatmap, this), 3);
+    patternLayout->addWidget(new HistogramView(summary.histograms.total(),
+                                                surveyed ? estimatedMaxHeartRate(survey.ageGroup)
+                                                         : kDefaultMaxHeartRate,
+                                                this), 2);
+    chartLayout->addLayout(patternLayout, 1);
+
     mainLayout->addWidget(infoFrame, 1);
-    mainLayout->addWidget(chartView, 2);
+    mainLayout->addLayout(chartLayout, 2);
     setLayout(mainLayout);
 }
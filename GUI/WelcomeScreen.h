@@ -7,7 +7,8 @@
  *
  * This file declares the WelcomeScreen class, which displays a personalized welcome message
  * along with the user's heart health statistics and a historical chart. It integrates with the
- * HeartHealthScreen to present detailed heart health information.
+ * HeartHealthScreen to present detailed heart health information. A weekly heatmap shows the user's mean
+ * heart rate by hour of day and day of week.
  *
  * @note This widget is intended to be used within a QStackedWidget for smooth screen transitions.
  *
@@ -16,6 +17,7 @@
 
 #include "custombackgroundwidget.h"
 #include "HeartHealthScreen.h"
+#include "../WeeklyHeatmap.h"
 #include <QStackedWidget>
 #include <QString>
 #include <QLabel>
@@ -47,6 +49,13 @@ public:
                            QWidget *parent = nullptr);
 
 private:
+    /**
+     * @brief Gets a user's cached weekly heatmap, laid out in the current local time zone.
+     * @param username The user's username.
+     * @return WeeklyHeatmap& The cached heatmap (empty the first time it is requested).
+     */
+    static WeeklyHeatmap& heatmapFor(const QString &username);
+
     QStackedWidget *stackedWidget;
     QString user;
     QLabel *welcomeLabel;
@@ -1,4 +1,5 @@
 #include "custombackgroundwidget.h"
+#include "../MetricsRegistry.h"
 #include <QPainter>
 #include <QPainterPath>
 #include <QLinearGradient>
@@ -29,8 +30,11 @@ CustomBackgroundWidget::CustomBackgroundWidget(QWidget *parent)
     : QWidget(parent), offsetX(0)
 {
     // Timer for the animation
+    static MetricCounter &ticks = MetricsRegistry::global().counter(
+        "heartpi_gui_timer_ticks_total{timer=\"background_animation\"}", "GUI timer callbacks run, by timer.");
     timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, [=]() {
+        ticks.add();
         offsetX += 10;
         if (offsetX > width()) {
             offsetX = 0;
@@ -5,19 +5,68 @@
  * This file contains the main function which initializes the QApplication, creates and shows
  * the MainWindow, and starts the application's event loop.
  *
+ * It also serves the process metrics in Prometheus text format on http://127.0.0.1:9464/metrics (the port
+ * can be changed with HEARTPI_METRICS_PORT, or set to 0 to turn the endpoint off) and runs a watchdog timer
+ * that records how late the event loop gets around to it, counting a stall whenever it is blocked for long.
+ *
  * @return int Application exit status.
  * @author Ola Waked
  */
 
 #include "mainwindow.h"
+#include "../HttpServer.h"
+#include "../MetricsRegistry.h"
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <thread>
+
+namespace {
+
+const int kWatchdogMs = 50;             // Watchdog timer period.
+const double kStallSeconds = 0.25;      // Lateness counted as a stall.
+
+}
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    // The endpoint runs on a thread of its own so a stalled GUI can still be scraped.
+    HttpServer metricsServer;
+    metricsServer.route("GET", "/metrics", [](const HttpRequest &, HttpResponse &response) {
+        response.contentType = MetricsRegistry::kContentType;
+        response.body = MetricsRegistry::global().exposition();
+    });
+    bool portOk = false;
+    int metricsPort = qEnvironmentVariableIntValue("HEARTPI_METRICS_PORT", &portOk);
+    if (!portOk) metricsPort = 9464;
+    std::thread metricsThread;
+    if (metricsPort > 0 && metricsPort <= 65535 &&
+        metricsServer.listen("127.0.0.1", static_cast<std::uint16_t>(metricsPort)))
+        metricsThread = std::thread([&metricsServer]() { metricsServer.run(); });
+
+    MetricCounter &stalls = MetricsRegistry::global().counter(
+        "heartpi_gui_stalls_total", "Times the GUI event loop was blocked for more than 250 ms.");
+    MetricHistogram &lag = MetricsRegistry::global().histogram(
+        "heartpi_gui_event_loop_lag_seconds", "How late the GUI watchdog timer fired.",
+        {0.005, 0.025, 0.1, 0.25, 1.0, 5.0});
+    QElapsedTimer sinceTick;
+    sinceTick.start();
+    QTimer watchdog;
+    QObject::connect(&watchdog, &QTimer::timeout, [&]() {
+        double late = static_cast<double>(sinceTick.restart() - kWatchdogMs) / 1000.0;
+        if (late < 0.0) late = 0.0;
+        lag.observe(late);
+        if (late > kStallSeconds) stalls.add();
+    });
+    watchdog.start(kWatchdogMs);
+
     MainWindow window;
     window.show();
 
-    return app.exec();
+    int status = app.exec();
+    metricsServer.stop();
+    if (metricsThread.joinable()) metricsThread.join();
+    return status;
 }
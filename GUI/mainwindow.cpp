@@ -5,7 +5,8 @@
  * The MainWindow sets up the main menu with an animated background and provides navigation
  * between various screens: SurveyScreen for user registration/login, SurveyFormScreen for survey input,
  * HeartHealthScreen for displaying heart health statistics, ResultsLoginScreen for viewing past results,
- * WelcomeScreen for personalized greetings, and NotifyCaregiverScreen for sending alerts.
+ * WelcomeScreen for personalized greetings, NotifyCaregiverScreen for sending alerts, and
+ * CaregiverDashboardScreen for the users who need attention now.
  *
  * @note The application uses a QStackedWidget to manage screen transitions.
  *
@@ -19,6 +20,7 @@
 #include "TipsForUser.h"
 #include "EmailSender.h"
 #include "NotifyCaregiverScreen.h"  // New include
+#include "CaregiverDashboardScreen.h"
 #include <QVBoxLayout>
 #include <QApplication>
 #include <QLabel>
@@ -97,7 +99,7 @@ void MainWindow::setupMainMenu()
 
     QFrame *container = new QFrame(mainMenuWidget);
     container->setStyleSheet("background-color: #662255; border-radius: 20px;");
-    container->setFixedSize(500, 500);
+    container->setFixedSize(500, 580);
 
     QVBoxLayout *containerLayout = new QVBoxLayout(container);
     containerLayout->setAlignment(Qt::AlignCenter);
@@ -138,6 +140,12 @@ void MainWindow::setupMainMenu()
     notifyButton->setFixedSize(300, 60);
     containerLayout->addWidget(notifyButton, 0, Qt::AlignCenter);
 
+    // --- Caregiver Dashboard Button ---
+    QPushButton *dashboardButton = new QPushButton("Caregiver Dashboard", container);
+    dashboardButton->setStyleSheet(buttonStyle);
+    dashboardButton->setFixedSize(300, 60);
+    containerLayout->addWidget(dashboardButton, 0, Qt::AlignCenter);
+
     layout->addWidget(container, 0, Qt::AlignCenter);
 
     // Start the animated background once (and let it run continuously)
@@ -155,6 +163,13 @@ void MainWindow::setupMainMenu()
         stackedWidget->setCurrentWidget(notifyScreen);
     });
 
+    // --- Caregiver Dashboard Button Connection ---
+    connect(dashboardButton, &QPushButton::clicked, [=]() {
+        CaregiverDashboardScreen *dashboardScreen = new CaregiverDashboardScreen(stackedWidget);
+        stackedWidget->addWidget(dashboardScreen);
+        stackedWidget->setCurrentWidget(dashboardScreen);
+    });
+
 
     // ----------- Exit Button at Bottom Right Without Breaking Layout ------------
     QPushButton *exitButton = new QPushButton("Exit", mainMenuWidget);
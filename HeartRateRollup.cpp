@@ -0,0 +1,305 @@
+/**
+ * @file HeartRateRollup.cpp
+ * @brief Implements the HeartRateRollup tiers.
+ *
+ * The serialised form is plain CSV so that it can sit next to userdata.csv and be inspected by hand:
+ * one "tier,<index>,<bucketCount>" line followed by one "start,count,sum,sumSquares,min,max" line per bucket.
+ * writeChanges() uses the same layout with a fourth "tier" field, the start of the first bucket it covers.
+ */
+
+#include "HeartRateRollup.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+/**
+ * @brief Parses one "start,count,sum,sumSquares,min,max" line.
+ *
+ * strtod/strtoll avoid a stringstream per line, which matters for minute tiers with hundreds of thousands
+ * of buckets.
+ *
+ * @param line Source line.
+ * @param[out] bucket Parsed bucket.
+ * @return bool False if a field is missing.
+ */
+bool parseBucket(const std::string &line, RollupBucket &bucket) {
+    const char *p = line.c_str();
+    char *end = nullptr;
+    bucket.start = std::strtoll(p, &end, 10);
+    if (*end != ',') return false;
+    bucket.count = std::strtoll(end + 1, &end, 10);
+    if (*end != ',') return false;
+    bucket.sum = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    bucket.sumSquares = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    bucket.min = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    bucket.max = std::strtod(end + 1, &end);
+    return end != line.c_str();
+}
+
+/**
+ * @brief Reads a "tier,<index>,<bucketCount>[,<from>]" line.
+ * @param line Source line.
+ * @param tier Expected tier index.
+ * @param[out] bucketCount Number of bucket lines that follow.
+ * @param[out] end Set to the character after the bucket count.
+ * @return bool False if the line is malformed.
+ */
+bool parseTierLine(const std::string &line, int tier, long long &bucketCount, char *&end) {
+    if (line.compare(0, 5, "tier,") != 0) return false;
+    long index = std::strtol(line.c_str() + 5, &end, 10);
+    if (index != tier || *end != ',') return false;
+    bucketCount = std::strtoll(end + 1, &end, 10);
+    return bucketCount >= 0;
+}
+
+} // namespace
+
+/**
+ * @brief Adds one reading to the bucket.
+ * @param bpm Heart rate in beats per minute.
+ */
+void RollupBucket::add(double bpm) {
+    if (count == 0) {
+        min = bpm;
+        max = bpm;
+    } else {
+        if (bpm < min) min = bpm;
+        if (bpm > max) max = bpm;
+    }
+    ++count;
+    sum += bpm;
+    sumSquares += bpm * bpm;
+}
+
+/**
+ * @brief Merges another bucket's statistics into this one.
+ * @param other Bucket to merge.
+ */
+void RollupBucket::merge(const RollupBucket &other) {
+    if (other.count == 0) return;
+    if (count == 0) {
+        min = other.min;
+        max = other.max;
+    } else {
+        if (other.min < min) min = other.min;
+        if (other.max > max) max = other.max;
+    }
+    count += other.count;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+}
+
+/**
+ * @brief Gets the bucket width of a tier.
+ * @param tier Rollup tier.
+ * @return long long Width in seconds.
+ */
+long long HeartRateRollup::tierSeconds(Tier tier) {
+    static const long long widths[kTierCount] = { 60, 3600, 86400 };
+    return widths[tier];
+}
+
+/**
+ * @brief Aligns a timestamp to the start of its bucket (floor division, so pre-1970 values stay aligned).
+ * @param timestamp Seconds since epoch.
+ * @param tier Rollup tier.
+ * @return long long Bucket start.
+ */
+long long HeartRateRollup::bucketStart(long long timestamp, Tier tier) {
+    long long width = tierSeconds(tier);
+    long long q = timestamp / width;
+    if (timestamp % width < 0) --q;
+    return q * width;
+}
+
+/**
+ * @brief Adds one reading to every tier.
+ * @param timestamp Seconds since epoch.
+ * @param bpm Heart rate in beats per minute.
+ */
+void HeartRateRollup::addReading(long long timestamp, double bpm) {
+    if (timestamp > lastTimestamp) lastTimestamp = timestamp;
+    for (int t = 0; t < kTierCount; ++t) {
+        std::vector<RollupBucket> &tier = tiers[t];
+        long long start = bucketStart(timestamp, static_cast<Tier>(t));
+        if (t == Minute && start < minuteHorizon()) continue;
+        if (!tier.empty() && tier.back().start == start) {
+            tier.back().add(bpm);
+        } else if (tier.empty() || tier.back().start < start) {
+            RollupBucket bucket;
+            bucket.start = start;
+            bucket.add(bpm);
+            tier.push_back(bucket);
+        } else {
+            auto it = std::lower_bound(tier.begin(), tier.end(), start,
+                                       [](const RollupBucket &b, long long s) { return b.start < s; });
+            if (it == tier.end() || it->start != start) {
+                RollupBucket bucket;
+                bucket.start = start;
+                it = tier.insert(it, bucket);
+            }
+            it->add(bpm);
+        }
+    }
+    // Waiting for an hour's worth keeps the erase, which shifts the whole tier, off the per-reading path.
+    trimMinutes(tierSeconds(Hour));
+}
+
+/**
+ * @brief Drops minute buckets before the horizon once they are more than a given slack behind it.
+ * @param slack Seconds of older buckets that may stay.
+ */
+void HeartRateRollup::trimMinutes(long long slack) {
+    std::vector<RollupBucket> &minutes = tiers[Minute];
+    long long horizon = minuteHorizon();
+    if (minutes.empty() || minutes.front().start >= horizon - slack) return;
+    auto keep = std::lower_bound(minutes.begin(), minutes.end(), horizon,
+                                 [](const RollupBucket &b, long long s) { return b.start < s; });
+    minutes.erase(minutes.begin(), keep);
+}
+
+/**
+ * @brief Merges the buckets of a tier that overlap a time range.
+ * @param tier Rollup tier.
+ * @param from Inclusive range start.
+ * @param to Exclusive range end.
+ * @return RollupBucket Combined statistics.
+ */
+RollupBucket HeartRateRollup::summarize(Tier tier, long long from, long long to) const {
+    const std::vector<RollupBucket> &buckets = tiers[tier];
+    long long width = tierSeconds(tier);
+    auto it = std::lower_bound(buckets.begin(), buckets.end(), from - width + 1,
+                               [](const RollupBucket &b, long long s) { return b.start < s; });
+    RollupBucket total;
+    total.start = from;
+    for (; it != buckets.end() && it->start < to; ++it) total.merge(*it);
+    return total;
+}
+
+/**
+ * @brief Gets the total number of readings added.
+ * @return long long Reading count.
+ */
+long long HeartRateRollup::getReadingCount() const {
+    long long total = 0;
+    for (const RollupBucket &b : tiers[Day]) total += b.count;
+    return total;
+}
+
+/**
+ * @brief Removes all buckets.
+ */
+void HeartRateRollup::clear() {
+    for (int t = 0; t < kTierCount; ++t) tiers[t].clear();
+    lastTimestamp = 0;
+}
+
+/**
+ * @brief Writes the tiers as CSV sections.
+ *
+ * Minute buckets before the horizon that have not been trimmed yet are left out, so the output does not
+ * depend on when the last trim happened.
+ *
+ * @param out Output stream.
+ */
+void HeartRateRollup::write(std::ostream &out) const {
+    out << "last," << lastTimestamp << "\n";
+    std::streamsize precision = out.precision(17);
+    for (int t = 0; t < kTierCount; ++t) {
+        auto first = tiers[t].begin();
+        if (t == Minute)
+            first = std::lower_bound(first, tiers[t].end(), minuteHorizon(),
+                                     [](const RollupBucket &b, long long s) { return b.start < s; });
+        out << "tier," << t << "," << (tiers[t].end() - first) << "\n";
+        for (auto it = first; it != tiers[t].end(); ++it) {
+            out << it->start << "," << it->count << "," << it->sum << "," << it->sumSquares << ","
+                << it->min << "," << it->max << "\n";
+        }
+    }
+    out.precision(precision);
+}
+
+/**
+ * @brief Reads tiers previously produced by write().
+ * @param in Input stream positioned at the "last" line.
+ * @return bool False if the data is malformed.
+ */
+bool HeartRateRollup::read(std::istream &in) {
+    clear();
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 5, "last,") != 0) return false;
+    lastTimestamp = std::strtoll(line.c_str() + 5, nullptr, 10);
+
+    for (int t = 0; t < kTierCount; ++t) {
+        char *end = nullptr;
+        long long bucketCount = 0;
+        if (!std::getline(in, line) || !parseTierLine(line, t, bucketCount, end)) return false;
+
+        tiers[t].resize(static_cast<std::size_t>(bucketCount));
+        for (RollupBucket &b : tiers[t]) {
+            if (!std::getline(in, line) || !parseBucket(line, b)) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the buckets that readings at or after a given time can have touched.
+ *
+ * The tier lines carry the start of the first bucket they cover, so readChanges() knows which buckets the
+ * section replaces even when it holds none.
+ *
+ * @param out Output stream.
+ * @param since Earliest timestamp added since the last write.
+ */
+void HeartRateRollup::writeChanges(std::ostream &out, long long since) const {
+    out << "last," << lastTimestamp << "\n";
+    std::streamsize precision = out.precision(17);
+    for (int t = 0; t < kTierCount; ++t) {
+        long long from = bucketStart(since, static_cast<Tier>(t));
+        auto first = std::lower_bound(tiers[t].begin(), tiers[t].end(), from,
+                                      [](const RollupBucket &b, long long s) { return b.start < s; });
+        out << "tier," << t << "," << (tiers[t].end() - first) << "," << from << "\n";
+        for (auto it = first; it != tiers[t].end(); ++it) {
+            out << it->start << "," << it->count << "," << it->sum << "," << it->sumSquares << ","
+                << it->min << "," << it->max << "\n";
+        }
+    }
+    out.precision(precision);
+}
+
+/**
+ * @brief Applies buckets previously produced by writeChanges().
+ * @param in Input stream positioned at the "last" line.
+ * @return bool False if the data is malformed.
+ */
+bool HeartRateRollup::readChanges(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 5, "last,") != 0) return false;
+    lastTimestamp = std::strtoll(line.c_str() + 5, nullptr, 10);
+
+    RollupBucket bucket;
+    for (int t = 0; t < kTierCount; ++t) {
+        char *end = nullptr;
+        long long bucketCount = 0;
+        if (!std::getline(in, line) || !parseTierLine(line, t, bucketCount, end) || *end != ',') return false;
+        long long from = std::strtoll(end + 1, nullptr, 10);
+
+        std::vector<RollupBucket> &tier = tiers[t];
+        tier.erase(std::lower_bound(tier.begin(), tier.end(), from,
+                                    [](const RollupBucket &b, long long s) { return b.start < s; }),
+                   tier.end());
+        for (long long i = 0; i < bucketCount; ++i) {
+            if (!std::getline(in, line) || !parseBucket(line, bucket)) return false;
+            if (bucket.start < from || (!tier.empty() && bucket.start <= tier.back().start)) return false;
+            tier.push_back(bucket);
+        }
+    }
+    trimMinutes(0);
+    return true;
+}
@@ -0,0 +1,165 @@
+#ifndef HEARTRATEROLLUP_H
+#define HEARTRATEROLLUP_H
+
+/**
+ * @file HeartRateRollup.h
+ * @brief Declaration of the HeartRateRollup class and its RollupBucket records.
+ *
+ * This header declares time-bucketed summaries of a user's heart-rate readings at three resolutions
+ * (1 minute, 1 hour and 1 day). Long-history analyses work on these tiers instead of rescanning every raw
+ * per-second reading in userdata.csv.
+ */
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Sufficient statistics for the readings that fall inside one time bucket.
+ */
+struct RollupBucket {
+    long long start = 0;        /**< Bucket start (seconds since epoch, aligned to the tier width). */
+    long long count = 0;        /**< Number of readings. */
+    double sum = 0.0;           /**< Sum of BPM values. */
+    double sumSquares = 0.0;    /**< Sum of squared BPM values. */
+    double min = 0.0;           /**< Smallest BPM value. */
+    double max = 0.0;           /**< Largest BPM value. */
+
+    /**
+     * @brief Adds one reading to the bucket.
+     * @param bpm Heart rate in beats per minute.
+     */
+    void add(double bpm);
+
+    /**
+     * @brief Merges another bucket's statistics into this one.
+     * @param other Bucket to merge.
+     */
+    void merge(const RollupBucket &other);
+
+    /** @return double Mean BPM of the bucket (0 if empty). */
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+};
+
+/**
+ * @class HeartRateRollup
+ * @brief Minute, hour and day rollup tiers for one user's heart-rate history.
+ *
+ * Each tier is a vector of non-empty buckets sorted by start time. Readings normally arrive in time order
+ * and are appended in O(1); an out-of-order reading is placed with a binary search.
+ *
+ * The minute tier only keeps the last kMinuteRetention seconds before the newest reading; older minutes live
+ * on in the hour and day tiers. Without the cap a summary would grow by 1440 buckets a day forever.
+ */
+class HeartRateRollup {
+public:
+    /**
+     * @brief Rollup resolutions, finest first.
+     */
+    enum Tier {
+        Minute = 0,
+        Hour = 1,
+        Day = 2
+    };
+
+    static const int kTierCount = 3;    /**< Number of tiers. */
+    static const long long kMinuteRetention = 14 * 86400;  /**< Seconds of minute buckets kept. */
+
+    /**
+     * @brief Gets the bucket width of a tier.
+     * @param tier Rollup tier.
+     * @return long long Width in seconds.
+     */
+    static long long tierSeconds(Tier tier);
+
+    /**
+     * @brief Aligns a timestamp to the start of its bucket.
+     * @param timestamp Seconds since epoch.
+     * @param tier Rollup tier.
+     * @return long long Bucket start.
+     */
+    static long long bucketStart(long long timestamp, Tier tier);
+
+    /**
+     * @brief Adds one reading to every tier.
+     * @param timestamp Seconds since epoch.
+     * @param bpm Heart rate in beats per minute.
+     */
+    void addReading(long long timestamp, double bpm);
+
+    /**
+     * @brief Gets the buckets of a tier.
+     * @param tier Rollup tier.
+     * @return const std::vector<RollupBucket>& Non-empty buckets sorted by start.
+     */
+    const std::vector<RollupBucket>& buckets(Tier tier) const { return tiers[tier]; }
+
+    /**
+     * @brief Merges the buckets of a tier that overlap a time range.
+     * @param tier Rollup tier.
+     * @param from Inclusive range start (seconds since epoch).
+     * @param to Exclusive range end (seconds since epoch).
+     * @return RollupBucket Combined statistics (count 0 if nothing overlaps).
+     */
+    RollupBucket summarize(Tier tier, long long from, long long to) const;
+
+    /** @return long long Total number of readings added. */
+    long long getReadingCount() const;
+
+    /** @return long long Timestamp of the newest reading (0 if none). */
+    long long getLastTimestamp() const { return lastTimestamp; }
+
+    /**
+     * @brief Gets the start of the oldest minute the minute tier is guaranteed to hold.
+     *
+     * Minute buckets from here on are complete; earlier minutes may have been dropped, so callers that need
+     * minute resolution further back have to fall back to the hour tier or the raw readings.
+     *
+     * @return long long Minute-aligned timestamp.
+     */
+    long long minuteHorizon() const { return bucketStart(lastTimestamp - kMinuteRetention, Minute); }
+
+    /**
+     * @brief Removes all buckets.
+     */
+    void clear();
+
+    /**
+     * @brief Writes the tiers as CSV sections.
+     * @param out Output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads tiers previously produced by write().
+     * @param in Input stream positioned at the first tier section.
+     * @return bool False if the data is malformed.
+     */
+    bool read(std::istream &in);
+
+    /**
+     * @brief Writes only the buckets that readings at or after a given time can have touched.
+     * @param out Output stream.
+     * @param since Earliest timestamp added since the last write.
+     */
+    void writeChanges(std::ostream &out, long long since) const;
+
+    /**
+     * @brief Applies buckets previously produced by writeChanges(), replacing the ones they cover.
+     * @param in Input stream positioned at the "last" line.
+     * @return bool False if the data is malformed (the tiers are then in an unspecified state).
+     */
+    bool readChanges(std::istream &in);
+
+private:
+    std::vector<RollupBucket> tiers[kTierCount];   /**< Buckets per tier. */
+    long long lastTimestamp = 0;                    /**< Newest reading seen. */
+
+    /**
+     * @brief Drops minute buckets before the horizon once they are more than a given slack behind it.
+     * @param slack Seconds of older buckets that may stay.
+     */
+    void trimMinutes(long long slack);
+};
+
+#endif // HEARTRATEROLLUP_H
@@ -0,0 +1,230 @@
+/**
+ * @file HoltWinters.cpp
+ * @brief Implements the incremental Holt-Winters heart-rate forecaster.
+ *
+ * The serialised state is two CSV lines:
+ * "holtwinters,first,last,seen,ready,seenSlots,level,trend,residualVar,residualCount,lastForecast,lastActual"
+ * and "seasonal,s0,...,s23".
+ */
+
+#include "HoltWinters.h"
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+const double kResidualRate = 0.05;  // EWMA weight of the newest squared error
+const double kMinSigma = 1.0;       // BPM; matches the anomaly detector's sigma floor
+
+} // namespace
+
+/**
+ * @brief Constructs a new HoltWinters object.
+ * @param alpha Level smoothing weight.
+ * @param beta Trend smoothing weight.
+ * @param gamma Seasonal smoothing weight.
+ * @param phi Trend damping factor.
+ */
+HoltWinters::HoltWinters(double alpha, double beta, double gamma, double phi)
+    : alpha(alpha), beta(beta), gamma(gamma), phi(phi) {}
+
+/**
+ * @brief Gets the seasonal slot (hour of day, UTC) of an hour.
+ * @param bucketStart Start of the hour.
+ * @return int Slot in [0, kSeasonLength).
+ */
+int HoltWinters::slotOf(long long bucketStart) {
+    long long hour = bucketStart / kStepSeconds;
+    if (bucketStart % kStepSeconds < 0) --hour;
+    long long slot = hour % kSeasonLength;
+    return static_cast<int>(slot < 0 ? slot + kSeasonLength : slot);
+}
+
+/**
+ * @brief Sum of phi^1 .. phi^h.
+ * @param h Steps ahead.
+ * @return double Multiplier.
+ */
+double HoltWinters::dampedSteps(long long h) const {
+    if (phi >= 1.0) return static_cast<double>(h);
+    return phi * (1.0 - std::pow(phi, static_cast<double>(h))) / (1.0 - phi);
+}
+
+/**
+ * @brief Feeds the mean of one completed hourly bucket.
+ * @param bucketStart Start of the hour.
+ * @param bpm Mean heart rate of the hour.
+ */
+void HoltWinters::update(long long bucketStart, double bpm) {
+    if (bucketsSeen > 0 && bucketStart <= lastBucketStart) return;
+    int slot = slotOf(bucketStart);
+
+    if (!ready) {
+        // Warm-up: running mean for the level, raw hourly values for the seasonal profile.
+        if (bucketsSeen == 0) firstBucketStart = bucketStart;
+        ++bucketsSeen;
+        level += (bpm - level) / bucketsSeen;
+        season[slot] = bpm;
+        seenSlots |= 1u << slot;
+        lastBucketStart = bucketStart;
+        lastActual = bpm;
+        if (bucketStart - firstBucketStart >= (kSeasonLength - 1) * kStepSeconds) {
+            for (int s = 0; s < kSeasonLength; ++s)
+                season[s] = (seenSlots & (1u << s)) ? season[s] - level : 0.0;
+            trend = 0.0;
+            ready = true;
+        }
+        return;
+    }
+
+    long long gap = (bucketStart - lastBucketStart) / kStepSeconds;
+    double projected = level + dampedSteps(gap) * trend;
+    double forecastValue = projected + season[slot];
+    double error = bpm - forecastValue;
+    residualVar = residualCount == 0 ? error * error
+                                     : (1.0 - kResidualRate) * residualVar + kResidualRate * error * error;
+    ++residualCount;
+
+    double previousLevel = level;
+    level = alpha * (bpm - season[slot]) + (1.0 - alpha) * projected;
+    trend = beta * (level - previousLevel) / gap + (1.0 - beta) * std::pow(phi, static_cast<double>(gap)) * trend;
+    season[slot] = gamma * (bpm - level) + (1.0 - gamma) * season[slot];
+
+    ++bucketsSeen;
+    lastBucketStart = bucketStart;
+    lastForecast = forecastValue;
+    lastActual = bpm;
+}
+
+/**
+ * @brief Forecasts one specific hour.
+ * @param bucketStart Start of an hour after the last bucket fed.
+ * @return double Forecast BPM (0 until the model is ready).
+ */
+double HoltWinters::forecastAt(long long bucketStart) const {
+    if (!ready) return 0.0;
+    long long h = (bucketStart - lastBucketStart) / kStepSeconds;
+    if (h < 1) h = 1;
+    return level + dampedSteps(h) * trend + season[slotOf(bucketStart)];
+}
+
+/**
+ * @brief Forecasts the hours following the last bucket fed.
+ * @param steps Number of hourly steps to forecast.
+ * @return std::vector<double> One forecast per step (empty until the model is ready).
+ */
+std::vector<double> HoltWinters::forecast(int steps) const {
+    std::vector<double> values;
+    if (!ready || steps <= 0) return values;
+    values.reserve(static_cast<std::size_t>(steps));
+    double damped = 0.0;
+    double power = 1.0;
+    for (int h = 1; h <= steps; ++h) {
+        power *= phi;
+        damped += power;
+        long long start = lastBucketStart + h * kStepSeconds;
+        values.push_back(level + damped * trend + season[slotOf(start)]);
+    }
+    return values;
+}
+
+/**
+ * @brief Gets the standard deviation of recent one-step forecast errors.
+ * @return double Sigma in BPM, floored at 1 BPM.
+ */
+double HoltWinters::getResidualSigma() const {
+    return std::fmax(std::sqrt(residualVar), kMinSigma);
+}
+
+/**
+ * @brief Tests whether a value deviates from the forecast for its hour.
+ *
+ * Never flags before a day of one-step errors has been collected, since the residual sigma is not yet
+ * meaningful.
+ *
+ * @param actual Observed BPM.
+ * @param expected Forecast BPM.
+ * @param limit Allowed deviation in residual standard deviations.
+ * @return bool True for a deviation.
+ */
+bool HoltWinters::isDeviation(double actual, double expected, double limit) const {
+    if (!ready || residualCount < kSeasonLength) return false;
+    return std::fabs(actual - expected) > limit * getResidualSigma();
+}
+
+/**
+ * @brief Clears the model state.
+ */
+void HoltWinters::clear() {
+    *this = HoltWinters(alpha, beta, gamma, phi);
+}
+
+/**
+ * @brief Writes the model state.
+ * @param out Output stream.
+ */
+void HoltWinters::write(std::ostream &out) const {
+    std::streamsize precision = out.precision(17);
+    out << "holtwinters," << firstBucketStart << "," << lastBucketStart << "," << bucketsSeen << ","
+        << (ready ? 1 : 0) << "," << seenSlots << "," << level << "," << trend << "," << residualVar << ","
+        << residualCount << "," << lastForecast << "," << lastActual << "\n";
+    out << "seasonal";
+    for (int s = 0; s < kSeasonLength; ++s) out << "," << season[s];
+    out << "\n";
+    out.precision(precision);
+}
+
+/**
+ * @brief Reads state previously produced by write().
+ * @param in Input stream positioned at the "holtwinters" line.
+ * @return bool False if the data is malformed.
+ */
+bool HoltWinters::read(std::istream &in) {
+    std::string header;
+    if (!std::getline(in, header)) return false;
+    return read(header, in);
+}
+
+/**
+ * @brief Parses state whose "holtwinters" line has already been read.
+ * @param header The "holtwinters" line.
+ * @param in Input stream positioned at the "seasonal" line.
+ * @return bool False if the data is malformed.
+ */
+bool HoltWinters::read(const std::string &header, std::istream &in) {
+    clear();
+    if (header.compare(0, 12, "holtwinters,") != 0) return false;
+    char *end = nullptr;
+    const char *p = header.c_str() + 12;
+    firstBucketStart = std::strtoll(p, &end, 10);
+    if (*end != ',') return false;
+    lastBucketStart = std::strtoll(end + 1, &end, 10);
+    if (*end != ',') return false;
+    bucketsSeen = std::strtoll(end + 1, &end, 10);
+    if (*end != ',') return false;
+    ready = std::strtol(end + 1, &end, 10) != 0;
+    if (*end != ',') return false;
+    seenSlots = static_cast<unsigned>(std::strtoul(end + 1, &end, 10));
+    if (*end != ',') return false;
+    level = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    trend = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    residualVar = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    residualCount = std::strtoll(end + 1, &end, 10);
+    if (*end != ',') return false;
+    lastForecast = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    lastActual = std::strtod(end + 1, &end);
+
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 8, "seasonal") != 0) return false;
+    p = line.c_str() + 8;
+    for (int s = 0; s < kSeasonLength; ++s) {
+        if (*p != ',') return false;
+        season[s] = std::strtod(p + 1, &end);
+        p = end;
+    }
+    return true;
+}
@@ -0,0 +1,159 @@
+#ifndef HOLTWINTERS_H
+#define HOLTWINTERS_H
+
+/**
+ * @file HoltWinters.h
+ * @brief Declaration of the HoltWinters forecaster for hourly heart-rate means.
+ *
+ * This header declares additive triple exponential smoothing (level, damped trend and a 24-hour seasonal
+ * profile) fed one completed hourly rollup bucket at a time. The whole state is a few dozen numbers, so it is
+ * kept in each user's summary file and a forecast never needs the raw history.
+ */
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class HoltWinters
+ * @brief Incremental damped additive Holt-Winters model with daily seasonality on hourly buckets.
+ *
+ * Update equations for an observation y at seasonal slot s (phi is the trend damping):
+ *   level    = alpha * (y - season[s]) + (1 - alpha) * (level + phi * trend)
+ *   trend    = beta * (level - previousLevel) + (1 - beta) * phi * trend
+ *   season[s] = gamma * (y - level) + (1 - gamma) * season[s]
+ *
+ * The first 24 hours only seed the level and the seasonal profile. Hours without readings are skipped by
+ * projecting the trend across the gap. Each update is O(1).
+ */
+class HoltWinters {
+public:
+    static const int kSeasonLength = 24;        /**< Hourly buckets per seasonal cycle. */
+    static const long long kStepSeconds = 3600; /**< Width of one step (the hour rollup tier). */
+
+    /**
+     * @brief Constructs a new HoltWinters object.
+     * @param alpha Level smoothing weight.
+     * @param beta Trend smoothing weight.
+     * @param gamma Seasonal smoothing weight.
+     * @param phi Trend damping factor (1 for an undamped trend).
+     */
+    explicit HoltWinters(double alpha = 0.2, double beta = 0.01, double gamma = 0.1, double phi = 0.98);
+
+    /**
+     * @brief Feeds the mean of one completed hourly bucket.
+     *
+     * Buckets must arrive in time order; a bucket at or before the last one fed is ignored.
+     *
+     * @param bucketStart Start of the hour (seconds since epoch, aligned to kStepSeconds).
+     * @param bpm Mean heart rate of the hour.
+     */
+    void update(long long bucketStart, double bpm);
+
+    /**
+     * @brief Forecasts the hours following the last bucket fed.
+     * @param steps Number of hourly steps to forecast.
+     * @return std::vector<double> Forecast for the hours starting at getNextBucketStart(), one per step
+     * (empty until the model is ready).
+     */
+    std::vector<double> forecast(int steps) const;
+
+    /**
+     * @brief Forecasts one specific hour.
+     * @param bucketStart Start of an hour after the last bucket fed.
+     * @return double Forecast BPM (0 until the model is ready).
+     */
+    double forecastAt(long long bucketStart) const;
+
+    /** @return bool True once a full seasonal cycle has been seen. */
+    bool isReady() const { return ready; }
+
+    /** @return long long Start of the last hour fed (0 if none). */
+    long long getLastBucketStart() const { return lastBucketStart; }
+
+    /** @return long long Start of the hour the one-step forecast refers to. */
+    long long getNextBucketStart() const { return lastBucketStart + kStepSeconds; }
+
+    /** @return long long Number of hours fed. */
+    long long getBucketsSeen() const { return bucketsSeen; }
+
+    /** @return double Standard deviation of recent one-step forecast errors (BPM). */
+    double getResidualSigma() const;
+
+    /** @return double Forecast made for the last hour fed, before it was observed. */
+    double getLastForecast() const { return lastForecast; }
+
+    /** @return double Observed mean of the last hour fed. */
+    double getLastActual() const { return lastActual; }
+
+    /**
+     * @brief Tests whether a value deviates from the forecast for its hour.
+     * @param actual Observed BPM.
+     * @param expected Forecast BPM.
+     * @param limit Allowed deviation in residual standard deviations.
+     * @return bool True if |actual - expected| exceeds limit * getResidualSigma().
+     */
+    bool isDeviation(double actual, double expected, double limit = 3.0) const;
+
+    /**
+     * @brief Clears the model state (the smoothing parameters are kept).
+     */
+    void clear();
+
+    /**
+     * @brief Writes the model state as a "holtwinters" line and a "seasonal" line.
+     * @param out Output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads state previously produced by write().
+     * @param in Input stream positioned at the "holtwinters" line.
+     * @return bool False if the data is malformed.
+     */
+    bool read(std::istream &in);
+
+    /**
+     * @brief Parses state whose "holtwinters" line has already been read.
+     * @param header The "holtwinters" line.
+     * @param in Input stream positioned at the "seasonal" line.
+     * @return bool False if the data is malformed.
+     */
+    bool read(const std::string &header, std::istream &in);
+
+private:
+    double alpha;                       /**< Level smoothing weight. */
+    double beta;                        /**< Trend smoothing weight. */
+    double gamma;                       /**< Seasonal smoothing weight. */
+    double phi;                         /**< Trend damping factor. */
+
+    double level = 0.0;                 /**< Deseasonalised level. */
+    double trend = 0.0;                 /**< Per-hour trend. */
+    double season[kSeasonLength] = {};  /**< Additive offset per hour of day. */
+    unsigned seenSlots = 0;             /**< Bit per hour of day observed during warm-up. */
+    bool ready = false;                 /**< True after the first full seasonal cycle. */
+    long long lastBucketStart = 0;      /**< Start of the last hour fed. */
+    long long firstBucketStart = 0;     /**< Start of the first hour fed. */
+    long long bucketsSeen = 0;          /**< Number of hours fed. */
+    double residualVar = 0.0;           /**< EWMA of squared one-step errors. */
+    long long residualCount = 0;        /**< Number of one-step errors folded into residualVar. */
+    double lastForecast = 0.0;          /**< One-step forecast for the last hour fed. */
+    double lastActual = 0.0;            /**< Observed mean of the last hour fed. */
+
+    /**
+     * @brief Gets the seasonal slot (hour of day, UTC) of an hour.
+     * @param bucketStart Start of the hour.
+     * @return int Slot in [0, kSeasonLength).
+     */
+    static int slotOf(long long bucketStart);
+
+    /**
+     * @brief Sum of phi^1 .. phi^h, the damped trend multiplier for h steps ahead.
+     * @param h Steps ahead.
+     * @return double Multiplier.
+     */
+    double dampedSteps(long long h) const;
+};
+
+#endif // HOLTWINTERS_H
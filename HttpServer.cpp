@@ -0,0 +1,600 @@
+/**
+ * @file HttpServer.cpp
+ * @brief Implements the epoll-based embedded HTTP/1.1 server.
+ */
+
+#include "HttpServer.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const std::size_t kMaxHeaderBytes = 16 * 1024;  // Request line plus headers.
+const std::size_t kReadChunk = 64 * 1024;       // Bytes requested per recv().
+const std::size_t kMaxReadPerEvent = 1 << 20;   // Keeps one fast sender from starving the others.
+const std::size_t kMaxPendingOutput = 4 << 20;  // Unsent bytes above which a connection is not read.
+const long long kIdleTimeoutMs = 60 * 1000;     // Connections silent this long are closed.
+const int kSweepIntervalMs = 1000;              // How often idle connections are looked for.
+const int kMaxEvents = 64;
+
+/**
+ * @brief Gets the steady clock in milliseconds.
+ * @return long long Milliseconds.
+ */
+long long steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Compares a header name with a lowercase name, ignoring ASCII case.
+ * @param name Header name as received.
+ * @param length Its length.
+ * @param lower Lowercase name to compare with.
+ * @return bool True if equal.
+ */
+bool headerIs(const char *name, std::size_t length, const char *lower) {
+    for (std::size_t i = 0; i < length; ++i, ++lower) {
+        char c = name[i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (*lower == '\0' || c != *lower) return false;
+    }
+    return *lower == '\0';
+}
+
+/**
+ * @brief Checks whether a comma-separated header value contains a token, ignoring ASCII case.
+ * @param value Header value.
+ * @param length Its length.
+ * @param lower Lowercase token.
+ * @return bool True if present.
+ */
+bool headerHasToken(const char *value, std::size_t length, const char *lower) {
+    std::size_t tokenLength = std::strlen(lower);
+    std::size_t start = 0;
+    while (start < length) {
+        std::size_t stop = start;
+        while (stop < length && value[stop] != ',') ++stop;
+        std::size_t a = start, b = stop;
+        while (a < b && (value[a] == ' ' || value[a] == '\t')) ++a;
+        while (b > a && (value[b - 1] == ' ' || value[b - 1] == '\t')) --b;
+        if (b - a == tokenLength && headerIs(value + a, tokenLength, lower)) return true;
+        start = stop + 1;
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a server that is not listening yet.
+ * @param maxBodyBytes Largest accepted body.
+ */
+HttpServer::HttpServer(std::size_t maxBodyBytes) : maxBody(maxBodyBytes) {}
+
+HttpServer::~HttpServer() {
+    for (auto &entry : connections) ::close(entry.first);
+    if (listenFd >= 0) ::close(listenFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+/**
+ * @brief Starts listening.
+ * @param address IPv4 address to bind.
+ * @param port TCP port (0 picks a free one).
+ * @return bool False if the socket could not be bound.
+ */
+bool HttpServer::listen(const std::string &address, std::uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        ErrorHandling::logErrorMessage("HTTP server: invalid address " + address);
+        return false;
+    }
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int yes = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        ErrorHandling::logErrorMessage("HTTP server: cannot listen on " + address + ":" + std::to_string(port) +
+                                       ": " + std::strerror(errno));
+        if (listenFd >= 0) ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr *>(&addr), &length);
+    boundPort = ntohs(addr.sin_port);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    return true;
+}
+
+/**
+ * @brief Registers a handler.
+ * @param method Request method.
+ * @param path Exact path.
+ * @param handler Called for matching requests.
+ */
+void HttpServer::route(const std::string &method, const std::string &path, Handler handler) {
+    routes[method + " " + path] = std::move(handler);
+}
+
+/**
+ * @brief Waits for and handles socket events once.
+ * @param timeoutMs Longest wait in milliseconds.
+ * @return bool False if the server is not listening or the wait failed.
+ */
+bool HttpServer::poll(int timeoutMs) {
+    if (epollFd < 0) return false;
+    // With clients connected the wait is cut short now and then to close the idle ones.
+    if (!connections.empty() && (timeoutMs < 0 || timeoutMs > kSweepIntervalMs)) timeoutMs = kSweepIntervalMs;
+    epoll_event events[kMaxEvents];
+    int ready = epoll_wait(epollFd, events, kMaxEvents, timeoutMs);
+    if (ready < 0) return errno == EINTR;
+    for (int i = 0; i < ready; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == listenFd) {
+            acceptClients();
+            continue;
+        }
+        if (fd == wakeFd) {
+            std::uint64_t value = 0;
+            while (::read(wakeFd, &value, sizeof(value)) > 0) {}
+            drainCompleted();
+            continue;
+        }
+        auto it = connections.find(fd);
+        if (it == connections.end()) continue;
+        bool keep = true;
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) keep = readClient(fd, it->second);
+        if (keep && (events[i].events & EPOLLOUT)) keep = serve(fd, it->second);
+        if (!keep) closeClient(fd);
+    }
+    long long now = steadyMs();
+    if (now - lastSweep >= kSweepIntervalMs) {
+        lastSweep = now;
+        closeIdle(now);
+    }
+    return true;
+}
+
+/**
+ * @brief Handles events until stop() is called.
+ */
+void HttpServer::run() {
+    while (!stopping.load(std::memory_order_relaxed))
+        if (!poll(-1)) break;
+    stopping.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Makes run() return.
+ */
+void HttpServer::stop() {
+    stopping.store(true, std::memory_order_relaxed);
+    if (wakeFd >= 0) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+/**
+ * @brief Takes over the response of the request being handled.
+ * @return Deferred Ticket for complete().
+ */
+HttpServer::Deferred HttpServer::defer() {
+    deferring = true;
+    return handling;
+}
+
+/**
+ * @brief Queues the response of a deferred request for the polling thread.
+ * @param ticket Ticket from defer().
+ * @param response The response.
+ */
+void HttpServer::complete(const Deferred &ticket, const HttpResponse &response) {
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(Completion{ticket, response});
+    }
+    if (wakeFd >= 0) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+/**
+ * @brief Queues the responses passed to complete() and resumes their connections.
+ */
+void HttpServer::drainCompleted() {
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completing.swap(completed);
+    }
+    long long now = steadyMs();
+    for (const Completion &done : completing) {
+        auto it = connections.find(done.ticket.fd);
+        if (it == connections.end() || it->second.serial != done.ticket.serial || !it->second.awaiting) continue;
+        Connection &connection = it->second;
+        connection.awaiting = false;
+        connection.lastActive = now;
+        queueResponse(connection, done.response.status, done.response.contentType, done.response.body,
+                      connection.closeAfterReply);
+        if (!serve(done.ticket.fd, connection)) closeClient(done.ticket.fd);
+    }
+    completing.clear();
+}
+
+/**
+ * @brief Closes connections that have been idle for too long.
+ *
+ * A connection waiting for a deferred response is not idle: the wait is the server's doing.
+ *
+ * @param now Steady-clock milliseconds.
+ */
+void HttpServer::closeIdle(long long now) {
+    std::vector<int> idle;
+    for (const auto &entry : connections)
+        if (!entry.second.awaiting && now - entry.second.lastActive > kIdleTimeoutMs) idle.push_back(entry.first);
+    for (int fd : idle) closeClient(fd);
+}
+
+/**
+ * @brief Accepts every pending connection.
+ */
+void HttpServer::acceptClients() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                ErrorHandling::logErrorMessage(std::string("HTTP server: accept failed: ") + std::strerror(errno));
+            return;
+        }
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        Connection &connection = connections[fd];
+        connection = Connection();
+        connection.events = EPOLLIN;
+        connection.serial = ++nextSerial;
+        connection.lastActive = steadyMs();
+    }
+}
+
+/**
+ * @brief Reads what a connection has sent and handles every complete request in it.
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ * @return bool False if the connection should be closed now.
+ */
+bool HttpServer::readClient(int fd, Connection &connection) {
+    bool peerClosed = false;
+    std::size_t total = 0;
+    while (total < kMaxReadPerEvent) {
+        std::size_t used = connection.input.size();
+        connection.input.resize(used + kReadChunk);
+        ssize_t got = ::recv(fd, &connection.input[used], kReadChunk, 0);
+        connection.input.resize(used + (got > 0 ? static_cast<std::size_t>(got) : 0));
+        if (got > 0) {
+            total += static_cast<std::size_t>(got);
+            connection.lastActive = steadyMs();
+            continue;
+        }
+        if (got == 0) peerClosed = true;
+        else if (errno == EINTR) continue;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+        break;
+    }
+    // After an error response the rest of the stream is not trusted; it is drained and dropped.
+    if (connection.closing) {
+        connection.input.clear();
+        connection.consumed = 0;
+        return !peerClosed && serve(fd, connection);
+    }
+    if (!serve(fd, connection)) return false;
+    return !peerClosed || connection.awaiting || connection.sent < connection.output.size();
+}
+
+/**
+ * @brief Handles what can be handled, sends what can be sent and updates the epoll registration.
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ * @return bool False if the connection should be closed now.
+ */
+bool HttpServer::serve(int fd, Connection &connection) {
+    handleRequests(fd, connection);
+    if (!flush(fd, connection)) return false;
+    watch(fd, connection);
+    return true;
+}
+
+/**
+ * @brief Registers a connection for input unless it is paused, and for output while any is unsent.
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ */
+void HttpServer::watch(int fd, Connection &connection) {
+    std::size_t pending = connection.output.size() - connection.sent;
+    std::uint32_t wanted = 0;
+    if (!connection.awaiting && pending < kMaxPendingOutput) wanted |= EPOLLIN;
+    if (pending > 0) wanted |= EPOLLOUT;
+    if (wanted == connection.events) return;
+    epoll_event event{};
+    event.events = wanted;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    connection.events = wanted;
+}
+
+/**
+ * @brief Handles the complete requests at the front of a connection's input.
+ *
+ * Handling stops while a deferred response is outstanding or too much output is unsent; the rest of the
+ * input waits in the buffer and is handled once the connection can take more.
+ *
+ * @param fd Client descriptor.
+ * @param connection Connection state.
+ * @return bool False on a protocol error that closes the connection after the error response.
+ */
+bool HttpServer::handleRequests(int fd, Connection &connection) {
+    std::string &input = connection.input;
+    bool ok = true;
+    while (!connection.closing && !connection.awaiting &&
+           connection.output.size() - connection.sent < kMaxPendingOutput) {
+        std::size_t headerEnd = input.find("\r\n\r\n", connection.consumed);
+        if (headerEnd == std::string::npos) {
+            if (input.size() - connection.consumed > kMaxHeaderBytes) {
+                queueResponse(connection, 431, "text/plain", "Request headers too large\n", true);
+                ok = false;
+            }
+            break;
+        }
+        const char *start = input.data() + connection.consumed;
+        const char *headersEnd = input.data() + headerEnd;
+        headerEnd += 4;
+
+        // Request line: METHOD SP target SP HTTP/1.x
+        const char *lineEnd = static_cast<const char *>(std::memchr(start, '\r', headersEnd + 2 - start));
+        const char *space1 = static_cast<const char *>(std::memchr(start, ' ', lineEnd - start));
+        const char *space2 = space1 ? static_cast<const char *>(std::memchr(space1 + 1, ' ', lineEnd - space1 - 1))
+                                    : nullptr;
+        if (!space1 || !space2 || space1 == start || space2 == space1 + 1 || lineEnd - space2 - 1 != 8 ||
+            std::memcmp(space2 + 1, "HTTP/1.", 7) != 0) {
+            queueResponse(connection, 400, "text/plain", "Malformed request line\n", true);
+            ok = false;
+            break;
+        }
+        bool keepAlive = space2[8] != '0';
+        request.method.assign(start, space1);
+        const char *target = space1 + 1;
+        const char *question = static_cast<const char *>(std::memchr(target, '?', space2 - target));
+        request.path.assign(target, question ? question : space2);
+        request.query.assign(question ? question + 1 : space2, space2);
+        request.contentType.clear();
+
+        std::size_t contentLength = 0;
+        bool expectContinue = false;
+        bool badHeader = false;
+        bool chunked = false;
+        for (const char *line = lineEnd + 2; line < headersEnd;) {
+            const char *end = static_cast<const char *>(std::memchr(line, '\r', headersEnd + 2 - line));
+            const char *colon = static_cast<const char *>(std::memchr(line, ':', end - line));
+            if (!colon) {
+                badHeader = true;
+                break;
+            }
+            const char *value = colon + 1;
+            while (value < end && (*value == ' ' || *value == '\t')) ++value;
+            const char *valueEnd = end;
+            while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) --valueEnd;
+            std::size_t nameLength = static_cast<std::size_t>(colon - line);
+            std::size_t valueLength = static_cast<std::size_t>(valueEnd - value);
+            if (headerIs(line, nameLength, "content-length")) {
+                char *parsedEnd = nullptr;
+                std::string digits(value, valueLength);
+                unsigned long long length = std::strtoull(digits.c_str(), &parsedEnd, 10);
+                if (digits.empty() || *parsedEnd != '\0') badHeader = true;
+                contentLength = static_cast<std::size_t>(length);
+            } else if (headerIs(line, nameLength, "content-type")) {
+                const char *semicolon = static_cast<const char *>(std::memchr(value, ';', valueLength));
+                const char *typeEnd = semicolon ? semicolon : valueEnd;
+                while (typeEnd > value && typeEnd[-1] == ' ') --typeEnd;
+                request.contentType.assign(value, typeEnd);
+                for (char &c : request.contentType)
+                    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            } else if (headerIs(line, nameLength, "connection")) {
+                if (headerHasToken(value, valueLength, "close")) keepAlive = false;
+                else if (headerHasToken(value, valueLength, "keep-alive")) keepAlive = true;
+            } else if (headerIs(line, nameLength, "transfer-encoding")) {
+                chunked = !headerHasToken(value, valueLength, "identity");
+            } else if (headerIs(line, nameLength, "expect")) {
+                expectContinue = headerHasToken(value, valueLength, "100-continue");
+            }
+            line = end + 2;
+        }
+        if (badHeader) {
+            queueResponse(connection, 400, "text/plain", "Malformed header\n", true);
+            ok = false;
+            break;
+        }
+        if (chunked) {
+            queueResponse(connection, 501, "text/plain", "Chunked bodies are not supported; send Content-Length\n",
+                          true);
+            ok = false;
+            break;
+        }
+        if (contentLength > maxBody) {
+            queueResponse(connection, 413, "text/plain", "Body too large\n", true);
+            ok = false;
+            break;
+        }
+        if (input.size() - headerEnd < contentLength) {
+            if (expectContinue && !connection.continueSent) {
+                connection.output += "HTTP/1.1 100 Continue\r\n\r\n";
+                connection.continueSent = true;
+            }
+            break;
+        }
+
+        request.body = input.data() + headerEnd;
+        request.bodySize = contentLength;
+        response.status = 200;
+        response.contentType = "application/json";
+        response.body.clear();
+        routeKey.assign(request.method);
+        routeKey += ' ';
+        routeKey += request.path;
+        auto handler = routes.find(routeKey);
+        if (handler == routes.end()) {
+            response.status = 404;
+            response.contentType = "text/plain";
+            response.body = "Not found\n";
+        } else {
+            handling.fd = fd;
+            handling.serial = connection.serial;
+            deferring = false;
+            try {
+                handler->second(request, response);
+            } catch (const std::exception &e) {
+                ErrorHandling::handleException(e);
+                response.status = 500;
+                response.contentType = "text/plain";
+                response.body = "Internal error\n";
+            }
+        }
+        connection.consumed = headerEnd + contentLength;
+        connection.continueSent = false;
+        if (deferring) {
+            deferring = false;
+            connection.awaiting = true;
+            connection.closeAfterReply = !keepAlive;
+            continue;
+        }
+        queueResponse(connection, response.status, response.contentType, response.body, !keepAlive);
+    }
+
+    if (connection.consumed == input.size()) {
+        input.clear();
+        connection.consumed = 0;
+    } else if (connection.consumed > input.size() / 2) {
+        input.erase(0, connection.consumed);
+        connection.consumed = 0;
+    }
+    return ok;
+}
+
+/**
+ * @brief Appends a response to a connection's output.
+ * @param connection Connection state.
+ * @param status Status code.
+ * @param contentType Content-Type header.
+ * @param body Body.
+ * @param close Add "Connection: close" and close after sending.
+ */
+void HttpServer::queueResponse(Connection &connection, int status, const std::string &contentType,
+                               const std::string &body, bool close) {
+    char header[256];
+    int length = std::snprintf(header, sizeof(header),
+                               "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n%s\r\n", status,
+                               reasonPhrase(status), contentType.c_str(), body.size(),
+                               close ? "Connection: close\r\n" : "");
+    connection.output.append(header, static_cast<std::size_t>(std::min<int>(length, sizeof(header) - 1)));
+    connection.output += body;
+    if (close) connection.closing = true;
+}
+
+/**
+ * @brief Sends as much pending output as the socket takes.
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ * @return bool False if the connection should be closed now.
+ */
+bool HttpServer::flush(int fd, Connection &connection) {
+    while (connection.sent < connection.output.size()) {
+        ssize_t written = ::send(fd, connection.output.data() + connection.sent,
+                                 connection.output.size() - connection.sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            connection.sent += static_cast<std::size_t>(written);
+            connection.lastActive = steadyMs();
+            continue;
+        }
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // A client that reads slowly but steadily would otherwise keep the sent prefix around forever.
+            if (connection.sent >= kMaxPendingOutput) {
+                connection.output.erase(0, connection.sent);
+                connection.sent = 0;
+            }
+            return true;
+        }
+        return false;
+    }
+    connection.output.clear();
+    connection.sent = 0;
+    return !connection.closing;
+}
+
+/**
+ * @brief Closes a connection.
+ * @param fd Client descriptor.
+ */
+void HttpServer::closeClient(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+}
+
+/**
+ * @brief Gets the standard reason phrase of a status code.
+ * @param status Status code.
+ * @return const char* Reason phrase.
+ */
+const char *HttpServer::reasonPhrase(int status) {
+    switch (status) {
+    case 100: return "Continue";
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 411: return "Length Required";
+    case 413: return "Payload Too Large";
+    case 415: return "Unsupported Media Type";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
@@ -0,0 +1,266 @@
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+/**
+ * @file HttpServer.h
+ * @brief Declaration of the small embedded HTTP/1.1 server used by the headless HeartPi services.
+ *
+ * This header declares a single-threaded, non-blocking HTTP/1.1 server built on an epoll loop. It supports
+ * persistent connections, pipelined requests, Content-Length bodies and "Expect: 100-continue", which is all
+ * sensor gateways and monitoring scrapers need, and routes each request to a handler by method and path.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A parsed request. The body points into the connection buffer and is only valid during the handler call.
+ */
+struct HttpRequest {
+    std::string method;             /**< Request method, e.g. "POST". */
+    std::string path;               /**< Path without the query string. */
+    std::string query;              /**< Query string without the '?' (may be empty). */
+    std::string contentType;        /**< Content-Type media type, lowercased, without parameters. */
+    const char *body = nullptr;     /**< Body bytes. */
+    std::size_t bodySize = 0;       /**< Body length. */
+};
+
+/**
+ * @brief A response filled in by a handler.
+ */
+struct HttpResponse {
+    int status = 200;                               /**< Status code. */
+    std::string contentType = "application/json";   /**< Content-Type header. */
+    std::string body;                               /**< Body. */
+};
+
+/**
+ * @class HttpServer
+ * @brief Non-blocking HTTP/1.1 server with method-and-path routing.
+ *
+ * Each connection keeps one input and one output buffer that are reused across requests, so a busy
+ * keep-alive connection does not allocate per request once its buffers have grown. Requests are handled in
+ * arrival order on the thread that calls poll() or run(); a handler that takes long delays every connection,
+ * so slow work should defer() its response and complete() it from another thread.
+ *
+ * A connection is not read while a deferred response is outstanding or while more than 4 MB of its output is
+ * unsent, so a client that pipelines requests without reading the responses cannot grow its buffers without
+ * bound. Connections that neither send nor receive anything for 60 seconds are closed.
+ */
+class HttpServer {
+public:
+    /**
+     * @brief Request handler.
+     */
+    using Handler = std::function<void(const HttpRequest &, HttpResponse &)>;
+
+    /**
+     * @brief Identifies a request whose response is sent later, see defer().
+     */
+    struct Deferred {
+        int fd = -1;                /**< Client descriptor. */
+        std::uint64_t serial = 0;   /**< Connection serial, so a reused descriptor is never answered by mistake. */
+    };
+
+    /**
+     * @brief Constructs a server that is not listening yet.
+     * @param maxBodyBytes Largest accepted body; bigger requests get 413 and the connection is closed.
+     */
+    explicit HttpServer(std::size_t maxBodyBytes = 16 * 1024 * 1024);
+
+    ~HttpServer();
+
+    HttpServer(const HttpServer &) = delete;
+    HttpServer &operator=(const HttpServer &) = delete;
+
+    /**
+     * @brief Starts listening.
+     * @param address IPv4 address to bind ("127.0.0.1" for local only, "0.0.0.0" for the LAN).
+     * @param port TCP port (0 picks a free one, see port()).
+     * @return bool False if the socket could not be bound.
+     */
+    bool listen(const std::string &address, std::uint16_t port);
+
+    /** @return std::uint16_t The bound port (0 before listen()). */
+    std::uint16_t port() const { return boundPort; }
+
+    /**
+     * @brief Registers a handler.
+     * @param method Request method.
+     * @param path Exact path.
+     * @param handler Called for matching requests.
+     */
+    void route(const std::string &method, const std::string &path, Handler handler);
+
+    /**
+     * @brief Waits for and handles socket events once.
+     * @param timeoutMs Longest wait in milliseconds (-1: until something happens).
+     * @return bool False if the server is not listening or the wait failed.
+     */
+    bool poll(int timeoutMs);
+
+    /**
+     * @brief Handles events until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return. Safe to call from any thread or a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Takes over the response of the request being handled. Call only from inside a handler.
+     *
+     * The handler's own response is discarded. The connection handles no further request until complete()
+     * is called with the returned ticket, so pipelined responses stay in order.
+     *
+     * @return Deferred Ticket for complete().
+     */
+    Deferred defer();
+
+    /**
+     * @brief Sends the response of a deferred request. Safe to call from any thread.
+     *
+     * The response is queued and sent by the thread running poll(); if the client has gone, it is dropped.
+     *
+     * @param ticket Ticket from defer().
+     * @param response The response.
+     */
+    void complete(const Deferred &ticket, const HttpResponse &response);
+
+    /** @return std::size_t Number of open client connections. */
+    std::size_t connectionCount() const { return connections.size(); }
+
+    /**
+     * @brief Gets the standard reason phrase of a status code.
+     * @param status Status code.
+     * @return const char* Reason phrase.
+     */
+    static const char *reasonPhrase(int status);
+
+private:
+    /**
+     * @brief Per-connection state.
+     */
+    struct Connection {
+        std::string input;              /**< Received bytes not yet handled. */
+        std::size_t consumed = 0;       /**< Bytes at the front of input already handled. */
+        std::string output;             /**< Response bytes not yet sent. */
+        std::size_t sent = 0;           /**< Bytes at the front of output already sent. */
+        bool continueSent = false;      /**< "100 Continue" already sent for the pending request. */
+        bool closing = false;           /**< Close once output is flushed. */
+        bool awaiting = false;          /**< A deferred response is outstanding. */
+        bool closeAfterReply = false;   /**< The deferred request asked to close the connection. */
+        std::uint32_t events = 0;       /**< epoll events the descriptor is registered for. */
+        std::uint64_t serial = 0;       /**< Distinguishes this connection from earlier ones on the same descriptor. */
+        long long lastActive = 0;       /**< Steady-clock milliseconds of the last byte received or sent. */
+    };
+
+    /**
+     * @brief A deferred response waiting to be queued by the polling thread.
+     */
+    struct Completion {
+        Deferred ticket;                /**< Request it answers. */
+        HttpResponse response;          /**< The response. */
+    };
+
+    std::size_t maxBody;                                    /**< Body size limit. */
+    int listenFd = -1;                                      /**< Listening socket. */
+    int epollFd = -1;                                       /**< epoll instance. */
+    int wakeFd = -1;                                        /**< eventfd that interrupts the wait in stop(). */
+    std::uint16_t boundPort = 0;                            /**< Bound port. */
+    std::atomic<bool> stopping{false};                      /**< Set by stop(). */
+    std::unordered_map<std::string, Handler> routes;        /**< "METHOD path" to handler. */
+    std::unordered_map<int, Connection> connections;        /**< Open connections by descriptor. */
+    std::string routeKey;                                   /**< Scratch for route lookups. */
+    HttpRequest request;                                    /**< Scratch request, reused. */
+    HttpResponse response;                                  /**< Scratch response, reused. */
+    Deferred handling;                                      /**< Request whose handler is running. */
+    bool deferring = false;                                 /**< defer() was called by the running handler. */
+    std::uint64_t nextSerial = 0;                           /**< Serial of the next accepted connection. */
+    long long lastSweep = 0;                                /**< When idle connections were last looked for. */
+    std::mutex completedMutex;                              /**< Guards completed. */
+    std::vector<Completion> completed;                      /**< Deferred responses from complete(). */
+    std::vector<Completion> completing;                     /**< Scratch for draining completed. */
+
+    /**
+     * @brief Accepts every pending connection.
+     */
+    void acceptClients();
+
+    /**
+     * @brief Reads what a connection has sent and handles every complete request in it.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     * @return bool False if the connection should be closed now.
+     */
+    bool readClient(int fd, Connection &connection);
+
+    /**
+     * @brief Handles the complete requests at the front of a connection's input.
+     * @param fd Client descriptor.
+     * @param connection Connection state.
+     * @return bool False on a protocol error that closes the connection after the error response.
+     */
+    bool handleRequests(int fd, Connection &connection);
+
+    /**
+     * @brief Handles what can be handled, sends what can be sent and updates the epoll registration.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     * @return bool False if the connection should be closed now.
+     */
+    bool serve(int fd, Connection &connection);
+
+    /**
+     * @brief Registers a connection for input unless it is paused, and for output while any is unsent.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     */
+    void watch(int fd, Connection &connection);
+
+    /**
+     * @brief Queues the responses passed to complete() and resumes their connections.
+     */
+    void drainCompleted();
+
+    /**
+     * @brief Closes connections that have been idle for too long.
+     * @param now Steady-clock milliseconds.
+     */
+    void closeIdle(long long now);
+
+    /**
+     * @brief Appends a response to a connection's output.
+     * @param connection Connection state.
+     * @param status Status code.
+     * @param contentType Content-Type header.
+     * @param body Body.
+     * @param close Add "Connection: close" and close after sending.
+     */
+    void queueResponse(Connection &connection, int status, const std::string &contentType, const std::string &body,
+                       bool close);
+
+    /**
+     * @brief Sends as much pending output as the socket takes.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     * @return bool False if the connection should be closed now.
+     */
+    bool flush(int fd, Connection &connection);
+
+    /**
+     * @brief Closes a connection.
+     * @param fd Client descriptor.
+     */
+    void closeClient(int fd);
+};
+
+#endif // HTTPSERVER_H
@@ -0,0 +1,214 @@
+/**
+ * @file LifestyleOptimizer.cpp
+ * @brief Implements the scoring table and the what-if search over lifestyle changes.
+ */
+
+#include "LifestyleOptimizer.h"
+#include "Calculations.h"
+#include "RiskModel.h"
+#include "SurveyIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+const std::size_t kPeople = 6 * 2 * 16;     // age group x gender x family history
+
+const char *kSleepText[5] = { "less than 4", "4 - 5", "6 - 7", "7 - 8", "more than 8" };
+const char *kExerciseText[4] = { "never", "1 - 2 times", "3 - 5 times", "6 - 7 times" };
+const char *kDietText[6] = { "high protein", "low carb", "vegetarian", "Western", "vegan", "balanced" };
+
+/**
+ * @brief Gets the lifestyle answers of a variant index.
+ * @param variant 0 to kVariants - 1.
+ * @return LifestyleChoice The answers.
+ */
+LifestyleChoice choiceOf(std::size_t variant) {
+    LifestyleChoice choice;
+    choice.smoker = variant % 2 != 0;
+    variant /= 2;
+    choice.dietType = static_cast<int>(variant % 6) + 1;
+    variant /= 6;
+    choice.exerciseFrequency = static_cast<int>(variant % 4) + 1;
+    choice.sleepHours = static_cast<int>(variant / 4) + 1;
+    return choice;
+}
+
+} // namespace
+
+/**
+ * @brief Builds the scoring table.
+ * @param model Trained model, or nullptr.
+ */
+LifestyleOptimizer::LifestyleOptimizer(const LogisticRiskModel *model)
+    : model(model), scores(kPeople * kVariants) {
+    std::vector<float> rows;
+    if (model) {
+        probabilities.resize(scores.size());
+        rows.resize(scores.size() * RiskFeatures::kWidth);
+    }
+    for (int age = 1; age <= 6; ++age) {
+        for (int male = 0; male < 2; ++male) {
+            for (unsigned history = 0; history < 16; ++history) {
+                for (std::size_t variant = 0; variant < kVariants; ++variant) {
+                    LifestyleChoice c = choiceOf(variant);
+                    std::size_t row = rowOf(age, male != 0, history, c);
+                    scores[row] = static_cast<std::int8_t>(computeRiskScore(
+                        age, male != 0, c.sleepHours, c.exerciseFrequency, history, c.dietType, c.smoker));
+                    if (model)
+                        RiskFeatures::encode(age, male != 0, c.sleepHours, c.exerciseFrequency, history, c.dietType,
+                                             c.smoker, &rows[row * RiskFeatures::kWidth]);
+                }
+            }
+        }
+    }
+    if (model) model->scoreBatch(rows.data(), scores.size(), probabilities.data());
+}
+
+/**
+ * @brief Gets the table row of a survey.
+ * @param ageGroup Age group (1-6).
+ * @param male Gender assigned at birth.
+ * @param familyHistory Family history bits.
+ * @param choice Lifestyle answers.
+ * @return std::size_t Row.
+ */
+std::size_t LifestyleOptimizer::rowOf(int ageGroup, bool male, unsigned familyHistory,
+                                      const LifestyleChoice &choice) {
+    std::size_t person = (static_cast<std::size_t>(ageGroup - 1) * 2 + (male ? 1 : 0)) * 16 + (familyHistory & 15u);
+    std::size_t variant = ((static_cast<std::size_t>(choice.sleepHours - 1) * 4 + (choice.exerciseFrequency - 1)) * 6 +
+                           (choice.dietType - 1)) * 2 + (choice.smoker ? 1 : 0);
+    return person * kVariants + variant;
+}
+
+/**
+ * @brief Finds the best lifestyle changes for a person.
+ * @param ageGroup Age group (1-6).
+ * @param male Gender assigned at birth.
+ * @param familyHistory Family history bits.
+ * @param current Current answers.
+ * @param limit Maximum number of suggestions.
+ * @return std::vector<LifestyleSuggestion> Ranked suggestions.
+ */
+std::vector<LifestyleSuggestion> LifestyleOptimizer::suggest(int ageGroup, bool male, unsigned familyHistory,
+                                                             const LifestyleChoice &current,
+                                                             std::size_t limit) const {
+    std::vector<LifestyleSuggestion> candidates;
+    ageGroup = std::min(std::max(ageGroup, 1), 6);
+    LifestyleChoice from = current;
+    from.sleepHours = std::min(std::max(from.sleepHours, 1), 5);
+    from.exerciseFrequency = std::min(std::max(from.exerciseFrequency, 1), 4);
+    from.dietType = std::min(std::max(from.dietType, 1), 6);
+
+    auto riskAt = [this](std::size_t row) {
+        return probabilities.empty() ? static_cast<double>(scores[row]) : static_cast<double>(probabilities[row]);
+    };
+    const std::size_t first = rowOf(ageGroup, male, familyHistory, choiceOf(0));
+    const double before = riskAt(rowOf(ageGroup, male, familyHistory, from));
+
+    // A change qualifies only if each answer it touches, changed on its own, does not raise the risk.
+    auto harmless = [&](const LifestyleChoice &to) {
+        LifestyleChoice step = from;
+        step.sleepHours = to.sleepHours;
+        if (riskAt(rowOf(ageGroup, male, familyHistory, step)) > before) return false;
+        step = from;
+        step.exerciseFrequency = to.exerciseFrequency;
+        if (riskAt(rowOf(ageGroup, male, familyHistory, step)) > before) return false;
+        step = from;
+        step.dietType = to.dietType;
+        if (riskAt(rowOf(ageGroup, male, familyHistory, step)) > before) return false;
+        return !to.smoker || from.smoker;
+    };
+    for (std::size_t variant = 0; variant < kVariants; ++variant) {
+        double after = riskAt(first + variant);
+        if (after >= before || !harmless(choiceOf(variant))) continue;
+        LifestyleSuggestion suggestion;
+        suggestion.choice = choiceOf(variant);
+        suggestion.scoreAfter = scores[first + variant];
+        suggestion.tierAfter = model ? model->tierOf(after) : riskTierOf(suggestion.scoreAfter);
+        suggestion.riskBefore = before;
+        suggestion.riskAfter = after;
+        suggestion.effort = effort(from, suggestion.choice);
+        candidates.push_back(suggestion);
+    }
+
+    // Keep the Pareto front: sweep by effort and keep each change that beats every cheaper one.
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const LifestyleSuggestion &a, const LifestyleSuggestion &b) {
+                         return a.effort != b.effort ? a.effort < b.effort : a.riskAfter < b.riskAfter;
+                     });
+    std::vector<LifestyleSuggestion> front;
+    double best = before;
+    for (const LifestyleSuggestion &candidate : candidates) {
+        if (candidate.riskAfter >= best) continue;
+        best = candidate.riskAfter;
+        front.push_back(candidate);
+    }
+    std::sort(front.begin(), front.end(), [](const LifestyleSuggestion &a, const LifestyleSuggestion &b) {
+        if (a.reductionPerEffort() != b.reductionPerEffort()) return a.reductionPerEffort() > b.reductionPerEffort();
+        return a.riskAfter < b.riskAfter;
+    });
+    if (front.size() > limit) front.resize(limit);
+    return front;
+}
+
+/**
+ * @brief Finds the best lifestyle changes for a survey profile.
+ * @param profile Survey answers.
+ * @param limit Maximum number of suggestions.
+ * @return std::vector<LifestyleSuggestion> Ranked suggestions.
+ */
+std::vector<LifestyleSuggestion> LifestyleOptimizer::suggest(const SurveyProfile &profile, std::size_t limit) const {
+    LifestyleChoice current;
+    current.sleepHours = profile.sleepHours;
+    current.exerciseFrequency = profile.exerciseFrequency;
+    current.dietType = profile.dietType;
+    current.smoker = profile.smoker;
+    return suggest(profile.ageGroup, profile.male, profile.familyHistory, current, limit);
+}
+
+/**
+ * @brief Gets the effort of a change.
+ * @param from Current answers.
+ * @param to Answers after the change.
+ * @return double Effort.
+ */
+double LifestyleOptimizer::effort(const LifestyleChoice &from, const LifestyleChoice &to) {
+    double total = std::abs(to.sleepHours - from.sleepHours);
+    if (to.exerciseFrequency != from.exerciseFrequency) {
+        total += std::abs(to.exerciseFrequency - from.exerciseFrequency);
+        if (from.exerciseFrequency == 1) total += 1.0;
+    }
+    if (to.dietType != from.dietType) total += to.dietType == 6 ? 2.0 : 2.5;
+    if (to.smoker != from.smoker) total += 3.0;
+    return total;
+}
+
+/**
+ * @brief Describes a change.
+ * @param from Current answers.
+ * @param to Answers after the change.
+ * @return std::string Description.
+ */
+std::string LifestyleOptimizer::describe(const LifestyleChoice &from, const LifestyleChoice &to) {
+    std::vector<std::string> parts;
+    if (to.smoker != from.smoker) parts.push_back(to.smoker ? "start smoking" : "quit smoking");
+    if (to.exerciseFrequency != from.exerciseFrequency)
+        parts.push_back(to.exerciseFrequency == 1 ? std::string("stop exercising")
+                                                  : std::string("exercise ") +
+                                                        kExerciseText[to.exerciseFrequency - 1] + " a week");
+    if (to.dietType != from.dietType)
+        parts.push_back(std::string("switch to a ") + kDietText[to.dietType - 1] + " diet");
+    if (to.sleepHours != from.sleepHours)
+        parts.push_back(std::string("sleep ") + kSleepText[to.sleepHours - 1] + " hours a night");
+    if (parts.empty()) return "Keep your current habits";
+
+    std::string text;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        if (i > 0) text += i + 1 == parts.size() ? " and " : ", ";
+        text += parts[i];
+    }
+    text[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])));
+    return text;
+}
@@ -0,0 +1,129 @@
+#ifndef LIFESTYLEOPTIMIZER_H
+#define LIFESTYLEOPTIMIZER_H
+
+/**
+ * @file LifestyleOptimizer.h
+ * @brief Declaration of the what-if search over lifestyle changes.
+ *
+ * This header declares an optimizer that enumerates every combination of the modifiable survey answers
+ * (sleep, exercise, diet and smoking) for a person, scores each one with a precomputed table covering every
+ * possible survey, and ranks the changes by risk reduction per unit of effort.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class LogisticRiskModel;
+struct SurveyProfile;
+
+/**
+ * @brief The modifiable survey answers.
+ */
+struct LifestyleChoice {
+    int sleepHours = 3;             /**< 1: less than 4 ... 5: more than 8. */
+    int exerciseFrequency = 1;      /**< 1: never ... 4: 6-7 times a week. */
+    int dietType = 6;               /**< 1: high protein ... 6: balanced. */
+    bool smoker = false;            /**< Smoking status. */
+
+    bool operator==(const LifestyleChoice &other) const {
+        return sleepHours == other.sleepHours && exerciseFrequency == other.exerciseFrequency &&
+               dietType == other.dietType && smoker == other.smoker;
+    }
+};
+
+/**
+ * @brief One ranked change.
+ */
+struct LifestyleSuggestion {
+    LifestyleChoice choice;         /**< Answers after the change. */
+    int scoreAfter = 0;             /**< Point score after the change. */
+    int tierAfter = 0;              /**< Tier after the change (0: Low, 1: Moderate, 2: High). */
+    double riskBefore = 0.0;        /**< Risk before the change (model probability, or point score). */
+    double riskAfter = 0.0;         /**< Risk after the change. */
+    double effort = 0.0;            /**< Effort of the change (see LifestyleOptimizer::effort()). */
+
+    /** @return double Risk reduction per unit of effort. */
+    double reductionPerEffort() const { return effort > 0.0 ? (riskBefore - riskAfter) / effort : 0.0; }
+};
+
+/**
+ * @class LifestyleOptimizer
+ * @brief Ranks lifestyle changes using a table of scores for every possible survey.
+ *
+ * The table holds the point score (and, when a trained model is given, its probability) of all
+ * 6 x 2 x 5 x 4 x 16 x 6 x 2 = 23,040 surveys, ordered so that the 240 lifestyle variants of one person are
+ * contiguous. suggest() therefore reads 240 neighbouring entries and never calls the scoring code.
+ *
+ * Only changes that make no single answer riskier are considered, so a suggestion never pays for one habit
+ * with another (e.g. more exercise but less sleep). Of those, only Pareto-optimal ones are suggested: a
+ * combination is dropped when another one lowers the risk at least as much for no more effort, so every part
+ * of a suggestion contributes.
+ */
+class LifestyleOptimizer {
+public:
+    static const std::size_t kVariants = 5 * 4 * 6 * 2;    /**< Lifestyle combinations per person. */
+
+    /**
+     * @brief Builds the scoring table.
+     * @param model Trained model to rank by probability, or nullptr to rank by the point score.
+     */
+    explicit LifestyleOptimizer(const LogisticRiskModel *model = nullptr);
+
+    /**
+     * @brief Finds the best lifestyle changes for a person.
+     * @param ageGroup Age group (1-6).
+     * @param male Gender assigned at birth.
+     * @param familyHistory Bit i set if FamilyHealth disease i runs in the family.
+     * @param current Current answers.
+     * @param limit Maximum number of suggestions.
+     * @return std::vector<LifestyleSuggestion> Changes that lower the risk, best reduction per effort first.
+     */
+    std::vector<LifestyleSuggestion> suggest(int ageGroup, bool male, unsigned familyHistory,
+                                             const LifestyleChoice &current, std::size_t limit) const;
+
+    /**
+     * @brief Finds the best lifestyle changes for a survey profile.
+     * @param profile Survey answers.
+     * @param limit Maximum number of suggestions.
+     * @return std::vector<LifestyleSuggestion> Changes that lower the risk, best reduction per effort first.
+     */
+    std::vector<LifestyleSuggestion> suggest(const SurveyProfile &profile, std::size_t limit) const;
+
+    /**
+     * @brief Gets the effort of a change.
+     *
+     * Each sleep or exercise step costs one unit (two for the first exercise step, starting a habit).
+     * Switching to a balanced diet costs two units, to a more restrictive one 2.5, and quitting smoking three.
+     *
+     * @param from Current answers.
+     * @param to Answers after the change.
+     * @return double Effort (0 when nothing changes).
+     */
+    static double effort(const LifestyleChoice &from, const LifestyleChoice &to);
+
+    /**
+     * @brief Describes a change in the survey's wording, e.g. "Quit smoking and exercise 3 - 5 times a week".
+     * @param from Current answers.
+     * @param to Answers after the change.
+     * @return std::string Description.
+     */
+    static std::string describe(const LifestyleChoice &from, const LifestyleChoice &to);
+
+    /** @return bool True if the table ranks by model probability. */
+    bool usesModel() const { return !probabilities.empty(); }
+
+private:
+    const LogisticRiskModel *model;     /**< Model used for tiers, or nullptr. */
+    std::vector<std::int8_t> scores;    /**< Point score per survey. */
+    std::vector<float> probabilities;   /**< Model probability per survey (empty without a model). */
+
+    /**
+     * @brief Gets the table row of a survey.
+     * @return std::size_t Row.
+     */
+    static std::size_t rowOf(int ageGroup, bool male, unsigned familyHistory, const LifestyleChoice &choice);
+};
+
+#endif // LIFESTYLEOPTIMIZER_H
@@ -0,0 +1,239 @@
+/**
+ * @file MatrixProfile.cpp
+ * @brief Implements the diagonal-blocked matrix profile and motif/discord extraction.
+ */
+
+#include "MatrixProfile.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+
+const int kDiagonalBlock = 64;      // Diagonals advanced together by one worker.
+const double kInvalidPenalty = -10.0;   // Added to the correlation of pairs involving an invalid window.
+
+} // namespace
+
+/**
+ * @brief Computes the profile of a series.
+ * @param series One value per step.
+ * @param observed Non-zero where the value was measured rather than filled in.
+ * @param windowLength Window length in steps.
+ * @param start Timestamp of the first step.
+ * @param step Seconds per step.
+ * @param threads Worker threads (0: one per core).
+ */
+void MatrixProfile::compute(const std::vector<double> &series, const std::vector<std::uint8_t> &observed,
+                            int windowLength, long long start, long long step, unsigned threads) {
+    window = std::max(4, windowLength);
+    startTime = start;
+    stepSeconds = step;
+    profile.clear();
+    neighbours.clear();
+    const long long n = static_cast<long long>(series.size());
+    const long long m = window;
+    if (n < 2 * m) return;
+    const long long length = n - m + 1;
+
+    // Window means and inverse norms; invalid windows get a large negative penalty instead.
+    std::vector<double> mean(length), inverseNorm(length), penalty(length, 0.0);
+    std::vector<long long> missing(n + 1, 0);
+    for (long long i = 0; i < n; ++i) missing[i + 1] = missing[i] + (observed[i] ? 0 : 1);
+    for (long long i = 0; i < length; ++i) {
+        double sum = 0.0;
+        for (long long j = i; j < i + m; ++j) sum += series[j];
+        mean[i] = sum / m;
+        double squares = 0.0;
+        for (long long j = i; j < i + m; ++j) squares += (series[j] - mean[i]) * (series[j] - mean[i]);
+        bool valid = missing[i + m] == missing[i] && squares > 1e-8 * m;
+        inverseNorm[i] = valid ? 1.0 / std::sqrt(squares) : 0.0;
+        if (!valid) penalty[i] = kInvalidPenalty;
+    }
+    // Differences that advance a window pair's covariance one step down its diagonal.
+    std::vector<double> df(length, 0.0), dg(length, 0.0);
+    for (long long i = 1; i < length; ++i) {
+        df[i] = (series[i + m - 1] - series[i - 1]) / 2.0;
+        dg[i] = (series[i + m - 1] - mean[i]) + (series[i - 1] - mean[i - 1]);
+    }
+
+    // Trivial matches within a quarter window of the diagonal are excluded.
+    const long long firstDiagonal = std::max(1LL, m / 4);
+    const long long blocks = (length - firstDiagonal + kDiagonalBlock - 1) / kDiagonalBlock;
+    if (blocks <= 0) return;
+    unsigned threadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned>(std::min<long long>(threadCount, blocks));
+    const double none = -std::numeric_limits<double>::infinity();
+    std::vector<std::vector<double>> bestCorrelation(threadCount, std::vector<double>(length, none));
+    std::vector<std::vector<long long>> bestIndex(threadCount, std::vector<long long>(length, -1));
+    std::atomic<long long> nextBlock(0);
+
+    auto worker = [&](unsigned thread) {
+        double *correlationOut = bestCorrelation[thread].data();
+        long long *indexOut = bestIndex[thread].data();
+        double covariance[kDiagonalBlock];
+        double correlation[kDiagonalBlock];
+        for (long long block = nextBlock++; block < blocks; block = nextBlock++) {
+            const long long diagonal = firstDiagonal + block * kDiagonalBlock;
+            const long long count = std::min<long long>(kDiagonalBlock, length - diagonal);
+            for (long long b = 0; b < count; ++b) {
+                double sum = 0.0;
+                for (long long j = 0; j < m; ++j) sum += (series[diagonal + b + j] - mean[diagonal + b]) *
+                                                        (series[j] - mean[0]);
+                covariance[b] = sum;
+            }
+            for (long long row = 0; row < length - diagonal; ++row) {
+                const long long active = std::min(count, length - diagonal - row);
+                const long long column = row + diagonal;
+                const double dfRow = df[row], dgRow = dg[row];
+                const double normRow = inverseNorm[row], penaltyRow = penalty[row];
+                const double *dfColumn = df.data() + column;
+                const double *dgColumn = dg.data() + column;
+                const double *normColumn = inverseNorm.data() + column;
+                const double *penaltyColumn = penalty.data() + column;
+                for (long long b = 0; b < active; ++b) {
+                    covariance[b] += dfRow * dgColumn[b] + dfColumn[b] * dgRow;
+                    correlation[b] = covariance[b] * normRow * normColumn[b] + penaltyRow + penaltyColumn[b];
+                }
+                double *columnBest = correlationOut + column;
+                long long *columnIndex = indexOut + column;
+                for (long long b = 0; b < active; ++b) {
+                    bool better = correlation[b] > columnBest[b];
+                    columnBest[b] = better ? correlation[b] : columnBest[b];
+                    columnIndex[b] = better ? row : columnIndex[b];
+                }
+                // The row's best is found with a max reduction; its position is only looked up on improvement.
+                double rowBest = correlation[0];
+                for (long long b = 1; b < active; ++b) rowBest = std::max(rowBest, correlation[b]);
+                if (rowBest > correlationOut[row]) {
+                    long long b = 0;
+                    while (correlation[b] != rowBest) ++b;
+                    correlationOut[row] = rowBest;
+                    indexOut[row] = column + b;
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threadCount; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread &thread : pool) thread.join();
+
+    profile.assign(length, -1.0);
+    neighbours.assign(length, -1);
+    for (long long i = 0; i < length; ++i) {
+        double best = bestCorrelation[0][i];
+        long long index = bestIndex[0][i];
+        for (unsigned t = 1; t < threadCount; ++t) {
+            if (bestCorrelation[t][i] > best) {
+                best = bestCorrelation[t][i];
+                index = bestIndex[t][i];
+            }
+        }
+        // Any pair involving an invalid window carries the penalty, so a real match is always above -1.5.
+        if (best < -1.5 || penalty[i] != 0.0) continue;
+        profile[i] = std::sqrt(std::max(0.0, 2.0 * m * (1.0 - std::min(best, 1.0))));
+        neighbours[i] = index;
+    }
+}
+
+/**
+ * @brief Computes the profile of the per-minute means in a time range of a user's minute tier.
+ * @param rollup The user's rollup tiers.
+ * @param from Inclusive range start.
+ * @param to Exclusive range end.
+ * @param windowLength Window length in minutes.
+ * @param threads Worker threads (0: one per core).
+ * @return bool False if the range has fewer than two windows of data.
+ */
+bool MatrixProfile::computeFromRollup(const HeartRateRollup &rollup, long long from, long long to,
+                                      int windowLength, unsigned threads) {
+    const std::vector<RollupBucket> &minutes = rollup.buckets(HeartRateRollup::Minute);
+    auto first = std::lower_bound(minutes.begin(), minutes.end(), from,
+                                  [](const RollupBucket &bucket, long long time) { return bucket.start < time; });
+    auto last = std::lower_bound(first, minutes.end(), to,
+                                 [](const RollupBucket &bucket, long long time) { return bucket.start < time; });
+    profile.clear();
+    neighbours.clear();
+    if (first == last) return false;
+
+    // The series runs from the first to the last minute with readings in the range.
+    long long begin = first->start;
+    long long steps = (std::prev(last)->start - begin) / 60 + 1;
+    std::vector<double> series(static_cast<std::size_t>(steps), 0.0);
+    std::vector<std::uint8_t> observed(static_cast<std::size_t>(steps), 0);
+    long long previous = -1;
+    for (auto it = first; it != last; ++it) {
+        long long step = (it->start - begin) / 60;
+        series[step] = it->mean();
+        observed[step] = 1;
+        if (previous >= 0 && step - previous > 1 && step - previous <= kMaxGapMinutes + 1) {
+            for (long long s = previous + 1; s < step; ++s) {
+                series[s] = series[previous] + (series[step] - series[previous]) * (s - previous) / (step - previous);
+                observed[s] = 1;
+            }
+        }
+        previous = step;
+    }
+    compute(series, observed, windowLength, begin, 60, threads);
+    return !profile.empty();
+}
+
+/**
+ * @brief Picks windows in a given order, skipping those within half a window of an earlier pick.
+ * @param order Candidate window indices, best first.
+ * @param count Maximum number of picks.
+ * @param includeNeighbours Also block the area around each pick's neighbour.
+ * @return std::vector<ProfileEvent> Picked windows.
+ */
+std::vector<ProfileEvent> MatrixProfile::pick(const std::vector<std::size_t> &order, std::size_t count,
+                                              bool includeNeighbours) const {
+    std::vector<ProfileEvent> events;
+    std::vector<long long> taken;
+    long long zone = std::max(1, window / 2);
+    auto isTaken = [&](long long index) {
+        for (long long other : taken)
+            if (std::llabs(other - index) < zone) return true;
+        return false;
+    };
+    for (std::size_t i : order) {
+        if (events.size() >= count) break;
+        if (isTaken(static_cast<long long>(i)) || (includeNeighbours && isTaken(neighbours[i]))) continue;
+        ProfileEvent event;
+        event.timestamp = timeOf(i);
+        event.matchTimestamp = timeOf(static_cast<std::size_t>(neighbours[i]));
+        event.distance = profile[i];
+        events.push_back(event);
+        taken.push_back(static_cast<long long>(i));
+        if (includeNeighbours) taken.push_back(neighbours[i]);
+    }
+    return events;
+}
+
+/**
+ * @brief Finds the closest pairs of windows, skipping windows that overlap an earlier pick.
+ * @param count Maximum number of motifs.
+ * @return std::vector<ProfileEvent> Motifs, closest first.
+ */
+std::vector<ProfileEvent> MatrixProfile::motifs(std::size_t count) const {
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < profile.size(); ++i)
+        if (neighbours[i] >= 0) order.push_back(i);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return profile[a] < profile[b]; });
+    return pick(order, count, true);
+}
+
+/**
+ * @brief Finds the windows farthest from their nearest neighbour, skipping overlapping windows.
+ * @param count Maximum number of discords.
+ * @return std::vector<ProfileEvent> Discords, most unusual first.
+ */
+std::vector<ProfileEvent> MatrixProfile::discords(std::size_t count) const {
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < profile.size(); ++i)
+        if (neighbours[i] >= 0) order.push_back(i);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return profile[a] > profile[b]; });
+    return pick(order, count, false);
+}
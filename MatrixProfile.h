@@ -0,0 +1,132 @@
+#ifndef MATRIXPROFILE_H
+#define MATRIXPROFILE_H
+
+/**
+ * @file MatrixProfile.h
+ * @brief Declaration of the matrix profile of a per-minute heart-rate series and its motifs and discords.
+ *
+ * This header declares the matrix profile: for every window of a series, the z-normalized Euclidean
+ * distance to its nearest non-overlapping match elsewhere in the series. Low values mark motifs (patterns
+ * that recur, such as a nightly tachycardia episode) and high values mark discords (windows unlike anything
+ * else in the history, i.e. candidate anomalies).
+ */
+
+#include "HeartRateRollup.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A motif pair or a discord.
+ */
+struct ProfileEvent {
+    long long timestamp = 0;        /**< Start of the window (seconds since epoch). */
+    long long matchTimestamp = 0;   /**< Start of its nearest neighbour. */
+    double distance = 0.0;          /**< Z-normalized Euclidean distance between the two windows. */
+};
+
+/**
+ * @class MatrixProfile
+ * @brief Exact matrix profile computed diagonal by diagonal (the STOMP / SCRIMP family, in the MPX form).
+ *
+ * Along each diagonal of the distance matrix the windows' covariance is updated in O(1) per step from
+ * precomputed differences, so the whole profile costs O(n^2) multiply-adds with no FFTs. Each worker thread
+ * takes a block of adjacent diagonals and advances all of them together, one row at a time: the inner loop
+ * runs across diagonals over contiguous arrays, which the compiler vectorizes. Threads keep private profiles
+ * that are merged at the end.
+ *
+ * Windows covering a gap of more than kMaxGapMinutes without readings, or a completely flat stretch, are
+ * marked invalid: they get no profile value and are never anyone's neighbour.
+ */
+class MatrixProfile {
+public:
+    static const int kMaxGapMinutes = 5;    /**< Longer gaps invalidate the windows that cover them. */
+
+    /**
+     * @brief Computes the profile of a series.
+     * @param series One value per step.
+     * @param observed Non-zero where the value was measured rather than filled in.
+     * @param windowLength Window length in steps (at least 4).
+     * @param start Timestamp of the first step.
+     * @param step Seconds per step.
+     * @param threads Worker threads (0: one per core).
+     */
+    void compute(const std::vector<double> &series, const std::vector<std::uint8_t> &observed, int windowLength,
+                 long long start = 0, long long step = 60, unsigned threads = 0);
+
+    /**
+     * @brief Computes the profile of the per-minute means in a time range of a user's minute tier.
+     *
+     * Gaps of up to kMaxGapMinutes are filled by linear interpolation; longer ones are left unobserved. The
+     * minute tier only reaches back HeartRateRollup::kMinuteRetention, so older parts of the range are empty.
+     *
+     * @param rollup The user's rollup tiers.
+     * @param from Inclusive range start (seconds since epoch).
+     * @param to Exclusive range end (seconds since epoch).
+     * @param windowLength Window length in minutes.
+     * @param threads Worker threads (0: one per core).
+     * @return bool False if the range has fewer than two windows of data.
+     */
+    bool computeFromRollup(const HeartRateRollup &rollup, long long from, long long to, int windowLength,
+                           unsigned threads = 0);
+
+    /** @return std::size_t Number of windows (0 before compute()). */
+    std::size_t size() const { return profile.size(); }
+
+    /** @return int Window length in steps. */
+    int getWindow() const { return window; }
+
+    /**
+     * @brief Gets the distance from a window to its nearest neighbour.
+     * @param i Window index.
+     * @return double Distance, or a negative value if the window is invalid.
+     */
+    double distance(std::size_t i) const { return profile[i]; }
+
+    /**
+     * @brief Gets a window's nearest neighbour.
+     * @param i Window index.
+     * @return long long Neighbour's window index, or -1 if the window is invalid.
+     */
+    long long neighbour(std::size_t i) const { return neighbours[i]; }
+
+    /**
+     * @brief Gets the start time of a window.
+     * @param i Window index.
+     * @return long long Seconds since epoch.
+     */
+    long long timeOf(std::size_t i) const { return startTime + static_cast<long long>(i) * stepSeconds; }
+
+    /**
+     * @brief Finds the closest pairs of windows, skipping windows that overlap an earlier pick.
+     * @param count Maximum number of motifs.
+     * @return std::vector<ProfileEvent> Motifs, closest first.
+     */
+    std::vector<ProfileEvent> motifs(std::size_t count) const;
+
+    /**
+     * @brief Finds the windows farthest from their nearest neighbour, skipping overlapping windows.
+     * @param count Maximum number of discords.
+     * @return std::vector<ProfileEvent> Discords, most unusual first.
+     */
+    std::vector<ProfileEvent> discords(std::size_t count) const;
+
+private:
+    int window = 0;                         /**< Window length in steps. */
+    long long startTime = 0;                /**< Timestamp of step 0. */
+    long long stepSeconds = 60;             /**< Seconds per step. */
+    std::vector<double> profile;            /**< Distance to the nearest neighbour (negative if invalid). */
+    std::vector<long long> neighbours;      /**< Nearest neighbour index (-1 if invalid). */
+
+    /**
+     * @brief Picks windows in a given order, skipping those within half a window of an earlier pick.
+     * @param order Candidate window indices, best first.
+     * @param count Maximum number of picks.
+     * @param includeNeighbours Also block the area around each pick's neighbour.
+     * @return std::vector<ProfileEvent> Picked windows.
+     */
+    std::vector<ProfileEvent> pick(const std::vector<std::size_t> &order, std::size_t count,
+                                   bool includeNeighbours) const;
+};
+
+#endif // MATRIXPROFILE_H
@@ -0,0 +1,287 @@
+/**
+ * @file MetricsRegistry.cpp
+ * @brief Implements the sharded metrics and their Prometheus text rendering.
+ */
+
+#include "MetricsRegistry.h"
+#include "ErrorHandling.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+const char *const MetricsRegistry::kContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+namespace {
+
+/**
+ * @brief Reinterprets a double as the bits stored in a slot.
+ */
+std::uint64_t toBits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Reinterprets the bits stored in a slot as a double.
+ */
+double fromBits(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Formats a sample value the way Prometheus spells it.
+ * @param value The value.
+ * @return std::string The text.
+ */
+std::string formatNumber(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.15g", value);
+    return text;
+}
+
+/**
+ * @brief Appends one sample line: name{labels[,extra]} value.
+ * @param out Output.
+ * @param name Sample name.
+ * @param labels Label pairs without braces (may be empty).
+ * @param extra One more label pair (may be empty).
+ * @param value The formatted value.
+ */
+void appendSample(std::string &out, const std::string &name, const std::string &labels, const std::string &extra,
+                  const std::string &value) {
+    out += name;
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) out += ',';
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+} // namespace
+
+/**
+ * @brief Gets the calling thread's shard.
+ * @return std::size_t Shard index below kShards.
+ */
+std::size_t metrics_detail::threadShard() {
+    static std::atomic<std::size_t> nextShard{0};
+    thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shard;
+}
+
+/**
+ * @brief Sums the counter's shards.
+ * @return std::uint64_t The count.
+ */
+std::uint64_t MetricCounter::value() const {
+    std::uint64_t total = 0;
+    for (const metrics_detail::Line &shard : shards) total += shard.slots[0].load(std::memory_order_relaxed);
+    return total;
+}
+
+/**
+ * @brief Adds to the gauge.
+ * @param amount Amount to add.
+ */
+void MetricGauge::add(double amount) {
+    double expected = current.load(std::memory_order_relaxed);
+    while (!current.compare_exchange_weak(expected, expected + amount, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Constructs a histogram.
+ * @param bounds Bucket upper bounds, increasing.
+ */
+MetricHistogram::MetricHistogram(std::vector<double> bounds)
+    : upperBounds(std::move(bounds)), linesPerShard((upperBounds.size() + 2 + 7) / 8),
+      lines(new metrics_detail::Line[metrics_detail::kShards * linesPerShard]) {}
+
+/**
+ * @brief Records an observation in the calling thread's shard.
+ *
+ * Histograms have a handful of buckets, so a linear scan beats a binary search here.
+ *
+ * @param value The observed value.
+ */
+void MetricHistogram::observe(double value) {
+    std::size_t bucket = 0;
+    while (bucket < upperBounds.size() && value > upperBounds[bucket]) ++bucket;
+    std::size_t shard = metrics_detail::threadShard();
+    slot(shard, bucket).fetch_add(1, std::memory_order_relaxed);
+    // The shard is normally written by one thread only, so this loop almost never retries.
+    std::atomic<std::uint64_t> &sum = slot(shard, upperBounds.size() + 1);
+    std::uint64_t expected = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(expected, toBits(fromBits(expected) + value), std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Sums the shards.
+ * @param[out] bucketCounts Non-cumulative count per bucket, the +Inf bucket last.
+ * @param[out] sum Sum of all observations.
+ */
+void MetricHistogram::snapshot(std::vector<std::uint64_t> &bucketCounts, double &sum) const {
+    bucketCounts.assign(upperBounds.size() + 1, 0);
+    sum = 0.0;
+    for (std::size_t shard = 0; shard < metrics_detail::kShards; ++shard) {
+        for (std::size_t b = 0; b < bucketCounts.size(); ++b)
+            bucketCounts[b] += slot(shard, b).load(std::memory_order_relaxed);
+        sum += fromBits(slot(shard, upperBounds.size() + 1).load(std::memory_order_relaxed));
+    }
+}
+
+/**
+ * @brief Gets the process-wide registry.
+ * @return MetricsRegistry& The registry.
+ */
+MetricsRegistry &MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+/**
+ * @brief Gets or creates a counter.
+ * @param name Metric name, optionally with labels.
+ * @param help One-line description.
+ * @return MetricCounter& The counter.
+ */
+MetricCounter &MetricsRegistry::counter(const std::string &name, const std::string &help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool created = false;
+    Entry &entry = lookup(name, help, Type::Counter, created);
+    if (created) entry.counter.reset(new MetricCounter());
+    return *entry.counter;
+}
+
+/**
+ * @brief Gets or creates a gauge.
+ * @param name Metric name, optionally with labels.
+ * @param help One-line description.
+ * @return MetricGauge& The gauge.
+ */
+MetricGauge &MetricsRegistry::gauge(const std::string &name, const std::string &help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool created = false;
+    Entry &entry = lookup(name, help, Type::Gauge, created);
+    if (created) entry.gauge.reset(new MetricGauge());
+    return *entry.gauge;
+}
+
+/**
+ * @brief Gets or creates a histogram.
+ * @param name Metric name, optionally with labels.
+ * @param help One-line description.
+ * @param bounds Bucket upper bounds, increasing.
+ * @return MetricHistogram& The histogram.
+ */
+MetricHistogram &MetricsRegistry::histogram(const std::string &name, const std::string &help,
+                                            std::vector<double> bounds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool created = false;
+    Entry &entry = lookup(name, help, Type::Histogram, created);
+    if (created) entry.histogram.reset(new MetricHistogram(std::move(bounds)));
+    return *entry.histogram;
+}
+
+/**
+ * @brief Finds or creates an entry.
+ *
+ * A name already registered as another type is a programming error; it is logged and the caller gets a
+ * metric of its own that is not exported, so instrumentation never breaks the code it measures.
+ *
+ * @param name Metric name, optionally with labels.
+ * @param help Description.
+ * @param type Kind of metric.
+ * @param created Set to true if the entry is new.
+ * @return Entry& The entry.
+ */
+MetricsRegistry::Entry &MetricsRegistry::lookup(const std::string &name, const std::string &help, Type type,
+                                                bool &created) {
+    std::size_t brace = name.find('{');
+    std::string family = name.substr(0, brace);
+    std::string labels;
+    if (brace != std::string::npos && name.size() > brace + 1 && name.back() == '}')
+        labels = name.substr(brace + 1, name.size() - brace - 2);
+
+    bool exported = true;
+    for (const std::unique_ptr<Entry> &entry : entries) {
+        if (entry->family != family) continue;
+        if (entry->type != type) {
+            if (exported)
+                ErrorHandling::logErrorMessage("Metric " + name + " registered with two different types");
+            exported = false;
+        } else if (entry->labels == labels && !entry->help.empty()) {
+            return *entry;
+        }
+    }
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->family = family;
+    entry->labels = labels;
+    entry->help = exported ? (help.empty() ? family : help) : std::string();
+    entry->type = type;
+    created = true;
+    entries.push_back(std::move(entry));
+    return *entries.back();
+}
+
+/**
+ * @brief Renders every metric in the Prometheus text format.
+ *
+ * Samples of one family are written together under a single HELP and TYPE line, as the format requires,
+ * even if they were registered apart. Entries without help text are the unexported duplicates.
+ *
+ * @return std::string The exposition.
+ */
+std::string MetricsRegistry::exposition() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    std::vector<bool> written(entries.size(), false);
+    std::vector<std::uint64_t> buckets;
+    for (std::size_t first = 0; first < entries.size(); ++first) {
+        const Entry &head = *entries[first];
+        if (written[first] || head.help.empty()) continue;
+        out += "# HELP " + head.family + ' ';
+        for (char c : head.help) {
+            if (c == '\\') out += "\\\\";
+            else if (c == '\n') out += "\\n";
+            else out += c;
+        }
+        static const char *const typeNames[] = {"counter", "gauge", "histogram"};
+        out += "\n# TYPE " + head.family + ' ' + typeNames[static_cast<int>(head.type)] + '\n';
+
+        for (std::size_t i = first; i < entries.size(); ++i) {
+            const Entry &entry = *entries[i];
+            if (written[i] || entry.family != head.family || entry.help.empty()) continue;
+            written[i] = true;
+            if (entry.type == Type::Counter) {
+                appendSample(out, entry.family, entry.labels, "", std::to_string(entry.counter->value()));
+            } else if (entry.type == Type::Gauge) {
+                appendSample(out, entry.family, entry.labels, "", formatNumber(entry.gauge->value()));
+            } else {
+                double sum = 0.0;
+                entry.histogram->snapshot(buckets, sum);
+                const std::vector<double> &bounds = entry.histogram->bounds();
+                std::uint64_t cumulative = 0;
+                for (std::size_t b = 0; b < buckets.size(); ++b) {
+                    cumulative += buckets[b];
+                    std::string le = "le=\"" + (b < bounds.size() ? formatNumber(bounds[b]) : "+Inf") + '"';
+                    appendSample(out, entry.family + "_bucket", entry.labels, le, std::to_string(cumulative));
+                }
+                appendSample(out, entry.family + "_sum", entry.labels, "", formatNumber(sum));
+                appendSample(out, entry.family + "_count", entry.labels, "", std::to_string(cumulative));
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,222 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+/**
+ * @file MetricsRegistry.h
+ * @brief Declaration of the process-wide counters, gauges and histograms exported in Prometheus text format.
+ *
+ * ErrorHandling records what went wrong as free text; this header declares the numbers that show what the
+ * program is doing: readings ingested, CSV bytes scanned, emails sent, GUI stalls and so on. Updates are a
+ * relaxed atomic add on a cache line owned by the calling thread, so they are cheap enough for hot paths.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics_detail {
+
+const std::size_t kShards = 16;             /**< Cache-line shards per metric; a power of two. */
+
+/**
+ * @brief One cache line of atomic slots, so shards written by different threads never share a line.
+ */
+struct alignas(64) Line {
+    std::atomic<std::uint64_t> slots[8];
+    Line() {
+        for (std::atomic<std::uint64_t> &slot : slots) slot.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Gets the calling thread's shard, assigned round-robin the first time the thread records anything.
+ * @return std::size_t Shard index below kShards.
+ */
+std::size_t threadShard();
+
+} // namespace metrics_detail
+
+/**
+ * @class MetricCounter
+ * @brief A monotonically increasing count, e.g. readings ingested.
+ */
+class MetricCounter {
+public:
+    /**
+     * @brief Adds to the counter.
+     * @param amount Amount to add.
+     */
+    void add(std::uint64_t amount = 1) {
+        shards[metrics_detail::threadShard()].slots[0].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /** @return std::uint64_t Sum over all shards. */
+    std::uint64_t value() const;
+
+private:
+    metrics_detail::Line shards[metrics_detail::kShards];
+};
+
+/**
+ * @class MetricGauge
+ * @brief A value that goes up and down, e.g. open connections.
+ *
+ * Gauges are set rather than accumulated, which does not shard, so a gauge is a single atomic. Set them
+ * from state changes, not per item.
+ */
+class MetricGauge {
+public:
+    /**
+     * @brief Sets the gauge.
+     * @param newValue New value.
+     */
+    void set(double newValue) { current.store(newValue, std::memory_order_relaxed); }
+
+    /**
+     * @brief Adds to the gauge (negative to subtract).
+     * @param amount Amount to add.
+     */
+    void add(double amount);
+
+    /** @return double Current value. */
+    double value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> current{0.0};
+};
+
+/**
+ * @class MetricHistogram
+ * @brief Counts observations into fixed buckets, e.g. how long an append took.
+ *
+ * Each shard holds one count per bucket plus the running sum, on cache lines of its own. Bucket bounds are
+ * inclusive upper bounds in increasing order; values above the last bound land in the implicit +Inf bucket.
+ */
+class MetricHistogram {
+public:
+    /**
+     * @brief Constructs a histogram.
+     * @param bounds Bucket upper bounds, increasing.
+     */
+    explicit MetricHistogram(std::vector<double> bounds);
+
+    /**
+     * @brief Records an observation.
+     * @param value The observed value.
+     */
+    void observe(double value);
+
+    /** @return const std::vector<double>& Bucket upper bounds. */
+    const std::vector<double> &bounds() const { return upperBounds; }
+
+    /**
+     * @brief Sums the shards.
+     * @param[out] bucketCounts Non-cumulative count per bucket, the +Inf bucket last.
+     * @param[out] sum Sum of all observations.
+     */
+    void snapshot(std::vector<std::uint64_t> &bucketCounts, double &sum) const;
+
+private:
+    std::vector<double> upperBounds;                        /**< Bucket upper bounds. */
+    std::size_t linesPerShard;                              /**< Cache lines holding one shard. */
+    std::unique_ptr<metrics_detail::Line[]> lines;          /**< kShards * linesPerShard lines. */
+
+    /**
+     * @brief Gets a slot of a shard: slot b < bounds().size() + 1 is bucket b, the next one is the sum.
+     * @param shard Shard index.
+     * @param slot Slot index.
+     * @return std::atomic<std::uint64_t>& The slot.
+     */
+    std::atomic<std::uint64_t> &slot(std::size_t shard, std::size_t slot) const {
+        return lines[shard * linesPerShard + slot / 8].slots[slot % 8];
+    }
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Names the metrics of a process and renders them in the Prometheus text exposition format.
+ *
+ * Metrics are created on first use and live as long as the registry, so callers look one up once and keep
+ * the reference, typically in a function-local static:
+ *
+ *     static MetricCounter &ingested = MetricsRegistry::global().counter("heartpi_readings_ingested_total",
+ *                                                                        "Readings appended to the CSV.");
+ *     ingested.add(count);
+ *
+ * A name may carry a fixed label set, e.g. "heartpi_gui_timer_ticks_total{timer=\"live_chart\"}"; metrics
+ * that share the part before '{' are one family and must have the same type. Looking metrics up and
+ * rendering take a lock; recording does not.
+ */
+class MetricsRegistry {
+public:
+    static const char *const kContentType;  /**< Content-Type of exposition() output. */
+
+    /** @return MetricsRegistry& The registry the program's own instrumentation uses. */
+    static MetricsRegistry &global();
+
+    /**
+     * @brief Gets or creates a counter.
+     * @param name Metric name, optionally with labels.
+     * @param help One-line description.
+     * @return MetricCounter& The counter.
+     */
+    MetricCounter &counter(const std::string &name, const std::string &help);
+
+    /**
+     * @brief Gets or creates a gauge.
+     * @param name Metric name, optionally with labels.
+     * @param help One-line description.
+     * @return MetricGauge& The gauge.
+     */
+    MetricGauge &gauge(const std::string &name, const std::string &help);
+
+    /**
+     * @brief Gets or creates a histogram; the bounds of an existing one are kept.
+     * @param name Metric name, optionally with labels.
+     * @param help One-line description.
+     * @param bounds Bucket upper bounds, increasing.
+     * @return MetricHistogram& The histogram.
+     */
+    MetricHistogram &histogram(const std::string &name, const std::string &help, std::vector<double> bounds);
+
+    /**
+     * @brief Renders every metric in the Prometheus text format (version 0.0.4).
+     * @return std::string The exposition, families in registration order.
+     */
+    std::string exposition() const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    /**
+     * @brief One registered metric.
+     */
+    struct Entry {
+        std::string family;                         /**< Name without labels. */
+        std::string labels;                         /**< Label pairs without braces (may be empty). */
+        std::string help;                           /**< Description. */
+        Type type;                                  /**< Kind of metric. */
+        std::unique_ptr<MetricCounter> counter;     /**< Set for counters. */
+        std::unique_ptr<MetricGauge> gauge;         /**< Set for gauges. */
+        std::unique_ptr<MetricHistogram> histogram; /**< Set for histograms. */
+    };
+
+    mutable std::mutex mutex;                       /**< Guards entries (not the metrics themselves). */
+    std::vector<std::unique_ptr<Entry>> entries;    /**< Metrics in registration order. */
+
+    /**
+     * @brief Finds or creates an entry; the caller holds the lock.
+     * @param name Metric name, optionally with labels.
+     * @param help Description.
+     * @param type Kind of metric.
+     * @param created Set to true if the entry is new.
+     * @return Entry& The entry.
+     */
+    Entry &lookup(const std::string &name, const std::string &help, Type type, bool &created);
+};
+
+#endif // METRICSREGISTRY_H
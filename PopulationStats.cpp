@@ -0,0 +1,128 @@
+/**
+ * @file PopulationStats.cpp
+ * @brief Implements the PopulationStats sketch collection.
+ *
+ * File format: a "HeartPiPopulation,1" header, then for each sketch a "name,<key>" line followed by the
+ * sketch's own lines.
+ */
+
+#include "PopulationStats.h"
+#include "ErrorHandling.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const char *kPopulationMagic = "HeartPiPopulation,1";
+
+} // namespace
+
+/**
+ * @brief Gets the key of the per-user daily average heart-rate distribution.
+ * @return std::string Key.
+ */
+std::string PopulationStats::userDayKey() {
+    return "user-day/bpm";
+}
+
+/**
+ * @brief Gets the key of a vital-sign distribution for one risk tier and age group.
+ * @param vital Vital name.
+ * @param tier Risk tier.
+ * @param ageGroup Survey age group.
+ * @return std::string Key.
+ */
+std::string PopulationStats::vitalKey(const std::string &vital, const std::string &tier, int ageGroup) {
+    return "vital/" + vital + "/" + tier + "/" + std::to_string(ageGroup);
+}
+
+/**
+ * @brief Adds a value to a sketch, creating it on first use.
+ * @param key Sketch key.
+ * @param value Value to add.
+ */
+void PopulationStats::add(const std::string &key, double value) {
+    sketches[key].add(value);
+}
+
+/**
+ * @brief Merges every sketch of another collection into this one.
+ * @param other Collection to merge.
+ */
+void PopulationStats::merge(const PopulationStats &other) {
+    for (const auto &entry : other.sketches) sketches[entry.first].merge(entry.second);
+}
+
+/**
+ * @brief Looks up a sketch.
+ * @param key Sketch key.
+ * @return const QuantileSketch* The sketch, or nullptr.
+ */
+const QuantileSketch* PopulationStats::find(const std::string &key) const {
+    auto it = sketches.find(key);
+    return it == sketches.end() ? nullptr : &it->second;
+}
+
+/**
+ * @brief Estimates the percentile rank of a value within one sketch.
+ * @param key Sketch key.
+ * @param value Value to rank.
+ * @return double Percentile rank, or -1 if the sketch does not exist.
+ */
+double PopulationStats::percentileRank(const std::string &key, double value) const {
+    const QuantileSketch *sketch = find(key);
+    return sketch && !sketch->empty() ? sketch->percentileRank(value) : -1.0;
+}
+
+/**
+ * @brief Loads the collection from a file.
+ * @param path File path.
+ * @return bool False if the file exists but is malformed.
+ */
+bool PopulationStats::load(const std::string &path) {
+    sketches.clear();
+    std::ifstream in(path);
+    if (!in.is_open()) return true;
+
+    std::string line;
+    if (!std::getline(in, line) || line != kPopulationMagic) {
+        ErrorHandling::logErrorMessage("Ignoring malformed population sketches in " + path);
+        return false;
+    }
+    while (std::getline(in, line)) {
+        if (line.compare(0, 5, "name,") != 0 || !sketches[line.substr(5)].read(in)) {
+            ErrorHandling::logErrorMessage("Ignoring malformed population sketches in " + path);
+            sketches.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Saves the collection to a file.
+ * @param path File path.
+ * @return bool False if the file could not be written.
+ */
+bool PopulationStats::save(const std::string &path) const {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out.is_open()) {
+            ErrorHandling::logErrorMessage("Failed to write population sketches " + tempPath);
+            return false;
+        }
+        out << kPopulationMagic << "\n";
+        for (const auto &entry : sketches) {
+            out << "name," << entry.first << "\n";
+            entry.second.write(out);
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        ErrorHandling::logErrorMessage("Failed to replace population sketches " + path + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
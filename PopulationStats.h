@@ -0,0 +1,91 @@
+#ifndef POPULATIONSTATS_H
+#define POPULATIONSTATS_H
+
+/**
+ * @file PopulationStats.h
+ * @brief Declaration of the PopulationStats class, a keyed collection of quantile sketches.
+ *
+ * This header declares the population-wide distributions used for percentile ranks: the daily average heart
+ * rate of every user-day, and each vital sign broken down by risk tier and survey age group. All of them are
+ * QuantileSketch objects, so a batch's contribution can be built separately and merged in.
+ */
+
+#include "QuantileSketch.h"
+#include <map>
+#include <string>
+
+/**
+ * @class PopulationStats
+ * @brief Named QuantileSketch objects with persistence and merging.
+ */
+class PopulationStats {
+private:
+    std::map<std::string, QuantileSketch> sketches;     /**< Sketch per key. */
+
+public:
+    /**
+     * @brief Gets the key of the per-user daily average heart-rate distribution.
+     *
+     * A user's average keeps moving as readings arrive and a sketch cannot retract values, so each user
+     * contributes one value per completed day instead of one ever-changing lifetime average.
+     *
+     * @return std::string Key.
+     */
+    static std::string userDayKey();
+
+    /**
+     * @brief Gets the key of a vital-sign distribution for one risk tier and age group.
+     * @param vital Vital name (e.g. "bpm", "spo2", "sysbp").
+     * @param tier Risk tier ("Low", "Moderate" or "High").
+     * @param ageGroup Survey age group (1: 18-24 ... 6: 65+).
+     * @return std::string Key.
+     */
+    static std::string vitalKey(const std::string &vital, const std::string &tier, int ageGroup);
+
+    /**
+     * @brief Adds a value to a sketch, creating it on first use.
+     * @param key Sketch key.
+     * @param value Value to add.
+     */
+    void add(const std::string &key, double value);
+
+    /**
+     * @brief Merges every sketch of another collection into this one.
+     * @param other Collection to merge.
+     */
+    void merge(const PopulationStats &other);
+
+    /**
+     * @brief Looks up a sketch.
+     * @param key Sketch key.
+     * @return const QuantileSketch* The sketch, or nullptr if nothing was added under the key.
+     */
+    const QuantileSketch* find(const std::string &key) const;
+
+    /**
+     * @brief Estimates the percentile rank of a value within one sketch.
+     * @param key Sketch key.
+     * @param value Value to rank.
+     * @return double Percentile rank in [0, 100], or -1 if the sketch does not exist.
+     */
+    double percentileRank(const std::string &key, double value) const;
+
+    /** @return bool True if no sketch exists. */
+    bool empty() const { return sketches.empty(); }
+
+    /**
+     * @brief Loads the collection from a file.
+     * @param path File path.
+     * @return bool False if the file exists but is malformed (the collection is left empty).
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief Saves the collection to a file via a temporary file and rename.
+     * @param path File path.
+     * @return bool False if the file could not be written.
+     */
+    bool save(const std::string &path) const;
+};
+
+#endif // POPULATIONSTATS_H
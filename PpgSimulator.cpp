@@ -0,0 +1,72 @@
+/**
+ * @file PpgSimulator.cpp
+ * @brief Implements the PpgSimulator class for generating two-channel PPG signals.
+ *
+ * The generated signal follows the Beer-Lambert model used by reflective pulse oximeters: a large DC term
+ * with a small pulsatile term whose relative size differs between the red and infrared wavelengths
+ * according to the oxygen saturation.
+ */
+
+#include "PpgSimulator.h"
+#include <cmath>
+
+namespace {
+const double kPi = 3.14159265358979323846;
+}
+
+/**
+ * @brief Constructs a new PpgSimulator object.
+ *
+ * DC levels and IR perfusion are chosen to resemble typical finger readings on an 18-bit MAX30102.
+ *
+ * @param sampleRateHz Samples per second per channel.
+ * @param heartRateBpm Initial pulse rate in beats per minute.
+ * @param spo2Percent Initial target oxygen saturation in percent.
+ */
+PpgSimulator::PpgSimulator(double sampleRateHz, double heartRateBpm, double spo2Percent)
+    : sampleRate(sampleRateHz), heartRate(heartRateBpm), spo2(spo2Percent),
+      redDc(52000.0), irDc(61000.0), irPerfusion(0.02),
+      phase(0.0), wanderPhase(0.0), noise(-1.0, 1.0) {}
+
+/**
+ * @brief Evaluates the normalised pulse shape at a cardiac phase.
+ *
+ * A fundamental plus two harmonics gives a sharp systolic upstroke and a visible dicrotic notch.
+ *
+ * @param cyclePhase Phase within the cardiac cycle in [0, 1).
+ * @return double Pulse amplitude in roughly [-1, 1].
+ */
+double PpgSimulator::pulseShape(double cyclePhase) {
+    double w = 2.0 * kPi * cyclePhase;
+    return 0.80 * std::sin(w) + 0.35 * std::sin(2.0 * w + 0.8) + 0.10 * std::sin(3.0 * w + 1.6);
+}
+
+/**
+ * @brief Generates consecutive red/IR sample pairs.
+ *
+ * The ratio-of-ratios R = (AC_red/DC_red) / (AC_ir/DC_ir) is derived from the target SpO2 by inverting
+ * SpO2 = 110 - 25 * R. Light absorption lowers the received intensity, so the pulse is subtracted from DC.
+ *
+ * @param[out] red Buffer receiving @p count red samples.
+ * @param[out] ir Buffer receiving @p count infrared samples.
+ * @param count Number of sample pairs to generate.
+ */
+void PpgSimulator::generate(double* red, double* ir, int count) {
+    double ratio = (110.0 - spo2) / 25.0;
+    double redPerfusion = ratio * irPerfusion;
+    double phaseStep = heartRate / 60.0 / sampleRate;
+    double wanderStep = 0.25 / sampleRate; // ~15 breaths per minute
+
+    for (int i = 0; i < count; ++i) {
+        double pulse = pulseShape(phase);
+        double wander = 1.0 + 0.001 * std::sin(2.0 * kPi * wanderPhase);
+
+        red[i] = redDc * wander * (1.0 - 0.5 * redPerfusion * pulse) + 15.0 * noise.generate();
+        ir[i]  = irDc  * wander * (1.0 - 0.5 * irPerfusion  * pulse) + 15.0 * noise.generate();
+
+        phase += phaseStep;
+        if (phase >= 1.0) phase -= 1.0;
+        wanderPhase += wanderStep;
+        if (wanderPhase >= 1.0) wanderPhase -= 1.0;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef PPGSIMULATOR_H
+#define PPGSIMULATOR_H
+
+/**
+ * @file PpgSimulator.h
+ * @brief Declaration of the PpgSimulator class.
+ *
+ * This header declares a two-channel photoplethysmogram (PPG) generator that mimics the red and
+ * infrared outputs of a MAX30102-class pulse oximetry sensor. It is used to drive the SpO2Processor
+ * when no physical sensor is attached.
+ */
+
+#include "RandomNumberGenerator.h"
+
+/**
+ * @class PpgSimulator
+ * @brief Generates simulated red and infrared PPG sample pairs.
+ *
+ * Each channel is modelled as a large DC level (tissue and venous blood absorption) plus a small pulsatile
+ * AC component (arterial blood) at the configured heart rate, with slow baseline wander and additive noise.
+ * The red channel's perfusion is scaled so that the ratio-of-ratios matches the target SpO2 under the
+ * standard empirical calibration SpO2 = 110 - 25 * R.
+ */
+class PpgSimulator {
+private:
+    double sampleRate;          /**< Samples per second per channel. */
+    double heartRate;           /**< Pulse rate in beats per minute. */
+    double spo2;                /**< Target oxygen saturation in percent. */
+    double redDc;               /**< DC level of the red channel (ADC counts). */
+    double irDc;                /**< DC level of the IR channel (ADC counts). */
+    double irPerfusion;         /**< AC/DC ratio of the IR channel. */
+    double phase;               /**< Cardiac phase in cycles, kept in [0, 1). */
+    double wanderPhase;         /**< Respiratory baseline wander phase in cycles. */
+    RandomNumberGenerator noise; /**< Uniform noise source shared by both channels. */
+
+    /**
+     * @brief Evaluates the normalised pulse shape at a cardiac phase.
+     *
+     * @param cyclePhase Phase within the cardiac cycle in [0, 1).
+     * @return double Pulse amplitude in roughly [-1, 1] with a systolic peak and dicrotic notch.
+     */
+    static double pulseShape(double cyclePhase);
+
+public:
+    /**
+     * @brief Constructs a new PpgSimulator object.
+     *
+     * @param sampleRateHz Samples per second per channel (the MAX30102 default is 100 Hz).
+     * @param heartRateBpm Initial pulse rate in beats per minute.
+     * @param spo2Percent Initial target oxygen saturation in percent.
+     */
+    PpgSimulator(double sampleRateHz = 100.0, double heartRateBpm = 70.0, double spo2Percent = 98.0);
+
+    /**
+     * @brief Sets the pulse rate used for subsequent samples.
+     * @param bpm Pulse rate in beats per minute.
+     */
+    void setHeartRate(double bpm) { heartRate = bpm; }
+
+    /**
+     * @brief Sets the target oxygen saturation used for subsequent samples.
+     * @param percent Oxygen saturation in percent.
+     */
+    void setSpO2(double percent) { spo2 = percent; }
+
+    /**
+     * @brief Gets the sample rate of the simulator.
+     * @return double Samples per second per channel.
+     */
+    double getSampleRate() const { return sampleRate; }
+
+    /**
+     * @brief Generates consecutive red/IR sample pairs.
+     *
+     * Phase is carried across calls so that successive blocks form a continuous signal.
+     *
+     * @param[out] red Buffer receiving @p count red samples.
+     * @param[out] ir Buffer receiving @p count infrared samples.
+     * @param count Number of sample pairs to generate.
+     */
+    void generate(double* red, double* ir, int count);
+};
+
+#endif // PPGSIMULATOR_H
@@ -0,0 +1,245 @@
+/**
+ * @file QuantileSketch.cpp
+ * @brief Implements the KLL QuantileSketch.
+ *
+ * Serialised form: "sketch,k,n,min,max,levelCount" followed by "level,<itemCount>,v1,v2,..." per level.
+ */
+
+#include "QuantileSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+/**
+ * @brief Constructs a new QuantileSketch object.
+ * @param k Accuracy parameter.
+ */
+QuantileSketch::QuantileSketch(int k) : k(std::max(8, k)), levels(1) {}
+
+/**
+ * @brief Gets the capacity of a level.
+ *
+ * The top level holds k items; each level below holds 2/3 as many, with a floor of 2.
+ *
+ * @param level Level index.
+ * @return std::size_t Capacity.
+ */
+std::size_t QuantileSketch::capacity(std::size_t level) const {
+    std::size_t depth = levels.size() - 1 - level;
+    double cap = std::ceil(k * std::pow(2.0 / 3.0, static_cast<double>(depth)));
+    return std::max<std::size_t>(2, static_cast<std::size_t>(cap));
+}
+
+/**
+ * @brief Adds one value.
+ * @param value Value to add.
+ */
+void QuantileSketch::add(double value) {
+    if (n == 0) {
+        minValue = value;
+        maxValue = value;
+    } else {
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+    }
+    ++n;
+    levels[0].push_back(value);
+    ++retainedItems;
+    if (retainedItems >= totalCapacity()) compress();
+    viewValid = false;
+}
+
+/**
+ * @brief Gets the sum of all level capacities.
+ * @return std::size_t Total capacity.
+ */
+std::size_t QuantileSketch::totalCapacity() const {
+    std::size_t total = 0;
+    for (std::size_t h = 0; h < levels.size(); ++h) total += capacity(h);
+    return total;
+}
+
+/**
+ * @brief Compacts the lowest full level.
+ *
+ * The level is sorted and, starting at a random offset of 0 or 1, every second item moves up a level
+ * (doubling its weight). With an odd item count the largest item stays behind so no weight is lost.
+ * Compacting lazily (only once the whole sketch is full) keeps more items at low levels, which is where
+ * most of the accuracy comes from.
+ */
+void QuantileSketch::compress() {
+    for (std::size_t h = 0; h < levels.size(); ++h) {
+        if (levels[h].size() < capacity(h)) continue;
+        if (h + 1 == levels.size()) levels.emplace_back();
+
+        std::vector<double> &level = levels[h];
+        std::sort(level.begin(), level.end());
+        double leftover = 0.0;
+        bool hasLeftover = level.size() % 2 == 1;
+        if (hasLeftover) {
+            leftover = level.back();
+            level.pop_back();
+        }
+
+        coin ^= coin << 13;
+        coin ^= coin >> 17;
+        coin ^= coin << 5;
+        std::size_t offset = coin & 1u;
+
+        std::vector<double> &next = levels[h + 1];
+        std::size_t before = level.size();
+        for (std::size_t i = offset; i < level.size(); i += 2) next.push_back(level[i]);
+        retainedItems -= before / 2;
+        level.clear();
+        if (hasLeftover) level.push_back(leftover);
+        return;
+    }
+}
+
+/**
+ * @brief Merges another sketch into this one.
+ * @param other Sketch to merge.
+ */
+void QuantileSketch::merge(const QuantileSketch &other) {
+    if (other.n == 0) return;
+    if (n == 0) {
+        minValue = other.minValue;
+        maxValue = other.maxValue;
+    } else {
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+    if (levels.size() < other.levels.size()) levels.resize(other.levels.size());
+    for (std::size_t h = 0; h < other.levels.size(); ++h)
+        levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+    n += other.n;
+    retainedItems += other.retainedItems;
+
+    while (retainedItems >= totalCapacity()) compress();
+    viewValid = false;
+}
+
+/**
+ * @brief Rebuilds the sorted view used by rank and quantile queries.
+ */
+void QuantileSketch::buildView() const {
+    std::vector<std::pair<double, long long>> items;
+    items.reserve(retained());
+    for (std::size_t h = 0; h < levels.size(); ++h)
+        for (double v : levels[h]) items.emplace_back(v, 1LL << h);
+    std::sort(items.begin(), items.end());
+
+    viewValues.resize(items.size());
+    viewWeights.resize(items.size());
+    long long cumulative = 0;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        cumulative += items[i].second;
+        viewValues[i] = items[i].first;
+        viewWeights[i] = cumulative;
+    }
+    viewValid = true;
+}
+
+/**
+ * @brief Estimates the percentile rank of a value.
+ *
+ * Two binary searches over the sorted view give the weight strictly below and the weight equal to the
+ * value. The retained weight can differ slightly from n after compaction, so ranks are normalised by it.
+ *
+ * @param value Value to rank.
+ * @return double Percentile rank in [0, 100].
+ */
+double QuantileSketch::percentileRank(double value) const {
+    if (n == 0) return 0.0;
+    if (!viewValid) buildView();
+    if (viewWeights.empty()) return 0.0;
+    std::size_t lo = std::lower_bound(viewValues.begin(), viewValues.end(), value) - viewValues.begin();
+    std::size_t hi = std::upper_bound(viewValues.begin(), viewValues.end(), value) - viewValues.begin();
+    double below = lo > 0 ? static_cast<double>(viewWeights[lo - 1]) : 0.0;
+    double atOrBelow = hi > 0 ? static_cast<double>(viewWeights[hi - 1]) : 0.0;
+    double total = static_cast<double>(viewWeights.back());
+    return 100.0 * (below + 0.5 * (atOrBelow - below)) / total;
+}
+
+/**
+ * @brief Estimates a quantile.
+ * @param fraction Quantile in [0, 1].
+ * @return double The estimated value.
+ */
+double QuantileSketch::quantile(double fraction) const {
+    if (n == 0) return 0.0;
+    if (fraction <= 0.0) return minValue;
+    if (fraction >= 1.0) return maxValue;
+    if (!viewValid) buildView();
+    long long target = static_cast<long long>(std::ceil(fraction * viewWeights.back()));
+    std::size_t i = std::lower_bound(viewWeights.begin(), viewWeights.end(), target) - viewWeights.begin();
+    return viewValues[std::min(i, viewValues.size() - 1)];
+}
+
+/**
+ * @brief Writes the sketch.
+ * @param out Output stream.
+ */
+void QuantileSketch::write(std::ostream &out) const {
+    std::streamsize precision = out.precision(17);
+    out << "sketch," << k << "," << n << "," << minValue << "," << maxValue << "," << levels.size() << "\n";
+    for (const std::vector<double> &level : levels) {
+        out << "level," << level.size();
+        for (double v : level) out << "," << v;
+        out << "\n";
+    }
+    out.precision(precision);
+}
+
+/**
+ * @brief Reads a sketch previously produced by write().
+ *
+ * Item counts are checked against the capacity of a sketch with the stored k and level count before any
+ * level is allocated, so a corrupt file cannot make the reader allocate without bound.
+ *
+ * @param in Input stream positioned at the "sketch" line.
+ * @return bool False if the data is malformed.
+ */
+bool QuantileSketch::read(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 7, "sketch,") != 0) return false;
+    char *end = nullptr;
+    long parsedK = std::strtol(line.c_str() + 7, &end, 10);
+    if (*end != ',') return false;
+    long long parsedN = std::strtoll(end + 1, &end, 10);
+    if (*end != ',') return false;
+    double parsedMin = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    double parsedMax = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    long levelCount = std::strtol(end + 1, &end, 10);
+    const long kMaxK = 1L << 20;   // Far above any k in use.
+    if (levelCount < 1 || levelCount > 64 || parsedK < 1 || parsedK > kMaxK) return false;
+
+    QuantileSketch shape(static_cast<int>(parsedK));
+    shape.levels.resize(static_cast<std::size_t>(levelCount));
+    std::size_t room = shape.totalCapacity();
+    std::vector<std::vector<double>> parsedLevels(static_cast<std::size_t>(levelCount));
+    for (std::vector<double> &level : parsedLevels) {
+        if (!std::getline(in, line) || line.compare(0, 6, "level,") != 0) return false;
+        long long items = std::strtoll(line.c_str() + 6, &end, 10);
+        if (items < 0 || static_cast<unsigned long long>(items) > room) return false;
+        room -= static_cast<std::size_t>(items);
+        level.resize(static_cast<std::size_t>(items));
+        for (double &v : level) {
+            if (*end != ',') return false;
+            v = std::strtod(end + 1, &end);
+        }
+    }
+
+    k = std::max(8, static_cast<int>(parsedK));
+    n = parsedN;
+    minValue = parsedMin;
+    maxValue = parsedMax;
+    levels.swap(parsedLevels);
+    retainedItems = 0;
+    for (const std::vector<double> &level : levels) retainedItems += level.size();
+    viewValid = false;
+    return true;
+}
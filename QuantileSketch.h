@@ -0,0 +1,129 @@
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+/**
+ * @file QuantileSketch.h
+ * @brief Declaration of the QuantileSketch class, a mergeable KLL quantile sketch.
+ *
+ * This header declares a compact summary of a stream of values that answers rank and quantile queries with a
+ * bounded error, and that can be merged with another sketch of the same kind. Population statistics use it
+ * so that "where does this value fall among everyone?" never requires scanning other users' data.
+ */
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class QuantileSketch
+ * @brief KLL sketch (Karnin, Lang and Liberty, 2016) with a cached sorted view for O(log k) rank queries.
+ *
+ * Items live in a stack of compactors. Level h holds items of weight 2^h; when the sketch reaches its total
+ * capacity, the lowest full level is sorted and every other item is promoted to the next level. Capacities
+ * shrink geometrically (by 2/3) towards the bottom, so at most about 3k items are retained. With k = 200 the
+ * rank error on a million values is about 0.5%.
+ */
+class QuantileSketch {
+public:
+    /**
+     * @brief Constructs a new QuantileSketch object.
+     * @param k Accuracy parameter (capacity of the top compactor).
+     */
+    explicit QuantileSketch(int k = 200);
+
+    /**
+     * @brief Adds one value.
+     * @param value Value to add.
+     */
+    void add(double value);
+
+    /**
+     * @brief Merges another sketch into this one.
+     * @param other Sketch to merge (its k is ignored; this sketch keeps its own).
+     */
+    void merge(const QuantileSketch &other);
+
+    /**
+     * @brief Estimates the percentile rank of a value.
+     *
+     * Ties count half, so the median of a stream of identical values is 50.
+     *
+     * @param value Value to rank.
+     * @return double Percentage of the stream below the value, in [0, 100] (0 for an empty sketch).
+     */
+    double percentileRank(double value) const;
+
+    /**
+     * @brief Estimates a quantile.
+     * @param fraction Quantile in [0, 1].
+     * @return double The estimated value (0 for an empty sketch).
+     */
+    double quantile(double fraction) const;
+
+    /** @return long long Number of values added (including merged sketches). */
+    long long count() const { return n; }
+
+    /** @return bool True if no values have been added. */
+    bool empty() const { return n == 0; }
+
+    /** @return double Smallest value added. */
+    double min() const { return minValue; }
+
+    /** @return double Largest value added. */
+    double max() const { return maxValue; }
+
+    /** @return std::size_t Number of retained items. */
+    std::size_t retained() const { return retainedItems; }
+
+    /**
+     * @brief Writes the sketch as a "sketch" line followed by one "level" line per compactor.
+     * @param out Output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads a sketch previously produced by write().
+     * @param in Input stream positioned at the "sketch" line.
+     * @return bool False if the data is malformed.
+     */
+    bool read(std::istream &in);
+
+private:
+    int k;                                      /**< Accuracy parameter. */
+    long long n = 0;                            /**< Total weight (values added). */
+    double minValue = 0.0;                      /**< Exact minimum. */
+    double maxValue = 0.0;                      /**< Exact maximum. */
+    std::vector<std::vector<double>> levels;    /**< Compactors; level h holds items of weight 2^h. */
+    std::size_t retainedItems = 0;              /**< Items across all levels. */
+    std::uint32_t coin = 0x9E3779B9u;           /**< State of the xorshift coin that picks compaction offsets. */
+
+    mutable std::vector<double> viewValues;     /**< Retained items sorted ascending. */
+    mutable std::vector<long long> viewWeights; /**< Cumulative weight up to and including each sorted item. */
+    mutable bool viewValid = false;             /**< False when the sorted view must be rebuilt. */
+
+    /**
+     * @brief Gets the capacity of a level.
+     * @param level Level index.
+     * @return std::size_t Capacity.
+     */
+    std::size_t capacity(std::size_t level) const;
+
+    /**
+     * @brief Gets the sum of all level capacities.
+     * @return std::size_t Total capacity.
+     */
+    std::size_t totalCapacity() const;
+
+    /**
+     * @brief Compacts the lowest full level.
+     */
+    void compress();
+
+    /**
+     * @brief Rebuilds the sorted view used by rank and quantile queries.
+     */
+    void buildView() const;
+};
+
+#endif // QUANTILESKETCH_H
@@ -0,0 +1,465 @@
+/**
+ * @file ReadingBatchParser.cpp
+ * @brief Implements in-place parsing of JSON and CSV reading batches.
+ */
+
+#include "ReadingBatchParser.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const double kMaxBpm = 300.0;   // Anything above is a sensor fault, not a heart rate.
+const int kMaxJsonDepth = 32;   // Nesting allowed inside ignored members.
+
+/**
+ * @brief Skips JSON whitespace.
+ * @param p Cursor.
+ * @param end End of input.
+ */
+void skipSpace(const char *&p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+}
+
+/**
+ * @brief Appends a code point to a sink as UTF-8.
+ * @param code Code point.
+ * @param sink Called with each byte.
+ */
+template <typename Sink>
+void putUtf8(unsigned long code, Sink &sink) {
+    if (code < 0x80) {
+        sink(static_cast<char>(code));
+    } else if (code < 0x800) {
+        sink(static_cast<char>(0xC0 | (code >> 6)));
+        sink(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        sink(static_cast<char>(0xE0 | (code >> 12)));
+        sink(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        sink(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        sink(static_cast<char>(0xF0 | (code >> 18)));
+        sink(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        sink(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        sink(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+/**
+ * @brief Reads four hex digits.
+ * @param p Cursor (advanced past the digits).
+ * @param end End of input.
+ * @param[out] value The value.
+ * @return bool False if fewer than four hex digits follow.
+ */
+bool readHex4(const char *&p, const char *end, unsigned long &value) {
+    if (end - p < 4) return false;
+    value = 0;
+    for (int i = 0; i < 4; ++i, ++p) {
+        char c = *p;
+        int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (digit < 0) return false;
+        value = value * 16 + static_cast<unsigned long>(digit);
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a JSON string, decoding escapes into a sink.
+ * @param p Cursor at the opening quote (advanced past the closing quote).
+ * @param end End of input.
+ * @param sink Called with each decoded byte.
+ * @return bool False if the string is malformed.
+ */
+template <typename Sink>
+bool readString(const char *&p, const char *end, Sink &&sink) {
+    if (p >= end || *p != '"') return false;
+    ++p;
+    while (p < end) {
+        char c = *p++;
+        if (c == '"') return true;
+        if (static_cast<unsigned char>(c) < 0x20) return false;
+        if (c != '\\') {
+            sink(c);
+            continue;
+        }
+        if (p >= end) return false;
+        char escape = *p++;
+        switch (escape) {
+        case '"': sink('"'); break;
+        case '\\': sink('\\'); break;
+        case '/': sink('/'); break;
+        case 'b': sink('\b'); break;
+        case 'f': sink('\f'); break;
+        case 'n': sink('\n'); break;
+        case 'r': sink('\r'); break;
+        case 't': sink('\t'); break;
+        case 'u': {
+            unsigned long code = 0;
+            if (!readHex4(p, end, code)) return false;
+            if (code >= 0xD800 && code < 0xDC00) {
+                unsigned long low = 0;
+                if (end - p < 2 || p[0] != '\\' || p[1] != 'u') return false;
+                p += 2;
+                if (!readHex4(p, end, low) || low < 0xDC00 || low >= 0xE000) return false;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            } else if (code >= 0xDC00 && code < 0xE000) {
+                return false;
+            }
+            putUtf8(code, sink);
+            break;
+        }
+        default: return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Skips any JSON value.
+ * @param p Cursor at the value.
+ * @param end End of input.
+ * @param depth Current nesting depth.
+ * @return bool False if the value is malformed or nested too deeply.
+ */
+bool skipValue(const char *&p, const char *end, int depth) {
+    skipSpace(p, end);
+    if (p >= end) return false;
+    if (*p == '"') return readString(p, end, [](char) {});
+    if (*p == '{' || *p == '[') {
+        if (depth >= kMaxJsonDepth) return false;
+        const char close = *p == '{' ? '}' : ']';
+        const bool object = *p == '{';
+        ++p;
+        skipSpace(p, end);
+        if (p < end && *p == close) {
+            ++p;
+            return true;
+        }
+        while (true) {
+            if (object) {
+                skipSpace(p, end);
+                if (!readString(p, end, [](char) {})) return false;
+                skipSpace(p, end);
+                if (p >= end || *p++ != ':') return false;
+            }
+            if (!skipValue(p, end, depth + 1)) return false;
+            skipSpace(p, end);
+            if (p >= end) return false;
+            if (*p == ',') {
+                ++p;
+                continue;
+            }
+            if (*p++ != close) return false;
+            return true;
+        }
+    }
+    for (const char *literal : {"true", "false", "null"}) {
+        std::size_t length = std::strlen(literal);
+        if (static_cast<std::size_t>(end - p) >= length && std::memcmp(p, literal, length) == 0) {
+            p += length;
+            return true;
+        }
+    }
+    double ignored = 0.0;
+    std::from_chars_result result = std::from_chars(p, end, ignored);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+/**
+ * @brief Reads a number.
+ * @param p Cursor (advanced past the number).
+ * @param end End of input.
+ * @param[out] value The number.
+ * @return bool False if no number follows.
+ */
+bool readNumber(const char *&p, const char *end, double &value) {
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc() || !std::isfinite(value)) return false;
+    p = result.ptr;
+    return true;
+}
+
+/**
+ * @brief Reads a timestamp, truncating any fractional seconds.
+ * @param p Cursor (advanced past the number).
+ * @param end End of input.
+ * @param[out] value Seconds since epoch.
+ * @return bool False if no number follows.
+ */
+bool readTimestamp(const char *&p, const char *end, long long &value) {
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec == std::errc() && (result.ptr == end || (*result.ptr != '.' && *result.ptr != 'e' &&
+                                                           *result.ptr != 'E'))) {
+        p = result.ptr;
+        return true;
+    }
+    double seconds = 0.0;
+    if (!readNumber(p, end, seconds) || std::fabs(seconds) > 9e15) return false;
+    value = static_cast<long long>(std::floor(seconds));
+    return true;
+}
+
+/**
+ * @brief Finds the end of a CSV field, trimming spaces, tabs and carriage returns.
+ * @param[in,out] begin Field start (advanced past leading blanks).
+ * @param[in,out] end Field end (moved before trailing blanks).
+ */
+void trimField(const char *&begin, const char *&end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+}
+
+} // namespace
+
+/**
+ * @brief Guesses the format from the first non-blank character.
+ * @param data Body.
+ * @param size Body length.
+ * @return Format The guessed format.
+ */
+ReadingBatchParser::Format ReadingBatchParser::sniff(const char *data, std::size_t size) {
+    const char *p = data;
+    skipSpace(p, data + size);
+    return p < data + size && (*p == '[' || *p == '{') ? Json : Csv;
+}
+
+/**
+ * @brief Parses a batch, replacing the previous one.
+ * @param data Body.
+ * @param size Body length.
+ * @param format Body format.
+ * @return bool False if the body is malformed.
+ */
+bool ReadingBatchParser::parse(const char *data, std::size_t size, Format format) {
+    used = 0;
+    message.clear();
+    bool ok = format == Json ? parseJson(data, data + size) : parseCsv(data, data + size);
+    if (!ok) used = 0;
+    return ok;
+}
+
+/**
+ * @brief Gets the next free slot.
+ * @return HeartRateReading& The slot.
+ */
+HeartRateReading &ReadingBatchParser::nextSlot() {
+    if (used == slots.size()) slots.emplace_back();
+    HeartRateReading &slot = slots[used++];
+    slot.spo2 = -1.0;
+    return slot;
+}
+
+/**
+ * @brief Records a parse error.
+ * @param text Message.
+ * @param index Reading position the error belongs to.
+ * @return bool Always false.
+ */
+bool ReadingBatchParser::fail(const std::string &text, std::size_t index) {
+    message = "reading " + std::to_string(index + 1) + ": " + text;
+    return false;
+}
+
+/**
+ * @brief Checks a parsed reading's fields.
+ * @param reading The reading.
+ * @param index Its position in the batch.
+ * @return bool False if a field is out of range.
+ */
+bool ReadingBatchParser::validate(const HeartRateReading &reading, std::size_t index) {
+    if (reading.user.empty()) return fail("missing user", index);
+    // Commas and control characters would split or break the userdata.csv row.
+    for (char c : reading.user)
+        if (c == ',' || static_cast<unsigned char>(c) < 0x20)
+            return fail("user contains a comma or control character", index);
+    if (reading.timestamp <= 0) return fail("timestamp must be positive", index);
+    if (!(reading.bpm > 0.0 && reading.bpm <= kMaxBpm)) return fail("bpm out of range", index);
+    if (reading.spo2 > 100.0) return fail("spo2 out of range", index);
+    return true;
+}
+
+/**
+ * @brief Parses a JSON body.
+ * @param p Start of the body.
+ * @param end End of the body.
+ * @return bool False if malformed.
+ */
+bool ReadingBatchParser::parseJson(const char *p, const char *end) {
+    skipSpace(p, end);
+    bool wrapped = p < end && *p == '{';
+    if (wrapped) {
+        // {"readings": [...]}: other members are skipped until the array is found.
+        ++p;
+        bool found = false;
+        while (!found) {
+            skipSpace(p, end);
+            char key[16];
+            std::size_t length = 0;
+            if (!readString(p, end, [&](char c) { if (length < sizeof(key)) key[length] = c; ++length; }))
+                return fail("expected a member name", 0);
+            skipSpace(p, end);
+            if (p >= end || *p++ != ':') return fail("expected ':'", 0);
+            skipSpace(p, end);
+            if (length == 8 && std::memcmp(key, "readings", 8) == 0) {
+                found = true;
+                break;
+            }
+            if (!skipValue(p, end, 1)) return fail("malformed value", 0);
+            skipSpace(p, end);
+            if (p >= end || *p++ != ',') return fail("expected a \"readings\" array", 0);
+        }
+    }
+    if (p >= end || *p++ != '[') return fail("expected an array of readings", 0);
+
+    skipSpace(p, end);
+    bool empty = p < end && *p == ']';
+    if (empty) ++p;
+    while (!empty) {
+        const std::size_t index = used;
+        skipSpace(p, end);
+        if (p >= end || *p++ != '{') return fail("expected an object", index);
+        HeartRateReading &reading = nextSlot();
+        reading.user.clear();
+        bool hasUser = false, hasTimestamp = false, hasBpm = false;
+        skipSpace(p, end);
+        bool emptyObject = p < end && *p == '}';
+        if (emptyObject) ++p;
+        while (!emptyObject) {
+            skipSpace(p, end);
+            char key[16];
+            std::size_t length = 0;
+            if (!readString(p, end, [&](char c) { if (length < sizeof(key)) key[length] = c; ++length; }))
+                return fail("expected a member name", index);
+            skipSpace(p, end);
+            if (p >= end || *p++ != ':') return fail("expected ':'", index);
+            skipSpace(p, end);
+            auto is = [&](const char *name) {
+                return length == std::strlen(name) && std::memcmp(key, name, length) == 0;
+            };
+            if (is("user")) {
+                reading.user.clear();
+                if (!readString(p, end, [&](char c) { reading.user.push_back(c); }))
+                    return fail("user must be a string", index);
+                hasUser = true;
+            } else if (is("timestamp")) {
+                if (!readTimestamp(p, end, reading.timestamp)) return fail("timestamp must be a number", index);
+                hasTimestamp = true;
+            } else if (is("bpm")) {
+                if (!readNumber(p, end, reading.bpm)) return fail("bpm must be a number", index);
+                hasBpm = true;
+            } else if (is("spo2")) {
+                if (end - p >= 4 && std::memcmp(p, "null", 4) == 0) {
+                    p += 4;
+                    reading.spo2 = -1.0;
+                } else if (!readNumber(p, end, reading.spo2)) {
+                    return fail("spo2 must be a number or null", index);
+                }
+            } else if (!skipValue(p, end, 2)) {
+                return fail("malformed value", index);
+            }
+            skipSpace(p, end);
+            if (p >= end) return fail("unterminated object", index);
+            if (*p == ',') {
+                ++p;
+                continue;
+            }
+            if (*p++ != '}') return fail("expected ',' or '}'", index);
+            break;
+        }
+        if (!hasUser || !hasTimestamp || !hasBpm) return fail("user, timestamp and bpm are required", index);
+        if (!validate(reading, index)) return false;
+
+        skipSpace(p, end);
+        if (p >= end) return fail("unterminated array", index);
+        if (*p == ',') {
+            ++p;
+            continue;
+        }
+        if (*p++ != ']') return fail("expected ',' or ']'", index);
+        break;
+    }
+    if (wrapped) {
+        // The rest of the wrapping object is checked for well-formedness but otherwise ignored.
+        while (true) {
+            skipSpace(p, end);
+            if (p < end && *p == '}') {
+                ++p;
+                break;
+            }
+            if (p >= end || *p++ != ',') return fail("expected ',' or '}' after the readings", used);
+            skipSpace(p, end);
+            if (!readString(p, end, [](char) {})) return fail("expected a member name", used);
+            skipSpace(p, end);
+            if (p >= end || *p++ != ':' || !skipValue(p, end, 1)) return fail("malformed value", used);
+        }
+    }
+    skipSpace(p, end);
+    if (p != end) return fail("unexpected data after the readings", used);
+    return true;
+}
+
+/**
+ * @brief Parses a CSV body.
+ * @param p Start of the body.
+ * @param end End of the body.
+ * @return bool False if malformed.
+ */
+bool ReadingBatchParser::parseCsv(const char *p, const char *end) {
+    bool firstRow = true;
+    while (p < end) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (!lineEnd) lineEnd = end;
+        const char *fieldStart[4];
+        const char *fieldEnd[4];
+        int fields = 0;
+        bool blank = true;
+        for (const char *field = p; fields < 5;) {
+            const char *comma =
+                static_cast<const char *>(std::memchr(field, ',', static_cast<std::size_t>(lineEnd - field)));
+            const char *stop = comma ? comma : lineEnd;
+            if (fields < 4) {
+                fieldStart[fields] = field;
+                fieldEnd[fields] = stop;
+                trimField(fieldStart[fields], fieldEnd[fields]);
+                blank = blank && fieldStart[fields] == fieldEnd[fields];
+            }
+            ++fields;
+            if (!comma) break;
+            field = comma + 1;
+        }
+        p = lineEnd + 1;
+        if (blank && fields == 1) continue;
+
+        const std::size_t index = used;
+        if (fields != 3 && fields != 4) return fail("expected user,timestamp,bpm[,spo2]", index);
+        long long timestamp = 0;
+        std::from_chars_result parsed = std::from_chars(fieldStart[1], fieldEnd[1], timestamp);
+        if (parsed.ec != std::errc() || parsed.ptr != fieldEnd[1]) {
+            // A header row is allowed before the first reading.
+            if (firstRow) {
+                firstRow = false;
+                continue;
+            }
+            return fail("timestamp must be an integer", index);
+        }
+        firstRow = false;
+        HeartRateReading &reading = nextSlot();
+        reading.user.assign(fieldStart[0], static_cast<std::size_t>(fieldEnd[0] - fieldStart[0]));
+        reading.timestamp = timestamp;
+        const char *cursor = fieldStart[2];
+        if (!readNumber(cursor, fieldEnd[2], reading.bpm) || cursor != fieldEnd[2])
+            return fail("bpm must be a number", index);
+        if (fields == 4 && fieldStart[3] != fieldEnd[3]) {
+            cursor = fieldStart[3];
+            if (!readNumber(cursor, fieldEnd[3], reading.spo2) || cursor != fieldEnd[3])
+                return fail("spo2 must be a number", index);
+        }
+        if (!validate(reading, index)) return false;
+    }
+    return true;
+}
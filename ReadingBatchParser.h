@@ -0,0 +1,113 @@
+#ifndef READINGBATCHPARSER_H
+#define READINGBATCHPARSER_H
+
+/**
+ * @file ReadingBatchParser.h
+ * @brief Declaration of the parser for batches of readings pushed by sensor gateways.
+ *
+ * This header declares a parser for request bodies that carry many readings at once, either as a JSON array
+ * of objects or as CSV rows in the userdata.csv layout. The parser reuses its reading slots from one batch to
+ * the next, so in steady state a batch is parsed without allocating per reading.
+ */
+
+#include "ReadingStore.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class ReadingBatchParser
+ * @brief Parses JSON or CSV reading batches into reusable HeartRateReading slots.
+ *
+ * JSON bodies are an array of objects, or an object whose "readings" member is that array:
+ *
+ *     [{"user": "alice", "timestamp": 1760000000, "bpm": 72.5, "spo2": 98}, ...]
+ *
+ * "user", "timestamp" (seconds since epoch) and "bpm" are required; "spo2" is optional and may be null;
+ * other members are ignored. CSV bodies hold "user,timestamp,bpm[,spo2]" rows, optionally after a header row.
+ *
+ * A batch is all or nothing: the first malformed or out-of-range reading fails the whole parse, so a
+ * gateway never has half a batch stored. Numbers are read in place with std::from_chars and usernames are
+ * assigned into strings whose capacity survives between batches.
+ */
+class ReadingBatchParser {
+public:
+    /**
+     * @brief Body formats.
+     */
+    enum Format {
+        Json = 0,
+        Csv
+    };
+
+    /**
+     * @brief Guesses the format from the first non-blank character ('[' or '{' means JSON).
+     * @param data Body.
+     * @param size Body length.
+     * @return Format The guessed format.
+     */
+    static Format sniff(const char *data, std::size_t size);
+
+    /**
+     * @brief Parses a batch, replacing the previous one.
+     * @param data Body.
+     * @param size Body length.
+     * @param format Body format.
+     * @return bool False if the body is malformed (see error()); count() is then 0.
+     */
+    bool parse(const char *data, std::size_t size, Format format);
+
+    /** @return const HeartRateReading* The parsed readings. */
+    const HeartRateReading *readings() const { return slots.data(); }
+
+    /** @return std::size_t Number of parsed readings. */
+    std::size_t count() const { return used; }
+
+    /** @return const std::string& Why the last parse failed (empty after a success). */
+    const std::string &error() const { return message; }
+
+private:
+    std::vector<HeartRateReading> slots;    /**< Reading slots, kept between batches. */
+    std::size_t used = 0;                   /**< Slots filled by the last parse. */
+    std::string message;                    /**< Last error. */
+
+    /**
+     * @brief Gets the next free slot, growing the slot array only past its high-water mark.
+     * @return HeartRateReading& The slot.
+     */
+    HeartRateReading &nextSlot();
+
+    /**
+     * @brief Parses a JSON body.
+     * @param p Start of the body.
+     * @param end End of the body.
+     * @return bool False if malformed.
+     */
+    bool parseJson(const char *p, const char *end);
+
+    /**
+     * @brief Parses a CSV body.
+     * @param p Start of the body.
+     * @param end End of the body.
+     * @return bool False if malformed.
+     */
+    bool parseCsv(const char *p, const char *end);
+
+    /**
+     * @brief Checks a parsed reading's fields.
+     * @param reading The reading.
+     * @param index Its position in the batch (for the error message).
+     * @return bool False if a field is out of range.
+     */
+    bool validate(const HeartRateReading &reading, std::size_t index);
+
+    /**
+     * @brief Records a parse error.
+     * @param text Message.
+     * @param index Reading position the error belongs to.
+     * @return bool Always false.
+     */
+    bool fail(const std::string &text, std::size_t index);
+};
+
+#endif // READINGBATCHPARSER_H
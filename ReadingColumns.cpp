@@ -0,0 +1,201 @@
+/**
+ * @file ReadingColumns.cpp
+ * @brief Implements the columnar reading store and its binary file format.
+ *
+ * The file starts with "HPRC", a version and the CSV offset, followed by the user dictionary and the four
+ * columns as raw arrays. Block statistics are not stored; read() recomputes them in one pass.
+ */
+
+#include "ReadingColumns.h"
+#include "ReadingStore.h"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace {
+
+const char kColumnsMagic[4] = { 'H', 'P', 'R', 'C' };
+const std::uint32_t kColumnsVersion = 1;
+
+/**
+ * @brief Writes a column as a length-prefixed raw array.
+ * @param out Output stream.
+ * @param column Column.
+ */
+template <typename T>
+void writeColumn(std::ostream &out, const std::vector<T> &column) {
+    std::uint64_t count = column.size();
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(column.data()), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+/**
+ * @brief Reads a column written by writeColumn().
+ * @param in Input stream.
+ * @param[out] column Column.
+ * @return bool False if the stream is short.
+ */
+template <typename T>
+bool readColumn(std::istream &in, std::vector<T> &column) {
+    std::uint64_t count = 0;
+    in.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if (!in || count > (std::uint64_t(1) << 40)) return false;
+    column.resize(static_cast<std::size_t>(count));
+    in.read(reinterpret_cast<char *>(column.data()), static_cast<std::streamsize>(count * sizeof(T)));
+    return static_cast<bool>(in);
+}
+
+} // namespace
+
+/**
+ * @brief Appends one reading.
+ * @param reading The reading.
+ */
+void ReadingColumns::append(const HeartRateReading &reading) {
+    auto found = ids.find(reading.user);
+    std::uint32_t id;
+    if (found == ids.end()) {
+        id = static_cast<std::uint32_t>(names.size());
+        names.push_back(reading.user);
+        ids.emplace(reading.user, id);
+    } else {
+        id = found->second;
+    }
+    times.push_back(reading.timestamp);
+    users.push_back(id);
+    bpm.push_back(static_cast<float>(reading.bpm));
+    spo2.push_back(reading.spo2 >= 0.0 ? static_cast<float>(reading.spo2) : -1.0f);
+    updateStats(times.size() - 1);
+}
+
+/**
+ * @brief Folds a row into its block's statistics.
+ * @param row Row index (rows must be folded in order).
+ */
+void ReadingColumns::updateStats(std::size_t row) {
+    if (row % kBlockRows == 0) {
+        BlockStats block;
+        block.minTime = block.maxTime = times[row];
+        block.minBpm = block.maxBpm = bpm[row];
+        stats.push_back(block);
+    }
+    BlockStats &block = stats.back();
+    block.minTime = std::min(block.minTime, times[row]);
+    block.maxTime = std::max(block.maxTime, times[row]);
+    block.minBpm = std::min(block.minBpm, bpm[row]);
+    block.maxBpm = std::max(block.maxBpm, bpm[row]);
+    if (stats.size() > 1 && block.minTime < stats[stats.size() - 2].maxTime) timeSorted = false;
+    if (spo2[row] >= 0.0f) {
+        block.minSpo2 = block.spo2Rows == 0 ? spo2[row] : std::min(block.minSpo2, spo2[row]);
+        block.maxSpo2 = block.spo2Rows == 0 ? spo2[row] : std::max(block.maxSpo2, spo2[row]);
+        ++block.spo2Rows;
+    }
+}
+
+/**
+ * @brief Gets the first block whose rows may be at or after a time.
+ * @param time Seconds since epoch.
+ * @return std::size_t Block index.
+ */
+std::size_t ReadingColumns::blocksFrom(long long time) const {
+    if (!timeSorted) return 0;
+    auto first = std::partition_point(stats.begin(), stats.end(),
+                                      [time](const BlockStats &block) { return block.maxTime < time; });
+    return static_cast<std::size_t>(first - stats.begin());
+}
+
+/**
+ * @brief Looks up a user's id.
+ * @param user Username.
+ * @return long long Id, or -1.
+ */
+long long ReadingColumns::userId(const std::string &user) const {
+    auto found = ids.find(user);
+    return found == ids.end() ? -1 : static_cast<long long>(found->second);
+}
+
+/**
+ * @brief Removes every row.
+ */
+void ReadingColumns::clear() {
+    csvOffset = 0;
+    times.clear();
+    users.clear();
+    bpm.clear();
+    spo2.clear();
+    names.clear();
+    ids.clear();
+    stats.clear();
+    timeSorted = true;
+}
+
+/**
+ * @brief Writes the columns in a binary format.
+ * @param out Binary output stream.
+ */
+void ReadingColumns::write(std::ostream &out) const {
+    out.write(kColumnsMagic, sizeof(kColumnsMagic));
+    out.write(reinterpret_cast<const char *>(&kColumnsVersion), sizeof(kColumnsVersion));
+    out.write(reinterpret_cast<const char *>(&csvOffset), sizeof(csvOffset));
+    std::uint32_t userCount = static_cast<std::uint32_t>(names.size());
+    out.write(reinterpret_cast<const char *>(&userCount), sizeof(userCount));
+    for (const std::string &name : names) {
+        std::uint32_t length = static_cast<std::uint32_t>(name.size());
+        out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+        out.write(name.data(), length);
+    }
+    writeColumn(out, times);
+    writeColumn(out, users);
+    writeColumn(out, bpm);
+    writeColumn(out, spo2);
+}
+
+/**
+ * @brief Reads columns previously produced by write() and recomputes the block statistics.
+ * @param in Binary input stream.
+ * @return bool False if the data is malformed.
+ */
+bool ReadingColumns::read(std::istream &in) {
+    clear();
+    char magic[4];
+    std::uint32_t version = 0, userCount = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&csvOffset), sizeof(csvOffset));
+    in.read(reinterpret_cast<char *>(&userCount), sizeof(userCount));
+    bool ok = in && std::memcmp(magic, kColumnsMagic, sizeof(magic)) == 0 && version == kColumnsVersion;
+    for (std::uint32_t id = 0; ok && id < userCount; ++id) {
+        std::uint32_t length = 0;
+        in.read(reinterpret_cast<char *>(&length), sizeof(length));
+        std::string name(length, '\0');
+        if (in && length > 0) in.read(&name[0], length);
+        ok = static_cast<bool>(in) && ids.emplace(name, id).second;
+        names.push_back(name);
+    }
+    ok = ok && readColumn(in, times) && readColumn(in, users) && readColumn(in, bpm) && readColumn(in, spo2) &&
+         users.size() == times.size() && bpm.size() == times.size() && spo2.size() == times.size();
+    for (std::size_t row = 0; ok && row < users.size(); ++row) ok = users[row] < userCount;
+    if (!ok) {
+        clear();
+        return false;
+    }
+
+    for (std::size_t row = 0; row < times.size(); ++row) updateStats(row);
+    return true;
+}
+
+/**
+ * @brief Reads just the CSV offset from the front of a column file.
+ * @param in Binary input stream.
+ * @param[out] offset The file's csvOffset.
+ * @return bool False if the stream does not hold a column file of this version.
+ */
+bool ReadingColumns::readCsvOffset(std::istream &in, std::uint64_t &offset) {
+    char magic[4];
+    std::uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&offset), sizeof(offset));
+    return in && std::memcmp(magic, kColumnsMagic, sizeof(magic)) == 0 && version == kColumnsVersion;
+}
@@ -0,0 +1,143 @@
+#ifndef READINGCOLUMNS_H
+#define READINGCOLUMNS_H
+
+/**
+ * @file ReadingColumns.h
+ * @brief Declaration of the columnar copy of userdata.csv used by the reading query engine.
+ *
+ * This header declares a column-per-field copy of every heart-rate reading, split into fixed-size blocks that
+ * each carry min/max statistics (a zone map). Queries skip blocks whose statistics rule them out and run
+ * tight per-column loops over the rest instead of parsing CSV rows.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct HeartRateReading;
+
+/**
+ * @class ReadingColumns
+ * @brief Readings stored as parallel columns in blocks of kBlockRows rows, with per-block statistics.
+ *
+ * Users are dictionary-encoded as 32-bit ids. Rows keep CSV order; because readings are appended in time
+ * order the blocks are normally sorted by time, which isTimeSorted() reports and blocksFrom() exploits
+ * with a binary search.
+ */
+class ReadingColumns {
+public:
+    static const std::size_t kBlockRows = 4096;    /**< Rows per block. */
+
+    /**
+     * @brief Min/max statistics of one block.
+     */
+    struct BlockStats {
+        long long minTime = 0;          /**< Earliest timestamp. */
+        long long maxTime = 0;          /**< Latest timestamp. */
+        float minBpm = 0.0f;            /**< Smallest BPM. */
+        float maxBpm = 0.0f;            /**< Largest BPM. */
+        float minSpo2 = 0.0f;           /**< Smallest SpO2 among rows that have one. */
+        float maxSpo2 = 0.0f;           /**< Largest SpO2 among rows that have one. */
+        std::uint32_t spo2Rows = 0;     /**< Rows with an SpO2 value. */
+    };
+
+    std::uint64_t csvOffset = 0;        /**< Bytes of userdata.csv already folded in. */
+
+    /**
+     * @brief Appends one reading.
+     * @param reading The reading.
+     */
+    void append(const HeartRateReading &reading);
+
+    /** @return std::size_t Number of rows. */
+    std::size_t size() const { return times.size(); }
+
+    /** @return std::size_t Number of blocks (the last one may be partial). */
+    std::size_t blockCount() const { return stats.size(); }
+
+    /**
+     * @brief Gets a block's statistics.
+     * @param block Block index.
+     * @return const BlockStats& Statistics.
+     */
+    const BlockStats& blockStats(std::size_t block) const { return stats[block]; }
+
+    /**
+     * @brief Gets the first block whose rows may be at or after a time.
+     * @param time Seconds since epoch.
+     * @return std::size_t Block index (0 unless the blocks are time-sorted).
+     */
+    std::size_t blocksFrom(long long time) const;
+
+    /** @return bool True if every block's rows are no earlier than the previous block's. */
+    bool isTimeSorted() const { return timeSorted; }
+
+    /** @return const std::vector<long long>& Timestamp column. */
+    const std::vector<long long>& timeColumn() const { return times; }
+
+    /** @return const std::vector<std::uint32_t>& User id column. */
+    const std::vector<std::uint32_t>& userColumn() const { return users; }
+
+    /** @return const std::vector<float>& BPM column. */
+    const std::vector<float>& bpmColumn() const { return bpm; }
+
+    /** @return const std::vector<float>& SpO2 column (negative where the row has none). */
+    const std::vector<float>& spo2Column() const { return spo2; }
+
+    /** @return const std::vector<std::string>& User name per id. */
+    const std::vector<std::string>& userNames() const { return names; }
+
+    /**
+     * @brief Looks up a user's id.
+     * @param user Username.
+     * @return long long Id, or -1 if the user has no readings.
+     */
+    long long userId(const std::string &user) const;
+
+    /**
+     * @brief Removes every row.
+     */
+    void clear();
+
+    /**
+     * @brief Writes the columns in a binary format.
+     * @param out Binary output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads columns previously produced by write() and recomputes the block statistics.
+     * @param in Binary input stream.
+     * @return bool False if the data is malformed.
+     */
+    bool read(std::istream &in);
+
+    /**
+     * @brief Reads just the CSV offset from the front of a column file.
+     * @param in Binary input stream positioned at the start of the file.
+     * @param[out] offset The file's csvOffset.
+     * @return bool False if the stream does not hold a column file of this version.
+     */
+    static bool readCsvOffset(std::istream &in, std::uint64_t &offset);
+
+private:
+    std::vector<long long> times;                       /**< Timestamp per row. */
+    std::vector<std::uint32_t> users;                   /**< User id per row. */
+    std::vector<float> bpm;                             /**< BPM per row. */
+    std::vector<float> spo2;                            /**< SpO2 per row (negative if none). */
+    std::vector<std::string> names;                     /**< User name per id. */
+    std::unordered_map<std::string, std::uint32_t> ids; /**< Id per user name. */
+    std::vector<BlockStats> stats;                      /**< Statistics per block. */
+    bool timeSorted = true;                             /**< Blocks are in time order. */
+
+    /**
+     * @brief Folds a row into its block's statistics.
+     * @param row Row index (rows must be folded in order).
+     */
+    void updateStats(std::size_t row);
+};
+
+#endif // READINGCOLUMNS_H
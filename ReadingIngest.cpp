@@ -0,0 +1,178 @@
+/**
+ * @file ReadingIngest.cpp
+ * @brief Implements the reading batch ingest endpoint.
+ */
+
+#include "ReadingIngest.h"
+#include <string>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Writes a JSON error body.
+ * @param response Response to fill in.
+ * @param status Status code.
+ * @param text Message (quotes and backslashes are escaped, control characters dropped).
+ */
+void setError(HttpResponse &response, int status, const std::string &text) {
+    response.status = status;
+    response.body = "{\"error\":\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') response.body += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) response.body += c;
+    }
+    response.body += "\"}";
+}
+
+} // namespace
+
+/**
+ * @brief Constructs the service.
+ * @param store Store that receives the readings.
+ * @param maxQueuedBatches Batches that may wait for the writer.
+ */
+ReadingIngest::ReadingIngest(ReadingStore &store, std::size_t maxQueuedBatches)
+    : store(store), maxQueued(maxQueuedBatches) {}
+
+/**
+ * @brief Stores the queued batches and stops the writer thread.
+ */
+ReadingIngest::~ReadingIngest() {
+    finish();
+}
+
+/**
+ * @brief Registers the ingest and statistics routes on a server and starts the writer thread.
+ * @param server Server to register with.
+ */
+void ReadingIngest::attach(HttpServer &server) {
+    this->server = &server;
+    server.route("POST", "/readings", [this](const HttpRequest &request, HttpResponse &response) {
+        handle(request, response);
+    });
+    server.route("GET", "/readings/stats", [this](const HttpRequest &, HttpResponse &response) {
+        std::size_t queued;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued = queue.size();
+        }
+        response.body = "{\"batches\":" + std::to_string(batches) + ",\"readings\":" + std::to_string(readings) +
+                        ",\"rejected\":" + std::to_string(rejected) + ",\"busy\":" + std::to_string(busy) +
+                        ",\"queued\":" + std::to_string(queued) + "}";
+    });
+    if (!writer.joinable()) writer = std::thread(&ReadingIngest::writeBatches, this);
+}
+
+/**
+ * @brief Stores the queued batches and stops the writer thread.
+ */
+void ReadingIngest::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishing = true;
+    }
+    wake.notify_all();
+    if (writer.joinable()) writer.join();
+}
+
+/**
+ * @brief Parses a batch and appends it to the store.
+ * @param request The request.
+ * @param response Filled in with the outcome.
+ */
+void ReadingIngest::handle(const HttpRequest &request, HttpResponse &response) {
+    ReadingBatchParser::Format format;
+    if (request.contentType == "application/json")
+        format = ReadingBatchParser::Json;
+    else if (request.contentType == "text/csv")
+        format = ReadingBatchParser::Csv;
+    else
+        format = ReadingBatchParser::sniff(request.body, request.bodySize);
+
+    if (!parser.parse(request.body, request.bodySize, format)) {
+        ++rejected;
+        setError(response, 400, parser.error());
+        return;
+    }
+    if (!server) {
+        if (!store.append(parser.readings(), parser.count())) {
+            ++rejected;
+            setError(response, 500, "readings could not be stored");
+            return;
+        }
+        ++batches;
+        readings += parser.count();
+        response.body = "{\"accepted\":" + std::to_string(parser.count()) + "}";
+        return;
+    }
+
+    // Only this thread adds to the queue, so the room checked here is still there below.
+    std::vector<HeartRateReading> rows;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finishing || queue.size() >= maxQueued) {
+            ++busy;
+            setError(response, 503, "ingest is behind; retry later");
+            return;
+        }
+        if (!spare.empty()) {
+            rows.swap(spare.back());
+            spare.pop_back();
+        }
+    }
+    rows.assign(parser.readings(), parser.readings() + parser.count());
+    HttpServer::Deferred ticket = server->defer();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(Batch{std::move(rows), ticket});
+    }
+    wake.notify_one();
+}
+
+/**
+ * @brief Writer thread: appends queued batches until finish() is called and the queue is empty.
+ *
+ * Everything queued while the previous append ran is taken at once and written with one append() call;
+ * each batch is then answered with the outcome of that write.
+ */
+void ReadingIngest::writeBatches() {
+    std::vector<Batch> taken;
+    std::vector<HeartRateReading> merged;
+    HttpResponse response;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return finishing || !queue.empty(); });
+        if (queue.empty()) return;
+        taken.swap(queue);
+        lock.unlock();
+
+        bool stored;
+        if (taken.size() == 1) {
+            stored = store.append(taken[0].readings);
+        } else {
+            merged.clear();
+            for (const Batch &batch : taken) merged.insert(merged.end(), batch.readings.begin(), batch.readings.end());
+            stored = store.append(merged);
+        }
+        for (const Batch &batch : taken) {
+            response.status = 200;
+            if (stored) {
+                ++batches;
+                readings += batch.readings.size();
+                response.body = "{\"accepted\":" + std::to_string(batch.readings.size()) + "}";
+            } else {
+                ++rejected;
+                setError(response, 500, "readings could not be stored");
+            }
+            server->complete(batch.ticket, response);
+        }
+
+        lock.lock();
+        for (Batch &batch : taken) {
+            batch.readings.clear();
+            spare.push_back(std::move(batch.readings));
+        }
+        taken.clear();
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef READINGINGEST_H
+#define READINGINGEST_H
+
+/**
+ * @file ReadingIngest.h
+ * @brief Declaration of the HTTP endpoint through which sensor gateways push reading batches.
+ *
+ * This header declares the service behind "POST /readings": it parses a JSON or CSV body with a
+ * ReadingBatchParser and hands the whole batch to ReadingStore::append() on a writer thread, so gateways can
+ * store readings without going through the GUI and the HTTP loop keeps serving while the CSV is written.
+ */
+
+#include "HttpServer.h"
+#include "ReadingBatchParser.h"
+#include "ReadingStore.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ReadingIngest
+ * @brief Accepts reading batches over HTTP and appends them to a ReadingStore.
+ *
+ * The body format follows the Content-Type ("application/json" or "text/csv"); any other type is sniffed
+ * from the first character. Responses are JSON:
+ *
+ *     200 {"accepted": N}          the batch was stored
+ *     400 {"error": "..."}         the body is malformed; nothing was stored
+ *     500 {"error": "..."}         the CSV could not be written; nothing was stored
+ *     503 {"error": "..."}         the writer has fallen behind; nothing was stored, retry later
+ *
+ * Parsing happens on the HTTP thread. The parsed batch is queued for a writer thread and the response is
+ * deferred until the batch is on disk, so a 200 still means stored. Batches that queue up while an append
+ * runs go to userdata.csv together in one write, and a batch is never split. When the queue is full, new
+ * batches are turned away with 503 instead of stalling every connection behind the disk.
+ */
+class ReadingIngest {
+public:
+    /**
+     * @brief Constructs the service.
+     * @param store Store that receives the readings; it must outlive the service.
+     * @param maxQueuedBatches Batches that may wait for the writer before new ones get 503.
+     */
+    explicit ReadingIngest(ReadingStore &store, std::size_t maxQueuedBatches = 64);
+
+    /**
+     * @brief Stores the queued batches and stops the writer thread.
+     */
+    ~ReadingIngest();
+
+    ReadingIngest(const ReadingIngest &) = delete;
+    ReadingIngest &operator=(const ReadingIngest &) = delete;
+
+    /**
+     * @brief Registers "POST /readings" and "GET /readings/stats" on a server and starts the writer thread.
+     * @param server Server to register with; it must outlive the service.
+     */
+    void attach(HttpServer &server);
+
+    /**
+     * @brief Handles one ingest request.
+     *
+     * Once attached, the response is deferred until the writer has stored the batch. Without a server the
+     * batch is stored before this returns.
+     *
+     * @param request The request.
+     * @param response Filled in with the outcome.
+     */
+    void handle(const HttpRequest &request, HttpResponse &response);
+
+    /**
+     * @brief Stores the queued batches and stops the writer thread; later batches get 503.
+     */
+    void finish();
+
+    /** @return std::uint64_t Batches stored. */
+    std::uint64_t batchesAccepted() const { return batches; }
+
+    /** @return std::uint64_t Readings stored. */
+    std::uint64_t readingsAccepted() const { return readings; }
+
+    /** @return std::uint64_t Batches rejected as malformed or unwritable. */
+    std::uint64_t batchesRejected() const { return rejected; }
+
+    /** @return std::uint64_t Batches turned away with 503 because the writer had fallen behind. */
+    std::uint64_t batchesBusy() const { return busy; }
+
+private:
+    /**
+     * @brief A parsed batch waiting for the writer.
+     */
+    struct Batch {
+        std::vector<HeartRateReading> readings;     /**< The readings. */
+        HttpServer::Deferred ticket;                /**< Request to answer once they are stored. */
+    };
+
+    ReadingStore &store;                            /**< Destination store. */
+    ReadingBatchParser parser;                      /**< Parser, reused across batches. */
+    HttpServer *server = nullptr;                   /**< Server the responses go to, once attached. */
+    std::size_t maxQueued;                          /**< Queue limit. */
+    std::mutex mutex;                               /**< Guards queue, spare and finishing. */
+    std::condition_variable wake;                   /**< Signals the writer. */
+    std::vector<Batch> queue;                       /**< Batches waiting for the writer, oldest first. */
+    std::vector<std::vector<HeartRateReading>> spare;   /**< Emptied reading vectors, reused by new batches. */
+    bool finishing = false;                         /**< finish() was called. */
+    std::thread writer;                             /**< Writer thread, started by attach(). */
+    std::atomic<std::uint64_t> batches{0};          /**< Batches stored. */
+    std::atomic<std::uint64_t> readings{0};         /**< Readings stored. */
+    std::atomic<std::uint64_t> rejected{0};         /**< Batches rejected. */
+    std::atomic<std::uint64_t> busy{0};             /**< Batches turned away while the queue was full. */
+
+    /**
+     * @brief Writer thread: appends queued batches until finish() is called and the queue is empty.
+     */
+    void writeBatches();
+};
+
+#endif // READINGINGEST_H
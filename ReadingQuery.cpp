@@ -0,0 +1,657 @@
+/**
+ * @file ReadingQuery.cpp
+ * @brief Implements the reading query parser, the vectorized column scan and the rollup executor.
+ */
+
+#include "ReadingQuery.h"
+#include "HeartRateRollup.h"
+#include "ReadingColumns.h"
+#include "ReadingStore.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+// Rough relative costs of the work each plan does: parsing text is far slower than reading raw arrays.
+const double kTextByteCost = 8.0;       /**< Per byte of summary or CSV text parsed. */
+const double kColumnByteCost = 0.5;     /**< Per byte of the binary column file read. */
+const double kRowCost = 1.0;            /**< Per row the column scan touches. */
+const double kColumnRowBytes = 20.0;    /**< Column file bytes per row (time, user, BPM, SpO2). */
+
+/**
+ * @brief One lexical token.
+ */
+struct Token {
+    enum Kind { End, Word, Number, String, Symbol } kind = End;
+    std::string text;       /**< Lower-cased word, symbol, string contents or number digits. */
+    double number = 0.0;    /**< Numeric value. */
+    std::string unit;       /**< Unit letters directly after a number (e.g. "d" in 7d). */
+};
+
+/**
+ * @brief Splits query text into tokens.
+ * @param text Query text.
+ * @param[out] tokens Tokens followed by an End token.
+ * @param[out] error Description of the first lexical error.
+ * @return bool False on a lexical error.
+ */
+bool tokenize(const std::string &text, std::vector<Token> &tokens, std::string &error) {
+    std::size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (std::isspace(c)) {
+            ++i;
+            continue;
+        }
+        Token token;
+        if (std::isalpha(c) || c == '_') {
+            token.kind = Token::Word;
+            while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_'))
+                token.text += static_cast<char>(std::tolower(static_cast<unsigned char>(text[i++])));
+        } else if (std::isdigit(c) || (c == '.' && i + 1 < text.size() && std::isdigit(text[i + 1]))) {
+            token.kind = Token::Number;
+            while (i < text.size() && (std::isdigit(static_cast<unsigned char>(text[i])) || text[i] == '.'))
+                token.text += text[i++];
+            token.number = std::strtod(token.text.c_str(), nullptr);
+            while (i < text.size() && std::isalpha(static_cast<unsigned char>(text[i])))
+                token.unit += static_cast<char>(std::tolower(static_cast<unsigned char>(text[i++])));
+        } else if (c == '\'' || c == '"') {
+            token.kind = Token::String;
+            std::size_t close = text.find(static_cast<char>(c), i + 1);
+            if (close == std::string::npos) {
+                error = "unterminated string";
+                return false;
+            }
+            token.text = text.substr(i + 1, close - i - 1);
+            i = close + 1;
+        } else if (c == '<' || c == '>') {
+            token.kind = Token::Symbol;
+            token.text = static_cast<char>(c);
+            if (++i < text.size() && text[i] == '=') token.text += text[i++];
+        } else if (c == '(' || c == ')' || c == ',' || c == '*' || c == '=' || c == '-') {
+            token.kind = Token::Symbol;
+            token.text = static_cast<char>(c);
+            ++i;
+        } else {
+            error = std::string("unexpected character '") + static_cast<char>(c) + "'";
+            return false;
+        }
+        tokens.push_back(token);
+    }
+    tokens.push_back(Token());
+    return true;
+}
+
+/**
+ * @brief Converts a duration unit to seconds.
+ * @param unit "s", "m", "h", "d" or "w" (empty means seconds).
+ * @return long long Seconds per unit, or 0 if unknown.
+ */
+long long unitSeconds(const std::string &unit) {
+    if (unit.empty() || unit == "s") return 1;
+    if (unit == "m" || unit == "min") return 60;
+    if (unit == "h") return 3600;
+    if (unit == "d") return 86400;
+    if (unit == "w") return 7 * 86400;
+    return 0;
+}
+
+/**
+ * @brief Floors a timestamp to a bucket boundary.
+ * @param time Seconds since epoch.
+ * @param width Bucket width in seconds.
+ * @return long long Bucket start.
+ */
+long long floorTo(long long time, long long width) {
+    long long q = time / width;
+    if (time % width != 0 && time < 0) --q;
+    return q * width;
+}
+
+/**
+ * @brief Group identity: user id (0 when not grouped by user) and bucket start (0 when not grouped by time).
+ */
+struct GroupKey {
+    std::uint32_t user = 0;
+    long long bucket = 0;
+
+    bool operator==(const GroupKey &other) const { return user == other.user && bucket == other.bucket; }
+};
+
+/**
+ * @brief Hash of a group key.
+ */
+struct GroupKeyHash {
+    std::size_t operator()(const GroupKey &key) const {
+        return std::hash<long long>()(key.bucket * 0x9E3779B97F4A7C15LL) ^ key.user;
+    }
+};
+
+/**
+ * @brief Formats an aggregate value.
+ * @param value Value.
+ * @param integral True for counts.
+ * @return std::string Text ("-" for an empty group).
+ */
+std::string formatValue(double value, bool integral) {
+    if (std::isnan(value) || std::isinf(value)) return "-";
+    char text[32];
+    std::snprintf(text, sizeof(text), integral ? "%.0f" : "%.2f", value);
+    return text;
+}
+
+/**
+ * @brief Formats a bucket start as a UTC date and time.
+ * @param start Seconds since epoch.
+ * @param width Bucket width in seconds.
+ * @return std::string "YYYY-MM-DD" for days, "YYYY-MM-DD hh:mm" otherwise.
+ */
+std::string formatBucket(long long start, long long width) {
+    std::time_t t = static_cast<std::time_t>(start);
+    std::tm parts = *std::gmtime(&t);
+    char text[32];
+    std::strftime(text, sizeof(text), width >= 86400 ? "%Y-%m-%d" : "%Y-%m-%d %H:%M", &parts);
+    return text;
+}
+
+} // namespace
+
+/**
+ * @brief Running aggregates of one group.
+ */
+struct ReadingQuery::Group {
+    std::uint32_t user = 0;         /**< User id (0 when not grouped by user). */
+    long long bucket = 0;           /**< Time bucket start (0 when not grouped by time). */
+    long long rows = 0;             /**< Matching rows. */
+    double bpmSum = 0.0;            /**< Sum of BPM. */
+    float bpmMin = std::numeric_limits<float>::infinity();      /**< Smallest BPM. */
+    float bpmMax = -std::numeric_limits<float>::infinity();     /**< Largest BPM. */
+    long long spo2Rows = 0;         /**< Matching rows with an SpO2 value. */
+    double spo2Sum = 0.0;           /**< Sum of SpO2. */
+    float spo2Min = std::numeric_limits<float>::infinity();     /**< Smallest SpO2. */
+    float spo2Max = -std::numeric_limits<float>::infinity();    /**< Largest SpO2. */
+};
+
+/**
+ * @brief Parses a query.
+ * @param text Query text.
+ * @param[out] error Description of the first syntax error.
+ * @param now Current time.
+ * @return bool False on a syntax error.
+ */
+bool ReadingQuery::parse(const std::string &text, std::string &error, long long now) {
+    *this = ReadingQuery();
+    std::vector<Token> tokens;
+    if (!tokenize(text, tokens, error)) return false;
+    std::size_t pos = 0;
+    auto peekWord = [&](const char *word) { return tokens[pos].kind == Token::Word && tokens[pos].text == word; };
+    auto peekSymbol = [&](const char *symbol) {
+        return tokens[pos].kind == Token::Symbol && tokens[pos].text == symbol;
+    };
+    auto expectSymbol = [&](const char *symbol) {
+        if (!peekSymbol(symbol)) {
+            error = std::string("expected '") + symbol + "'";
+            return false;
+        }
+        ++pos;
+        return true;
+    };
+    auto parseKey = [&](Key &key) {
+        static const char *names[] = { "user", "minute", "hour", "day" };
+        for (int k = 0; k < 4; ++k) {
+            if (peekWord(names[k])) {
+                key = static_cast<Key>(k);
+                ++pos;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (!peekWord("select")) {
+        error = "query must start with SELECT";
+        return false;
+    }
+    ++pos;
+    do {
+        Item item;
+        static const char *aggregates[] = { "count", "sum", "avg", "min", "max" };
+        if (parseKey(item.key)) {
+            item.isKey = true;
+            item.label = tokens[pos - 1].text;
+        } else {
+            int found = -1;
+            for (int a = 0; a < 5; ++a)
+                if (peekWord(aggregates[a])) found = a;
+            if (found < 0) {
+                error = "expected a group key or an aggregate, found '" + tokens[pos].text + "'";
+                return false;
+            }
+            item.aggregate = static_cast<Aggregate>(found);
+            ++pos;
+            if (!expectSymbol("(")) return false;
+            if (peekSymbol("*") && item.aggregate == Count) {
+                item.field = FieldRows;
+                ++pos;
+            } else if (peekWord("bpm") || peekWord("spo2")) {
+                item.field = peekWord("bpm") ? FieldBpm : FieldSpo2;
+                ++pos;
+            } else {
+                error = "expected bpm or spo2";
+                return false;
+            }
+            if (!expectSymbol(")")) return false;
+            item.label = std::string(aggregates[found]) + "(" +
+                         (item.field == FieldRows ? "*" : item.field == FieldBpm ? "bpm" : "spo2") + ")";
+        }
+        items.push_back(item);
+    } while (peekSymbol(",") && ++pos);
+
+    if (peekWord("where")) {
+        do {
+            ++pos;
+            if (peekWord("user")) {
+                ++pos;
+                if (!expectSymbol("=")) return false;
+                if (tokens[pos].kind != Token::String) {
+                    error = "expected a quoted user name";
+                    return false;
+                }
+                if (!user.empty() && user != tokens[pos].text) impossible = true;
+                user = tokens[pos++].text;
+                continue;
+            }
+            bool isTime = peekWord("time");
+            Range *range = peekWord("bpm") ? &bpm : peekWord("spo2") ? &spo2 : nullptr;
+            if (!isTime && !range) {
+                error = "expected bpm, spo2, user or time in WHERE, found '" + tokens[pos].text + "'";
+                return false;
+            }
+            ++pos;
+            std::string op = tokens[pos].kind == Token::Symbol ? tokens[pos].text : "";
+            if (op != "<" && op != "<=" && op != ">" && op != ">=" && op != "=") {
+                error = "expected a comparison operator";
+                return false;
+            }
+            ++pos;
+            if (isTime) {
+                long long value;
+                if (peekWord("now") || peekWord("today")) {
+                    value = peekWord("now") ? now : floorTo(now, 86400);
+                    ++pos;
+                    if (peekSymbol("-")) {
+                        ++pos;
+                        long long scale = tokens[pos].kind == Token::Number ? unitSeconds(tokens[pos].unit) : 0;
+                        if (scale == 0) {
+                            error = "expected a duration such as 7d";
+                            return false;
+                        }
+                        value -= static_cast<long long>(tokens[pos++].number * scale);
+                    }
+                } else if (tokens[pos].kind == Token::Number && tokens[pos].unit.empty()) {
+                    value = static_cast<long long>(tokens[pos++].number);
+                } else {
+                    error = "expected a time (seconds since epoch, now or today)";
+                    return false;
+                }
+                if (op == ">" || op == ">=" || op == "=") from = std::max(from, op == ">" ? value + 1 : value);
+                if (op == "<" || op == "<=" || op == "=") to = std::min(to, op == "<" ? value - 1 : value);
+            } else {
+                if (tokens[pos].kind != Token::Number || !tokens[pos].unit.empty()) {
+                    error = "expected a number";
+                    return false;
+                }
+                float value = static_cast<float>(tokens[pos++].number);
+                range->active = true;
+                if (op == ">" || op == ">=" || op == "=")
+                    range->low = std::max(range->low, op == ">" ? std::nextafter(value, 1e30f) : value);
+                if (op == "<" || op == "<=" || op == "=")
+                    range->high = std::min(range->high, op == "<" ? std::nextafter(value, -1e30f) : value);
+            }
+        } while (peekWord("and"));
+    }
+    // Rows without an SpO2 value never satisfy an SpO2 predicate.
+    if (spo2.active) spo2.low = std::max(spo2.low, 0.0f);
+    if (bpm.low > bpm.high || spo2.low > spo2.high || from > to) impossible = true;
+
+    bool groupedTime[4] = { false, false, false, false };
+    if (peekWord("group")) {
+        ++pos;
+        if (!peekWord("by")) {
+            error = "expected BY after GROUP";
+            return false;
+        }
+        do {
+            ++pos;
+            Key key;
+            if (!parseKey(key)) {
+                error = "expected user, minute, hour or day after GROUP BY";
+                return false;
+            }
+            if (key == KeyUser) {
+                groupUser = true;
+            } else {
+                if (groupSeconds != 0 && !groupedTime[key]) {
+                    error = "only one time key can be grouped on";
+                    return false;
+                }
+                groupedTime[key] = true;
+                groupSeconds = key == KeyMinute ? 60 : key == KeyHour ? 3600 : 86400;
+            }
+        } while (peekSymbol(","));
+    }
+    for (const Item &item : items) {
+        if (item.isKey && (item.key == KeyUser ? !groupUser : !groupedTime[item.key])) {
+            error = "'" + item.label + "' is selected but not grouped on";
+            return false;
+        }
+    }
+    if (peekWord("limit")) {
+        ++pos;
+        if (tokens[pos].kind != Token::Number) {
+            error = "expected a row count after LIMIT";
+            return false;
+        }
+        limit = static_cast<std::size_t>(tokens[pos++].number);
+    }
+    if (tokens[pos].kind != Token::End) {
+        error = "unexpected '" + tokens[pos].text + "'";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Runs the query as a vectorized scan over the columnar readings.
+ * @param columns Columnar readings.
+ * @return QueryResult Result.
+ */
+QueryResult ReadingQuery::execute(const ReadingColumns &columns) const {
+    QueryResult result;
+    result.plan = "column scan";
+    const std::vector<long long> &times = columns.timeColumn();
+    const std::vector<std::uint32_t> &users = columns.userColumn();
+    const std::vector<float> &bpmColumn = columns.bpmColumn();
+    const std::vector<float> &spo2Column = columns.spo2Column();
+    long long userId = user.empty() ? -1 : columns.userId(user);
+    bool grouped = groupUser || groupSeconds != 0;
+    std::unordered_map<GroupKey, Group, GroupKeyHash> groups;
+    Group total;
+    std::vector<std::uint8_t> mask(ReadingColumns::kBlockRows);
+    const float inf = std::numeric_limits<float>::infinity();
+
+    std::size_t blockCount = columns.blockCount();
+    std::size_t first = impossible || (!user.empty() && userId < 0) ? blockCount : columns.blocksFrom(from);
+    result.blocksSkipped = first;
+    for (std::size_t b = first; b < blockCount; ++b) {
+        const ReadingColumns::BlockStats &stats = columns.blockStats(b);
+        if (columns.isTimeSorted() && stats.minTime > to) {
+            result.blocksSkipped += blockCount - b;
+            break;
+        }
+        bool skip = stats.maxTime < from || stats.minTime > to || stats.maxBpm < bpm.low || stats.minBpm > bpm.high;
+        if (spo2.active)
+            skip = skip || stats.spo2Rows == 0 || stats.maxSpo2 < spo2.low || stats.minSpo2 > spo2.high;
+        if (skip) {
+            ++result.blocksSkipped;
+            continue;
+        }
+        ++result.blocksScanned;
+        std::size_t begin = b * ReadingColumns::kBlockRows;
+        std::size_t n = std::min(ReadingColumns::kBlockRows, times.size() - begin);
+        result.rowsScanned += n;
+        const long long *t = times.data() + begin;
+        const std::uint32_t *u = users.data() + begin;
+        const float *v = bpmColumn.data() + begin;
+        const float *s = spo2Column.data() + begin;
+        std::uint8_t *m = mask.data();
+
+        // One pass per predicate column; a predicate the block statistics already satisfy is not evaluated.
+        bool timeNeeded = stats.minTime < from || stats.maxTime > to;
+        bool bpmNeeded = stats.minBpm < bpm.low || stats.maxBpm > bpm.high;
+        bool spo2Needed = spo2.active && (stats.spo2Rows != n || stats.minSpo2 < spo2.low || stats.maxSpo2 > spo2.high);
+        std::fill(m, m + n, std::uint8_t(1));
+        if (timeNeeded)
+            for (std::size_t i = 0; i < n; ++i) m[i] = (t[i] >= from) & (t[i] <= to);
+        if (bpmNeeded)
+            for (std::size_t i = 0; i < n; ++i) m[i] &= (v[i] >= bpm.low) & (v[i] <= bpm.high);
+        if (spo2Needed)
+            for (std::size_t i = 0; i < n; ++i) m[i] &= (s[i] >= spo2.low) & (s[i] <= spo2.high);
+        if (userId >= 0) {
+            std::uint32_t id = static_cast<std::uint32_t>(userId);
+            for (std::size_t i = 0; i < n; ++i) m[i] &= u[i] == id;
+        }
+
+        if (!grouped) {
+            long long rows = 0, spo2Rows = 0;
+            double bpmSum = 0.0, spo2Sum = 0.0;
+            float bpmMin = inf, bpmMax = -inf, spo2Min = inf, spo2Max = -inf;
+            for (std::size_t i = 0; i < n; ++i) {
+                bool keep = m[i] != 0;
+                rows += keep;
+                bpmSum += keep ? v[i] : 0.0f;
+                bpmMin = std::min(bpmMin, keep ? v[i] : inf);
+                bpmMax = std::max(bpmMax, keep ? v[i] : -inf);
+                bool hasSpo2 = keep && s[i] >= 0.0f;
+                spo2Rows += hasSpo2;
+                spo2Sum += hasSpo2 ? s[i] : 0.0f;
+                spo2Min = std::min(spo2Min, hasSpo2 ? s[i] : inf);
+                spo2Max = std::max(spo2Max, hasSpo2 ? s[i] : -inf);
+            }
+            total.rows += rows;
+            total.bpmSum += bpmSum;
+            total.bpmMin = std::min(total.bpmMin, bpmMin);
+            total.bpmMax = std::max(total.bpmMax, bpmMax);
+            total.spo2Rows += spo2Rows;
+            total.spo2Sum += spo2Sum;
+            total.spo2Min = std::min(total.spo2Min, spo2Min);
+            total.spo2Max = std::max(total.spo2Max, spo2Max);
+            continue;
+        }
+
+        // Consecutive rows usually share a group, so the last group looked up is reused.
+        GroupKey lastKey;
+        Group *group = nullptr;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!m[i]) continue;
+            GroupKey key;
+            key.user = groupUser ? u[i] : 0;
+            key.bucket = groupSeconds != 0 ? floorTo(t[i], groupSeconds) : 0;
+            if (!group || !(key == lastKey)) {
+                group = &groups[key];
+                group->user = key.user;
+                group->bucket = key.bucket;
+                lastKey = key;
+            }
+            ++group->rows;
+            group->bpmSum += v[i];
+            group->bpmMin = std::min(group->bpmMin, v[i]);
+            group->bpmMax = std::max(group->bpmMax, v[i]);
+            if (s[i] >= 0.0f) {
+                ++group->spo2Rows;
+                group->spo2Sum += s[i];
+                group->spo2Min = std::min(group->spo2Min, s[i]);
+                group->spo2Max = std::max(group->spo2Max, s[i]);
+            }
+        }
+    }
+
+    std::vector<Group> ordered;
+    if (grouped) {
+        ordered.reserve(groups.size());
+        for (const auto &entry : groups) ordered.push_back(entry.second);
+    } else {
+        ordered.push_back(total);
+    }
+    finish(ordered, columns.userNames(), result);
+    return result;
+}
+
+/**
+ * @brief Picks the rollup tier that answers the query.
+ * @return int The coarsest tier whose width divides the time group and the time bounds, or -1 if none.
+ */
+int ReadingQuery::rollupTier() const {
+    for (int tier = HeartRateRollup::kTierCount - 1; tier >= 0; --tier) {
+        long long width = HeartRateRollup::tierSeconds(static_cast<HeartRateRollup::Tier>(tier));
+        if (groupSeconds != 0 && groupSeconds % width != 0) continue;
+        if (from != LLONG_MIN && floorTo(from, width) != from) continue;
+        if (to != LLONG_MAX && floorTo(to + 1, width) != to + 1) continue;
+        return tier;
+    }
+    return -1;
+}
+
+/**
+ * @brief Tells whether the query can be answered from the rollup tiers.
+ * @return bool True if executeOnRollups() gives the same answer as execute().
+ */
+bool ReadingQuery::canUseRollups() const {
+    if (bpm.active || spo2.active) return false;
+    for (const Item &item : items)
+        if (!item.isKey && item.field == FieldSpo2) return false;
+    return rollupTier() >= 0;
+}
+
+/**
+ * @brief Estimates the cost of executeOnRollups().
+ * @param store Reading store holding the per-user summaries.
+ * @param users Users to include.
+ * @return double Estimated cost.
+ */
+double ReadingQuery::rollupCost(const ReadingStore &store, const std::vector<std::string> &users) const {
+    double bytes = 0.0;
+    for (const std::string &name : users) {
+        if (user.empty() || name == user) bytes += static_cast<double>(store.summaryReadBytes(name));
+    }
+    return bytes * kTextByteCost;
+}
+
+/**
+ * @brief Estimates the cost of execute(), including loading the columns if needed.
+ *
+ * Block statistics let the scan skip blocks, but how many depends on the data, so every row is counted.
+ *
+ * @param store Reading store holding the columnar copy.
+ * @param columns The loaded columns, or null.
+ * @return double Estimated cost.
+ */
+double ReadingQuery::scanCost(const ReadingStore &store, const ReadingColumns *columns) {
+    if (columns) return static_cast<double>(columns->size()) * kRowCost;
+    std::uintmax_t columnBytes = 0, csvBytes = 0;
+    store.columnsReadBytes(columnBytes, csvBytes);
+    double rows = static_cast<double>(columnBytes) / kColumnRowBytes;
+    return static_cast<double>(columnBytes) * kColumnByteCost + static_cast<double>(csvBytes) * kTextByteCost +
+           rows * kRowCost;
+}
+
+/**
+ * @brief Runs the query on the users' rollup tiers.
+ * @param store Reading store holding the per-user summaries.
+ * @param users Users to include (the user filter, if any, is applied as well).
+ * @param[out] result Result.
+ * @return bool False if the rollups do not cover the query.
+ */
+bool ReadingQuery::executeOnRollups(const ReadingStore &store, const std::vector<std::string> &users,
+                                    QueryResult &result) const {
+    result = QueryResult();
+    HeartRateRollup::Tier tier = static_cast<HeartRateRollup::Tier>(std::max(rollupTier(), 0));
+    static const char *tierNames[] = { "minute", "hour", "day" };
+    result.plan = std::string("rollup (") + tierNames[tier] + " tier)";
+    bool grouped = groupUser || groupSeconds != 0;
+    std::unordered_map<GroupKey, Group, GroupKeyHash> groups;
+    Group total;
+
+    for (std::size_t id = 0; id < users.size() && !impossible; ++id) {
+        if (!user.empty() && users[id] != user) continue;
+        UserSummary summary;
+        if (!store.readSummary(users[id], summary)) continue;
+        // Readings before the minute horizon are only left in the hour tier.
+        if (tier == HeartRateRollup::Minute && from < summary.rollup.minuteHorizon() &&
+            summary.rollup.summarize(HeartRateRollup::Hour, from, summary.rollup.minuteHorizon()).count > 0)
+            return false;
+        const std::vector<RollupBucket> &buckets = summary.rollup.buckets(tier);
+        auto it = std::lower_bound(buckets.begin(), buckets.end(), from,
+                                   [](const RollupBucket &bucket, long long time) { return bucket.start < time; });
+        Group *group = nullptr;
+        GroupKey lastKey;
+        for (; it != buckets.end() && it->start <= to; ++it) {
+            ++result.rowsScanned;
+            if (it->count == 0) continue;
+            if (grouped) {
+                GroupKey key;
+                key.user = groupUser ? static_cast<std::uint32_t>(id) : 0;
+                key.bucket = groupSeconds != 0 ? floorTo(it->start, groupSeconds) : 0;
+                if (!group || !(key == lastKey)) {
+                    group = &groups[key];
+                    group->user = key.user;
+                    group->bucket = key.bucket;
+                    lastKey = key;
+                }
+            } else {
+                group = &total;
+            }
+            group->rows += it->count;
+            group->bpmSum += it->sum;
+            group->bpmMin = std::min(group->bpmMin, static_cast<float>(it->min));
+            group->bpmMax = std::max(group->bpmMax, static_cast<float>(it->max));
+        }
+    }
+
+    std::vector<Group> ordered;
+    if (grouped) {
+        ordered.reserve(groups.size());
+        for (const auto &entry : groups) ordered.push_back(entry.second);
+    } else {
+        ordered.push_back(total);
+    }
+    finish(ordered, users, result);
+    return true;
+}
+
+/**
+ * @brief Sorts groups by their keys and formats them as result rows.
+ * @param groups Aggregated groups (reordered).
+ * @param userNames User name per group user id.
+ * @param[out] result Result whose columns and rows are filled in.
+ */
+void ReadingQuery::finish(std::vector<Group> &groups, const std::vector<std::string> &userNames,
+                          QueryResult &result) const {
+    std::sort(groups.begin(), groups.end(), [&](const Group &a, const Group &b) {
+        if (groupUser && a.user != b.user) return userNames[a.user] < userNames[b.user];
+        return a.bucket < b.bucket;
+    });
+    for (const Item &item : items) result.columns.push_back(item.label);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (const Group &group : groups) {
+        if (limit != 0 && result.rows.size() >= limit) break;
+        std::vector<std::string> row;
+        for (const Item &item : items) {
+            if (item.isKey) {
+                row.push_back(item.key == KeyUser ? userNames[group.user] : formatBucket(group.bucket, groupSeconds));
+                continue;
+            }
+            bool isSpo2 = item.field == FieldSpo2;
+            long long count = isSpo2 ? group.spo2Rows : group.rows;
+            double sum = isSpo2 ? group.spo2Sum : group.bpmSum;
+            double value = nan;
+            switch (item.aggregate) {
+            case Count: value = static_cast<double>(count); break;
+            case Sum: value = count > 0 ? sum : nan; break;
+            case Avg: value = count > 0 ? sum / count : nan; break;
+            case Min: value = isSpo2 ? group.spo2Min : group.bpmMin; break;
+            case Max: value = isSpo2 ? group.spo2Max : group.bpmMax; break;
+            }
+            row.push_back(formatValue(value, item.aggregate == Count));
+        }
+        result.rows.push_back(row);
+    }
+}
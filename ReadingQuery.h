@@ -0,0 +1,199 @@
+#ifndef READINGQUERY_H
+#define READINGQUERY_H
+
+/**
+ * @file ReadingQuery.h
+ * @brief Declaration of the reading query language and its vectorized and rollup executors.
+ *
+ * This header declares a small query language for ad-hoc questions about heart-rate readings, such as
+ * "average BPM per user per hour for the last week where BPM > 100". A parsed query runs either as a
+ * block-at-a-time scan over ReadingColumns, pruning blocks with their time and value statistics, or, when it
+ * only needs BPM aggregates over tier-aligned time ranges, directly on the users' rollup tiers.
+ */
+
+#include <climits>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class ReadingColumns;
+class ReadingStore;
+
+/**
+ * @brief Output of a query.
+ */
+struct QueryResult {
+    std::vector<std::string> columns;               /**< Column headers in SELECT order. */
+    std::vector<std::vector<std::string>> rows;     /**< Formatted cells, sorted by the group keys. */
+    std::string plan;                               /**< How the query was executed. */
+    std::size_t blocksScanned = 0;                  /**< Column blocks read (scan plan). */
+    std::size_t blocksSkipped = 0;                  /**< Column blocks ruled out by their statistics. */
+    std::size_t rowsScanned = 0;                    /**< Rows read (scan plan) or rollup buckets read. */
+};
+
+/**
+ * @class ReadingQuery
+ * @brief Parses and executes reading queries.
+ *
+ * Syntax (keywords and names are case-insensitive):
+ *   query   := SELECT item { , item } [ WHERE pred { AND pred } ] [ GROUP BY key { , key } ] [ LIMIT n ]
+ *   item    := key | agg ( field ) | COUNT ( * )
+ *   key     := user | minute | hour | day          (time buckets are UTC)
+ *   agg     := count | sum | avg | min | max
+ *   field   := bpm | spo2
+ *   pred    := field op number | user = 'name' | time op when
+ *   op      := < | <= | > | >= | =
+ *   when    := seconds-since-epoch | now [ - n(s|m|h|d|w) ] | today [ - n(s|m|h|d|w) ]
+ * Every key in SELECT must be grouped on. Example:
+ *   SELECT user, hour, avg(bpm), count(*) WHERE bpm > 100 AND time >= now - 7d GROUP BY user, hour
+ *
+ * Scan plan: blocks are skipped when their min/max statistics exclude every row, located with a binary
+ * search on time when the blocks are time-sorted, and processed without a filter when their statistics
+ * show every row qualifies. Other blocks build a selection mask one predicate column at a time and reduce
+ * the masked columns, so each inner loop is a branch-free pass over one column.
+ *
+ * Rollup plan: without BPM or SpO2 predicates or SpO2 aggregates, and with time bounds aligned to a rollup
+ * tier no finer than the time group, the query merges rollup buckets instead of reading rows.
+ */
+class ReadingQuery {
+public:
+    /**
+     * @brief Group keys.
+     */
+    enum Key {
+        KeyUser = 0,
+        KeyMinute,
+        KeyHour,
+        KeyDay
+    };
+
+    /**
+     * @brief Aggregate functions.
+     */
+    enum Aggregate {
+        Count = 0,
+        Sum,
+        Avg,
+        Min,
+        Max
+    };
+
+    /**
+     * @brief Aggregated fields.
+     */
+    enum Field {
+        FieldRows = 0,  /**< count(*). */
+        FieldBpm,
+        FieldSpo2
+    };
+
+    /**
+     * @brief Parses a query.
+     * @param text Query text.
+     * @param[out] error Description of the first syntax error.
+     * @param now Current time used by "now" and "today" (seconds since epoch).
+     * @return bool False on a syntax error.
+     */
+    bool parse(const std::string &text, std::string &error, long long now);
+
+    /**
+     * @brief Runs the query as a vectorized scan over the columnar readings.
+     * @param columns Columnar readings.
+     * @return QueryResult Result.
+     */
+    QueryResult execute(const ReadingColumns &columns) const;
+
+    /**
+     * @brief Tells whether the query can be answered from the rollup tiers.
+     * @return bool True if executeOnRollups() gives the same answer as execute().
+     */
+    bool canUseRollups() const;
+
+    /**
+     * @brief Estimates the cost of executeOnRollups() from file sizes and offsets, without reading summaries.
+     *
+     * The rollup plan parses each user's summary text and every CSV row the summary has not folded in yet,
+     * which for a user without a summary is the whole CSV.
+     *
+     * @param store Reading store holding the per-user summaries.
+     * @param users Users to include (the user filter, if any, is applied as well).
+     * @return double Estimated cost, comparable with scanCost().
+     */
+    double rollupCost(const ReadingStore &store, const std::vector<std::string> &users) const;
+
+    /**
+     * @brief Estimates the cost of execute(), including loading the columns if that is still to be done.
+     * @param store Reading store holding the columnar copy.
+     * @param columns The loaded columns, or null if they have not been loaded.
+     * @return double Estimated cost, comparable with rollupCost().
+     */
+    static double scanCost(const ReadingStore &store, const ReadingColumns *columns);
+
+    /**
+     * @brief Runs the query on the users' rollup tiers.
+     *
+     * Summaries are read with ReadingStore::readSummary(), so a query never writes anything. A query that
+     * needs the minute tier further back than a user's minute horizon cannot be answered this way; the caller
+     * then falls back to execute().
+     *
+     * @param store Reading store holding the per-user summaries.
+     * @param users Users to include (the user filter, if any, is applied as well).
+     * @param[out] result Result.
+     * @return bool False if the rollups do not cover the query.
+     */
+    bool executeOnRollups(const ReadingStore &store, const std::vector<std::string> &users,
+                          QueryResult &result) const;
+
+    /** @return const std::string& User the query is restricted to (empty if none). */
+    const std::string& userFilter() const { return user; }
+
+private:
+    /**
+     * @brief One SELECT item.
+     */
+    struct Item {
+        bool isKey = false;             /**< True for a group key, false for an aggregate. */
+        Key key = KeyUser;              /**< Group key. */
+        Aggregate aggregate = Count;    /**< Aggregate function. */
+        Field field = FieldRows;        /**< Aggregated field. */
+        std::string label;              /**< Column header. */
+    };
+
+    /**
+     * @brief Inclusive value range of a predicate column.
+     */
+    struct Range {
+        float low = -1e30f;             /**< Smallest accepted value. */
+        float high = 1e30f;             /**< Largest accepted value. */
+        bool active = false;            /**< True if a predicate restricts the column. */
+    };
+
+    std::vector<Item> items;                    /**< SELECT items. */
+    bool groupUser = false;                     /**< GROUP BY user. */
+    long long groupSeconds = 0;                 /**< Time bucket width (0 if not grouped by time). */
+    Range bpm;                                  /**< BPM predicate. */
+    Range spo2;                                 /**< SpO2 predicate. */
+    long long from = LLONG_MIN;                 /**< Earliest accepted timestamp. */
+    long long to = LLONG_MAX;                   /**< Latest accepted timestamp. */
+    std::string user;                           /**< Required user (empty for any). */
+    bool impossible = false;                    /**< Contradictory predicates (e.g. two different users). */
+    std::size_t limit = 0;                      /**< Maximum rows (0 for no limit). */
+
+    struct Group;
+
+    /**
+     * @brief Picks the rollup tier that answers the query.
+     * @return int The coarsest tier whose width divides the time group and the time bounds, or -1 if none.
+     */
+    int rollupTier() const;
+
+    /**
+     * @brief Sorts groups by their keys and formats them as result rows.
+     * @param groups Aggregated groups (reordered).
+     * @param userNames User name per group user id.
+     * @param[out] result Result whose columns and rows are filled in.
+     */
+    void finish(std::vector<Group> &groups, const std::vector<std::string> &userNames, QueryResult &result) const;
+};
+
+#endif // READINGQUERY_H
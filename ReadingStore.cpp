@@ -0,0 +1,817 @@
+/**
+ * @file ReadingStore.cpp
+ * @brief Implements the ReadingStore class and the UserSummary it maintains.
+ *
+ * Summary files live in the summary directory as "<user>.summary" and start with a snapshot: a small header
+ * ("HeartPiSummary,6", "user,<name>", "offset,<bytes>") followed by the rollup tiers, the Holt-Winters
+ * state, a "population,<dayStart>" line, the day histograms, the change detector ("detector,..." and
+ * "change,<count>,<kind>,<timestamp>,<value>,<baseline>,<severity>") and the newest reading
+ * ("latest,<timestamp>,<bpm>,<spo2>"). A summary with any other magic line is rebuilt
+ * from the CSV, so the magic is bumped whenever the layout changes. Snapshots are written to a temporary file
+ * and renamed into place so a crash never leaves a half-written summary behind.
+ *
+ * Change records are appended after the snapshot: "changes,<fromOffset>,<toOffset>,<populationDay>", the
+ * rollup buckets and day histograms the new readings touched, the Holt-Winters state, the change detector, the
+ * newest reading and "end,<toOffset>".
+ * A record only applies on top of the offset reached so far, and one cut short by a crash (no end line) is
+ * ignored, so appending is as safe as the rename.
+ *
+ * The population sketches are shared by every process that appends (the GUI, ingestd), so each batch reads,
+ * merges and replaces them while holding an exclusive lock on "population.sketch.lock".
+ */
+
+#include "ReadingStore.h"
+#include "ReadingColumns.h"
+#include "ErrorHandling.h"
+#include "FileLock.h"
+#include "MetricsRegistry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+
+namespace {
+
+const char *kSummaryMagic = "HeartPiSummary,6";
+
+/**
+ * @brief Appends a reading in the CSV row format (without a newline) to a buffer.
+ * @param buffer Buffer to append to; it only allocates when it has to grow.
+ * @param reading The reading.
+ */
+void appendReadingLine(std::string &buffer, const HeartRateReading &reading) {
+    char numbers[96];
+    int length;
+    if (reading.spo2 >= 0.0)
+        length = std::snprintf(numbers, sizeof(numbers), ",%lld,%.1f,%.1f", reading.timestamp, reading.bpm,
+                               reading.spo2);
+    else
+        length = std::snprintf(numbers, sizeof(numbers), ",%lld,%.1f", reading.timestamp, reading.bpm);
+    buffer += reading.user;
+    buffer.append(numbers, static_cast<std::size_t>(length));
+}
+
+/**
+ * @brief Trims spaces, tabs and carriage returns from both ends of a string view.
+ * @param text Text to trim.
+ * @param begin Index of the first character.
+ * @param end One past the last character.
+ * @return std::string The trimmed substring.
+ */
+std::string trimmed(const std::string &text, std::size_t begin, std::size_t end) {
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t' || text[begin] == '\r')) ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r')) --end;
+    return text.substr(begin, end - begin);
+}
+
+/**
+ * @brief Writes the change detector, its last event and the newest reading.
+ * @param out Output stream.
+ * @param summary Summary to write.
+ */
+void writeDetector(std::ostream &out, const UserSummary &summary) {
+    summary.detector.write(out);
+    const ChangeEvent &event = summary.lastChange;
+    out << "change," << summary.changeCount << "," << static_cast<int>(event.kind) << "," << event.timestamp << ","
+        << event.value << "," << event.baseline << "," << event.severity << "\n";
+    out << "latest," << summary.latestTimestamp << "," << summary.latestBpm << "," << summary.latestSpO2 << "\n";
+}
+
+/**
+ * @brief Reads what writeDetector() wrote.
+ * @param in Input stream.
+ * @param[out] summary Summary to fill in.
+ * @return bool False if the lines are malformed.
+ */
+bool readDetector(std::istream &in, UserSummary &summary) {
+    std::string line;
+    if (!summary.detector.read(in) || !std::getline(in, line) || line.compare(0, 7, "change,") != 0) return false;
+    char *end = nullptr;
+    ChangeEvent &event = summary.lastChange;
+    summary.changeCount = std::strtoll(line.c_str() + 7, &end, 10);
+    if (*end != ',') return false;
+    long kind = std::strtol(end + 1, &end, 10);
+    if (*end != ',' || kind < ChangeEvent::EwmaHigh || kind > ChangeEvent::CusumDown) return false;
+    event.kind = static_cast<ChangeEvent::Kind>(kind);
+    event.timestamp = std::strtoll(end + 1, &end, 10);
+    if (*end != ',') return false;
+    event.value = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    event.baseline = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    event.severity = std::strtod(end + 1, &end);
+    if (*end != '\0' || !std::getline(in, line) || line.compare(0, 7, "latest,") != 0) return false;
+    summary.latestTimestamp = std::strtoll(line.c_str() + 7, &end, 10);
+    if (*end != ',') return false;
+    summary.latestBpm = std::strtod(end + 1, &end);
+    if (*end != ',') return false;
+    summary.latestSpO2 = std::strtod(end + 1, &end);
+    return *end == '\0';
+}
+
+/**
+ * @brief Writes a summary snapshot.
+ * @param out Output stream.
+ * @param summary Summary to write.
+ */
+void writeSnapshot(std::ostream &out, const UserSummary &summary) {
+    out << kSummaryMagic << "\n";
+    out << "user," << summary.user << "\n";
+    out << "offset," << summary.csvOffset << "\n";
+    summary.rollup.write(out);
+    summary.forecaster.write(out);
+    out << "population," << summary.populationDay << "\n";
+    summary.histograms.write(out);
+    writeDetector(out, summary);
+}
+
+/**
+ * @brief Replaces a file's content via a temporary file and rename.
+ * @param path File to replace.
+ * @param text New content.
+ * @return bool False if the file could not be written.
+ */
+bool replaceFile(const std::string &path, const std::string &text) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            ErrorHandling::logErrorMessage("Failed to write summary " + tempPath);
+            return false;
+        }
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        out.close();
+        if (!out) {
+            ErrorHandling::logErrorMessage("Failed to write summary " + tempPath);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        ErrorHandling::logErrorMessage("Failed to replace summary " + path + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Folds one reading into every part of the summary.
+ * @param reading The reading.
+ */
+void UserSummary::addReading(const HeartRateReading &reading) {
+    if (reading.timestamp >= latestTimestamp) {
+        latestTimestamp = reading.timestamp;
+        latestBpm = reading.bpm;
+        latestSpO2 = reading.spo2;
+    }
+    rollup.addReading(reading.timestamp, reading.bpm);
+    histograms.addReading(reading.timestamp, reading.bpm);
+    feedForecaster();
+    ChangeEvent event;
+    if (detector.update(reading.timestamp, reading.bpm, event)) {
+        lastChange = event;
+        ++changeCount;
+    }
+}
+
+/**
+ * @brief Feeds the forecaster every completed hour bucket it has not seen yet.
+ */
+void UserSummary::feedForecaster() {
+    const std::vector<RollupBucket> &hours = rollup.buckets(HeartRateRollup::Hour);
+    if (hours.size() < 2) return;
+    std::size_t next = hours.size() - 1;
+    while (next > 0 && (forecaster.getBucketsSeen() == 0 || hours[next - 1].start > forecaster.getLastBucketStart()))
+        --next;
+    for (std::size_t i = next; i + 1 < hours.size(); ++i) forecaster.update(hours[i].start, hours[i].mean());
+}
+
+/**
+ * @brief Constructs a new ReadingStore object.
+ * @param csvFile Path of the reading CSV.
+ * @param summaryDirectory Directory for per-user summary files.
+ */
+ReadingStore::ReadingStore(const std::string &csvFile, const std::string &summaryDirectory)
+    : csvPath(csvFile), summaryDir(summaryDirectory) {}
+
+/**
+ * @brief Parses a reading row.
+ * @param line CSV line without the newline.
+ * @param[out] reading Parsed reading.
+ * @return bool False for registration rows, the header and malformed rows.
+ */
+bool ReadingStore::parseReadingLine(const std::string &line, HeartRateReading &reading) {
+    std::size_t fieldStart[5];
+    std::size_t fieldEnd[5];
+    int fields = 0;
+    std::size_t begin = 0;
+    while (fields < 5) {
+        std::size_t comma = line.find(',', begin);
+        fieldStart[fields] = begin;
+        fieldEnd[fields] = comma == std::string::npos ? line.size() : comma;
+        ++fields;
+        if (comma == std::string::npos) break;
+        begin = comma + 1;
+    }
+    if (fields != 3 && fields != 4) return false;
+
+    std::string timestampText = trimmed(line, fieldStart[1], fieldEnd[1]);
+    std::string bpmText = trimmed(line, fieldStart[2], fieldEnd[2]);
+    char *end = nullptr;
+    long long timestamp = std::strtoll(timestampText.c_str(), &end, 10);
+    if (timestampText.empty() || *end != '\0') return false;
+    double bpm = std::strtod(bpmText.c_str(), &end);
+    if (bpmText.empty() || *end != '\0') return false;
+
+    reading.user = trimmed(line, fieldStart[0], fieldEnd[0]);
+    reading.timestamp = timestamp;
+    reading.bpm = bpm;
+    reading.spo2 = -1.0;
+    if (fields == 4) {
+        std::string spo2Text = trimmed(line, fieldStart[3], fieldEnd[3]);
+        double spo2 = std::strtod(spo2Text.c_str(), &end);
+        if (!spo2Text.empty() && *end == '\0') reading.spo2 = spo2;
+    }
+    return !reading.user.empty();
+}
+
+/**
+ * @brief Formats a reading as a CSV row.
+ * @param reading Reading to format.
+ * @return std::string CSV row without the newline.
+ */
+std::string ReadingStore::formatReadingLine(const HeartRateReading &reading) {
+    std::string line;
+    appendReadingLine(line, reading);
+    return line;
+}
+
+/**
+ * @brief Adds to the count of reading CSV bytes read (heartpi_csv_bytes_scanned_total).
+ * @param bytes Bytes read.
+ */
+void ReadingStore::countCsvBytesScanned(std::uint64_t bytes) {
+    static MetricCounter &counter = MetricsRegistry::global().counter(
+        "heartpi_csv_bytes_scanned_total", "Bytes of the reading CSV read by catch-up and full-file scans.");
+    counter.add(bytes);
+}
+
+/**
+ * @brief Gets the path of a user's summary file.
+ *
+ * Letters, digits, '-' and '_' are kept; everything else is written as %XX so distinct usernames always
+ * map to distinct files.
+ *
+ * @param user Username.
+ * @return std::string Summary file path.
+ */
+std::string ReadingStore::summaryPath(const std::string &user) const {
+    static const char *hex = "0123456789ABCDEF";
+    std::string name;
+    for (unsigned char c : user) {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_') {
+            name += static_cast<char>(c);
+        } else {
+            name += '%';
+            name += hex[c >> 4];
+            name += hex[c & 0x0F];
+        }
+    }
+    return summaryDir + "/" + name + ".summary";
+}
+
+/**
+ * @brief Appends a batch of readings and updates the affected users' summaries.
+ * @param batch Readings to append.
+ * @return bool False if the CSV could not be written.
+ */
+bool ReadingStore::append(const std::vector<HeartRateReading> &batch, const PopulationStats &extra) {
+    return append(batch.data(), batch.size(), extra);
+}
+
+/**
+ * @brief Appends a batch of readings held in a plain array.
+ *
+ * Rows are formatted straight into one buffer, and a user is only looked up in the affected-user set when
+ * it differs from the previous row's, which is the common case for gateway batches grouped by wearer.
+ *
+ * @param batch First reading.
+ * @param count Number of readings.
+ * @return bool False if the CSV could not be written.
+ */
+bool ReadingStore::append(const HeartRateReading *batch, std::size_t count, const PopulationStats &extra) {
+    if (count == 0 && extra.empty()) return true;
+    static MetricCounter &ingested = MetricsRegistry::global().counter(
+        "heartpi_readings_ingested_total", "Readings appended to the reading CSV.");
+    static MetricHistogram &appendSeconds = MetricsRegistry::global().histogram(
+        "heartpi_reading_append_seconds", "Time to append a batch and update the affected summaries.",
+        {0.001, 0.005, 0.025, 0.1, 0.5, 2.5});
+    auto started = std::chrono::steady_clock::now();
+
+    // Appends and their rollback run under the CSV's lock, so a rollback only ever cuts off this batch.
+    std::unique_ptr<FileLock> csvLock;
+    if (count > 0) csvLock.reset(new FileLock(csvPath + ".lock"));
+    std::string buffer;
+    buffer.reserve(count * 32);
+    std::error_code ec;
+    std::uintmax_t previousSize = std::filesystem::exists(csvPath, ec) ? std::filesystem::file_size(csvPath, ec) : 0;
+    if (ec) previousSize = 0;
+    if (previousSize == 0) buffer += "Username,Password\n";
+    std::set<std::string> users;
+    const std::string *previous = nullptr;
+    for (std::size_t i = 0; i < count; ++i) {
+        const HeartRateReading &reading = batch[i];
+        appendReadingLine(buffer, reading);
+        buffer += '\n';
+        if (!previous || *previous != reading.user) users.insert(reading.user);
+        previous = &reading.user;
+    }
+
+    bool contiguous = false;
+    if (count > 0) {
+        std::ofstream out(csvPath, std::ios::binary | std::ios::app);
+        if (!out.is_open()) {
+            ErrorHandling::logErrorMessage("Failed to open " + csvPath + " for appending readings");
+            return false;
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.close();
+        if (!out) {
+            ErrorHandling::logErrorMessage("Failed to append readings to " + csvPath);
+            // Whatever part of the batch reached the file is cut off again, so a batch lands whole or not at all.
+            if (csvLock->isLocked() && std::filesystem::file_size(csvPath, ec) > previousSize && !ec)
+                std::filesystem::resize_file(csvPath, previousSize, ec);
+            return false;
+        }
+        ingested.add(count);
+        // Nobody else appended in between, so the new bytes are exactly this buffer.
+        contiguous = std::filesystem::file_size(csvPath, ec) == previousSize + buffer.size() && !ec;
+    }
+    csvLock.reset();
+    long long before = static_cast<long long>(previousSize);
+    long long after = static_cast<long long>(previousSize + buffer.size());
+
+    // Summaries that had consumed the CSV up to this batch take it from the buffer; the others read their
+    // tail back from the file, this batch included.
+    std::vector<CachedSummary *> affected;
+    std::unordered_map<std::string, CachedSummary *> direct;
+    for (const std::string &user : users) {
+        CachedSummary &entry = cachedSummary(user);
+        if (contiguous && entry.summary.csvOffset == before) direct[user] = &entry;
+        else if (!catchUp(entry)) continue;
+        affected.push_back(&entry);
+    }
+    if (!direct.empty()) {
+        // The rows are parsed back rather than taken from the batch, so they fold exactly as a rescan would.
+        HeartRateReading reading;
+        std::string line;
+        CachedSummary *target = nullptr;
+        std::string targetUser;
+        for (std::size_t lineStart = 0, newline; (newline = buffer.find('\n', lineStart)) != std::string::npos;
+             lineStart = newline + 1) {
+            line.assign(buffer, lineStart, newline - lineStart);
+            if (!parseReadingLine(line, reading)) continue;
+            if (!target || reading.user != targetUser) {
+                auto found = direct.find(reading.user);
+                target = found == direct.end() ? nullptr : found->second;
+                targetUser = reading.user;
+                if (!target) continue;
+            }
+            fold(*target, reading);
+        }
+    }
+    if (contiguous) {
+        for (auto &cached : cache)
+            if (cached.second.summary.csvOffset == before) cached.second.summary.csvOffset = after;
+    }
+
+    PopulationStats fresh;
+    fresh.merge(extra);
+    for (CachedSummary *entry : affected) {
+        UserSummary &summary = entry->summary;
+        // Every day bucket except the newest is complete.
+        const std::vector<RollupBucket> &days = summary.rollup.buckets(HeartRateRollup::Day);
+        for (std::size_t i = 0; i + 1 < days.size(); ++i) {
+            if (days[i].start <= summary.populationDay) continue;
+            fresh.add(PopulationStats::userDayKey(), days[i].mean());
+            summary.populationDay = days[i].start;
+            entry->dirty = true;
+        }
+        persist(*entry);
+    }
+    trimCache();
+    if (!fresh.empty()) {
+        // Without the lock, two processes merging at once would each write back a copy missing the other's samples.
+        std::filesystem::create_directories(summaryDir, ec);
+        FileLock lock(populationPath() + ".lock");
+        PopulationStats population;
+        loadPopulation(population);
+        population.merge(fresh);
+        population.save(populationPath());
+    }
+    appendSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    return true;
+}
+
+/**
+ * @brief Loads the population sketches.
+ * @param[out] population The sketches.
+ * @return bool False if the file is malformed.
+ */
+bool ReadingStore::loadPopulation(PopulationStats &population) const {
+    return population.load(populationPath());
+}
+
+/**
+ * @brief Loads a user's summary, catching it up with any rows appended since it was last saved.
+ * @param user Username.
+ * @param[out] summary The up-to-date summary.
+ * @return bool False if the CSV could not be read.
+ */
+bool ReadingStore::loadSummary(const std::string &user, UserSummary &summary) const {
+    CachedSummary &entry = cachedSummary(user);
+    if (!catchUp(entry)) return false;
+    persist(entry);
+    summary = entry.summary;
+    trimCache();
+    return true;
+}
+
+/**
+ * @brief Reads a user's summary and catches it up in memory only.
+ * @param user Username.
+ * @param[out] summary The up-to-date summary.
+ * @return bool False if the CSV could not be read.
+ */
+bool ReadingStore::readSummary(const std::string &user, UserSummary &summary) const {
+    CachedSummary entry;
+    entry.summary.user = user;
+    if (!readSummaryFile(user, entry)) {
+        entry = CachedSummary();
+        entry.summary.user = user;
+    }
+    if (!catchUp(entry)) return false;
+    summary = std::move(entry.summary);
+    return true;
+}
+
+/**
+ * @brief Estimates how much reading a user's summary would parse.
+ *
+ * Only the snapshot's offset is looked at, so rows already covered by change records count as unread; the
+ * estimate errs on the high side.
+ *
+ * @param user Username.
+ * @return std::uintmax_t Estimated bytes.
+ */
+std::uintmax_t ReadingStore::summaryReadBytes(const std::string &user) const {
+    std::error_code ec;
+    std::uintmax_t csvBytes = std::filesystem::file_size(csvPath, ec);
+    if (ec) csvBytes = 0;
+    std::string path = summaryPath(user);
+    std::uintmax_t summaryBytes = std::filesystem::file_size(path, ec);
+    if (ec) return csvBytes;
+
+    std::ifstream in(path, std::ios::binary);
+    std::string magic, userLine, offsetLine;
+    if (!std::getline(in, magic) || magic != kSummaryMagic || !std::getline(in, userLine) ||
+        userLine != "user," + user || !std::getline(in, offsetLine) || offsetLine.compare(0, 7, "offset,") != 0)
+        return csvBytes;
+    long long offset = std::strtoll(offsetLine.c_str() + 7, nullptr, 10);
+    if (offset < 0 || static_cast<std::uintmax_t>(offset) > csvBytes) return csvBytes;
+    return summaryBytes + (csvBytes - static_cast<std::uintmax_t>(offset));
+}
+
+/**
+ * @brief Estimates how much loadColumns() would read.
+ * @param[out] columnBytes Size of the column file.
+ * @param[out] csvBytes Bytes of CSV not folded into it.
+ */
+void ReadingStore::columnsReadBytes(std::uintmax_t &columnBytes, std::uintmax_t &csvBytes) const {
+    std::error_code ec;
+    csvBytes = std::filesystem::file_size(csvPath, ec);
+    if (ec) csvBytes = 0;
+    columnBytes = std::filesystem::file_size(columnsPath(), ec);
+    if (ec) {
+        columnBytes = 0;
+        return;
+    }
+    std::ifstream in(columnsPath(), std::ios::binary);
+    std::uint64_t offset = 0;
+    if (ReadingColumns::readCsvOffset(in, offset) && offset <= csvBytes) csvBytes -= offset;
+}
+
+/**
+ * @brief Gets a user's cached summary, reading it from disk if it is not cached or the file has changed.
+ *
+ * The file's size and modification time tell whether another store or process has saved it since.
+ *
+ * @param user Username.
+ * @return CachedSummary& The entry.
+ */
+ReadingStore::CachedSummary &ReadingStore::cachedSummary(const std::string &user) const {
+    std::error_code ec;
+    std::string path = summaryPath(user);
+    std::uintmax_t size = std::filesystem::file_size(path, ec);
+    std::filesystem::file_time_type time;
+    if (!ec) time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        size = 0;
+        time = std::filesystem::file_time_type();
+    }
+
+    auto found = cache.find(user);
+    CachedSummary &entry = found != cache.end() ? found->second : cache[user];
+    if (found == cache.end() || size != entry.fileBytes || time != entry.fileTime) {
+        entry = CachedSummary();
+        entry.summary.user = user;
+        if (!readSummaryFile(user, entry)) {
+            entry = CachedSummary();
+            entry.summary.user = user;
+            entry.dirty = true;
+        }
+        entry.fileBytes = size;
+        entry.fileTime = time;
+    }
+    entry.lastUse = ++useCounter;
+    return entry;
+}
+
+/**
+ * @brief Reads a summary file: the snapshot, then every complete change record that follows on from it.
+ * @param user Username.
+ * @param[out] entry The entry to fill in.
+ * @return bool False if there is no usable snapshot.
+ */
+bool ReadingStore::readSummaryFile(const std::string &user, CachedSummary &entry) const {
+    std::ifstream in(summaryPath(user), std::ios::binary);
+    if (!in.is_open()) return false;
+
+    // A summary in any other layout, including an older one, is rebuilt from the CSV rather than upgraded.
+    UserSummary &summary = entry.summary;
+    std::string magic, userLine, offsetLine, section, populationLine;
+    bool ok = std::getline(in, magic) && magic == kSummaryMagic &&
+              std::getline(in, userLine) && userLine == "user," + user &&
+              std::getline(in, offsetLine) && offsetLine.compare(0, 7, "offset,") == 0 &&
+              summary.rollup.read(in) &&
+              std::getline(in, section) && summary.forecaster.read(section, in) &&
+              std::getline(in, populationLine) && populationLine.compare(0, 11, "population,") == 0 &&
+              summary.histograms.read(in) && readDetector(in, summary);
+    if (!ok) return false;
+    summary.csvOffset = std::strtoll(offsetLine.c_str() + 7, nullptr, 10);
+    summary.populationDay = std::strtoll(populationLine.c_str() + 11, nullptr, 10);
+    std::streamoff snapshotEnd = in.tellg();
+    entry.snapshotBytes = snapshotEnd > 0 ? static_cast<std::uintmax_t>(snapshotEnd) : 0;
+
+    std::string line, record;
+    bool clean = true;
+    while (std::getline(in, line)) {
+        char *end = nullptr;
+        long long fromOffset = 0, toOffset = 0, populationDay = 0;
+        if (line.compare(0, 8, "changes,") == 0) {
+            fromOffset = std::strtoll(line.c_str() + 8, &end, 10);
+            if (*end == ',') toOffset = std::strtoll(end + 1, &end, 10);
+            if (*end == ',') populationDay = std::strtoll(end + 1, &end, 10);
+        }
+        if (!end || *end != '\0' || fromOffset != summary.csvOffset) {
+            clean = false;
+            break;
+        }
+
+        // The record is checked for its end line before any of it is applied.
+        std::string endLine = "end," + std::to_string(toOffset);
+        record.clear();
+        bool complete = false;
+        while (std::getline(in, line)) {
+            if (line == endLine) {
+                complete = true;
+                break;
+            }
+            record += line;
+            record += '\n';
+        }
+        if (!complete) {
+            clean = false;
+            break;
+        }
+        std::istringstream body(record);
+        if (!summary.rollup.readChanges(body) || !std::getline(body, section) ||
+            !summary.forecaster.read(section, body) || !summary.histograms.readChanges(body) ||
+            !readDetector(body, summary))
+            return false;
+        summary.csvOffset = toOffset;
+        summary.populationDay = populationDay;
+    }
+    // Anything after the last usable record is rewritten away by the next save.
+    entry.savedOffset = clean ? summary.csvOffset : -1;
+    return true;
+}
+
+/**
+ * @brief Folds in the rows appended to the CSV since the summary's offset.
+ * @param entry Cached summary.
+ * @return bool False if the CSV could not be read.
+ */
+bool ReadingStore::catchUp(CachedSummary &entry) const {
+    UserSummary &summary = entry.summary;
+    std::ifstream csv(csvPath, std::ios::binary | std::ios::ate);
+    if (!csv.is_open()) {
+        return false;
+    }
+    long long size = static_cast<long long>(csv.tellg());
+    if (size < summary.csvOffset) {
+        // The CSV was rewritten underneath us; start over.
+        std::string user = summary.user;
+        summary = UserSummary();
+        summary.user = user;
+        entry.savedOffset = -1;
+        entry.dirty = true;
+    }
+    if (size == summary.csvOffset) return true;
+
+    std::string tail(static_cast<std::size_t>(size - summary.csvOffset), '\0');
+    csv.seekg(summary.csvOffset);
+    csv.read(&tail[0], static_cast<std::streamsize>(tail.size()));
+    countCsvBytesScanned(tail.size());
+
+    // Only complete lines are consumed; a row still being written is picked up next time.
+    std::size_t lineStart = 0;
+    HeartRateReading reading;
+    std::string line;
+    while (true) {
+        std::size_t newline = tail.find('\n', lineStart);
+        if (newline == std::string::npos) break;
+        line.assign(tail, lineStart, newline - lineStart);
+        if (parseReadingLine(line, reading) && reading.user == summary.user) fold(entry, reading);
+        lineStart = newline + 1;
+    }
+    summary.csvOffset += static_cast<long long>(lineStart);
+    return true;
+}
+
+/**
+ * @brief Folds one reading into a cached summary and marks it dirty.
+ * @param entry Cached summary.
+ * @param reading The reading.
+ */
+void ReadingStore::fold(CachedSummary &entry, const HeartRateReading &reading) {
+    entry.summary.addReading(reading);
+    if (reading.timestamp < entry.changedSince) entry.changedSince = reading.timestamp;
+    entry.dirty = true;
+}
+
+/**
+ * @brief Saves a dirty summary.
+ *
+ * A change record goes on the end of the file when the file is still the one this store last saw and its
+ * records take up less room than the snapshot; otherwise the summary is compacted into a fresh snapshot. That
+ * keeps the file within twice the snapshot size while most saves write a few hundred bytes.
+ *
+ * @param entry Cached summary.
+ * @return bool False if the file could not be written.
+ */
+bool ReadingStore::persist(CachedSummary &entry) const {
+    if (!entry.dirty) return true;
+    const UserSummary &summary = entry.summary;
+    std::string path = summaryPath(summary.user);
+    std::error_code ec;
+    std::uintmax_t size = std::filesystem::file_size(path, ec);
+    bool unchanged = !ec && size == entry.fileBytes && std::filesystem::last_write_time(path, ec) == entry.fileTime &&
+                     !ec;
+
+    std::ostringstream text;
+    if (entry.savedOffset >= 0 && unchanged && entry.fileBytes - entry.snapshotBytes < entry.snapshotBytes) {
+        text << "changes," << entry.savedOffset << "," << summary.csvOffset << "," << summary.populationDay << "\n";
+        summary.rollup.writeChanges(text, entry.changedSince);
+        summary.forecaster.write(text);
+        summary.histograms.writeChanges(text, entry.changedSince);
+        writeDetector(text, summary);
+        text << "end," << summary.csvOffset << "\n";
+        std::string record = text.str();
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.write(record.data(), static_cast<std::streamsize>(record.size()));
+        out.close();
+        if (!out) {
+            ErrorHandling::logErrorMessage("Failed to append to summary " + path);
+            std::filesystem::resize_file(path, entry.fileBytes, ec);
+            entry.savedOffset = -1;
+            return false;
+        }
+        entry.fileBytes += record.size();
+    } else {
+        std::filesystem::create_directories(summaryDir, ec);
+        writeSnapshot(text, summary);
+        std::string snapshot = text.str();
+        if (!replaceFile(path, snapshot)) return false;
+        entry.snapshotBytes = snapshot.size();
+        entry.fileBytes = snapshot.size();
+    }
+    entry.fileTime = std::filesystem::last_write_time(path, ec);
+    entry.savedOffset = summary.csvOffset;
+    entry.changedSince = LLONG_MAX;
+    entry.dirty = false;
+    return true;
+}
+
+/**
+ * @brief Drops the least recently used summaries beyond kCachedSummaries.
+ *
+ * Summaries are saved as soon as they change, so dropping one loses nothing.
+ */
+void ReadingStore::trimCache() const {
+    if (cache.size() <= kCachedSummaries) return;
+    std::vector<unsigned long long> uses;
+    uses.reserve(cache.size());
+    for (const auto &cached : cache) uses.push_back(cached.second.lastUse);
+    std::size_t drop = cache.size() - kCachedSummaries;
+    std::nth_element(uses.begin(), uses.begin() + static_cast<std::ptrdiff_t>(drop), uses.end());
+    unsigned long long keepFrom = uses[drop];
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.lastUse < keepFrom) it = cache.erase(it);
+        else ++it;
+    }
+}
+
+/**
+ * @brief Loads the columnar copy of every reading, catching it up with any rows appended since it was saved.
+ * @param[out] columns The up-to-date columns.
+ * @return bool False if the CSV could not be read.
+ */
+bool ReadingStore::loadColumns(ReadingColumns &columns) const {
+    bool changed = false;
+    {
+        std::ifstream in(columnsPath(), std::ios::binary);
+        if (!in.is_open() || !columns.read(in)) {
+            columns.clear();
+            changed = true;
+        }
+    }
+
+    std::ifstream csv(csvPath, std::ios::binary | std::ios::ate);
+    if (!csv.is_open()) return false;
+    std::uint64_t size = static_cast<std::uint64_t>(csv.tellg());
+    if (size < columns.csvOffset) {
+        // The CSV was rewritten underneath us; start over.
+        columns.clear();
+        changed = true;
+    }
+    if (size > columns.csvOffset) {
+        std::string tail(static_cast<std::size_t>(size - columns.csvOffset), '\0');
+        csv.seekg(static_cast<std::streamoff>(columns.csvOffset));
+        csv.read(&tail[0], static_cast<std::streamsize>(tail.size()));
+        countCsvBytesScanned(tail.size());
+
+        // Only complete lines are consumed; a row still being written is picked up next time.
+        std::size_t lineStart = 0;
+        HeartRateReading reading;
+        std::string line;
+        while (true) {
+            std::size_t newline = tail.find('\n', lineStart);
+            if (newline == std::string::npos) break;
+            line.assign(tail, lineStart, newline - lineStart);
+            if (parseReadingLine(line, reading)) columns.append(reading);
+            lineStart = newline + 1;
+        }
+        columns.csvOffset += lineStart;
+        changed = true;
+    }
+    if (!changed) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(summaryDir, ec);
+    std::string path = columnsPath();
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            ErrorHandling::logErrorMessage("Failed to write " + tempPath);
+            return true;
+        }
+        columns.write(out);
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) ErrorHandling::logErrorMessage("Failed to replace " + path + ": " + ec.message());
+    return true;
+}
+
+/**
+ * @brief Writes a user's summary file as a fresh snapshot via a temporary file and rename.
+ * @param summary Summary to write.
+ * @return bool False if the file could not be written.
+ */
+bool ReadingStore::saveSummary(const UserSummary &summary) const {
+    std::error_code ec;
+    std::filesystem::create_directories(summaryDir, ec);
+    std::ostringstream text;
+    writeSnapshot(text, summary);
+    cache.erase(summary.user);
+    return replaceFile(summaryPath(summary.user), text.str());
+}
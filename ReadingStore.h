@@ -0,0 +1,292 @@
+#ifndef READINGSTORE_H
+#define READINGSTORE_H
+
+/**
+ * @file ReadingStore.h
+ * @brief Declaration of the ReadingStore class and the per-user summary it maintains.
+ *
+ * This header declares the single place where heart-rate readings are appended to userdata.csv. Every
+ * append also folds the new readings into a per-user summary file (rollup tiers, day histograms, the
+ * Holt-Winters forecast state, the change detector and other incrementally maintained state), so screens and
+ * analyses can read the summary instead of rescanning the whole CSV.
+ */
+
+#include "AnomalyDetector.h"
+#include "BpmHistogram.h"
+#include "HeartRateRollup.h"
+#include "HoltWinters.h"
+#include "PopulationStats.h"
+#include <climits>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ReadingColumns;
+
+/**
+ * @brief One heart-rate reading row of userdata.csv.
+ */
+struct HeartRateReading {
+    std::string user;           /**< Username the reading belongs to. */
+    long long timestamp = 0;    /**< Seconds since epoch. */
+    double bpm = 0.0;           /**< Heart rate in beats per minute. */
+    double spo2 = -1.0;         /**< Oxygen saturation in percent, or negative if the row has none. */
+};
+
+/**
+ * @brief Incrementally maintained state for one user.
+ */
+struct UserSummary {
+    std::string user;           /**< Username. */
+    long long csvOffset = 0;    /**< Bytes of userdata.csv already folded into this summary. */
+    HeartRateRollup rollup;     /**< Minute / hour / day rollup tiers. */
+    HoltWinters forecaster;     /**< Hourly forecast model, fed each hour bucket once it is complete. */
+    DailyHistograms histograms; /**< 1-BPM histogram per day, aligned to the rollup's day tier. */
+    long long populationDay = 0;    /**< Newest completed day whose average went into the population sketches. */
+    PatientDetector detector;   /**< EWMA / CUSUM change detector, fed every reading. */
+    ChangeEvent lastChange;     /**< Most recent change event (meaningful when changeCount > 0). */
+    long long changeCount = 0;  /**< Change events raised so far. */
+    long long latestTimestamp = 0;  /**< Timestamp of the newest reading (0 if none). */
+    double latestBpm = 0.0;         /**< Heart rate of the newest reading. */
+    double latestSpO2 = -1.0;       /**< SpO2 of the newest reading, or negative if it had none. */
+
+    /**
+     * @brief Folds one reading into every part of the summary.
+     * @param reading The reading (must belong to this user).
+     */
+    void addReading(const HeartRateReading &reading);
+
+    /**
+     * @brief Feeds the forecaster every completed hour bucket it has not seen yet.
+     *
+     * The newest hour bucket is still filling and is left for later. In steady state this touches one bucket.
+     */
+    void feedForecaster();
+};
+
+/**
+ * @class ReadingStore
+ * @brief Appends readings to userdata.csv and keeps per-user summaries in step with it.
+ *
+ * Each summary records the CSV byte offset it has consumed. Loading a summary catches it up by scanning only
+ * the bytes appended since then, so summaries stay correct even when other code paths append to the CSV.
+ *
+ * A store keeps the summaries it has touched in memory, so a long-lived store (the ingest server's) folds a
+ * batch straight into them instead of reading the summary and the CSV tail back. Saving appends a change
+ * record with just the buckets the new readings touched; the file is rewritten whole only once the records
+ * outgrow the snapshot in front of them. A summary file changed by another process is read again. The cache
+ * is not locked: a ReadingStore is used from one thread at a time.
+ */
+class ReadingStore {
+private:
+    /**
+     * @brief A summary held in memory, with what is needed to save only its changes.
+     */
+    struct CachedSummary {
+        UserSummary summary;                        /**< The summary. */
+        long long savedOffset = -1;                 /**< csvOffset as saved, or -1 if the file needs rewriting. */
+        long long changedSince = LLONG_MAX;         /**< Earliest reading folded in since the last save. */
+        bool dirty = false;                         /**< Anything changed since the last save. */
+        std::uintmax_t snapshotBytes = 0;           /**< Size of the snapshot at the front of the file. */
+        std::uintmax_t fileBytes = 0;               /**< Size of the file as this store last saw it. */
+        std::filesystem::file_time_type fileTime;   /**< Modification time of the file as last seen. */
+        unsigned long long lastUse = 0;             /**< Use counter value of the latest access. */
+    };
+
+    static const std::size_t kCachedSummaries = 256;   /**< Summaries kept in memory per store. */
+
+    std::string csvPath;        /**< Path of the reading CSV. */
+    std::string summaryDir;     /**< Directory holding one summary file per user. */
+    mutable std::unordered_map<std::string, CachedSummary> cache;  /**< Summaries by username. */
+    mutable unsigned long long useCounter = 0;                      /**< Ticks on every cache access. */
+
+    /**
+     * @brief Gets a user's cached summary, reading it from disk if it is not cached or the file has changed.
+     *
+     * Never evicts, so pointers to other entries stay valid; trimCache() does that.
+     *
+     * @param user Username.
+     * @return CachedSummary& The entry (an empty summary if there is no usable file).
+     */
+    CachedSummary &cachedSummary(const std::string &user) const;
+
+    /**
+     * @brief Reads a summary file: the snapshot, then every complete change record that follows on from it.
+     * @param user Username.
+     * @param[out] entry The entry to fill in.
+     * @return bool False if there is no usable snapshot.
+     */
+    bool readSummaryFile(const std::string &user, CachedSummary &entry) const;
+
+    /**
+     * @brief Folds in the rows appended to the CSV since the summary's offset.
+     * @param entry Cached summary.
+     * @return bool False if the CSV could not be read.
+     */
+    bool catchUp(CachedSummary &entry) const;
+
+    /**
+     * @brief Folds one reading into a cached summary and marks it dirty.
+     * @param entry Cached summary.
+     * @param reading The reading (must belong to the entry's user).
+     */
+    static void fold(CachedSummary &entry, const HeartRateReading &reading);
+
+    /**
+     * @brief Saves a dirty summary: a change record if the file on disk is the one last seen, else a snapshot.
+     * @param entry Cached summary.
+     * @return bool False if the file could not be written.
+     */
+    bool persist(CachedSummary &entry) const;
+
+    /**
+     * @brief Drops the least recently used summaries beyond kCachedSummaries.
+     */
+    void trimCache() const;
+
+public:
+    /**
+     * @brief Constructs a new ReadingStore object.
+     * @param csvFile Path of the reading CSV (registration and reading rows share this file).
+     * @param summaryDirectory Directory for per-user summary files.
+     */
+    explicit ReadingStore(const std::string &csvFile = "userdata.csv",
+                          const std::string &summaryDirectory = "summaries");
+
+    /**
+     * @brief Appends a batch of readings and updates the affected users' summaries and the population sketches.
+     *
+     * All rows are written with a single stream write, under the FileLock on "<csv>.lock" that every writer of
+     * the CSV takes; if the write fails the file is cut back to its previous length under the same lock, so
+     * rows other processes append are never lost. Every day that has completed for an affected user is
+     * added to the per-user daily average sketch once, and the caller's own sketches (for example vitals by
+     * risk tier and age group) are merged in, so the population file is rewritten once per batch.
+     *
+     * @param batch Readings to append.
+     * @param extra Additional population samples gathered with the batch.
+     * @return bool False if the CSV could not be written.
+     */
+    bool append(const std::vector<HeartRateReading> &batch, const PopulationStats &extra = PopulationStats());
+
+    /**
+     * @brief Appends a batch of readings held in a plain array, e.g. the slots of a ReadingBatchParser.
+     *
+     * Behaves exactly like the vector overload: the rows go to the CSV in one write, then the summaries and
+     * population sketches are updated once for the whole batch.
+     *
+     * @param batch First reading.
+     * @param count Number of readings.
+     * @param extra Additional population samples gathered with the batch.
+     * @return bool False if the CSV could not be written.
+     */
+    bool append(const HeartRateReading *batch, std::size_t count, const PopulationStats &extra = PopulationStats());
+
+    /**
+     * @brief Loads the population sketches.
+     * @param[out] population The sketches (empty if none were saved yet).
+     * @return bool False if the file is malformed.
+     */
+    bool loadPopulation(PopulationStats &population) const;
+
+    /** @return std::string Path of the population sketch file. */
+    std::string populationPath() const { return summaryDir + "/population.sketch"; }
+
+    /**
+     * @brief Loads a user's summary, catching it up with any rows appended since it was last saved.
+     *
+     * A missing or unreadable summary is rebuilt from the whole CSV. If catching up changed anything the
+     * change is saved back.
+     *
+     * @param user Username.
+     * @param[out] summary The up-to-date summary.
+     * @return bool False if the CSV could not be read.
+     */
+    bool loadSummary(const std::string &user, UserSummary &summary) const;
+
+    /**
+     * @brief Reads a user's summary and catches it up in memory only.
+     *
+     * Nothing is written and the cache is left alone, so read-only callers such as queries have no side
+     * effects. A missing summary costs a scan of the whole CSV every time; loadSummary() saves that work.
+     *
+     * @param user Username.
+     * @param[out] summary The up-to-date summary.
+     * @return bool False if the CSV could not be read.
+     */
+    bool readSummary(const std::string &user, UserSummary &summary) const;
+
+    /**
+     * @brief Estimates how much reading a user's summary would parse, from file sizes and its header alone.
+     * @param user Username.
+     * @return std::uintmax_t Bytes of summary file plus bytes of CSV it has not folded in (the whole CSV if
+     *         the summary is missing or in another layout).
+     */
+    std::uintmax_t summaryReadBytes(const std::string &user) const;
+
+    /**
+     * @brief Estimates how much loadColumns() would read, from file sizes and the column file's header alone.
+     * @param[out] columnBytes Size of the column file.
+     * @param[out] csvBytes Bytes of CSV not folded into it (the whole CSV if it is missing or unreadable).
+     */
+    void columnsReadBytes(std::uintmax_t &columnBytes, std::uintmax_t &csvBytes) const;
+
+    /**
+     * @brief Loads the columnar copy of every reading, catching it up with any rows appended since it was saved.
+     *
+     * A missing or unreadable file is rebuilt from the whole CSV. If catching up changed anything the file is
+     * saved back.
+     *
+     * @param[out] columns The up-to-date columns.
+     * @return bool False if the CSV could not be read.
+     */
+    bool loadColumns(ReadingColumns &columns) const;
+
+    /** @return std::string Path of the columnar reading file. */
+    std::string columnsPath() const { return summaryDir + "/readings.columns"; }
+
+    /**
+     * @brief Writes a user's summary file as a fresh snapshot, replacing any change records.
+     * @param summary Summary to write.
+     * @return bool False if the file could not be written.
+     */
+    bool saveSummary(const UserSummary &summary) const;
+
+    /**
+     * @brief Gets the path of a user's summary file.
+     * @param user Username (characters unsafe in file names are escaped).
+     * @return std::string Summary file path.
+     */
+    std::string summaryPath(const std::string &user) const;
+
+    /** @return const std::string& Path of the reading CSV. */
+    const std::string& getCsvPath() const { return csvPath; }
+
+    /**
+     * @brief Parses a reading row ("username,timestamp,BPM" with an optional trailing SpO2 column).
+     * @param line CSV line without the newline.
+     * @param[out] reading Parsed reading.
+     * @return bool False for registration rows, the header and malformed rows.
+     */
+    static bool parseReadingLine(const std::string &line, HeartRateReading &reading);
+
+    /**
+     * @brief Formats a reading as a CSV row (without the newline).
+     * @param reading Reading to format.
+     * @return std::string CSV row.
+     */
+    static std::string formatReadingLine(const HeartRateReading &reading);
+
+    /**
+     * @brief Adds to the count of reading CSV bytes read (heartpi_csv_bytes_scanned_total).
+     *
+     * Every scan of the CSV, whether a catch-up here or a full-file read elsewhere, is counted through this,
+     * so the metric shows what the file costs to read.
+     *
+     * @param bytes Bytes read.
+     */
+    static void countCsvBytesScanned(std::uint64_t bytes);
+};
+
+#endif // READINGSTORE_H
@@ -0,0 +1,305 @@
+/**
+ * @file RiskModel.cpp
+ * @brief Implements the RiskFeatures encoding and LogisticRiskModel scoring and persistence.
+ *
+ * Model file format (text): "HeartPiRiskModel,1", "bias,<b>", "thresholds,<moderate>,<high>", then
+ * "weights," followed by the RiskFeatures::kUsed coefficients in column order.
+ */
+
+#include "RiskModel.h"
+#include "ErrorHandling.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RISKMODEL_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RISKMODEL_NEON
+#endif
+
+namespace {
+
+const char *kModelMagic = "HeartPiRiskModel,1";
+
+// First column of each answer group.
+const int kAgeColumn = 0;
+const int kMaleColumn = 6;
+const int kSleepColumn = 7;
+const int kExerciseColumn = 12;
+const int kHistoryColumn = 16;
+const int kDietColumn = 20;
+const int kSmokerColumn = 26;
+
+/**
+ * @brief Logistic function.
+ * @param z Log-odds.
+ * @return double Probability.
+ */
+double logistic(double z) {
+    return 1.0 / (1.0 + std::exp(-z));
+}
+
+} // namespace
+
+/**
+ * @brief Encodes raw survey answers.
+ * @param ageGroup 1-6.
+ * @param male Gender.
+ * @param sleepHours 1-5.
+ * @param exerciseFrequency 1-4.
+ * @param familyHistory Disease bits.
+ * @param dietType 1-6.
+ * @param smoker Smoking status.
+ * @param[out] row kWidth floats.
+ */
+void RiskFeatures::encode(int ageGroup, bool male, int sleepHours, int exerciseFrequency, unsigned familyHistory,
+                          int dietType, bool smoker, float *row) {
+    std::memset(row, 0, sizeof(float) * kWidth);
+    if (ageGroup >= 1 && ageGroup <= 6) row[kAgeColumn + ageGroup - 1] = 1.0f;
+    row[kMaleColumn] = male ? 1.0f : 0.0f;
+    if (sleepHours >= 1 && sleepHours <= 5) row[kSleepColumn + sleepHours - 1] = 1.0f;
+    if (exerciseFrequency >= 1 && exerciseFrequency <= 4) row[kExerciseColumn + exerciseFrequency - 1] = 1.0f;
+    for (int i = 0; i < 4; ++i)
+        if (familyHistory & (1u << i)) row[kHistoryColumn + i] = 1.0f;
+    if (dietType >= 1 && dietType <= 6) row[kDietColumn + dietType - 1] = 1.0f;
+    row[kSmokerColumn] = smoker ? 1.0f : 0.0f;
+}
+
+/**
+ * @brief Encodes a FamilyHealth object.
+ * @param family Survey answers.
+ * @param[out] row kWidth floats.
+ */
+void RiskFeatures::encode(const FamilyHealth &family, float *row) {
+    unsigned history = 0;
+    for (int i = 0; i < 4; ++i)
+        if (family.hasFamilyDisease(i)) history |= 1u << i;
+    encode(family.getAgeGroup(), family.getGender(), family.getSleepHours(), family.getExerciseFrequency(),
+           history, family.getDietType(), family.getIsSmoker(), row);
+}
+
+/**
+ * @brief Gets a readable name for a feature column.
+ * @param column Column index.
+ * @return std::string Feature name.
+ */
+std::string RiskFeatures::name(int column) {
+    static const char *ages[] = { "18-24", "25-34", "35-44", "45-54", "55-64", "65+" };
+    static const char *histories[] = { "cad", "diabetes", "cholesterol", "bp" };
+    static const char *diets[] = { "highprotein", "lowcarb", "vegetarian", "western", "vegan", "balanced" };
+    if (column < kMaleColumn) return std::string("age=") + ages[column - kAgeColumn];
+    if (column == kMaleColumn) return "gender=male";
+    if (column < kExerciseColumn) return "sleep=" + std::to_string(column - kSleepColumn + 1);
+    if (column < kHistoryColumn) return "exercise=" + std::to_string(column - kExerciseColumn + 1);
+    if (column < kDietColumn) return std::string("history=") + histories[column - kHistoryColumn];
+    if (column < kSmokerColumn) return std::string("diet=") + diets[column - kDietColumn];
+    if (column == kSmokerColumn) return "smoker=yes";
+    return "";
+}
+
+/**
+ * @brief Constructs an untrained model.
+ */
+LogisticRiskModel::LogisticRiskModel() {
+    std::memset(weights, 0, sizeof(weights));
+}
+
+/**
+ * @brief Dot product of two kWidth rows.
+ * @param a First row.
+ * @param b Second row.
+ * @return float Dot product.
+ */
+float LogisticRiskModel::dot(const float *a, const float *b) {
+#if defined(RISKMODEL_SSE)
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    for (int i = 0; i < RiskFeatures::kWidth; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 sum = _mm_add_ps(sum0, sum1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#elif defined(RISKMODEL_NEON)
+    float32x4_t sum0 = vdupq_n_f32(0.0f), sum1 = vdupq_n_f32(0.0f);
+    for (int i = 0; i < RiskFeatures::kWidth; i += 8) {
+        sum0 = vmlaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+        sum1 = vmlaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t sum = vaddq_f32(sum0, sum1);
+    float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(half, half), 0);
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < RiskFeatures::kWidth; ++i) sum += a[i] * b[i];
+    return sum;
+#endif
+}
+
+/**
+ * @brief Adds scale * x to y.
+ * @param scale Multiplier.
+ * @param x Row to add.
+ * @param[in,out] y Accumulator row.
+ */
+void LogisticRiskModel::axpy(float scale, const float *x, float *y) {
+#if defined(RISKMODEL_SSE)
+    __m128 s = _mm_set1_ps(scale);
+    for (int i = 0; i < RiskFeatures::kWidth; i += 4)
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(s, _mm_loadu_ps(x + i))));
+#elif defined(RISKMODEL_NEON)
+    for (int i = 0; i < RiskFeatures::kWidth; i += 4)
+        vst1q_f32(y + i, vmlaq_n_f32(vld1q_f32(y + i), vld1q_f32(x + i), scale));
+#else
+    for (int i = 0; i < RiskFeatures::kWidth; ++i) y[i] += scale * x[i];
+#endif
+}
+
+/**
+ * @brief Scores one encoded row.
+ * @param row kWidth floats.
+ * @return double Probability.
+ */
+double LogisticRiskModel::probability(const float *row) const {
+    return logistic(static_cast<double>(dot(weights, row)) + bias);
+}
+
+/**
+ * @brief Scores a FamilyHealth object.
+ * @param family Survey answers.
+ * @return double Probability.
+ */
+double LogisticRiskModel::probability(const FamilyHealth &family) const {
+    alignas(16) float row[RiskFeatures::kWidth];
+    RiskFeatures::encode(family, row);
+    return probability(row);
+}
+
+/**
+ * @brief Scores many encoded rows.
+ * @param rows Rows back to back.
+ * @param count Number of rows.
+ * @param[out] probabilities Probabilities.
+ */
+void LogisticRiskModel::scoreBatch(const float *rows, std::size_t count, float *probabilities) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        float z = dot(weights, rows + i * RiskFeatures::kWidth) + bias;
+        probabilities[i] = 1.0f / (1.0f + std::exp(-z));
+    }
+}
+
+/**
+ * @brief Maps a probability to a tier.
+ * @param probability Probability.
+ * @return int 0: Low, 1: Moderate, 2: High.
+ */
+int LogisticRiskModel::tierOf(double probability) const {
+    if (probability >= highThreshold) return 2;
+    if (probability >= moderateThreshold) return 1;
+    return 0;
+}
+
+/**
+ * @brief Sets the tier cut-offs.
+ * @param moderate Lowest Moderate probability.
+ * @param high Lowest High probability.
+ */
+void LogisticRiskModel::setThresholds(double moderate, double high) {
+    moderateThreshold = moderate;
+    highThreshold = high;
+}
+
+/**
+ * @brief Saves the model as text.
+ * @param path File path.
+ * @return bool False if the file could not be written.
+ */
+bool LogisticRiskModel::save(const std::string &path) const {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out.is_open()) {
+            ErrorHandling::logErrorMessage("Failed to write risk model " + tempPath);
+            return false;
+        }
+        out.precision(9);
+        out << kModelMagic << "\n";
+        out << "bias," << bias << "\n";
+        out << "thresholds," << moderateThreshold << "," << highThreshold << "\n";
+        out << "weights";
+        for (int i = 0; i < RiskFeatures::kUsed; ++i) out << "," << weights[i];
+        out << "\n";
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        ErrorHandling::logErrorMessage("Failed to replace risk model " + path + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Loads a model written by save().
+ * @param path File path.
+ * @return bool False if the file is missing or malformed.
+ */
+bool LogisticRiskModel::load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    std::string line;
+    if (!std::getline(in, line) || line != kModelMagic) {
+        ErrorHandling::logErrorMessage("Not a risk model file: " + path);
+        return false;
+    }
+
+    LogisticRiskModel loaded;
+    bool haveWeights = false;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key, value;
+        std::getline(fields, key, ',');
+        if (key == "bias" && std::getline(fields, value, ',')) {
+            loaded.bias = std::strtof(value.c_str(), nullptr);
+        } else if (key == "thresholds") {
+            std::string high;
+            if (std::getline(fields, value, ',') && std::getline(fields, high, ','))
+                loaded.setThresholds(std::strtod(value.c_str(), nullptr), std::strtod(high.c_str(), nullptr));
+        } else if (key == "weights") {
+            int i = 0;
+            while (i < RiskFeatures::kUsed && std::getline(fields, value, ','))
+                loaded.weights[i++] = std::strtof(value.c_str(), nullptr);
+            haveWeights = i == RiskFeatures::kUsed;
+        }
+    }
+    if (!haveWeights) {
+        ErrorHandling::logErrorMessage("Risk model has no complete weights: " + path);
+        return false;
+    }
+    *this = loaded;
+    return true;
+}
+
+/**
+ * @brief Gets the model named by HEARTPI_RISK_MODEL.
+ * @return const LogisticRiskModel* The model, or nullptr if none is configured or it failed to load.
+ */
+const LogisticRiskModel* LogisticRiskModel::installed() {
+    static LogisticRiskModel model;
+    static const bool loaded = []() {
+        const char *path = std::getenv("HEARTPI_RISK_MODEL");
+        if (!path || !*path) return false;
+        if (model.load(path)) return true;
+        ErrorHandling::logErrorMessage(std::string("HEARTPI_RISK_MODEL names an unusable model: ") + path +
+                                       "; using the point score");
+        return false;
+    }();
+    return loaded ? &model : nullptr;
+}
@@ -0,0 +1,174 @@
+#ifndef RISKMODEL_H
+#define RISKMODEL_H
+
+/**
+ * @file RiskModel.h
+ * @brief Declaration of the RiskFeatures encoding and the LogisticRiskModel scorer.
+ *
+ * This header declares a logistic-regression alternative to the additive point system in assessHeartHealth().
+ * Survey answers are one-hot encoded into a fixed-width float row, and the model's probability is the
+ * logistic of one dot product, so scoring a batch of profiles is a tight SIMD loop. Coefficients come from
+ * RiskModelTrainer and are stored in a small text file.
+ */
+
+#include "FamilyHealth.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief One-hot encoding of survey answers into a padded float row.
+ *
+ * Layout: age group 1-6 (6), male (1), sleep 1-5 (5), exercise 1-4 (4), family history bits (4), diet 1-6 (6),
+ * smoker (1), then zero padding to kWidth so rows stay a whole number of SIMD vectors.
+ */
+struct RiskFeatures {
+    static const int kUsed = 27;    /**< Encoded features. */
+    static const int kWidth = 32;   /**< Row width including padding. */
+
+    /**
+     * @brief Encodes raw survey answers.
+     * @param ageGroup 1-6.
+     * @param male Gender assigned at birth.
+     * @param sleepHours 1-5.
+     * @param exerciseFrequency 1-4.
+     * @param familyHistory Bit i set if FamilyHealth disease i runs in the family.
+     * @param dietType 1-6.
+     * @param smoker Smoking status.
+     * @param[out] row kWidth floats.
+     */
+    static void encode(int ageGroup, bool male, int sleepHours, int exerciseFrequency, unsigned familyHistory,
+                       int dietType, bool smoker, float *row);
+
+    /**
+     * @brief Encodes a FamilyHealth object.
+     * @param family Survey answers.
+     * @param[out] row kWidth floats.
+     */
+    static void encode(const FamilyHealth &family, float *row);
+
+    /**
+     * @brief Gets a readable name for a feature column.
+     * @param column Column index.
+     * @return std::string Name such as "age=45-54" (empty for padding).
+     */
+    static std::string name(int column);
+};
+
+/**
+ * @class LogisticRiskModel
+ * @brief Calibrated probability of heart disease from survey answers, with tier cut-offs.
+ */
+class LogisticRiskModel {
+public:
+    /**
+     * @brief Constructs an untrained model (all weights zero).
+     */
+    LogisticRiskModel();
+
+    /**
+     * @brief Scores one encoded row.
+     * @param row kWidth floats from RiskFeatures::encode().
+     * @return double Probability in (0, 1).
+     */
+    double probability(const float *row) const;
+
+    /**
+     * @brief Scores a FamilyHealth object.
+     * @param family Survey answers.
+     * @return double Probability in (0, 1).
+     */
+    double probability(const FamilyHealth &family) const;
+
+    /**
+     * @brief Scores many encoded rows.
+     * @param rows count rows of kWidth floats, back to back.
+     * @param count Number of rows.
+     * @param[out] probabilities count probabilities.
+     */
+    void scoreBatch(const float *rows, std::size_t count, float *probabilities) const;
+
+    /**
+     * @brief Maps a probability to a tier using the model's cut-offs.
+     * @param probability Probability.
+     * @return int 0: Low, 1: Moderate, 2: High.
+     */
+    int tierOf(double probability) const;
+
+    /**
+     * @brief Sets the tier cut-offs.
+     * @param moderate Lowest Moderate probability.
+     * @param high Lowest High probability.
+     */
+    void setThresholds(double moderate, double high);
+
+    /** @return double Lowest Moderate probability. */
+    double getModerateThreshold() const { return moderateThreshold; }
+
+    /** @return double Lowest High probability. */
+    double getHighThreshold() const { return highThreshold; }
+
+    /** @return const float* kWidth weights (padding weights are zero). */
+    const float* getWeights() const { return weights; }
+
+    /** @return float* Mutable weights, for the trainer. */
+    float* mutableWeights() { return weights; }
+
+    /** @return float Intercept. */
+    float getBias() const { return bias; }
+
+    /**
+     * @brief Sets the intercept.
+     * @param value Intercept.
+     */
+    void setBias(float value) { bias = value; }
+
+    /**
+     * @brief Saves the model as text via a temporary file and rename.
+     * @param path File path.
+     * @return bool False if the file could not be written.
+     */
+    bool save(const std::string &path) const;
+
+    /**
+     * @brief Loads a model written by save().
+     * @param path File path.
+     * @return bool False if the file is missing or malformed (the model is left untouched).
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief Gets the model the application scores surveys with, loading it on first use.
+     *
+     * The model is opted into explicitly: HEARTPI_RISK_MODEL names the model file (e.g. the risk_model.txt
+     * written by tools/riskmodel). When it is unset or empty the point score is used, whatever files lie
+     * around. A model that is named but cannot be loaded is logged and the point score is used. Every screen
+     * shares this one instance, so the file is read once per run.
+     *
+     * @return const LogisticRiskModel* The model, or nullptr if none is configured (use the point score).
+     */
+    static const LogisticRiskModel* installed();
+
+    /**
+     * @brief Dot product of two kWidth rows using SSE or NEON where available.
+     * @param a First row.
+     * @param b Second row.
+     * @return float Dot product.
+     */
+    static float dot(const float *a, const float *b);
+
+    /**
+     * @brief Adds scale * x to y for kWidth rows using SSE or NEON where available.
+     * @param scale Multiplier.
+     * @param x Row to add.
+     * @param[in,out] y Accumulator row.
+     */
+    static void axpy(float scale, const float *x, float *y);
+
+private:
+    alignas(16) float weights[RiskFeatures::kWidth];   /**< Coefficient per feature column. */
+    float bias = 0.0f;                                  /**< Intercept. */
+    double moderateThreshold = 0.10;                    /**< Lowest Moderate probability. */
+    double highThreshold = 0.20;                        /**< Lowest High probability. */
+};
+
+#endif // RISKMODEL_H
@@ -0,0 +1,313 @@
+/**
+ * @file RiskModelTrainer.cpp
+ * @brief Implements cohort loading and simulation, parallel mini-batch training and model evaluation.
+ */
+
+#include "RiskModelTrainer.h"
+#include "Calculations.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Fixed set of threads that run one task per worker index and wait for all of them to finish.
+ *
+ * Mini-batches are only a few milliseconds of work, so threads are kept alive across batches instead of
+ * being started for each one. The calling thread acts as worker 0.
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned count) : workerCount(std::max(1u, count)) {
+        for (unsigned i = 1; i < workerCount; ++i) threads.emplace_back([this, i] { loop(i); });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            ++generation;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads) thread.join();
+    }
+
+    unsigned size() const { return workerCount; }
+
+    /**
+     * @brief Runs task(i) for every worker index i and returns when all have finished.
+     * @param task Task to run.
+     */
+    void run(const std::function<void(unsigned)> &task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &task;
+            pending = workerCount - 1;
+            ++generation;
+        }
+        wake.notify_all();
+        task(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    unsigned workerCount;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(unsigned)> *current = nullptr;
+    unsigned long long generation = 0;
+    unsigned pending = 0;
+    bool stopping = false;
+
+    void loop(unsigned index) {
+        unsigned long long seen = 0;
+        while (true) {
+            const std::function<void(unsigned)> *task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                if (stopping) return;
+                task = current;
+            }
+            (*task)(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pending == 0) done.notify_one();
+            }
+        }
+    }
+};
+
+/**
+ * @brief Partial gradient of one worker, padded to its own cache lines.
+ */
+struct alignas(64) PartialGradient {
+    float weights[RiskFeatures::kWidth];
+    double bias;
+};
+
+} // namespace
+
+/**
+ * @brief Appends one subject.
+ * @param row Encoded row.
+ * @param outcome Outcome.
+ */
+void RiskCohort::add(const float *row, bool outcome) {
+    features.insert(features.end(), row, row + RiskFeatures::kWidth);
+    outcomes.push_back(outcome ? 1.0f : 0.0f);
+}
+
+/**
+ * @brief Appends simulated subjects.
+ * @param count Number of subjects.
+ * @param seed Random seed.
+ */
+void RiskCohort::simulate(std::size_t count, std::uint32_t seed) {
+    // logit(p) = kIntercept + kSlope * score, with p(10) = 0.10 and p(18) = 0.20.
+    const double kSlope = (std::log(0.2 / 0.8) - std::log(0.1 / 0.9)) / 8.0;
+    const double kIntercept = std::log(0.1 / 0.9) - 10.0 * kSlope;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    features.reserve(features.size() + count * RiskFeatures::kWidth);
+    outcomes.reserve(outcomes.size() + count);
+    float row[RiskFeatures::kWidth];
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t r = rng();
+        int ageGroup = 1 + static_cast<int>(r % 6);
+        bool male = (r >> 3) & 1u;
+        int sleepHours = 1 + static_cast<int>((r >> 4) % 5);
+        int exerciseFrequency = 1 + static_cast<int>((r >> 8) % 4);
+        unsigned familyHistory = (r >> 10) & 15u;
+        int dietType = 1 + static_cast<int>((r >> 14) % 6);
+        bool smoker = (r >> 18) & 1u;
+
+        int score = computeRiskScore(ageGroup, male, sleepHours, exerciseFrequency, familyHistory, dietType, smoker);
+        double probability = 1.0 / (1.0 + std::exp(-(kIntercept + kSlope * score)));
+        RiskFeatures::encode(ageGroup, male, sleepHours, exerciseFrequency, familyHistory, dietType, smoker, row);
+        add(row, unit(rng) < probability);
+    }
+}
+
+/**
+ * @brief Appends subjects from a CSV file.
+ * @param path CSV path.
+ * @return bool False if the file could not be opened.
+ */
+bool RiskCohort::loadCsv(const std::string &path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        ErrorHandling::logErrorMessage("Failed to open cohort file " + path);
+        return false;
+    }
+    std::string line;
+    float row[RiskFeatures::kWidth];
+    while (std::getline(in, line)) {
+        long values[8];
+        const char *p = line.c_str();
+        char *end = nullptr;
+        bool ok = true;
+        for (int i = 0; i < 8 && ok; ++i) {
+            values[i] = std::strtol(p, &end, 10);
+            ok = end != p && (i == 7 ? (*end == '\0' || *end == '\r') : *end == ',');
+            p = end + 1;
+        }
+        if (!ok) continue;
+        RiskFeatures::encode(static_cast<int>(values[0]), values[1] != 0, static_cast<int>(values[2]),
+                             static_cast<int>(values[3]), static_cast<unsigned>(values[4]),
+                             static_cast<int>(values[5]), values[6] != 0, row);
+        add(row, values[7] != 0);
+    }
+    return true;
+}
+
+/**
+ * @brief Shuffles the subjects.
+ * @param seed Random seed.
+ */
+void RiskCohort::shuffle(std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    const std::size_t width = RiskFeatures::kWidth;
+    for (std::size_t i = size(); i > 1; --i) {
+        std::size_t j = std::uniform_int_distribution<std::size_t>(0, i - 1)(rng);
+        if (j == i - 1) continue;
+        std::swap_ranges(features.begin() + static_cast<std::ptrdiff_t>((i - 1) * width),
+                         features.begin() + static_cast<std::ptrdiff_t>(i * width),
+                         features.begin() + static_cast<std::ptrdiff_t>(j * width));
+        std::swap(outcomes[i - 1], outcomes[j]);
+    }
+}
+
+/**
+ * @brief Splits off the last part of the cohort as a holdout set.
+ * @param fraction Share of subjects to move.
+ * @return RiskCohort The holdout subjects.
+ */
+RiskCohort RiskCohort::splitHoldout(double fraction) {
+    std::size_t keep = size() - static_cast<std::size_t>(size() * std::min(std::max(fraction, 0.0), 1.0));
+    RiskCohort holdout;
+    holdout.features.assign(features.begin() + static_cast<std::ptrdiff_t>(keep * RiskFeatures::kWidth),
+                            features.end());
+    holdout.outcomes.assign(outcomes.begin() + static_cast<std::ptrdiff_t>(keep), outcomes.end());
+    features.resize(keep * RiskFeatures::kWidth);
+    outcomes.resize(keep);
+    return holdout;
+}
+
+/**
+ * @brief Constructs a trainer.
+ * @param options Training settings.
+ */
+RiskModelTrainer::RiskModelTrainer(const TrainingOptions &options) : options(options) {}
+
+/**
+ * @brief Fits a model by mini-batch gradient descent.
+ * @param cohort Training subjects.
+ * @param[in,out] model Model to train.
+ * @return double Training log loss.
+ */
+double RiskModelTrainer::train(const RiskCohort &cohort, LogisticRiskModel &model) const {
+    if (cohort.size() == 0) return 0.0;
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    WorkerPool pool(threads);
+    std::vector<PartialGradient> partials(pool.size());
+
+    const std::size_t width = RiskFeatures::kWidth;
+    const std::size_t batchSize = std::max<std::size_t>(1, options.batchSize);
+    double velocity[RiskFeatures::kWidth + 1] = {};
+    float *weights = model.mutableWeights();
+
+    for (int epoch = 0; epoch < options.epochs; ++epoch) {
+        for (std::size_t start = 0; start < cohort.size(); start += batchSize) {
+            std::size_t end = std::min(cohort.size(), start + batchSize);
+            std::size_t rowsPerWorker = (end - start + pool.size() - 1) / pool.size();
+            const float bias = model.getBias();
+
+            pool.run([&](unsigned worker) {
+                PartialGradient &partial = partials[worker];
+                std::fill(partial.weights, partial.weights + width, 0.0f);
+                partial.bias = 0.0;
+                std::size_t from = start + worker * rowsPerWorker;
+                std::size_t to = std::min(end, from + rowsPerWorker);
+                for (std::size_t i = from; i < to; ++i) {
+                    const float *row = cohort.rows() + i * width;
+                    float z = LogisticRiskModel::dot(weights, row) + bias;
+                    float error = 1.0f / (1.0f + std::exp(-z)) - cohort.labels()[i];
+                    LogisticRiskModel::axpy(error, row, partial.weights);
+                    partial.bias += error;
+                }
+            });
+
+            double scale = 1.0 / static_cast<double>(end - start);
+            for (std::size_t k = 0; k <= width; ++k) {
+                double gradient = 0.0;
+                for (const PartialGradient &partial : partials)
+                    gradient += k < width ? partial.weights[k] : partial.bias;
+                gradient *= scale;
+                if (k < width) gradient += options.l2 * weights[k];
+                velocity[k] = options.momentum * velocity[k] - options.learningRate * gradient;
+                if (k < width)
+                    weights[k] += static_cast<float>(velocity[k]);
+                else
+                    model.setBias(model.getBias() + static_cast<float>(velocity[k]));
+            }
+        }
+    }
+    return evaluate(model, cohort, 1).logLoss;
+}
+
+/**
+ * @brief Measures log loss, Brier score and calibration.
+ * @param model Model.
+ * @param cohort Subjects.
+ * @param binCount Number of bins.
+ * @return ModelEvaluation The report.
+ */
+ModelEvaluation RiskModelTrainer::evaluate(const LogisticRiskModel &model, const RiskCohort &cohort,
+                                           int binCount) {
+    ModelEvaluation result;
+    binCount = std::max(1, binCount);
+    result.bins.resize(static_cast<std::size_t>(binCount));
+    if (cohort.size() == 0) return result;
+
+    const std::size_t chunk = 4096;
+    std::vector<float> probabilities(chunk);
+    double logLoss = 0.0, brier = 0.0;
+    for (std::size_t start = 0; start < cohort.size(); start += chunk) {
+        std::size_t count = std::min(chunk, cohort.size() - start);
+        model.scoreBatch(cohort.rows() + start * RiskFeatures::kWidth, count, probabilities.data());
+        for (std::size_t i = 0; i < count; ++i) {
+            double p = std::min(std::max(static_cast<double>(probabilities[i]), 1e-7), 1.0 - 1e-7);
+            double y = cohort.labels()[start + i];
+            logLoss -= y * std::log(p) + (1.0 - y) * std::log(1.0 - p);
+            brier += (p - y) * (p - y);
+            CalibrationBin &bin = result.bins[std::min(static_cast<std::size_t>(p * binCount),
+                                                       static_cast<std::size_t>(binCount - 1))];
+            bin.predicted += p;
+            bin.observed += y;
+            ++bin.count;
+        }
+    }
+    double n = static_cast<double>(cohort.size());
+    result.logLoss = logLoss / n;
+    result.brierScore = brier / n;
+    for (CalibrationBin &bin : result.bins) {
+        if (bin.count == 0) continue;
+        bin.predicted /= bin.count;
+        bin.observed /= bin.count;
+        result.calibrationError += std::abs(bin.predicted - bin.observed) * bin.count / n;
+    }
+    return result;
+}
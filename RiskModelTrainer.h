@@ -0,0 +1,150 @@
+#ifndef RISKMODELTRAINER_H
+#define RISKMODELTRAINER_H
+
+/**
+ * @file RiskModelTrainer.h
+ * @brief Declaration of the RiskCohort training set and the RiskModelTrainer for LogisticRiskModel.
+ *
+ * This header declares the offline side of the logistic risk model: cohorts of encoded survey answers with a
+ * 0/1 outcome (simulated, or imported from CSV), a multithreaded mini-batch gradient-descent trainer, and the
+ * calibration report used to check that predicted probabilities match observed outcome rates.
+ */
+
+#include "RiskModel.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class RiskCohort
+ * @brief Encoded survey rows (RiskFeatures::kWidth floats each) with their outcomes.
+ */
+class RiskCohort {
+public:
+    /**
+     * @brief Appends one subject.
+     * @param row kWidth floats from RiskFeatures::encode().
+     * @param outcome True if the subject developed heart disease.
+     */
+    void add(const float *row, bool outcome);
+
+    /**
+     * @brief Appends simulated subjects.
+     *
+     * Answers are drawn uniformly from the survey options and each outcome is drawn from a logistic function of
+     * the existing point score, scaled so a score of 10 (the Moderate cut-off) gives a 10% probability and 18
+     * (the High cut-off) gives 20%. A model trained on such a cohort reproduces the point system's tiers with
+     * the default thresholds, which makes it a sanity check for the trainer.
+     *
+     * @param count Number of subjects.
+     * @param seed Random seed.
+     */
+    void simulate(std::size_t count, std::uint32_t seed);
+
+    /**
+     * @brief Appends subjects from a CSV file.
+     *
+     * Rows are "ageGroup,gender,sleepHours,exercise,familyHistoryBits,diet,smoker,outcome" with gender, smoker
+     * and outcome as 0/1; a header row and malformed rows are skipped.
+     *
+     * @param path CSV path.
+     * @return bool False if the file could not be opened.
+     */
+    bool loadCsv(const std::string &path);
+
+    /**
+     * @brief Shuffles the subjects so contiguous mini-batches are random samples.
+     * @param seed Random seed.
+     */
+    void shuffle(std::uint32_t seed);
+
+    /**
+     * @brief Splits off the last part of the cohort (after shuffling) as a holdout set.
+     * @param fraction Share of subjects to move, in (0, 1).
+     * @return RiskCohort The holdout subjects.
+     */
+    RiskCohort splitHoldout(double fraction);
+
+    /** @return std::size_t Number of subjects. */
+    std::size_t size() const { return outcomes.size(); }
+
+    /** @return const float* Rows back to back. */
+    const float* rows() const { return features.data(); }
+
+    /** @return const float* Outcome per subject (0 or 1). */
+    const float* labels() const { return outcomes.data(); }
+
+private:
+    std::vector<float> features;    /**< size() rows of RiskFeatures::kWidth floats. */
+    std::vector<float> outcomes;    /**< 0 or 1 per subject. */
+};
+
+/**
+ * @brief Mini-batch gradient descent settings.
+ */
+struct TrainingOptions {
+    int epochs = 10;                    /**< Passes over the cohort. */
+    std::size_t batchSize = 8192;       /**< Subjects per gradient step. */
+    double learningRate = 0.5;          /**< Step size. */
+    double momentum = 0.9;              /**< Heavy-ball momentum. */
+    double l2 = 1e-5;                   /**< L2 penalty on the weights (not the intercept). */
+    unsigned threads = 0;               /**< Worker threads (0: one per core). */
+};
+
+/**
+ * @brief One calibration bin: subjects whose predicted probability fell in the bin.
+ */
+struct CalibrationBin {
+    double predicted = 0.0;     /**< Mean predicted probability. */
+    double observed = 0.0;      /**< Observed outcome rate. */
+    std::size_t count = 0;      /**< Subjects in the bin. */
+};
+
+/**
+ * @brief Quality of a model on a cohort.
+ */
+struct ModelEvaluation {
+    double logLoss = 0.0;                   /**< Mean negative log-likelihood. */
+    double brierScore = 0.0;                /**< Mean squared error of the probabilities. */
+    double calibrationError = 0.0;          /**< Count-weighted mean |predicted - observed| over the bins. */
+    std::vector<CalibrationBin> bins;       /**< Equal-width probability bins. */
+};
+
+/**
+ * @class RiskModelTrainer
+ * @brief Fits a LogisticRiskModel by mini-batch gradient descent across all cores.
+ *
+ * Each mini-batch is split between persistent worker threads; every worker accumulates its part of the
+ * gradient with SIMD dot products and axpy updates, and the partial gradients are summed before the step.
+ */
+class RiskModelTrainer {
+public:
+    /**
+     * @brief Constructs a trainer.
+     * @param options Training settings.
+     */
+    explicit RiskModelTrainer(const TrainingOptions &options = TrainingOptions());
+
+    /**
+     * @brief Fits a model.
+     * @param cohort Training subjects (shuffle first so batches are random samples).
+     * @param[in,out] model Model to train; its current weights are the starting point.
+     * @return double Log loss on the training cohort after the last epoch.
+     */
+    double train(const RiskCohort &cohort, LogisticRiskModel &model) const;
+
+    /**
+     * @brief Measures log loss, Brier score and calibration.
+     * @param model Model.
+     * @param cohort Subjects to score.
+     * @param binCount Number of equal-width probability bins.
+     * @return ModelEvaluation The report.
+     */
+    static ModelEvaluation evaluate(const LogisticRiskModel &model, const RiskCohort &cohort, int binCount = 10);
+
+private:
+    TrainingOptions options;    /**< Training settings. */
+};
+
+#endif // RISKMODELTRAINER_H
@@ -0,0 +1,515 @@
+/**
+ * @file RiskWatchlist.cpp
+ * @brief Implements the indexed top-K tracker and the caregiver watchlist.
+ */
+
+#include "RiskWatchlist.h"
+#include "ReadingStore.h"
+#include "SurveyStore.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const std::size_t kReadChunk = 1 << 20;     // Bytes read at a time while following a log.
+const char *kWatchlistMagic = "HeartPiWatchlist,1";
+
+/**
+ * @brief Reads the complete lines appended to a file since a byte offset.
+ *
+ * The tail is read in chunks of kReadChunk bytes, so the first catch-up on a large log needs one chunk of
+ * memory rather than a copy of the whole file.
+ *
+ * @param path File path.
+ * @param[in,out] offset Bytes already consumed; advanced past the last complete line.
+ * @param[out] truncated Set to true if the file is now shorter than offset (it was replaced).
+ * @param visit Called with each line (without the newline).
+ * @return bool False if the file could not be opened.
+ */
+template <typename Visitor>
+bool readAppendedLines(const std::string &path, std::uint64_t &offset, bool &truncated, Visitor visit) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    std::uint64_t size = static_cast<std::uint64_t>(in.tellg());
+    truncated = size < offset;
+    if (truncated || size == offset) return true;
+
+    std::string chunk(static_cast<std::size_t>(std::min<std::uint64_t>(kReadChunk, size - offset)), '\0');
+    std::string line;                   // The line being assembled, which may span chunks.
+    std::uint64_t position = offset;    // File offset of the chunk's first byte.
+    in.seekg(static_cast<std::streamoff>(offset));
+    while (position < size) {
+        std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size(), size - position));
+        if (!in.read(&chunk[0], static_cast<std::streamsize>(length))) break;
+        std::size_t lineStart = 0;
+        while (true) {
+            const char *newline = static_cast<const char *>(std::memchr(chunk.data() + lineStart, '\n',
+                                                                        length - lineStart));
+            if (!newline) break;
+            std::size_t end = static_cast<std::size_t>(newline - chunk.data());
+            line.append(chunk, lineStart, end - lineStart);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            visit(line);
+            line.clear();
+            lineStart = end + 1;
+            offset = position + lineStart;
+        }
+        line.append(chunk, lineStart, length - lineStart);
+        position += length;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty tracker.
+ * @param capacity K.
+ */
+TopKTracker::TopKTracker(std::size_t capacity) : k(std::max<std::size_t>(capacity, 1)) {}
+
+/**
+ * @brief Tells whether one entry ranks above another (higher score, then seen first).
+ * @param a Slot.
+ * @param b Slot.
+ * @return bool True if a ranks above b.
+ */
+bool TopKTracker::ranksAbove(std::size_t a, std::size_t b) const {
+    if (entries[a].score != entries[b].score) return entries[a].score > entries[b].score;
+    return entries[a].order < entries[b].order;
+}
+
+/**
+ * @brief Tells whether a belongs nearer the root than b in a heap.
+ * @param topHeap True for the top min-heap, false for the reserve max-heap.
+ * @param a Slot.
+ * @param b Slot.
+ * @return bool True if a goes first.
+ */
+bool TopKTracker::heapBefore(bool topHeap, std::size_t a, std::size_t b) const {
+    return topHeap ? ranksAbove(b, a) : ranksAbove(a, b);
+}
+
+/**
+ * @brief Stores a slot at a heap position and records the position.
+ * @param topHeap Heap.
+ * @param index Position.
+ * @param slot Slot.
+ */
+void TopKTracker::place(bool topHeap, std::size_t index, std::size_t slot) {
+    (topHeap ? top : reserve)[index] = slot;
+    entries[slot].inTop = topHeap;
+    entries[slot].position = index;
+}
+
+/**
+ * @brief Moves a heap element towards the root.
+ * @param topHeap Heap.
+ * @param index Position.
+ */
+void TopKTracker::siftUp(bool topHeap, std::size_t index) {
+    std::vector<std::size_t> &heap = topHeap ? top : reserve;
+    std::size_t slot = heap[index];
+    while (index > 0) {
+        std::size_t parent = (index - 1) / 2;
+        if (!heapBefore(topHeap, slot, heap[parent])) break;
+        place(topHeap, index, heap[parent]);
+        index = parent;
+    }
+    place(topHeap, index, slot);
+}
+
+/**
+ * @brief Moves a heap element away from the root.
+ * @param topHeap Heap.
+ * @param index Position.
+ */
+void TopKTracker::siftDown(bool topHeap, std::size_t index) {
+    std::vector<std::size_t> &heap = topHeap ? top : reserve;
+    std::size_t slot = heap[index];
+    while (true) {
+        std::size_t child = 2 * index + 1;
+        if (child >= heap.size()) break;
+        if (child + 1 < heap.size() && heapBefore(topHeap, heap[child + 1], heap[child])) ++child;
+        if (!heapBefore(topHeap, heap[child], slot)) break;
+        place(topHeap, index, heap[child]);
+        index = child;
+    }
+    place(topHeap, index, slot);
+}
+
+/**
+ * @brief Adds a slot to a heap.
+ * @param topHeap Heap.
+ * @param slot Slot.
+ */
+void TopKTracker::push(bool topHeap, std::size_t slot) {
+    std::vector<std::size_t> &heap = topHeap ? top : reserve;
+    heap.push_back(slot);
+    siftUp(topHeap, heap.size() - 1);
+}
+
+/**
+ * @brief Removes the element at a heap position.
+ * @param topHeap Heap.
+ * @param index Position.
+ * @return std::size_t The removed slot.
+ */
+std::size_t TopKTracker::pop(bool topHeap, std::size_t index) {
+    std::vector<std::size_t> &heap = topHeap ? top : reserve;
+    std::size_t slot = heap[index];
+    std::size_t last = heap.back();
+    heap.pop_back();
+    if (index < heap.size()) {
+        place(topHeap, index, last);
+        siftDown(topHeap, index);
+        siftUp(topHeap, entries[last].position);
+    }
+    return slot;
+}
+
+/**
+ * @brief Restores the invariant: the top heap is full and no reserve entry ranks above its weakest entry.
+ */
+void TopKTracker::rebalance() {
+    while (top.size() < k && !reserve.empty()) push(true, pop(false, 0));
+    while (!reserve.empty() && ranksAbove(reserve[0], top[0])) {
+        std::size_t promoted = reserve[0];
+        std::size_t demoted = top[0];
+        place(true, 0, promoted);
+        place(false, 0, demoted);
+        siftDown(true, 0);
+        siftDown(false, 0);
+    }
+}
+
+/**
+ * @brief Sets a key's score, adding the key if it is new.
+ * @param key Key.
+ * @param score New score.
+ */
+void TopKTracker::update(const std::string &key, double score) {
+    auto found = slotOf.find(key);
+    if (found == slotOf.end()) {
+        std::size_t slot = entries.size();
+        Entry entry;
+        entry.key = key;
+        entry.score = score;
+        entry.order = nextOrder++;
+        entries.push_back(entry);
+        slotOf.emplace(key, slot);
+        push(top.size() < k, slot);
+    } else {
+        Entry &entry = entries[found->second];
+        if (entry.score == score) return;
+        bool raised = score > entry.score;
+        entry.score = score;
+        // Raising a score moves it away from the top heap's root (min) and towards the reserve's root (max).
+        if (raised == entry.inTop) siftDown(entry.inTop, entry.position);
+        else siftUp(entry.inTop, entry.position);
+    }
+    rebalance();
+}
+
+/**
+ * @brief Removes a key.
+ * @param key Key.
+ * @return bool False if the key was not tracked.
+ */
+bool TopKTracker::remove(const std::string &key) {
+    auto found = slotOf.find(key);
+    if (found == slotOf.end()) return false;
+    std::size_t slot = found->second;
+    pop(entries[slot].inTop, entries[slot].position);
+    slotOf.erase(found);
+
+    // Keep entries dense: move the last entry into the freed slot.
+    std::size_t last = entries.size() - 1;
+    if (slot != last) {
+        entries[slot] = std::move(entries[last]);
+        slotOf[entries[slot].key] = slot;
+        (entries[slot].inTop ? top : reserve)[entries[slot].position] = slot;
+    }
+    entries.pop_back();
+    rebalance();
+    return true;
+}
+
+/**
+ * @brief Gets a key's score.
+ * @param key Key.
+ * @param[out] score Score.
+ * @return bool False if the key is not tracked.
+ */
+bool TopKTracker::find(const std::string &key, double &score) const {
+    auto found = slotOf.find(key);
+    if (found == slotOf.end()) return false;
+    score = entries[found->second].score;
+    return true;
+}
+
+/**
+ * @brief Tells whether a key is in the top K.
+ * @param key Key.
+ * @return bool True if in the top K.
+ */
+bool TopKTracker::isTop(const std::string &key) const {
+    auto found = slotOf.find(key);
+    return found != slotOf.end() && entries[found->second].inTop;
+}
+
+/**
+ * @brief Gets the top K, best first.
+ * @return std::vector<std::pair<std::string, double>> Keys and scores.
+ */
+std::vector<std::pair<std::string, double>> TopKTracker::ranked() const {
+    std::vector<std::size_t> slots(top);
+    std::sort(slots.begin(), slots.end(), [this](std::size_t a, std::size_t b) { return ranksAbove(a, b); });
+    std::vector<std::pair<std::string, double>> result;
+    result.reserve(slots.size());
+    for (std::size_t slot : slots) result.emplace_back(entries[slot].key, entries[slot].score);
+    return result;
+}
+
+/**
+ * @brief Gets every tracked key in the order the keys were added.
+ * @return std::vector<std::string> Keys.
+ */
+std::vector<std::string> TopKTracker::keys() const {
+    std::vector<std::size_t> slots(entries.size());
+    for (std::size_t i = 0; i < slots.size(); ++i) slots[i] = i;
+    std::sort(slots.begin(), slots.end(),
+              [this](std::size_t a, std::size_t b) { return entries[a].order < entries[b].order; });
+    std::vector<std::string> result;
+    result.reserve(slots.size());
+    for (std::size_t slot : slots) result.push_back(entries[slot].key);
+    return result;
+}
+
+/**
+ * @brief Removes every key.
+ */
+void TopKTracker::clear() {
+    entries.clear();
+    slotOf.clear();
+    top.clear();
+    reserve.clear();
+    nextOrder = 0;
+}
+
+/**
+ * @brief Constructs an empty watchlist.
+ * @param capacity Number of users shown.
+ * @param tierWeight Attention per risk tier.
+ */
+RiskWatchlist::RiskWatchlist(std::size_t capacity, double tierWeight) : tierWeight(tierWeight), ranking(capacity) {}
+
+/**
+ * @brief Computes a user's attention score.
+ * @param state User state.
+ * @return double Attention.
+ */
+double RiskWatchlist::attentionOf(const UserState &state) const {
+    double attention = state.tier > 0 ? tierWeight * state.tier : 0.0;
+    if (state.detector.getAlarmState() != 0) attention += state.detector.getLastSeverity();
+    return attention;
+}
+
+/**
+ * @brief Folds in one heart-rate reading.
+ * @param reading The reading.
+ */
+void RiskWatchlist::addReading(const HeartRateReading &reading) {
+    UserState &state = users[reading.user];
+    ChangeEvent event;
+    state.detector.update(reading.timestamp, reading.bpm, event);
+    state.lastReading = std::max(state.lastReading, reading.timestamp);
+    ranking.update(reading.user, attentionOf(state));
+}
+
+/**
+ * @brief Records a user's latest assessment.
+ * @param user Username.
+ * @param tier Tier.
+ */
+void RiskWatchlist::setAssessment(const std::string &user, int tier) {
+    UserState &state = users[user];
+    state.tier = std::min(std::max(tier, 0), 2);
+    ranking.update(user, attentionOf(state));
+}
+
+/**
+ * @brief Folds in the readings and surveys logged since the previous call.
+ * @param readings Reading store.
+ * @param surveys Survey store.
+ * @param[out] changed Set to true if anything was folded in.
+ * @return bool False if the reading CSV could not be read.
+ */
+bool RiskWatchlist::catchUp(const ReadingStore &readings, const SurveyStore &surveys, bool &changed) {
+    changed = false;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool readingsTruncated = false, surveysTruncated = false;
+        std::uint64_t readingStart = readingOffset, surveyStart = surveyOffset;
+        HeartRateReading reading;
+        SurveyProfile profile;
+        // Surveys first, so a catch-up that spans both sees the tier before the readings that follow it.
+        readAppendedLines(surveys.getCsvPath(), surveyOffset, surveysTruncated, [&](const std::string &line) {
+            if (SurveyStore::parseLine(line, profile) && !profile.user.empty())
+                setAssessment(profile.user, profile.tier);
+        });
+        if (!surveysTruncated) {
+            bool ok = readAppendedLines(readings.getCsvPath(), readingOffset, readingsTruncated,
+                                        [&](const std::string &line) {
+                                            if (ReadingStore::parseReadingLine(line, reading)) addReading(reading);
+                                        });
+            if (!ok) return false;
+        }
+        changed = changed || readingOffset != readingStart || surveyOffset != surveyStart;
+        if (!readingsTruncated && !surveysTruncated) return true;
+
+        // A log was replaced underneath us; start over from both logs.
+        users.clear();
+        ranking.clear();
+        readingOffset = 0;
+        surveyOffset = 0;
+        changed = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Replaces the watchlist with one saved by save().
+ *
+ * The file holds the magic line, "offsets,<readingBytes>,<surveyBytes>", and per user
+ * "user,<tier>,<lastReading>,<name>" followed by the user's "detector,..." line, in the order the ranking
+ * first saw the users.
+ *
+ * @param path File path.
+ * @return bool False if the file is missing or malformed.
+ */
+bool RiskWatchlist::load(const std::string &path) {
+    users.clear();
+    ranking.clear();
+    readingOffset = 0;
+    surveyOffset = 0;
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::string line;
+    bool ok = std::getline(in, line) && line == kWatchlistMagic && std::getline(in, line) &&
+              line.compare(0, 8, "offsets,") == 0;
+    if (ok) {
+        char *end = nullptr;
+        readingOffset = std::strtoull(line.c_str() + 8, &end, 10);
+        ok = *end == ',';
+        if (ok) surveyOffset = std::strtoull(end + 1, &end, 10);
+        ok = ok && *end == '\0';
+    }
+    while (ok && std::getline(in, line)) {
+        char *end = nullptr;
+        ok = line.compare(0, 5, "user,") == 0;
+        if (!ok) break;
+        int tier = static_cast<int>(std::strtol(line.c_str() + 5, &end, 10));
+        ok = *end == ',';
+        if (!ok) break;
+        long long lastReading = std::strtoll(end + 1, &end, 10);
+        ok = *end == ',' && end[1] != '\0';
+        if (!ok) break;
+        std::string user(end + 1);
+        UserState &state = users[user];
+        state.tier = tier;
+        state.lastReading = lastReading;
+        ok = state.detector.read(in);
+        if (ok) ranking.update(user, attentionOf(state));
+    }
+    if (ok) return true;
+
+    ErrorHandling::logErrorMessage("Ignoring malformed watchlist state in " + path);
+    users.clear();
+    ranking.clear();
+    readingOffset = 0;
+    surveyOffset = 0;
+    return false;
+}
+
+/**
+ * @brief Saves the log offsets and every user's state.
+ * @param path File path.
+ * @return bool False if the file could not be written.
+ */
+bool RiskWatchlist::save(const std::string &path) const {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out.is_open()) {
+            ErrorHandling::logErrorMessage("Failed to write watchlist state " + tempPath);
+            return false;
+        }
+        out << kWatchlistMagic << "\n";
+        out << "offsets," << readingOffset << "," << surveyOffset << "\n";
+        for (const std::string &user : ranking.keys()) {
+            const UserState &state = users.at(user);
+            out << "user," << state.tier << "," << state.lastReading << "," << user << "\n";
+            state.detector.write(out);
+        }
+        out.close();
+        if (!out) {
+            ErrorHandling::logErrorMessage("Failed to write watchlist state " + tempPath);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        ErrorHandling::logErrorMessage("Failed to replace watchlist state " + path + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Builds a row from a user's state.
+ * @param user Username.
+ * @param state User state.
+ * @return WatchlistEntry The row.
+ */
+WatchlistEntry RiskWatchlist::makeEntry(const std::string &user, const UserState &state) const {
+    WatchlistEntry entry;
+    entry.user = user;
+    entry.attention = attentionOf(state);
+    entry.tier = state.tier;
+    entry.alarmState = state.detector.getAlarmState();
+    entry.severity = entry.alarmState != 0 ? state.detector.getLastSeverity() : 0.0;
+    entry.recentBpm = state.detector.getRecentLevel();
+    entry.lastReading = state.lastReading;
+    return entry;
+}
+
+/**
+ * @brief Gets the users who need attention most, best first.
+ * @return std::vector<WatchlistEntry> Up to K rows.
+ */
+std::vector<WatchlistEntry> RiskWatchlist::top() const {
+    std::vector<WatchlistEntry> rows;
+    for (const auto &ranked : ranking.ranked()) rows.push_back(makeEntry(ranked.first, users.at(ranked.first)));
+    return rows;
+}
+
+/**
+ * @brief Gets a user's row.
+ * @param user Username.
+ * @return WatchlistEntry The row.
+ */
+WatchlistEntry RiskWatchlist::entryOf(const std::string &user) const {
+    auto found = users.find(user);
+    if (found == users.end()) {
+        WatchlistEntry entry;
+        entry.user = user;
+        return entry;
+    }
+    return makeEntry(user, found->second);
+}
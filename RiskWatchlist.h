@@ -0,0 +1,253 @@
+#ifndef RISKWATCHLIST_H
+#define RISKWATCHLIST_H
+
+/**
+ * @file RiskWatchlist.h
+ * @brief Declaration of the indexed top-K tracker and the caregiver watchlist built on it.
+ *
+ * This header declares the structures behind "who needs attention now?": every user has an attention score
+ * that combines their latest risk tier with the severity of any active heart-rate alarm, and the K users with
+ * the highest scores are kept in an indexed heap that is adjusted on every reading or assessment instead of
+ * being recomputed from each user's history.
+ */
+
+#include "AnomalyDetector.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct HeartRateReading;
+class ReadingStore;
+class SurveyStore;
+
+/**
+ * @class TopKTracker
+ * @brief The K highest-scoring keys under arbitrary score updates.
+ *
+ * Keys are split between an indexed min-heap holding the current top K and an indexed max-heap (the reserve)
+ * holding everyone else; every key knows its heap position, so an update sifts it in place. After each change
+ * the two roots are compared and swapped if the best reserve key now beats the weakest top key, which keeps
+ * the split exact even when a top-K score drops. Updates cost O(log K) inside the top K and O(log N) in the
+ * reserve, so with K much smaller than N most updates cost O(log N). Keeping the reserve ordered is the price
+ * of exactness: without it, finding the key that replaces a top-K key whose score drops would need a scan of
+ * all N keys. Ties are broken in favour of the key seen first.
+ */
+class TopKTracker {
+public:
+    /**
+     * @brief Constructs an empty tracker.
+     * @param capacity K, the number of keys kept in the top set.
+     */
+    explicit TopKTracker(std::size_t capacity = 10);
+
+    /**
+     * @brief Sets a key's score, adding the key if it is new.
+     * @param key Key.
+     * @param score New score.
+     */
+    void update(const std::string &key, double score);
+
+    /**
+     * @brief Removes a key.
+     * @param key Key.
+     * @return bool False if the key was not tracked.
+     */
+    bool remove(const std::string &key);
+
+    /**
+     * @brief Gets a key's score.
+     * @param key Key.
+     * @param[out] score Score.
+     * @return bool False if the key is not tracked.
+     */
+    bool find(const std::string &key, double &score) const;
+
+    /**
+     * @brief Tells whether a key is in the top K.
+     * @param key Key.
+     * @return bool True if the key is tracked and in the top K.
+     */
+    bool isTop(const std::string &key) const;
+
+    /**
+     * @brief Gets the top K, best first.
+     * @return std::vector<std::pair<std::string, double>> Keys and scores (O(K log K)).
+     */
+    std::vector<std::pair<std::string, double>> ranked() const;
+
+    /**
+     * @brief Gets every tracked key in the order the keys were added, so a copy can reproduce the tie-breaks.
+     * @return std::vector<std::string> Keys (O(N log N)).
+     */
+    std::vector<std::string> keys() const;
+
+    /** @return std::size_t K. */
+    std::size_t capacity() const { return k; }
+
+    /** @return std::size_t Number of tracked keys. */
+    std::size_t size() const { return entries.size(); }
+
+    /**
+     * @brief Removes every key.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief One tracked key.
+     */
+    struct Entry {
+        std::string key;            /**< Key. */
+        double score = 0.0;         /**< Current score. */
+        std::uint64_t order = 0;    /**< Insertion sequence (tie-break). */
+        bool inTop = false;         /**< True if the entry lives in the top heap. */
+        std::size_t position = 0;   /**< Index in its heap. */
+    };
+
+    std::size_t k;                                          /**< Capacity of the top set. */
+    std::vector<Entry> entries;                             /**< Entries (slots are reused after removal). */
+    std::unordered_map<std::string, std::size_t> slotOf;    /**< Entry slot per key. */
+    std::vector<std::size_t> top;                           /**< Min-heap of the top K slots. */
+    std::vector<std::size_t> reserve;                       /**< Max-heap of the remaining slots. */
+    std::uint64_t nextOrder = 0;                            /**< Next insertion sequence number. */
+
+    bool ranksAbove(std::size_t a, std::size_t b) const;
+    bool heapBefore(bool topHeap, std::size_t a, std::size_t b) const;
+    void place(bool topHeap, std::size_t index, std::size_t slot);
+    void siftUp(bool topHeap, std::size_t index);
+    void siftDown(bool topHeap, std::size_t index);
+    void push(bool topHeap, std::size_t slot);
+    std::size_t pop(bool topHeap, std::size_t index);
+    void rebalance();
+};
+
+/**
+ * @brief One row of the watchlist.
+ */
+struct WatchlistEntry {
+    std::string user;           /**< Username. */
+    double attention = 0.0;     /**< Attention score (see RiskWatchlist). */
+    int tier = -1;              /**< Latest assessed tier (0: Low, 1: Moderate, 2: High), or -1 if none. */
+    int alarmState = 0;         /**< +1 / -1 while an upward / downward heart-rate alarm is active, else 0. */
+    double severity = 0.0;      /**< Severity of the active alarm in baseline standard deviations (0 if none). */
+    double recentBpm = 0.0;     /**< EWMA-smoothed heart rate. */
+    long long lastReading = 0;  /**< Time of the newest reading (0 if none). */
+};
+
+/**
+ * @class RiskWatchlist
+ * @brief Caregiver watchlist: the top-K users by attention score, maintained reading by reading.
+ *
+ * attention = tierWeight x tier + severity of the active alarm, so an active alarm of tierWeight standard
+ * deviations counts as much as one risk tier. Each reading updates the user's PatientDetector in O(1) and their
+ * score in the TopKTracker, in O(log N) for N users; each assessment replaces the user's tier. catchUp() folds
+ * in only the bytes appended to the reading and survey logs since the previous call.
+ *
+ * save() writes the log offsets and every user's state, so a watchlist loaded from it resumes where the saved
+ * one stopped instead of reading both logs from the start.
+ */
+class RiskWatchlist {
+public:
+    static constexpr double kDefaultTierWeight = 3.0;  /**< Attention per risk tier. */
+
+    /**
+     * @brief Constructs an empty watchlist.
+     * @param capacity Number of users shown (K).
+     * @param tierWeight Attention per risk tier.
+     */
+    explicit RiskWatchlist(std::size_t capacity = 10, double tierWeight = kDefaultTierWeight);
+
+    /**
+     * @brief Folds in one heart-rate reading.
+     * @param reading The reading.
+     */
+    void addReading(const HeartRateReading &reading);
+
+    /**
+     * @brief Records a user's latest assessment.
+     * @param user Username.
+     * @param tier 0: Low, 1: Moderate, 2: High.
+     */
+    void setAssessment(const std::string &user, int tier);
+
+    /**
+     * @brief Folds in the readings and surveys logged since the previous call.
+     *
+     * The first call reads both logs once; later calls read only what was appended. If a log shrank (it was
+     * replaced), the watchlist is rebuilt from the start of both logs.
+     *
+     * @param readings Reading store whose CSV is followed.
+     * @param surveys Survey store whose log is followed.
+     * @param[out] changed Set to true if any reading or survey was folded in.
+     * @return bool False if the reading CSV could not be read.
+     */
+    bool catchUp(const ReadingStore &readings, const SurveyStore &surveys, bool &changed);
+
+    /**
+     * @brief Replaces the watchlist with one saved by save().
+     * @param path File path.
+     * @return bool False if the file is missing or malformed (the watchlist is then empty and starts over).
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief Saves the log offsets and every user's state via a temporary file and rename.
+     * @param path File path.
+     * @return bool False if the file could not be written.
+     */
+    bool save(const std::string &path) const;
+
+    /**
+     * @brief Gets the users who need attention most, best first.
+     * @return std::vector<WatchlistEntry> Up to K rows.
+     */
+    std::vector<WatchlistEntry> top() const;
+
+    /**
+     * @brief Gets a user's row.
+     * @param user Username.
+     * @return WatchlistEntry The row (attention 0 and tier -1 for unknown users).
+     */
+    WatchlistEntry entryOf(const std::string &user) const;
+
+    /** @return std::size_t Number of users with readings or assessments. */
+    std::size_t size() const { return users.size(); }
+
+    /** @return std::size_t Number of users shown (K). */
+    std::size_t capacity() const { return ranking.capacity(); }
+
+private:
+    /**
+     * @brief State kept per user.
+     */
+    struct UserState {
+        PatientDetector detector;   /**< Heart-rate change detector. */
+        int tier = -1;              /**< Latest assessed tier, or -1. */
+        long long lastReading = 0;  /**< Time of the newest reading. */
+    };
+
+    double tierWeight;                                  /**< Attention per risk tier. */
+    std::unordered_map<std::string, UserState> users;   /**< State per user. */
+    TopKTracker ranking;                                /**< Attention ranking. */
+    std::uint64_t readingOffset = 0;                    /**< Bytes of the reading CSV folded in. */
+    std::uint64_t surveyOffset = 0;                     /**< Bytes of the survey log folded in. */
+
+    /**
+     * @brief Computes a user's attention score.
+     * @param state User state.
+     * @return double Attention.
+     */
+    double attentionOf(const UserState &state) const;
+
+    /**
+     * @brief Builds a row from a user's state.
+     * @param user Username.
+     * @param state User state.
+     * @return WatchlistEntry The row.
+     */
+    WatchlistEntry makeEntry(const std::string &user, const UserState &state) const;
+};
+
+#endif // RISKWATCHLIST_H
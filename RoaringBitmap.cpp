@@ -0,0 +1,519 @@
+/**
+ * @file RoaringBitmap.cpp
+ * @brief Implements the RoaringBitmap container operations.
+ *
+ * Binary format (little-endian as written by the host): uint32 container count, then per container a uint16
+ * key, a uint32 cardinality, a uint8 kind (0 array, 1 bitmap) and either cardinality uint16 values or
+ * 1024 uint64 words.
+ */
+
+#include "RoaringBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Counts the set bits of a word.
+ * @param word Word.
+ * @return int Number of set bits.
+ */
+int RoaringBitmap::popcount(std::uint64_t word) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(word));
+#elif defined(__POPCNT__) || defined(__aarch64__) || defined(__ARM_NEON)
+    return __builtin_popcountll(word);
+#else
+    // Without the POPCNT instruction GCC calls a slow library routine; this SWAR sum is several times faster.
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/**
+ * @brief Gets the index of the lowest set bit of a non-zero word.
+ * @param word Word.
+ * @return std::uint32_t Bit index.
+ */
+std::uint32_t RoaringBitmap::countTrailingZeros(std::uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return static_cast<std::uint32_t>(__builtin_ctzll(word));
+#endif
+}
+
+/**
+ * @brief Converts an array chunk to bitmap form.
+ */
+void RoaringBitmap::Container::toBitmap() {
+    if (isBitmap()) return;
+    words.assign(kBitmapWords, 0);
+    for (std::uint16_t v : values) words[v >> 6] |= std::uint64_t(1) << (v & 63);
+    values.clear();
+    values.shrink_to_fit();
+}
+
+/**
+ * @brief Converts a bitmap chunk back to array form once it holds few enough values.
+ */
+void RoaringBitmap::Container::toArrayIfSparse() {
+    if (!isBitmap() || cardinality > kArrayMax) return;
+    values.clear();
+    values.reserve(cardinality);
+    for (std::uint32_t w = 0; w < kBitmapWords; ++w) {
+        std::uint64_t word = words[w];
+        while (word) {
+            values.push_back(static_cast<std::uint16_t>(w * 64 + countTrailingZeros(word)));
+            word &= word - 1;
+        }
+    }
+    words.clear();
+    words.shrink_to_fit();
+}
+
+/**
+ * @brief Finds or creates the chunk for a key.
+ * @param key High 16 bits.
+ * @return Container& The chunk.
+ */
+RoaringBitmap::Container& RoaringBitmap::containerFor(std::uint16_t key) {
+    if (!containers.empty() && containers.back().key == key) return containers.back();
+    if (containers.empty() || containers.back().key < key) {
+        containers.emplace_back();
+        containers.back().key = key;
+        return containers.back();
+    }
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container &c, std::uint16_t k) { return c.key < k; });
+    if (it == containers.end() || it->key != key) {
+        it = containers.insert(it, Container());
+        it->key = key;
+    }
+    return *it;
+}
+
+/**
+ * @brief Adds a value.
+ * @param value Value to add.
+ */
+void RoaringBitmap::add(std::uint32_t value) {
+    Container &c = containerFor(static_cast<std::uint16_t>(value >> 16));
+    std::uint16_t low = static_cast<std::uint16_t>(value & 0xFFFF);
+    if (c.isBitmap()) {
+        std::uint64_t &word = c.words[low >> 6];
+        std::uint64_t bit = std::uint64_t(1) << (low & 63);
+        if (!(word & bit)) {
+            word |= bit;
+            ++c.cardinality;
+        }
+        return;
+    }
+    if (c.values.empty() || c.values.back() < low) {
+        c.values.push_back(low);
+    } else {
+        auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+        if (*it == low) return;
+        c.values.insert(it, low);
+    }
+    ++c.cardinality;
+    if (c.cardinality > kArrayMax) c.toBitmap();
+}
+
+/**
+ * @brief Adds every value in [from, to).
+ * @param from First value.
+ * @param to One past the last value.
+ */
+void RoaringBitmap::addRange(std::uint64_t from, std::uint64_t to) {
+    if (to > (std::uint64_t(1) << 32)) to = std::uint64_t(1) << 32;
+    while (from < to) {
+        std::uint64_t chunkEnd = std::min<std::uint64_t>((from | 0xFFFF) + 1, to);
+        Container &c = containerFor(static_cast<std::uint16_t>(from >> 16));
+        if (chunkEnd - from <= 64 && !c.isBitmap()) {
+            for (std::uint64_t v = from; v < chunkEnd; ++v) add(static_cast<std::uint32_t>(v));
+        } else {
+            c.toBitmap();
+            for (std::uint64_t v = from & 0xFFFF; v < ((chunkEnd - 1) & 0xFFFF) + 1; ) {
+                if ((v & 63) == 0 && v + 64 <= ((chunkEnd - 1) & 0xFFFF) + 1) {
+                    c.words[v >> 6] = ~std::uint64_t(0);
+                    v += 64;
+                } else {
+                    c.words[v >> 6] |= std::uint64_t(1) << (v & 63);
+                    ++v;
+                }
+            }
+            std::uint32_t count = 0;
+            for (std::uint64_t word : c.words) count += popcount(word);
+            c.cardinality = count;
+            c.toArrayIfSparse();
+        }
+        from = chunkEnd;
+    }
+}
+
+/**
+ * @brief Tests membership.
+ * @param value Value to test.
+ * @return bool True if present.
+ */
+bool RoaringBitmap::contains(std::uint32_t value) const {
+    std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container &c, std::uint16_t k) { return c.key < k; });
+    if (it == containers.end() || it->key != key) return false;
+    std::uint16_t low = static_cast<std::uint16_t>(value & 0xFFFF);
+    if (it->isBitmap()) return (it->words[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(it->values.begin(), it->values.end(), low);
+}
+
+/**
+ * @brief Gets the number of values in the set.
+ * @return std::uint64_t Cardinality.
+ */
+std::uint64_t RoaringBitmap::cardinality() const {
+    std::uint64_t total = 0;
+    for (const Container &c : containers) total += c.cardinality;
+    return total;
+}
+
+/**
+ * @brief Intersects two chunks with the same key.
+ * @param a First chunk.
+ * @param b Second chunk.
+ * @return Container The intersection (possibly empty).
+ */
+RoaringBitmap::Container RoaringBitmap::intersect(const Container &a, const Container &b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        result.words.resize(kBitmapWords);
+        std::uint32_t count = 0;
+        for (std::uint32_t w = 0; w < kBitmapWords; ++w) {
+            result.words[w] = a.words[w] & b.words[w];
+            count += popcount(result.words[w]);
+        }
+        result.cardinality = count;
+        result.toArrayIfSparse();
+    } else if (a.isBitmap() || b.isBitmap()) {
+        const Container &array = a.isBitmap() ? b : a;
+        const Container &bitmap = a.isBitmap() ? a : b;
+        for (std::uint16_t v : array.values)
+            if ((bitmap.words[v >> 6] >> (v & 63)) & 1) result.values.push_back(v);
+        result.cardinality = static_cast<std::uint32_t>(result.values.size());
+    } else {
+        std::set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                              std::back_inserter(result.values));
+        result.cardinality = static_cast<std::uint32_t>(result.values.size());
+    }
+    return result;
+}
+
+/**
+ * @brief Unites two chunks with the same key.
+ * @param a First chunk.
+ * @param b Second chunk.
+ * @return Container The union.
+ */
+RoaringBitmap::Container RoaringBitmap::unite(const Container &a, const Container &b) {
+    Container result;
+    result.key = a.key;
+    if (!a.isBitmap() && !b.isBitmap() && a.cardinality + b.cardinality <= kArrayMax) {
+        std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                       std::back_inserter(result.values));
+        result.cardinality = static_cast<std::uint32_t>(result.values.size());
+        return result;
+    }
+    result.words.assign(kBitmapWords, 0);
+    for (const Container *c : { &a, &b }) {
+        if (c->isBitmap()) {
+            for (std::uint32_t w = 0; w < kBitmapWords; ++w) result.words[w] |= c->words[w];
+        } else {
+            for (std::uint16_t v : c->values) result.words[v >> 6] |= std::uint64_t(1) << (v & 63);
+        }
+    }
+    std::uint32_t count = 0;
+    for (std::uint64_t word : result.words) count += popcount(word);
+    result.cardinality = count;
+    result.toArrayIfSparse();
+    return result;
+}
+
+/**
+ * @brief Removes the values of one chunk from another with the same key.
+ * @param a Chunk to subtract from.
+ * @param b Chunk to remove.
+ * @return Container The difference (possibly empty).
+ */
+RoaringBitmap::Container RoaringBitmap::subtract(const Container &a, const Container &b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap()) {
+        result.words = a.words;
+        if (b.isBitmap()) {
+            for (std::uint32_t w = 0; w < kBitmapWords; ++w) result.words[w] &= ~b.words[w];
+        } else {
+            for (std::uint16_t v : b.values) result.words[v >> 6] &= ~(std::uint64_t(1) << (v & 63));
+        }
+        std::uint32_t count = 0;
+        for (std::uint64_t word : result.words) count += popcount(word);
+        result.cardinality = count;
+        result.toArrayIfSparse();
+    } else if (b.isBitmap()) {
+        for (std::uint16_t v : a.values)
+            if (!((b.words[v >> 6] >> (v & 63)) & 1)) result.values.push_back(v);
+        result.cardinality = static_cast<std::uint32_t>(result.values.size());
+    } else {
+        std::set_difference(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                            std::back_inserter(result.values));
+        result.cardinality = static_cast<std::uint32_t>(result.values.size());
+    }
+    return result;
+}
+
+/**
+ * @brief Counts the intersection of two chunks without building it.
+ * @param a First chunk.
+ * @param b Second chunk.
+ * @return std::uint32_t Size of the intersection.
+ */
+std::uint32_t RoaringBitmap::intersectCount(const Container &a, const Container &b) {
+    std::uint32_t count = 0;
+    if (a.isBitmap() && b.isBitmap()) {
+        for (std::uint32_t w = 0; w < kBitmapWords; ++w) count += popcount(a.words[w] & b.words[w]);
+    } else if (a.isBitmap() || b.isBitmap()) {
+        const Container &array = a.isBitmap() ? b : a;
+        const Container &bitmap = a.isBitmap() ? a : b;
+        for (std::uint16_t v : array.values) count += (bitmap.words[v >> 6] >> (v & 63)) & 1;
+    } else {
+        auto i = a.values.begin(), j = b.values.begin();
+        while (i != a.values.end() && j != b.values.end()) {
+            if (*i < *j) ++i;
+            else if (*j < *i) ++j;
+            else { ++count; ++i; ++j; }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Intersection.
+ * @param other Other set.
+ * @return RoaringBitmap Values in both sets.
+ */
+RoaringBitmap RoaringBitmap::operator&(const RoaringBitmap &other) const {
+    RoaringBitmap result;
+    auto i = containers.begin(), j = other.containers.begin();
+    while (i != containers.end() && j != other.containers.end()) {
+        if (i->key < j->key) ++i;
+        else if (j->key < i->key) ++j;
+        else {
+            Container c = intersect(*i, *j);
+            if (c.cardinality > 0) result.containers.push_back(std::move(c));
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Union.
+ * @param other Other set.
+ * @return RoaringBitmap Values in either set.
+ */
+RoaringBitmap RoaringBitmap::operator|(const RoaringBitmap &other) const {
+    RoaringBitmap result;
+    auto i = containers.begin(), j = other.containers.begin();
+    while (i != containers.end() || j != other.containers.end()) {
+        if (j == other.containers.end() || (i != containers.end() && i->key < j->key)) {
+            result.containers.push_back(*i++);
+        } else if (i == containers.end() || j->key < i->key) {
+            result.containers.push_back(*j++);
+        } else {
+            result.containers.push_back(unite(*i, *j));
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Difference (AND NOT).
+ * @param other Set to remove.
+ * @return RoaringBitmap Values in this set but not in other.
+ */
+RoaringBitmap RoaringBitmap::operator-(const RoaringBitmap &other) const {
+    RoaringBitmap result;
+    auto j = other.containers.begin();
+    for (const Container &c : containers) {
+        while (j != other.containers.end() && j->key < c.key) ++j;
+        if (j == other.containers.end() || j->key != c.key) {
+            result.containers.push_back(c);
+        } else {
+            Container d = subtract(c, *j);
+            if (d.cardinality > 0) result.containers.push_back(std::move(d));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Counts the intersection without building it.
+ * @param other Other set.
+ * @return std::uint64_t Size of the intersection.
+ */
+std::uint64_t RoaringBitmap::andCardinality(const RoaringBitmap &other) const {
+    std::uint64_t total = 0;
+    auto i = containers.begin(), j = other.containers.begin();
+    while (i != containers.end() && j != other.containers.end()) {
+        if (i->key < j->key) ++i;
+        else if (j->key < i->key) ++j;
+        else {
+            total += intersectCount(*i, *j);
+            ++i;
+            ++j;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Intersects any number of sets in one pass.
+ * @param sets Sets to intersect.
+ * @return RoaringBitmap Values in every set.
+ */
+RoaringBitmap RoaringBitmap::intersectAll(const std::vector<const RoaringBitmap *> &sets) {
+    RoaringBitmap result;
+    if (sets.empty()) return result;
+    if (sets.size() == 1) return *sets[0];
+
+    // Drive the walk from the set with the fewest chunks.
+    std::size_t driver = 0;
+    for (std::size_t s = 1; s < sets.size(); ++s)
+        if (sets[s]->containers.size() < sets[driver]->containers.size()) driver = s;
+
+    std::vector<std::size_t> cursor(sets.size(), 0);
+    std::vector<const Container *> matched(sets.size());
+    for (const Container &lead : sets[driver]->containers) {
+        bool everywhere = true;
+        const Container *smallestArray = nullptr;
+        for (std::size_t s = 0; s < sets.size() && everywhere; ++s) {
+            const std::vector<Container> &cs = sets[s]->containers;
+            std::size_t &i = cursor[s];
+            while (i < cs.size() && cs[i].key < lead.key) ++i;
+            if (i == cs.size() || cs[i].key != lead.key) {
+                everywhere = false;
+                break;
+            }
+            matched[s] = &cs[i];
+            if (!cs[i].isBitmap() && (!smallestArray || cs[i].cardinality < smallestArray->cardinality))
+                smallestArray = &cs[i];
+        }
+        if (!everywhere) continue;
+
+        Container c;
+        c.key = lead.key;
+        if (smallestArray) {
+            // Filter the smallest array through every other chunk.
+            for (std::uint16_t v : smallestArray->values) {
+                bool inAll = true;
+                for (const Container *m : matched) {
+                    if (m == smallestArray) continue;
+                    inAll = m->isBitmap() ? ((m->words[v >> 6] >> (v & 63)) & 1)
+                                          : std::binary_search(m->values.begin(), m->values.end(), v);
+                    if (!inAll) break;
+                }
+                if (inAll) c.values.push_back(v);
+            }
+            c.cardinality = static_cast<std::uint32_t>(c.values.size());
+        } else {
+            c.words = matched[0]->words;
+            for (std::size_t s = 1; s < matched.size(); ++s) {
+                const std::uint64_t *w = matched[s]->words.data();
+                for (std::uint32_t k = 0; k < kBitmapWords; ++k) c.words[k] &= w[k];
+            }
+            std::uint32_t count = 0;
+            for (std::uint64_t word : c.words) count += popcount(word);
+            c.cardinality = count;
+            c.toArrayIfSparse();
+        }
+        if (c.cardinality > 0) result.containers.push_back(std::move(c));
+    }
+    return result;
+}
+
+/**
+ * @brief Gets the approximate heap size.
+ * @return std::size_t Bytes.
+ */
+std::size_t RoaringBitmap::memoryUsage() const {
+    std::size_t bytes = containers.capacity() * sizeof(Container);
+    for (const Container &c : containers)
+        bytes += c.values.capacity() * sizeof(std::uint16_t) + c.words.capacity() * sizeof(std::uint64_t);
+    return bytes;
+}
+
+/**
+ * @brief Writes the set in binary form.
+ * @param out Binary output stream.
+ */
+void RoaringBitmap::write(std::ostream &out) const {
+    std::uint32_t count = static_cast<std::uint32_t>(containers.size());
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    for (const Container &c : containers) {
+        std::uint8_t kind = c.isBitmap() ? 1 : 0;
+        out.write(reinterpret_cast<const char *>(&c.key), sizeof(c.key));
+        out.write(reinterpret_cast<const char *>(&c.cardinality), sizeof(c.cardinality));
+        out.write(reinterpret_cast<const char *>(&kind), sizeof(kind));
+        if (kind)
+            out.write(reinterpret_cast<const char *>(c.words.data()), kBitmapWords * sizeof(std::uint64_t));
+        else
+            out.write(reinterpret_cast<const char *>(c.values.data()), c.values.size() * sizeof(std::uint16_t));
+    }
+}
+
+/**
+ * @brief Reads a set previously produced by write().
+ * @param in Binary input stream.
+ * @return bool False if the data is malformed.
+ */
+bool RoaringBitmap::read(std::istream &in) {
+    containers.clear();
+    std::uint32_t count = 0;
+    if (!in.read(reinterpret_cast<char *>(&count), sizeof(count)) || count > 65536) return false;
+    containers.resize(count);
+    for (Container &c : containers) {
+        std::uint8_t kind = 0;
+        in.read(reinterpret_cast<char *>(&c.key), sizeof(c.key));
+        in.read(reinterpret_cast<char *>(&c.cardinality), sizeof(c.cardinality));
+        in.read(reinterpret_cast<char *>(&kind), sizeof(kind));
+        if (!in || c.cardinality == 0 || c.cardinality > 65536) {
+            containers.clear();
+            return false;
+        }
+        if (kind) {
+            c.words.resize(kBitmapWords);
+            in.read(reinterpret_cast<char *>(c.words.data()), kBitmapWords * sizeof(std::uint64_t));
+        } else {
+            if (c.cardinality > kArrayMax) {
+                containers.clear();
+                return false;
+            }
+            c.values.resize(c.cardinality);
+            in.read(reinterpret_cast<char *>(c.values.data()), c.values.size() * sizeof(std::uint16_t));
+        }
+        if (!in) {
+            containers.clear();
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,198 @@
+#ifndef ROARINGBITMAP_H
+#define ROARINGBITMAP_H
+
+/**
+ * @file RoaringBitmap.h
+ * @brief Declaration of the RoaringBitmap class, a compressed set of 32-bit integers.
+ *
+ * This header declares a Roaring bitmap (Chambi, Lemire et al., 2016) used to index survey answers by profile
+ * number. Sparse and dense regions are stored differently, so set operations and counts over hundreds of
+ * millions of profiles run over a few megabytes instead of one byte or flag per profile.
+ */
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class RoaringBitmap
+ * @brief Set of uint32 values split into 65536-value chunks, each stored as a sorted array or a bitmap.
+ *
+ * A chunk with at most 4096 values is a sorted array of 16-bit offsets (at most 8 KB); a denser chunk is a
+ * fixed 8 KB bitmap. Intersections, unions and differences work chunk by chunk and pick the cheapest
+ * algorithm for each pair of container kinds; bitmap/bitmap work is whole 64-bit words with popcount.
+ */
+class RoaringBitmap {
+public:
+    /**
+     * @brief Adds a value.
+     *
+     * Values added in increasing order (the usual case for profile numbers) take the O(1) append path.
+     *
+     * @param value Value to add.
+     */
+    void add(std::uint32_t value);
+
+    /**
+     * @brief Adds every value in [from, to).
+     * @param from First value.
+     * @param to One past the last value.
+     */
+    void addRange(std::uint64_t from, std::uint64_t to);
+
+    /**
+     * @brief Tests membership.
+     * @param value Value to test.
+     * @return bool True if the value is in the set.
+     */
+    bool contains(std::uint32_t value) const;
+
+    /** @return std::uint64_t Number of values in the set. */
+    std::uint64_t cardinality() const;
+
+    /** @return bool True if the set is empty. */
+    bool empty() const { return containers.empty(); }
+
+    /**
+     * @brief Removes every value.
+     */
+    void clear() { containers.clear(); }
+
+    /**
+     * @brief Intersection.
+     * @param other Other set.
+     * @return RoaringBitmap Values in both sets.
+     */
+    RoaringBitmap operator&(const RoaringBitmap &other) const;
+
+    /**
+     * @brief Union.
+     * @param other Other set.
+     * @return RoaringBitmap Values in either set.
+     */
+    RoaringBitmap operator|(const RoaringBitmap &other) const;
+
+    /**
+     * @brief Difference (AND NOT).
+     * @param other Set to remove.
+     * @return RoaringBitmap Values in this set but not in other.
+     */
+    RoaringBitmap operator-(const RoaringBitmap &other) const;
+
+    /**
+     * @brief Counts the intersection without building it.
+     * @param other Other set.
+     * @return std::uint64_t Size of the intersection.
+     */
+    std::uint64_t andCardinality(const RoaringBitmap &other) const;
+
+    /**
+     * @brief Intersects any number of sets in one pass.
+     *
+     * Only chunks present in every set are visited. Bitmap chunks are ANDed word by word across all sets at
+     * once, so no intermediate result is built for a chain such as a & b & c & d.
+     *
+     * @param sets Sets to intersect (must not be empty).
+     * @return RoaringBitmap Values in every set.
+     */
+    static RoaringBitmap intersectAll(const std::vector<const RoaringBitmap *> &sets);
+
+    /**
+     * @brief Calls a function for every value in increasing order.
+     * @param visit Function taking a uint32 value.
+     */
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const Container &c : containers) {
+            std::uint32_t high = static_cast<std::uint32_t>(c.key) << 16;
+            if (c.words.empty()) {
+                for (std::uint16_t low : c.values) visit(high | low);
+            } else {
+                for (std::uint32_t w = 0; w < kBitmapWords; ++w) {
+                    std::uint64_t word = c.words[w];
+                    while (word) {
+                        visit(high | (w * 64 + countTrailingZeros(word)));
+                        word &= word - 1;
+                    }
+                }
+            }
+        }
+    }
+
+    /** @return std::size_t Approximate heap size in bytes. */
+    std::size_t memoryUsage() const;
+
+    /**
+     * @brief Writes the set in a compact binary form.
+     * @param out Binary output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads a set previously produced by write().
+     * @param in Binary input stream.
+     * @return bool False if the data is malformed.
+     */
+    bool read(std::istream &in);
+
+    /**
+     * @brief Counts the set bits of a word.
+     * @param word Word.
+     * @return int Number of set bits.
+     */
+    static int popcount(std::uint64_t word);
+
+    /**
+     * @brief Gets the index of the lowest set bit of a non-zero word.
+     * @param word Word (must not be zero).
+     * @return std::uint32_t Bit index.
+     */
+    static std::uint32_t countTrailingZeros(std::uint64_t word);
+
+private:
+    static const std::uint32_t kArrayMax = 4096;        /**< Largest chunk stored as an array. */
+    static const std::uint32_t kBitmapWords = 1024;     /**< 64-bit words in a bitmap chunk. */
+
+    /**
+     * @brief One 65536-value chunk.
+     */
+    struct Container {
+        std::uint16_t key = 0;                  /**< High 16 bits shared by the chunk's values. */
+        std::uint32_t cardinality = 0;          /**< Values in the chunk. */
+        std::vector<std::uint16_t> values;      /**< Sorted low bits (array form). */
+        std::vector<std::uint64_t> words;       /**< Bitmap form (kBitmapWords words), empty in array form. */
+
+        /** @return bool True in bitmap form. */
+        bool isBitmap() const { return !words.empty(); }
+
+        /** @brief Converts an array chunk to bitmap form. */
+        void toBitmap();
+
+        /** @brief Converts a bitmap chunk back to an array once it holds at most kArrayMax values. */
+        void toArrayIfSparse();
+    };
+
+    std::vector<Container> containers;          /**< Non-empty chunks sorted by key. */
+
+    /**
+     * @brief Finds or creates the chunk for a key.
+     * @param key High 16 bits.
+     * @return Container& The chunk.
+     */
+    Container& containerFor(std::uint16_t key);
+
+    /** @brief Intersects two chunks with the same key. */
+    static Container intersect(const Container &a, const Container &b);
+
+    /** @brief Unites two chunks with the same key. */
+    static Container unite(const Container &a, const Container &b);
+
+    /** @brief Removes the values of b from a (same key). */
+    static Container subtract(const Container &a, const Container &b);
+
+    /** @brief Counts the intersection of two chunks without building it. */
+    static std::uint32_t intersectCount(const Container &a, const Container &b);
+};
+
+#endif // ROARINGBITMAP_H
@@ -0,0 +1,192 @@
+/**
+ * @file SampleBus.cpp
+ * @brief Implements the per-stream sample rings.
+ */
+
+#include "SampleBus.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Constructs an empty bus.
+ * @param maxStreams Largest number of streams.
+ * @param samplesPerStream Ring capacity per stream.
+ */
+SampleBus::SampleBus(std::size_t maxStreams, std::size_t samplesPerStream)
+    : streams(new Stream[maxStreams]), maxStreams(maxStreams) {
+    std::size_t capacity = 1;
+    while (capacity < samplesPerStream) capacity <<= 1;
+    mask = capacity - 1;
+}
+
+/**
+ * @brief Finds or creates a stream.
+ * @param id Stream identifier.
+ * @return long long Stream index, or -1 if the bus is full.
+ */
+long long SampleBus::open(std::uint32_t id) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    auto it = ids.find(id);
+    if (it != ids.end()) return static_cast<long long>(it->second);
+    std::size_t index = opened.load(std::memory_order_relaxed);
+    if (index >= maxStreams) return -1;
+    Stream &stream = streams[index];
+    stream.id = id;
+    stream.ring.reset(new std::int16_t[mask + 1]());
+    ids.emplace(id, index);
+    opened.store(index + 1, std::memory_order_release);
+    return static_cast<long long>(index);
+}
+
+/**
+ * @brief Finds a stream.
+ * @param id Stream identifier.
+ * @return long long Stream index, or -1.
+ */
+long long SampleBus::find(std::uint32_t id) const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    auto it = ids.find(id);
+    return it == ids.end() ? -1 : static_cast<long long>(it->second);
+}
+
+/**
+ * @brief Decides whether a frame continues a stream.
+ *
+ * A retransmission that overlaps the end of the stream only partly still carries new samples after the
+ * overlap, so only the overlap is skipped.
+ *
+ * @param stream Stream index.
+ * @param sequence First sequence number of the frame.
+ * @param count Samples in the frame.
+ * @param restart Sequence numbering restarted.
+ * @param[out] skip Leading samples already committed.
+ * @return bool True if the frame has samples to commit.
+ */
+bool SampleBus::admit(std::size_t stream, std::uint64_t sequence, std::size_t count, bool restart,
+                      std::size_t &skip) {
+    Stream &s = streams[stream];
+    std::uint64_t expected = s.nextSequence.load(std::memory_order_relaxed);
+    skip = 0;
+    if (!s.started || restart) {
+        s.started = true;
+        return true;
+    }
+    if (sequence < expected) {
+        skip = static_cast<std::size_t>(std::min<std::uint64_t>(expected - sequence, count));
+        s.duplicates.fetch_add(skip, std::memory_order_relaxed);
+        return skip < count;
+    }
+    if (sequence > expected) s.lost.fetch_add(sequence - expected, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Tells whether a frame would leave a gap before it.
+ * @param stream Stream index.
+ * @param sequence First sequence number of the frame.
+ * @return bool True if the frame starts after the expected sequence number.
+ */
+bool SampleBus::ahead(std::size_t stream, std::uint64_t sequence) const {
+    const Stream &s = streams[stream];
+    return s.started && sequence > s.nextSequence.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reserves space for the next samples of a stream.
+ * @param stream Stream index.
+ * @param count Samples to reserve.
+ * @return SampleSpan Where to write them.
+ */
+SampleSpan SampleBus::reserve(std::size_t stream, std::size_t count) {
+    Stream &s = streams[stream];
+    count = std::min(count, mask + 1);
+    std::uint64_t begin = s.written.load(std::memory_order_relaxed);
+    std::uint64_t end = begin + count;
+    if (end > s.reserved.load(std::memory_order_relaxed)) {
+        s.reserved.store(end, std::memory_order_relaxed);
+        // Readers must see the reservation before any byte of the overwritten samples changes.
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    std::size_t offset = static_cast<std::size_t>(begin & mask);
+    SampleSpan span;
+    span.first = s.ring.get() + offset;
+    span.firstCount = std::min(count, mask + 1 - offset);
+    span.second = s.ring.get();
+    span.secondCount = count - span.firstCount;
+    return span;
+}
+
+/**
+ * @brief Publishes reserved samples.
+ * @param stream Stream index.
+ * @param count Samples written.
+ * @param sequence Sequence number of the first of them.
+ * @param lastTimestamp Capture time of the last of them.
+ * @param interval Microseconds between samples.
+ */
+void SampleBus::commit(std::size_t stream, std::size_t count, std::uint64_t sequence, std::int64_t lastTimestamp,
+                       std::uint32_t interval) {
+    Stream &s = streams[stream];
+    s.nextSequence.store(sequence + count, std::memory_order_relaxed);
+    s.lastTimestamp.store(lastTimestamp, std::memory_order_relaxed);
+    s.interval.store(interval, std::memory_order_relaxed);
+    s.written.store(s.written.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
+
+/**
+ * @brief Copies committed samples out of a stream.
+ * @param stream Stream index.
+ * @param from First bus position wanted.
+ * @param out Destination.
+ * @param maxCount Room in the destination.
+ * @param[out] start Bus position of out[0].
+ * @return std::size_t Samples copied.
+ */
+std::size_t SampleBus::read(std::size_t stream, std::uint64_t from, std::int16_t *out, std::size_t maxCount,
+                            std::uint64_t &start) const {
+    const Stream &s = streams[stream];
+    const std::uint64_t capacity = mask + 1;
+    std::uint64_t written = s.written.load(std::memory_order_acquire);
+    std::uint64_t reserved = s.reserved.load(std::memory_order_relaxed);
+    std::uint64_t oldest = reserved > capacity ? reserved - capacity : 0;
+    start = std::max(from, oldest);
+    if (start >= written) {
+        start = written;
+        return 0;
+    }
+    std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(written - start, maxCount));
+    std::size_t offset = static_cast<std::size_t>(start & mask);
+    std::size_t head = std::min<std::size_t>(count, capacity - offset);
+    std::memcpy(out, s.ring.get() + offset, head * sizeof(std::int16_t));
+    std::memcpy(out + head, s.ring.get(), (count - head) * sizeof(std::int16_t));
+
+    // Whatever the writer reserved over while we copied may be torn; drop it from the front.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    reserved = s.reserved.load(std::memory_order_relaxed);
+    oldest = reserved > capacity ? reserved - capacity : 0;
+    if (oldest > start) {
+        std::uint64_t torn = std::min<std::uint64_t>(oldest - start, count);
+        std::memmove(out, out + torn, static_cast<std::size_t>(count - torn) * sizeof(std::int16_t));
+        count -= static_cast<std::size_t>(torn);
+        start += torn;
+    }
+    return count;
+}
+
+/**
+ * @brief Gets a stream's bookkeeping.
+ * @param stream Stream index.
+ * @return SampleStreamInfo The snapshot.
+ */
+SampleStreamInfo SampleBus::info(std::size_t stream) const {
+    const Stream &s = streams[stream];
+    SampleStreamInfo info;
+    info.id = s.id;
+    info.written = s.written.load(std::memory_order_acquire);
+    info.nextSequence = s.nextSequence.load(std::memory_order_relaxed);
+    info.lastTimestamp = s.lastTimestamp.load(std::memory_order_relaxed);
+    info.interval = s.interval.load(std::memory_order_relaxed);
+    info.lost = s.lost.load(std::memory_order_relaxed);
+    info.duplicates = s.duplicates.load(std::memory_order_relaxed);
+    return info;
+}
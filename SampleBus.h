@@ -0,0 +1,186 @@
+#ifndef SAMPLEBUS_H
+#define SAMPLEBUS_H
+
+/**
+ * @file SampleBus.h
+ * @brief Declaration of the in-memory bus that carries raw sample streams from the receiver to consumers.
+ *
+ * This header declares a set of per-stream ring buffers of 16-bit samples. One writer (SampleServer)
+ * reserves space in a ring, fills it, for example by reading a socket straight into it, and commits it;
+ * any number of readers on other threads copy recent samples out without locking.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief Space reserved in a stream's ring; the second part is non-empty when the space wraps around.
+ */
+struct SampleSpan {
+    std::int16_t *first = nullptr;      /**< First part. */
+    std::size_t firstCount = 0;         /**< Samples in the first part. */
+    std::int16_t *second = nullptr;     /**< Second part, at the start of the ring. */
+    std::size_t secondCount = 0;        /**< Samples in the second part. */
+};
+
+/**
+ * @brief Snapshot of a stream's bookkeeping.
+ */
+struct SampleStreamInfo {
+    std::uint32_t id = 0;               /**< Stream identifier. */
+    std::uint64_t written = 0;          /**< Samples committed so far (bus positions 0 to written - 1). */
+    std::uint64_t nextSequence = 0;     /**< Device sequence number expected next. */
+    std::int64_t lastTimestamp = 0;     /**< Capture time of the newest sample (microseconds since epoch). */
+    std::uint32_t interval = 0;         /**< Microseconds between samples. */
+    std::uint64_t lost = 0;             /**< Samples skipped by sequence gaps. */
+    std::uint64_t duplicates = 0;       /**< Samples dropped as retransmissions. */
+};
+
+/**
+ * @class SampleBus
+ * @brief Fixed-size per-stream sample rings with one writer and lock-free readers.
+ *
+ * Samples are addressed by bus position, which counts the samples committed to a stream; sequence gaps on
+ * the wire are counted in SampleStreamInfo::lost rather than left as holes in the ring. Each ring holds the
+ * newest samplesPerStream samples (rounded up to a power of two), and older ones are overwritten.
+ *
+ * Readers follow the seqlock pattern: they copy, then check how far the writer has reserved and discard
+ * whatever it may have overwritten meanwhile, so a reader never returns a torn sample. Streams are opened
+ * and written on the writer thread only; they are never closed, so stream indices stay valid.
+ */
+class SampleBus {
+public:
+    /**
+     * @brief Constructs an empty bus.
+     * @param maxStreams Largest number of streams.
+     * @param samplesPerStream Ring capacity per stream (rounded up to a power of two).
+     */
+    explicit SampleBus(std::size_t maxStreams = 1024, std::size_t samplesPerStream = 8192);
+
+    SampleBus(const SampleBus &) = delete;
+    SampleBus &operator=(const SampleBus &) = delete;
+
+    /**
+     * @brief Finds or creates a stream (writer thread only).
+     * @param id Stream identifier.
+     * @return long long Stream index, or -1 if maxStreams streams are already open.
+     */
+    long long open(std::uint32_t id);
+
+    /**
+     * @brief Finds a stream (any thread).
+     * @param id Stream identifier.
+     * @return long long Stream index, or -1 if the stream has not been opened.
+     */
+    long long find(std::uint32_t id) const;
+
+    /** @return std::size_t Number of open streams (any thread). */
+    std::size_t streamCount() const { return opened.load(std::memory_order_acquire); }
+
+    /** @return std::size_t Ring capacity per stream in samples. */
+    std::size_t capacity() const { return mask + 1; }
+
+    /**
+     * @brief Decides whether a frame continues a stream (writer thread only).
+     *
+     * A frame that starts at or after the expected sequence number is accepted and any gap is counted as
+     * lost. A frame that starts before it is a retransmission: the samples already committed are skipped
+     * and counted as duplicates, and only the rest, if any, is accepted. The restart flag accepts the whole
+     * frame and resets the expected sequence number.
+     *
+     * @param stream Stream index.
+     * @param sequence Sequence number of the frame's first sample.
+     * @param count Samples in the frame.
+     * @param restart True if the device restarted its numbering.
+     * @param[out] skip Leading samples of the frame to drop before committing the rest.
+     * @return bool True if the frame has samples to commit.
+     */
+    bool admit(std::size_t stream, std::uint64_t sequence, std::size_t count, bool restart, std::size_t &skip);
+
+    /**
+     * @brief Tells whether a frame would leave a gap before it (writer thread only).
+     *
+     * A receiver whose transport can reorder frames holds such a frame back for a moment, in case the frames
+     * before it are still on their way, instead of letting admit() count them as lost.
+     *
+     * @param stream Stream index.
+     * @param sequence Sequence number of the frame's first sample.
+     * @return bool True if the stream has started and the frame starts after the expected sequence number.
+     */
+    bool ahead(std::size_t stream, std::uint64_t sequence) const;
+
+    /**
+     * @brief Reserves space for the next samples of a stream (writer thread only).
+     *
+     * The oldest samples of the ring become unreadable as soon as they are reserved over.
+     *
+     * @param stream Stream index.
+     * @param count Samples to reserve (at most capacity()).
+     * @return SampleSpan Where to write them.
+     */
+    SampleSpan reserve(std::size_t stream, std::size_t count);
+
+    /**
+     * @brief Publishes reserved samples (writer thread only).
+     * @param stream Stream index.
+     * @param count Samples written into the last reservation.
+     * @param sequence Sequence number of the first of them.
+     * @param lastTimestamp Capture time of the last of them.
+     * @param interval Microseconds between samples.
+     */
+    void commit(std::size_t stream, std::size_t count, std::uint64_t sequence, std::int64_t lastTimestamp,
+                std::uint32_t interval);
+
+    /**
+     * @brief Copies committed samples out of a stream (any thread).
+     *
+     * If the requested position has already been overwritten the copy starts at the oldest sample still
+     * held, which the caller can detect through @p start.
+     *
+     * @param stream Stream index.
+     * @param from First bus position wanted.
+     * @param out Destination.
+     * @param maxCount Room in the destination.
+     * @param[out] start Bus position of out[0].
+     * @return std::size_t Samples copied.
+     */
+    std::size_t read(std::size_t stream, std::uint64_t from, std::int16_t *out, std::size_t maxCount,
+                     std::uint64_t &start) const;
+
+    /**
+     * @brief Gets a stream's bookkeeping (any thread).
+     * @param stream Stream index.
+     * @return SampleStreamInfo The snapshot.
+     */
+    SampleStreamInfo info(std::size_t stream) const;
+
+private:
+    /**
+     * @brief One stream's ring and counters.
+     */
+    struct Stream {
+        std::uint32_t id = 0;                                   /**< Stream identifier. */
+        std::unique_ptr<std::int16_t[]> ring;                   /**< Sample storage. */
+        std::atomic<std::uint64_t> written{0};                  /**< Samples committed. */
+        std::atomic<std::uint64_t> reserved{0};                 /**< End of the furthest reservation. */
+        std::atomic<std::uint64_t> nextSequence{0};             /**< Device sequence expected next. */
+        std::atomic<std::int64_t> lastTimestamp{0};             /**< Capture time of the newest sample. */
+        std::atomic<std::uint32_t> interval{0};                 /**< Microseconds between samples. */
+        std::atomic<std::uint64_t> lost{0};                     /**< Samples skipped by gaps. */
+        std::atomic<std::uint64_t> duplicates{0};               /**< Samples dropped as retransmissions. */
+        bool started = false;                                   /**< A frame has been admitted. */
+    };
+
+    std::size_t mask;                                           /**< Ring capacity minus one. */
+    std::unique_ptr<Stream[]> streams;                          /**< Stream slots. */
+    std::size_t maxStreams;                                     /**< Number of stream slots. */
+    std::atomic<std::size_t> opened{0};                         /**< Slots in use. */
+    mutable std::mutex indexMutex;                              /**< Guards ids. */
+    std::unordered_map<std::uint32_t, std::size_t> ids;         /**< Stream identifier to index. */
+};
+
+#endif // SAMPLEBUS_H
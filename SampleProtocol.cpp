@@ -0,0 +1,72 @@
+/**
+ * @file SampleProtocol.cpp
+ * @brief Implements encoding and decoding of sample frames.
+ */
+
+#include "SampleProtocol.h"
+
+const char SampleProtocol::kMagic[4] = {'H', 'P', 'S', '1'};
+const std::size_t SampleProtocol::kHeaderBytes;
+const std::size_t SampleProtocol::kMaxFrameSamples;
+const std::uint16_t SampleProtocol::kFlagRestart;
+
+namespace {
+
+/**
+ * @brief Reads a little-endian unsigned integer.
+ * @param bytes First byte.
+ * @param size Width in bytes.
+ * @return std::uint64_t The value.
+ */
+std::uint64_t loadLittle(const unsigned char *bytes, int size) {
+    std::uint64_t value = 0;
+    for (int i = size - 1; i >= 0; --i) value = value << 8 | bytes[i];
+    return value;
+}
+
+/**
+ * @brief Appends a little-endian unsigned integer.
+ * @param out Buffer.
+ * @param value The value.
+ * @param size Width in bytes.
+ */
+void storeLittle(std::string &out, std::uint64_t value, int size) {
+    for (int i = 0; i < size; ++i) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+} // namespace
+
+/**
+ * @brief Decodes and checks a frame header.
+ * @param bytes Header bytes.
+ * @param[out] header The decoded header.
+ * @return bool False if the header is inconsistent.
+ */
+bool SampleProtocol::decodeHeader(const unsigned char *bytes, SampleFrameHeader &header) {
+    std::uint64_t length = loadLittle(bytes, 4);
+    header.streamId = static_cast<std::uint32_t>(loadLittle(bytes + 4, 4));
+    header.sequence = loadLittle(bytes + 8, 8);
+    header.timestamp = static_cast<std::int64_t>(loadLittle(bytes + 16, 8));
+    header.interval = static_cast<std::uint32_t>(loadLittle(bytes + 24, 4));
+    header.sampleCount = static_cast<std::uint16_t>(loadLittle(bytes + 28, 2));
+    header.flags = static_cast<std::uint16_t>(loadLittle(bytes + 30, 2));
+    return header.sampleCount > 0 && header.sampleCount <= kMaxFrameSamples &&
+           length == kHeaderBytes - 4 + 2 * static_cast<std::uint64_t>(header.sampleCount);
+}
+
+/**
+ * @brief Appends an encoded frame to a buffer.
+ * @param out Buffer to append to.
+ * @param header Frame header.
+ * @param samples The samples.
+ */
+void SampleProtocol::appendFrame(std::string &out, const SampleFrameHeader &header, const std::int16_t *samples) {
+    storeLittle(out, kHeaderBytes - 4 + 2 * static_cast<std::uint64_t>(header.sampleCount), 4);
+    storeLittle(out, header.streamId, 4);
+    storeLittle(out, header.sequence, 8);
+    storeLittle(out, static_cast<std::uint64_t>(header.timestamp), 8);
+    storeLittle(out, header.interval, 4);
+    storeLittle(out, header.sampleCount, 2);
+    storeLittle(out, header.flags, 2);
+    for (std::uint16_t i = 0; i < header.sampleCount; ++i) storeLittle(out, static_cast<std::uint16_t>(samples[i]), 2);
+}
@@ -0,0 +1,72 @@
+#ifndef SAMPLEPROTOCOL_H
+#define SAMPLEPROTOCOL_H
+
+/**
+ * @file SampleProtocol.h
+ * @brief Declaration of the length-prefixed binary protocol bedside devices use to stream raw samples.
+ *
+ * This header declares the wire format spoken between a device and SampleServer. A connection starts with
+ * the four bytes "HPS1" and then carries frames, each holding a batch of 16-bit samples from one stream:
+ *
+ *     offset  size  field
+ *          0     4  length          bytes after this field: 28 + 2 * sampleCount
+ *          4     4  streamId        device-chosen stream identifier
+ *          8     8  sequence        sequence number of the first sample in the frame
+ *         16     8  timestamp       capture time of the first sample, microseconds since epoch
+ *         24     4  interval        microseconds between samples
+ *         28     2  sampleCount     samples in the frame (1 to kMaxFrameSamples)
+ *         30     2  flags           kFlagRestart: the device restarted its sequence numbering
+ *         32   2*n  samples         signed 16-bit samples
+ *
+ * All integers are little-endian. Sequence numbers count samples, not frames, so a receiver can tell how
+ * many samples a gap lost.
+ *
+ * Over UDP a datagram carries exactly one frame and no preamble. Datagrams may arrive twice or out of order,
+ * so the receiver puts them back in sequence; devices should keep frames below the path MTU.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Decoded frame header.
+ */
+struct SampleFrameHeader {
+    std::uint32_t streamId = 0;         /**< Stream identifier. */
+    std::uint64_t sequence = 0;         /**< Sequence number of the first sample. */
+    std::int64_t timestamp = 0;         /**< Capture time of the first sample (microseconds since epoch). */
+    std::uint32_t interval = 0;         /**< Microseconds between samples. */
+    std::uint16_t sampleCount = 0;      /**< Samples in the frame. */
+    std::uint16_t flags = 0;            /**< Frame flags. */
+};
+
+/**
+ * @class SampleProtocol
+ * @brief Encodes and decodes sample frames.
+ */
+class SampleProtocol {
+public:
+    static const char kMagic[4];                            /**< Connection preamble, "HPS1". */
+    static const std::size_t kHeaderBytes = 32;             /**< Length prefix plus header. */
+    static const std::size_t kMaxFrameSamples = 4096;       /**< Largest batch accepted in one frame. */
+    static const std::uint16_t kFlagRestart = 0x0001;       /**< Sequence numbering restarted. */
+
+    /**
+     * @brief Decodes and checks a frame header.
+     * @param bytes kHeaderBytes bytes starting at the length prefix.
+     * @param[out] header The decoded header.
+     * @return bool False if the length does not match the sample count or the count is out of range.
+     */
+    static bool decodeHeader(const unsigned char *bytes, SampleFrameHeader &header);
+
+    /**
+     * @brief Appends an encoded frame to a buffer.
+     * @param out Buffer to append to.
+     * @param header Frame header (sampleCount gives the number of samples).
+     * @param samples The samples.
+     */
+    static void appendFrame(std::string &out, const SampleFrameHeader &header, const std::int16_t *samples);
+};
+
+#endif // SAMPLEPROTOCOL_H
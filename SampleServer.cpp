@@ -0,0 +1,606 @@
+/**
+ * @file SampleServer.cpp
+ * @brief Implements the epoll receiver for the binary sample protocol.
+ */
+
+#include "SampleServer.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+const std::size_t kMaxReadPerEvent = 256 * 1024;    // Keeps one fast device from starving the others.
+const int kMaxEvents = 64;
+const std::uint64_t kUdpOwnerBit = 1ULL << 62;      // Set in the writer key of a UDP sender, not of a connection.
+const std::size_t kDatagramBytes =
+    SampleProtocol::kHeaderBytes + SampleProtocol::kMaxFrameSamples * sizeof(std::int16_t);
+
+/**
+ * @brief Copies little-endian samples into place.
+ * @param to Destination.
+ * @param from Wire bytes.
+ * @param count Samples to copy.
+ */
+void copySamples(std::int16_t *to, const unsigned char *from, std::size_t count) {
+    if (count == 0) return;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (std::size_t i = 0; i < count; ++i)
+        to[i] = static_cast<std::int16_t>(from[2 * i] | from[2 * i + 1] << 8);
+#else
+    std::memcpy(to, from, count * sizeof(std::int16_t));
+#endif
+}
+
+} // namespace
+
+const std::size_t SampleServer::kStagingBytes;
+const std::size_t SampleServer::kUdpBatch;
+const std::size_t SampleServer::kReorderFrames;
+const int SampleServer::kReorderWaitMs;
+const int SampleServer::kUdpOwnerIdleMs;
+const std::uint64_t SampleServer::kNoOwner;
+
+/**
+ * @brief Constructs a server that is not listening yet.
+ * @param bus Bus that receives the samples.
+ */
+SampleServer::SampleServer(SampleBus &bus)
+    : bus(bus), discard(SampleProtocol::kMaxFrameSamples * sizeof(std::int16_t)) {}
+
+SampleServer::~SampleServer() {
+    for (auto &entry : connections) ::close(entry.first);
+    if (listenFd >= 0) ::close(listenFd);
+    if (udpFd >= 0) ::close(udpFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+/**
+ * @brief Starts listening.
+ * @param address IPv4 address to bind.
+ * @param port TCP port (0 picks a free one).
+ * @return bool False if the socket could not be bound.
+ */
+bool SampleServer::listen(const std::string &address, std::uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        ErrorHandling::logErrorMessage("Sample server: invalid address " + address);
+        return false;
+    }
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int yes = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0 || !startPolling()) {
+        ErrorHandling::logErrorMessage("Sample server: cannot listen on " + address + ":" + std::to_string(port) +
+                                       ": " + std::strerror(errno));
+        if (listenFd >= 0) ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr *>(&addr), &length);
+    boundPort = ntohs(addr.sin_port);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    return true;
+}
+
+/**
+ * @brief Starts receiving datagrams as well.
+ * @param address IPv4 address to bind.
+ * @param port UDP port (0 picks a free one).
+ * @return bool False if the socket could not be bound.
+ */
+bool SampleServer::listenUdp(const std::string &address, std::uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        ErrorHandling::logErrorMessage("Sample server: invalid address " + address);
+        return false;
+    }
+    udpFd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    // Datagrams that arrive while the server is busy wait in the socket; a larger buffer rides out bursts.
+    int bufferBytes = 4 * 1024 * 1024;
+    setsockopt(udpFd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+    if (udpFd < 0 || ::bind(udpFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || !startPolling()) {
+        ErrorHandling::logErrorMessage("Sample server: cannot receive on UDP " + address + ":" + std::to_string(port) +
+                                       ": " + std::strerror(errno));
+        if (udpFd >= 0) ::close(udpFd);
+        udpFd = -1;
+        return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(udpFd, reinterpret_cast<sockaddr *>(&addr), &length);
+    boundUdpPort = ntohs(addr.sin_port);
+    datagrams.resize(kUdpBatch * kDatagramBytes);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = udpFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, udpFd, &event);
+    return true;
+}
+
+/**
+ * @brief Creates the epoll instance and wake descriptor on first use.
+ * @return bool False if they could not be created.
+ */
+bool SampleServer::startPolling() {
+    if (epollFd >= 0) return true;
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        if (epollFd >= 0) ::close(epollFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+        epollFd = wakeFd = -1;
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    return true;
+}
+
+/**
+ * @brief Waits for and handles socket events once.
+ * @param timeoutMs Longest wait in milliseconds.
+ * @return bool False if the server is not listening or the wait failed.
+ */
+bool SampleServer::poll(int timeoutMs) {
+    if (epollFd < 0) return false;
+    epoll_event events[kMaxEvents];
+    int ready = epoll_wait(epollFd, events, kMaxEvents, timeoutMs);
+    if (ready < 0) return errno == EINTR;
+    for (int i = 0; i < ready; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == listenFd) {
+            acceptClients();
+            continue;
+        }
+        if (fd == udpFd) {
+            readDatagrams();
+            continue;
+        }
+        if (fd == wakeFd) {
+            std::uint64_t value = 0;
+            while (::read(wakeFd, &value, sizeof(value)) > 0) {}
+            continue;
+        }
+        auto it = connections.find(fd);
+        if (it != connections.end() && !readClient(fd, it->second)) closeClient(fd);
+    }
+    if (heldFrames > 0) expireHeld(Clock::now());
+    return true;
+}
+
+/**
+ * @brief Handles events until stop() is called.
+ */
+void SampleServer::run() {
+    while (!stopping.load(std::memory_order_relaxed))
+        if (!poll(heldFrames > 0 ? kReorderWaitMs : -1)) break;
+    stopping.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Makes run() return.
+ */
+void SampleServer::stop() {
+    stopping.store(true, std::memory_order_relaxed);
+    if (wakeFd >= 0) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+/**
+ * @brief Accepts every pending connection.
+ */
+void SampleServer::acceptClients() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                ErrorHandling::logErrorMessage(std::string("Sample server: accept failed: ") + std::strerror(errno));
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections[fd].owner = static_cast<std::uint64_t>(fd);
+        connectionsOpen.store(connections.size(), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Reads what a connection has sent and decodes every complete frame in it.
+ *
+ * While a payload is outstanding, one readv() asks for the rest of it, in place in the ring, plus as much
+ * of what follows as the staging area holds.
+ *
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ * @return bool False if the connection should be closed.
+ */
+bool SampleServer::readClient(int fd, Connection &connection) {
+    std::size_t total = 0;
+    while (total < kMaxReadPerEvent) {
+        iovec parts[4];
+        int count = 0;
+        std::size_t payloadWanted = 0;
+        if (connection.inPayload) {
+            std::size_t skip = connection.payloadDone;
+            for (int s = 0; s < 3; ++s) {
+                std::size_t size = connection.segmentBytes[s];
+                if (skip >= size) {
+                    skip -= size;
+                    continue;
+                }
+                parts[count].iov_base = connection.segment[s] + skip;
+                parts[count].iov_len = size - skip;
+                payloadWanted += size - skip;
+                ++count;
+                skip = 0;
+            }
+        }
+        if (connection.begin == connection.end) {
+            connection.begin = connection.end = 0;
+        } else if (connection.begin > 0) {
+            std::memmove(connection.staging, connection.staging + connection.begin,
+                         connection.end - connection.begin);
+            connection.end -= connection.begin;
+            connection.begin = 0;
+        }
+        std::size_t stagingWanted = kStagingBytes - connection.end;
+        if (stagingWanted > 0) {
+            parts[count].iov_base = connection.staging + connection.end;
+            parts[count].iov_len = stagingWanted;
+            ++count;
+        }
+
+        ssize_t got = ::readv(fd, parts, count);
+        if (got == 0) return false;
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        std::size_t bytes = static_cast<std::size_t>(got);
+        total += bytes;
+        std::size_t intoPayload = std::min(bytes, payloadWanted);
+        connection.payloadDone += intoPayload;
+        connection.end += bytes - intoPayload;
+        if (!decode(connection)) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // A short read means the socket is drained for now.
+        if (bytes < payloadWanted + stagingWanted) break;
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes the staged bytes of a connection as far as they go.
+ * @param connection Connection state.
+ * @return bool False on a protocol violation.
+ */
+bool SampleServer::decode(Connection &connection) {
+    while (true) {
+        if (connection.inPayload) {
+            // Payload bytes that arrived together with their header are moved into place once.
+            std::size_t frameBytes =
+                connection.segmentBytes[0] + connection.segmentBytes[1] + connection.segmentBytes[2];
+            while (connection.payloadDone < frameBytes && connection.begin < connection.end) {
+                std::size_t offset = connection.payloadDone;
+                int s = 0;
+                while (offset >= connection.segmentBytes[s]) offset -= connection.segmentBytes[s++];
+                std::size_t take = std::min(connection.segmentBytes[s] - offset, connection.end - connection.begin);
+                std::memcpy(connection.segment[s] + offset, connection.staging + connection.begin, take);
+                connection.begin += take;
+                connection.payloadDone += take;
+            }
+            if (connection.payloadDone < frameBytes) return true;
+            finishFrame(connection);
+            continue;
+        }
+        std::size_t available = connection.end - connection.begin;
+        if (!connection.greeted) {
+            if (available < sizeof(SampleProtocol::kMagic)) return true;
+            if (std::memcmp(connection.staging + connection.begin, SampleProtocol::kMagic,
+                            sizeof(SampleProtocol::kMagic)) != 0)
+                return false;
+            connection.begin += sizeof(SampleProtocol::kMagic);
+            connection.greeted = true;
+            continue;
+        }
+        if (available < SampleProtocol::kHeaderBytes) return true;
+        if (!SampleProtocol::decodeHeader(connection.staging + connection.begin, connection.header)) return false;
+        connection.begin += SampleProtocol::kHeaderBytes;
+        if (!startFrame(connection)) return false;
+    }
+}
+
+/**
+ * @brief Picks the destination of a frame whose header was just decoded.
+ *
+ * New samples are read into a fresh reservation in their stream's ring. Samples the stream already has,
+ * and frames larger than the ring, are read into the scratch area.
+ *
+ * @param connection Connection state.
+ * @return bool False if the bus has no room for another stream or another writer owns the stream.
+ */
+bool SampleServer::startFrame(Connection &connection) {
+    const SampleFrameHeader &header = connection.header;
+    if (connection.cachedStream < 0 || connection.cachedId != header.streamId) {
+        Writer *writer = claim(header.streamId, connection.owner, Clock::now());
+        if (!writer) return false;
+        connection.cachedStream = static_cast<long long>(writer->stream);
+        connection.cachedId = header.streamId;
+        if (std::find(connection.owned.begin(), connection.owned.end(), header.streamId) == connection.owned.end())
+            connection.owned.push_back(header.streamId);
+    }
+    connection.stream = static_cast<std::size_t>(connection.cachedStream);
+    std::size_t skip = 0;
+    connection.accepted = header.sampleCount <= bus.capacity() &&
+                          bus.admit(connection.stream, header.sequence, header.sampleCount,
+                                    (header.flags & SampleProtocol::kFlagRestart) != 0, skip);
+    connection.skipped = connection.accepted ? skip : header.sampleCount;
+    connection.segment[0] = discard.data();
+    connection.segmentBytes[0] = connection.skipped * sizeof(std::int16_t);
+    connection.segment[1] = connection.segment[2] = nullptr;
+    connection.segmentBytes[1] = connection.segmentBytes[2] = 0;
+    if (connection.accepted) {
+        SampleSpan span = bus.reserve(connection.stream, header.sampleCount - connection.skipped);
+        connection.segment[1] = reinterpret_cast<unsigned char *>(span.first);
+        connection.segmentBytes[1] = span.firstCount * sizeof(std::int16_t);
+        connection.segment[2] = reinterpret_cast<unsigned char *>(span.second);
+        connection.segmentBytes[2] = span.secondCount * sizeof(std::int16_t);
+    }
+    connection.payloadDone = 0;
+    connection.inPayload = true;
+    return true;
+}
+
+/**
+ * @brief Commits a frame whose payload is complete.
+ * @param connection Connection state.
+ */
+void SampleServer::finishFrame(Connection &connection) {
+    connection.inPayload = false;
+    if (!connection.accepted) return;
+    const SampleFrameHeader &header = connection.header;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    // The wire is little-endian; on a big-endian host the samples are swapped where they landed.
+    for (int s = 1; s < 3; ++s) {
+        unsigned char *bytes = connection.segment[s];
+        for (std::size_t i = 0; i + 1 < connection.segmentBytes[s]; i += 2) std::swap(bytes[i], bytes[i + 1]);
+    }
+#endif
+    std::int64_t lastTimestamp = header.timestamp + static_cast<std::int64_t>(header.sampleCount - 1) *
+                                                        static_cast<std::int64_t>(header.interval);
+    std::size_t count = header.sampleCount - connection.skipped;
+    bus.commit(connection.stream, count, header.sequence + connection.skipped, lastTimestamp, header.interval);
+    frames.fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(count, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Closes a connection and frees the streams it wrote, so a device that reconnects can resume them.
+ * @param fd Client descriptor.
+ */
+void SampleServer::closeClient(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    auto it = connections.find(fd);
+    if (it != connections.end()) {
+        for (std::uint32_t streamId : it->second.owned) {
+            auto writer = writers.find(streamId);
+            if (writer != writers.end() && writer->second.owner == it->second.owner) writer->second.owner = kNoOwner;
+        }
+        connections.erase(it);
+    }
+    connectionsOpen.store(connections.size(), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Finds or opens a stream for a writer, refusing it if another writer owns the stream.
+ *
+ * Two devices configured with the same stream identifier would otherwise interleave their samples in one
+ * ring, each one's frames counting as the other's gaps and retransmissions.
+ *
+ * @param streamId Stream identifier.
+ * @param owner Writer key.
+ * @param now Current time.
+ * @return Writer* The stream's writer entry, or nullptr if it was refused or the bus is full.
+ */
+SampleServer::Writer *SampleServer::claim(std::uint32_t streamId, std::uint64_t owner, Clock::time_point now) {
+    auto it = writers.find(streamId);
+    if (it == writers.end()) {
+        long long stream = bus.open(streamId);
+        if (stream < 0) {
+            ErrorHandling::logErrorMessage("Sample server: no room for stream " + std::to_string(streamId));
+            return nullptr;
+        }
+        it = writers.emplace(streamId, Writer()).first;
+        it->second.stream = static_cast<std::size_t>(stream);
+    }
+    Writer &writer = it->second;
+    if (writer.owner != owner) {
+        bool lapsed = writer.owner == kNoOwner ||
+                      ((writer.owner & kUdpOwnerBit) != 0 && writer.held.empty() &&
+                       now - writer.lastSeen > std::chrono::milliseconds(kUdpOwnerIdleMs));
+        if (!lapsed) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            // Datagrams are dropped silently; logging each one would flood the log.
+            if ((owner & kUdpOwnerBit) == 0)
+                ErrorHandling::logErrorMessage("Sample server: stream " + std::to_string(streamId) +
+                                               " already has a writer");
+            return nullptr;
+        }
+        writer.owner = owner;
+    }
+    writer.lastSeen = now;
+    return &writer;
+}
+
+/**
+ * @brief Receives and handles every pending datagram, kUdpBatch per system call.
+ */
+void SampleServer::readDatagrams() {
+    mmsghdr messages[kUdpBatch];
+    iovec parts[kUdpBatch];
+    sockaddr_in senders[kUdpBatch];
+    std::size_t total = 0;
+    while (total < kMaxReadPerEvent) {
+        for (std::size_t i = 0; i < kUdpBatch; ++i) {
+            parts[i].iov_base = datagrams.data() + i * kDatagramBytes;
+            parts[i].iov_len = kDatagramBytes;
+            std::memset(&messages[i], 0, sizeof(messages[i]));
+            messages[i].msg_hdr.msg_name = &senders[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+            messages[i].msg_hdr.msg_iov = &parts[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int got = recvmmsg(udpFd, messages, kUdpBatch, MSG_DONTWAIT, nullptr);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                ErrorHandling::logErrorMessage(std::string("Sample server: recvmmsg failed: ") + std::strerror(errno));
+            return;
+        }
+        Clock::time_point now = Clock::now();
+        for (int i = 0; i < got; ++i) {
+            std::size_t size = messages[i].msg_len;
+            total += size;
+            // A truncated datagram was longer than any valid frame.
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) size = 0;
+            std::uint64_t owner = kUdpOwnerBit | static_cast<std::uint64_t>(ntohl(senders[i].sin_addr.s_addr)) << 16 |
+                                  ntohs(senders[i].sin_port);
+            handleDatagram(datagrams.data() + i * kDatagramBytes, size, owner, now);
+        }
+        if (static_cast<std::size_t>(got) < kUdpBatch) break;
+    }
+}
+
+/**
+ * @brief Handles one received datagram.
+ *
+ * A frame that starts after the expected sequence number may have been overtaken by the ones before it,
+ * so it is held, in sequence order, instead of being admitted with a gap. A duplicate of a held frame is
+ * held too; admit() drops it as a retransmission once its twin is in.
+ *
+ * @param bytes The datagram.
+ * @param size Its size.
+ * @param owner Sender key.
+ * @param now Receive time.
+ */
+void SampleServer::handleDatagram(const unsigned char *bytes, std::size_t size, std::uint64_t owner,
+                                  Clock::time_point now) {
+    SampleFrameHeader header;
+    if (size < SampleProtocol::kHeaderBytes || !SampleProtocol::decodeHeader(bytes, header) ||
+        size != SampleProtocol::kHeaderBytes + header.sampleCount * sizeof(std::int16_t)) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Writer *writer = claim(header.streamId, owner, now);
+    if (!writer) return;
+    const unsigned char *payload = bytes + SampleProtocol::kHeaderBytes;
+    if ((header.flags & SampleProtocol::kFlagRestart) == 0 && bus.ahead(writer->stream, header.sequence)) {
+        HeldFrame frame;
+        frame.header = header;
+        frame.payload.assign(reinterpret_cast<const char *>(payload), size - SampleProtocol::kHeaderBytes);
+        frame.since = now;
+        auto at = std::upper_bound(writer->held.begin(), writer->held.end(), header.sequence,
+                                   [](std::uint64_t sequence, const HeldFrame &held) {
+                                       return sequence < held.header.sequence;
+                                   });
+        writer->held.insert(at, std::move(frame));
+        ++heldFrames;
+        if (writer->held.size() > kReorderFrames) releaseHeld(*writer, true);
+        return;
+    }
+    if (commitFrame(writer->stream, header, payload) && !writer->held.empty()) releaseHeld(*writer, false);
+}
+
+/**
+ * @brief Admits and commits a frame whose payload is in memory.
+ * @param stream Bus index.
+ * @param header Frame header.
+ * @param payload Little-endian samples.
+ * @return bool True if any of it was committed, false if it was dropped.
+ */
+bool SampleServer::commitFrame(std::size_t stream, const SampleFrameHeader &header, const unsigned char *payload) {
+    std::size_t skip = 0;
+    if (header.sampleCount > bus.capacity() ||
+        !bus.admit(stream, header.sequence, header.sampleCount, (header.flags & SampleProtocol::kFlagRestart) != 0,
+                   skip))
+        return false;
+    std::size_t count = header.sampleCount - skip;
+    payload += skip * sizeof(std::int16_t);
+    SampleSpan span = bus.reserve(stream, count);
+    copySamples(span.first, payload, span.firstCount);
+    copySamples(span.second, payload + span.firstCount * sizeof(std::int16_t), span.secondCount);
+    std::int64_t lastTimestamp = header.timestamp + static_cast<std::int64_t>(header.sampleCount - 1) *
+                                                        static_cast<std::int64_t>(header.interval);
+    bus.commit(stream, count, header.sequence + skip, lastTimestamp, header.interval);
+    frames.fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(count, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Commits held datagrams of a stream that are now in sequence.
+ *
+ * When forced, the first held datagram goes in even though frames before it are still missing; admit()
+ * then counts them as lost, and any later arrival of them as a retransmission.
+ *
+ * @param writer The stream's writer.
+ * @param force Commit the first held datagram regardless.
+ */
+void SampleServer::releaseHeld(Writer &writer, bool force) {
+    while (!writer.held.empty()) {
+        const HeldFrame &frame = writer.held.front();
+        bool gap = bus.ahead(writer.stream, frame.header.sequence);
+        if (gap && !force) break;
+        force = false;
+        if (commitFrame(writer.stream, frame.header, reinterpret_cast<const unsigned char *>(frame.payload.data())) &&
+            !gap)
+            reordered.fetch_add(1, std::memory_order_relaxed);
+        writer.held.erase(writer.held.begin());
+        --heldFrames;
+    }
+}
+
+/**
+ * @brief Gives up waiting on gaps that held datagrams have waited on for kReorderWaitMs.
+ * @param now Current time.
+ */
+void SampleServer::expireHeld(Clock::time_point now) {
+    for (auto &entry : writers) {
+        Writer &writer = entry.second;
+        while (!writer.held.empty() && now - writer.held.front().since >= std::chrono::milliseconds(kReorderWaitMs))
+            releaseHeld(writer, true);
+    }
+}
@@ -0,0 +1,278 @@
+#ifndef SAMPLESERVER_H
+#define SAMPLESERVER_H
+
+/**
+ * @file SampleServer.h
+ * @brief Declaration of the receiver for the binary sample protocol.
+ *
+ * This header declares a single-threaded epoll server that accepts SampleProtocol connections from bedside
+ * devices and decodes their frames into a SampleBus. Sample payloads are read with readv() straight into
+ * the reserved space of the stream's ring, so high-rate ECG does not pass through a parse buffer. Devices
+ * that cannot keep a connection open may send the same frames as UDP datagrams instead.
+ */
+
+#include "SampleBus.h"
+#include "SampleProtocol.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class SampleServer
+ * @brief Non-blocking receiver that decodes sample frames into a SampleBus.
+ *
+ * Each readv() fills up to three places at once: the rest of the current frame's payload, in the one or
+ * two parts of its ring reservation, and a small per-connection staging area that catches the next frame
+ * headers. A payload byte therefore lands in the ring directly, or, if it arrived in the same read as its
+ * header, is copied from staging into the ring once. The samples of a retransmitted frame that are already
+ * in the ring are read into a scratch area and dropped, and any new samples after them are kept; a
+ * malformed frame closes the connection.
+ *
+ * Datagrams are received in batches with recvmmsg(). A stream's ring position is only known once the
+ * header has been read, so datagram payloads land in a batch buffer and are copied into the ring once. A
+ * datagram that would leave a gap is held for up to kReorderWaitMs in case the frames before it were merely
+ * overtaken; after that, or once kReorderFrames are held, the gap is counted as lost.
+ *
+ * Each stream has one writer: the connection, or for UDP the sender address, that sent its first frame. A
+ * connection that writes to a stream another one owns is closed; such datagrams are dropped. A stream is
+ * free again when its connection closes, or when its UDP sender has been silent for kUdpOwnerIdleMs.
+ *
+ * The server thread is the bus's only writer. Counters may be read from any thread.
+ */
+class SampleServer {
+public:
+    /**
+     * @brief Constructs a server that is not listening yet.
+     * @param bus Bus that receives the samples; it must outlive the server.
+     */
+    explicit SampleServer(SampleBus &bus);
+
+    ~SampleServer();
+
+    SampleServer(const SampleServer &) = delete;
+    SampleServer &operator=(const SampleServer &) = delete;
+
+    /**
+     * @brief Starts listening.
+     * @param address IPv4 address to bind.
+     * @param port TCP port (0 picks a free one, see port()).
+     * @return bool False if the socket could not be bound.
+     */
+    bool listen(const std::string &address, std::uint16_t port);
+
+    /** @return std::uint16_t The bound port (0 before listen()). */
+    std::uint16_t port() const { return boundPort; }
+
+    /**
+     * @brief Starts receiving datagrams as well.
+     * @param address IPv4 address to bind.
+     * @param port UDP port (0 picks a free one, see udpPort()).
+     * @return bool False if the socket could not be bound.
+     */
+    bool listenUdp(const std::string &address, std::uint16_t port);
+
+    /** @return std::uint16_t The bound UDP port (0 before listenUdp()). */
+    std::uint16_t udpPort() const { return boundUdpPort; }
+
+    /**
+     * @brief Waits for and handles socket events once.
+     * @param timeoutMs Longest wait in milliseconds (-1: until something happens).
+     * @return bool False if the server is not listening or the wait failed.
+     */
+    bool poll(int timeoutMs);
+
+    /**
+     * @brief Handles events until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return. Safe to call from any thread or a signal handler.
+     */
+    void stop();
+
+    /** @return std::size_t Open device connections (any thread). */
+    std::size_t connectionCount() const { return connectionsOpen.load(std::memory_order_relaxed); }
+
+    /** @return std::uint64_t Frames committed to the bus (any thread). */
+    std::uint64_t framesReceived() const { return frames.load(std::memory_order_relaxed); }
+
+    /** @return std::uint64_t Samples committed to the bus (any thread). */
+    std::uint64_t samplesReceived() const { return samples.load(std::memory_order_relaxed); }
+
+    /** @return std::uint64_t Connections closed, or datagrams dropped, for a protocol violation (any thread). */
+    std::uint64_t protocolErrors() const { return errors.load(std::memory_order_relaxed); }
+
+    /** @return std::uint64_t Frames refused because another writer owns their stream (any thread). */
+    std::uint64_t writersRejected() const { return rejected.load(std::memory_order_relaxed); }
+
+    /** @return std::uint64_t Datagrams that arrived early and were put back in sequence (any thread). */
+    std::uint64_t framesReordered() const { return reordered.load(std::memory_order_relaxed); }
+
+private:
+    static const std::size_t kStagingBytes = 2048;  /**< Per-connection header staging area. */
+    static const std::size_t kUdpBatch = 32;        /**< Datagrams per recvmmsg(). */
+    static const std::size_t kReorderFrames = 16;   /**< Early datagrams held per stream at most. */
+    static const int kReorderWaitMs = 20;           /**< Longest an early datagram waits for the gap before it. */
+    static const int kUdpOwnerIdleMs = 10000;       /**< Silence after which another sender may take a stream. */
+    static const std::uint64_t kNoOwner = ~0ULL;    /**< Owner of a stream whose writer has gone. */
+
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief Per-connection decoder state.
+     */
+    struct Connection {
+        unsigned char staging[kStagingBytes];   /**< Bytes read but not yet decoded. */
+        std::size_t begin = 0;                  /**< First undecoded staging byte. */
+        std::size_t end = 0;                    /**< One past the last staging byte. */
+        bool greeted = false;                   /**< The "HPS1" preamble has been checked. */
+        bool inPayload = false;                 /**< A header was decoded and its payload is being read. */
+        bool accepted = false;                  /**< The current frame will be committed. */
+        SampleFrameHeader header;               /**< Header of the current frame. */
+        std::size_t stream = 0;                 /**< Bus index of the current frame's stream. */
+        unsigned char *segment[3] = {};         /**< Payload destination parts: scratch, then the ring. */
+        std::size_t segmentBytes[3] = {};       /**< Sizes of the destination parts. */
+        std::size_t skipped = 0;                /**< Leading samples of the current frame that are dropped. */
+        std::size_t payloadDone = 0;            /**< Payload bytes already in place. */
+        std::uint32_t cachedId = 0;             /**< Stream identifier of the last frame. */
+        long long cachedStream = -1;            /**< Its bus index (-1: none yet). */
+        std::uint64_t owner = 0;                /**< Writer key of the connection. */
+        std::vector<std::uint32_t> owned;       /**< Streams this connection writes. */
+    };
+
+    /**
+     * @brief A datagram that arrived before the frames it follows.
+     */
+    struct HeldFrame {
+        SampleFrameHeader header;               /**< Its header. */
+        std::string payload;                    /**< Its samples, as received. */
+        Clock::time_point since;                /**< When it arrived. */
+    };
+
+    /**
+     * @brief The writer of one stream.
+     */
+    struct Writer {
+        std::size_t stream = 0;                 /**< Bus index. */
+        std::uint64_t owner = kNoOwner;         /**< Connection or sender key (kNoOwner: free). */
+        Clock::time_point lastSeen;             /**< Last datagram from a UDP owner. */
+        std::vector<HeldFrame> held;            /**< Early datagrams, by sequence number. */
+    };
+
+    SampleBus &bus;                                         /**< Destination bus. */
+    int listenFd = -1;                                      /**< Listening socket. */
+    int epollFd = -1;                                       /**< epoll instance. */
+    int wakeFd = -1;                                        /**< eventfd that interrupts the wait in stop(). */
+    int udpFd = -1;                                         /**< Datagram socket. */
+    std::uint16_t boundPort = 0;                            /**< Bound port. */
+    std::uint16_t boundUdpPort = 0;                         /**< Bound UDP port. */
+    std::atomic<bool> stopping{false};                      /**< Set by stop(). */
+    std::unordered_map<int, Connection> connections;        /**< Open connections by descriptor. */
+    std::unordered_map<std::uint32_t, Writer> writers;     /**< Stream writers by stream identifier. */
+    std::vector<unsigned char> discard;                     /**< Scratch payload for dropped frames. */
+    std::vector<unsigned char> datagrams;                   /**< recvmmsg() buffers, kUdpBatch of them. */
+    std::size_t heldFrames = 0;                             /**< Early datagrams held over all streams. */
+    std::atomic<std::size_t> connectionsOpen{0};            /**< Open connections. */
+    std::atomic<std::uint64_t> frames{0};                   /**< Frames committed. */
+    std::atomic<std::uint64_t> samples{0};                  /**< Samples committed. */
+    std::atomic<std::uint64_t> errors{0};                   /**< Protocol violations. */
+    std::atomic<std::uint64_t> rejected{0};                 /**< Frames from a second writer. */
+    std::atomic<std::uint64_t> reordered{0};                /**< Early datagrams put back in sequence. */
+
+    /**
+     * @brief Creates the epoll instance and wake descriptor on first use.
+     * @return bool False if they could not be created.
+     */
+    bool startPolling();
+
+    /**
+     * @brief Accepts every pending connection.
+     */
+    void acceptClients();
+
+    /**
+     * @brief Reads what a connection has sent and decodes every complete frame in it.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     * @return bool False if the connection should be closed.
+     */
+    bool readClient(int fd, Connection &connection);
+
+    /**
+     * @brief Decodes the staged bytes of a connection as far as they go.
+     * @param connection Connection state.
+     * @return bool False on a protocol violation.
+     */
+    bool decode(Connection &connection);
+
+    /**
+     * @brief Picks the destination of a frame whose header was just decoded.
+     * @param connection Connection state.
+     * @return bool False if the bus has no room for another stream.
+     */
+    bool startFrame(Connection &connection);
+
+    /**
+     * @brief Commits a frame whose payload is complete.
+     * @param connection Connection state.
+     */
+    void finishFrame(Connection &connection);
+
+    /**
+     * @brief Closes a connection and frees the streams it wrote.
+     * @param fd Client descriptor.
+     */
+    void closeClient(int fd);
+
+    /**
+     * @brief Finds or opens a stream for a writer, refusing it if another writer owns the stream.
+     * @param streamId Stream identifier.
+     * @param owner Writer key: a connection's, or a UDP sender's.
+     * @param now Current time, for UDP ownership.
+     * @return Writer* The stream's writer entry, or nullptr if it was refused or the bus is full.
+     */
+    Writer *claim(std::uint32_t streamId, std::uint64_t owner, Clock::time_point now);
+
+    /**
+     * @brief Receives and handles every pending datagram.
+     */
+    void readDatagrams();
+
+    /**
+     * @brief Handles one received datagram.
+     * @param bytes The datagram.
+     * @param size Its size.
+     * @param owner Sender key.
+     * @param now Receive time.
+     */
+    void handleDatagram(const unsigned char *bytes, std::size_t size, std::uint64_t owner, Clock::time_point now);
+
+    /**
+     * @brief Admits and commits a frame whose payload is in memory.
+     * @param stream Bus index.
+     * @param header Frame header.
+     * @param payload Little-endian samples.
+     * @return bool True if any of it was committed, false if it was dropped as a retransmission.
+     */
+    bool commitFrame(std::size_t stream, const SampleFrameHeader &header, const unsigned char *payload);
+
+    /**
+     * @brief Commits held datagrams of a stream that are now in sequence.
+     * @param writer The stream's writer.
+     * @param force Commit the first held datagram even if frames before it are still missing.
+     */
+    void releaseHeld(Writer &writer, bool force);
+
+    /**
+     * @brief Gives up waiting on gaps that held datagrams have waited on for kReorderWaitMs.
+     * @param now Current time.
+     */
+    void expireHeld(Clock::time_point now);
+};
+
+#endif // SAMPLESERVER_H
@@ -0,0 +1,356 @@
+/**
+ * @file SensitivityAnalysis.cpp
+ * @brief Implements the Sobol sequence, Saltelli sampling, the index estimators and the built-in models.
+ */
+
+#include "SensitivityAnalysis.h"
+#include "Calculations.h"
+#include "RiskModel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Joe-Kuo (new-joe-kuo-6.21201) parameters for Sobol dimensions 2 onwards.
+ */
+struct DirectionParameters {
+    int degree;             /**< Degree s of the primitive polynomial. */
+    std::uint32_t a;        /**< Inner coefficients of the polynomial. */
+    std::uint32_t m[7];     /**< Initial direction integers. */
+};
+
+const DirectionParameters kDirections[SobolSequence::kMaxDimensions - 1] = {
+    { 1, 0, { 1 } },
+    { 2, 1, { 1, 3 } },
+    { 3, 1, { 1, 3, 1 } },
+    { 3, 2, { 1, 1, 1 } },
+    { 4, 1, { 1, 1, 3, 3 } },
+    { 4, 4, { 1, 3, 5, 13 } },
+    { 5, 2, { 1, 1, 5, 5, 17 } },
+    { 5, 4, { 1, 1, 5, 5, 5 } },
+    { 5, 7, { 1, 1, 7, 11, 19 } },
+    { 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } },
+    { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+    { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+    { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+    { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+    { 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+    { 7, 4, { 1, 3, 7, 13, 13, 15, 69 } }
+};
+
+const int kLevels[FactorCount] = { 6, 2, 5, 4, 2, 2, 2, 2, 6, 2 };
+const int kFirstAnswer[FactorCount] = { 1, 0, 1, 1, 0, 0, 0, 0, 1, 0 };
+
+const std::size_t kChunkRows = 1024;
+
+/**
+ * @brief Per-replicate sums of one output.
+ */
+struct OutputSums {
+    double sumA = 0.0, sumB = 0.0, sumSquares = 0.0;
+    double firstNumerator[FactorCount] = {};
+    double totalNumerator[FactorCount] = {};
+
+    void merge(const OutputSums &other) {
+        sumA += other.sumA;
+        sumB += other.sumB;
+        sumSquares += other.sumSquares;
+        for (int f = 0; f < FactorCount; ++f) {
+            firstNumerator[f] += other.firstNumerator[f];
+            totalNumerator[f] += other.totalNumerator[f];
+        }
+    }
+};
+
+/**
+ * @brief Inverse standard normal CDF (Abramowitz and Stegun 26.2.23, error below 4.5e-4).
+ * @param p Probability in (0, 1).
+ * @return double Quantile.
+ */
+double normalQuantile(double p) {
+    double q = p < 0.5 ? p : 1.0 - p;
+    double t = std::sqrt(-2.0 * std::log(q));
+    double z = t - (2.515517 + 0.802853 * t + 0.010328 * t * t) /
+                   (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+    return p < 0.5 ? -z : z;
+}
+
+/**
+ * @brief Student t quantile by the Cornish-Fisher expansion around the normal quantile.
+ * @param p Probability in (0, 1).
+ * @param degrees Degrees of freedom.
+ * @return double Quantile.
+ */
+double studentQuantile(double p, int degrees) {
+    double z = normalQuantile(p);
+    double v = std::max(1, degrees);
+    double z3 = z * z * z, z5 = z3 * z * z;
+    return z + (z3 + z) / (4.0 * v) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * v * v);
+}
+
+/**
+ * @brief Mean and confidence half-width over replicates.
+ * @param values One value per replicate.
+ * @param tValue t quantile.
+ * @return SensitivityIndex The estimate.
+ */
+SensitivityIndex summarize(const std::vector<double> &values, double tValue) {
+    SensitivityIndex index;
+    if (values.empty()) return index;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    index.value = sum / values.size();
+    if (values.size() < 2) return index;
+    double squares = 0.0;
+    for (double v : values) squares += (v - index.value) * (v - index.value);
+    double sd = std::sqrt(squares / (values.size() - 1));
+    index.halfWidth = tValue * sd / std::sqrt(static_cast<double>(values.size()));
+    return index;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs the sequence.
+ * @param dimensions Number of dimensions.
+ * @param shiftSeed Seed of the digital shift.
+ */
+SobolSequence::SobolSequence(int dimensions, std::uint32_t shiftSeed)
+    : dimensionCount(std::min(std::max(dimensions, 1), kMaxDimensions)),
+      directions(static_cast<std::size_t>(dimensionCount) * 32), shifts(static_cast<std::size_t>(dimensionCount)) {
+    for (int k = 0; k < 32; ++k) directions[k] = 1u << (31 - k);
+    for (int d = 1; d < dimensionCount; ++d) {
+        const DirectionParameters &p = kDirections[d - 1];
+        std::uint32_t *v = &directions[static_cast<std::size_t>(d) * 32];
+        for (int k = 0; k < 32; ++k) {
+            if (k < p.degree) {
+                v[k] = p.m[k] << (31 - k);
+                continue;
+            }
+            v[k] = v[k - p.degree] ^ (v[k - p.degree] >> p.degree);
+            for (int l = 1; l < p.degree; ++l)
+                if ((p.a >> (p.degree - 1 - l)) & 1u) v[k] ^= v[k - l];
+        }
+    }
+    if (shiftSeed != 0) {
+        std::mt19937 rng(shiftSeed);
+        for (std::uint32_t &shift : shifts) shift = rng();
+    }
+}
+
+/**
+ * @brief Gets a point.
+ * @param index Point index.
+ * @param[out] point Values in [0, 1).
+ */
+void SobolSequence::point(std::uint32_t index, double *point) const {
+    for (int d = 0; d < dimensionCount; ++d) {
+        const std::uint32_t *v = &directions[static_cast<std::size_t>(d) * 32];
+        std::uint32_t x = shifts[static_cast<std::size_t>(d)];
+        for (std::uint32_t bits = index, k = 0; bits; bits >>= 1, ++k)
+            if (bits & 1u) x ^= v[k];
+        point[d] = x * (1.0 / 4294967296.0);
+    }
+}
+
+/**
+ * @brief Constructs an analysis.
+ * @param options Settings.
+ */
+SensitivityAnalysis::SensitivityAnalysis(const SensitivityOptions &options) : options(options) {}
+
+/**
+ * @brief Gets the number of model evaluations run() performs.
+ * @return std::uint64_t Evaluations.
+ */
+std::uint64_t SensitivityAnalysis::evaluationCount() const {
+    return (std::uint64_t(1) << options.samplesLog2) * static_cast<std::uint64_t>(options.replicates) *
+           (FactorCount + 2);
+}
+
+/**
+ * @brief Gets a factor's name.
+ * @param factor Factor.
+ * @return std::string Name.
+ */
+std::string SensitivityAnalysis::factorName(SensitivityFactor factor) {
+    static const char *names[FactorCount] = { "age", "gender", "sleep", "exercise", "history: CAD",
+                                              "history: diabetes", "history: cholesterol", "history: BP",
+                                              "diet", "smoker" };
+    return names[factor];
+}
+
+/**
+ * @brief Gets the number of answers a factor can take.
+ * @param factor Factor.
+ * @return int Number of answers.
+ */
+int SensitivityAnalysis::factorLevels(SensitivityFactor factor) {
+    return kLevels[factor];
+}
+
+/**
+ * @brief Runs the analysis.
+ * @param model Batch model.
+ * @return std::vector<SensitivityOutput> Indices per output.
+ */
+std::vector<SensitivityOutput> SensitivityAnalysis::run(const SensitivityModel &model) const {
+    const std::size_t outputCount = model.outputs.size();
+    const std::size_t samples = std::size_t(1) << options.samplesLog2;
+    const std::size_t chunkRows = std::min(kChunkRows, samples);
+    const std::size_t chunksPerReplicate = samples / chunkRows;
+    const int replicates = std::max(1, options.replicates);
+    const std::size_t workItems = chunksPerReplicate * static_cast<std::size_t>(replicates);
+    const std::size_t matrices = FactorCount + 2;   // A, B, AB_0 .. AB_{F-1}
+
+    std::vector<SobolSequence> sequences;
+    for (int r = 0; r < replicates; ++r)
+        sequences.emplace_back(2 * FactorCount, options.seed * 7919u + static_cast<std::uint32_t>(r) + 1u);
+
+    unsigned threadCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, workItems));
+    std::vector<std::vector<OutputSums>> threadSums(threadCount,
+                                                    std::vector<OutputSums>(replicates * outputCount));
+    std::atomic<std::size_t> nextItem(0);
+
+    auto worker = [&](unsigned thread) {
+        std::vector<int> answers(matrices * chunkRows * FactorCount);
+        std::vector<float> values(matrices * chunkRows * outputCount);
+        double point[2 * FactorCount];
+        for (std::size_t item = nextItem++; item < workItems; item = nextItem++) {
+            std::size_t replicate = item / chunksPerReplicate;
+            std::size_t first = (item % chunksPerReplicate) * chunkRows;
+
+            // Rows of A, B and every AB_i, matrix after matrix.
+            for (std::size_t k = 0; k < chunkRows; ++k) {
+                sequences[replicate].point(static_cast<std::uint32_t>(first + k), point);
+                int a[FactorCount], b[FactorCount];
+                for (int f = 0; f < FactorCount; ++f) {
+                    a[f] = kFirstAnswer[f] + std::min(kLevels[f] - 1, static_cast<int>(point[f] * kLevels[f]));
+                    b[f] = kFirstAnswer[f] +
+                           std::min(kLevels[f] - 1, static_cast<int>(point[FactorCount + f] * kLevels[f]));
+                }
+                for (std::size_t m = 0; m < matrices; ++m) {
+                    int *row = &answers[(m * chunkRows + k) * FactorCount];
+                    const int *source = m == 1 ? b : a;
+                    std::copy(source, source + FactorCount, row);
+                    if (m >= 2) row[m - 2] = b[m - 2];
+                }
+            }
+            model.evaluate(answers.data(), matrices * chunkRows, values.data());
+
+            for (std::size_t o = 0; o < outputCount; ++o) {
+                OutputSums &sums = threadSums[thread][replicate * outputCount + o];
+                auto value = [&](std::size_t m, std::size_t k) {
+                    return static_cast<double>(values[(m * chunkRows + k) * outputCount + o]);
+                };
+                for (std::size_t k = 0; k < chunkRows; ++k) {
+                    double fA = value(0, k), fB = value(1, k);
+                    sums.sumA += fA;
+                    sums.sumB += fB;
+                    sums.sumSquares += fA * fA + fB * fB;
+                    for (int f = 0; f < FactorCount; ++f) {
+                        double fAB = value(static_cast<std::size_t>(f) + 2, k);
+                        sums.firstNumerator[f] += fB * (fAB - fA);
+                        sums.totalNumerator[f] += (fA - fAB) * (fA - fAB);
+                    }
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) threads.emplace_back(worker, t);
+    worker(0);
+    for (std::thread &thread : threads) thread.join();
+
+    double tValue = studentQuantile(0.5 + options.confidence / 2.0, replicates - 1);
+    std::vector<SensitivityOutput> results(outputCount);
+    for (std::size_t o = 0; o < outputCount; ++o) {
+        SensitivityOutput &result = results[o];
+        result.name = model.outputs[o];
+        std::vector<double> firsts[FactorCount], totals[FactorCount];
+        for (int r = 0; r < replicates; ++r) {
+            OutputSums sums;
+            for (unsigned t = 0; t < threadCount; ++t) sums.merge(threadSums[t][r * outputCount + o]);
+            double n = static_cast<double>(samples);
+            double mean = (sums.sumA + sums.sumB) / (2.0 * n);
+            double variance = std::max(0.0, sums.sumSquares / (2.0 * n) - mean * mean);
+            result.mean += mean / replicates;
+            result.variance += variance / replicates;
+            for (int f = 0; f < FactorCount; ++f) {
+                firsts[f].push_back(variance > 0 ? sums.firstNumerator[f] / n / variance : 0.0);
+                totals[f].push_back(variance > 0 ? sums.totalNumerator[f] / (2.0 * n) / variance : 0.0);
+            }
+        }
+        for (int f = 0; f < FactorCount; ++f) {
+            result.first[f] = summarize(firsts[f], tValue);
+            result.total[f] = summarize(totals[f], tValue);
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief Gets the point system as a batch model.
+ * @return SensitivityModel The model.
+ */
+SensitivityModel SensitivityAnalysis::pointSystemModel() {
+    SensitivityModel model;
+    model.outputs = { "point score", "tier", "heart rate", "systolic BP", "diastolic BP", "cholesterol" };
+    model.evaluate = [](const int *answers, std::size_t rows, float *values) {
+        for (std::size_t i = 0; i < rows; ++i, answers += FactorCount, values += 6) {
+            unsigned history = (answers[FactorCad] ? 1u : 0u) | (answers[FactorDiabetes] ? 2u : 0u) |
+                               (answers[FactorCholesterol] ? 4u : 0u) | (answers[FactorBloodPressure] ? 8u : 0u);
+            int score = computeRiskScore(answers[FactorAge], answers[FactorGender] != 0, answers[FactorSleep],
+                                         answers[FactorExercise], history, answers[FactorDiet],
+                                         answers[FactorSmoker] != 0);
+            int tier = riskTierOf(score);
+            // The simulated vitals are uniform within the tier's range, so their expectation is its midpoint.
+            const SimulatedVitalRanges &ranges = simulatedVitalRanges(tier);
+            values[0] = static_cast<float>(score);
+            values[1] = static_cast<float>(tier);
+            values[2] = static_cast<float>((ranges.heartRate[0] + ranges.heartRate[1]) / 2.0);
+            values[3] = static_cast<float>((ranges.sysBP[0] + ranges.sysBP[1]) / 2.0);
+            values[4] = static_cast<float>((ranges.diasBP[0] + ranges.diasBP[1]) / 2.0);
+            values[5] = static_cast<float>((ranges.cholesterol[0] + ranges.cholesterol[1]) / 2.0);
+        }
+    };
+    return model;
+}
+
+/**
+ * @brief Gets a trained logistic model as a batch model.
+ * @param model Trained model.
+ * @return SensitivityModel The model.
+ */
+SensitivityModel SensitivityAnalysis::logisticModel(const LogisticRiskModel &model) {
+    SensitivityModel result;
+    result.outputs = { "model probability", "model tier" };
+    const LogisticRiskModel *scorer = &model;
+    result.evaluate = [scorer](const int *answers, std::size_t rows, float *values) {
+        thread_local std::vector<float> encoded, probabilities;
+        encoded.resize(rows * RiskFeatures::kWidth);
+        probabilities.resize(rows);
+        for (std::size_t i = 0; i < rows; ++i) {
+            const int *a = answers + i * FactorCount;
+            unsigned history = (a[FactorCad] ? 1u : 0u) | (a[FactorDiabetes] ? 2u : 0u) |
+                               (a[FactorCholesterol] ? 4u : 0u) | (a[FactorBloodPressure] ? 8u : 0u);
+            RiskFeatures::encode(a[FactorAge], a[FactorGender] != 0, a[FactorSleep], a[FactorExercise], history,
+                                 a[FactorDiet], a[FactorSmoker] != 0, &encoded[i * RiskFeatures::kWidth]);
+        }
+        scorer->scoreBatch(encoded.data(), rows, probabilities.data());
+        for (std::size_t i = 0; i < rows; ++i) {
+            values[2 * i] = probabilities[i];
+            values[2 * i + 1] = static_cast<float>(scorer->tierOf(probabilities[i]));
+        }
+    };
+    return result;
+}
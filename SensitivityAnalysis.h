@@ -0,0 +1,165 @@
+#ifndef SENSITIVITYANALYSIS_H
+#define SENSITIVITYANALYSIS_H
+
+/**
+ * @file SensitivityAnalysis.h
+ * @brief Declaration of the Sobol sequence and the Saltelli global sensitivity analysis of the risk models.
+ *
+ * This header declares a variance-based (Sobol) sensitivity analysis over the survey answers. Answers are
+ * drawn from a randomized quasi-random Sobol sequence, the model is evaluated in batches on the Saltelli
+ * A / B / AB_i matrices, and first-order and total-order indices are reported with confidence intervals from
+ * independent randomizations.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class LogisticRiskModel;
+
+/**
+ * @class SobolSequence
+ * @brief Digitally shifted Sobol low-discrepancy sequence (Joe-Kuo direction numbers, up to 21 dimensions).
+ */
+class SobolSequence {
+public:
+    static const int kMaxDimensions = 21;   /**< Dimensions with built-in direction numbers. */
+
+    /**
+     * @brief Constructs the sequence.
+     * @param dimensions Number of dimensions (1 to kMaxDimensions).
+     * @param shiftSeed Seed of the random digital shift (0 for the unshifted sequence).
+     */
+    SobolSequence(int dimensions, std::uint32_t shiftSeed);
+
+    /**
+     * @brief Gets a point.
+     * @param index Point index.
+     * @param[out] point dimensions() values in [0, 1).
+     */
+    void point(std::uint32_t index, double *point) const;
+
+    /** @return int Number of dimensions. */
+    int dimensions() const { return dimensionCount; }
+
+private:
+    int dimensionCount;                                 /**< Number of dimensions. */
+    std::vector<std::uint32_t> directions;              /**< 32 direction numbers per dimension. */
+    std::vector<std::uint32_t> shifts;                  /**< Digital shift per dimension. */
+};
+
+/**
+ * @brief Survey factors varied by the analysis; the four family-history diseases are separate factors.
+ */
+enum SensitivityFactor {
+    FactorAge = 0,
+    FactorGender,
+    FactorSleep,
+    FactorExercise,
+    FactorCad,
+    FactorDiabetes,
+    FactorCholesterol,
+    FactorBloodPressure,
+    FactorDiet,
+    FactorSmoker,
+    FactorCount
+};
+
+/**
+ * @brief A batch model: rows × FactorCount answers (as stored in FamilyHealth) in, rows × outputs() values out.
+ */
+struct SensitivityModel {
+    std::vector<std::string> outputs;                                   /**< Output names. */
+    std::function<void(const int *answers, std::size_t rows, float *values)> evaluate;  /**< Batch evaluator. */
+};
+
+/**
+ * @brief Index estimate with its confidence half-width.
+ */
+struct SensitivityIndex {
+    double value = 0.0;         /**< Mean over replicates. */
+    double halfWidth = 0.0;     /**< Half-width of the confidence interval. */
+};
+
+/**
+ * @brief Indices of one output.
+ */
+struct SensitivityOutput {
+    std::string name;                           /**< Output name. */
+    double mean = 0.0;                          /**< Output mean. */
+    double variance = 0.0;                      /**< Output variance. */
+    SensitivityIndex first[FactorCount];        /**< First-order index per factor. */
+    SensitivityIndex total[FactorCount];        /**< Total-order index per factor. */
+};
+
+/**
+ * @brief Analysis settings.
+ */
+struct SensitivityOptions {
+    int samplesLog2 = 16;           /**< Base samples per replicate = 2^samplesLog2. */
+    int replicates = 16;            /**< Independent digital shifts (used for the confidence intervals). */
+    double confidence = 0.95;       /**< Confidence level. */
+    unsigned threads = 0;           /**< Worker threads (0: one per core). */
+    std::uint32_t seed = 1;         /**< Seed of the digital shifts. */
+};
+
+/**
+ * @class SensitivityAnalysis
+ * @brief Saltelli sampling with Saltelli (2010) first-order and Jansen total-order estimators.
+ *
+ * Each replicate evaluates the model on N·(FactorCount + 2) rows. Work is split into chunks of rows that
+ * worker threads claim from a shared counter; per-replicate sums are merged at the end, and the interval is
+ * mean ± t·sd/√R over the R replicates.
+ */
+class SensitivityAnalysis {
+public:
+    /**
+     * @brief Constructs an analysis.
+     * @param options Settings.
+     */
+    explicit SensitivityAnalysis(const SensitivityOptions &options = SensitivityOptions());
+
+    /**
+     * @brief Runs the analysis.
+     * @param model Batch model.
+     * @return std::vector<SensitivityOutput> Indices per model output.
+     */
+    std::vector<SensitivityOutput> run(const SensitivityModel &model) const;
+
+    /** @return std::uint64_t Model evaluations run() performs. */
+    std::uint64_t evaluationCount() const;
+
+    /**
+     * @brief Gets the point system as a batch model: score, tier and the tier's mean simulated vitals.
+     * @return SensitivityModel The model.
+     */
+    static SensitivityModel pointSystemModel();
+
+    /**
+     * @brief Gets a trained logistic model as a batch model (probability and tier), scored with scoreBatch().
+     * @param model Trained model (must outlive the returned object).
+     * @return SensitivityModel The model.
+     */
+    static SensitivityModel logisticModel(const LogisticRiskModel &model);
+
+    /**
+     * @brief Gets a factor's name.
+     * @param factor Factor.
+     * @return std::string Name.
+     */
+    static std::string factorName(SensitivityFactor factor);
+
+    /**
+     * @brief Gets the number of answers a factor can take.
+     * @param factor Factor.
+     * @return int Number of answers.
+     */
+    static int factorLevels(SensitivityFactor factor);
+
+private:
+    SensitivityOptions options;     /**< Settings. */
+};
+
+#endif // SENSITIVITYANALYSIS_H
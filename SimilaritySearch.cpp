@@ -0,0 +1,360 @@
+/**
+ * @file SimilaritySearch.cpp
+ * @brief Implements the patient-day collection and its lower-bound cascade k-NN search.
+ */
+
+#include "SimilaritySearch.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <thread>
+
+namespace {
+
+const double kInfinity = std::numeric_limits<double>::infinity();
+
+/**
+ * @brief Z-normalizes a curve in place (a flat curve becomes all zeros).
+ * @param curve Values.
+ */
+void zNormalize(std::vector<double> &curve) {
+    double mean = 0.0, squares = 0.0;
+    for (double v : curve) mean += v;
+    mean /= curve.size();
+    for (double v : curve) squares += (v - mean) * (v - mean);
+    double sd = std::sqrt(squares / curve.size());
+    for (double &v : curve) v = sd > 1e-9 ? (v - mean) / sd : 0.0;
+}
+
+/**
+ * @brief Computes the running max and min of a series over +/- w points (Lemire's streaming algorithm).
+ * @param series Values.
+ * @param n Length.
+ * @param w Half-width.
+ * @param[out] upper Running max.
+ * @param[out] lower Running min.
+ */
+template <typename T>
+void envelope(const T *series, int n, int w, double *upper, double *lower) {
+    std::deque<int> maxima, minima;
+    for (int i = 0; i < n + w; ++i) {
+        if (i < n) {
+            while (!maxima.empty() && series[maxima.back()] <= series[i]) maxima.pop_back();
+            while (!minima.empty() && series[minima.back()] >= series[i]) minima.pop_back();
+            maxima.push_back(i);
+            minima.push_back(i);
+        }
+        int centre = i - w;
+        if (centre < 0) continue;
+        while (maxima.front() < centre - w) maxima.pop_front();
+        while (minima.front() < centre - w) minima.pop_front();
+        upper[centre] = series[maxima.front()];
+        lower[centre] = series[minima.front()];
+    }
+}
+
+/**
+ * @brief LB_Keogh of a series against an envelope, abandoning once it reaches a bound.
+ * @param series Values, visited in the given order.
+ * @param order Point order (largest query magnitude first).
+ * @param upper Envelope max.
+ * @param lower Envelope min.
+ * @param n Length.
+ * @param bound Abandon threshold.
+ * @param[out] contribution Per-point contribution (filled up to where it stopped).
+ * @return double Lower bound (at least bound if abandoned).
+ */
+template <typename T>
+double lbKeogh(const T *series, const int *order, const double *upper, const double *lower, int n, double bound,
+               double *contribution) {
+    double sum = 0.0;
+    for (int k = 0; k < n && sum < bound; ++k) {
+        int i = order[k];
+        double v = series[i];
+        double d = v > upper[i] ? v - upper[i] : v < lower[i] ? lower[i] - v : 0.0;
+        contribution[i] = d * d;
+        sum += d * d;
+    }
+    return sum;
+}
+
+/**
+ * @brief Banded DTW with squared point costs that abandons once the cost must reach a bound.
+ * @param a First series.
+ * @param b Second series.
+ * @param remaining remaining[i] lower-bounds the cost of rows i and later (n + 1 entries, last is 0).
+ * @param n Length.
+ * @param w Band half-width.
+ * @param bound Abandon threshold.
+ * @param previous Scratch row of n entries.
+ * @param current Scratch row of n entries.
+ * @return double DTW cost, or infinity if abandoned.
+ */
+double dtw(const double *a, const float *b, const double *remaining, int n, int w, double bound,
+           std::vector<double> &previous, std::vector<double> &current) {
+    std::fill(previous.begin(), previous.end(), kInfinity);
+    std::fill(current.begin(), current.end(), kInfinity);
+    for (int i = 0; i < n; ++i) {
+        int lo = std::max(0, i - w), hi = std::min(n - 1, i + w);
+        double rowMin = kInfinity;
+        for (int j = lo; j <= hi; ++j) {
+            double d = a[i] - b[j];
+            double best;
+            if (i == 0 && j == 0) {
+                best = 0.0;
+            } else {
+                best = i > 0 ? previous[j] : kInfinity;
+                if (j > lo) best = std::min(best, current[j - 1]);
+                if (i > 0 && j > 0) best = std::min(best, previous[j - 1]);
+            }
+            current[j] = d * d + best;
+            rowMin = std::min(rowMin, current[j]);
+        }
+        // Every warping path still has to cross the rows after i + w, whose cost remaining[] bounds.
+        if (rowMin + remaining[std::min(n, i + w + 1)] >= bound) return kInfinity;
+        std::swap(previous, current);
+    }
+    return previous[n - 1];
+}
+
+/**
+ * @brief A candidate in a worker's top-k heap.
+ */
+struct Candidate {
+    double distance;    /**< Distance to the query. */
+    std::size_t row;    /**< Stored day. */
+
+    bool operator<(const Candidate &other) const { return distance < other.distance; }
+};
+
+} // namespace
+
+/**
+ * @brief Constructs an empty collection.
+ * @param resolutionMinutes Minutes per point.
+ */
+SimilaritySearch::SimilaritySearch(int resolutionMinutes)
+    : resolution(std::max(1, resolutionMinutes)),
+      points(1440 / std::max(1, resolutionMinutes)) {}
+
+/**
+ * @brief Builds a day's curve from the minute tier.
+ * @param rollup The user's rollup tiers.
+ * @param dayStart Day start (seconds since epoch, UTC).
+ * @param resolutionMinutes Minutes per point.
+ * @param minCoverage Fraction of points that must have readings.
+ * @param[out] curve The day's curve.
+ * @return bool False if the day has too few readings.
+ */
+bool SimilaritySearch::dayCurve(const HeartRateRollup &rollup, long long dayStart, int resolutionMinutes,
+                                double minCoverage, std::vector<double> &curve) {
+    int n = 1440 / resolutionMinutes;
+    std::vector<double> sums(n, 0.0);
+    std::vector<long long> counts(n, 0);
+    // Minutes older than the horizon have been dropped, so such days fall back to hours.
+    bool hourly = dayStart < rollup.minuteHorizon();
+    const std::vector<RollupBucket> &buckets =
+        rollup.buckets(hourly ? HeartRateRollup::Hour : HeartRateRollup::Minute);
+    long long width = hourly ? 3600 : 60;
+    auto it = std::lower_bound(buckets.begin(), buckets.end(), dayStart,
+                               [](const RollupBucket &bucket, long long start) { return bucket.start < start; });
+    for (; it != buckets.end() && it->start < dayStart + 86400; ++it) {
+        int first = static_cast<int>((it->start - dayStart) / (60 * resolutionMinutes));
+        int last = static_cast<int>((it->start + width - 1 - dayStart) / (60 * resolutionMinutes));
+        for (int point = first; point <= last; ++point) {
+            sums[point] += it->sum;
+            counts[point] += it->count;
+        }
+    }
+
+    std::vector<int> covered;
+    for (int i = 0; i < n; ++i)
+        if (counts[i] > 0) covered.push_back(i);
+    if (covered.empty() || covered.size() < minCoverage * n) return false;
+
+    curve.assign(n, 0.0);
+    for (int i : covered) curve[i] = sums[i] / counts[i];
+    for (int i = 0; i < covered.front(); ++i) curve[i] = curve[covered.front()];
+    for (int i = covered.back() + 1; i < n; ++i) curve[i] = curve[covered.back()];
+    for (std::size_t c = 0; c + 1 < covered.size(); ++c) {
+        int left = covered[c], right = covered[c + 1];
+        for (int i = left + 1; i < right; ++i)
+            curve[i] = curve[left] + (curve[right] - curve[left]) * (i - left) / (right - left);
+    }
+    return true;
+}
+
+/**
+ * @brief Adds one patient-day.
+ * @param user Username.
+ * @param dayStart Day start.
+ * @param curve length() values.
+ */
+void SimilaritySearch::addDay(const std::string &user, long long dayStart, const std::vector<double> &curve) {
+    if (static_cast<int>(curve.size()) != points) return;
+    if (users.empty() || users.back() != user) users.push_back(user);
+    DayKey key;
+    key.user = static_cast<std::uint32_t>(users.size() - 1);
+    key.start = dayStart;
+    days.push_back(key);
+    std::vector<double> normalized = curve;
+    zNormalize(normalized);
+    values.insert(values.end(), normalized.begin(), normalized.end());
+}
+
+/**
+ * @brief Adds every sufficiently covered day of a user's minute tier.
+ * @param user Username.
+ * @param rollup The user's rollup tiers.
+ * @param minCoverage Fraction of points that must have readings.
+ * @return std::size_t Number of days added.
+ */
+std::size_t SimilaritySearch::addUser(const std::string &user, const HeartRateRollup &rollup, double minCoverage) {
+    std::size_t added = 0;
+    std::vector<double> curve;
+    for (const RollupBucket &day : rollup.buckets(HeartRateRollup::Day)) {
+        if (!dayCurve(rollup, day.start, resolution, minCoverage, curve)) continue;
+        addDay(user, day.start, curve);
+        ++added;
+    }
+    return added;
+}
+
+/**
+ * @brief Finds the days closest to a query curve.
+ * @param query length() values.
+ * @param k Number of matches.
+ * @param metric Distance measure.
+ * @param window Sakoe-Chiba band half-width as a fraction of the day.
+ * @param threads Worker threads (0: one per core).
+ * @param[out] stats Optional work counters.
+ * @return std::vector<SimilarityMatch> Up to k matches, closest first.
+ */
+std::vector<SimilarityMatch> SimilaritySearch::search(const std::vector<double> &query, std::size_t k,
+                                                      Metric metric, double window, unsigned threads,
+                                                      SimilarityStats *stats) const {
+    std::vector<SimilarityMatch> matches;
+    if (static_cast<int>(query.size()) != points || k == 0 || days.empty()) return matches;
+    const int n = points;
+    const int w = metric == Dtw ? std::min(n - 1, static_cast<int>(std::floor(window * n))) : 0;
+
+    std::vector<double> q = query;
+    zNormalize(q);
+    std::vector<double> upper(n), lower(n);
+    envelope(q.data(), n, w, upper.data(), lower.data());
+    // Points far from the mean contribute most, so visiting them first abandons soonest.
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return std::fabs(q[a]) > std::fabs(q[b]); });
+
+    unsigned threadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t chunk = 256;
+    std::size_t chunks = (days.size() + chunk - 1) / chunk;
+    threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, chunks));
+    std::atomic<std::size_t> nextChunk(0);
+    std::atomic<double> sharedBound(kInfinity);
+    std::vector<std::priority_queue<Candidate>> heaps(threadCount);
+    std::vector<SimilarityStats> threadStats(threadCount);
+
+    auto worker = [&](unsigned thread) {
+        std::priority_queue<Candidate> &heap = heaps[thread];
+        SimilarityStats &counts = threadStats[thread];
+        std::vector<double> forward(n), reverse(n), remaining(n + 1), candidateUpper(n), candidateLower(n);
+        std::vector<double> previous(n), current(n);
+        for (std::size_t c = nextChunk++; c < chunks; c = nextChunk++) {
+            std::size_t end = std::min(days.size(), (c + 1) * chunk);
+            for (std::size_t row = c * chunk; row < end; ++row) {
+                const float *candidate = values.data() + row * n;
+                ++counts.candidates;
+                // Any worker's k-th best bounds the global k-th best from above.
+                double bound = sharedBound.load(std::memory_order_relaxed);
+                if (heap.size() == k) bound = std::min(bound, heap.top().distance);
+
+                double kim = (q[0] - candidate[0]) * (q[0] - candidate[0]) +
+                             (q[n - 1] - candidate[n - 1]) * (q[n - 1] - candidate[n - 1]);
+                if (kim >= bound) {
+                    ++counts.prunedByKim;
+                    continue;
+                }
+
+                double distance;
+                if (metric == Euclidean) {
+                    distance = 0.0;
+                    for (int i = 0; i < n && distance < bound; ++i) {
+                        double d = q[order[i]] - candidate[order[i]];
+                        distance += d * d;
+                    }
+                    if (distance >= bound) {
+                        ++counts.abandoned;
+                        continue;
+                    }
+                } else {
+                    double lb = lbKeogh(candidate, order.data(), upper.data(), lower.data(), n, bound,
+                                        forward.data());
+                    if (lb >= bound) {
+                        ++counts.prunedByKeogh;
+                        continue;
+                    }
+                    envelope(candidate, n, w, candidateUpper.data(), candidateLower.data());
+                    double lbReverse = lbKeogh(q.data(), order.data(), candidateUpper.data(), candidateLower.data(),
+                                               n, bound, reverse.data());
+                    if (lbReverse >= bound) {
+                        ++counts.prunedByKeoghReverse;
+                        continue;
+                    }
+                    // Suffix sums of the tighter bound's contributions let DTW abandon row by row.
+                    const std::vector<double> &tighter = lbReverse > lb ? reverse : forward;
+                    remaining[n] = 0.0;
+                    for (int i = n - 1; i >= 0; --i) remaining[i] = remaining[i + 1] + tighter[i];
+                    distance = dtw(q.data(), candidate, remaining.data(), n, w, bound, previous, current);
+                    if (distance >= bound) {
+                        ++counts.abandoned;
+                        continue;
+                    }
+                }
+                ++counts.completed;
+                heap.push({ distance, row });
+                if (heap.size() > k) heap.pop();
+                if (heap.size() == k) {
+                    double kth = heap.top().distance;
+                    double shared = sharedBound.load(std::memory_order_relaxed);
+                    while (kth < shared && !sharedBound.compare_exchange_weak(shared, kth)) {}
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threadCount; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread &thread : pool) thread.join();
+
+    std::vector<Candidate> all;
+    for (std::priority_queue<Candidate> &heap : heaps) {
+        for (; !heap.empty(); heap.pop()) all.push_back(heap.top());
+    }
+    std::sort(all.begin(), all.end());
+    if (all.size() > k) all.resize(k);
+    for (const Candidate &candidate : all) {
+        SimilarityMatch match;
+        match.user = users[days[candidate.row].user];
+        match.day = days[candidate.row].start;
+        match.distance = candidate.distance;
+        matches.push_back(match);
+    }
+    if (stats) {
+        *stats = SimilarityStats();
+        for (const SimilarityStats &s : threadStats) {
+            stats->candidates += s.candidates;
+            stats->prunedByKim += s.prunedByKim;
+            stats->prunedByKeogh += s.prunedByKeogh;
+            stats->prunedByKeoghReverse += s.prunedByKeoghReverse;
+            stats->abandoned += s.abandoned;
+            stats->completed += s.completed;
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,137 @@
+#ifndef SIMILARITYSEARCH_H
+#define SIMILARITYSEARCH_H
+
+/**
+ * @file SimilaritySearch.h
+ * @brief Declaration of the k-nearest-neighbour search over users' daily heart-rate curves.
+ *
+ * This header declares an in-memory collection of patient-days, each the day's 1-minute rollup means
+ * resampled to a fixed length and z-normalized, and a search that finds the days most similar to a query
+ * curve under z-normalized Euclidean or dynamic time warping (DTW) distance. Most candidates are ruled out by
+ * cheap lower bounds before any full distance is computed.
+ */
+
+#include "HeartRateRollup.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One search hit.
+ */
+struct SimilarityMatch {
+    std::string user;           /**< Username. */
+    long long day = 0;          /**< Day start (seconds since epoch, UTC). */
+    double distance = 0.0;      /**< Distance to the query (squared Euclidean or DTW cost). */
+};
+
+/**
+ * @brief How much work a search did.
+ */
+struct SimilarityStats {
+    std::size_t candidates = 0;         /**< Days considered. */
+    std::size_t prunedByKim = 0;        /**< Ruled out by the first/last point bound. */
+    std::size_t prunedByKeogh = 0;      /**< Ruled out by LB_Keogh against the query envelope. */
+    std::size_t prunedByKeoghReverse = 0;   /**< Ruled out by LB_Keogh against the candidate envelope. */
+    std::size_t abandoned = 0;          /**< Full distances abandoned part way. */
+    std::size_t completed = 0;          /**< Full distances computed to the end. */
+};
+
+/**
+ * @class SimilaritySearch
+ * @brief Patient-day collection with a lower-bound cascade k-NN search (after the UCR suite).
+ *
+ * For DTW the cascade is LB_Kim, then LB_Keogh of the candidate against the query's warping envelope, then
+ * LB_Keogh of the query against the candidate's envelope, then DTW inside a Sakoe-Chiba band that abandons
+ * as soon as its partial cost plus the remaining LB_Keogh contributions exceeds the k-th best distance so
+ * far. Euclidean distance abandons early as well, visiting the query's largest-magnitude points first.
+ * Days are split between worker threads, which share the best k-th distance any of them has found.
+ */
+class SimilaritySearch {
+public:
+    /**
+     * @brief Distance measures.
+     */
+    enum Metric {
+        Euclidean = 0,  /**< Squared z-normalized Euclidean distance. */
+        Dtw             /**< DTW with squared point costs inside a Sakoe-Chiba band. */
+    };
+
+    /**
+     * @brief Constructs an empty collection.
+     * @param resolutionMinutes Minutes per point (1 gives 1440-point days; must divide 1440).
+     */
+    explicit SimilaritySearch(int resolutionMinutes = 1);
+
+    /** @return int Points per day. */
+    int length() const { return points; }
+
+    /** @return std::size_t Number of patient-days. */
+    std::size_t size() const { return days.size(); }
+
+    /**
+     * @brief Builds a day's curve from the minute tier.
+     *
+     * Each point is the mean of the minutes it covers; points with no readings are filled by linear
+     * interpolation between their neighbours (or copied from the nearest point at either end). Days before
+     * the minute tier's horizon are built from the hour tier, each hour's mean standing for its points.
+     *
+     * @param rollup The user's rollup tiers.
+     * @param dayStart Day start (seconds since epoch, UTC).
+     * @param resolutionMinutes Minutes per point.
+     * @param minCoverage Fraction of points that must have readings.
+     * @param[out] curve The day's curve (not normalized).
+     * @return bool False if the day has too few readings.
+     */
+    static bool dayCurve(const HeartRateRollup &rollup, long long dayStart, int resolutionMinutes,
+                         double minCoverage, std::vector<double> &curve);
+
+    /**
+     * @brief Adds one patient-day.
+     * @param user Username.
+     * @param dayStart Day start.
+     * @param curve length() values.
+     */
+    void addDay(const std::string &user, long long dayStart, const std::vector<double> &curve);
+
+    /**
+     * @brief Adds every sufficiently covered day of a user's minute tier.
+     * @param user Username.
+     * @param rollup The user's rollup tiers.
+     * @param minCoverage Fraction of points that must have readings.
+     * @return std::size_t Number of days added.
+     */
+    std::size_t addUser(const std::string &user, const HeartRateRollup &rollup, double minCoverage = 0.5);
+
+    /**
+     * @brief Finds the days closest to a query curve.
+     * @param query length() values (z-normalized internally).
+     * @param k Number of matches.
+     * @param metric Distance measure.
+     * @param window Sakoe-Chiba band half-width as a fraction of the day (DTW only).
+     * @param threads Worker threads (0: one per core).
+     * @param[out] stats Optional work counters.
+     * @return std::vector<SimilarityMatch> Up to k matches, closest first.
+     */
+    std::vector<SimilarityMatch> search(const std::vector<double> &query, std::size_t k, Metric metric,
+                                        double window = 0.05, unsigned threads = 0,
+                                        SimilarityStats *stats = nullptr) const;
+
+private:
+    /**
+     * @brief Identity of one stored day.
+     */
+    struct DayKey {
+        std::uint32_t user = 0;     /**< Index into users. */
+        long long start = 0;        /**< Day start. */
+    };
+
+    int resolution;                 /**< Minutes per point. */
+    int points;                     /**< Points per day. */
+    std::vector<std::string> users; /**< Username per index. */
+    std::vector<DayKey> days;       /**< Day per row. */
+    std::vector<float> values;      /**< Z-normalized curves, points per row. */
+};
+
+#endif // SIMILARITYSEARCH_H
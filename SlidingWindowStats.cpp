@@ -0,0 +1,140 @@
+/**
+ * @file SlidingWindowStats.cpp
+ * @brief Implements the SlidingWindowStats class.
+ *
+ * Every sample enters the window, the min deque and the max deque once and leaves each of them at most
+ * once, which gives O(1) amortized updates regardless of the window length.
+ */
+
+#include "SlidingWindowStats.h"
+#include <cmath>
+
+/**
+ * @brief Adds a term to the compensated sum.
+ *
+ * Neumaier's variant also handles terms larger than the running sum, which happens whenever a sample is
+ * subtracted back out of the window.
+ *
+ * @param x Term to add.
+ */
+void SlidingWindowStats::CompensatedSum::add(double x) {
+    double t = sum + x;
+    if (std::fabs(sum) >= std::fabs(x))
+        compensation += (sum - t) + x;
+    else
+        compensation += (x - t) + sum;
+    sum = t;
+}
+
+/**
+ * @brief Constructs a new SlidingWindowStats object.
+ *
+ * @param maxSamples Maximum number of samples in the window (0 = no count limit).
+ * @param maxAgeUnits Maximum age of a sample relative to the newest one (0 = no age limit).
+ */
+SlidingWindowStats::SlidingWindowStats(std::size_t maxSamples, double maxAgeUnits)
+    : maxCount(maxSamples), maxAge(maxAgeUnits), nextSequence(0.0), shift(0.0) {}
+
+/**
+ * @brief Adds a timestamped sample and evicts anything that fell out of the window.
+ *
+ * @param time Sample timestamp (non-decreasing).
+ * @param value Sample value.
+ */
+void SlidingWindowStats::add(double time, double value) {
+    if (window.empty()) {
+        // Re-anchor the shift on an empty window so the sums stay small relative to the data.
+        shift = value;
+        sum = CompensatedSum();
+        sumSquares = CompensatedSum();
+    }
+
+    window.push_back({ time, value });
+    double d = value - shift;
+    sum.add(d);
+    sumSquares.add(d * d);
+
+    while (!minQueue.empty() && minQueue.back().value > value) minQueue.pop_back();
+    minQueue.push_back({ time, value });
+    while (!maxQueue.empty() && maxQueue.back().value < value) maxQueue.pop_back();
+    maxQueue.push_back({ time, value });
+
+    nextSequence = time + 1.0;
+
+    if (maxCount > 0) {
+        while (window.size() > maxCount) evictOldest();
+    }
+    expire(time);
+}
+
+/**
+ * @brief Evicts samples older than @p now - maxAge.
+ * @param now Current time in timestamp units.
+ */
+void SlidingWindowStats::expire(double now) {
+    if (maxAge <= 0.0) return;
+    while (!window.empty() && window.front().time <= now - maxAge) evictOldest();
+}
+
+/**
+ * @brief Removes the oldest sample from the window and all accumulators.
+ *
+ * The monotonic deques only need popping when their front is the very sample being evicted; samples are
+ * matched by timestamp and value since every deque entry originated from the window.
+ */
+void SlidingWindowStats::evictOldest() {
+    const Sample oldest = window.front();
+    window.pop_front();
+
+    double d = oldest.value - shift;
+    sum.add(-d);
+    sumSquares.add(-d * d);
+
+    if (!minQueue.empty() && minQueue.front().time == oldest.time && minQueue.front().value == oldest.value)
+        minQueue.pop_front();
+    if (!maxQueue.empty() && maxQueue.front().time == oldest.time && maxQueue.front().value == oldest.value)
+        maxQueue.pop_front();
+
+    if (window.empty()) clear();
+}
+
+/**
+ * @brief Removes all samples.
+ */
+void SlidingWindowStats::clear() {
+    window.clear();
+    minQueue.clear();
+    maxQueue.clear();
+    sum = CompensatedSum();
+    sumSquares = CompensatedSum();
+    shift = 0.0;
+}
+
+/**
+ * @brief Gets the mean of the window.
+ * @return double Mean value (0 if empty).
+ */
+double SlidingWindowStats::mean() const {
+    if (window.empty()) return 0.0;
+    return shift + sum.value() / static_cast<double>(window.size());
+}
+
+/**
+ * @brief Gets the sample variance of the window.
+ * @return double Variance (0 with fewer than two samples).
+ */
+double SlidingWindowStats::variance() const {
+    std::size_t n = window.size();
+    if (n < 2) return 0.0;
+    double s = sum.value();
+    double v = (sumSquares.value() - s * s / static_cast<double>(n)) / static_cast<double>(n - 1);
+    return v > 0.0 ? v : 0.0;
+}
+
+/**
+ * @brief Gets the sample standard deviation of the window.
+ * @return double Standard deviation.
+ */
+double SlidingWindowStats::stddev() const {
+    return std::sqrt(variance());
+}
@@ -0,0 +1,138 @@
+#ifndef SLIDINGWINDOWSTATS_H
+#define SLIDINGWINDOWSTATS_H
+
+/**
+ * @file SlidingWindowStats.h
+ * @brief Declaration of the SlidingWindowStats class.
+ *
+ * This header declares a reusable windowed-statistics component for live vitals. It maintains the mean,
+ * variance, minimum and maximum of the most recent samples with O(1) amortized work per update, so charts
+ * and labels can follow the data without rescanning it.
+ */
+
+#include <cstddef>
+#include <deque>
+
+/**
+ * @class SlidingWindowStats
+ * @brief Running mean, variance, min and max over a count- or time-based window.
+ *
+ * Samples are evicted once the window holds more than @c maxCount samples or once they are older than
+ * @c maxAge (in the same units as the timestamps passed to add()). A limit of zero disables that bound, so
+ * a default-constructed object accumulates over everything it has seen.
+ *
+ * Minimum and maximum are kept in monotonic deques (each sample is pushed and popped at most once).
+ * Sums are kept with Neumaier compensated summation over values shifted by a reference sample, which keeps
+ * the variance accurate even after millions of adds and removes.
+ */
+class SlidingWindowStats {
+private:
+    /**
+     * @brief A timestamped sample.
+     */
+    struct Sample {
+        double time;
+        double value;
+    };
+
+    /**
+     * @brief Neumaier (improved Kahan) compensated accumulator.
+     */
+    struct CompensatedSum {
+        double sum = 0.0;
+        double compensation = 0.0;
+        void add(double x);
+        double value() const { return sum + compensation; }
+    };
+
+    std::size_t maxCount;          /**< Maximum samples kept (0 = unbounded). */
+    double maxAge;                 /**< Maximum sample age (0 = unbounded). */
+    double nextSequence;           /**< Implicit timestamp for add(value). */
+    double shift;                  /**< Reference value subtracted before summing. */
+    std::deque<Sample> window;     /**< Samples currently inside the window. */
+    std::deque<Sample> minQueue;   /**< Increasing values; front is the window minimum. */
+    std::deque<Sample> maxQueue;   /**< Decreasing values; front is the window maximum. */
+    CompensatedSum sum;            /**< Sum of (value - shift). */
+    CompensatedSum sumSquares;     /**< Sum of (value - shift)^2. */
+
+    /**
+     * @brief Removes the oldest sample from the window and all accumulators.
+     */
+    void evictOldest();
+
+public:
+    /**
+     * @brief Constructs a new SlidingWindowStats object.
+     *
+     * @param maxSamples Maximum number of samples in the window (0 = no count limit).
+     * @param maxAgeUnits Maximum age of a sample relative to the newest one (0 = no age limit).
+     */
+    explicit SlidingWindowStats(std::size_t maxSamples = 0, double maxAgeUnits = 0.0);
+
+    /**
+     * @brief Creates a window over the last @p samples values.
+     * @param samples Number of samples to keep.
+     * @return SlidingWindowStats A count-based window.
+     */
+    static SlidingWindowStats countWindow(std::size_t samples) { return SlidingWindowStats(samples, 0.0); }
+
+    /**
+     * @brief Creates a window over samples no older than @p span.
+     * @param span Window length in timestamp units (e.g. seconds).
+     * @return SlidingWindowStats A time-based window.
+     */
+    static SlidingWindowStats timeWindow(double span) { return SlidingWindowStats(0, span); }
+
+    /**
+     * @brief Adds a timestamped sample and evicts anything that fell out of the window.
+     *
+     * Timestamps must be non-decreasing.
+     *
+     * @param time Sample timestamp.
+     * @param value Sample value.
+     */
+    void add(double time, double value);
+
+    /**
+     * @brief Adds a sample using an implicit, increasing sequence number as its timestamp.
+     * @param value Sample value.
+     */
+    void add(double value) { add(nextSequence, value); }
+
+    /**
+     * @brief Evicts samples older than @p now - maxAge without adding a new one.
+     * @param now Current time in timestamp units.
+     */
+    void expire(double now);
+
+    /**
+     * @brief Removes all samples.
+     */
+    void clear();
+
+    /** @return std::size_t Number of samples currently in the window. */
+    std::size_t count() const { return window.size(); }
+
+    /** @return bool True if the window holds no samples. */
+    bool empty() const { return window.empty(); }
+
+    /** @return double Mean of the window (0 if empty). */
+    double mean() const;
+
+    /** @return double Sample variance of the window (0 with fewer than two samples). */
+    double variance() const;
+
+    /** @return double Sample standard deviation of the window. */
+    double stddev() const;
+
+    /** @return double Smallest value in the window (0 if empty). */
+    double min() const { return minQueue.empty() ? 0.0 : minQueue.front().value; }
+
+    /** @return double Largest value in the window (0 if empty). */
+    double max() const { return maxQueue.empty() ? 0.0 : maxQueue.front().value; }
+
+    /** @return double Most recently added value (0 if empty). */
+    double latest() const { return window.empty() ? 0.0 : window.back().value; }
+};
+
+#endif // SLIDINGWINDOWSTATS_H
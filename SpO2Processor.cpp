@@ -0,0 +1,152 @@
+/**
+ * @file SpO2Processor.cpp
+ * @brief Implements the SpO2Processor class for ratio-of-ratios SpO2 estimation.
+ *
+ * Each block is detrended with a least-squares line per channel. The line's value at the block centre gives
+ * the DC level and the RMS of the residual gives the AC level. The pulse rate is derived from the spacing of
+ * rising zero crossings in the detrended IR signal.
+ */
+
+#include "SpO2Processor.h"
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief AC/DC extraction for one channel of a block.
+ */
+struct ChannelLevels {
+    double dc;
+    double ac;
+};
+
+/**
+ * @brief Fits a line to the samples and returns DC (fit at centre) and AC (RMS of the residual).
+ *
+ * The sample index is centred so that the fit reduces to two independent sums.
+ *
+ * @param samples Channel samples.
+ * @param count Number of samples.
+ * @param[out] residual Buffer of @p count values receiving the detrended signal (may be nullptr).
+ * @return ChannelLevels The extracted DC and AC levels.
+ */
+ChannelLevels extractLevels(const double* samples, int count, double* residual) {
+    double centre = 0.5 * (count - 1);
+    double sum = 0.0, sumXt = 0.0, sumTt = 0.0;
+    for (int i = 0; i < count; ++i) {
+        double t = i - centre;
+        sum += samples[i];
+        sumXt += samples[i] * t;
+        sumTt += t * t;
+    }
+    double mean = sum / count;
+    double slope = sumTt > 0.0 ? sumXt / sumTt : 0.0;
+
+    double sumSq = 0.0;
+    for (int i = 0; i < count; ++i) {
+        double r = samples[i] - (mean + slope * (i - centre));
+        sumSq += r * r;
+        if (residual) residual[i] = r;
+    }
+    return { mean, std::sqrt(sumSq / count) };
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a new SpO2Processor object.
+ *
+ * @param sampleRateHz Samples per second per channel.
+ * @param samplesPerBlock Number of sample pairs per estimate.
+ * @param a Intercept of the SpO2 calibration line.
+ * @param b Slope of the SpO2 calibration line.
+ */
+SpO2Processor::SpO2Processor(double sampleRateHz, int samplesPerBlock, double a, double b)
+    : sampleRate(sampleRateHz), blockSize(samplesPerBlock < 2 ? 2 : samplesPerBlock),
+      calibrationA(a), calibrationB(b), irResidual(blockSize), pairsProcessed(0)
+{
+    redBlock.reserve(blockSize);
+    irBlock.reserve(blockSize);
+}
+
+/**
+ * @brief Feeds sample pairs into the processor, running an estimate every time a block fills up.
+ *
+ * @param red Pointer to @p count red samples.
+ * @param ir Pointer to @p count infrared samples.
+ * @param count Number of sample pairs.
+ * @return int The number of blocks completed by this call.
+ */
+int SpO2Processor::addSamples(const double* red, const double* ir, int count) {
+    int completed = 0;
+    int i = 0;
+    while (i < count) {
+        int take = blockSize - static_cast<int>(redBlock.size());
+        if (take > count - i) take = count - i;
+        redBlock.insert(redBlock.end(), red + i, red + i + take);
+        irBlock.insert(irBlock.end(), ir + i, ir + i + take);
+        i += take;
+        if (static_cast<int>(redBlock.size()) == blockSize) {
+            processBlock();
+            redBlock.clear();
+            irBlock.clear();
+            ++completed;
+        }
+    }
+    pairsProcessed += count;
+    return completed;
+}
+
+/**
+ * @brief Runs the ratio-of-ratios estimate over the buffered block.
+ *
+ * Blocks whose IR perfusion index (AC/DC) is below 0.05% are marked invalid; this is what a finger
+ * lifted off the sensor looks like.
+ */
+void SpO2Processor::processBlock() {
+    ChannelLevels redLevels = extractLevels(redBlock.data(), blockSize, nullptr);
+    ChannelLevels irLevels = extractLevels(irBlock.data(), blockSize, irResidual.data());
+
+    SpO2Estimate estimate;
+    if (redLevels.dc <= 0.0 || irLevels.dc <= 0.0 || irLevels.ac / irLevels.dc < 0.0005) {
+        latest = estimate;
+        return;
+    }
+
+    estimate.ratio = (redLevels.ac / redLevels.dc) / (irLevels.ac / irLevels.dc);
+    estimate.spo2 = calibrationA - calibrationB * estimate.ratio;
+    if (estimate.spo2 > 100.0) estimate.spo2 = 100.0;
+    if (estimate.spo2 < 0.0) estimate.spo2 = 0.0;
+    estimate.valid = true;
+
+    // Absorption is inverted, so a falling residual marks the systolic upstroke. A small hysteresis band
+    // keeps sensor noise around zero from being counted as extra beats.
+    double band = 0.3 * irLevels.ac;
+    int firstCrossing = -1, lastCrossing = -1, crossings = 0;
+    bool armed = false;
+    for (int i = 0; i < blockSize; ++i) {
+        if (irResidual[i] > band) {
+            armed = true;
+        } else if (armed && irResidual[i] < -band) {
+            armed = false;
+            if (firstCrossing < 0) firstCrossing = i;
+            lastCrossing = i;
+            ++crossings;
+        }
+    }
+    if (crossings >= 2) {
+        double samplesPerBeat = static_cast<double>(lastCrossing - firstCrossing) / (crossings - 1);
+        estimate.heartRate = 60.0 * sampleRate / samplesPerBeat;
+    }
+    latest = estimate;
+}
+
+/**
+ * @brief Discards buffered samples, the latest estimate and the pair count.
+ */
+void SpO2Processor::reset() {
+    redBlock.clear();
+    irBlock.clear();
+    latest = SpO2Estimate();
+    pairsProcessed = 0;
+}
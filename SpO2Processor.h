@@ -0,0 +1,88 @@
+#ifndef SPO2PROCESSOR_H
+#define SPO2PROCESSOR_H
+
+/**
+ * @file SpO2Processor.h
+ * @brief Declaration of the SpO2Processor class.
+ *
+ * This header declares a streaming block processor that estimates blood oxygen saturation (SpO2) and pulse
+ * rate from paired red and infrared PPG samples using the ratio-of-ratios method.
+ */
+
+#include <vector>
+
+/**
+ * @brief Result of processing one block of PPG samples.
+ */
+struct SpO2Estimate {
+    double spo2 = 0.0;      /**< Estimated oxygen saturation in percent. */
+    double ratio = 0.0;     /**< Ratio-of-ratios R = (AC_red/DC_red) / (AC_ir/DC_ir). */
+    double heartRate = 0.0; /**< Pulse rate from IR zero crossings (0 if fewer than two beats were seen). */
+    bool valid = false;     /**< False if the block had too little perfusion to trust. */
+};
+
+/**
+ * @class SpO2Processor
+ * @brief Estimates SpO2 from red/IR PPG streams in fixed-size blocks.
+ *
+ * Samples are buffered until a full block is available. For each block the DC component is taken as the
+ * least-squares linear trend (which also removes slow baseline wander) and the AC component as the RMS of
+ * the detrended signal. The ratio-of-ratios is mapped to SpO2 with the empirical line SpO2 = a - b * R.
+ */
+class SpO2Processor {
+private:
+    double sampleRate;          /**< Samples per second per channel. */
+    int blockSize;              /**< Number of sample pairs per estimate. */
+    double calibrationA;        /**< Intercept of the SpO2 calibration line. */
+    double calibrationB;        /**< Slope of the SpO2 calibration line. */
+    std::vector<double> redBlock; /**< Buffered red samples for the current block. */
+    std::vector<double> irBlock;  /**< Buffered IR samples for the current block. */
+    std::vector<double> irResidual; /**< Scratch buffer for the detrended IR block, reused by every block. */
+    SpO2Estimate latest;        /**< Most recent completed estimate. */
+    long long pairsProcessed;   /**< Total sample pairs consumed. */
+
+    /**
+     * @brief Runs the ratio-of-ratios estimate over the buffered block.
+     */
+    void processBlock();
+
+public:
+    /**
+     * @brief Constructs a new SpO2Processor object.
+     *
+     * @param sampleRateHz Samples per second per channel.
+     * @param samplesPerBlock Number of sample pairs per estimate (at least one full beat is recommended).
+     * @param a Intercept of the SpO2 calibration line (default 110).
+     * @param b Slope of the SpO2 calibration line (default 25).
+     */
+    SpO2Processor(double sampleRateHz = 100.0, int samplesPerBlock = 100, double a = 110.0, double b = 25.0);
+
+    /**
+     * @brief Feeds sample pairs into the processor.
+     *
+     * @param red Pointer to @p count red samples.
+     * @param ir Pointer to @p count infrared samples.
+     * @param count Number of sample pairs.
+     * @return int The number of blocks completed by this call; the last one is available via latestEstimate().
+     */
+    int addSamples(const double* red, const double* ir, int count);
+
+    /**
+     * @brief Gets the estimate from the most recently completed block.
+     * @return const SpO2Estimate& The latest estimate (invalid until the first block completes).
+     */
+    const SpO2Estimate& latestEstimate() const { return latest; }
+
+    /**
+     * @brief Gets the number of red/IR sample pairs consumed so far.
+     * @return long long Total sample pairs.
+     */
+    long long getPairsProcessed() const { return pairsProcessed; }
+
+    /**
+     * @brief Discards buffered samples, the latest estimate and the pair count.
+     */
+    void reset();
+};
+
+#endif // SPO2PROCESSOR_H
@@ -0,0 +1,262 @@
+/**
+ * @file SurveyCube.cpp
+ * @brief Implements the SurveyCube cell layout, incremental updates and roll-up rebuild.
+ *
+ * Cells are laid out row-major with one extra "all" slot at the end of every dimension, so the grand total is
+ * the last cell. Binary format: "HPSC", a uint32 version, a uint32 count of non-empty base cells, then per cell
+ * its uint32 index, three uint32 tier counts, the uint32 vital counts and the double vital sums. Roll-up cells
+ * are not stored; read() recomputes them.
+ */
+
+#include "SurveyCube.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char kCubeMagic[4] = { 'H', 'P', 'S', 'C' };
+const std::uint32_t kCubeVersion = 1;
+
+// Value counts and the first stored value of each dimension, in Dimension order.
+const int kDimensionSizes[SurveyCube::DimensionCount] = { 6, 2, 5, 4, 16, 6, 2 };
+const int kDimensionBase[SurveyCube::DimensionCount]  = { 1, 0, 1, 1, 0, 1, 0 };
+
+} // namespace
+
+/**
+ * @brief Adds another cell's aggregates.
+ * @param other Cell to add.
+ */
+void SurveyCube::Cell::merge(const Cell &other) {
+    for (int t = 0; t < 3; ++t) tierCounts[t] += other.tierCounts[t];
+    for (int v = 0; v < VitalCount; ++v) {
+        vitalCounts[v] += other.vitalCounts[v];
+        vitalSums[v] += other.vitalSums[v];
+    }
+}
+
+/**
+ * @brief Constructs an empty cube.
+ */
+SurveyCube::SurveyCube() {
+    std::size_t total = 1;
+    for (int d = DimensionCount - 1; d >= 0; --d) {
+        strides[d] = total;
+        total *= static_cast<std::size_t>(kDimensionSizes[d] + 1);
+    }
+    cells.resize(total);
+}
+
+/**
+ * @brief Gets the number of values a dimension can take.
+ * @param dimension Dimension.
+ * @return int Number of values.
+ */
+int SurveyCube::valueCount(Dimension dimension) {
+    return kDimensionSizes[dimension];
+}
+
+/**
+ * @brief Gets a slice with every dimension rolled up.
+ * @return Slice The whole population.
+ */
+SurveyCube::Slice SurveyCube::everything() {
+    Slice slice;
+    slice.fill(All);
+    return slice;
+}
+
+/**
+ * @brief Gets the slice a profile falls into.
+ * @param profile Profile.
+ * @return Slice Its value in every dimension.
+ */
+SurveyCube::Slice SurveyCube::sliceOf(const SurveyProfile &profile) {
+    return Slice{ { profile.ageGroup, profile.male ? 1 : 0, profile.sleepHours, profile.exerciseFrequency,
+                    static_cast<int>(profile.familyHistory & 15u), profile.dietType, profile.smoker ? 1 : 0 } };
+}
+
+/**
+ * @brief Gets a recorded vital of a profile.
+ * @param profile Profile.
+ * @param vital Vital.
+ * @return double Value, negative if not recorded.
+ */
+double SurveyCube::vitalOf(const SurveyProfile &profile, Vital vital) {
+    switch (vital) {
+    case Bpm: return profile.bpm;
+    case SpO2: return profile.spo2;
+    case SystolicBP: return profile.systolicBP;
+    case DiastolicBP: return profile.diastolicBP;
+    case Cholesterol: return profile.cholesterol;
+    default: return -1.0;
+    }
+}
+
+/**
+ * @brief Converts a slice to a cell index.
+ * @param slice Slice.
+ * @param[out] index Cell index.
+ * @return bool False if a value is out of range.
+ */
+bool SurveyCube::indexOf(const Slice &slice, std::size_t &index) const {
+    index = 0;
+    for (int d = 0; d < DimensionCount; ++d) {
+        int slot = slice[d] == All ? kDimensionSizes[d] : slice[d] - kDimensionBase[d];
+        if (slot < 0 || slot > kDimensionSizes[d]) return false;
+        index += static_cast<std::size_t>(slot) * strides[d];
+    }
+    return true;
+}
+
+/**
+ * @brief Adds a survey to every cell it rolls up into.
+ * @param profile Survey.
+ */
+void SurveyCube::add(const SurveyProfile &profile) {
+    Slice slice = sliceOf(profile);
+    std::size_t base[DimensionCount], rolled[DimensionCount];
+    for (int d = 0; d < DimensionCount; ++d) {
+        int slot = slice[d] - kDimensionBase[d];
+        if (slot < 0 || slot >= kDimensionSizes[d]) return;
+        base[d] = static_cast<std::size_t>(slot) * strides[d];
+        rolled[d] = static_cast<std::size_t>(kDimensionSizes[d]) * strides[d];
+    }
+    int tier = profile.tier < 0 ? 0 : (profile.tier > 2 ? 2 : profile.tier);
+    double vitals[VitalCount];
+    for (int v = 0; v < VitalCount; ++v) vitals[v] = vitalOf(profile, static_cast<Vital>(v));
+
+    // Bit d of mask rolls dimension d up.
+    for (unsigned mask = 0; mask < (1u << DimensionCount); ++mask) {
+        std::size_t index = 0;
+        for (int d = 0; d < DimensionCount; ++d) index += (mask >> d) & 1u ? rolled[d] : base[d];
+        Cell &cell = cells[index];
+        ++cell.tierCounts[tier];
+        for (int v = 0; v < VitalCount; ++v) {
+            if (vitals[v] < 0) continue;
+            ++cell.vitalCounts[v];
+            cell.vitalSums[v] += vitals[v];
+        }
+    }
+}
+
+/**
+ * @brief Looks up the aggregates of a slice.
+ * @param slice Slice.
+ * @return const Cell& Aggregates.
+ */
+const SurveyCube::Cell& SurveyCube::query(const Slice &slice) const {
+    static const Cell empty;
+    std::size_t index;
+    if (!indexOf(slice, index)) return empty;
+    return cells[index];
+}
+
+/**
+ * @brief Breaks a slice down by the values of one dimension.
+ * @param dimension Dimension to group by.
+ * @param filter Slice to break down.
+ * @return std::vector<Cell> One cell per value of the dimension.
+ */
+std::vector<SurveyCube::Cell> SurveyCube::breakdown(Dimension dimension, const Slice &filter) const {
+    std::vector<Cell> result;
+    result.reserve(static_cast<std::size_t>(kDimensionSizes[dimension]));
+    Slice slice = filter;
+    for (int slot = 0; slot < kDimensionSizes[dimension]; ++slot) {
+        slice[dimension] = kDimensionBase[dimension] + slot;
+        result.push_back(query(slice));
+    }
+    return result;
+}
+
+/**
+ * @brief Removes every survey.
+ */
+void SurveyCube::clear() {
+    std::fill(cells.begin(), cells.end(), Cell());
+}
+
+/**
+ * @brief Recomputes every roll-up cell from the base cells.
+ *
+ * Rolls up one dimension at a time: after pass d, the "all" slot of d holds the sum over d's values of cells
+ * that are already complete in dimensions 0..d-1. Seven passes over the cube instead of 128 updates per cell.
+ */
+void SurveyCube::rebuildRollups() {
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        for (int d = 0; d < DimensionCount; ++d) {
+            if ((i / strides[d]) % static_cast<std::size_t>(kDimensionSizes[d] + 1) ==
+                static_cast<std::size_t>(kDimensionSizes[d])) {
+                cells[i] = Cell();
+                break;
+            }
+        }
+    }
+    for (int d = 0; d < DimensionCount; ++d) {
+        std::size_t slots = static_cast<std::size_t>(kDimensionSizes[d] + 1);
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            std::size_t slot = (i / strides[d]) % slots;
+            if (slot + 1 == slots) continue;
+            cells[i + (slots - 1 - slot) * strides[d]].merge(cells[i]);
+        }
+    }
+}
+
+/**
+ * @brief Writes the non-empty base cells in binary form.
+ * @param out Binary output stream.
+ */
+void SurveyCube::write(std::ostream &out) const {
+    std::vector<std::uint32_t> used;
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        if (cells[i].count() == 0) continue;
+        bool isBase = true;
+        for (int d = 0; d < DimensionCount && isBase; ++d)
+            isBase = (i / strides[d]) % static_cast<std::size_t>(kDimensionSizes[d] + 1) !=
+                     static_cast<std::size_t>(kDimensionSizes[d]);
+        if (isBase) used.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    std::uint32_t count = static_cast<std::uint32_t>(used.size());
+    out.write(kCubeMagic, sizeof(kCubeMagic));
+    out.write(reinterpret_cast<const char *>(&kCubeVersion), sizeof(kCubeVersion));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    for (std::uint32_t index : used) {
+        const Cell &cell = cells[index];
+        out.write(reinterpret_cast<const char *>(&index), sizeof(index));
+        out.write(reinterpret_cast<const char *>(cell.tierCounts), sizeof(cell.tierCounts));
+        out.write(reinterpret_cast<const char *>(cell.vitalCounts), sizeof(cell.vitalCounts));
+        out.write(reinterpret_cast<const char *>(cell.vitalSums), sizeof(cell.vitalSums));
+    }
+}
+
+/**
+ * @brief Reads a cube previously produced by write() and rebuilds its roll-ups.
+ * @param in Binary input stream.
+ * @return bool False if the data is malformed (the cube is left empty).
+ */
+bool SurveyCube::read(std::istream &in) {
+    clear();
+    char magic[4];
+    std::uint32_t version = 0, count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&count), sizeof(count));
+    bool ok = in && std::memcmp(magic, kCubeMagic, sizeof(magic)) == 0 && version == kCubeVersion;
+    for (std::uint32_t n = 0; ok && n < count; ++n) {
+        std::uint32_t index = 0;
+        Cell cell;
+        in.read(reinterpret_cast<char *>(&index), sizeof(index));
+        in.read(reinterpret_cast<char *>(cell.tierCounts), sizeof(cell.tierCounts));
+        in.read(reinterpret_cast<char *>(cell.vitalCounts), sizeof(cell.vitalCounts));
+        in.read(reinterpret_cast<char *>(cell.vitalSums), sizeof(cell.vitalSums));
+        ok = in && index < cells.size();
+        if (ok) cells[index] = cell;
+    }
+    if (!ok) {
+        clear();
+        return false;
+    }
+    rebuildRollups();
+    return true;
+}
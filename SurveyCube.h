@@ -0,0 +1,192 @@
+#ifndef SURVEYCUBE_H
+#define SURVEYCUBE_H
+
+/**
+ * @file SurveyCube.h
+ * @brief Declaration of the SurveyCube class, a dense precomputed aggregate cube over survey answers.
+ *
+ * This header declares an in-memory OLAP cube over the seven survey dimensions (age group, gender, sleep,
+ * exercise, family-history combination, diet, smoking). Every dimension has one extra "all" slot, and each
+ * submitted survey is added to every cell it rolls up into, so any roll-up or slice is a single array lookup.
+ */
+
+#include "SurveyIndex.h"
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class SurveyCube
+ * @brief Counts per risk tier and vitals sums for every combination of survey answers and roll-ups.
+ *
+ * With the survey's option counts (6, 2, 5, 4, 2^4, 6, 2) plus an "all" slot per dimension the cube has
+ * 7·3·6·5·17·7·3 = 224,910 cells. Adding a survey touches the 2^7 = 128 cells it belongs to; a query is
+ * an index computation and one cell read.
+ */
+class SurveyCube {
+public:
+    /**
+     * @brief Cube dimensions, in the order of the survey form.
+     */
+    enum Dimension {
+        Age = 0,
+        Gender,
+        Sleep,
+        Exercise,
+        History,
+        Diet,
+        Smoker,
+        DimensionCount
+    };
+
+    /**
+     * @brief Vitals summed per cell.
+     */
+    enum Vital {
+        Bpm = 0,
+        SpO2,
+        SystolicBP,
+        DiastolicBP,
+        Cholesterol,
+        VitalCount
+    };
+
+    static const int All = -1;      /**< Slice value that rolls a dimension up. */
+
+    /**
+     * @brief Values to fix per dimension, as stored in SurveyProfile (History: disease bit mask), or All.
+     */
+    typedef std::array<int, DimensionCount> Slice;
+
+    /**
+     * @brief Aggregates of one cell.
+     */
+    struct Cell {
+        std::uint32_t tierCounts[3] = { 0, 0, 0 };      /**< Surveys per tier (Low, Moderate, High). */
+        std::uint32_t vitalCounts[VitalCount] = {};     /**< Surveys that recorded each vital. */
+        double vitalSums[VitalCount] = {};              /**< Sum of each recorded vital. */
+
+        /** @return std::uint64_t Number of surveys in the cell. */
+        std::uint64_t count() const {
+            return std::uint64_t(tierCounts[0]) + tierCounts[1] + tierCounts[2];
+        }
+
+        /**
+         * @brief Gets the mean of a vital.
+         * @param vital Vital.
+         * @return double Mean, or -1 if no survey in the cell recorded it.
+         */
+        double mean(Vital vital) const {
+            return vitalCounts[vital] ? vitalSums[vital] / vitalCounts[vital] : -1.0;
+        }
+
+        /**
+         * @brief Gets the share of surveys in a tier.
+         * @param tier 0: Low, 1: Moderate, 2: High.
+         * @return double Fraction in [0, 1] (0 for an empty cell).
+         */
+        double tierShare(int tier) const {
+            std::uint64_t total = count();
+            return total ? static_cast<double>(tierCounts[tier]) / total : 0.0;
+        }
+
+        /**
+         * @brief Adds another cell's aggregates.
+         * @param other Cell to add.
+         */
+        void merge(const Cell &other);
+    };
+
+    /**
+     * @brief Constructs an empty cube.
+     */
+    SurveyCube();
+
+    /**
+     * @brief Adds a survey to every cell it rolls up into.
+     * @param profile Survey with its tier and (optionally) vitals.
+     */
+    void add(const SurveyProfile &profile);
+
+    /**
+     * @brief Looks up the aggregates of a slice.
+     * @param slice Fixed value or All per dimension.
+     * @return const Cell& Aggregates (an empty cell if a value is out of range).
+     */
+    const Cell& query(const Slice &slice) const;
+
+    /**
+     * @brief Breaks a slice down by the values of one dimension.
+     * @param dimension Dimension to group by.
+     * @param filter Slice to break down (its value for dimension is ignored).
+     * @return std::vector<Cell> One cell per value of the dimension, in value order.
+     */
+    std::vector<Cell> breakdown(Dimension dimension, const Slice &filter) const;
+
+    /** @return Slice A slice with every dimension rolled up (the whole population). */
+    static Slice everything();
+
+    /**
+     * @brief Gets the slice a profile falls into.
+     * @param profile Profile.
+     * @return Slice Its value in every dimension.
+     */
+    static Slice sliceOf(const SurveyProfile &profile);
+
+    /**
+     * @brief Gets a recorded vital of a profile.
+     * @param profile Profile.
+     * @param vital Vital.
+     * @return double Value, negative if not recorded.
+     */
+    static double vitalOf(const SurveyProfile &profile, Vital vital);
+
+    /**
+     * @brief Gets the number of values a dimension can take (excluding All).
+     * @param dimension Dimension.
+     * @return int Number of values.
+     */
+    static int valueCount(Dimension dimension);
+
+    /** @return std::uint64_t Number of surveys added. */
+    std::uint64_t size() const { return cells.back().count(); }
+
+    /**
+     * @brief Removes every survey.
+     */
+    void clear();
+
+    /**
+     * @brief Writes the non-empty base cells in binary form.
+     * @param out Binary output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads a cube previously produced by write() and rebuilds its roll-ups.
+     * @param in Binary input stream.
+     * @return bool False if the data is malformed.
+     */
+    bool read(std::istream &in);
+
+private:
+    std::vector<Cell> cells;                    /**< Every cell; the last one is the grand total. */
+    std::size_t strides[DimensionCount];        /**< Cell index step per dimension slot. */
+
+    /**
+     * @brief Converts a slice to a cell index.
+     * @param slice Slice.
+     * @param[out] index Cell index.
+     * @return bool False if a value is out of range.
+     */
+    bool indexOf(const Slice &slice, std::size_t &index) const;
+
+    /**
+     * @brief Recomputes every roll-up cell from the base cells.
+     */
+    void rebuildRollups();
+};
+
+#endif // SURVEYCUBE_H
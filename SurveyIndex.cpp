@@ -0,0 +1,384 @@
+/**
+ * @file SurveyIndex.cpp
+ * @brief Implements the SurveyIndex posting lists and its query parser.
+ *
+ * Binary format: "HPSI", a uint32 version, a uint32 profile count, the universe bitmap, then every posting
+ * list in field/value order.
+ */
+
+#include "SurveyIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char kIndexMagic[4] = { 'H', 'P', 'S', 'I' };
+const std::uint32_t kIndexVersion = 1;
+
+// Value counts and the first stored value of each field, in Field order.
+const int kValueCounts[SurveyIndex::FieldCount] = { 6, 2, 5, 4, 4, 6, 2, 3 };
+const int kValueBase[SurveyIndex::FieldCount]   = { 1, 0, 1, 1, 0, 1, 0, 0 };
+
+/**
+ * @brief Lower-cases a string.
+ * @param text Text.
+ * @return std::string Lower-case copy.
+ */
+std::string lower(const std::string &text) {
+    std::string result = text;
+    for (char &c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return result;
+}
+
+/**
+ * @brief Parses a whole string as an integer.
+ * @param text Text.
+ * @param[out] value Parsed value.
+ * @return bool False if the text is not an integer.
+ */
+bool parseInt(const std::string &text, int &value) {
+    if (text.empty()) return false;
+    char *end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0') return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Builds a profile from survey answers.
+ * @param family Survey answers.
+ * @param tier Risk tier name.
+ * @param user Username.
+ * @param timestamp Submission time.
+ * @return SurveyProfile The profile.
+ */
+SurveyProfile SurveyProfile::fromFamilyHealth(const FamilyHealth &family, const std::string &tier,
+                                              const std::string &user, long long timestamp) {
+    SurveyProfile profile;
+    profile.user = user;
+    profile.timestamp = timestamp;
+    profile.ageGroup = family.getAgeGroup();
+    profile.male = family.getGender();
+    profile.sleepHours = family.getSleepHours();
+    profile.exerciseFrequency = family.getExerciseFrequency();
+    for (int i = 0; i < 4; ++i)
+        if (family.hasFamilyDisease(i)) profile.familyHistory |= 1u << i;
+    profile.dietType = family.getDietType();
+    profile.smoker = family.getIsSmoker();
+    profile.tier = std::max(0, tierIndex(tier));
+    return profile;
+}
+
+/**
+ * @brief Converts a tier name to its index.
+ * @param tier Tier name.
+ * @return int 0, 1, 2, or -1.
+ */
+int SurveyProfile::tierIndex(const std::string &tier) {
+    std::string name = lower(tier);
+    if (name == "low") return 0;
+    if (name == "moderate") return 1;
+    if (name == "high") return 2;
+    return -1;
+}
+
+/**
+ * @brief Converts a tier index to its name.
+ * @param tier Tier index.
+ * @return std::string Tier name.
+ */
+std::string SurveyProfile::tierName(int tier) {
+    static const char *names[] = { "Low", "Moderate", "High" };
+    return names[std::min(std::max(tier, 0), 2)];
+}
+
+/**
+ * @brief Recursive-descent parser and evaluator for SurveyIndex queries.
+ */
+class SurveyIndex::Parser {
+public:
+    Parser(const SurveyIndex &index, const std::string &text) : index(index), text(text) { next(); }
+
+    /**
+     * @brief Parses and evaluates the whole query.
+     * @param[out] result Matching profiles.
+     * @param[out] error First error.
+     * @return bool False on a syntax error.
+     */
+    bool run(RoaringBitmap &result, std::string &error) {
+        Operand operand = expression();
+        result = failed.empty() ? operand.get() : RoaringBitmap();
+        if (failed.empty() && !token.empty()) failed = "Unexpected '" + token + "'";
+        error = failed;
+        return failed.empty();
+    }
+
+private:
+    const SurveyIndex &index;
+    const std::string &text;
+    std::size_t pos = 0;
+    std::string token;
+    std::string failed;
+
+    /**
+     * @brief Reads the next token: a word, '=', '(' or ')'. An empty token marks the end.
+     */
+    void next() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        token.clear();
+        if (pos >= text.size()) return;
+        char c = text[pos];
+        if (c == '=' || c == '(' || c == ')') {
+            token = c;
+            ++pos;
+            return;
+        }
+        while (pos < text.size()) {
+            c = text[pos];
+            if (std::isspace(static_cast<unsigned char>(c)) || c == '=' || c == '(' || c == ')') break;
+            token += c;
+            ++pos;
+        }
+    }
+
+    bool isKeyword(const char *keyword) const { return lower(token) == keyword; }
+
+    /**
+     * @brief A sub-result: either a posting list borrowed from the index or a computed bitmap.
+     *
+     * Borrowing means a term like "age=4" costs nothing until it is combined with something else.
+     */
+    struct Operand {
+        const RoaringBitmap *borrowed = nullptr;
+        RoaringBitmap owned;
+
+        const RoaringBitmap& get() const { return borrowed ? *borrowed : owned; }
+    };
+
+    static Operand own(RoaringBitmap bitmap) {
+        Operand operand;
+        operand.owned = std::move(bitmap);
+        return operand;
+    }
+
+    Operand expression() {
+        Operand result = term();
+        while (failed.empty() && isKeyword("or")) {
+            next();
+            Operand right = term();
+            result = own(result.get() | right.get());
+        }
+        return result;
+    }
+
+    Operand term() {
+        // Positive factors are intersected in a single multi-way pass; "AND NOT x" factors are subtracted
+        // afterwards, which avoids materialising NOT x against the universe.
+        std::vector<Operand> positive, negative;
+        positive.push_back(factor());
+        while (failed.empty() && isKeyword("and")) {
+            next();
+            if (isKeyword("not")) {
+                next();
+                negative.push_back(factor());
+            } else {
+                positive.push_back(factor());
+            }
+        }
+        if (positive.size() == 1 && negative.empty()) return std::move(positive[0]);
+
+        std::vector<const RoaringBitmap *> sets;
+        for (const Operand &operand : positive) sets.push_back(&operand.get());
+        RoaringBitmap result = RoaringBitmap::intersectAll(sets);
+        for (const Operand &operand : negative) result = result - operand.get();
+        return own(std::move(result));
+    }
+
+    Operand factor() {
+        if (!failed.empty()) return Operand();
+        if (isKeyword("not")) {
+            next();
+            Operand inner = factor();
+            return own(index.all() - inner.get());
+        }
+        if (token == "(") {
+            next();
+            Operand inner = expression();
+            if (failed.empty() && token != ")") failed = "Expected ')'";
+            next();
+            return inner;
+        }
+        std::string field = lower(token);
+        next();
+        if (token != "=") {
+            failed = field.empty() ? "Unexpected end of query" : "Expected '=' after '" + field + "'";
+            return Operand();
+        }
+        next();
+        std::string value = lower(token);
+        next();
+        Operand operand;
+        operand.borrowed = lookup(field, value);
+        return operand;
+    }
+
+    const RoaringBitmap* lookup(const std::string &field, const std::string &value) {
+        static const char *ages[] = { "18-24", "25-34", "35-44", "45-54", "55-64", "65+" };
+        static const char *histories[] = { "cad", "diabetes", "cholesterol", "bp" };
+        static const char *diets[] = { "highprotein", "lowcarb", "vegetarian", "western", "vegan", "balanced" };
+
+        int number = 0;
+        bool numeric = parseInt(value, number);
+        auto named = [&](const char *const *names, int count) {
+            for (int i = 0; i < count; ++i)
+                if (value == names[i]) return i + 1;
+            return numeric ? number : 0;
+        };
+
+        Field f;
+        int stored;
+        if (field == "age") { f = Age; stored = named(ages, 6); }
+        else if (field == "gender") { f = Gender; stored = value == "male" ? 1 : (value == "female" ? 0 : -1); }
+        else if (field == "sleep") { f = Sleep; stored = numeric ? number : 0; }
+        else if (field == "exercise") { f = Exercise; stored = numeric ? number : 0; }
+        else if (field == "history") { f = History; stored = named(histories, 4) - 1; }
+        else if (field == "diet") { f = Diet; stored = named(diets, 6); }
+        else if (field == "smoker") { f = Smoker; stored = value == "yes" ? 1 : (value == "no" ? 0 : -1); }
+        else if (field == "tier") { f = Tier; stored = SurveyProfile::tierIndex(value); }
+        else {
+            failed = "Unknown field '" + field + "'";
+            return nullptr;
+        }
+        if (stored < kValueBase[f] || stored >= kValueBase[f] + kValueCounts[f]) {
+            failed = "Unknown value '" + value + "' for " + field;
+            return nullptr;
+        }
+        return &index.posting(f, stored);
+    }
+};
+
+/**
+ * @brief Constructs an empty index.
+ */
+SurveyIndex::SurveyIndex() {
+    for (int f = 0; f < FieldCount; ++f) postings[f].resize(static_cast<std::size_t>(kValueCounts[f]));
+}
+
+/**
+ * @brief Gets the number of distinct values a field can take.
+ * @param field Field.
+ * @return int Number of values.
+ */
+int SurveyIndex::valueCount(Field field) {
+    return kValueCounts[field];
+}
+
+/**
+ * @brief Indexes a profile.
+ * @param profile Profile to add.
+ * @return std::uint32_t The profile's number.
+ */
+std::uint32_t SurveyIndex::add(const SurveyProfile &profile) {
+    std::uint32_t id = profileCount++;
+    everyone.add(id);
+    auto put = [&](Field f, int stored) {
+        int slot = stored - kValueBase[f];
+        if (slot >= 0 && slot < kValueCounts[f]) postings[f][static_cast<std::size_t>(slot)].add(id);
+    };
+    put(Age, profile.ageGroup);
+    put(Gender, profile.male ? 1 : 0);
+    put(Sleep, profile.sleepHours);
+    put(Exercise, profile.exerciseFrequency);
+    for (int i = 0; i < 4; ++i)
+        if (profile.familyHistory & (1u << i)) put(History, i);
+    put(Diet, profile.dietType);
+    put(Smoker, profile.smoker ? 1 : 0);
+    put(Tier, profile.tier);
+    return id;
+}
+
+/**
+ * @brief Gets the posting list of one answer value.
+ * @param field Field.
+ * @param value Stored answer value.
+ * @return const RoaringBitmap& Profiles with that answer.
+ */
+const RoaringBitmap& SurveyIndex::posting(Field field, int value) const {
+    static const RoaringBitmap none;
+    int slot = value - kValueBase[field];
+    if (slot < 0 || slot >= kValueCounts[field]) return none;
+    return postings[field][static_cast<std::size_t>(slot)];
+}
+
+/**
+ * @brief Evaluates a query.
+ * @param expression Query text.
+ * @param[out] result Matching profiles.
+ * @param[out] error First syntax error.
+ * @return bool False on a syntax error.
+ */
+bool SurveyIndex::query(const std::string &expression, RoaringBitmap &result, std::string &error) const {
+    Parser parser(*this, expression);
+    return parser.run(result, error);
+}
+
+/**
+ * @brief Counts the profiles matching a query.
+ * @param expression Query text.
+ * @return long long Matches, or -1 on a syntax error.
+ */
+long long SurveyIndex::count(const std::string &expression) const {
+    RoaringBitmap result;
+    std::string error;
+    if (!query(expression, result, error)) return -1;
+    return static_cast<long long>(result.cardinality());
+}
+
+/**
+ * @brief Removes every profile.
+ */
+void SurveyIndex::clear() {
+    for (int f = 0; f < FieldCount; ++f)
+        for (RoaringBitmap &bitmap : postings[f]) bitmap.clear();
+    everyone.clear();
+    profileCount = 0;
+}
+
+/**
+ * @brief Writes the index in binary form.
+ * @param out Binary output stream.
+ */
+void SurveyIndex::write(std::ostream &out) const {
+    out.write(kIndexMagic, sizeof(kIndexMagic));
+    out.write(reinterpret_cast<const char *>(&kIndexVersion), sizeof(kIndexVersion));
+    out.write(reinterpret_cast<const char *>(&profileCount), sizeof(profileCount));
+    everyone.write(out);
+    for (int f = 0; f < FieldCount; ++f)
+        for (const RoaringBitmap &bitmap : postings[f]) bitmap.write(out);
+}
+
+/**
+ * @brief Reads an index previously produced by write().
+ * @param in Binary input stream.
+ * @return bool False if the data is malformed (the index is left empty).
+ */
+bool SurveyIndex::read(std::istream &in) {
+    clear();
+    char magic[4];
+    std::uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&profileCount), sizeof(profileCount));
+    bool ok = in && std::memcmp(magic, kIndexMagic, sizeof(magic)) == 0 && version == kIndexVersion &&
+              everyone.read(in);
+    for (int f = 0; ok && f < FieldCount; ++f)
+        for (RoaringBitmap &bitmap : postings[f])
+            if (ok && !bitmap.read(in)) ok = false;
+    if (!ok) clear();
+    return ok;
+}
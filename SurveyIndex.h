@@ -0,0 +1,179 @@
+#ifndef SURVEYINDEX_H
+#define SURVEYINDEX_H
+
+/**
+ * @file SurveyIndex.h
+ * @brief Declaration of the SurveyProfile record and the SurveyIndex bitmap index over survey answers.
+ *
+ * This header declares one RoaringBitmap per survey answer value (plus the computed risk tier), keyed by
+ * profile number, and a small boolean query language over them. Cohort questions such as "male smokers aged
+ * 45-54 with a family history of high blood pressure in the High tier" become a handful of bitmap ANDs.
+ */
+
+#include "FamilyHealth.h"
+#include "RoaringBitmap.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One submitted survey with its computed risk tier.
+ */
+struct SurveyProfile {
+    std::string user;               /**< Username (may be empty for anonymous surveys). */
+    long long timestamp = 0;        /**< Submission time (seconds since epoch). */
+    int ageGroup = 1;               /**< 1: 18-24, 2: 25-34, 3: 35-44, 4: 45-54, 5: 55-64, 6: 65+. */
+    bool male = false;              /**< Gender assigned at birth. */
+    int sleepHours = 1;             /**< 1: less than 4 ... 5: more than 8. */
+    int exerciseFrequency = 1;      /**< 1: never ... 4: 6-7 times a week. */
+    unsigned familyHistory = 0;     /**< Bit i set if FamilyHealth disease i runs in the family. */
+    int dietType = 1;               /**< 1: high protein ... 6: balanced. */
+    bool smoker = false;            /**< Smoking status. */
+    int tier = 0;                   /**< 0: Low, 1: Moderate, 2: High. */
+    double bpm = -1.0;              /**< Mean heart rate of the assessment, or -1 if not recorded. */
+    double spo2 = -1.0;             /**< Mean SpO2 (%), or -1 if not recorded. */
+    double systolicBP = -1.0;       /**< Systolic blood pressure, or -1 if not recorded. */
+    double diastolicBP = -1.0;      /**< Diastolic blood pressure, or -1 if not recorded. */
+    double cholesterol = -1.0;      /**< Cholesterol, or -1 if not recorded. */
+
+    /**
+     * @brief Builds a profile from survey answers.
+     * @param family Survey answers.
+     * @param tier Risk tier ("Low", "Moderate" or "High").
+     * @param user Username.
+     * @param timestamp Submission time.
+     * @return SurveyProfile The profile.
+     */
+    static SurveyProfile fromFamilyHealth(const FamilyHealth &family, const std::string &tier,
+                                          const std::string &user, long long timestamp);
+
+    /**
+     * @brief Converts a tier name to its index.
+     * @param tier "Low", "Moderate" or "High" (case-insensitive).
+     * @return int 0, 1 or 2, or -1 if unknown.
+     */
+    static int tierIndex(const std::string &tier);
+
+    /**
+     * @brief Converts a tier index to its name.
+     * @param tier 0, 1 or 2.
+     * @return std::string "Low", "Moderate" or "High".
+     */
+    static std::string tierName(int tier);
+};
+
+/**
+ * @class SurveyIndex
+ * @brief Roaring bitmap per answer value, with AND / OR / NOT queries and counts.
+ *
+ * Profiles are numbered in insertion order, so every posting list is appended to in increasing order.
+ *
+ * Query syntax (keywords are case-insensitive; AND binds tighter than OR):
+ *   expr  := term { OR term }
+ *   term  := factor { AND factor }
+ *   factor:= NOT factor | '(' expr ')' | field '=' value
+ * Fields and values:
+ *   age = 1..6 | 18-24 | 25-34 | 35-44 | 45-54 | 55-64 | 65+
+ *   gender = female | male
+ *   sleep = 1..5
+ *   exercise = 1..4
+ *   history = cad | diabetes | cholesterol | bp | 1..4   (the disease runs in the family)
+ *   diet = 1..6 | highprotein | lowcarb | vegetarian | western | vegan | balanced
+ *   smoker = yes | no
+ *   tier = low | moderate | high
+ */
+class SurveyIndex {
+public:
+    /**
+     * @brief Indexed survey fields.
+     */
+    enum Field {
+        Age = 0,
+        Gender,
+        Sleep,
+        Exercise,
+        History,
+        Diet,
+        Smoker,
+        Tier,
+        FieldCount
+    };
+
+    /**
+     * @brief Constructs an empty index.
+     */
+    SurveyIndex();
+
+    /**
+     * @brief Indexes a profile.
+     * @param profile Profile to add.
+     * @return std::uint32_t The profile's number.
+     */
+    std::uint32_t add(const SurveyProfile &profile);
+
+    /**
+     * @brief Gets the posting list of one answer value.
+     * @param field Field.
+     * @param value Answer value as stored in SurveyProfile (History: disease index 0-3).
+     * @return const RoaringBitmap& Profiles with that answer (empty if the value is out of range).
+     */
+    const RoaringBitmap& posting(Field field, int value) const;
+
+    /** @return const RoaringBitmap& Every indexed profile (the universe for NOT). */
+    const RoaringBitmap& all() const { return everyone; }
+
+    /** @return std::uint32_t Number of indexed profiles. */
+    std::uint32_t size() const { return profileCount; }
+
+    /**
+     * @brief Evaluates a query.
+     * @param expression Query text.
+     * @param[out] result Matching profiles.
+     * @param[out] error Description of the first syntax error.
+     * @return bool False on a syntax error.
+     */
+    bool query(const std::string &expression, RoaringBitmap &result, std::string &error) const;
+
+    /**
+     * @brief Counts the profiles matching a query.
+     * @param expression Query text.
+     * @return long long Number of matches, or -1 on a syntax error.
+     */
+    long long count(const std::string &expression) const;
+
+    /**
+     * @brief Removes every profile.
+     */
+    void clear();
+
+    /**
+     * @brief Writes the index in binary form.
+     * @param out Binary output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads an index previously produced by write().
+     * @param in Binary input stream.
+     * @return bool False if the data is malformed.
+     */
+    bool read(std::istream &in);
+
+    /**
+     * @brief Gets the number of distinct values a field can take.
+     * @param field Field.
+     * @return int Number of values.
+     */
+    static int valueCount(Field field);
+
+private:
+    std::vector<RoaringBitmap> postings[FieldCount];    /**< Posting list per field value. */
+    RoaringBitmap everyone;                             /**< All profile numbers. */
+    std::uint32_t profileCount = 0;                     /**< Profiles indexed. */
+
+    class Parser;
+};
+
+#endif // SURVEYINDEX_H
@@ -0,0 +1,348 @@
+/**
+ * @file SurveyStore.cpp
+ * @brief Implements the SurveyStore survey log and index and cube maintenance.
+ *
+ * Log rows are "username,timestamp,ageGroup,gender,sleepHours,exercise,familyHistoryBits,diet,smoker,tier,
+ * bpm,spo2,sysbp,diasbp,cholesterol" with gender and smoker as 0/1, tier as its name and -1 for vitals that
+ * were not recorded (rows without the vitals columns are also accepted). The index, cube and latest files each
+ * start with a uint64 log offset followed by the SurveyIndex or SurveyCube binary form, or for SurveyLatest one
+ * log row per user.
+ */
+
+#include "SurveyStore.h"
+#include "ErrorHandling.h"
+#include "FileLock.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace {
+
+const char *kSurveyHeader = "Username,Timestamp,AgeGroup,Gender,SleepHours,Exercise,FamilyHistory,Diet,Smoker,Tier,"
+                            "BPM,SpO2,SysBP,DiasBP,Cholesterol";
+
+/**
+ * @brief Reads a persisted index or cube and the log offset it covers.
+ * @param path File path.
+ * @param[out] model SurveyIndex or SurveyCube.
+ * @param[out] offset Log bytes covered.
+ * @return bool False if the file is missing or malformed.
+ */
+template <typename Model>
+bool readModelFile(const std::string &path, Model &model, std::uint64_t &offset) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    if (!in.read(reinterpret_cast<char *>(&offset), sizeof(offset))) return false;
+    return model.read(in);
+}
+
+/**
+ * @brief Writes an index or cube and its log offset via a temporary file and rename.
+ * @param path File path.
+ * @param model SurveyIndex or SurveyCube.
+ * @param offset Log bytes covered.
+ * @return bool False if the file could not be written.
+ */
+template <typename Model>
+bool writeModelFile(const std::string &path, const Model &model, std::uint64_t offset) {
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            ErrorHandling::logErrorMessage("Failed to write " + tempPath);
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+        model.write(out);
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        ErrorHandling::logErrorMessage("Failed to replace " + path + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses complete log lines from a buffer.
+ * @param buffer Log bytes.
+ * @param visit Called with each parsed profile.
+ * @return std::size_t Bytes consumed (through the last newline).
+ */
+template <typename Visitor>
+std::size_t parseBuffer(const std::string &buffer, Visitor visit) {
+    std::size_t lineStart = 0;
+    SurveyProfile profile;
+    std::string line;
+    while (true) {
+        std::size_t newline = buffer.find('\n', lineStart);
+        if (newline == std::string::npos) break;
+        line.assign(buffer, lineStart, newline - lineStart);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (SurveyStore::parseLine(line, profile)) visit(profile);
+        lineStart = newline + 1;
+    }
+    return lineStart;
+}
+
+/**
+ * @brief Loads a persisted index or cube and folds in any surveys logged since it was saved.
+ * @param modelPath Persisted file path.
+ * @param csvPath Survey log path.
+ * @param[out] model The up-to-date SurveyIndex or SurveyCube.
+ * @return bool False if neither the file nor the log could be read.
+ */
+template <typename Model>
+bool loadAndCatchUp(const std::string &modelPath, const std::string &csvPath, Model &model) {
+    std::uint64_t offset = 0;
+    bool haveModel = readModelFile(modelPath, model, offset);
+    if (!haveModel) {
+        model.clear();
+        offset = 0;
+    }
+
+    std::ifstream csv(csvPath, std::ios::binary | std::ios::ate);
+    if (!csv.is_open()) return haveModel;
+    std::uint64_t size = static_cast<std::uint64_t>(csv.tellg());
+    if (size < offset) {
+        // The log was replaced; rebuild from scratch.
+        model.clear();
+        offset = 0;
+    }
+    if (size == offset && haveModel) return true;
+
+    std::string tail(static_cast<std::size_t>(size - offset), '\0');
+    csv.seekg(static_cast<std::streamoff>(offset));
+    csv.read(&tail[0], static_cast<std::streamsize>(tail.size()));
+    offset += parseBuffer(tail, [&](const SurveyProfile &profile) { model.add(profile); });
+    writeModelFile(modelPath, model, offset);
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Records a survey.
+ * @param profile Survey in log order.
+ */
+void SurveyLatest::add(const SurveyProfile &profile) {
+    if (!profile.user.empty()) latest[profile.user] = profile;
+}
+
+/**
+ * @brief Finds a user's latest survey.
+ * @param user Username.
+ * @return const SurveyProfile* The survey, or nullptr.
+ */
+const SurveyProfile *SurveyLatest::find(const std::string &user) const {
+    auto it = latest.find(user);
+    return it == latest.end() ? nullptr : &it->second;
+}
+
+/**
+ * @brief Writes the surveys as log rows.
+ * @param out Output stream.
+ */
+void SurveyLatest::write(std::ostream &out) const {
+    for (const auto &entry : latest) out << SurveyStore::formatLine(entry.second) << '\n';
+}
+
+/**
+ * @brief Reads surveys written by write().
+ * @param in Input stream.
+ * @return bool False if a row is malformed.
+ */
+bool SurveyLatest::read(std::istream &in) {
+    latest.clear();
+    std::string line;
+    SurveyProfile profile;
+    while (std::getline(in, line)) {
+        if (!SurveyStore::parseLine(line, profile)) return false;
+        add(profile);
+    }
+    return true;
+}
+
+/**
+ * @brief Constructs a new SurveyStore object.
+ * @param csvFile Path of the survey log.
+ * @param indexFile Path of the persisted index.
+ * @param cubeFile Path of the persisted cube.
+ * @param latestFile Path of the persisted latest surveys.
+ */
+SurveyStore::SurveyStore(const std::string &csvFile, const std::string &indexFile, const std::string &cubeFile,
+                         const std::string &latestFile)
+    : csvPath(csvFile), indexPath(indexFile), cubePath(cubeFile), latestPath(latestFile) {}
+
+/**
+ * @brief Parses a survey log row.
+ * @param line CSV line.
+ * @param[out] profile Parsed profile.
+ * @return bool False for the header and malformed rows.
+ */
+bool SurveyStore::parseLine(const std::string &line, SurveyProfile &profile) {
+    std::size_t comma = line.find(',');
+    if (comma == std::string::npos) return false;
+    profile.user = line.substr(0, comma);
+
+    const char *p = line.c_str() + comma + 1;
+    char *end = nullptr;
+    long long values[7];
+    profile.timestamp = std::strtoll(p, &end, 10);
+    if (end == p || *end != ',') return false;
+    for (long long &v : values) {
+        p = end + 1;
+        v = std::strtoll(p, &end, 10);
+        if (end == p || *end != ',') return false;
+    }
+    p = end + 1;
+    const char *tierEnd = std::strchr(p, ',');
+    int tier = SurveyProfile::tierIndex(tierEnd ? std::string(p, tierEnd) : std::string(p));
+    if (tier < 0) return false;
+
+    double vitals[5] = { -1.0, -1.0, -1.0, -1.0, -1.0 };
+    for (int i = 0; tierEnd && i < 5; ++i) {
+        p = tierEnd + 1;
+        vitals[i] = std::strtod(p, &end);
+        if (end == p || (*end != ',' && *end != '\0')) return false;
+        tierEnd = *end == ',' ? end : nullptr;
+    }
+
+    profile.ageGroup = static_cast<int>(values[0]);
+    profile.male = values[1] != 0;
+    profile.sleepHours = static_cast<int>(values[2]);
+    profile.exerciseFrequency = static_cast<int>(values[3]);
+    profile.familyHistory = static_cast<unsigned>(values[4]);
+    profile.dietType = static_cast<int>(values[5]);
+    profile.smoker = values[6] != 0;
+    profile.tier = tier;
+    profile.bpm = vitals[0];
+    profile.spo2 = vitals[1];
+    profile.systolicBP = vitals[2];
+    profile.diastolicBP = vitals[3];
+    profile.cholesterol = vitals[4];
+    return true;
+}
+
+/**
+ * @brief Formats a profile as a survey log row.
+ * @param profile Profile.
+ * @return std::string CSV row.
+ */
+std::string SurveyStore::formatLine(const SurveyProfile &profile) {
+    char vitals[96];
+    std::snprintf(vitals, sizeof(vitals), ",%.1f,%.1f,%.1f,%.1f,%.1f", profile.bpm, profile.spo2,
+                  profile.systolicBP, profile.diastolicBP, profile.cholesterol);
+    return profile.user + "," + std::to_string(profile.timestamp) + "," + std::to_string(profile.ageGroup) + "," +
+           (profile.male ? "1" : "0") + "," + std::to_string(profile.sleepHours) + "," +
+           std::to_string(profile.exerciseFrequency) + "," + std::to_string(profile.familyHistory) + "," +
+           std::to_string(profile.dietType) + "," + (profile.smoker ? "1" : "0") + "," +
+           SurveyProfile::tierName(profile.tier) + vitals;
+}
+
+/**
+ * @brief Appends profiles to the log and folds them into the persisted index, cube and latest surveys.
+ * @param profiles Profiles to append.
+ * @param[out] cube If given, receives the up-to-date cube.
+ * @return bool False if the log could not be written.
+ */
+bool SurveyStore::append(const std::vector<SurveyProfile> &profiles, SurveyCube *cube) {
+    if (profiles.empty()) return true;
+    std::string buffer;
+    // Measuring, appending and any rollback happen under the log's lock, so a rollback only cuts off this batch.
+    FileLock lock(csvPath + ".lock");
+    std::error_code ec;
+    std::uintmax_t previousSize = std::filesystem::exists(csvPath, ec) ? std::filesystem::file_size(csvPath, ec) : 0;
+    if (ec) previousSize = 0;
+    if (previousSize == 0) buffer += std::string(kSurveyHeader) + "\n";
+    for (const SurveyProfile &profile : profiles) buffer += formatLine(profile) + "\n";
+
+    std::ofstream out(csvPath, std::ios::binary | std::ios::app);
+    if (!out.is_open()) {
+        ErrorHandling::logErrorMessage("Failed to open " + csvPath + " for appending surveys");
+        return false;
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.close();
+    if (!out) {
+        ErrorHandling::logErrorMessage("Failed to append surveys to " + csvPath);
+        // A partial row would be read as a survey by every later catch-up, so the batch is cut off again.
+        if (lock.isLocked() && std::filesystem::file_size(csvPath, ec) > previousSize && !ec)
+            std::filesystem::resize_file(csvPath, previousSize, ec);
+        return false;
+    }
+
+    SurveyIndex index;
+    loadIndex(index);
+    SurveyCube updated;
+    loadCube(cube ? *cube : updated);
+    SurveyLatest latest;
+    loadLatest(latest);
+    return true;
+}
+
+/**
+ * @brief Loads the index, catching it up with any surveys logged since it was saved.
+ * @param[out] index The up-to-date index.
+ * @return bool False if neither the index nor the log could be read.
+ */
+bool SurveyStore::loadIndex(SurveyIndex &index) const {
+    return loadAndCatchUp(indexPath, csvPath, index);
+}
+
+/**
+ * @brief Loads the cube, catching it up with any surveys logged since it was saved.
+ * @param[out] cube The up-to-date cube.
+ * @return bool False if neither the cube nor the log could be read.
+ */
+bool SurveyStore::loadCube(SurveyCube &cube) const {
+    return loadAndCatchUp(cubePath, csvPath, cube);
+}
+
+/**
+ * @brief Loads each user's latest survey, catching up with any surveys logged since it was saved.
+ * @param[out] latest The up-to-date latest surveys.
+ * @return bool False if neither the saved surveys nor the log could be read.
+ */
+bool SurveyStore::loadLatest(SurveyLatest &latest) const {
+    return loadAndCatchUp(latestPath, csvPath, latest);
+}
+
+/**
+ * @brief Gets one user's latest survey.
+ * @param user Username.
+ * @param[out] profile The survey.
+ * @return bool False if the user has not submitted a survey.
+ */
+bool SurveyStore::loadLatest(const std::string &user, SurveyProfile &profile) const {
+    SurveyLatest latest;
+    if (!loadLatest(latest)) return false;
+    const SurveyProfile *found = latest.find(user);
+    if (!found) return false;
+    profile = *found;
+    return true;
+}
+
+/**
+ * @brief Reads every profile in the log.
+ * @param[out] profiles Profiles in log order.
+ * @return bool False if the log could not be read.
+ */
+bool SurveyStore::loadProfiles(std::vector<SurveyProfile> &profiles) const {
+    profiles.clear();
+    std::ifstream csv(csvPath, std::ios::binary | std::ios::ate);
+    if (!csv.is_open()) return false;
+    std::string buffer(static_cast<std::size_t>(csv.tellg()), '\0');
+    csv.seekg(0);
+    csv.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+    parseBuffer(buffer, [&](const SurveyProfile &profile) { profiles.push_back(profile); });
+    return true;
+}
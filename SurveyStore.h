@@ -0,0 +1,151 @@
+#ifndef SURVEYSTORE_H
+#define SURVEYSTORE_H
+
+/**
+ * @file SurveyStore.h
+ * @brief Declaration of the SurveyStore class, which logs submitted surveys and keeps their index current.
+ *
+ * This header declares the survey counterpart of ReadingStore: surveys are appended to surveydata.csv, and the
+ * SurveyIndex, SurveyCube and SurveyLatest saved next to the reading summaries each record how many bytes of
+ * that log they cover, so loading any of them only parses surveys submitted since it was last saved.
+ */
+
+#include "SurveyCube.h"
+#include "SurveyIndex.h"
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class SurveyLatest
+ * @brief The latest survey of each user, so a screen that needs one user's answers does not parse the log.
+ */
+class SurveyLatest {
+public:
+    /**
+     * @brief Records a survey; a later one replaces the user's earlier one (anonymous surveys are ignored).
+     * @param profile Survey in log order.
+     */
+    void add(const SurveyProfile &profile);
+
+    /**
+     * @brief Finds a user's latest survey.
+     * @param user Username.
+     * @return const SurveyProfile* The survey, or nullptr if the user has none.
+     */
+    const SurveyProfile *find(const std::string &user) const;
+
+    /** @brief Forgets every survey. */
+    void clear() { latest.clear(); }
+
+    /**
+     * @brief Writes the surveys as log rows.
+     * @param out Output stream.
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads surveys written by write().
+     * @param in Input stream.
+     * @return bool False if a row is malformed.
+     */
+    bool read(std::istream &in);
+
+private:
+    std::unordered_map<std::string, SurveyProfile> latest;  /**< Latest survey by username. */
+};
+
+/**
+ * @class SurveyStore
+ * @brief Appends survey profiles to a CSV log and maintains the persisted SurveyIndex, SurveyCube and SurveyLatest.
+ */
+class SurveyStore {
+private:
+    std::string csvPath;        /**< Path of the survey log. */
+    std::string indexPath;      /**< Path of the persisted index. */
+    std::string cubePath;       /**< Path of the persisted cube. */
+    std::string latestPath;     /**< Path of the persisted latest surveys. */
+
+public:
+    /**
+     * @brief Constructs a new SurveyStore object.
+     * @param csvFile Path of the survey log.
+     * @param indexFile Path of the persisted index.
+     * @param cubeFile Path of the persisted cube.
+     * @param latestFile Path of the persisted latest surveys.
+     */
+    explicit SurveyStore(const std::string &csvFile = "surveydata.csv",
+                         const std::string &indexFile = "summaries/survey.index",
+                         const std::string &cubeFile = "summaries/survey.cube",
+                         const std::string &latestFile = "summaries/survey.latest");
+
+    /**
+     * @brief Appends profiles to the log in one write and folds them into the persisted index, cube and latest
+     *        surveys.
+     *
+     * Runs under a FileLock on "<log>.lock". A failed write is cut back to the log's previous length under the
+     * same lock, so a partial row never stays behind and rows other processes append are never cut off.
+     *
+     * @param profiles Profiles to append.
+     * @param[out] cube If given, receives the up-to-date cube (saves loading it again).
+     * @return bool False if the log could not be written.
+     */
+    bool append(const std::vector<SurveyProfile> &profiles, SurveyCube *cube = nullptr);
+
+    /**
+     * @brief Loads the index, catching it up with any surveys logged since it was saved.
+     * @param[out] index The up-to-date index.
+     * @return bool False if neither the index nor the log could be read.
+     */
+    bool loadIndex(SurveyIndex &index) const;
+
+    /**
+     * @brief Loads the cube, catching it up with any surveys logged since it was saved.
+     * @param[out] cube The up-to-date cube.
+     * @return bool False if neither the cube nor the log could be read.
+     */
+    bool loadCube(SurveyCube &cube) const;
+
+    /**
+     * @brief Loads each user's latest survey, catching up with any surveys logged since it was saved.
+     * @param[out] latest The up-to-date latest surveys.
+     * @return bool False if neither the saved surveys nor the log could be read.
+     */
+    bool loadLatest(SurveyLatest &latest) const;
+
+    /**
+     * @brief Gets one user's latest survey.
+     * @param user Username.
+     * @param[out] profile The survey.
+     * @return bool False if the user has not submitted a survey.
+     */
+    bool loadLatest(const std::string &user, SurveyProfile &profile) const;
+
+    /**
+     * @brief Reads every profile in the log.
+     * @param[out] profiles Profiles in log order (profile number = position).
+     * @return bool False if the log could not be read.
+     */
+    bool loadProfiles(std::vector<SurveyProfile> &profiles) const;
+
+    /** @return const std::string& Path of the survey log. */
+    const std::string& getCsvPath() const { return csvPath; }
+
+    /**
+     * @brief Parses a survey log row.
+     * @param line CSV line without the newline.
+     * @param[out] profile Parsed profile.
+     * @return bool False for the header and malformed rows.
+     */
+    static bool parseLine(const std::string &line, SurveyProfile &profile);
+
+    /**
+     * @brief Formats a profile as a survey log row (without the newline).
+     * @param profile Profile.
+     * @return std::string CSV row.
+     */
+    static std::string formatLine(const SurveyProfile &profile);
+};
+
+#endif // SURVEYSTORE_H
@@ -0,0 +1,260 @@
+/**
+ * @file VitalsBroadcaster.cpp
+ * @brief Implements the WebSocket vitals fan-out.
+ */
+
+#include "VitalsBroadcaster.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+const int VitalsBroadcaster::kLevels;
+
+namespace {
+
+/**
+ * @brief Decodes a percent-encoded query value ('+' is a space).
+ * @param text Encoded text.
+ * @return std::string Decoded text.
+ */
+std::string decodeQueryValue(const std::string &text) {
+    std::string out;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '+') {
+            out += ' ';
+        } else if (c == '%' && i + 2 < text.size() && std::isxdigit(static_cast<unsigned char>(text[i + 1])) &&
+                   std::isxdigit(static_cast<unsigned char>(text[i + 2]))) {
+            out += static_cast<char>(std::stoi(text.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Appends a string to JSON output as a quoted string.
+ * @param out Output.
+ * @param text Text.
+ */
+void appendJsonString(std::string &out, const std::string &text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+            out += escape;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a broadcaster and registers it with a server.
+ * @param server Server the viewers connect to.
+ * @param highWaterBytes Downgrade threshold.
+ * @param maxBacklogBytes Skip threshold.
+ */
+VitalsBroadcaster::VitalsBroadcaster(WebSocketServer &server, std::size_t highWaterBytes,
+                                     std::size_t maxBacklogBytes)
+    : server(server), highWater(highWaterBytes), maxBacklog(std::max(maxBacklogBytes, highWaterBytes)) {
+    server.onOpen([this](int client, const std::string &path, const std::string &query) {
+        return subscribe(client, path, query);
+    });
+    server.onClose([this](int client) { unsubscribe(client); });
+}
+
+/**
+ * @brief Sends a batch of one user's readings to that user's subscribers.
+ *
+ * Each subscriber's level is adjusted from its queue size first, then the batch is encoded for each level
+ * that someone needs, once.
+ *
+ * @param user Username.
+ * @param readings The readings.
+ * @param count Number of readings.
+ */
+void VitalsBroadcaster::publish(const std::string &user, const HeartRateReading *readings, std::size_t count) {
+    auto it = watchers.find(user);
+    if (it == watchers.end() || count == 0) return;
+    WebSocketServer::Message messages[kLevels];
+    for (int client : it->second) {
+        Subscriber &subscriber = subscribers[client];
+        std::size_t backlog = server.backlog(client);
+        if (backlog > highWater && subscriber.level < kLevels - 1) {
+            ++subscriber.level;
+            ++downgraded;
+        } else if (backlog == 0 && subscriber.level > 0) {
+            --subscriber.level;
+        }
+        if (backlog > maxBacklog) {
+            ++skipped;
+            continue;
+        }
+        WebSocketServer::Message &message = messages[subscriber.level];
+        if (!message) {
+            message = WebSocketServer::textMessage(encodeBatch(user, readings, count, subscriber.level));
+            ++encoded;
+        }
+        if (server.send(client, message)) ++sent;
+    }
+}
+
+/**
+ * @brief Starts following a reading CSV from its current end.
+ * @param path Path of the CSV.
+ */
+void VitalsBroadcaster::follow(const std::string &path) {
+    csvPath = path;
+    std::ifstream in(csvPath, std::ios::binary | std::ios::ate);
+    csvOffset = in.is_open() ? static_cast<std::uint64_t>(in.tellg()) : 0;
+}
+
+/**
+ * @brief Publishes the rows appended to the followed CSV since the last call.
+ * @return bool False if the CSV could not be read.
+ */
+bool VitalsBroadcaster::catchUp() {
+    if (csvPath.empty()) return true;
+    std::ifstream in(csvPath, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    std::uint64_t size = static_cast<std::uint64_t>(in.tellg());
+    if (size < csvOffset) {
+        csvOffset = size;
+        return true;
+    }
+    if (size == csvOffset) return true;
+
+    std::string tail(static_cast<std::size_t>(size - csvOffset), '\0');
+    in.seekg(static_cast<std::streamoff>(csvOffset));
+    in.read(&tail[0], static_cast<std::streamsize>(tail.size()));
+    ReadingStore::countCsvBytesScanned(tail.size());
+    std::size_t lineStart = 0;
+    std::string line;
+    HeartRateReading reading;
+    while (true) {
+        std::size_t newline = tail.find('\n', lineStart);
+        if (newline == std::string::npos) break;
+        std::size_t comma = tail.find(',', lineStart);
+        if (comma < newline) {
+            line.assign(tail, lineStart, comma - lineStart);
+            if (watchers.count(line)) {
+                line.assign(tail, lineStart, newline - lineStart);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (ReadingStore::parseReadingLine(line, reading)) pending[reading.user].push_back(reading);
+            }
+        }
+        lineStart = newline + 1;
+    }
+    csvOffset += lineStart;
+
+    for (auto &entry : pending) {
+        if (entry.second.empty()) continue;
+        publish(entry.first, entry.second.data(), entry.second.size());
+        entry.second.clear();
+    }
+    return true;
+}
+
+/**
+ * @brief Encodes a batch as JSON, averaging groups of 4^level readings.
+ * @param user Username.
+ * @param readings The readings.
+ * @param count Number of readings.
+ * @param level Resolution level.
+ * @return std::string The JSON text.
+ */
+std::string VitalsBroadcaster::encodeBatch(const std::string &user, const HeartRateReading *readings,
+                                           std::size_t count, int level) {
+    std::size_t group = std::size_t(1) << (2 * level);
+    std::string out;
+    out.reserve(48 + count / group * 32);
+    out += "{\"user\":";
+    appendJsonString(out, user);
+    out += ",\"resolution\":" + std::to_string(group) + ",\"readings\":[";
+    char row[96];
+    for (std::size_t first = 0; first < count; first += group) {
+        std::size_t last = std::min(count, first + group);
+        double bpm = 0.0, spo2 = 0.0;
+        std::size_t spo2Count = 0;
+        for (std::size_t i = first; i < last; ++i) {
+            bpm += readings[i].bpm;
+            if (readings[i].spo2 >= 0.0) {
+                spo2 += readings[i].spo2;
+                ++spo2Count;
+            }
+        }
+        bpm /= static_cast<double>(last - first);
+        int length;
+        if (spo2Count > 0)
+            length = std::snprintf(row, sizeof(row), "%s[%lld,%.1f,%.1f]", first ? "," : "",
+                                   readings[first].timestamp, bpm, spo2 / static_cast<double>(spo2Count));
+        else
+            length = std::snprintf(row, sizeof(row), "%s[%lld,%.1f,null]", first ? "," : "",
+                                   readings[first].timestamp, bpm);
+        out.append(row, static_cast<std::size_t>(length));
+    }
+    out += "]}";
+    return out;
+}
+
+/**
+ * @brief Counts subscribers at a resolution level.
+ * @param level Level.
+ * @return std::size_t Subscribers at that level.
+ */
+std::size_t VitalsBroadcaster::subscribersAtLevel(int level) const {
+    std::size_t total = 0;
+    for (const auto &entry : subscribers)
+        if (entry.second.level == level) ++total;
+    return total;
+}
+
+/**
+ * @brief Accepts "/vitals?user=NAME" requests.
+ * @param client Client id.
+ * @param path Request path.
+ * @param query Query string.
+ * @return bool True if the client is now subscribed.
+ */
+bool VitalsBroadcaster::subscribe(int client, const std::string &path, const std::string &query) {
+    if (path != "/vitals") return false;
+    std::string user;
+    std::size_t start = 0;
+    while (start <= query.size()) {
+        std::size_t stop = query.find('&', start);
+        if (stop == std::string::npos) stop = query.size();
+        if (query.compare(start, 5, "user=") == 0) user = decodeQueryValue(query.substr(start + 5, stop - start - 5));
+        start = stop + 1;
+    }
+    if (user.empty()) return false;
+    subscribers[client].user = user;
+    watchers[user].push_back(client);
+    return true;
+}
+
+/**
+ * @brief Forgets a departed viewer.
+ * @param client Client id.
+ */
+void VitalsBroadcaster::unsubscribe(int client) {
+    auto it = subscribers.find(client);
+    if (it == subscribers.end()) return;
+    auto watching = watchers.find(it->second.user);
+    if (watching != watchers.end()) {
+        std::vector<int> &clients = watching->second;
+        clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+        if (clients.empty()) watchers.erase(watching);
+    }
+    subscribers.erase(it);
+}
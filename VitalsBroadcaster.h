@@ -0,0 +1,145 @@
+#ifndef VITALSBROADCASTER_H
+#define VITALSBROADCASTER_H
+
+/**
+ * @file VitalsBroadcaster.h
+ * @brief Declaration of the live per-user vitals feed that caregivers watch over WebSocket.
+ *
+ * NotifyCaregiverScreen sends a caregiver a one-off email. This header declares a broadcaster that follows
+ * userdata.csv and pushes each user's new readings to every caregiver subscribed to that user, so they can
+ * watch the live chart from elsewhere on the LAN.
+ */
+
+#include "ReadingStore.h"
+#include "WebSocketServer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class VitalsBroadcaster
+ * @brief Fans out per-user reading batches to WebSocket subscribers at a resolution each can keep up with.
+ *
+ * Viewers connect to "/vitals?user=NAME" and receive one JSON text message per batch:
+ *
+ *     {"user":"alice","resolution":1,"readings":[[1760000000,72.5,98.0],[1760000001,73.0,null],...]}
+ *
+ * where each row is [timestamp, bpm, spo2] and "resolution" is how many readings each row averages.
+ *
+ * A batch is encoded once per resolution level in use and the same frame is queued for every subscriber at
+ * that level. A subscriber whose queue grows past the high-water mark drops to the next coarser level (4x
+ * fewer rows per step); once its queue has drained it steps back up one level per batch. At the coarsest
+ * level a subscriber whose queue still exceeds the backlog limit skips batches until it catches up, so a
+ * stalled viewer costs at most that limit in memory.
+ */
+class VitalsBroadcaster {
+public:
+    static const int kLevels = 3;           /**< Resolution levels: every reading, means of 4, means of 16. */
+
+    /**
+     * @brief Constructs a broadcaster and registers it with a server.
+     * @param server Server the viewers connect to; it must outlive the broadcaster.
+     * @param highWaterBytes Queue size at which a subscriber drops one resolution level.
+     * @param maxBacklogBytes Queue size beyond which a coarsest-level subscriber skips batches.
+     */
+    explicit VitalsBroadcaster(WebSocketServer &server, std::size_t highWaterBytes = 64 * 1024,
+                               std::size_t maxBacklogBytes = 256 * 1024);
+
+    /**
+     * @brief Sends a batch of one user's readings to that user's subscribers.
+     * @param user Username.
+     * @param readings The readings, oldest first.
+     * @param count Number of readings.
+     */
+    void publish(const std::string &user, const HeartRateReading *readings, std::size_t count);
+
+    /**
+     * @brief Starts following a reading CSV from its current end, so only new rows are published.
+     * @param csvPath Path of the CSV.
+     */
+    void follow(const std::string &csvPath);
+
+    /**
+     * @brief Publishes the rows appended to the followed CSV since the last call.
+     *
+     * Rows of users nobody watches are skipped before they are parsed. If the file was replaced, following
+     * restarts from its new end.
+     *
+     * @return bool False if the CSV could not be read.
+     */
+    bool catchUp();
+
+    /**
+     * @brief Encodes a batch as the JSON message described above.
+     * @param user Username.
+     * @param readings The readings.
+     * @param count Number of readings.
+     * @param level Resolution level (0 to kLevels - 1).
+     * @return std::string The JSON text.
+     */
+    static std::string encodeBatch(const std::string &user, const HeartRateReading *readings, std::size_t count,
+                                   int level);
+
+    /** @return std::size_t Subscribed viewers. */
+    std::size_t subscriberCount() const { return subscribers.size(); }
+
+    /**
+     * @brief Counts subscribers at a resolution level.
+     * @param level Level.
+     * @return std::size_t Subscribers at that level.
+     */
+    std::size_t subscribersAtLevel(int level) const;
+
+    /** @return std::uint64_t Messages encoded (at most kLevels per batch). */
+    std::uint64_t messagesEncoded() const { return encoded; }
+
+    /** @return std::uint64_t Messages queued to subscribers. */
+    std::uint64_t messagesSent() const { return sent; }
+
+    /** @return std::uint64_t Batches a subscriber skipped because it was too far behind. */
+    std::uint64_t messagesSkipped() const { return skipped; }
+
+    /** @return std::uint64_t Times a subscriber dropped to a coarser level. */
+    std::uint64_t downgrades() const { return downgraded; }
+
+private:
+    /**
+     * @brief One viewer.
+     */
+    struct Subscriber {
+        std::string user;       /**< Watched user. */
+        int level = 0;          /**< Current resolution level. */
+    };
+
+    WebSocketServer &server;                                            /**< Viewer connections. */
+    std::size_t highWater;                                              /**< Downgrade threshold. */
+    std::size_t maxBacklog;                                             /**< Skip threshold. */
+    std::unordered_map<int, Subscriber> subscribers;                    /**< Viewers by client id. */
+    std::unordered_map<std::string, std::vector<int>> watchers;         /**< Client ids by watched user. */
+    std::string csvPath;                                                /**< Followed CSV (empty: none). */
+    std::uint64_t csvOffset = 0;                                        /**< Bytes of the CSV consumed. */
+    std::unordered_map<std::string, std::vector<HeartRateReading>> pending; /**< Scratch batches by user. */
+    std::uint64_t encoded = 0;                                          /**< Messages encoded. */
+    std::uint64_t sent = 0;                                             /**< Messages queued. */
+    std::uint64_t skipped = 0;                                          /**< Batches skipped. */
+    std::uint64_t downgraded = 0;                                       /**< Level drops. */
+
+    /**
+     * @brief Accepts "/vitals?user=NAME" requests.
+     * @param client Client id.
+     * @param path Request path.
+     * @param query Query string.
+     * @return bool True if the client is now subscribed.
+     */
+    bool subscribe(int client, const std::string &path, const std::string &query);
+
+    /**
+     * @brief Forgets a departed viewer.
+     * @param client Client id.
+     */
+    void unsubscribe(int client);
+};
+
+#endif // VITALSBROADCASTER_H
@@ -0,0 +1,607 @@
+/**
+ * @file WebSocketServer.cpp
+ * @brief Implements the epoll-based WebSocket server.
+ */
+
+#include "WebSocketServer.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const std::size_t kMaxHandshakeBytes = 8 * 1024;    // Request line plus headers.
+const std::size_t kMaxClientFrame = 64 * 1024;      // Clients only send control frames and small notes.
+const std::size_t kReadChunk = 16 * 1024;
+const int kMaxEvents = 64;
+const int kMaxGather = 16;                          // Frames handed to one writev().
+const long long kHandshakeTimeoutMs = 10 * 1000;    // Connections not upgraded by then are closed.
+const long long kIdleTimeoutMs = 60 * 1000;         // Connections silent this long are closed.
+const int kSweepIntervalMs = 1000;                  // How often idle connections are looked for.
+
+/**
+ * @brief Gets the steady clock in milliseconds.
+ * @return long long Milliseconds.
+ */
+long long steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Computes the SHA-1 digest of a short message (as needed for Sec-WebSocket-Accept).
+ * @param message Message.
+ * @param digest Receives the 20-byte digest.
+ */
+void sha1(const std::string &message, unsigned char digest[20]) {
+    std::uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string data = message;
+    std::uint64_t bits = static_cast<std::uint64_t>(message.size()) * 8;
+    data += static_cast<char>(0x80);
+    while (data.size() % 64 != 56) data += '\0';
+    for (int i = 7; i >= 0; --i) data += static_cast<char>((bits >> (8 * i)) & 0xFF);
+
+    auto rotl = [](std::uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+    for (std::size_t chunk = 0; chunk < data.size(); chunk += 64) {
+        std::uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char *p = reinterpret_cast<const unsigned char *>(data.data()) + chunk + 4 * i;
+            w[i] = static_cast<std::uint32_t>(p[0]) << 24 | static_cast<std::uint32_t>(p[1]) << 16 |
+                   static_cast<std::uint32_t>(p[2]) << 8 | p[3];
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            std::uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            std::uint32_t next = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = next;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 5; ++i)
+        for (int j = 0; j < 4; ++j) digest[4 * i + j] = static_cast<unsigned char>(h[i] >> (24 - 8 * j));
+}
+
+/**
+ * @brief Encodes bytes as base64.
+ * @param bytes Bytes.
+ * @param size Number of bytes.
+ * @return std::string The encoding.
+ */
+std::string base64(const unsigned char *bytes, std::size_t size) {
+    static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (std::size_t i = 0; i < size; i += 3) {
+        std::uint32_t group = static_cast<std::uint32_t>(bytes[i]) << 16;
+        if (i + 1 < size) group |= static_cast<std::uint32_t>(bytes[i + 1]) << 8;
+        if (i + 2 < size) group |= bytes[i + 2];
+        out += alphabet[(group >> 18) & 0x3F];
+        out += alphabet[(group >> 12) & 0x3F];
+        out += i + 1 < size ? alphabet[(group >> 6) & 0x3F] : '=';
+        out += i + 2 < size ? alphabet[group & 0x3F] : '=';
+    }
+    return out;
+}
+
+/**
+ * @brief Encodes an unmasked server frame.
+ * @param opcode Frame opcode.
+ * @param payload Payload bytes.
+ * @param size Payload length.
+ * @return std::string The frame.
+ */
+std::string encodeFrame(unsigned char opcode, const char *payload, std::size_t size) {
+    std::string frame;
+    frame.reserve(size + 10);
+    frame += static_cast<char>(0x80 | opcode);
+    if (size < 126) {
+        frame += static_cast<char>(size);
+    } else if (size <= 0xFFFF) {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>(size >> 8);
+        frame += static_cast<char>(size & 0xFF);
+    } else {
+        frame += static_cast<char>(127);
+        for (int i = 7; i >= 0; --i) frame += static_cast<char>((static_cast<std::uint64_t>(size) >> (8 * i)) & 0xFF);
+    }
+    frame.append(payload, size);
+    return frame;
+}
+
+/**
+ * @brief Finds a header value in a request, ignoring the name's ASCII case.
+ * @param headers Header block (after the request line, CRLF-separated).
+ * @param lowerName Lowercase header name.
+ * @return std::string Trimmed value, or empty if absent.
+ */
+std::string headerValue(const std::string &headers, const char *lowerName) {
+    std::size_t nameLength = std::strlen(lowerName);
+    std::size_t line = 0;
+    while (line < headers.size()) {
+        std::size_t end = headers.find("\r\n", line);
+        if (end == std::string::npos) end = headers.size();
+        std::size_t colon = headers.find(':', line);
+        if (colon != std::string::npos && colon < end && colon - line == nameLength) {
+            bool same = true;
+            for (std::size_t i = 0; i < nameLength && same; ++i) {
+                char c = headers[line + i];
+                if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+                same = c == lowerName[i];
+            }
+            if (same) {
+                std::size_t a = colon + 1, b = end;
+                while (a < b && (headers[a] == ' ' || headers[a] == '\t')) ++a;
+                while (b > a && (headers[b - 1] == ' ' || headers[b - 1] == '\t')) --b;
+                return headers.substr(a, b - a);
+            }
+        }
+        line = end + 2;
+    }
+    return std::string();
+}
+
+/**
+ * @brief Checks whether a comma-separated header value contains a token, ignoring ASCII case.
+ * @param value Header value.
+ * @param lowerToken Lowercase token.
+ * @return bool True if present.
+ */
+bool hasToken(const std::string &value, const char *lowerToken) {
+    std::string lower = value;
+    for (char &c : lower)
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    std::size_t length = std::strlen(lowerToken);
+    std::size_t start = 0;
+    while (start <= lower.size()) {
+        std::size_t stop = lower.find(',', start);
+        if (stop == std::string::npos) stop = lower.size();
+        std::size_t a = start, b = stop;
+        while (a < b && (lower[a] == ' ' || lower[a] == '\t')) ++a;
+        while (b > a && (lower[b - 1] == ' ' || lower[b - 1] == '\t')) --b;
+        if (b - a == length && lower.compare(a, length, lowerToken) == 0) return true;
+        start = stop + 1;
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a server that is not listening yet.
+ * @param sendBufferBytes Kernel send buffer per client.
+ */
+WebSocketServer::WebSocketServer(std::size_t sendBufferBytes) : sendBuffer(sendBufferBytes) {}
+
+WebSocketServer::~WebSocketServer() {
+    for (auto &entry : connections) ::close(entry.first);
+    if (listenFd >= 0) ::close(listenFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+/**
+ * @brief Starts listening.
+ * @param address IPv4 address to bind.
+ * @param port TCP port (0 picks a free one).
+ * @return bool False if the socket could not be bound.
+ */
+bool WebSocketServer::listen(const std::string &address, std::uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        ErrorHandling::logErrorMessage("WebSocket server: invalid address " + address);
+        return false;
+    }
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int yes = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        ErrorHandling::logErrorMessage("WebSocket server: cannot listen on " + address + ":" + std::to_string(port) +
+                                       ": " + std::strerror(errno));
+        if (listenFd >= 0) ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr *>(&addr), &length);
+    boundPort = ntohs(addr.sin_port);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    return true;
+}
+
+/**
+ * @brief Waits for and handles socket events once.
+ * @param timeoutMs Longest wait in milliseconds.
+ * @return bool False if the server is not listening or the wait failed.
+ */
+bool WebSocketServer::poll(int timeoutMs) {
+    if (epollFd < 0) return false;
+    // With clients connected the wait is cut short now and then to close the idle ones.
+    if (!connections.empty() && (timeoutMs < 0 || timeoutMs > kSweepIntervalMs)) timeoutMs = kSweepIntervalMs;
+    epoll_event events[kMaxEvents];
+    int ready = epoll_wait(epollFd, events, kMaxEvents, timeoutMs);
+    if (ready < 0) return errno == EINTR;
+    for (int i = 0; i < ready; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == listenFd) {
+            acceptClients();
+            continue;
+        }
+        if (fd == wakeFd) {
+            std::uint64_t value = 0;
+            while (::read(wakeFd, &value, sizeof(value)) > 0) {}
+            continue;
+        }
+        auto it = connections.find(fd);
+        if (it == connections.end()) continue;
+        bool keep = true;
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) keep = readClient(fd, it->second);
+        if (keep && (events[i].events & EPOLLOUT)) keep = flush(fd, it->second);
+        if (!keep) closeClient(fd);
+    }
+    long long now = steadyMs();
+    if (now - lastSweep >= kSweepIntervalMs) {
+        lastSweep = now;
+        closeIdle(now);
+    }
+    return true;
+}
+
+/**
+ * @brief Handles events until stop() is called.
+ */
+void WebSocketServer::run() {
+    while (!stopping.load(std::memory_order_relaxed))
+        if (!poll(-1)) break;
+    stopping.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Makes run() return.
+ */
+void WebSocketServer::stop() {
+    stopping.store(true, std::memory_order_relaxed);
+    if (wakeFd >= 0) {
+        std::uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+/**
+ * @brief Encodes a text message into an unmasked server frame.
+ * @param payload UTF-8 text.
+ * @return Message The frame.
+ */
+WebSocketServer::Message WebSocketServer::textMessage(const std::string &payload) {
+    return std::make_shared<const std::string>(encodeFrame(0x1, payload.data(), payload.size()));
+}
+
+/**
+ * @brief Queues a message for a client and sends as much as the socket takes.
+ *
+ * A send failure only shuts the socket down; the connection is closed, and the close handler called, from
+ * the event loop, so callers may send while iterating over their own client lists.
+ *
+ * @param client Client id.
+ * @param message The frame.
+ * @return bool False if the client is not an open WebSocket client.
+ */
+bool WebSocketServer::send(int client, const Message &message) {
+    auto it = connections.find(client);
+    if (it == connections.end() || !it->second.upgraded || it->second.closing) return false;
+    Connection &connection = it->second;
+    connection.queue.push_back(message);
+    connection.queued += message->size();
+    if (!flush(client, connection)) ::shutdown(client, SHUT_RDWR);
+    return true;
+}
+
+/**
+ * @brief Gets the bytes queued for a client.
+ * @param client Client id.
+ * @return std::size_t Queued bytes.
+ */
+std::size_t WebSocketServer::backlog(int client) const {
+    auto it = connections.find(client);
+    return it == connections.end() ? 0 : it->second.queued;
+}
+
+/**
+ * @brief Sends a close frame to a client and closes it once the frame is out.
+ * @param client Client id.
+ */
+void WebSocketServer::close(int client) {
+    auto it = connections.find(client);
+    if (it == connections.end() || it->second.closing) return;
+    static const char normal[2] = {0x03, static_cast<char>(0xE8)};  // 1000: normal closure
+    queueBytes(it->second, encodeFrame(0x8, normal, 2));
+    it->second.closing = true;
+    if (!flush(client, it->second)) ::shutdown(client, SHUT_RDWR);
+}
+
+/**
+ * @brief Accepts every pending connection.
+ */
+void WebSocketServer::acceptClients() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                ErrorHandling::logErrorMessage(std::string("WebSocket server: accept failed: ") +
+                                               std::strerror(errno));
+            return;
+        }
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        int buffer = static_cast<int>(sendBuffer);
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        Connection &connection = connections[fd];
+        connection.opened = connection.lastActive = steadyMs();
+    }
+}
+
+/**
+ * @brief Reads what a connection has sent and handles it.
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ * @return bool False if the connection should be closed now.
+ */
+bool WebSocketServer::readClient(int fd, Connection &connection) {
+    char chunk[kReadChunk];
+    while (true) {
+        ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (got == 0) return false;
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            break;
+        }
+        connection.lastActive = steadyMs();
+        // After a close frame the rest of the stream is drained and dropped.
+        if (!connection.closing) connection.input.append(chunk, static_cast<std::size_t>(got));
+        if (connection.input.size() > kMaxHandshakeBytes + kMaxClientFrame) return false;
+    }
+    if (!connection.upgraded) {
+        if (!handshake(fd, connection)) return connection.input.size() <= kMaxHandshakeBytes;
+        if (!connection.upgraded) return flush(fd, connection);
+    }
+    if (!handleFrames(connection)) return false;
+    return flush(fd, connection);
+}
+
+/**
+ * @brief Closes connections still in the handshake past its deadline and ones idle for too long.
+ *
+ * A client that stops taking its frames counts as idle once nothing has been sent for the idle timeout,
+ * so a stalled viewer does not hold its backlog forever.
+ *
+ * @param now Steady-clock milliseconds.
+ */
+void WebSocketServer::closeIdle(long long now) {
+    std::vector<int> idle;
+    for (const auto &entry : connections) {
+        const Connection &connection = entry.second;
+        if ((!connection.upgraded && now - connection.opened > kHandshakeTimeoutMs) ||
+            now - connection.lastActive > kIdleTimeoutMs)
+            idle.push_back(entry.first);
+    }
+    for (int fd : idle) closeClient(fd);
+}
+
+/**
+ * @brief Handles a complete handshake request at the front of the input.
+ *
+ * Anything but a well-formed version 13 upgrade gets 400; a request the open handler refuses gets 404. In
+ * both cases the connection is closed after the response.
+ *
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ * @return bool False if the request is incomplete.
+ */
+bool WebSocketServer::handshake(int fd, Connection &connection) {
+    std::size_t end = connection.input.find("\r\n\r\n");
+    if (end == std::string::npos) return false;
+    std::string request = connection.input.substr(0, end + 2);
+    connection.input.erase(0, end + 4);
+
+    std::size_t lineEnd = request.find("\r\n");
+    std::string line = request.substr(0, lineEnd);
+    std::string headers = request.substr(lineEnd + 2);
+    std::size_t space1 = line.find(' ');
+    std::size_t space2 = space1 == std::string::npos ? std::string::npos : line.find(' ', space1 + 1);
+    std::string key = headerValue(headers, "sec-websocket-key");
+    bool valid = space1 != std::string::npos && space2 != std::string::npos && line.compare(0, space1, "GET") == 0 &&
+                 hasToken(headerValue(headers, "upgrade"), "websocket") &&
+                 hasToken(headerValue(headers, "connection"), "upgrade") &&
+                 headerValue(headers, "sec-websocket-version") == "13" && !key.empty();
+    if (!valid) {
+        queueBytes(connection, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        connection.closing = true;
+        return true;
+    }
+    std::string target = line.substr(space1 + 1, space2 - space1 - 1);
+    std::size_t question = target.find('?');
+    std::string path = target.substr(0, question);
+    std::string query = question == std::string::npos ? std::string() : target.substr(question + 1);
+    if (!openHandler || !openHandler(fd, path, query)) {
+        queueBytes(connection, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        connection.closing = true;
+        return true;
+    }
+
+    unsigned char digest[20];
+    sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+    queueBytes(connection, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                           "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n");
+    connection.upgraded = true;
+    return true;
+}
+
+/**
+ * @brief Handles the complete client frames at the front of the input.
+ *
+ * Pings are answered with pongs and a close frame is echoed; data frames are ignored.
+ *
+ * @param connection Connection state.
+ * @return bool False on a protocol violation.
+ */
+bool WebSocketServer::handleFrames(Connection &connection) {
+    std::string &input = connection.input;
+    std::size_t at = 0;
+    while (!connection.closing && input.size() - at >= 2) {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(input.data()) + at;
+        unsigned char opcode = p[0] & 0x0F;
+        bool masked = (p[1] & 0x80) != 0;
+        std::uint64_t length = p[1] & 0x7F;
+        std::size_t header = 2;
+        if (length == 126) {
+            if (input.size() - at < 4) break;
+            length = static_cast<std::uint64_t>(p[2]) << 8 | p[3];
+            header = 4;
+        } else if (length == 127) {
+            if (input.size() - at < 10) break;
+            length = 0;
+            for (int i = 0; i < 8; ++i) length = length << 8 | p[2 + i];
+            header = 10;
+        }
+        // Clients must mask every frame (RFC 6455 section 5.1).
+        if (!masked || length > kMaxClientFrame) return false;
+        if (input.size() - at < header + 4 + length) break;
+        const unsigned char *mask = p + header;
+        std::string payload(reinterpret_cast<const char *>(mask + 4), static_cast<std::size_t>(length));
+        for (std::size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+        at += header + 4 + static_cast<std::size_t>(length);
+
+        if (opcode == 0x8) {
+            queueBytes(connection, encodeFrame(0x8, payload.data(), std::min<std::size_t>(payload.size(), 2)));
+            connection.closing = true;
+        } else if (opcode == 0x9) {
+            if (payload.size() > 125) return false;
+            queueBytes(connection, encodeFrame(0xA, payload.data(), payload.size()));
+        }
+    }
+    input.erase(0, at);
+    return true;
+}
+
+/**
+ * @brief Queues raw bytes on a connection.
+ * @param connection Connection state.
+ * @param bytes The bytes.
+ */
+void WebSocketServer::queueBytes(Connection &connection, const std::string &bytes) {
+    connection.queue.push_back(std::make_shared<const std::string>(bytes));
+    connection.queued += bytes.size();
+}
+
+/**
+ * @brief Sends as much queued output as the socket takes, several frames per writev().
+ * @param fd Client descriptor.
+ * @param connection Its state.
+ * @return bool False if the connection should be closed now.
+ */
+bool WebSocketServer::flush(int fd, Connection &connection) {
+    while (!connection.queue.empty()) {
+        iovec parts[kMaxGather];
+        int count = 0;
+        for (auto it = connection.queue.begin(); it != connection.queue.end() && count < kMaxGather; ++it, ++count) {
+            std::size_t skip = count == 0 ? connection.frontSent : 0;
+            parts[count].iov_base = const_cast<char *>((*it)->data()) + skip;
+            parts[count].iov_len = (*it)->size() - skip;
+        }
+        ssize_t sent = ::writev(fd, parts, count);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            break;
+        }
+        std::size_t left = static_cast<std::size_t>(sent);
+        connection.queued -= left;
+        if (left > 0) connection.lastActive = steadyMs();
+        while (left > 0) {
+            std::size_t remaining = connection.queue.front()->size() - connection.frontSent;
+            if (left < remaining) {
+                connection.frontSent += left;
+                break;
+            }
+            left -= remaining;
+            connection.queue.pop_front();
+            connection.frontSent = 0;
+        }
+    }
+    if (connection.queue.empty() && connection.closing) return false;
+
+    bool wantWrite = !connection.queue.empty();
+    if (wantWrite != connection.writing) {
+        epoll_event event{};
+        event.events = EPOLLIN | (wantWrite ? EPOLLOUT : 0u);
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+        connection.writing = wantWrite;
+    }
+    return true;
+}
+
+/**
+ * @brief Closes a connection.
+ * @param fd Client descriptor.
+ */
+void WebSocketServer::closeClient(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) return;
+    bool upgraded = it->second.upgraded;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(it);
+    if (upgraded && closeHandler) closeHandler(fd);
+}
@@ -0,0 +1,221 @@
+#ifndef WEBSOCKETSERVER_H
+#define WEBSOCKETSERVER_H
+
+/**
+ * @file WebSocketServer.h
+ * @brief Declaration of the small embedded WebSocket server used to push live data to viewers.
+ *
+ * This header declares a single-threaded, non-blocking WebSocket (RFC 6455) server built on an epoll loop.
+ * It performs the HTTP upgrade handshake, answers pings and close frames, and sends server-to-client
+ * messages. Messages are encoded into complete frames once and queued by reference, so the same bytes can
+ * go to any number of clients.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class WebSocketServer
+ * @brief Non-blocking WebSocket server with shared, pre-encoded outgoing messages.
+ *
+ * Clients connect with a GET request for any path; the open handler sees the path and query string and
+ * decides whether to accept. Incoming data messages are ignored: the server only pushes. Each client has a
+ * queue of shared messages that is written with writev(); backlog() reports how many bytes are queued so
+ * the caller can slow down or thin out what it sends to a client that is not keeping up.
+ *
+ * The kernel send buffer of each client is capped at construction, so the queue, not the kernel, is where
+ * a slow client's backlog shows up.
+ *
+ * A connection that has not completed the handshake within 10 seconds, or that has neither sent nor taken
+ * a byte for 60 seconds, is closed; poll() looks for them about once a second while clients are connected.
+ */
+class WebSocketServer {
+public:
+    /**
+     * @brief A complete encoded frame, shared by every client it is sent to.
+     */
+    using Message = std::shared_ptr<const std::string>;
+
+    /**
+     * @brief Decides whether to accept a client; called after a valid handshake request.
+     * Arguments: client id, request path, query string (without '?').
+     */
+    using OpenHandler = std::function<bool(int, const std::string &, const std::string &)>;
+
+    /**
+     * @brief Called when an accepted client goes away. Argument: client id.
+     */
+    using CloseHandler = std::function<void(int)>;
+
+    /**
+     * @brief Constructs a server that is not listening yet.
+     * @param sendBufferBytes Kernel send buffer per client (SO_SNDBUF).
+     */
+    explicit WebSocketServer(std::size_t sendBufferBytes = 32 * 1024);
+
+    ~WebSocketServer();
+
+    WebSocketServer(const WebSocketServer &) = delete;
+    WebSocketServer &operator=(const WebSocketServer &) = delete;
+
+    /**
+     * @brief Starts listening.
+     * @param address IPv4 address to bind ("127.0.0.1" for local only, "0.0.0.0" for the LAN).
+     * @param port TCP port (0 picks a free one, see port()).
+     * @return bool False if the socket could not be bound.
+     */
+    bool listen(const std::string &address, std::uint16_t port);
+
+    /** @return std::uint16_t The bound port (0 before listen()). */
+    std::uint16_t port() const { return boundPort; }
+
+    /**
+     * @brief Sets the handler that accepts or refuses new clients (all are refused without one).
+     * @param handler The handler.
+     */
+    void onOpen(OpenHandler handler) { openHandler = std::move(handler); }
+
+    /**
+     * @brief Sets the handler told about accepted clients that disconnect.
+     * @param handler The handler.
+     */
+    void onClose(CloseHandler handler) { closeHandler = std::move(handler); }
+
+    /**
+     * @brief Waits for and handles socket events once.
+     * @param timeoutMs Longest wait in milliseconds (-1: until something happens).
+     * @return bool False if the server is not listening or the wait failed.
+     */
+    bool poll(int timeoutMs);
+
+    /**
+     * @brief Handles events until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return. Safe to call from any thread or a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Encodes a text message into an unmasked server frame.
+     * @param payload UTF-8 text.
+     * @return Message The frame, ready to send to any number of clients.
+     */
+    static Message textMessage(const std::string &payload);
+
+    /**
+     * @brief Queues a message for a client and sends as much as the socket takes.
+     * @param client Client id.
+     * @param message The frame.
+     * @return bool False if the client is not an open WebSocket client.
+     */
+    bool send(int client, const Message &message);
+
+    /**
+     * @brief Gets the bytes queued for a client and not yet taken by its socket.
+     * @param client Client id.
+     * @return std::size_t Queued bytes (0 for unknown clients).
+     */
+    std::size_t backlog(int client) const;
+
+    /**
+     * @brief Sends a close frame to a client and closes it once the frame is out.
+     * @param client Client id.
+     */
+    void close(int client);
+
+    /** @return std::size_t Connections open, including ones still in the handshake. */
+    std::size_t connectionCount() const { return connections.size(); }
+
+private:
+    /**
+     * @brief Per-connection state.
+     */
+    struct Connection {
+        std::string input;                  /**< Received bytes not yet handled. */
+        std::deque<Message> queue;          /**< Frames waiting to be sent, oldest first. */
+        std::size_t frontSent = 0;          /**< Bytes of the front frame already sent. */
+        std::size_t queued = 0;             /**< Unsent bytes in the queue. */
+        bool upgraded = false;              /**< Handshake completed. */
+        bool closing = false;               /**< Close once the queue is flushed. */
+        bool writing = false;               /**< Registered for EPOLLOUT. */
+        long long opened = 0;               /**< Steady-clock milliseconds of the accept. */
+        long long lastActive = 0;           /**< Steady-clock milliseconds of the last byte received or sent. */
+    };
+
+    std::size_t sendBuffer;                                 /**< SO_SNDBUF per client. */
+    int listenFd = -1;                                      /**< Listening socket. */
+    int epollFd = -1;                                       /**< epoll instance. */
+    int wakeFd = -1;                                        /**< eventfd that interrupts the wait in stop(). */
+    std::uint16_t boundPort = 0;                            /**< Bound port. */
+    std::atomic<bool> stopping{false};                      /**< Set by stop(). */
+    long long lastSweep = 0;                                /**< When idle connections were last looked for. */
+    std::unordered_map<int, Connection> connections;        /**< Open connections by descriptor. */
+    OpenHandler openHandler;                                /**< Accepts or refuses clients. */
+    CloseHandler closeHandler;                              /**< Told about departures. */
+
+    /**
+     * @brief Accepts every pending connection.
+     */
+    void acceptClients();
+
+    /**
+     * @brief Reads what a connection has sent and handles it.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     * @return bool False if the connection should be closed now.
+     */
+    bool readClient(int fd, Connection &connection);
+
+    /**
+     * @brief Closes connections still in the handshake past its deadline and ones idle for too long.
+     * @param now Steady-clock milliseconds.
+     */
+    void closeIdle(long long now);
+
+    /**
+     * @brief Handles a complete handshake request at the front of the input.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     * @return bool False if the request is incomplete.
+     */
+    bool handshake(int fd, Connection &connection);
+
+    /**
+     * @brief Handles the complete client frames at the front of the input.
+     * @param connection Connection state.
+     * @return bool False on a protocol violation.
+     */
+    bool handleFrames(Connection &connection);
+
+    /**
+     * @brief Queues raw bytes (a handshake response or control frame) on a connection.
+     * @param connection Connection state.
+     * @param bytes The bytes.
+     */
+    void queueBytes(Connection &connection, const std::string &bytes);
+
+    /**
+     * @brief Sends as much queued output as the socket takes.
+     * @param fd Client descriptor.
+     * @param connection Its state.
+     * @return bool False if the connection should be closed now.
+     */
+    bool flush(int fd, Connection &connection);
+
+    /**
+     * @brief Closes a connection, telling the close handler if it was an accepted client.
+     * @param fd Client descriptor.
+     */
+    void closeClient(int fd);
+};
+
+#endif // WEBSOCKETSERVER_H
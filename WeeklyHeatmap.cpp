@@ -0,0 +1,108 @@
+/**
+ * @file WeeklyHeatmap.cpp
+ * @brief Implements the incrementally maintained hour-of-day by day-of-week heatmap.
+ */
+
+#include "WeeklyHeatmap.h"
+#include <algorithm>
+
+/**
+ * @brief Constructs an empty heatmap.
+ * @param utcOffsetSeconds Offset added to UTC bucket starts to get local time (whole hours).
+ */
+WeeklyHeatmap::WeeklyHeatmap(long long utcOffsetSeconds) : utcOffset(utcOffsetSeconds) {
+    reset();
+}
+
+/**
+ * @brief Removes every folded bucket.
+ */
+void WeeklyHeatmap::reset() {
+    std::fill(counts, counts + kDays * kHours, 0LL);
+    std::fill(sums, sums + kDays * kHours, 0.0);
+    foldedReadings = 0;
+    foldedThrough = 0;
+    folded = false;
+    openBucket = RollupBucket();
+}
+
+/**
+ * @brief Maps an hour bucket to its cell.
+ * @param start Bucket start (seconds since epoch, UTC).
+ * @return int Cell index (day * kHours + hour).
+ */
+int WeeklyHeatmap::cellOf(long long start) const {
+    long long hours = HeartRateRollup::bucketStart(start + utcOffset, HeartRateRollup::Hour) / 3600;
+    long long days = hours >= 0 ? hours / kHours : (hours - kHours + 1) / kHours;
+    int hour = static_cast<int>(hours - days * kHours);
+    // 1970-01-01 was a Thursday, three days after a Monday.
+    int day = static_cast<int>(((days + 3) % kDays + kDays) % kDays);
+    return day * kHours + hour;
+}
+
+/**
+ * @brief Folds in the hour buckets added since the previous update.
+ * @param rollup The user's rollup tiers.
+ */
+void WeeklyHeatmap::update(const HeartRateRollup &rollup) {
+    const std::vector<RollupBucket> &hours = rollup.buckets(HeartRateRollup::Hour);
+    if (hours.empty()) {
+        reset();
+        return;
+    }
+
+    // Everything folded so far plus the new buckets must add up to the rollup's total; otherwise an
+    // already-folded hour changed and the grid is rebuilt.
+    auto next = hours.begin();
+    if (folded) {
+        next = std::upper_bound(hours.begin(), hours.end(), foldedThrough,
+                                [](long long start, const RollupBucket &bucket) { return start < bucket.start; });
+        long long expected = foldedReadings;
+        for (auto it = next; it != hours.end(); ++it) expected += it->count;
+        if (next == hours.end() || expected != rollup.getReadingCount()) {
+            reset();
+            next = hours.begin();
+        }
+    }
+
+    auto last = hours.end() - 1;
+    for (; next != last; ++next) {
+        int cell = cellOf(next->start);
+        counts[cell] += next->count;
+        sums[cell] += next->sum;
+        foldedReadings += next->count;
+        foldedThrough = next->start;
+        folded = true;
+    }
+    openBucket = *last;
+}
+
+/**
+ * @brief Gets the number of readings in a cell.
+ * @param day Day of week (0 = Monday).
+ * @param hour Hour of day (0-23).
+ * @return long long Reading count.
+ */
+long long WeeklyHeatmap::count(int day, int hour) const {
+    int cell = day * kHours + hour;
+    long long total = counts[cell];
+    if (openBucket.count > 0 && cellOf(openBucket.start) == cell) total += openBucket.count;
+    return total;
+}
+
+/**
+ * @brief Gets the mean BPM of a cell.
+ * @param day Day of week (0 = Monday).
+ * @param hour Hour of day (0-23).
+ * @return double Mean BPM, or -1 if the cell has no readings.
+ */
+double WeeklyHeatmap::mean(int day, int hour) const {
+    int cell = day * kHours + hour;
+    long long total = counts[cell];
+    double sum = sums[cell];
+    if (openBucket.count > 0 && cellOf(openBucket.start) == cell) {
+        total += openBucket.count;
+        sum += openBucket.sum;
+    }
+    return total > 0 ? sum / total : -1.0;
+}
@@ -0,0 +1,84 @@
+#ifndef WEEKLYHEATMAP_H
+#define WEEKLYHEATMAP_H
+
+/**
+ * @file WeeklyHeatmap.h
+ * @brief Declaration of the hour-of-day by day-of-week heart-rate heatmap.
+ *
+ * This header declares a 7 x 24 grid of mean BPM built from a user's 1-hour rollup tier. The grid is kept
+ * between updates, so refreshing it only folds in the hour buckets added since the previous update.
+ */
+
+#include "HeartRateRollup.h"
+
+/**
+ * @class WeeklyHeatmap
+ * @brief Mean heart rate per (day of week, hour of day) cell, maintained incrementally from the hour tier.
+ *
+ * Completed hour buckets are folded into the cells once; the newest bucket may still be filling up, so it
+ * is held aside and re-read on every update. If the rollup's reading count no longer matches what has been
+ * folded (a late reading landed in an earlier hour, or the rollup was rebuilt), the grid is recomputed in
+ * one pass over the hour tier.
+ */
+class WeeklyHeatmap {
+public:
+    static const int kDays = 7;     /**< Rows, Monday first. */
+    static const int kHours = 24;   /**< Columns, midnight first. */
+
+    /**
+     * @brief Constructs an empty heatmap.
+     * @param utcOffsetSeconds Offset added to UTC bucket starts to get local time (whole hours).
+     */
+    explicit WeeklyHeatmap(long long utcOffsetSeconds = 0);
+
+    /**
+     * @brief Folds in the hour buckets added since the previous update.
+     * @param rollup The user's rollup tiers.
+     */
+    void update(const HeartRateRollup &rollup);
+
+    /**
+     * @brief Gets the mean BPM of a cell.
+     * @param day Day of week (0 = Monday).
+     * @param hour Hour of day (0-23).
+     * @return double Mean BPM, or -1 if the cell has no readings.
+     */
+    double mean(int day, int hour) const;
+
+    /**
+     * @brief Gets the number of readings in a cell.
+     * @param day Day of week (0 = Monday).
+     * @param hour Hour of day (0-23).
+     * @return long long Reading count.
+     */
+    long long count(int day, int hour) const;
+
+    /** @return bool True if no cell has any readings. */
+    bool empty() const { return openBucket.count == 0 && foldedReadings == 0; }
+
+    /** @return long long Offset from UTC the cells are laid out in. */
+    long long getUtcOffset() const { return utcOffset; }
+
+private:
+    long long utcOffset;                        /**< Seconds added to UTC to get local time. */
+    long long counts[kDays * kHours];           /**< Readings per cell from completed buckets. */
+    double sums[kDays * kHours];                /**< BPM sum per cell from completed buckets. */
+    long long foldedReadings = 0;               /**< Readings folded into the cells. */
+    long long foldedThrough = 0;                /**< Start of the newest folded bucket. */
+    bool folded = false;                        /**< True once any bucket has been folded. */
+    RollupBucket openBucket;                    /**< Newest bucket, not folded yet (count 0 if none). */
+
+    /**
+     * @brief Maps an hour bucket to its cell.
+     * @param start Bucket start (seconds since epoch, UTC).
+     * @return int Cell index (day * kHours + hour).
+     */
+    int cellOf(long long start) const;
+
+    /**
+     * @brief Removes every folded bucket.
+     */
+    void reset();
+};
+
+#endif // WEEKLYHEATMAP_H
@@ -0,0 +1,18 @@
+QT       -= gui core
+
+TARGET = accountimport
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../AccountImport.cpp \
+           ../../ErrorHandling.cpp \
+           ../../FileLock.cpp
+
+HEADERS += ../../AccountImport.h \
+           ../../ErrorHandling.h \
+           ../../FileLock.h
@@ -0,0 +1,111 @@
+/**
+ * @file main.cpp
+ * @brief Registers a list of accounts in userdata.csv in one batch.
+ *
+ * Usage: accountimport [--csv userdata.csv] [--dry-run] [--show N] ACCOUNTS.csv
+ *        accountimport [--csv userdata.csv] [--dry-run] [--readings M] --synthetic N
+ *
+ * ACCOUNTS.csv holds "username,password" lines (a "Username,Password" header is skipped). Accounts whose
+ * password breaks the registration rules or whose name is already taken, ignoring case, are reported and
+ * skipped; the rest are appended together. --synthetic generates N accounts to measure throughput; with
+ * --readings it first creates the CSV, which must not exist yet, holding M readings of 1000 users, so the
+ * measurement includes the scan of a realistic userdata.csv.
+ */
+
+#include "AccountImport.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string accountsPath;
+    std::size_t synthetic = 0;
+    std::size_t readings = 0;
+    std::size_t show = 20;
+    bool dryRun = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dry-run") {
+            dryRun = true;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0) {
+            accountsPath = arg;
+            continue;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--synthetic") synthetic = std::strtoull(value, nullptr, 10);
+        else if (arg == "--readings") readings = std::strtoull(value, nullptr, 10);
+        else if (arg == "--show") show = std::strtoull(value, nullptr, 10);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (accountsPath.empty() == (synthetic == 0)) {
+        std::fprintf(stderr, "Usage: %s [--csv FILE] [--dry-run] [--show N] ACCOUNTS.csv\n"
+                             "       %s [--csv FILE] [--dry-run] [--readings M] --synthetic N\n", argv[0], argv[0]);
+        return 1;
+    }
+    if (readings > 0) {
+        if (synthetic == 0 || std::filesystem::exists(csvPath)) {
+            std::fprintf(stderr, "--readings needs --synthetic and a --csv file that does not exist yet\n");
+            return 1;
+        }
+        std::ofstream seed(csvPath, std::ios::binary);
+        seed << "Username,Password\n";
+        for (std::size_t i = 0; i < readings; ++i)
+            seed << "user" << i % 1000 << "," << 1760000000 + i << "," << 60 + i % 60 << "\n";
+        if (!seed.flush()) {
+            std::fprintf(stderr, "Cannot write %s\n", csvPath.c_str());
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<AccountRecord> accounts;
+    if (synthetic > 0) {
+        accounts.resize(synthetic);
+        for (std::size_t i = 0; i < synthetic; ++i) {
+            accounts[i].username = "patient" + std::to_string(i);
+            accounts[i].password = "pw" + std::to_string(i * 7919 % 100000) + "x";
+        }
+    } else if (!AccountImport::parseAccounts(accountsPath, accounts)) {
+        std::fprintf(stderr, "Cannot read %s\n", accountsPath.c_str());
+        return 1;
+    }
+
+    AccountImport importer(csvPath);
+    if (!importer.loadExisting()) {
+        std::fprintf(stderr, "Cannot read %s\n", csvPath.c_str());
+        return 1;
+    }
+    AccountImportReport report = importer.import(accounts, dryRun);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!report.written) {
+        std::fprintf(stderr, "Failed to append to %s; nothing was imported\n", csvPath.c_str());
+        return 1;
+    }
+
+    for (std::size_t i = 0; i < report.rejected.size() && i < show; ++i) {
+        const AccountRejection &rejection = report.rejected[i];
+        std::printf("  line %zu  %s: %s\n", rejection.index + 1, rejection.username.c_str(), rejection.reason.c_str());
+    }
+    if (report.rejected.size() > show) std::printf("  ... %zu more\n", report.rejected.size() - show);
+    std::printf("%s %zu of %zu accounts (%zu rejected) in %.3f s, %.0f accounts/s\n",
+                dryRun ? "Would import" : "Imported", report.imported, accounts.size(), report.rejected.size(),
+                seconds, seconds > 0.0 ? static_cast<double>(accounts.size()) / seconds : 0.0);
+    return report.rejected.empty() ? 0 : 2;
+}
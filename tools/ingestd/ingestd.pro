@@ -0,0 +1,42 @@
+QT       -= gui core
+
+TARGET = ingestd
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../HttpServer.cpp \
+           ../../ReadingIngest.cpp \
+           ../../ReadingBatchParser.cpp \
+           ../../ReadingStore.cpp \
+           ../../AnomalyDetector.cpp \
+           ../../MetricsRegistry.cpp \
+           ../../ReadingColumns.cpp \
+           ../../HeartRateRollup.cpp \
+           ../../BpmHistogram.cpp \
+           ../../HoltWinters.cpp \
+           ../../PopulationStats.cpp \
+           ../../QuantileSketch.cpp \
+           ../../ErrorHandling.cpp \
+           ../../FileLock.cpp
+
+HEADERS += ../../HttpServer.h \
+           ../../ReadingIngest.h \
+           ../../ReadingBatchParser.h \
+           ../../ReadingStore.h \
+           ../../AnomalyDetector.h \
+           ../../MetricsRegistry.h \
+           ../../ReadingColumns.h \
+           ../../HeartRateRollup.h \
+           ../../BpmHistogram.h \
+           ../../HoltWinters.h \
+           ../../PopulationStats.h \
+           ../../QuantileSketch.h \
+           ../../ErrorHandling.h \
+           ../../FileLock.h
+
+unix: LIBS += -lpthread
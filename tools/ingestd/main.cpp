@@ -0,0 +1,87 @@
+/**
+ * @file main.cpp
+ * @brief Headless ingest daemon: accepts reading batches from sensor gateways over HTTP.
+ *
+ * Usage: ingestd [--csv userdata.csv] [--summaries DIR] [--address 127.0.0.1] [--port 8088]
+ *
+ * Gateways POST JSON or CSV batches to /readings (see ReadingIngest); GET /readings/stats reports the
+ * totals so far and GET /metrics serves the process metrics in Prometheus text format. Bind to 0.0.0.0 to
+ * accept gateways on the LAN. SIGINT or SIGTERM stops the daemon.
+ */
+
+#include "HttpServer.h"
+#include "MetricsRegistry.h"
+#include "ReadingIngest.h"
+#include "ReadingStore.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+HttpServer *runningServer = nullptr;
+
+void stopServer(int) {
+    if (runningServer) runningServer->stop();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string summaryDir = "summaries";
+    std::string address = "127.0.0.1";
+    unsigned long port = 8088;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--summaries") summaryDir = value;
+        else if (arg == "--address") address = value;
+        else if (arg == "--port") port = std::strtoul(value, nullptr, 10);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (port > 65535) {
+        std::fprintf(stderr, "Invalid port %lu\n", port);
+        return 1;
+    }
+
+    // The server is declared first so that it outlives the ingest writer, which answers through it.
+    ReadingStore store(csvPath, summaryDir);
+    HttpServer server;
+    ReadingIngest ingest(store);
+    ingest.attach(server);
+    server.route("GET", "/metrics", [](const HttpRequest &, HttpResponse &response) {
+        response.contentType = MetricsRegistry::kContentType;
+        response.body = MetricsRegistry::global().exposition();
+    });
+    if (!server.listen(address, static_cast<std::uint16_t>(port))) {
+        std::fprintf(stderr, "Cannot listen on %s:%lu\n", address.c_str(), port);
+        return 1;
+    }
+    runningServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    std::printf("Accepting readings on http://%s:%u/readings (appending to %s)\n", address.c_str(),
+                static_cast<unsigned>(server.port()), csvPath.c_str());
+    std::fflush(stdout);
+    server.run();
+    runningServer = nullptr;
+    ingest.finish();
+    std::printf("Stored %llu readings in %llu batches, rejected %llu batches, turned away %llu while busy\n",
+                static_cast<unsigned long long>(ingest.readingsAccepted()),
+                static_cast<unsigned long long>(ingest.batchesAccepted()),
+                static_cast<unsigned long long>(ingest.batchesRejected()),
+                static_cast<unsigned long long>(ingest.batchesBusy()));
+    return 0;
+}
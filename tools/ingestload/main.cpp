@@ -0,0 +1,273 @@
+/**
+ * @file main.cpp
+ * @brief Load test for the reading ingest endpoint: reports readings per second and request latency.
+ *
+ * Usage: ingestload [--host 127.0.0.1] [--port P] [--connections C] [--requests R] [--batch B]
+ *                   [--format json|csv] [--users U] [--parse-only]
+ *
+ * C keep-alive connections each POST R batches of B readings to /readings, spread over U users, and wait for
+ * every response before sending the next. A batch turned away with 503 because the writer is behind is sent
+ * again; the latency covers every attempt. Without --port an ingest server is started in-process against a
+ * temporary CSV, so the test is self-contained; with --port it targets a running ingestd. --parse-only skips
+ * the network and the store and times ReadingBatchParser alone on the same C x R batches.
+ */
+
+#include "HttpServer.h"
+#include "ReadingBatchParser.h"
+#include "ReadingIngest.h"
+#include "ReadingStore.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    unsigned port = 0;
+    std::size_t connections = 4;
+    std::size_t requests = 200;
+    std::size_t batch = 500;
+    std::size_t users = 8;
+    bool csv = false;
+    bool parseOnly = false;
+};
+
+/**
+ * @brief Builds one batch body.
+ */
+void buildBody(const Options &options, std::size_t client, std::size_t request, std::string &body) {
+    body.clear();
+    if (!options.csv) body += '[';
+    char line[160];
+    long long base = 1760000000LL + static_cast<long long>(request * options.batch);
+    for (std::size_t i = 0; i < options.batch; ++i) {
+        std::size_t user = (client * 7 + i * options.users / options.batch) % options.users;
+        double bpm = 60.0 + static_cast<double>((request * 31 + i * 17) % 60);
+        int length;
+        long long timestamp = base + static_cast<long long>(i);
+        int spo2 = 95 + static_cast<int>(i % 5);
+        if (options.csv)
+            length = std::snprintf(line, sizeof(line), "gateway%zu,%lld,%.1f,%d\n", user, timestamp, bpm, spo2);
+        else
+            length = std::snprintf(line, sizeof(line),
+                                   "%s{\"user\":\"gateway%zu\",\"timestamp\":%lld,\"bpm\":%.1f,\"spo2\":%d}",
+                                   i ? "," : "", user, timestamp, bpm, spo2);
+        body.append(line, static_cast<std::size_t>(length));
+    }
+    if (!options.csv) body += ']';
+}
+
+/**
+ * @brief Reads one response and returns its status, or -1 if the connection failed.
+ */
+int readResponse(int fd, std::string &buffer) {
+    buffer.clear();
+    std::size_t headerEnd = std::string::npos;
+    std::size_t needed = 0;
+    char chunk[4096];
+    while (true) {
+        if (headerEnd == std::string::npos) {
+            headerEnd = buffer.find("\r\n\r\n");
+            if (headerEnd != std::string::npos) {
+                std::size_t at = buffer.find("Content-Length:");
+                std::size_t length = at == std::string::npos ? 0 : std::strtoull(buffer.c_str() + at + 15, nullptr, 10);
+                needed = headerEnd + 4 + length;
+            }
+        }
+        if (headerEnd != std::string::npos && buffer.size() >= needed) break;
+        ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (got <= 0) return -1;
+        buffer.append(chunk, static_cast<std::size_t>(got));
+    }
+    return buffer.size() > 12 ? std::atoi(buffer.c_str() + 9) : -1;
+}
+
+/**
+ * @brief Runs one client connection and records each request's latency in microseconds.
+ */
+void runClient(const Options &options, std::size_t client, std::vector<double> &latencies,
+               std::atomic<std::size_t> &errors, std::atomic<std::size_t> &retries) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<std::uint16_t>(options.port));
+    inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        std::fprintf(stderr, "Cannot connect to %s:%u\n", options.host.c_str(), options.port);
+        if (fd >= 0) ::close(fd);
+        errors += options.requests;
+        return;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+    std::string body, request, response;
+    for (std::size_t r = 0; r < options.requests; ++r) {
+        buildBody(options, client, r, body);
+        request = "POST /readings HTTP/1.1\r\nHost: " + options.host + "\r\nContent-Type: " +
+                  (options.csv ? "text/csv" : "application/json") + "\r\nContent-Length: " +
+                  std::to_string(body.size()) + "\r\n\r\n";
+        request += body;
+
+        auto start = std::chrono::steady_clock::now();
+        int status;
+        while (true) {
+            std::size_t sent = 0;
+            while (sent < request.size()) {
+                ssize_t n = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                sent += static_cast<std::size_t>(n);
+            }
+            status = sent == request.size() ? readResponse(fd, response) : -1;
+            if (status != 503) break;
+            ++retries;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        latencies.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+        if (status != 200) {
+            ++errors;
+            if (status < 0) break;
+        }
+    }
+    ::close(fd);
+}
+
+/**
+ * @brief Parses every batch the clients would send with one parser and reports the cost per reading.
+ */
+int runParseOnly(const Options &options) {
+    std::vector<std::string> bodies;
+    for (std::size_t c = 0; c < options.connections; ++c) {
+        for (std::size_t r = 0; r < options.requests; ++r) {
+            bodies.emplace_back();
+            buildBody(options, c, r, bodies.back());
+        }
+    }
+    ReadingBatchParser parser;
+    ReadingBatchParser::Format format = options.csv ? ReadingBatchParser::Csv : ReadingBatchParser::Json;
+    std::size_t readings = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string &body : bodies) {
+        if (!parser.parse(body.data(), body.size(), format)) {
+            std::fprintf(stderr, "Batch rejected: %s\n", parser.error().c_str());
+            return 1;
+        }
+        readings += parser.count();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Parsed %zu %s readings in %zu batches in %.3f s: %.3f us per reading\n", readings,
+                options.csv ? "CSV" : "JSON", bodies.size(), seconds,
+                readings ? seconds * 1e6 / static_cast<double>(readings) : 0.0);
+    return 0;
+}
+
+double percentile(std::vector<double> &values, double q) {
+    if (values.empty()) return 0.0;
+    std::size_t k = static_cast<std::size_t>(q * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(k), values.end());
+    return values[k];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--parse-only") {
+            options.parseOnly = true;
+            continue;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--host") options.host = value;
+        else if (arg == "--port") options.port = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--connections") options.connections = std::strtoull(value, nullptr, 10);
+        else if (arg == "--requests") options.requests = std::strtoull(value, nullptr, 10);
+        else if (arg == "--batch") options.batch = std::strtoull(value, nullptr, 10);
+        else if (arg == "--users") options.users = std::strtoull(value, nullptr, 10);
+        else if (arg == "--format") options.csv = std::string(value) == "csv";
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (options.connections == 0 || options.batch == 0 || options.users == 0) {
+        std::fprintf(stderr, "--connections, --batch and --users must be positive\n");
+        return 1;
+    }
+    if (options.parseOnly) return runParseOnly(options);
+
+    // Self-contained mode: an in-process server on a free port, writing to a scratch directory.
+    std::filesystem::path scratch;
+    std::unique_ptr<ReadingStore> store;
+    std::unique_ptr<HttpServer> server;
+    std::unique_ptr<ReadingIngest> ingest;
+    std::thread serverThread;
+    if (options.port == 0) {
+        scratch = std::filesystem::temp_directory_path() / ("ingestload-" + std::to_string(::getpid()));
+        std::filesystem::create_directories(scratch);
+        store.reset(new ReadingStore((scratch / "userdata.csv").string(), (scratch / "summaries").string()));
+        server.reset(new HttpServer());
+        ingest.reset(new ReadingIngest(*store));
+        ingest->attach(*server);
+        if (!server->listen("127.0.0.1", 0)) return 1;
+        options.host = "127.0.0.1";
+        options.port = server->port();
+        serverThread = std::thread([&server]() { server->run(); });
+    }
+
+    std::vector<std::vector<double>> latencies(options.connections);
+    std::atomic<std::size_t> errors{0};
+    std::atomic<std::size_t> retries{0};
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t c = 0; c < options.connections; ++c) {
+        latencies[c].reserve(options.requests);
+        clients.emplace_back(runClient, std::cref(options), c, std::ref(latencies[c]), std::ref(errors),
+                             std::ref(retries));
+    }
+    for (std::thread &client : clients) client.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (server) {
+        server->stop();
+        serverThread.join();
+        ingest->finish();
+        std::error_code ec;
+        std::filesystem::remove_all(scratch, ec);
+    }
+
+    std::vector<double> all;
+    for (const std::vector<double> &part : latencies) all.insert(all.end(), part.begin(), part.end());
+    std::size_t ok = all.size() - std::min(all.size(), errors.load());
+    double readings = static_cast<double>(ok * options.batch);
+    std::printf("%zu requests (%zu failed) of %zu %s readings over %zu connections in %.2f s\n", all.size(),
+                errors.load(), options.batch, options.csv ? "CSV" : "JSON", options.connections, seconds);
+    std::printf("Throughput: %.0f readings/s, %.0f requests/s; %zu batches resent after 503\n", readings / seconds,
+                static_cast<double>(all.size()) / seconds, retries.load());
+    double p50 = percentile(all, 0.50);
+    double p99 = percentile(all, 0.99);
+    double worst = all.empty() ? 0.0 : *std::max_element(all.begin(), all.end());
+    std::printf("Latency: p50 %.0f us, p99 %.0f us, max %.0f us\n", p50, p99, worst);
+    return errors.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file main.cpp
+ * @brief Computes the matrix profile of a user's per-minute heart rate and prints its motifs and discords.
+ *
+ * Usage: matrixprofile --user NAME [--csv userdata.csv] [--summaries DIR] [--window MINUTES] [--days N]
+ *                      [--top K] [--threads N]
+ *
+ * --days limits the series to the last N days of the user's history (default: all of it). Motifs are the
+ * closest pairs of windows, discords the windows least like anything else.
+ */
+
+#include "MatrixProfile.h"
+#include "ReadingStore.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+#include <string>
+
+namespace {
+
+std::string formatTime(long long timestamp) {
+    std::time_t t = static_cast<std::time_t>(timestamp);
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M", std::gmtime(&t));
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string summaryDir = "summaries";
+    std::string user;
+    int window = 60;
+    long long days = 0;
+    std::size_t top = 5;
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--summaries") summaryDir = value;
+        else if (arg == "--user") user = value;
+        else if (arg == "--window") window = std::atoi(value);
+        else if (arg == "--days") days = std::atoll(value);
+        else if (arg == "--top") top = std::strtoull(value, nullptr, 10);
+        else if (arg == "--threads") threads = static_cast<unsigned>(std::atoi(value));
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (user.empty()) {
+        std::fprintf(stderr, "Usage: %s --user NAME [options]\n", argv[0]);
+        return 1;
+    }
+
+    UserSummary summary;
+    if (!ReadingStore(csvPath, summaryDir).loadSummary(user, summary)) {
+        std::fprintf(stderr, "Cannot read %s\n", csvPath.c_str());
+        return 1;
+    }
+    long long to = summary.rollup.getLastTimestamp() + 1;
+    long long from = days > 0 ? to - days * 86400 : std::numeric_limits<long long>::min();
+
+    auto start = std::chrono::steady_clock::now();
+    MatrixProfile profile;
+    if (!profile.computeFromRollup(summary.rollup, from, to, window, threads)) {
+        std::fprintf(stderr, "%s has too little minute data for %d-minute windows\n", user.c_str(), window);
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("Motifs (recurring %d-minute patterns):\n", window);
+    for (const ProfileEvent &motif : profile.motifs(top))
+        std::printf("  %s  ~  %s   distance %.3f\n", formatTime(motif.timestamp).c_str(),
+                    formatTime(motif.matchTimestamp).c_str(), motif.distance);
+    std::printf("Discords (candidate anomalies):\n");
+    for (const ProfileEvent &discord : profile.discords(top))
+        std::printf("  %s  nearest %s   distance %.3f\n", formatTime(discord.timestamp).c_str(),
+                    formatTime(discord.matchTimestamp).c_str(), discord.distance);
+    std::printf("%zu windows profiled in %.2f s\n", profile.size(), seconds);
+    return 0;
+}
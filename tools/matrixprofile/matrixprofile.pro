@@ -0,0 +1,42 @@
+QT       -= gui core
+
+TARGET = matrixprofile
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+# The diagonal kernel relies on loop vectorization, which -O2 leaves out on older compilers.
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE += -O3
+
+SOURCES += main.cpp \
+           ../../MatrixProfile.cpp \
+           ../../ReadingColumns.cpp \
+           ../../ReadingStore.cpp \
+           ../../AnomalyDetector.cpp \
+           ../../MetricsRegistry.cpp \
+           ../../HeartRateRollup.cpp \
+           ../../BpmHistogram.cpp \
+           ../../HoltWinters.cpp \
+           ../../PopulationStats.cpp \
+           ../../QuantileSketch.cpp \
+           ../../ErrorHandling.cpp \
+           ../../FileLock.cpp
+
+HEADERS += ../../MatrixProfile.h \
+           ../../ReadingColumns.h \
+           ../../ReadingStore.h \
+           ../../AnomalyDetector.h \
+           ../../MetricsRegistry.h \
+           ../../HeartRateRollup.h \
+           ../../BpmHistogram.h \
+           ../../HoltWinters.h \
+           ../../PopulationStats.h \
+           ../../QuantileSketch.h \
+           ../../ErrorHandling.h \
+           ../../FileLock.h
+
+unix: LIBS += -lpthread
@@ -0,0 +1,129 @@
+/**
+ * @file main.cpp
+ * @brief Finds the patient-days whose heart-rate curve looks most like a given user's day.
+ *
+ * Usage: patternsearch --user NAME --day YYYY-MM-DD [--csv userdata.csv] [--summaries DIR] [--k 10]
+ *                      [--metric dtw|euclidean] [--window 0.05] [--resolution 1] [--coverage 0.5] [--threads N]
+ *
+ * Every user's minute tier is turned into one curve per sufficiently covered day. The query day itself is
+ * left out of the matches.
+ */
+
+#include "ReadingColumns.h"
+#include "ReadingStore.h"
+#include "SimilaritySearch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+namespace {
+
+std::string formatDay(long long day) {
+    std::time_t t = static_cast<std::time_t>(day);
+    char text[16];
+    std::strftime(text, sizeof(text), "%Y-%m-%d", std::gmtime(&t));
+    return text;
+}
+
+bool parseDay(const std::string &text, long long &day) {
+    int year, month, date;
+    if (std::sscanf(text.c_str(), "%d-%d-%d", &year, &month, &date) != 3) return false;
+    // Days since 1970-01-01 in the proleptic Gregorian calendar.
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    long long yearOfEra = year - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + date - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    day = (era * 146097 + dayOfEra - 719468) * 86400;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string summaryDir = "summaries";
+    std::string user, dayText;
+    std::size_t k = 10;
+    SimilaritySearch::Metric metric = SimilaritySearch::Dtw;
+    double window = 0.05;
+    int resolution = 1;
+    double coverage = 0.5;
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--summaries") summaryDir = value;
+        else if (arg == "--user") user = value;
+        else if (arg == "--day") dayText = value;
+        else if (arg == "--k") k = std::strtoull(value, nullptr, 10);
+        else if (arg == "--metric") metric = std::string(value) == "euclidean" ? SimilaritySearch::Euclidean
+                                                                                : SimilaritySearch::Dtw;
+        else if (arg == "--window") window = std::atof(value);
+        else if (arg == "--resolution") resolution = std::atoi(value);
+        else if (arg == "--coverage") coverage = std::atof(value);
+        else if (arg == "--threads") threads = static_cast<unsigned>(std::atoi(value));
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    long long day = 0;
+    if (user.empty() || !parseDay(dayText, day)) {
+        std::fprintf(stderr, "Usage: %s --user NAME --day YYYY-MM-DD [options]\n", argv[0]);
+        return 1;
+    }
+    if (resolution <= 0 || 1440 % resolution != 0) {
+        std::fprintf(stderr, "--resolution must divide 1440\n");
+        return 1;
+    }
+
+    ReadingStore store(csvPath, summaryDir);
+    ReadingColumns columns;
+    if (!store.loadColumns(columns)) {
+        std::fprintf(stderr, "Cannot read %s\n", csvPath.c_str());
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    SimilaritySearch search(resolution);
+    std::vector<double> query;
+    bool haveQuery = false;
+    for (const std::string &name : columns.userNames()) {
+        UserSummary summary;
+        if (!store.loadSummary(name, summary)) continue;
+        search.addUser(name, summary.rollup, coverage);
+        if (name == user) haveQuery = SimilaritySearch::dayCurve(summary.rollup, day, resolution, coverage, query);
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!haveQuery) {
+        std::fprintf(stderr, "%s has too few readings on %s\n", user.c_str(), dayText.c_str());
+        return 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+    SimilarityStats stats;
+    std::vector<SimilarityMatch> matches = search.search(query, k + 1, metric, window, threads, &stats);
+    double searchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-20s %-10s %12s\n", "user", "day", "distance");
+    std::size_t shown = 0;
+    for (const SimilarityMatch &match : matches) {
+        if ((match.user == user && match.day == day) || shown == k) continue;
+        std::printf("%-20s %-10s %12.4f\n", match.user.c_str(), formatDay(match.day).c_str(), match.distance);
+        ++shown;
+    }
+    std::printf("%zu patient-days loaded in %.0f ms, searched in %.1f ms\n", search.size(), loadMs, searchMs);
+    std::printf("pruned: %zu LB_Kim, %zu LB_Keogh, %zu reverse LB_Keogh; %zu abandoned, %zu computed\n",
+                stats.prunedByKim, stats.prunedByKeogh, stats.prunedByKeoghReverse, stats.abandoned,
+                stats.completed);
+    return 0;
+}
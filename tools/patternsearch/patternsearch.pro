@@ -0,0 +1,38 @@
+QT       -= gui core
+
+TARGET = patternsearch
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../SimilaritySearch.cpp \
+           ../../ReadingColumns.cpp \
+           ../../ReadingStore.cpp \
+           ../../AnomalyDetector.cpp \
+           ../../MetricsRegistry.cpp \
+           ../../HeartRateRollup.cpp \
+           ../../BpmHistogram.cpp \
+           ../../HoltWinters.cpp \
+           ../../PopulationStats.cpp \
+           ../../QuantileSketch.cpp \
+           ../../ErrorHandling.cpp \
+           ../../FileLock.cpp
+
+HEADERS += ../../SimilaritySearch.h \
+           ../../ReadingColumns.h \
+           ../../ReadingStore.h \
+           ../../AnomalyDetector.h \
+           ../../MetricsRegistry.h \
+           ../../HeartRateRollup.h \
+           ../../BpmHistogram.h \
+           ../../HoltWinters.h \
+           ../../PopulationStats.h \
+           ../../QuantileSketch.h \
+           ../../ErrorHandling.h \
+           ../../FileLock.h
+
+unix: LIBS += -lpthread
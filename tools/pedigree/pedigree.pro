@@ -0,0 +1,18 @@
+QT       -= gui core
+
+TARGET = pedigree
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../FamilyGraph.cpp \
+           ../../ErrorHandling.cpp
+
+HEADERS += ../../FamilyGraph.h \
+           ../../ErrorHandling.h
+
+unix: LIBS += -lpthread
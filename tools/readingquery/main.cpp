@@ -0,0 +1,122 @@
+/**
+ * @file main.cpp
+ * @brief Command-line front end of the reading query language.
+ *
+ * Usage: readingquery [--csv userdata.csv] [--summaries DIR] [--no-pushdown] [--explain] "QUERY"
+ *
+ * Example:
+ *   readingquery "SELECT user, hour, avg(bpm), count(*) WHERE bpm > 100 AND time >= now - 7d GROUP BY user, hour"
+ *
+ * Queries that only need BPM aggregates over tier-aligned ranges can be answered from the per-user rollup
+ * tiers; the plan estimated to read less is used, and everything else scans the columnar copy of the readings.
+ * Queries never write summaries. --no-pushdown always scans and --explain prints the plan, the cost
+ * estimates and how much data was read.
+ */
+
+#include "ReadingColumns.h"
+#include "ReadingQuery.h"
+#include "ReadingStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printResult(const QueryResult &result) {
+    std::vector<std::size_t> widths;
+    for (const std::string &column : result.columns) widths.push_back(column.size());
+    for (const std::vector<std::string> &row : result.rows)
+        for (std::size_t c = 0; c < row.size(); ++c) widths[c] = std::max(widths[c], row[c].size());
+    for (std::size_t c = 0; c < result.columns.size(); ++c) {
+        int width = c + 1 < result.columns.size() ? -static_cast<int>(widths[c]) : static_cast<int>(widths[c]);
+        std::printf("%s%*s", c ? "  " : "", width, result.columns[c].c_str());
+    }
+    std::printf("\n");
+    for (const std::vector<std::string> &row : result.rows) {
+        for (std::size_t c = 0; c < row.size(); ++c)
+            std::printf("%s%*s", c ? "  " : "", static_cast<int>(widths[c]), row[c].c_str());
+        std::printf("\n");
+    }
+    std::printf("(%zu rows)\n", result.rows.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string summaryDir = "summaries";
+    bool pushdown = true;
+    bool explain = false;
+    std::string text;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-pushdown") {
+            pushdown = false;
+        } else if (arg == "--explain") {
+            explain = true;
+        } else if ((arg == "--csv" || arg == "--summaries") && i + 1 < argc) {
+            (arg == "--csv" ? csvPath : summaryDir) = argv[++i];
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        } else {
+            text += (text.empty() ? "" : " ") + arg;
+        }
+    }
+    if (text.empty()) {
+        std::fprintf(stderr, "Usage: %s [--csv FILE] [--summaries DIR] [--no-pushdown] [--explain] \"QUERY\"\n",
+                     argv[0]);
+        return 1;
+    }
+
+    ReadingQuery query;
+    std::string error;
+    if (!query.parse(text, error, static_cast<long long>(std::time(nullptr)))) {
+        std::fprintf(stderr, "Syntax error: %s\n", error.c_str());
+        return 1;
+    }
+
+    ReadingStore store(csvPath, summaryDir);
+    auto start = std::chrono::steady_clock::now();
+    QueryResult result;
+    bool rollups = pushdown && query.canUseRollups();
+    double rollupCost = 0.0, scanCost = 0.0;
+    bool answered = false;
+    if (rollups && !query.userFilter().empty()) {
+        // A single user's rollups may answer the query without loading the columns at all.
+        std::vector<std::string> users = { query.userFilter() };
+        rollupCost = query.rollupCost(store, users);
+        scanCost = ReadingQuery::scanCost(store, nullptr);
+        answered = rollupCost < scanCost && query.executeOnRollups(store, users, result);
+    }
+    if (!answered) {
+        ReadingColumns columns;
+        if (!store.loadColumns(columns)) {
+            std::fprintf(stderr, "Cannot read %s\n", csvPath.c_str());
+            return 1;
+        }
+        start = std::chrono::steady_clock::now();
+        if (rollups) {
+            rollupCost = query.rollupCost(store, columns.userNames());
+            scanCost = ReadingQuery::scanCost(store, &columns);
+            answered = rollupCost < scanCost && query.executeOnRollups(store, columns.userNames(), result);
+        }
+        if (!answered) result = query.execute(columns);
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printResult(result);
+    if (explain) {
+        std::printf("plan: %s\n", result.plan.c_str());
+        if (rollups) std::printf("estimated cost: rollup %.0f, scan %.0f\n", rollupCost, scanCost);
+        if (result.blocksScanned + result.blocksSkipped > 0)
+            std::printf("blocks: %zu scanned, %zu skipped\n", result.blocksScanned, result.blocksSkipped);
+        std::printf("%s read: %zu\n", result.plan == "column scan" ? "rows" : "rollup buckets", result.rowsScanned);
+        std::printf("time: %.3f ms\n", elapsed);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file main.cpp
+ * @brief Command-line trainer for the logistic risk model.
+ *
+ * Usage: riskmodel [--simulate N] [--import cohort.csv] [--epochs E] [--batch B] [--rate R] [--threads T]
+ *                  [--holdout F] [--thresholds MODERATE,HIGH] [--out risk_model.txt]
+ *
+ * Trains on the simulated and/or imported subjects, prints the coefficients and a calibration table for the
+ * holdout set, measures batch scoring throughput and saves the model. Point HEARTPI_RISK_MODEL at the output
+ * file when starting the GUI to replace the point system with the model.
+ */
+
+#include "RiskModel.h"
+#include "RiskModelTrainer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t simulate = 0;
+    std::vector<std::string> imports;
+    std::string outPath = "risk_model.txt";
+    double holdoutFraction = 0.2;
+    double moderate = 0.10, high = 0.20;
+    TrainingOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--simulate") simulate = std::strtoull(value, nullptr, 10);
+        else if (arg == "--import") imports.push_back(value);
+        else if (arg == "--epochs") options.epochs = std::atoi(value);
+        else if (arg == "--batch") options.batchSize = std::strtoull(value, nullptr, 10);
+        else if (arg == "--rate") options.learningRate = std::atof(value);
+        else if (arg == "--threads") options.threads = static_cast<unsigned>(std::atoi(value));
+        else if (arg == "--holdout") holdoutFraction = std::atof(value);
+        else if (arg == "--thresholds") {
+            if (std::sscanf(value, "%lf,%lf", &moderate, &high) != 2) {
+                std::fprintf(stderr, "--thresholds expects MODERATE,HIGH\n");
+                return 1;
+            }
+        }
+        else if (arg == "--out") outPath = value;
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (simulate == 0 && imports.empty()) simulate = 1000000;
+
+    RiskCohort cohort;
+    auto start = std::chrono::steady_clock::now();
+    if (simulate > 0) cohort.simulate(simulate, 42);
+    for (const std::string &path : imports)
+        if (!cohort.loadCsv(path)) return 1;
+    cohort.shuffle(7);
+    RiskCohort holdout = cohort.splitHoldout(holdoutFraction);
+    std::printf("Cohort: %zu training, %zu holdout subjects (%.2f s)\n", cohort.size(), holdout.size(),
+                secondsSince(start));
+
+    LogisticRiskModel model;
+    model.setThresholds(moderate, high);
+    start = std::chrono::steady_clock::now();
+    double trainLoss = RiskModelTrainer(options).train(cohort, model);
+    double trainSeconds = secondsSince(start);
+    std::printf("Trained %d epochs in %.2f s (%.1f M subjects/s), training log loss %.4f\n", options.epochs,
+                trainSeconds, options.epochs * cohort.size() / trainSeconds / 1e6, trainLoss);
+
+    std::printf("\n%-20s %9s\n", "feature", "weight");
+    std::printf("%-20s %9.4f\n", "(intercept)", model.getBias());
+    for (int i = 0; i < RiskFeatures::kUsed; ++i)
+        std::printf("%-20s %9.4f\n", RiskFeatures::name(i).c_str(), model.getWeights()[i]);
+
+    const RiskCohort &scored = holdout.size() > 0 ? holdout : cohort;
+    ModelEvaluation evaluation = RiskModelTrainer::evaluate(model, scored);
+    std::printf("\nHoldout log loss %.4f, Brier %.4f, calibration error %.4f\n", evaluation.logLoss,
+                evaluation.brierScore, evaluation.calibrationError);
+    std::printf("%-11s %9s %9s %9s\n", "bin", "predicted", "observed", "count");
+    for (std::size_t b = 0; b < evaluation.bins.size(); ++b) {
+        const CalibrationBin &bin = evaluation.bins[b];
+        if (bin.count == 0) continue;
+        std::printf("%4.2f-%4.2f   %9.4f %9.4f %9zu\n", static_cast<double>(b) / evaluation.bins.size(),
+                    static_cast<double>(b + 1) / evaluation.bins.size(), bin.predicted, bin.observed, bin.count);
+    }
+
+    std::vector<float> probabilities(scored.size());
+    start = std::chrono::steady_clock::now();
+    int passes = 0;
+    do {
+        model.scoreBatch(scored.rows(), scored.size(), probabilities.data());
+        ++passes;
+    } while (secondsSince(start) < 0.5);
+    std::printf("\nBatch scoring: %.1f M profiles/s on one thread\n",
+                passes * scored.size() / secondsSince(start) / 1e6);
+
+    if (!model.save(outPath)) return 1;
+    std::printf("Saved %s\n", outPath.c_str());
+    return 0;
+}
@@ -0,0 +1,26 @@
+QT       -= gui core
+
+TARGET = riskmodel
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../RiskModel.cpp \
+           ../../RiskModelTrainer.cpp \
+           ../../Calculations.cpp \
+           ../../FamilyHealth.cpp \
+           ../../RandomNumberGenerator.cpp \
+           ../../ErrorHandling.cpp
+
+HEADERS += ../../RiskModel.h \
+           ../../RiskModelTrainer.h \
+           ../../Calculations.h \
+           ../../FamilyHealth.h \
+           ../../RandomNumberGenerator.h \
+           ../../ErrorHandling.h
+
+unix: LIBS += -lpthread
@@ -0,0 +1,192 @@
+/**
+ * @file main.cpp
+ * @brief Headless sample daemon: receives raw ECG streams from bedside devices and stores heart rates.
+ *
+ * Usage: sampled [--csv userdata.csv] [--summaries DIR] [--streams streams.csv] [--address 127.0.0.1]
+ *                [--port 8092] [--udp-port P] [--window SECONDS] [--interval SECONDS]
+ *
+ * Devices stream over the binary sample protocol (see SampleProtocol) on the TCP port, or on the UDP port
+ * if one is given. A SampleServer decodes them into a SampleBus on its own thread; the main thread drains
+ * every stream each --interval seconds, counts its beats with an EcgBeatDetector and appends one reading
+ * per --window seconds through ReadingStore, so the readings reach the summaries and, through vitalsd,
+ * the caregivers. The --streams file maps devices to users, one "streamId,username" per line; samples of
+ * unmapped streams are received but not stored. SIGINT or SIGTERM stops the daemon.
+ */
+
+#include "EcgBeatDetector.h"
+#include "ReadingStore.h"
+#include "SampleBus.h"
+#include "SampleServer.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+/**
+ * @brief Drain state of one bus stream.
+ */
+struct StreamDrain {
+    bool resolved = false;          // The stream's user has been looked up.
+    std::string user;               // User the readings go to (empty: not stored).
+    std::uint64_t position = 0;     // Next bus position to read.
+    EcgBeatDetector detector;       // Beats seen so far.
+
+    explicit StreamDrain(double window) : detector(window) {}
+};
+
+/**
+ * @brief Reads "streamId,username" lines; blank lines and lines starting with '#' are skipped.
+ */
+bool loadStreamMap(const std::string &path, std::unordered_map<std::uint32_t, std::string> &users) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::size_t comma = line.find(',');
+        if (line.empty() || line[0] == '#' || comma == std::string::npos || comma + 1 == line.size()) continue;
+        char *end = nullptr;
+        unsigned long id = std::strtoul(line.c_str(), &end, 10);
+        if (end != line.c_str() + comma) continue;
+        users[static_cast<std::uint32_t>(id)] = line.substr(comma + 1);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string summaryDir = "summaries";
+    std::string streamsPath = "streams.csv";
+    std::string address = "127.0.0.1";
+    unsigned long port = 8092;
+    unsigned long udpPort = 0;
+    double window = 60.0;
+    double interval = 0.25;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--summaries") summaryDir = value;
+        else if (arg == "--streams") streamsPath = value;
+        else if (arg == "--address") address = value;
+        else if (arg == "--port") port = std::strtoul(value, nullptr, 10);
+        else if (arg == "--udp-port") udpPort = std::strtoul(value, nullptr, 10);
+        else if (arg == "--window") window = std::atof(value);
+        else if (arg == "--interval") interval = std::atof(value);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (port > 65535 || udpPort > 65535 || window < 1.0 || interval <= 0.0) {
+        std::fprintf(stderr, "Invalid --port, --udp-port, --window or --interval\n");
+        return 1;
+    }
+    std::unordered_map<std::uint32_t, std::string> users;
+    if (!loadStreamMap(streamsPath, users)) {
+        std::fprintf(stderr, "Cannot read %s\n", streamsPath.c_str());
+        return 1;
+    }
+
+    SampleBus bus;
+    SampleServer server(bus);
+    if (!server.listen(address, static_cast<std::uint16_t>(port))) {
+        std::fprintf(stderr, "Cannot listen on %s:%lu\n", address.c_str(), port);
+        return 1;
+    }
+    if (udpPort > 0 && !server.listenUdp(address, static_cast<std::uint16_t>(udpPort))) {
+        std::fprintf(stderr, "Cannot receive on UDP %s:%lu\n", address.c_str(), udpPort);
+        return 1;
+    }
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::printf("Receiving samples on %s:%u for %zu mapped streams (appending to %s)\n", address.c_str(),
+                static_cast<unsigned>(server.port()), users.size(), csvPath.c_str());
+    std::fflush(stdout);
+
+    // The server thread is the bus's only writer; this thread only reads.
+    std::thread receiver([&server] { server.run(); });
+    ReadingStore store(csvPath, summaryDir);
+    std::vector<StreamDrain> drains;
+    std::vector<std::int16_t> buffer(bus.capacity());
+    std::vector<HeartRateReading> batch;
+    unsigned long long stored = 0, overwritten = 0;
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(interval));
+
+    while (true) {
+        bool stopping = stopRequested != 0;
+        if (stopping) {
+            // Stop the writer first, so the last drain sees everything it committed.
+            server.stop();
+            receiver.join();
+        }
+        std::size_t streams = bus.streamCount();
+        if (drains.size() < streams) drains.resize(streams, StreamDrain(window));
+        batch.clear();
+        for (std::size_t index = 0; index < streams; ++index) {
+            StreamDrain &drain = drains[index];
+            SampleStreamInfo info = bus.info(index);
+            if (!drain.resolved) {
+                auto it = users.find(info.id);
+                if (it != users.end()) drain.user = it->second;
+                drain.resolved = true;
+            }
+            if (drain.user.empty()) {
+                drain.position = info.written;
+                continue;
+            }
+            while (drain.position < info.written) {
+                std::uint64_t start = 0;
+                std::size_t count = bus.read(index, drain.position, buffer.data(), buffer.size(), start);
+                if (count == 0) break;
+                // The ring moved past samples not drained yet; the beat spacing across the hole is unknown.
+                if (start > drain.position) {
+                    overwritten += start - drain.position;
+                    drain.detector.reset();
+                }
+                drain.position = start + count;
+                if (drain.detector.add(buffer.data(), count, info.interval) > 0 && drain.detector.windowBpm() > 0.0) {
+                    HeartRateReading reading;
+                    reading.user = drain.user;
+                    reading.timestamp = info.lastTimestamp / 1000000;
+                    reading.bpm = drain.detector.windowBpm();
+                    batch.push_back(reading);
+                }
+            }
+        }
+        if (!batch.empty()) {
+            if (store.append(batch)) stored += batch.size();
+            else std::fprintf(stderr, "Cannot append readings to %s\n", csvPath.c_str());
+        }
+        if (stopping) break;
+        std::this_thread::sleep_for(period);
+    }
+    std::printf("Received %llu samples in %llu frames (%llu protocol errors), stored %llu readings, "
+                "missed %llu samples not drained in time\n",
+                static_cast<unsigned long long>(server.samplesReceived()),
+                static_cast<unsigned long long>(server.framesReceived()),
+                static_cast<unsigned long long>(server.protocolErrors()), stored, overwritten);
+    return 0;
+}
@@ -0,0 +1,357 @@
+/**
+ * @file main.cpp
+ * @brief Load generator for the binary sample protocol: simulates many bedside devices streaming ECG.
+ *
+ * Usage: sampleload [--devices 500] [--rate 500] [--frame 50] [--seconds 10] [--retransmit N]
+ *                   [--overlap S] [--udp 0|1] [--reorder N] [--ecg BPM] [--host 127.0.0.1] [--port P]
+ *
+ * Each device opens its own connection and sends a frame of --frame samples every frame/rate seconds, with
+ * the devices' schedules staggered. --retransmit N resends every Nth frame to exercise duplicate dropping;
+ * with --overlap S the frame after it starts S samples early instead, so only part of it was seen before.
+ * With --udp 1 each frame is a datagram instead, and --reorder N sends every Nth frame after the one that
+ * follows it. --ecg sends a synthetic ECG at BPM beats per minute instead of a counting pattern, for example
+ * to check the heart rates sampled stores. Without --port a SampleServer and its SampleBus run in-process;
+ * the tool then also checks that every sample in the bus matches what its device sent, that a second writer
+ * for a stream is refused, and reports the receiver's counters.
+ */
+
+#include "SampleBus.h"
+#include "SampleProtocol.h"
+#include "SampleServer.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Device {
+    int fd = -1;
+    std::uint64_t sequence = 0;     // Next sample to generate.
+    double due = 0.0;               // Seconds after start when the next frame is due.
+    std::uint64_t frames = 0;       // Frames generated.
+    std::string pending;            // Encoded bytes the socket has not taken yet.
+    std::size_t sent = 0;           // Bytes of pending already sent.
+    std::string lastFrame;          // Most recent frame, for retransmission.
+    std::vector<std::string> late;  // Datagrams held back to be sent after the next frame.
+};
+
+/**
+ * @brief The value a device sends for a sequence number, so the receiver's copy can be checked.
+ */
+std::int16_t sampleValue(std::size_t device, std::uint64_t sequence) {
+    return static_cast<std::int16_t>(static_cast<int>((device * 7919 + sequence * 13) & 0x3FFF) - 8192);
+}
+
+/**
+ * @brief A synthetic ECG sample: a steep 40 ms QRS spike once per beat on a slow baseline wander.
+ */
+std::int16_t ecgValue(std::uint64_t sequence, double rate, double bpm) {
+    const double kPi = 3.14159265358979323846;
+    double t = static_cast<double>(sequence) / rate;
+    double intoBeat = std::fmod(t, 60.0 / bpm);
+    double value = 200.0 * std::sin(2.0 * kPi * 0.3 * t);
+    if (intoBeat < 0.04) value += 2000.0 * std::sin(kPi * intoBeat / 0.04);
+    return static_cast<std::int16_t>(std::lround(value));
+}
+
+/**
+ * @brief Sends as much of a device's pending bytes as its socket takes.
+ */
+bool flushDevice(Device &device) {
+    while (device.sent < device.pending.size()) {
+        ssize_t n = ::send(device.fd, device.pending.data() + device.sent, device.pending.size() - device.sent,
+                           MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        device.sent += static_cast<std::size_t>(n);
+    }
+    device.pending.clear();
+    device.sent = 0;
+    return true;
+}
+
+/**
+ * @brief Sends one datagram.
+ */
+bool sendDatagram(int fd, const std::string &datagram) {
+    ssize_t n;
+    do {
+        n = ::send(fd, datagram.data(), datagram.size(), MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n == static_cast<ssize_t>(datagram.size());
+}
+
+/**
+ * @brief Writes one frame to a stream that a device already writes, from a socket of its own.
+ */
+void sendIntruder(bool udp, const sockaddr_in &addr, std::uint32_t streamId, std::uint64_t sequence) {
+    int fd = ::socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) ::close(fd);
+        return;
+    }
+    std::vector<std::int16_t> values(8, 12345);
+    SampleFrameHeader header;
+    header.streamId = streamId;
+    header.sequence = sequence;
+    header.interval = 2000;
+    header.sampleCount = static_cast<std::uint16_t>(values.size());
+    std::string bytes;
+    if (!udp) bytes.assign(SampleProtocol::kMagic, sizeof(SampleProtocol::kMagic));
+    SampleProtocol::appendFrame(bytes, header, values.data());
+    sendDatagram(fd, bytes);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ::close(fd);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t deviceCount = 500;
+    double rate = 500.0;
+    std::size_t frameSamples = 50;
+    double seconds = 10.0;
+    std::size_t retransmit = 0;
+    std::size_t overlap = 0;
+    double ecgBpm = 0.0;
+    bool udp = false;
+    std::size_t reorder = 0;
+    std::string host = "127.0.0.1";
+    unsigned port = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--devices") deviceCount = std::strtoull(value, nullptr, 10);
+        else if (arg == "--rate") rate = std::atof(value);
+        else if (arg == "--frame") frameSamples = std::strtoull(value, nullptr, 10);
+        else if (arg == "--seconds") seconds = std::atof(value);
+        else if (arg == "--retransmit") retransmit = std::strtoull(value, nullptr, 10);
+        else if (arg == "--overlap") overlap = std::strtoull(value, nullptr, 10);
+        else if (arg == "--ecg") ecgBpm = std::atof(value);
+        else if (arg == "--udp") udp = std::atoi(value) != 0;
+        else if (arg == "--reorder") reorder = std::strtoull(value, nullptr, 10);
+        else if (arg == "--host") host = value;
+        else if (arg == "--port") port = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (deviceCount == 0 || rate <= 0.0 || frameSamples == 0 || frameSamples > SampleProtocol::kMaxFrameSamples) {
+        std::fprintf(stderr, "--devices and --rate must be positive and --frame between 1 and %zu\n",
+                     SampleProtocol::kMaxFrameSamples);
+        return 1;
+    }
+    if (reorder == 1 || (reorder > 0 && !udp)) {
+        std::fprintf(stderr, "--reorder needs --udp 1 and must be at least 2\n");
+        return 1;
+    }
+    if (overlap > 0 && (retransmit == 0 || overlap >= frameSamples ||
+                        frameSamples + overlap > SampleProtocol::kMaxFrameSamples)) {
+        std::fprintf(stderr, "--overlap needs --retransmit, must be below --frame and fit in a frame\n");
+        return 1;
+    }
+    if (ecgBpm < 0.0) {
+        std::fprintf(stderr, "--ecg must be positive\n");
+        return 1;
+    }
+    auto valueAt = [&](std::size_t device, std::uint64_t sequence) {
+        return ecgBpm > 0.0 ? ecgValue(sequence, rate, ecgBpm) : sampleValue(device, sequence);
+    };
+
+    // Two descriptors per device in-process, one otherwise; the default soft limit is often 1024.
+    rlimit files{};
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    std::unique_ptr<SampleBus> bus;
+    std::unique_ptr<SampleServer> server;
+    std::thread serverThread;
+    if (port == 0) {
+        bus.reset(new SampleBus(deviceCount, static_cast<std::size_t>(rate * 4)));
+        server.reset(new SampleServer(*bus));
+        if (!server->listen("127.0.0.1", 0) || (udp && !server->listenUdp("127.0.0.1", 0))) return 1;
+        host = "127.0.0.1";
+        port = udp ? server->udpPort() : server->port();
+        serverThread = std::thread([&server]() { server->run(); });
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    double period = static_cast<double>(frameSamples) / rate;
+    std::vector<Device> devices(deviceCount);
+    for (std::size_t d = 0; d < deviceCount; ++d) {
+        Device &device = devices[d];
+        device.fd = ::socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+        if (device.fd < 0 || ::connect(device.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            std::fprintf(stderr, "Cannot connect device %zu to %s:%u: %s\n", d, host.c_str(), port,
+                         std::strerror(errno));
+            return 1;
+        }
+        if (!udp) device.pending.assign(SampleProtocol::kMagic, sizeof(SampleProtocol::kMagic));
+        device.due = period * static_cast<double>(d) / static_cast<double>(deviceCount);
+    }
+
+    std::vector<std::int16_t> values(frameSamples + overlap);
+    std::uint64_t framesSent = 0, samplesSent = 0, retransmitted = 0, duplicatesSent = 0, sentLate = 0;
+    std::size_t backlogged = 0;
+    bool failed = false;
+    auto start = std::chrono::steady_clock::now();
+    auto wallStart = std::chrono::system_clock::now();
+    while (!failed) {
+        double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (now >= seconds) break;
+        double nextDue = seconds;
+        for (std::size_t d = 0; d < deviceCount; ++d) {
+            Device &device = devices[d];
+            while (device.due <= now) {
+                // The frame after a retransmitted one starts early when --overlap is given.
+                std::size_t lead = overlap > 0 && device.frames > 0 && device.frames % retransmit == 0 ? overlap : 0;
+                std::uint64_t first = device.sequence - lead;
+                for (std::size_t i = 0; i < frameSamples + lead; ++i) values[i] = valueAt(d, first + i);
+                SampleFrameHeader header;
+                header.streamId = static_cast<std::uint32_t>(1000 + d);
+                header.sequence = first;
+                header.interval = static_cast<std::uint32_t>(1e6 / rate);
+                header.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                                       wallStart.time_since_epoch()).count() +
+                                   static_cast<std::int64_t>(device.due * 1e6) -
+                                   static_cast<std::int64_t>(lead * header.interval);
+                header.sampleCount = static_cast<std::uint16_t>(frameSamples + lead);
+                header.flags = device.frames == 0 ? SampleProtocol::kFlagRestart : 0;
+                device.lastFrame.clear();
+                SampleProtocol::appendFrame(device.lastFrame, header, values.data());
+                bool twice = overlap == 0 && retransmit > 0 && (device.frames + 1) % retransmit == 0;
+                retransmitted += twice || lead > 0 ? 1 : 0;
+                duplicatesSent += twice ? frameSamples : lead;
+                if (!udp) {
+                    device.pending += device.lastFrame;
+                    if (twice) device.pending += device.lastFrame;
+                } else if (reorder > 0 && (device.frames + 1) % reorder == 0) {
+                    device.late.insert(device.late.end(), twice ? 2 : 1, device.lastFrame);
+                    ++sentLate;
+                } else {
+                    for (int copy = twice ? 2 : 1; copy > 0 && !failed; --copy)
+                        failed = !sendDatagram(device.fd, device.lastFrame);
+                    for (const std::string &datagram : device.late)
+                        if (!failed) failed = !sendDatagram(device.fd, datagram);
+                    device.late.clear();
+                }
+                device.sequence += frameSamples;
+                device.due += period;
+                ++device.frames;
+                ++framesSent;
+                samplesSent += frameSamples;
+            }
+            if (failed || !flushDevice(device)) {
+                std::fprintf(stderr, "Device %zu: send failed: %s\n", d, std::strerror(errno));
+                failed = true;
+                break;
+            }
+            if (!device.pending.empty()) ++backlogged;
+            if (device.due < nextDue) nextDue = device.due;
+        }
+        double wait = nextDue - std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (wait > 0) std::this_thread::sleep_for(std::chrono::duration<double>(std::min(wait, 0.005)));
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (Device &device : devices) {
+        // A frame held back at the end has nothing left to overtake it, so it arrives in order after all.
+        sentLate -= device.late.empty() ? 0 : 1;
+        for (const std::string &datagram : device.late)
+            if (!failed) failed = !sendDatagram(device.fd, datagram);
+        while (!failed && !device.pending.empty()) {
+            if (!flushDevice(device)) failed = true;
+            if (!device.pending.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::printf("%zu devices at %.0f Hz over %s, %zu samples per frame, for %.1f s\n", deviceCount, rate,
+                udp ? "UDP" : "TCP", frameSamples, elapsed);
+    std::printf("Sent %llu frames, %llu samples (%.0f samples/s), %llu retransmissions, %llu out of order; "
+                "sends that left a backlog: %zu\n",
+                static_cast<unsigned long long>(framesSent), static_cast<unsigned long long>(samplesSent),
+                static_cast<double>(samplesSent) / elapsed, static_cast<unsigned long long>(retransmitted),
+                static_cast<unsigned long long>(sentLate), backlogged);
+
+    int status = failed ? 1 : 0;
+    if (server) {
+        // Give the receiver time to drain what is still in flight.
+        auto drainStart = std::chrono::steady_clock::now();
+        while (server->samplesReceived() < samplesSent &&
+               std::chrono::steady_clock::now() - drainStart < std::chrono::seconds(5))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        double drain = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - drainStart).count();
+
+        // The first device's stream is still owned, so a frame for it from another socket must be refused.
+        sendIntruder(udp, addr, 1000, devices[0].sequence);
+        bool intruderRefused = server->writersRejected() == 1;
+
+        std::uint64_t lost = 0, duplicates = 0, mismatched = 0;
+        std::vector<std::int16_t> copy(bus->capacity());
+        for (std::size_t d = 0; d < deviceCount; ++d) {
+            long long stream = bus->find(static_cast<std::uint32_t>(1000 + d));
+            if (stream < 0) {
+                ++mismatched;
+                continue;
+            }
+            SampleStreamInfo info = bus->info(static_cast<std::size_t>(stream));
+            lost += info.lost;
+            duplicates += info.duplicates;
+            std::uint64_t first = 0;
+            std::size_t count = bus->read(static_cast<std::size_t>(stream), 0, copy.data(), copy.size(), first);
+            // Without gaps, bus positions equal device sequence numbers.
+            for (std::size_t i = 0; i < count; ++i)
+                if (copy[i] != valueAt(d, first + i)) ++mismatched;
+        }
+        std::printf("Received %llu frames, %llu samples; drained %.1f ms after the last send\n",
+                    static_cast<unsigned long long>(server->framesReceived()),
+                    static_cast<unsigned long long>(server->samplesReceived()), drain);
+        std::printf("Lost %llu, duplicates dropped %llu, reordered %llu, protocol errors %llu, "
+                    "mismatched samples %llu\n",
+                    static_cast<unsigned long long>(lost), static_cast<unsigned long long>(duplicates),
+                    static_cast<unsigned long long>(server->framesReordered()),
+                    static_cast<unsigned long long>(server->protocolErrors()),
+                    static_cast<unsigned long long>(mismatched));
+        std::printf("Second writer for a stream: %s\n", intruderRefused ? "refused" : "NOT refused");
+        if (server->samplesReceived() != samplesSent || lost != 0 || mismatched != 0 ||
+            duplicates != duplicatesSent || server->framesReordered() != sentLate || !intruderRefused)
+            status = 1;
+    }
+    for (Device &device : devices) ::close(device.fd);
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    double cpu = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                 static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    std::printf("CPU time %.2f s (%.0f%% of one core, generator%s)\n", cpu, 100.0 * cpu / elapsed,
+                server ? " and receiver" : "");
+
+    if (server) {
+        server->stop();
+        serverThread.join();
+    }
+    return status;
+}
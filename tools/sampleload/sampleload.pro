@@ -0,0 +1,22 @@
+QT       -= gui core
+
+TARGET = sampleload
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../SampleServer.cpp \
+           ../../SampleBus.cpp \
+           ../../SampleProtocol.cpp \
+           ../../ErrorHandling.cpp
+
+HEADERS += ../../SampleServer.h \
+           ../../SampleBus.h \
+           ../../SampleProtocol.h \
+           ../../ErrorHandling.h
+
+unix: LIBS += -lpthread
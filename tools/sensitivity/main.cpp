@@ -0,0 +1,94 @@
+/**
+ * @file main.cpp
+ * @brief Command-line Sobol sensitivity analysis of the risk tier and the simulated vitals.
+ *
+ * Usage: sensitivity [--samples-log2 K] [--replicates R] [--confidence C] [--threads T] [--seed S]
+ *                    [--model risk_model.txt]
+ *
+ * Prints, for every output of the point system (and of the logistic model when one is given), the
+ * first-order and total-order Sobol index of each survey answer with its confidence interval.
+ */
+
+#include "RiskModel.h"
+#include "SensitivityAnalysis.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printOutputs(const std::vector<SensitivityOutput> &outputs, double confidence) {
+    for (const SensitivityOutput &output : outputs) {
+        std::printf("\n%s: mean %.4f, variance %.4f\n", output.name.c_str(), output.mean, output.variance);
+        std::printf("%-22s %18s %18s\n", "factor", "first order", "total order");
+        double firstSum = 0.0;
+        for (int f = 0; f < FactorCount; ++f) {
+            std::printf("%-22s %8.4f +/- %6.4f %8.4f +/- %6.4f\n",
+                        SensitivityAnalysis::factorName(static_cast<SensitivityFactor>(f)).c_str(),
+                        output.first[f].value, output.first[f].halfWidth, output.total[f].value,
+                        output.total[f].halfWidth);
+            firstSum += output.first[f].value;
+        }
+        std::printf("%-22s %8.4f   (interactions %.4f, %.0f%% intervals)\n", "sum", firstSum, 1.0 - firstSum,
+                    confidence * 100.0);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    SensitivityOptions options;
+    std::string modelPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--samples-log2") options.samplesLog2 = std::atoi(value);
+        else if (arg == "--replicates") options.replicates = std::atoi(value);
+        else if (arg == "--confidence") options.confidence = std::atof(value);
+        else if (arg == "--threads") options.threads = static_cast<unsigned>(std::atoi(value));
+        else if (arg == "--seed") options.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--model") modelPath = value;
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (options.samplesLog2 < 4 || options.samplesLog2 > 30 || options.replicates < 2) {
+        std::fprintf(stderr, "--samples-log2 must be 4-30 and --replicates at least 2\n");
+        return 1;
+    }
+
+    SensitivityAnalysis analysis(options);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SensitivityOutput> outputs = analysis.run(SensitivityAnalysis::pointSystemModel());
+    double seconds = secondsSince(start);
+    std::printf("Point system: %llu evaluations in %.2f s (%.1f M/s)\n",
+                static_cast<unsigned long long>(analysis.evaluationCount()), seconds,
+                analysis.evaluationCount() / seconds / 1e6);
+    printOutputs(outputs, options.confidence);
+
+    if (!modelPath.empty()) {
+        LogisticRiskModel model;
+        if (!model.load(modelPath)) return 1;
+        start = std::chrono::steady_clock::now();
+        outputs = analysis.run(SensitivityAnalysis::logisticModel(model));
+        seconds = secondsSince(start);
+        std::printf("\nLogistic model: %llu evaluations in %.2f s (%.1f M/s)\n",
+                    static_cast<unsigned long long>(analysis.evaluationCount()), seconds,
+                    analysis.evaluationCount() / seconds / 1e6);
+        printOutputs(outputs, options.confidence);
+    }
+    return 0;
+}
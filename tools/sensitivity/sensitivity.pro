@@ -0,0 +1,26 @@
+QT       -= gui core
+
+TARGET = sensitivity
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../SensitivityAnalysis.cpp \
+           ../../RiskModel.cpp \
+           ../../Calculations.cpp \
+           ../../FamilyHealth.cpp \
+           ../../RandomNumberGenerator.cpp \
+           ../../ErrorHandling.cpp
+
+HEADERS += ../../SensitivityAnalysis.h \
+           ../../RiskModel.h \
+           ../../Calculations.h \
+           ../../FamilyHealth.h \
+           ../../RandomNumberGenerator.h \
+           ../../ErrorHandling.h
+
+unix: LIBS += -lpthread
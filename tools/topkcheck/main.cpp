@@ -0,0 +1,134 @@
+/**
+ * @file main.cpp
+ * @brief Checks TopKTracker against a brute-force ranking and times its updates.
+ *
+ * Usage: topkcheck [--ops 100000] [--keys 1000] [--top 10] [--seed 1]
+ *
+ * Runs random updates (scores drawn from a small range, so ties are common) and removes over the given
+ * number of keys. After every operation the tracker's top K, and the score and top-K membership of the key
+ * just touched, are compared with a reference that sorts every live key by score and then by the order keys
+ * were added. The exit status is 1 on the first mismatch.
+ */
+
+#include "RiskWatchlist.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief A live key of the reference.
+ */
+struct Reference {
+    double score = 0.0;
+    std::uint64_t order = 0;    // When the key was (re)added.
+};
+
+/**
+ * @brief The reference top K, best first.
+ */
+std::vector<std::pair<std::string, double>> referenceTop(const std::unordered_map<std::string, Reference> &live,
+                                                         std::size_t k) {
+    std::vector<std::pair<std::string, const Reference *>> all;
+    all.reserve(live.size());
+    for (const auto &entry : live) all.emplace_back(entry.first, &entry.second);
+    auto better = [](const std::pair<std::string, const Reference *> &a,
+                     const std::pair<std::string, const Reference *> &b) {
+        if (a.second->score != b.second->score) return a.second->score > b.second->score;
+        return a.second->order < b.second->order;
+    };
+    std::size_t count = std::min(k, all.size());
+    std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(count), all.end(), better);
+    std::vector<std::pair<std::string, double>> top;
+    for (std::size_t i = 0; i < count; ++i) top.emplace_back(all[i].first, all[i].second->score);
+    return top;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t ops = 100000;
+    std::size_t keyCount = 1000;
+    std::size_t k = 10;
+    unsigned long seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--ops") ops = std::strtoull(value, nullptr, 10);
+        else if (arg == "--keys") keyCount = std::strtoull(value, nullptr, 10);
+        else if (arg == "--top") k = std::strtoull(value, nullptr, 10);
+        else if (arg == "--seed") seed = std::strtoul(value, nullptr, 10);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (keyCount == 0 || k == 0) {
+        std::fprintf(stderr, "--keys and --top must be positive\n");
+        return 1;
+    }
+
+    std::mt19937_64 random(seed);
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < keyCount; ++i) keys.push_back("user" + std::to_string(i));
+
+    TopKTracker tracker(k);
+    std::unordered_map<std::string, Reference> live;
+    std::uint64_t nextOrder = 0;
+    std::size_t updates = 0, removes = 0;
+    for (std::size_t op = 0; op < ops; ++op) {
+        const std::string &key = keys[random() % keyCount];
+        if (random() % 10 == 0) {
+            bool tracked = live.erase(key) > 0;
+            if (tracker.remove(key) != tracked) {
+                std::fprintf(stderr, "Operation %zu: remove(%s) disagrees with the reference\n", op, key.c_str());
+                return 1;
+            }
+            ++removes;
+        } else {
+            double score = static_cast<double>(random() % 50) / 4.0;
+            auto inserted = live.emplace(key, Reference());
+            if (inserted.second) inserted.first->second.order = nextOrder++;
+            inserted.first->second.score = score;
+            tracker.update(key, score);
+            ++updates;
+        }
+
+        std::vector<std::pair<std::string, double>> expected = referenceTop(live, k);
+        double score = 0.0;
+        bool found = tracker.find(key, score);
+        auto reference = live.find(key);
+        bool expectedTop = false;
+        for (const auto &entry : expected) expectedTop = expectedTop || entry.first == key;
+        if (tracker.ranked() != expected || tracker.size() != live.size() || found != (reference != live.end()) ||
+            (found && score != reference->second.score) || tracker.isTop(key) != expectedTop) {
+            std::fprintf(stderr, "Operation %zu on %s: tracker disagrees with the reference\n", op, key.c_str());
+            return 1;
+        }
+    }
+    std::printf("%zu updates and %zu removes over %zu keys with K = %zu: tracker matches the reference\n", updates,
+                removes, keyCount, k);
+
+    // Timing, without the reference in the loop.
+    TopKTracker timed(k);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t op = 0; op < ops; ++op)
+        timed.update(keys[random() % keyCount], static_cast<double>(random() % 1000));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Updates: %.3f us each\n", seconds * 1e6 / static_cast<double>(ops ? ops : 1));
+    return 0;
+}
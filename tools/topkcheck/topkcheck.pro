@@ -0,0 +1,46 @@
+QT       -= gui core
+
+TARGET = topkcheck
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+           ../../RiskWatchlist.cpp \
+           ../../AnomalyDetector.cpp \
+           ../../ReadingStore.cpp \
+           ../../MetricsRegistry.cpp \
+           ../../ReadingColumns.cpp \
+           ../../HeartRateRollup.cpp \
+           ../../BpmHistogram.cpp \
+           ../../HoltWinters.cpp \
+           ../../PopulationStats.cpp \
+           ../../QuantileSketch.cpp \
+           ../../SurveyStore.cpp \
+           ../../SurveyIndex.cpp \
+           ../../SurveyCube.cpp \
+           ../../RoaringBitmap.cpp \
+           ../../FamilyHealth.cpp \
+           ../../ErrorHandling.cpp \
+           ../../FileLock.cpp
+
+HEADERS += ../../RiskWatchlist.h \
+           ../../AnomalyDetector.h \
+           ../../ReadingStore.h \
+           ../../MetricsRegistry.h \
+           ../../ReadingColumns.h \
+           ../../HeartRateRollup.h \
+           ../../BpmHistogram.h \
+           ../../HoltWinters.h \
+           ../../PopulationStats.h \
+           ../../QuantileSketch.h \
+           ../../SurveyStore.h \
+           ../../SurveyIndex.h \
+           ../../SurveyCube.h \
+           ../../RoaringBitmap.h \
+           ../../FamilyHealth.h \
+           ../../ErrorHandling.h \
+           ../../FileLock.h
@@ -0,0 +1,88 @@
+/**
+ * @file main.cpp
+ * @brief Live vitals daemon: streams new readings from userdata.csv to caregivers over WebSocket.
+ *
+ * Usage: vitalsd [--csv userdata.csv] [--address 127.0.0.1] [--port 8090] [--interval SECONDS]
+ *
+ * Caregivers connect to ws://HOST:PORT/vitals?user=NAME and receive that user's readings as they are
+ * appended, by the GUI or by ingestd (see VitalsBroadcaster for the message format). Bind to 0.0.0.0 to
+ * serve viewers elsewhere on the LAN. SIGINT or SIGTERM stops the daemon.
+ */
+
+#include "VitalsBroadcaster.h"
+#include "WebSocketServer.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string address = "127.0.0.1";
+    unsigned long port = 8090;
+    double interval = 0.25;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--address") address = value;
+        else if (arg == "--port") port = std::strtoul(value, nullptr, 10);
+        else if (arg == "--interval") interval = std::atof(value);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (port > 65535 || interval <= 0.0) {
+        std::fprintf(stderr, "Invalid --port or --interval\n");
+        return 1;
+    }
+
+    WebSocketServer server;
+    VitalsBroadcaster broadcaster(server);
+    if (!server.listen(address, static_cast<std::uint16_t>(port))) {
+        std::fprintf(stderr, "Cannot listen on %s:%lu\n", address.c_str(), port);
+        return 1;
+    }
+    broadcaster.follow(csvPath);
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::printf("Streaming %s on ws://%s:%u/vitals?user=NAME\n", csvPath.c_str(), address.c_str(),
+                static_cast<unsigned>(server.port()));
+    std::fflush(stdout);
+
+    auto period = std::chrono::duration<double>(interval);
+    auto nextPoll = std::chrono::steady_clock::now();
+    while (!stopRequested) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextPoll) {
+            if (!broadcaster.catchUp()) std::fprintf(stderr, "Cannot read %s\n", csvPath.c_str());
+            nextPoll = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+            continue;
+        }
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextPoll - now).count() + 1;
+        server.poll(static_cast<int>(wait));
+    }
+    std::printf("Sent %llu messages to %zu viewers (%llu encoded, %llu skipped)\n",
+                static_cast<unsigned long long>(broadcaster.messagesSent()), broadcaster.subscriberCount(),
+                static_cast<unsigned long long>(broadcaster.messagesEncoded()),
+                static_cast<unsigned long long>(broadcaster.messagesSkipped()));
+    return 0;
+}
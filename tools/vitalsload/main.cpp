@@ -0,0 +1,253 @@
+/**
+ * @file main.cpp
+ * @brief Load test for the WebSocket vitals fan-out: many caregivers, some of them too slow to keep up.
+ *
+ * Usage: vitalsload [--viewers 1000] [--users 100] [--slow 50] [--batch 50] [--rate 4] [--seconds 10]
+ *
+ * An in-process VitalsBroadcaster publishes a batch of --batch readings for each of --users users --rate
+ * times a second. --viewers WebSocket clients watch the users round-robin; the last --slow never read, so
+ * their queues fill and they must be thinned out rather than buffered. The tool reports delivery latency to
+ * the viewers that do read, how many messages were encoded versus sent, and where the slow viewers ended.
+ */
+
+#include "VitalsBroadcaster.h"
+#include "WebSocketServer.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Viewer {
+    int fd = -1;
+    bool slow = false;
+    std::string input;              // Bytes received and not yet parsed.
+    std::size_t messages = 0;       // Messages received.
+};
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Connects a viewer and completes the handshake; returns false if the server refused it.
+ */
+bool connectViewer(Viewer &viewer, std::uint16_t port, const std::string &user) {
+    viewer.fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (viewer.slow) {
+        int small = 4096;
+        setsockopt(viewer.fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(viewer.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) return false;
+    // The key and accept value are the example pair from RFC 6455, which also checks the server's SHA-1.
+    std::string request = "GET /vitals?user=" + user + " HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+                          "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                          "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (::send(viewer.fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size()))
+        return false;
+    std::string response;
+    char byte;
+    while (response.find("\r\n\r\n") == std::string::npos && ::recv(viewer.fd, &byte, 1, 0) == 1) response += byte;
+    return response.compare(0, 12, "HTTP/1.1 101") == 0 &&
+           response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != std::string::npos;
+}
+
+/**
+ * @brief Parses the complete frames a viewer has received; returns the batch index of each message.
+ */
+void parseFrames(Viewer &viewer, std::vector<long long> &batches) {
+    std::size_t at = 0;
+    const std::string &in = viewer.input;
+    while (in.size() - at >= 2) {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(in.data()) + at;
+        std::uint64_t length = p[1] & 0x7F;
+        std::size_t header = 2;
+        if (length == 126) {
+            if (in.size() - at < 4) break;
+            length = static_cast<std::uint64_t>(p[2]) << 8 | p[3];
+            header = 4;
+        } else if (length == 127) {
+            if (in.size() - at < 10) break;
+            length = 0;
+            for (int i = 0; i < 8; ++i) length = length << 8 | p[2 + i];
+            header = 10;
+        }
+        if (in.size() - at < header + length) break;
+        std::size_t rows = in.find("[[", at + header);
+        if ((p[0] & 0x0F) == 0x1 && rows != std::string::npos)
+            batches.push_back(std::atoll(in.c_str() + rows + 2) / 1000000);
+        ++viewer.messages;
+        at += header + static_cast<std::size_t>(length);
+    }
+    viewer.input.erase(0, at);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t viewerCount = 1000;
+    std::size_t userCount = 100;
+    std::size_t slowCount = 50;
+    std::size_t batch = 50;
+    double rate = 4.0;
+    double seconds = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--viewers") viewerCount = std::strtoull(value, nullptr, 10);
+        else if (arg == "--users") userCount = std::strtoull(value, nullptr, 10);
+        else if (arg == "--slow") slowCount = std::strtoull(value, nullptr, 10);
+        else if (arg == "--batch") batch = std::strtoull(value, nullptr, 10);
+        else if (arg == "--rate") rate = std::atof(value);
+        else if (arg == "--seconds") seconds = std::atof(value);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+    if (viewerCount == 0 || userCount == 0 || batch == 0 || rate <= 0.0 || slowCount > viewerCount) {
+        std::fprintf(stderr, "--viewers, --users, --batch and --rate must be positive and --slow <= --viewers\n");
+        return 1;
+    }
+
+    // Two descriptors per viewer; the default soft limit is often 1024.
+    rlimit files{};
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    WebSocketServer server;
+    VitalsBroadcaster broadcaster(server);
+    if (!server.listen("127.0.0.1", 0)) return 1;
+    std::size_t batchCount = static_cast<std::size_t>(seconds * rate);
+    std::vector<std::atomic<double>> published(batchCount);
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> finished{false};
+
+    // The server thread owns the server and broadcaster until it is joined.
+    std::thread serverThread([&]() {
+        std::vector<HeartRateReading> readings(batch);
+        std::size_t next = 0;
+        double start = 0.0;
+        while (!stopping.load()) {
+            server.poll(1);
+            if (next >= batchCount) {
+                finished.store(true);
+                continue;
+            }
+            if (broadcaster.subscriberCount() < viewerCount) continue;
+            double now = nowSeconds();
+            if (start == 0.0) start = now;
+            if (now < start + static_cast<double>(next) / rate) continue;
+            published[next].store(nowSeconds());
+            for (std::size_t u = 0; u < userCount; ++u) {
+                std::string user = "viewer-user" + std::to_string(u);
+                for (std::size_t i = 0; i < batch; ++i) {
+                    readings[i].user = user;
+                    readings[i].timestamp = static_cast<long long>(next) * 1000000 + static_cast<long long>(i);
+                    readings[i].bpm = 60.0 + static_cast<double>((u + i + next) % 40);
+                    readings[i].spo2 = 97.0;
+                }
+                broadcaster.publish(user, readings.data(), readings.size());
+            }
+            ++next;
+        }
+    });
+
+    std::vector<Viewer> viewers(viewerCount);
+    int epollFd = epoll_create1(0);
+    for (std::size_t v = 0; v < viewerCount; ++v) {
+        viewers[v].slow = v >= viewerCount - slowCount;     // One slow viewer among several for most users.
+        if (!connectViewer(viewers[v], server.port(), "viewer-user" + std::to_string(v % userCount))) {
+            std::fprintf(stderr, "Viewer %zu could not connect\n", v);
+            stopping.store(true);
+            serverThread.join();
+            return 1;
+        }
+        if (viewers[v].slow) continue;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = v;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, viewers[v].fd, &event);
+    }
+
+    std::vector<double> latencies;
+    std::vector<long long> batches;
+    std::size_t fastViewers = 0;
+    for (const Viewer &viewer : viewers) fastViewers += viewer.slow ? 0 : 1;
+    std::size_t expected = fastViewers * batchCount;
+    std::size_t received = 0;
+    double deadline = nowSeconds() + seconds + 30.0;
+    char chunk[65536];
+    epoll_event events[64];
+    while (received < expected && nowSeconds() < deadline) {
+        int ready = epoll_wait(epollFd, events, 64, 100);
+        for (int i = 0; i < ready; ++i) {
+            Viewer &viewer = viewers[events[i].data.u64];
+            ssize_t got = ::recv(viewer.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+            if (got <= 0) continue;
+            viewer.input.append(chunk, static_cast<std::size_t>(got));
+            batches.clear();
+            parseFrames(viewer, batches);
+            double now = nowSeconds();
+            for (long long k : batches) {
+                if (k >= 0 && static_cast<std::size_t>(k) < batchCount) latencies.push_back(now - published[k].load());
+                ++received;
+            }
+        }
+    }
+    while (!finished.load()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stopping.store(true);
+    serverThread.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double q) {
+        return latencies.empty() ? 0.0 : latencies[static_cast<std::size_t>(q * (latencies.size() - 1))] * 1e3;
+    };
+    std::printf("%zu viewers (%zu never reading) of %zu users, %zu batches of %zu readings per user\n", viewerCount,
+                viewerCount - fastViewers, userCount, batchCount, batch);
+    std::printf("Reading viewers got %zu of %zu messages; latency p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                received, expected, percentile(0.50), percentile(0.99), percentile(1.0));
+    std::printf("Encoded %llu messages for %llu sends; %llu downgrades, %llu skipped\n",
+                static_cast<unsigned long long>(broadcaster.messagesEncoded()),
+                static_cast<unsigned long long>(broadcaster.messagesSent()),
+                static_cast<unsigned long long>(broadcaster.downgrades()),
+                static_cast<unsigned long long>(broadcaster.messagesSkipped()));
+    std::printf("Viewers per level:");
+    for (int level = 0; level < VitalsBroadcaster::kLevels; ++level)
+        std::printf(" %d:%zu", level, broadcaster.subscribersAtLevel(level));
+    std::printf("\n");
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    double cpu = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                 static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    std::printf("CPU time %.2f s for server and viewers; peak RSS %ld MB\n", cpu, usage.ru_maxrss / 1024);
+
+    for (Viewer &viewer : viewers) ::close(viewer.fd);
+    ::close(epollFd);
+    return received == expected ? 0 : 1;
+}
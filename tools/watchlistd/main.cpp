@@ -0,0 +1,91 @@
+/**
+ * @file main.cpp
+ * @brief Headless caregiver watchlist: follows the reading and survey logs and prints the top-K users.
+ *
+ * Usage: watchlistd [--csv userdata.csv] [--surveys surveydata.csv] [--state watchlist.state] [--top K]
+ *                   [--interval SECONDS] [--once]
+ *
+ * Every interval the watchlist folds in the rows appended since the previous poll and, if anything changed,
+ * prints the users who need attention now and saves its state, so a restart resumes from the saved offsets
+ * instead of reading both logs from the start. --once prints the current list and exits.
+ */
+
+#include "ReadingStore.h"
+#include "RiskWatchlist.h"
+#include "SurveyIndex.h"
+#include "SurveyStore.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+
+namespace {
+
+void printWatchlist(const RiskWatchlist &watchlist) {
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    std::printf("%s  %zu users monitored\n", stamp, watchlist.size());
+    std::printf("  %-20s %9s %-9s %-14s %6s\n", "user", "attention", "risk", "alarm", "bpm");
+    for (const WatchlistEntry &entry : watchlist.top()) {
+        char alarm[32] = "-";
+        if (entry.alarmState != 0)
+            std::snprintf(alarm, sizeof(alarm), "%s %.1f SD", entry.alarmState > 0 ? "high" : "low", entry.severity);
+        std::printf("  %-20s %9.2f %-9s %-14s %6.0f\n", entry.user.c_str(), entry.attention,
+                    entry.tier >= 0 ? SurveyProfile::tierName(entry.tier).c_str() : "-", alarm, entry.recentBpm);
+    }
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string csvPath = "userdata.csv";
+    std::string surveyPath = "surveydata.csv";
+    std::string statePath = "watchlist.state";
+    std::size_t topK = 10;
+    double interval = 2.0;
+    bool once = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--once") {
+            once = true;
+            continue;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--surveys") surveyPath = value;
+        else if (arg == "--state") statePath = value;
+        else if (arg == "--top") topK = std::strtoull(value, nullptr, 10);
+        else if (arg == "--interval") interval = std::atof(value);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+    }
+
+    RiskWatchlist watchlist(topK);
+    watchlist.load(statePath);
+    ReadingStore readings(csvPath);
+    SurveyStore surveys(surveyPath);
+    while (true) {
+        bool changed = false;
+        if (!watchlist.catchUp(readings, surveys, changed)) {
+            std::fprintf(stderr, "Cannot read %s\n", csvPath.c_str());
+            if (once) return 1;
+        } else if (changed || once) {
+            printWatchlist(watchlist);
+            if (changed) watchlist.save(statePath);
+        }
+        if (once) return 0;
+        std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+    }
+}